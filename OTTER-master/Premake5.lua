@@ -100,11 +100,31 @@ Dependencies = {
 	"Glad",
 	"stbs",
 	"ImGui",
+	"tinyGLTF",
+}
+
+-- The prebuilt libraries we ship only work on Windows
+DependenciesWindows = {
 	"opengl32.lib",
 	"imagehlp.lib",
 	"dependencies/fmod/fmod64.lib",
 	"dependencies/gzip/zlib.lib",
-	"tinyGLTF",
+}
+
+-- On Linux we link the system packages instead (zlib, Bullet and the FMOD Linux SDK). OpenGL itself is loaded at
+-- runtime through glad, and headless contexts go through EGL, see HeadlessContext
+DependenciesLinux = {
+	"fmod",
+	"z",
+	"BulletSoftBody",
+	"BulletDynamics",
+	"BulletCollision",
+	"BulletInverseDynamics",
+	"Bullet3Common",
+	"LinearMath",
+	"EGL",
+	"pthread",
+	"dl",
 }
 
 DependenciesDebug = {
@@ -207,24 +227,36 @@ function CreateDefaultModule(folderName)
 	        defines {
 	            "WINDOWS",
 	        }
-	        
+
+	        links(DependenciesWindows)
+
+	    filter "system:linux"
+	        links(DependenciesLinux)
+
 	    filter "configurations:Debug"
 	        runtime "Debug"
 	        symbols "on"
 
-	    	links(linkListDebug)
-
 	    filter "configurations:Release"
 	        runtime "Release"
 	        optimize "on"
 
+	    -- The prebuilt Bullet libraries are Windows only, Linux gets them from DependenciesLinux
+	    filter { "system:windows", "configurations:Debug" }
+	    	links(linkListDebug)
+
+	    filter { "system:windows", "configurations:Release" }
 	    	links(linkListRelease)
         
 end
 
--- Executes an xcopy command to copy all newer files from one folder to another
+-- Executes an xcopy command (or cp outside of Windows) to copy all newer files from one folder to another
 function CopyFolder(sourcePath, destPath)
-	os.execute("xcopy /Q /E /Y /I /C \"" .. sourcePath .. "\" \"" .. destPath .. "\"")
+	if os.host() == "windows" then
+		os.execute("xcopy /Q /E /Y /I /C \"" .. sourcePath .. "\" \"" .. destPath .. "\"")
+	else
+		os.execute("mkdir -p \"" .. destPath .. "\" && cp -rf \"" .. sourcePath .. "/.\" \"" .. destPath .. "\"")
+	end
 end
 
 if not os.isdir(path.join(rootDir, "shared_assets")) then
@@ -330,18 +362,6 @@ function AddProjects(groupName, folders)
 			-- Gets the location of the project's source code
 			local srcdir = path.join(relpath, "src")
 
-			-- These are the commands that get executed after build, but before debugging
-			postbuildcommands {
-				-- This step copies over anything in the dll folder to the output directory
-		  		"(xcopy /Q /E /Y /I /C \"%{wks.location}shared_assets\\dll\" \"%{absdir}\")",
-		  		"(xcopy /Q /E /Y /I /C \"%{wks.location}dependencies\\dll\" \"%{absdir}\")",
-		  		-- This step ensures that the project has a resource directory
-		  		"(IF NOT EXIST \"%{resdir}\" mkdir \"%{resdir}\")",
-		  		"(xcopy /Q /E /Y /I /C \"%{wks.location}shared_assets\\res\" \"%{absdir}\")",
-		  		-- This step copies all the resources to the output directory
-		  		"(xcopy /Q /E /Y /I /C \"%{resdir}\" \"%{absdir}\")"
-			} 
-
 			-- Our source files are everything in the src folder
 			files {
 				"%{prj.location}\\src\\**.h",
@@ -363,18 +383,45 @@ function AddProjects(groupName, folders)
 			-- Link to the dependencies and modules
 			links(ProjLinks)
 
-		    buildoptions { "/bigobj" }
-
 			-- This filters for our windows builds
 			filter "system:windows"
 				systemversion "latest"
 
+				buildoptions { "/bigobj" }
+
+				-- These are the commands that get executed after build, but before debugging
+				postbuildcommands {
+					-- This step copies over anything in the dll folder to the output directory
+			  		"(xcopy /Q /E /Y /I /C \"%{wks.location}shared_assets\\dll\" \"%{absdir}\")",
+			  		"(xcopy /Q /E /Y /I /C \"%{wks.location}dependencies\\dll\" \"%{absdir}\")",
+			  		-- This step ensures that the project has a resource directory
+			  		"(IF NOT EXIST \"%{resdir}\" mkdir \"%{resdir}\")",
+			  		"(xcopy /Q /E /Y /I /C \"%{wks.location}shared_assets\\res\" \"%{absdir}\")",
+			  		-- This step copies all the resources to the output directory
+			  		"(xcopy /Q /E /Y /I /C \"%{resdir}\" \"%{absdir}\")"
+				} 
+
 				-- Set some defines for the windows builds
 				defines {
 					"GLFW_INCLUDE_NONE", 
 					"WINDOWS"
 				}
 
+				links(DependenciesWindows)
+
+			-- Linux builds are headless (see HeadlessContext), and GNU ld needs the static libraries grouped since
+			-- our modules and dependencies reference each other
+			filter "system:linux"
+				linkgroups "On"
+				links(DependenciesLinux)
+
+				-- The same resource copies as on Windows, the dlls are Windows only so we skip those
+				postbuildcommands {
+					"{MKDIR} \"%{resdir}\"",
+					"{COPYDIR} \"%{wks.location}shared_assets/res/.\" \"%{wks.location}bin/%{outputdir}/%{prj.name}\"",
+					"{COPYDIR} \"%{resdir}/.\" \"%{wks.location}bin/%{outputdir}/%{prj.name}\""
+				}
+
 			-- Filters for our debug configurations
 			filter "configurations:Debug"
 				runtime "Debug"
@@ -41,5 +41,27 @@ project "GLFW"
             "_GLFW_WIN32",
             "_CRT_SECURE_NO_WARNINGS"
 		}
+    -- Linux builds are for headless machines (CI and render farms), so we use GLFW's null platform, which needs no
+    -- display. HeadlessContext renders through EGL surfaceless directly, and falls back to OSMesa through GLFW. The
+    -- null platform has no native or EGL context, so those are never tried here
+    filter "system:linux"
+        buildoptions { "-std=c11" }
+
+        files
+        {
+            "src/null_init.c",
+            "src/null_joystick.c",
+            "src/null_monitor.c",
+            "src/null_window.c",
+            "src/posix_time.c",
+            "src/posix_thread.c",
+            "src/osmesa_context.c"
+        }
+
+        defines
+        {
+            "_GLFW_OSMESA"
+        }
+
     filter { "system:windows", "configurations:Release" }
 buildoptions "/MT"
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "IBehaviour.h"
 #include <vector>
 #include <GLM/glm.hpp>
+#include <CerealGLM.h>
 
 class FollowPathBehaviour final : public IBehaviour
 {
@@ -12,10 +13,20 @@ public:
 		_nextPointIx(0) { }
 	~FollowPathBehaviour() override = default;
 
+	// We only ever move our own transform, so paths can be followed on any thread
+	static constexpr bool ParallelSafe = true;
+
 	std::vector<glm::vec3> Points;
 	float                  Speed;
 
-	void Update(entt::handle entity) override;
+	// Movement is part of the simulation, so it runs at the fixed rate and is interpolated for rendering
+	void FixedUpdate(entt::handle entity) override;
+
+	// Saves the path with the scene, we always start from the first point
+	template <typename Archive>
+	void serialize(Archive& archive) {
+		archive(CEREAL_NVP(Points), CEREAL_NVP(Speed));
+	}
 	
 private:
 	int _nextPointIx;
@@ -1,9 +1,23 @@
 #pragma once
 #include <memory>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <typeinfo>
 #include <entt.hpp>
-#include <typeindex>
 struct BehaviourBinding;
 
+/*
+ * The phases of a frame that behaviours are invoked in, in the order that they run
+ */
+enum class BehaviourPhase {
+	FixedUpdate,
+	Update,
+	LateUpdate,
+	RenderGUI
+};
+
 /*
  * Represents a behaviour that can be tied to a single GameObject
  */
@@ -15,6 +29,19 @@ public:
 	bool    Enabled = true;
 	virtual ~IBehaviour() = default;
 
+	/*
+	 * Hide this with true in a behaviour type to let it's FixedUpdate, Update and LateUpdate run across the thread
+	 * pool in chunks. Only do this if those updates touch nothing but their own entity's components (ex: moving it's
+	 * own Transform), and never add or remove components or behaviours
+	 */
+	static constexpr bool ParallelSafe = false;
+	/*
+	 * Invoked on the main thread once per phase for each behaviour type, before any behaviours of that type are
+	 * updated. Hide this in a behaviour type to do work that every behaviour of that type shares (ex: reading input)
+	 * @param phase The phase that is about to run
+	 */
+	static void BeginPhase(BehaviourPhase /*phase*/) {}
+
 	/*
 	 * Invoked when the behaviour is added to the scene, or the scene has been loaded
 	 * @param entity The entity that the behaviour is bound to
@@ -32,8 +59,8 @@ public:
 	 */
 	virtual void Update(entt::handle entity) {}
 	/*
-	 * Invoked during the fixed rate update phase.
-	 * To get the approximate time since the last fixed update, use florp::app::Timing::FixedTimeStep
+	 * Invoked during the fixed rate update phase, which runs zero or more times per frame before Update.
+	 * To get the time since the last fixed update, use Timing::FixedTimeStep
 	 * @param entity The entity that the behaviour is bound to
 	 */
 	virtual void FixedUpdate(entt::handle entity) {}
@@ -54,100 +81,240 @@ protected:
 };
 
 /*
- * The component added to an entt entity to connect a behaviour to a specific entity
+ * Describes one type of behaviour, so that the behaviours of each type can be run without knowing what they are
+ */
+struct BehaviourType {
+	/*
+	 * The name of the type, for profiling and debugging
+	 */
+	const char* Name;
+	/*
+	 * Invokes one phase on every enabled behaviour of this type in the registry
+	 */
+	void(*Run)(entt::registry& registry, BehaviourPhase phase);
+	/*
+	 * Copies the behaviour of this type from one entity to another (see BehaviourBinding::Stamp)
+	 */
+	void(*Stamp)(const entt::registry& from, entt::entity src, entt::registry& to, entt::entity dst);
+};
+
+/*
+ * The component added to an entt entity to connect behaviours to a specific entity
+ *
+ * Behaviours are stored as regular entt components, so every behaviour type lives in it's own contiguous pool, and
+ * looking one up is a single sparse set lookup. Phases run type by type, in the order that the types were first
+ * bound, and each behaviour is called by it's concrete type so there's no virtual call per entity. Types that don't
+ * override a phase are skipped entirely, and ParallelSafe types are split across the job system
+ *
+ * An entity can have one behaviour of each type. Pointers returned by Bind and Get are only valid until the next
+ * behaviour of that type is bound or removed, DO NOT STORE THEM!
  */
 struct BehaviourBinding {
-	std::vector<std::shared_ptr<IBehaviour>> Behaviours;
+	/*
+	 * The types of behaviour that are bound to this entity, the behaviours themselves are stored in the registry
+	 */
+	std::vector<const BehaviourType*> Types;
+
+	/*
+	 * Gets every type of behaviour that has been bound so far, in the order that they are run
+	 */
+	static const std::vector<const BehaviourType*>& GetTypes() { return _types; }
 
 	/*
-	 * Binds an IBehaviour interface to the given entt entity
+	 * Invokes one phase on every enabled behaviour in the registry, one type at a time
+	 * @param registry The registry to update the behaviours of
+	 * @param phase The phase to invoke
+	 */
+	static void RunPhase(entt::registry& registry, BehaviourPhase phase);
+
+	/*
+	 * Binds an IBehaviour interface to the given entt entity, replacing any behaviour of the same type
 	 * @param T The type of behaviour to add
 	 * @param TArgs The argument types to forward to the behaviour's constructor
-	 * @param registry The registry that the entity is part of
 	 * @param entity The entity to add the behaviour to
 	 * @param args The arguments to forward to the behaviour's constructor
+	 * @returns The behaviour that was added. DO NOT STORE POINTER!
 	 */
 	template <typename T, typename ... TArgs, typename = typename std::enable_if<std::is_base_of<IBehaviour, T>::value>::type>
-	static std::shared_ptr<T> Bind(entt::handle entity, TArgs&&... args) {
-		// Get the binding component
-		BehaviourBinding& binding = entity.get_or_emplace<BehaviourBinding>();
-		// Make a new behaviour, forwarding the arguments
-		const std::shared_ptr<IBehaviour> behaviour = std::make_shared<T>(std::forward<TArgs>(args)...);
-		// Append it to the binding component's storage, and invoke the OnLoad
-		binding.Behaviours.push_back(behaviour);
-		behaviour->OnLoad(entity);
-		return std::dynamic_pointer_cast<T>(behaviour);
+	static T* Bind(entt::handle entity, TArgs&&... args) {
+		return _Bind<T>(entity, true, std::forward<TArgs>(args)...);
 	}
 
 	/*
 	 * Binds an IBehaviour interface to the given entt entity, setting it to disabled by default
 	 * @param T The type of behaviour to add
 	 * @param TArgs The argument types to forward to the behaviour's constructor
-	 * @param registry The registry that the entity is part of
 	 * @param entity The entity to add the behaviour to
 	 * @param args The arguments to forward to the behaviour's constructor
+	 * @returns The behaviour that was added. DO NOT STORE POINTER!
 	 */
 	template <typename T, typename ... TArgs, typename = typename std::enable_if<std::is_base_of<IBehaviour, T>::value>::type>
-	static std::shared_ptr<T> BindDisabled(entt::handle entity, TArgs&&... args) {
-		// Get the binding component
-		BehaviourBinding& binding = entity.get_or_emplace<BehaviourBinding>();
-		// Make a new behaviour, forwarding the arguments
-		const std::shared_ptr<IBehaviour> behaviour = std::make_shared<T>(std::forward<TArgs>(args)...);
-		behaviour->Enabled = false;
-		// Append it to the binding component's storage, and invoke the OnLoad
-		binding.Behaviours.push_back(behaviour);
-		behaviour->OnLoad(entity);
-		return std::dynamic_pointer_cast<T>(behaviour);
+	static T* BindDisabled(entt::handle entity, TArgs&&... args) {
+		return _Bind<T>(entity, false, std::forward<TArgs>(args)...);
+	}
+
+	/*
+	 * Removes the behaviour with the given type from the entity, invoking it's OnUnload
+	 * @param T The type of behaviour to remove
+	 * @param entity The entity to remove the behaviour from
+	 * @returns True if a behaviour was removed, false if the entity had no behaviour of type T
+	 */
+	template <typename T, typename = typename std::enable_if<std::is_base_of<IBehaviour, T>::value>::type>
+	static bool Unbind(entt::handle entity) {
+		T* behaviour = entity.try_get<T>();
+		if (behaviour == nullptr) {
+			return false;
+		}
+		behaviour->OnUnload(entity);
+		entity.remove<T>();
+		std::vector<const BehaviourType*>& types = entity.get<BehaviourBinding>().Types;
+		types.erase(std::find(types.begin(), types.end(), _GetType<T>()));
+		return true;
 	}
 
-	
 	/*
 	 * Checks whether the given entity has a behaviour of the given type
 	 * @param T The type of behaviour to check for
-	 * @param registry The registry that the entity is part of
 	 * @param entity The entity to check
 	 * @returns True if a behaviour of type T is attached to entity, or false if otherwise
 	 */
 	template <typename T, typename = typename std::enable_if<std::is_base_of<IBehaviour, T>::value>::type>
 	static bool Has(entt::handle entity) {
-		// Check to see if the entity has a behaviour binding attached
-		if (entity.has<BehaviourBinding>()) {
-			// Get the binding component
-			const auto& binding = entity.get<BehaviourBinding>();
-			// Iterate over all the pointers in the binding list
-			for (const auto& ptr : binding.Behaviours) {
-				// If the pointer type matches T, we return true
-				if (std::type_index(typeid(*ptr.get())) == std::type_index(typeid(T))) {
-					return true;
-				}
-			}
-			return false;
-		}
-		else return false;
+		return entity.has<T>();
 	}
 
 	/*
 	 * Gets the behaviour with the given type from the entity, or nullptr if none exists
 	 * @param T The type of behaviour to check for
-	 * @param registry The registry that the entity is part of
 	 * @param entity The entity to search
-	 * @returns The behaviour of type T that is attached to entity, or nullptr if no behaviour of that type is attached
+	 * @returns The behaviour of type T that is attached to entity, or nullptr if no behaviour of that type is attached. DO NOT STORE POINTER!
 	 */
 	template <typename T, typename = typename std::enable_if<std::is_base_of<IBehaviour, T>::value>::type>
-	static std::shared_ptr<T> Get(entt::handle entity) {
-		// Check to see if the entity has a behaviour binding attached
-		if (entity.has<BehaviourBinding>()) {
-			// Get the binding component
-			const auto& binding = entity.get<BehaviourBinding>();
-			// Iterate over all the pointers in the binding list
-			for (const auto& ptr : binding.Behaviours) {
-				// If the pointer type matches T, we return that behaviour, making sure to cast it back to the requested type
-				if (std::type_index(typeid(*ptr.get())) == std::type_index(typeid(T))) {
-					return std::dynamic_pointer_cast<T>(ptr);
+	static T* Get(entt::handle entity) {
+		return entity.try_get<T>();
+	}
+
+	/*
+	 * Copies the binding and all of it's behaviours from one entity to another, pass this to
+	 * GameScene::RegisterComponentType so that stamped entities get their own copies of the behaviours
+	 */
+	static void Stamp(const entt::registry& from, entt::entity src, entt::registry& to, entt::entity dst);
+
+private:
+	// Entities per chunk when running ParallelSafe behaviours on the job system
+	static constexpr size_t PARALLEL_CHUNK_SIZE = 1024;
+
+	inline static std::vector<const BehaviourType*> _types;
+
+	/*
+	 * Runs func(begin, end) over the range, split across the job system
+	 */
+	static void _ParallelFor(size_t count, const std::function<void(size_t, size_t)>& func);
+	/*
+	 * Asserts that a parallel run didn't change the size of it's pool, since that means a ParallelSafe behaviour bound
+	 * or removed behaviours while other threads were reading the pool
+	 */
+	static void _CheckParallelSafe(size_t countBefore, size_t countAfter);
+
+	template <typename T, typename ... TArgs>
+	static T* _Bind(entt::handle entity, bool enabled, TArgs&&... args) {
+		const BehaviourType* type = _GetType<T>();
+		BehaviourBinding& binding = entity.get_or_emplace<BehaviourBinding>();
+		if (T* existing = entity.try_get<T>()) {
+			existing->OnUnload(entity);
+		} else {
+			binding.Types.push_back(type);
+		}
+		T& behaviour = entity.emplace_or_replace<T>(std::forward<TArgs>(args)...);
+		behaviour.Enabled = enabled;
+		behaviour.OnLoad(entity);
+		// OnLoad may have bound more behaviours of this type, moving ours
+		return entity.try_get<T>();
+	}
+
+	/*
+	 * Gets the description of a behaviour type, adding it to the list of types to run the first time it's used
+	 */
+	template <typename T>
+	static const BehaviourType* _GetType() {
+		static const BehaviourType* type = []() {
+			static const BehaviourType result = { typeid(T).name(), &_Run<T>, &_Stamp<T> };
+			_types.push_back(&result);
+			return &result;
+		}();
+		return type;
+	}
+
+	// True if T (or a class between it and IBehaviour) overrides the given phase
+	template <typename Method>
+	static constexpr bool _Overrides(Method) {
+		return !std::is_same<Method, void (IBehaviour::*)(entt::handle)>::value;
+	}
+
+	template <typename T>
+	static void _Run(entt::registry& registry, BehaviourPhase phase) {
+		// We call the concrete type's methods directly (T::Update rather than Update), so there's no virtual dispatch
+		switch (phase) {
+			case BehaviourPhase::FixedUpdate:
+				if constexpr (_Overrides(&T::FixedUpdate)) {
+					_Each<T>(registry, phase, T::ParallelSafe, [](T& behaviour, entt::handle entity) { behaviour.T::FixedUpdate(entity); });
+				}
+				break;
+			case BehaviourPhase::Update:
+				if constexpr (_Overrides(&T::Update)) {
+					_Each<T>(registry, phase, T::ParallelSafe, [](T& behaviour, entt::handle entity) { behaviour.T::Update(entity); });
+				}
+				break;
+			case BehaviourPhase::LateUpdate:
+				if constexpr (_Overrides(&T::LateUpdate)) {
+					_Each<T>(registry, phase, T::ParallelSafe, [](T& behaviour, entt::handle entity) { behaviour.T::LateUpdate(entity); });
+				}
+				break;
+			case BehaviourPhase::RenderGUI:
+				// ImGui can only be used from the main thread
+				if constexpr (_Overrides(&T::RenderGUI)) {
+					_Each<T>(registry, phase, false, [](T& behaviour, entt::handle entity) { behaviour.T::RenderGUI(entity); });
+				}
+				break;
+		}
+	}
+
+	template <typename T, typename Func>
+	static void _Each(entt::registry& registry, BehaviourPhase phase, bool parallel, const Func& func) {
+		auto view = registry.view<T>();
+		const size_t count = view.size();
+		if (count == 0) {
+			return;
+		}
+		T::BeginPhase(phase);
+		if (parallel && count >= PARALLEL_CHUNK_SIZE * 2) {
+			// The pool is packed, so we walk the behaviours and their entities side by side. ParallelSafe behaviours
+			// can't bind or remove behaviours, so the pool stays put while we hold on to it
+			T* behaviours = view.raw();
+			const entt::entity* entities = view.data();
+			_ParallelFor(count, [&](size_t begin, size_t end) {
+				for (size_t ix = begin; ix < end; ix++) {
+					if (behaviours[ix].Enabled) {
+						func(behaviours[ix], entt::handle(registry, entities[ix]));
+					}
+				}
+			});
+			_CheckParallelSafe(count, view.size());
+		} else {
+			// A serial behaviour may bind another behaviour of it's own type, which can move the whole pool, so we
+			// look it up again for every entity. Behaviours bound during the phase are appended, and wait until the next one
+			for (size_t ix = 0; ix < count && ix < view.size(); ix++) {
+				T& behaviour = view.raw()[ix];
+				if (behaviour.Enabled) {
+					func(behaviour, entt::handle(registry, view.data()[ix]));
 				}
 			}
-			return nullptr;
 		}
-		else return nullptr;
 	}
-};
\ No newline at end of file
+
+	template <typename T>
+	static void _Stamp(const entt::registry& from, entt::entity src, entt::registry& to, entt::entity dst) {
+		T& behaviour = to.emplace_or_replace<T>(dst, from.get<T>(src));
+		behaviour.OnLoad(entt::handle(to, dst));
+	}
+};
@@ -0,0 +1,78 @@
+#pragma once
+#include "IBehaviour.h"
+#include <GLM/glm.hpp>
+#include <cereal/cereal.hpp>
+
+/// <summary>
+/// The pose of an entity's morph animation for the current frame, this is kept up to date by the MorphAnimator
+/// and passed to the vertex shader as the instance params (see MorphAnimation)
+/// </summary>
+struct MorphPose
+{
+	/// <summary>
+	/// The frame we are blending from
+	/// </summary>
+	int   Frame0 = 0;
+	/// <summary>
+	/// The frame we are blending to
+	/// </summary>
+	int   Frame1 = 0;
+	/// <summary>
+	/// How far we are between the frames, from 0 (Frame0) to 1 (Frame1)
+	/// </summary>
+	float Blend = 0.0f;
+
+	/// <summary>
+	/// Packs the pose into the layout expected by morph animation shaders
+	/// </summary>
+	glm::vec4 ToInstanceParams() const { return glm::vec4((float)Frame0, (float)Frame1, Blend, 0.0f); }
+};
+
+/// <summary>
+/// Plays back a morph animation at a fixed frame rate, updating the MorphPose component on it's entity. Since
+/// the pose is sent per instance, every animated entity can be at a different point in the animation and still
+/// be drawn together
+/// </summary>
+class MorphAnimator final : public IBehaviour
+{
+public:
+	MorphAnimator() :
+		FrameCount(1),
+		FrameRate(8.0f),
+		Time(0.0f),
+		Loop(true) { }
+	~MorphAnimator() override = default;
+
+	/// <summary>
+	/// The number of frames in the animation
+	/// </summary>
+	int   FrameCount;
+	/// <summary>
+	/// The number of frames to play per second
+	/// </summary>
+	float FrameRate;
+	/// <summary>
+	/// The time since the start of the animation, in seconds. Set this to start entities at different points in the animation
+	/// </summary>
+	float Time;
+	/// <summary>
+	/// True to blend from the last frame back into the first and keep playing, false to stop on the last frame
+	/// </summary>
+	bool  Loop;
+
+	void OnLoad(entt::handle entity) override;
+	void Update(entt::handle entity) override;
+
+	/// <summary>
+	/// Calculates the pose of the animation at the current time
+	/// </summary>
+	MorphPose GetPose() const;
+
+	/// <summary>
+	/// Saves the animator's settings with the scene, the pose is recalculated from them in OnLoad
+	/// </summary>
+	template <typename Archive>
+	void serialize(Archive& archive) {
+		archive(CEREAL_NVP(FrameCount), CEREAL_NVP(FrameRate), CEREAL_NVP(Time), CEREAL_NVP(Loop));
+	}
+};
@@ -9,6 +9,27 @@ typedef void(*StampFunction)(const entt::registry& from, const entt::entity src,
 
 typedef entt::handle GameObject;
 
+class SceneAssets;
+
+/// <summary>
+/// The formats that a scene can be saved in
+/// </summary>
+enum class SceneFormat
+{
+	/// <summary>
+	/// A binary archive, fastest to load but the largest on disk
+	/// </summary>
+	Binary,
+	/// <summary>
+	/// A binary archive compressed with zlib, slightly slower to load but much smaller
+	/// </summary>
+	Compressed,
+	/// <summary>
+	/// A JSON document with the same contents, for debugging and diffing. Much slower and larger than the binary formats
+	/// </summary>
+	Json
+};
+
 class GameScene final
 {
 	SMART_MEMORY_MANAGED(GameScene)
@@ -26,6 +47,25 @@ public:
 
 	entt::registry& Registry() { return _registry; }
 
+	/// <summary>
+	/// Gets the names of the meshes and materials that this scene uses, these must be set up before saving or loading
+	/// </summary>
+	const std::shared_ptr<SceneAssets>& Assets() const { return _assets; }
+
+	/// <summary>
+	/// Saves every entity in the scene to a file, see SceneSerializer. Throws a std::runtime_error if the file could
+	/// not be written
+	/// </summary>
+	/// <param name="path">The path to save the scene to</param>
+	/// <param name="format">The format to save the scene in</param>
+	void Save(const std::string& path, SceneFormat format = SceneFormat::Compressed);
+	/// <summary>
+	/// Loads the entities in a scene file into this scene, see SceneSerializer
+	/// </summary>
+	/// <param name="path">The path of the scene file</param>
+	/// <returns>True if the scene was loaded, false if not</returns>
+	bool Load(const std::string& path);
+
 	/// <summary>
 	/// Perform any tasks that should happen at the end of a loop, such as deleting queued objects
 	/// </summary>
@@ -54,10 +94,13 @@ public:
 private:
 	entt::registry _registry;
 	std::vector<entt::entity> _deletionQueue;
+	std::shared_ptr<SceneAssets> _assets;
 
 	static entt::registry _prefabRegistry;
 	static std::unordered_map<entt::id_type, StampFunction> _stampFunctions;
 
+	static void _StampTransform(const entt::registry& from, const entt::entity src, entt::registry& to, const entt::entity dst);
+
 	template <typename T>
 	static void _DefaultComponentStamp(const entt::registry& from, const entt::entity src, entt::registry& to, const entt::entity dst) {
 		to.emplace_or_replace<T>(dst, from.get<T>(src));
@@ -0,0 +1,99 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+#include <RendererComponent.h>
+
+/// <summary>
+/// Gives names to the meshes and materials that a scene uses, so that saved scenes can refer to them by name rather
+/// than storing them. Assets are still loaded and set up in code, the scene file just says which entity uses which
+/// </summary>
+class SceneAssets final
+{
+public:
+	typedef std::shared_ptr<SceneAssets> sptr;
+	static inline sptr Create() {
+		return std::make_shared<SceneAssets>();
+	}
+	// We'll disallow moving and copying, since loaded scenes point into our tables
+	SceneAssets(const SceneAssets& other) = delete;
+	SceneAssets(SceneAssets&& other) = delete;
+	SceneAssets& operator=(const SceneAssets& other) = delete;
+	SceneAssets& operator=(SceneAssets&& other) = delete;
+
+	/// <summary>
+	/// A named mesh, either one that is already loaded or one that is streaming in
+	/// </summary>
+	struct Mesh
+	{
+		std::string                    Name;
+		VertexArrayObject::sptr        Asset;
+		AssetHandle<VertexArrayObject> Handle;
+
+		/// <summary>
+		/// Points a renderer at this mesh
+		/// </summary>
+		void ApplyTo(RendererComponent& renderer) const {
+			if (Handle.IsValid()) {
+				renderer.SetMesh(Handle, Asset);
+			} else {
+				renderer.SetMesh(Asset);
+			}
+		}
+	};
+
+	SceneAssets() = default;
+	~SceneAssets() = default;
+
+	/// <summary>
+	/// Names a mesh, replacing any mesh that already had the name
+	/// </summary>
+	void AddMesh(const std::string& name, const VertexArrayObject::sptr& mesh);
+	/// <summary>
+	/// Names a mesh that is being streamed in by the AssetStreamer. Renderers that use the mesh (or the fallback while
+	/// it is loading) will be saved with this name
+	/// </summary>
+	/// <param name="name">The name of the mesh in scene files</param>
+	/// <param name="mesh">The handle of the mesh that is loading</param>
+	/// <param name="fallback">The mesh to render until it's ready, used when the mesh is loaded from a scene file</param>
+	void AddMesh(const std::string& name, const AssetHandle<VertexArrayObject>& mesh, const VertexArrayObject::sptr& fallback = nullptr);
+	/// <summary>
+	/// Names a material, replacing any material that already had the name
+	/// </summary>
+	void AddMaterial(const std::string& name, const ShaderMaterial::sptr& material);
+
+	/// <summary>
+	/// Finds a mesh by name, or nullptr if no mesh has the name
+	/// </summary>
+	const Mesh* FindMesh(const std::string& name) const;
+	/// <summary>
+	/// Finds a material by name, or nullptr if no material has the name
+	/// </summary>
+	ShaderMaterial::sptr FindMaterial(const std::string& name) const;
+
+	/// <summary>
+	/// Gets the name of the mesh that a renderer draws (or is streaming in), or an empty string if it isn't named
+	/// </summary>
+	const std::string& GetMeshName(const RendererComponent& renderer) const;
+	/// <summary>
+	/// Gets the name of a material, or an empty string if it isn't named
+	/// </summary>
+	const std::string& GetMaterialName(const ShaderMaterial::sptr& material) const;
+
+private:
+	std::unordered_map<std::string, Mesh>                 _meshes;
+	std::unordered_map<std::string, ShaderMaterial::sptr> _materials;
+	// Reverse lookups, keyed by the mesh, the shared state of a mesh handle, or the material. Meshes that are
+	// streamed in are added once they have loaded, see _ResolveLoadedMeshes
+	mutable std::unordered_map<const void*, std::string>  _meshNames;
+	std::unordered_map<const void*, std::string>          _materialNames;
+	// The names of the streamed meshes that were still loading the last time we checked
+	mutable std::vector<std::string>                      _loadingMeshes;
+
+	// Removes the reverse lookups for a mesh that is being replaced
+	void _ForgetMesh(const Mesh& mesh);
+	// Adds reverse lookups for the streamed meshes that have finished loading since the last call
+	void _ResolveLoadedMeshes() const;
+};
@@ -0,0 +1,288 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+#include <iterator>
+#include <entt.hpp>
+
+#include <cereal/cereal.hpp>
+#include <cereal/archives/binary.hpp>
+#include <cereal/archives/json.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <GLM/gtc/quaternion.hpp>
+#include <CerealGLM.h>
+
+#include "IBehaviour.h"
+#include "Scene.h"
+
+class SceneAssets;
+
+/// <summary>
+/// The state shared by every component type while a scene is being saved or loaded. Entities are stored in files by
+/// their index, so that they can be re-created in any registry
+/// </summary>
+struct SceneArchiveContext
+{
+	/// <summary>
+	/// Used when an entity is not in the file (ex: a transform without a parent)
+	/// </summary>
+	static constexpr uint32_t INVALID = ~0u;
+
+	entt::registry&    Registry;
+	const SceneAssets& Assets;
+	/// <summary>
+	/// The entities in the file, in the order they are stored
+	/// </summary>
+	std::vector<entt::entity> Entities;
+
+	SceneArchiveContext(entt::registry& registry, const SceneAssets& assets) : Registry(registry), Assets(assets) { }
+
+	/// <summary>
+	/// Gets the index of an entity within the file, or INVALID if it isn't being saved. Only used while saving
+	/// </summary>
+	uint32_t IndexOf(entt::entity entity) const {
+		const size_t id = entt::to_integral(entity) & entt::entt_traits<entt::entity>::entity_mask;
+		return entity != entt::null && id < _indices.size() ? _indices[id] : INVALID;
+	}
+
+	/// <summary>
+	/// Saves or loads a column of values, one per entity. Binary archives store the column as one block of memory,
+	/// so the type must be trivially copyable and have the same layout on every machine that reads the file
+	/// </summary>
+	/// <param name="archive">The archive to read or write</param>
+	/// <param name="name">The name of the column in JSON archives</param>
+	/// <param name="values">The values to write, or the vector to read into</param>
+	template <typename Archive, typename T>
+	void Column(Archive& archive, const char* name, std::vector<T>& values) const {
+		static_assert(std::is_trivially_copyable<T>::value, "Columns can only hold trivially copyable types");
+		if constexpr (std::is_same<Archive, cereal::BinaryOutputArchive>::value) {
+			archive(static_cast<uint64_t>(values.size()));
+			archive(cereal::binary_data(values.data(), values.size() * sizeof(T)));
+		} else if constexpr (std::is_same<Archive, cereal::BinaryInputArchive>::value) {
+			uint64_t size = 0;
+			archive(size);
+			// Every column has at most one value per entity, this stops a corrupt size from allocating the world
+			if (size > Entities.size()) {
+				throw std::runtime_error(std::string("Column \"") + name + "\" is larger than the scene");
+			}
+			values.resize(size);
+			archive(cereal::binary_data(values.data(), values.size() * sizeof(T)));
+		} else {
+			archive(cereal::make_nvp(name, values));
+		}
+	}
+
+	/// <summary>
+	/// Saves the entities that have a component of the given type, in the same order as the component's pool. Use
+	/// the pool's raw() array for the component columns
+	/// </summary>
+	template <typename Archive, typename View>
+	void SaveEntities(Archive& archive, const View& view) const {
+		std::vector<uint32_t> indices(view.size());
+		const entt::entity* entities = view.data();
+		for (size_t ix = 0; ix < indices.size(); ix++) {
+			indices[ix] = IndexOf(entities[ix]);
+		}
+		Column(archive, "entities", indices);
+	}
+
+	/// <summary>
+	/// Loads the entities that a component type was saved for, checking that each one is in the scene and only
+	/// appears once
+	/// </summary>
+	template <typename Archive>
+	std::vector<entt::entity> LoadEntities(Archive& archive) const {
+		std::vector<uint32_t> indices;
+		Column(archive, "entities", indices);
+		std::vector<entt::entity> result(indices.size());
+		std::vector<uint8_t> seen(Entities.size(), 0);
+		for (size_t ix = 0; ix < indices.size(); ix++) {
+			if (indices[ix] >= Entities.size() || seen[indices[ix]]) {
+				throw std::runtime_error("Invalid entity index " + std::to_string(indices[ix]));
+			}
+			seen[indices[ix]] = 1;
+			result[ix] = Entities[indices[ix]];
+		}
+		return result;
+	}
+
+private:
+	friend class SceneSerializer;
+	// Maps the identifier part of each entity in the registry to it's index in the file
+	std::vector<uint32_t> _indices;
+};
+
+/// <summary>
+/// Describes how to save and load one type of component. Every function is given the whole registry, so components
+/// are read and written a column at a time rather than an entity at a time
+/// </summary>
+struct SceneComponentType
+{
+	/// <summary>
+	/// The name of the type in scene files, this must not change once scenes have been saved with it
+	/// </summary>
+	std::string Name;
+	/// <summary>
+	/// Gets the number of components of this type in a registry, types with none are left out of the file
+	/// </summary>
+	size_t(*Count)(const entt::registry& registry);
+	void(*SaveBinary)(cereal::BinaryOutputArchive& archive, SceneArchiveContext& context);
+	void(*LoadBinary)(cereal::BinaryInputArchive& archive, SceneArchiveContext& context);
+	void(*SaveJson)(cereal::JSONOutputArchive& archive, SceneArchiveContext& context);
+	void(*LoadJson)(cereal::JSONInputArchive& archive, SceneArchiveContext& context);
+};
+
+/// <summary>
+/// Saves and loads the contents of a GameScene. Transforms, GameObjectTags and RendererComponents are always saved,
+/// other component and behaviour types must be registered before saving or loading a scene that uses them.
+/// Components of types that are not registered are not saved
+///
+/// Meshes and materials are saved by the names given to them in the scene's SceneAssets, and the same names must be
+/// registered before loading the scene. Renderers that use unnamed assets are saved without them
+/// </summary>
+class SceneSerializer final
+{
+public:
+	/// <summary>
+	/// The magic number at the start of binary scene files, "OTSC"
+	/// </summary>
+	static constexpr uint32_t MAGIC = 0x4353544F;
+	/// <summary>
+	/// The version of the scene format, files with a different version will not be loaded
+	/// </summary>
+	static constexpr uint32_t VERSION = 1;
+
+	/// <summary>
+	/// Saves every entity in the scene to a file. Throws a std::runtime_error if the file could not be written
+	/// </summary>
+	/// <param name="scene">The scene to save</param>
+	/// <param name="path">The path to save the scene to, an existing file is only replaced once the save succeeds</param>
+	/// <param name="format">The format to save the scene in</param>
+	static void Save(GameScene& scene, const std::string& path, SceneFormat format = SceneFormat::Compressed);
+	/// <summary>
+	/// Loads the entities in a file into a scene, alongside any entities it already has. The format is detected from
+	/// the file's contents. If the file can't be loaded, a warning is logged and the scene is left as it was
+	/// </summary>
+	/// <param name="scene">The scene to add the entities to</param>
+	/// <param name="path">The path of the scene file</param>
+	/// <returns>True if the scene was loaded, false if not</returns>
+	static bool Load(GameScene& scene, const std::string& path);
+
+	/// <summary>
+	/// Registers a type of component to be saved with scenes. The component must be default constructible and have
+	/// a cereal serialize function (or save and load functions)
+	/// </summary>
+	/// <param name="name">The name of the type in scene files</param>
+	template <typename T>
+	static void RegisterComponent(const std::string& name) {
+		RegisterType(_MakeType<_ComponentHandler<T>>(name));
+	}
+	/// <summary>
+	/// Registers a type of behaviour to be saved with scenes. If the behaviour has a cereal serialize function, it's
+	/// parameters are saved as well, otherwise it's default constructed when loading. Loaded behaviours are bound
+	/// the same as BehaviourBinding::Bind, so OnLoad sees the loaded parameters
+	/// </summary>
+	/// <param name="name">The name of the type in scene files</param>
+	template <typename T, typename = typename std::enable_if<std::is_base_of<IBehaviour, T>::value>::type>
+	static void RegisterBehaviour(const std::string& name) {
+		RegisterType(_MakeType<_BehaviourHandler<T>>(name));
+	}
+	/// <summary>
+	/// Registers a custom type, replacing any type with the same name
+	/// </summary>
+	static void RegisterType(const SceneComponentType& type);
+
+private:
+	SceneSerializer() = default;
+
+	inline static std::vector<SceneComponentType> _types;
+
+	static void _RegisterBuiltInTypes();
+	static const SceneComponentType* _FindType(const std::string& name);
+
+	template <typename Handler>
+	static SceneComponentType _MakeType(const std::string& name) {
+		return SceneComponentType{
+			name,
+			&Handler::Count,
+			&Handler::template Save<cereal::BinaryOutputArchive>,
+			&Handler::template Load<cereal::BinaryInputArchive>,
+			&Handler::template Save<cereal::JSONOutputArchive>,
+			&Handler::template Load<cereal::JSONInputArchive>
+		};
+	}
+
+	template <typename T>
+	struct _ComponentHandler
+	{
+		static size_t Count(const entt::registry& registry) { return registry.size<T>(); }
+
+		template <typename Archive>
+		static void Save(Archive& archive, SceneArchiveContext& context) {
+			auto view = context.Registry.view<T>();
+			context.SaveEntities(archive, view);
+			std::vector<T> values(view.raw(), view.raw() + view.size());
+			archive(cereal::make_nvp("values", values));
+		}
+
+		template <typename Archive>
+		static void Load(Archive& archive, SceneArchiveContext& context) {
+			const std::vector<entt::entity> entities = context.LoadEntities(archive);
+			std::vector<T> values;
+			archive(cereal::make_nvp("values", values));
+			if (values.size() != entities.size()) {
+				throw std::runtime_error("Component count does not match entity count");
+			}
+			context.Registry.insert<T>(entities.begin(), entities.end(), std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+		}
+	};
+
+	template <typename T>
+	struct _BehaviourHandler
+	{
+		static size_t Count(const entt::registry& registry) { return registry.size<T>(); }
+
+		template <typename Archive>
+		static void Save(Archive& archive, SceneArchiveContext& context) {
+			auto view = context.Registry.view<T>();
+			context.SaveEntities(archive, view);
+			std::vector<uint8_t> enabled(view.size());
+			const T* behaviours = view.raw();
+			for (size_t ix = 0; ix < enabled.size(); ix++) {
+				enabled[ix] = behaviours[ix].Enabled ? 1 : 0;
+			}
+			context.Column(archive, "enabled", enabled);
+			if constexpr (cereal::traits::is_output_serializable<T, Archive>::value) {
+				std::vector<T> values(behaviours, behaviours + view.size());
+				archive(cereal::make_nvp("values", values));
+			}
+		}
+
+		template <typename Archive>
+		static void Load(Archive& archive, SceneArchiveContext& context) {
+			const std::vector<entt::entity> entities = context.LoadEntities(archive);
+			std::vector<uint8_t> enabled;
+			context.Column(archive, "enabled", enabled);
+			std::vector<T> values;
+			if constexpr (cereal::traits::is_input_serializable<T, Archive>::value) {
+				archive(cereal::make_nvp("values", values));
+			} else {
+				values.resize(entities.size());
+			}
+			if (enabled.size() != entities.size() || values.size() != entities.size()) {
+				throw std::runtime_error("Behaviour count does not match entity count");
+			}
+			context.Registry.reserve<T>(context.Registry.size<T>() + entities.size());
+			for (size_t ix = 0; ix < entities.size(); ix++) {
+				const entt::handle entity(context.Registry, entities[ix]);
+				if (enabled[ix]) {
+					BehaviourBinding::Bind<T>(entity, std::move(values[ix]));
+				} else {
+					BehaviourBinding::BindDisabled<T>(entity, std::move(values[ix]));
+				}
+			}
+		}
+	};
+};
@@ -1,13 +1,28 @@
 #pragma once
 #include "IBehaviour.h"
-
+#include <GLM/glm.hpp>
+#include <cereal/cereal.hpp>
 
 class SimpleMoveBehaviour : public IBehaviour
 {
 public:
+	// Input is read once per frame in BeginPhase, so the updates only touch their own transform
+	static constexpr bool ParallelSafe = true;
+
 	bool Relative = true;
 	SimpleMoveBehaviour() = default;
 	~SimpleMoveBehaviour() = default;
 
+	static void BeginPhase(BehaviourPhase phase);
 	void Update(entt::handle entity) override;
+
+	template <typename Archive>
+	void serialize(Archive& archive) {
+		archive(CEREAL_NVP(Relative));
+	}
+
+private:
+	// The movement and rotation (in degrees) requested by the keyboard this frame, before scaling by the delta time
+	inline static glm::vec3 _move = glm::vec3(0.0f);
+	inline static glm::vec3 _rotate = glm::vec3(0.0f);
 };
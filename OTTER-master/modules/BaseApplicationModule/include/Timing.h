@@ -12,6 +12,20 @@ public:
 	double LastFrame;
 	float  DeltaTime;
 
+	/// <summary>
+	/// The time between fixed updates, in seconds. See FrameScheduler
+	/// </summary>
+	float  FixedTimeStep = 1.0f / 60.0f;
+	/// <summary>
+	/// The total time that has been simulated in fixed steps, in seconds
+	/// </summary>
+	double FixedTime = 0.0;
+	/// <summary>
+	/// How far we are between the last two fixed steps, from 0 to 1. Transforms moved in FixedUpdate are drawn
+	/// this far between their previous and current states
+	/// </summary>
+	float  InterpolationAlpha = 1.0f;
+
 protected:
 	Timing() = default;
-};
\ No newline at end of file
+};
@@ -0,0 +1,32 @@
+#include "IBehaviour.h"
+
+#include <JobSystem.h>
+#include <Profiler.h>
+#include <Logging.h>
+
+void BehaviourBinding::RunPhase(entt::registry& registry, BehaviourPhase phase) {
+	// Copy the count, since a behaviour may bind a type we haven't seen before. New types will get their first
+	// update next time around
+	const size_t count = _types.size();
+	for (size_t ix = 0; ix < count; ix++) {
+		PROFILE_SCOPE(_types[ix]->Name);
+		_types[ix]->Run(registry, phase);
+	}
+}
+
+void BehaviourBinding::Stamp(const entt::registry& from, entt::entity src, entt::registry& to, entt::entity dst) {
+	// We take a copy of the types, since OnLoad in the new behaviours may bind more
+	const std::vector<const BehaviourType*> types = from.get<BehaviourBinding>(src).Types;
+	to.emplace_or_replace<BehaviourBinding>(dst).Types = types;
+	for (const BehaviourType* type : types) {
+		type->Stamp(from, src, to, dst);
+	}
+}
+
+void BehaviourBinding::_ParallelFor(size_t count, const std::function<void(size_t, size_t)>& func) {
+	JobSystem::ParallelFor(count, PARALLEL_CHUNK_SIZE, func);
+}
+
+void BehaviourBinding::_CheckParallelSafe(size_t countBefore, size_t countAfter) {
+	LOG_ASSERT(countBefore == countAfter, "ParallelSafe behaviours must not bind or remove behaviours ({} before, {} after)", countBefore, countAfter);
+}
@@ -0,0 +1,38 @@
+#include "MorphAnimator.h"
+
+#include <cmath>
+#include <algorithm>
+#include "Timing.h"
+
+void MorphAnimator::OnLoad(entt::handle entity) {
+	entity.get_or_emplace<MorphPose>() = GetPose();
+}
+
+void MorphAnimator::Update(entt::handle entity) {
+	Time += Timing::Instance().DeltaTime;
+	// Keep the time inside a single loop, so that we don't lose precision after running for a long time
+	if (Loop && FrameCount > 0 && FrameRate > 0.0f) {
+		Time = std::fmod(Time, FrameCount / FrameRate);
+	}
+	entity.get_or_emplace<MorphPose>() = GetPose();
+}
+
+MorphPose MorphAnimator::GetPose() const {
+	MorphPose result;
+	if (FrameCount <= 1) {
+		return result;
+	}
+
+	float frame = std::max(Time * FrameRate, 0.0f);
+	if (Loop) {
+		frame = std::fmod(frame, (float)FrameCount);
+	} else if (frame >= FrameCount - 1) {
+		result.Frame0 = result.Frame1 = FrameCount - 1;
+		return result;
+	}
+
+	result.Frame0 = std::min((int)frame, FrameCount - 1);
+	result.Frame1 = (result.Frame0 + 1) % FrameCount;
+	result.Blend = frame - result.Frame0;
+	return result;
+}
@@ -2,6 +2,8 @@
 
 #include "Transform.h"
 #include "GameObjectTag.h"
+#include "SceneAssets.h"
+#include "SceneSerializer.h"
 #include "LoggingBase.h"
 
 entt::registry GameScene::_prefabRegistry;
@@ -9,8 +11,9 @@ std::unordered_map<entt::id_type, StampFunction> GameScene::_stampFunctions;
 
 GameScene::GameScene(const std::string& name) {
 	Name = name;
+	_assets = SceneAssets::Create();
 
-	RegisterComponentType<Transform>();
+	RegisterComponentType<Transform>(&_StampTransform);
 	RegisterComponentType<GameObjectTag>();
 }
 
@@ -30,6 +33,14 @@ entt::handle GameScene::CreateEntity(entt::entity prefab, const std::string& nam
 	return entt::handle(_registry, instance);
 }
 
+void GameScene::Save(const std::string& path, SceneFormat format) {
+	SceneSerializer::Save(*this, path, format);
+}
+
+bool GameScene::Load(const std::string& path) {
+	return SceneSerializer::Load(*this, path);
+}
+
 entt::handle GameScene::FindFirst(const std::string& name)
 {
 	entt::entity result = entt::null;
@@ -45,6 +56,16 @@ entt::handle GameScene::FindFirst(const std::string& name)
 	return entt::handle(_registry, entt::null);
 }
 
+void GameScene::_StampTransform(const entt::registry& from, const entt::entity src, entt::registry& to, const entt::entity dst) {
+	// Transforms live in their registry's transform system, so we need to create a new one in the destination
+	// registry and copy the local transform over, rather than copying the component itself
+	const Transform& source = from.get<Transform>(src);
+	Transform& result = to.emplace_or_replace<Transform>(dst, entt::handle(to, dst));
+	result.SetLocalPosition(source.GetLocalPosition());
+	result.SetLocalRotation(source.GetLocalRotationQuat());
+	result.SetLocalScale(source.GetLocalScale());
+}
+
 entt::handle GameScene::StampEntity(const entt::registry& from, entt::entity src, entt::registry& to) {
 	entt::entity dst = to.create();
 	from.visit(src, [&from, &to, src, dst](const auto type_id) {
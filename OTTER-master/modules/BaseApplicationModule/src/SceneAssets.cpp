@@ -0,0 +1,115 @@
+#include "SceneAssets.h"
+
+#include <algorithm>
+
+void SceneAssets::AddMesh(const std::string& name, const VertexArrayObject::sptr& mesh) {
+	Mesh& entry = _meshes[name];
+	_ForgetMesh(entry);
+	entry.Name = name;
+	entry.Asset = mesh;
+	entry.Handle = AssetHandle<VertexArrayObject>();
+	if (mesh != nullptr) {
+		_meshNames[mesh.get()] = name;
+	}
+}
+
+void SceneAssets::AddMesh(const std::string& name, const AssetHandle<VertexArrayObject>& mesh, const VertexArrayObject::sptr& fallback) {
+	Mesh& entry = _meshes[name];
+	_ForgetMesh(entry);
+	entry.Name = name;
+	entry.Asset = fallback;
+	entry.Handle = mesh;
+	if (mesh.IsValid()) {
+		_meshNames[mesh.GetState().get()] = name;
+		if (std::find(_loadingMeshes.begin(), _loadingMeshes.end(), name) == _loadingMeshes.end()) {
+			_loadingMeshes.push_back(name);
+		}
+	}
+}
+
+void SceneAssets::AddMaterial(const std::string& name, const ShaderMaterial::sptr& material) {
+	ShaderMaterial::sptr& entry = _materials[name];
+	if (entry != nullptr) {
+		auto it = _materialNames.find(entry.get());
+		if (it != _materialNames.end() && it->second == name) {
+			_materialNames.erase(it);
+		}
+	}
+	entry = material;
+	if (material != nullptr) {
+		_materialNames[material.get()] = name;
+	}
+}
+
+const SceneAssets::Mesh* SceneAssets::FindMesh(const std::string& name) const {
+	auto it = _meshes.find(name);
+	return it != _meshes.end() ? &it->second : nullptr;
+}
+
+ShaderMaterial::sptr SceneAssets::FindMaterial(const std::string& name) const {
+	auto it = _materials.find(name);
+	return it != _materials.end() ? it->second : nullptr;
+}
+
+const std::string& SceneAssets::GetMeshName(const RendererComponent& renderer) const {
+	static const std::string empty;
+	// Meshes that are still streaming in are found by their handle, since the renderer only has the fallback
+	if (renderer.PendingMesh.IsValid()) {
+		auto it = _meshNames.find(renderer.PendingMesh.GetState().get());
+		if (it != _meshNames.end()) {
+			return it->second;
+		}
+	}
+	if (renderer.Mesh == nullptr) {
+		return empty;
+	}
+	auto it = _meshNames.find(renderer.Mesh.get());
+	if (it != _meshNames.end()) {
+		return it->second;
+	}
+	// Once a streamed mesh is ready the renderer drops the handle, so we may need to learn what it loaded
+	if (_loadingMeshes.empty()) {
+		return empty;
+	}
+	_ResolveLoadedMeshes();
+	it = _meshNames.find(renderer.Mesh.get());
+	return it != _meshNames.end() ? it->second : empty;
+}
+
+const std::string& SceneAssets::GetMaterialName(const ShaderMaterial::sptr& material) const {
+	static const std::string empty;
+	auto it = _materialNames.find(material.get());
+	return it != _materialNames.end() ? it->second : empty;
+}
+
+void SceneAssets::_ForgetMesh(const Mesh& mesh) {
+	// Only remove lookups that still point at this name, in case the same asset was named again since
+	auto forget = [&](const void* key) {
+		auto it = _meshNames.find(key);
+		if (key != nullptr && it != _meshNames.end() && it->second == mesh.Name) {
+			_meshNames.erase(it);
+		}
+	};
+	forget(mesh.Asset.get());
+	if (mesh.Handle.IsValid()) {
+		forget(mesh.Handle.GetState().get());
+		forget(mesh.Handle.Get().get());
+	}
+}
+
+void SceneAssets::_ResolveLoadedMeshes() const {
+	_loadingMeshes.erase(std::remove_if(_loadingMeshes.begin(), _loadingMeshes.end(), [&](const std::string& name) {
+		auto it = _meshes.find(name);
+		if (it == _meshes.end() || !it->second.Handle.IsValid()) {
+			return true;
+		}
+		const AssetHandle<VertexArrayObject>& handle = it->second.Handle;
+		if (handle.IsLoading()) {
+			return false;
+		}
+		if (handle.IsReady() && handle.Get() != nullptr) {
+			_meshNames[handle.Get().get()] = name;
+		}
+		return true;
+	}), _loadingMeshes.end());
+}
@@ -0,0 +1,540 @@
+#include "SceneSerializer.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+#include <thread>
+#include <functional>
+
+#include <gzip/compress.hpp>
+#include <gzip/decompress.hpp>
+
+#include "Scene.h"
+#include "SceneAssets.h"
+#include "Transform.h"
+#include "TransformSystem.h"
+#include "GameObjectTag.h"
+#include "RendererComponent.h"
+#include "Logging.h"
+
+#pragma pack(push, 1)
+/// <summary>
+/// The header at the start of every binary scene file, all values are little endian. The body is a cereal binary
+/// archive, compressed with zlib if the flag is set
+/// </summary>
+struct SceneHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t Flags;
+	uint32_t Reserved;
+	// The size of the body once it has been decompressed
+	uint64_t BodySize;
+};
+#pragma pack(pop)
+
+static const uint32_t SCENE_FLAG_COMPRESSED = 1;
+
+/// <summary>
+/// Lets us read an archive straight out of a buffer, without copying it into a stringstream first
+/// </summary>
+class MemoryStreamBuffer : public std::streambuf
+{
+public:
+	MemoryStreamBuffer(const char* data, size_t size) {
+		char* begin = const_cast<char*>(data);
+		setg(begin, begin, begin + size);
+	}
+};
+
+// Calls the function for the type of archive we're using, since the types hold plain function pointers
+static void SaveType(cereal::BinaryOutputArchive& archive, const SceneComponentType& type, SceneArchiveContext& context) { type.SaveBinary(archive, context); }
+static void SaveType(cereal::JSONOutputArchive& archive, const SceneComponentType& type, SceneArchiveContext& context) { type.SaveJson(archive, context); }
+static void LoadType(cereal::BinaryInputArchive& archive, const SceneComponentType& type, SceneArchiveContext& context) { type.LoadBinary(archive, context); }
+static void LoadType(cereal::JSONInputArchive& archive, const SceneComponentType& type, SceneArchiveContext& context) { type.LoadJson(archive, context); }
+
+/// <summary>
+/// The components of one type, stored as the type's name followed by whatever the type writes
+/// </summary>
+struct SceneComponentBlock
+{
+	SceneArchiveContext&      Context;
+	const SceneComponentType* Type;
+	const SceneComponentType* (*Find)(const std::string& name);
+
+	template <typename Archive>
+	void save(Archive& archive) const {
+		archive(cereal::make_nvp("type", Type->Name));
+		SaveType(archive, *Type, Context);
+	}
+
+	template <typename Archive>
+	void load(Archive& archive) {
+		std::string name;
+		archive(cereal::make_nvp("type", name));
+		Type = Find(name);
+		if (Type == nullptr) {
+			throw std::runtime_error("Unknown component type \"" + name + "\", it may need to be registered with SceneSerializer");
+		}
+		LoadType(archive, *Type, Context);
+	}
+};
+
+/// <summary>
+/// Every component type in the scene, stored as a list so that JSON archives get an array
+/// </summary>
+struct SceneComponentList
+{
+	SceneArchiveContext&                   Context;
+	std::vector<const SceneComponentType*> Types;
+	const SceneComponentType* (*Find)(const std::string& name);
+
+	template <typename Archive>
+	void save(Archive& archive) const {
+		archive(cereal::make_size_tag(static_cast<cereal::size_type>(Types.size())));
+		for (const SceneComponentType* type : Types) {
+			archive(SceneComponentBlock{ Context, type, Find });
+		}
+	}
+
+	template <typename Archive>
+	void load(Archive& archive) {
+		cereal::size_type count = 0;
+		archive(cereal::make_size_tag(count));
+		for (cereal::size_type ix = 0; ix < count; ix++) {
+			SceneComponentBlock block{ Context, nullptr, Find };
+			archive(block);
+		}
+	}
+};
+
+/// <summary>
+/// Transforms are stored in the scene's TransformSystem, so we save their local transforms a column at a time and
+/// re-create them in the destination's system. Parents are stored by their index in the file
+/// </summary>
+struct TransformColumns
+{
+	static size_t Count(const entt::registry& registry) { return registry.size<Transform>(); }
+
+	template <typename Archive>
+	static void Save(Archive& archive, SceneArchiveContext& context) {
+		auto view = context.Registry.view<Transform>();
+		context.SaveEntities(archive, view);
+
+		const TransformSystem& system = *TransformSystem::Get(context.Registry);
+		const Transform* transforms = view.raw();
+		const size_t count = view.size();
+		std::vector<glm::vec3> positions(count);
+		std::vector<glm::quat> rotations(count);
+		std::vector<glm::vec3> eulers(count);
+		std::vector<glm::vec3> scales(count);
+		std::vector<uint32_t>  parents(count);
+		for (size_t ix = 0; ix < count; ix++) {
+			const uint32_t slot = transforms[ix].GetSlot();
+			positions[ix] = system.GetPosition(slot);
+			rotations[ix] = system.GetRotation(slot);
+			eulers[ix]    = system.GetRotationEuler(slot);
+			scales[ix]    = system.GetScale(slot);
+			const uint32_t parent = system.GetParent(slot);
+			parents[ix] = parent != TransformSystem::INVALID ? context.IndexOf(system.GetEntity(parent)) : SceneArchiveContext::INVALID;
+		}
+		context.Column(archive, "position", positions);
+		context.Column(archive, "rotation", rotations);
+		context.Column(archive, "euler", eulers);
+		context.Column(archive, "scale", scales);
+		context.Column(archive, "parent", parents);
+	}
+
+	template <typename Archive>
+	static void Load(Archive& archive, SceneArchiveContext& context) {
+		const std::vector<entt::entity> entities = context.LoadEntities(archive);
+		std::vector<glm::vec3> positions, eulers, scales;
+		std::vector<glm::quat> rotations;
+		std::vector<uint32_t>  parents;
+		context.Column(archive, "position", positions);
+		context.Column(archive, "rotation", rotations);
+		context.Column(archive, "euler", eulers);
+		context.Column(archive, "scale", scales);
+		context.Column(archive, "parent", parents);
+		const size_t count = entities.size();
+		if (positions.size() != count || rotations.size() != count || eulers.size() != count || scales.size() != count || parents.size() != count) {
+			throw std::runtime_error("Transform columns do not match entity count");
+		}
+
+		// Parents come straight from the file, so we find each one's transform and make sure the chains end before
+		// linking anything, since TransformSystem::SetParent only asserts on self parenting and cycles
+		std::unordered_map<entt::entity, uint32_t> columns;
+		columns.reserve(count);
+		for (size_t ix = 0; ix < count; ix++) {
+			columns.emplace(entities[ix], (uint32_t)ix);
+		}
+		std::vector<uint32_t> parentColumns(count, SceneArchiveContext::INVALID);
+		for (size_t ix = 0; ix < count; ix++) {
+			if (parents[ix] == SceneArchiveContext::INVALID) {
+				continue;
+			}
+			auto it = parents[ix] < context.Entities.size() ? columns.find(context.Entities[parents[ix]]) : columns.end();
+			if (it == columns.end()) {
+				throw std::runtime_error("Transform parent " + std::to_string(parents[ix]) + " does not have a transform");
+			}
+			parentColumns[ix] = it->second;
+		}
+		// 0 = unvisited, 1 = on the chain we are walking, 2 = known to reach a root
+		std::vector<uint8_t> state(count, 0);
+		for (size_t ix = 0; ix < count; ix++) {
+			uint32_t column = (uint32_t)ix;
+			while (column != SceneArchiveContext::INVALID && state[column] == 0) {
+				state[column] = 1;
+				column = parentColumns[column];
+			}
+			if (column != SceneArchiveContext::INVALID && state[column] == 1) {
+				throw std::runtime_error("Transform parents form a cycle");
+			}
+			for (column = (uint32_t)ix; column != SceneArchiveContext::INVALID && state[column] == 1; column = parentColumns[column]) {
+				state[column] = 2;
+			}
+		}
+
+		entt::registry& registry = context.Registry;
+		TransformSystem& system = *TransformSystem::Get(registry);
+		system.Reserve(system.GetCount() + count);
+		registry.reserve<Transform>(registry.size<Transform>() + count);
+
+		std::vector<uint32_t> slots(count);
+		for (size_t ix = 0; ix < count; ix++) {
+			const Transform& transform = registry.emplace<Transform>(entities[ix], entt::handle(registry, entities[ix]));
+			slots[ix] = transform.GetSlot();
+			system.SetPosition(slots[ix], positions[ix]);
+			system.SetRotation(slots[ix], rotations[ix], eulers[ix]);
+			system.SetScale(slots[ix], scales[ix]);
+		}
+		// Parents may come after their children, so we link them up once every transform exists
+		for (size_t ix = 0; ix < count; ix++) {
+			if (parentColumns[ix] != SceneArchiveContext::INVALID) {
+				system.SetParent(slots[ix], slots[parentColumns[ix]]);
+			}
+		}
+	}
+};
+
+struct GameObjectTagColumns
+{
+	static size_t Count(const entt::registry& registry) { return registry.size<GameObjectTag>(); }
+
+	template <typename Archive>
+	static void Save(Archive& archive, SceneArchiveContext& context) {
+		auto view = context.Registry.view<GameObjectTag>();
+		context.SaveEntities(archive, view);
+		std::vector<std::string> names(view.size());
+		const GameObjectTag* tags = view.raw();
+		for (size_t ix = 0; ix < names.size(); ix++) {
+			names[ix] = tags[ix].Name;
+		}
+		archive(cereal::make_nvp("names", names));
+	}
+
+	template <typename Archive>
+	static void Load(Archive& archive, SceneArchiveContext& context) {
+		const std::vector<entt::entity> entities = context.LoadEntities(archive);
+		std::vector<std::string> names;
+		archive(cereal::make_nvp("names", names));
+		if (names.size() != entities.size()) {
+			throw std::runtime_error("Tag count does not match entity count");
+		}
+		std::vector<GameObjectTag> tags;
+		tags.reserve(names.size());
+		for (const std::string& name : names) {
+			tags.emplace_back(name);
+		}
+		context.Registry.insert<GameObjectTag>(entities.begin(), entities.end(), tags.begin(), tags.end());
+	}
+};
+
+/// <summary>
+/// Renderers are saved as indices into tables of mesh and material names, so each name is only stored (and looked
+/// up when loading) once no matter how many renderers use it
+/// </summary>
+struct RendererColumns
+{
+	static size_t Count(const entt::registry& registry) { return registry.size<RendererComponent>(); }
+
+	// Gets the index of a name in the table, adding it if it's new
+	static uint32_t NameIndex(const std::string& name, std::vector<std::string>& names, std::unordered_map<std::string, uint32_t>& lookup) {
+		if (name.empty()) {
+			return SceneArchiveContext::INVALID;
+		}
+		auto result = lookup.emplace(name, static_cast<uint32_t>(names.size()));
+		if (result.second) {
+			names.push_back(name);
+		}
+		return result.first->second;
+	}
+
+	template <typename Archive>
+	static void Save(Archive& archive, SceneArchiveContext& context) {
+		auto view = context.Registry.view<RendererComponent>();
+		context.SaveEntities(archive, view);
+
+		const RendererComponent* renderers = view.raw();
+		const size_t count = view.size();
+		std::vector<std::string> meshNames, materialNames;
+		std::unordered_map<std::string, uint32_t> meshLookup, materialLookup;
+		std::vector<uint32_t> meshes(count), materials(count);
+		size_t unnamed = 0;
+		for (size_t ix = 0; ix < count; ix++) {
+			meshes[ix]    = NameIndex(context.Assets.GetMeshName(renderers[ix]), meshNames, meshLookup);
+			materials[ix] = NameIndex(context.Assets.GetMaterialName(renderers[ix].Material), materialNames, materialLookup);
+			if ((meshes[ix] == SceneArchiveContext::INVALID && renderers[ix].Mesh != nullptr) ||
+				(materials[ix] == SceneArchiveContext::INVALID && renderers[ix].Material != nullptr)) {
+				unnamed++;
+			}
+		}
+		if (unnamed > 0) {
+			LOG_WARN("{} renderers use meshes or materials that have not been added to the scene's assets, they will be saved without them", unnamed);
+		}
+
+		archive(cereal::make_nvp("meshNames", meshNames), cereal::make_nvp("materialNames", materialNames));
+		context.Column(archive, "mesh", meshes);
+		context.Column(archive, "material", materials);
+	}
+
+	template <typename Archive>
+	static void Load(Archive& archive, SceneArchiveContext& context) {
+		const std::vector<entt::entity> entities = context.LoadEntities(archive);
+		std::vector<std::string> meshNames, materialNames;
+		archive(cereal::make_nvp("meshNames", meshNames), cereal::make_nvp("materialNames", materialNames));
+		std::vector<uint32_t> meshes, materials;
+		context.Column(archive, "mesh", meshes);
+		context.Column(archive, "material", materials);
+		if (meshes.size() != entities.size() || materials.size() != entities.size()) {
+			throw std::runtime_error("Renderer columns do not match entity count");
+		}
+
+		// Resolve every name once, missing assets just leave the renderers without them
+		std::vector<const SceneAssets::Mesh*> meshAssets(meshNames.size());
+		for (size_t ix = 0; ix < meshNames.size(); ix++) {
+			meshAssets[ix] = context.Assets.FindMesh(meshNames[ix]);
+			if (meshAssets[ix] == nullptr) {
+				LOG_WARN("Scene uses mesh \"{}\", which has not been added to the scene's assets", meshNames[ix]);
+			}
+		}
+		std::vector<ShaderMaterial::sptr> materialAssets(materialNames.size());
+		for (size_t ix = 0; ix < materialNames.size(); ix++) {
+			materialAssets[ix] = context.Assets.FindMaterial(materialNames[ix]);
+			if (materialAssets[ix] == nullptr) {
+				LOG_WARN("Scene uses material \"{}\", which has not been added to the scene's assets", materialNames[ix]);
+			}
+		}
+
+		std::vector<RendererComponent> renderers(entities.size());
+		for (size_t ix = 0; ix < entities.size(); ix++) {
+			if (meshes[ix] != SceneArchiveContext::INVALID) {
+				if (meshes[ix] >= meshAssets.size()) {
+					throw std::runtime_error("Invalid mesh index " + std::to_string(meshes[ix]));
+				}
+				if (meshAssets[meshes[ix]] != nullptr) {
+					meshAssets[meshes[ix]]->ApplyTo(renderers[ix]);
+				}
+			}
+			if (materials[ix] != SceneArchiveContext::INVALID) {
+				if (materials[ix] >= materialAssets.size()) {
+					throw std::runtime_error("Invalid material index " + std::to_string(materials[ix]));
+				}
+				renderers[ix].Material = materialAssets[materials[ix]];
+			}
+		}
+		context.Registry.insert<RendererComponent>(entities.begin(), entities.end(),
+			std::make_move_iterator(renderers.begin()), std::make_move_iterator(renderers.end()));
+	}
+};
+
+void SceneSerializer::RegisterType(const SceneComponentType& type) {
+	_RegisterBuiltInTypes();
+	auto it = std::find_if(_types.begin(), _types.end(), [&](const SceneComponentType& existing) { return existing.Name == type.Name; });
+	if (it != _types.end()) {
+		*it = type;
+	} else {
+		_types.push_back(type);
+	}
+}
+
+void SceneSerializer::_RegisterBuiltInTypes() {
+	// The built in types come first, so that behaviours see their entity's transform and renderer in OnLoad
+	if (_types.empty()) {
+		_types.push_back(_MakeType<TransformColumns>("Transform"));
+		_types.push_back(_MakeType<GameObjectTagColumns>("GameObjectTag"));
+		_types.push_back(_MakeType<RendererColumns>("RendererComponent"));
+	}
+}
+
+const SceneComponentType* SceneSerializer::_FindType(const std::string& name) {
+	for (const SceneComponentType& type : _types) {
+		if (type.Name == name) {
+			return &type;
+		}
+	}
+	return nullptr;
+}
+
+/// <summary>
+/// Creates the entities for a scene file, all at once so the registry only grows once
+/// </summary>
+static void CreateEntities(SceneArchiveContext& context, uint64_t count) {
+	if (count > entt::entt_traits<entt::entity>::entity_mask) {
+		throw std::runtime_error("Scene has more entities than a registry can hold");
+	}
+	context.Registry.reserve(context.Registry.size() + count);
+	context.Entities.resize(static_cast<size_t>(count));
+	context.Registry.create(context.Entities.begin(), context.Entities.end());
+}
+
+void SceneSerializer::Save(GameScene& scene, const std::string& path, SceneFormat format) {
+	_RegisterBuiltInTypes();
+	entt::registry& registry = scene.Registry();
+	SceneArchiveContext context(registry, *scene.Assets());
+
+	// Entities are stored in the order they were created, which keeps the pools in the same order when loading
+	context.Entities.reserve(registry.alive());
+	registry.each([&](entt::entity entity) { context.Entities.push_back(entity); });
+	auto identifier = [](entt::entity entity) { return entt::to_integral(entity) & entt::entt_traits<entt::entity>::entity_mask; };
+	std::sort(context.Entities.begin(), context.Entities.end(), [&](entt::entity a, entt::entity b) { return identifier(a) < identifier(b); });
+	context._indices.assign(registry.size(), SceneArchiveContext::INVALID);
+	for (size_t ix = 0; ix < context.Entities.size(); ix++) {
+		context._indices[identifier(context.Entities[ix])] = static_cast<uint32_t>(ix);
+	}
+
+	SceneComponentList components{ context, {}, &_FindType };
+	for (const SceneComponentType& type : _types) {
+		if (type.Count(registry) > 0) {
+			components.Types.push_back(&type);
+		}
+	}
+
+	std::string contents;
+	if (format == SceneFormat::Json) {
+		std::ostringstream stream;
+		{
+			cereal::JSONOutputArchive archive(stream);
+			archive(cereal::make_nvp("version", VERSION),
+				cereal::make_nvp("entities", static_cast<uint64_t>(context.Entities.size())),
+				cereal::make_nvp("components", components));
+		}
+		contents = stream.str();
+	} else {
+		std::ostringstream stream(std::ios::binary);
+		{
+			cereal::BinaryOutputArchive archive(stream);
+			archive(static_cast<uint64_t>(context.Entities.size()), components);
+		}
+		const std::string body = stream.str();
+
+		SceneHeader header;
+		header.Magic    = MAGIC;
+		header.Version  = VERSION;
+		header.Flags    = format == SceneFormat::Compressed ? SCENE_FLAG_COMPRESSED : 0;
+		header.Reserved = 0;
+		header.BodySize = body.size();
+		contents.assign(reinterpret_cast<const char*>(&header), sizeof(SceneHeader));
+		// Scenes are mostly small numbers and repeated names, so the fastest level gets nearly all of the savings
+		contents += format == SceneFormat::Compressed ? gzip::compress(body.data(), body.size(), Z_BEST_SPEED) : body;
+	}
+
+	// We write to a temporary file first, so that a crash never leaves a half-written scene behind
+	const std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			throw std::runtime_error("Failed to open " + tempPath + " for writing");
+		}
+		file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+		if (!file) {
+			throw std::runtime_error("Failed to write scene " + tempPath);
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, path, error);
+	if (error) {
+		std::filesystem::remove(tempPath, error);
+		throw std::runtime_error("Failed to replace scene " + path);
+	}
+}
+
+bool SceneSerializer::Load(GameScene& scene, const std::string& path) {
+	_RegisterBuiltInTypes();
+
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file) {
+		LOG_WARN("Failed to open scene \"{}\"", path);
+		return false;
+	}
+	std::string contents(static_cast<size_t>(file.tellg()), '\0');
+	file.seekg(0);
+	file.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+	if (!file) {
+		LOG_WARN("Failed to read scene \"{}\"", path);
+		return false;
+	}
+
+	entt::registry& registry = scene.Registry();
+	SceneArchiveContext context(registry, *scene.Assets());
+	SceneComponentList components{ context, {}, &_FindType };
+	try {
+		const size_t start = contents.find_first_not_of(" \t\r\n");
+		if (start != std::string::npos && contents[start] == '{') {
+			std::istringstream stream(contents);
+			cereal::JSONInputArchive archive(stream);
+			uint32_t version = 0;
+			uint64_t count = 0;
+			archive(cereal::make_nvp("version", version), cereal::make_nvp("entities", count));
+			if (version != VERSION) {
+				throw std::runtime_error("Unsupported scene version " + std::to_string(version));
+			}
+			CreateEntities(context, count);
+			archive(cereal::make_nvp("components", components));
+		} else {
+			SceneHeader header;
+			if (contents.size() < sizeof(SceneHeader)) {
+				throw std::runtime_error("File is too small to be a scene");
+			}
+			memcpy(&header, contents.data(), sizeof(SceneHeader));
+			if (header.Magic != MAGIC) {
+				throw std::runtime_error("File is not a scene");
+			}
+			if (header.Version != VERSION) {
+				throw std::runtime_error("Unsupported scene version " + std::to_string(header.Version));
+			}
+
+			const char* body = contents.data() + sizeof(SceneHeader);
+			size_t bodySize = contents.size() - sizeof(SceneHeader);
+			std::string decompressed;
+			if (header.Flags & SCENE_FLAG_COMPRESSED) {
+				decompressed = gzip::decompress(body, bodySize);
+				body = decompressed.data();
+				bodySize = decompressed.size();
+			}
+			if (bodySize != header.BodySize) {
+				throw std::runtime_error("Scene is truncated");
+			}
+
+			MemoryStreamBuffer buffer(body, bodySize);
+			std::istream stream(&buffer);
+			cereal::BinaryInputArchive archive(stream);
+			uint64_t count = 0;
+			archive(count);
+			CreateEntities(context, count);
+			archive(components);
+		}
+	}
+	catch (const std::exception& e) {
+		LOG_WARN("Failed to load scene \"{}\": {}", path, e.what());
+		// Anything we've added so far goes back out, so the scene is left as it was
+		registry.destroy(context.Entities.begin(), context.Entities.end());
+		return false;
+	}
+	return true;
+}
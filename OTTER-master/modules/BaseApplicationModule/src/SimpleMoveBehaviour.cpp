@@ -5,88 +5,52 @@
 
 #include "GLFW/glfw3.h"
 
+// Returns 1 if the positive key is down, -1 if the negative key is down, and 0 if neither or both are
+static float KeyAxis(GLFWwindow* window, int positive, int negative) {
+	return (glfwGetKey(window, positive) == GLFW_PRESS ? 1.0f : 0.0f) - (glfwGetKey(window, negative) == GLFW_PRESS ? 1.0f : 0.0f);
+}
+
+void SimpleMoveBehaviour::BeginPhase(BehaviourPhase phase)
+{
+	if (phase != BehaviourPhase::Update) {
+		return;
+	}
+	GLFWwindow* window = Application::Instance().Window;
+	if (window == nullptr) {
+		_move = _rotate = glm::vec3(0.0f);
+		return;
+	}
+	_move = glm::vec3(
+		KeyAxis(window, GLFW_KEY_S, GLFW_KEY_W),
+		KeyAxis(window, GLFW_KEY_D, GLFW_KEY_A),
+		KeyAxis(window, GLFW_KEY_SPACE, GLFW_KEY_LEFT_CONTROL));
+	_rotate = glm::vec3(
+		KeyAxis(window, GLFW_KEY_LEFT, GLFW_KEY_RIGHT),
+		KeyAxis(window, GLFW_KEY_DOWN, GLFW_KEY_UP),
+		KeyAxis(window, GLFW_KEY_Q, GLFW_KEY_E)) * 45.0f;
+}
+
 void SimpleMoveBehaviour::Update(entt::handle entity)
 {
+	if (_move == glm::vec3(0.0f) && _rotate == glm::vec3(0.0f)) {
+		return;
+	}
 	float dt = Timing::Instance().DeltaTime;
-	GLFWwindow* window = Application::Instance().Window;
 	Transform& transform = entity.get<Transform>();
 
 	if (Relative) {
-		if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
-			transform.MoveLocal(0.0f, -1.0f * dt, 0.0f);
-		}
-		if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
-			transform.MoveLocal(0.0f, 1.0f * dt, 0.0f);
-		}
-		if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-			transform.MoveLocal(-1.0f * dt, 0.0f, 0.0f);
-		}
-		if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-			transform.MoveLocal(1.0f * dt, 0.0f, 0.0f);
-		}
-		if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) {
-			transform.MoveLocal(0.0f, 0.0f, 1.0f * dt);
-		}
-		if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS) {
-			transform.MoveLocal(0.0f, 0.0f, -1.0f * dt);
-		}
-
-		if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
-			transform.RotateLocal(0.0f, -45.0f * dt, 0.0f);
-		}
-		if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) {
-			transform.RotateLocal(0.0f, 45.0f * dt, 0.0f);
-		}
-		if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) {
-			transform.RotateLocal(45.0f * dt, 0.0f, 0.0f);
-		}
-		if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) {
-			transform.RotateLocal(-45.0f * dt, 0.0f, 0.0f);
-		}
-		if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) {
-			transform.RotateLocal(0.0f, 0.0f, 45.0f * dt);
-		}
-		if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS) {
-			transform.RotateLocal(0.0f, 0.0f, -45.0f * dt);
-		}
-	} else
-	{
-		if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
-			transform.MoveLocalFixed(0.0f, -1.0f * dt, 0.0f);
-		}
-		if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
-			transform.MoveLocalFixed(0.0f, 1.0f * dt, 0.0f);
-		}
-		if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-			transform.MoveLocalFixed(-1.0f * dt, 0.0f, 0.0f);
-		}
-		if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-			transform.MoveLocalFixed(1.0f * dt, 0.0f, 0.0f);
-		}
-		if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) {
-			transform.MoveLocalFixed(0.0f, 0.0f, 1.0f * dt);
-		}
-		if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS) {
-			transform.MoveLocalFixed(0.0f, 0.0f, -1.0f * dt);
-		}
-
-		if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
-			transform.RotateLocalFixed(0.0f, -45.0f * dt, 0.0f);
-		}
-		if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) {
-			transform.RotateLocalFixed(0.0f, 45.0f * dt, 0.0f);
-		}
-		if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) {
-			transform.RotateLocalFixed(45.0f * dt, 0.0f, 0.0f);
+		if (_move != glm::vec3(0.0f)) {
+			transform.MoveLocal(_move * dt);
 		}
-		if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) {
-			transform.RotateLocalFixed(-45.0f * dt, 0.0f, 0.0f);
+		if (_rotate != glm::vec3(0.0f)) {
+			transform.RotateLocal(_rotate * dt);
 		}
-		if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) {
-			transform.RotateLocalFixed(0.0f, 0.0f, 45.0f * dt);
+	} else {
+		if (_move != glm::vec3(0.0f)) {
+			transform.MoveLocalFixed(_move * dt);
 		}
-		if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS) {
-			transform.RotateLocalFixed(0.0f, 0.0f, -45.0f * dt);
+		if (_rotate != glm::vec3(0.0f)) {
+			transform.RotateLocalFixed(_rotate * dt);
 		}
 	}
 }
@@ -0,0 +1,207 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <functional>
+#include <unordered_map>
+
+#include <GLM/glm.hpp>
+
+#include "VertexArrayObject.h"
+#include "Texture2D.h"
+#include "TextureCubeMap.h"
+#include "Texture2DArray.h"
+#include "MorphAnimation.h"
+#include "AssetHandle.h"
+#include "AssetStreamer.h"
+
+/// <summary>
+/// The asset cache makes sure that every file is only loaded once per process. Assets are keyed by their canonical
+/// path and any options that affect the loaded result, and the cache only holds weak references to them, so an
+/// asset is evicted as soon as nothing in the application is using it anymore
+///
+/// If multiple threads request the same asset at the same time, only the first will load it, and the rest will
+/// wait for that load to finish. The same goes for assets that are being streamed in by the AssetStreamer
+/// </summary>
+class AssetCache
+{
+public:
+	/// <summary>
+	/// Counters for monitoring how effective the cache is
+	/// </summary>
+	struct Stats
+	{
+		/// <summary>
+		/// The number of requests that were served by an already loaded (or loading) asset
+		/// </summary>
+		uint64_t Hits;
+		/// <summary>
+		/// The number of requests that had to load the asset from disk
+		/// </summary>
+		uint64_t Misses;
+		/// <summary>
+		/// The number of assets that are currently loaded
+		/// </summary>
+		size_t   ResidentCount;
+		/// <summary>
+		/// The approximate amount of GPU memory used by the currently loaded assets, in bytes
+		/// </summary>
+		size_t   ResidentBytes;
+	};
+
+	/// <summary>
+	/// Loads an OBJ mesh via ObjLoader::LoadFromFile, or returns the existing mesh if it is already loaded with the same color
+	/// </summary>
+	static VertexArrayObject::sptr LoadObj(const std::string& path, const glm::vec4& inColor = glm::vec4(1.0f));
+	/// <summary>
+	/// Loads a NotObj mesh via NotObjLoader::LoadFromFile, or returns the existing mesh if it is already loaded
+	/// </summary>
+	static VertexArrayObject::sptr LoadNotObj(const std::string& path);
+	/// <summary>
+	/// Loads a texture via Texture2D::LoadFromFile, or returns the existing texture if it is already loaded
+	/// </summary>
+	static Texture2D::sptr LoadTexture2D(const std::string& path);
+	/// <summary>
+	/// Loads a cube map via TextureCubeMap::LoadFromImages, or returns the existing cube map if it is already loaded
+	/// </summary>
+	static TextureCubeMap::sptr LoadCubeMap(const std::string& path);
+	/// <summary>
+	/// Loads a texture array via Texture2DArray::LoadFromFiles, or returns the existing array if it is already loaded
+	/// </summary>
+	static Texture2DArray::sptr LoadTexture2DArray(const std::string& cachePath, const std::vector<std::string>& sourcePaths);
+	/// <summary>
+	/// Loads a morph animation via MorphAnimation::LoadFromFiles, or returns the existing animation if it is already loaded
+	/// </summary>
+	static MorphAnimation::sptr LoadMorphAnimation(const std::vector<std::string>& framePaths, bool quantize = true);
+
+	/// <summary>
+	/// Gets the cache key for an OBJ mesh loaded with the given color
+	/// </summary>
+	static std::string GetObjKey(const std::string& path, const glm::vec4& inColor = glm::vec4(1.0f));
+	/// <summary>
+	/// Gets the cache key for a NotObj mesh
+	/// </summary>
+	static std::string GetNotObjKey(const std::string& path);
+	/// <summary>
+	/// Gets the cache key for a 2D texture
+	/// </summary>
+	static std::string GetTexture2DKey(const std::string& path);
+	/// <summary>
+	/// Gets the cache key for a cube map
+	/// </summary>
+	static std::string GetCubeMapKey(const std::string& path);
+	/// <summary>
+	/// Gets the cache key for a texture array, which is keyed by it's baked path and every source path
+	/// </summary>
+	static std::string GetTexture2DArrayKey(const std::string& cachePath, const std::vector<std::string>& sourcePaths);
+	/// <summary>
+	/// Gets the cache key for a morph animation, which is keyed by every frame path
+	/// </summary>
+	static std::string GetMorphAnimationKey(const std::vector<std::string>& framePaths, bool quantize = true);
+
+	/// <summary>
+	/// Looks up an asset that is already loaded, counting as a hit if it is found
+	/// </summary>
+	/// <param name="key">The key of the asset, see the Get*Key functions</param>
+	/// <returns>The asset, or nullptr if it is not loaded</returns>
+	template <typename T>
+	static std::shared_ptr<T> Find(const std::string& key) {
+		return std::static_pointer_cast<T>(_Find(key));
+	}
+	/// <summary>
+	/// Adds an asset that was loaded outside of the cache (ex: by the AssetStreamer), counting as a miss. If the
+	/// asset is already in the cache, the existing asset is kept and returned instead
+	/// </summary>
+	/// <param name="key">The key of the asset, see the Get*Key functions</param>
+	/// <param name="asset">The asset to add</param>
+	/// <returns>The asset that is now in the cache</returns>
+	template <typename T>
+	static std::shared_ptr<T> Insert(const std::string& key, const std::shared_ptr<T>& asset) {
+		return std::static_pointer_cast<T>(_Insert(key, asset, asset != nullptr ? asset->GetGpuMemoryUsage() : 0));
+	}
+
+	/// <summary>
+	/// Removes all entries for assets that are no longer in use, and updates the resident counters
+	/// </summary>
+	/// <returns>The number of entries that were evicted</returns>
+	static size_t Collect();
+
+	/// <summary>
+	/// Evicts expired assets, and returns the current cache statistics
+	/// </summary>
+	static Stats GetStats();
+	/// <summary>
+	/// Resets the hit and miss counters back to zero
+	/// </summary>
+	static void ResetStats();
+
+protected:
+	AssetCache() = default;
+	~AssetCache() = default;
+
+	// Called once a synchronous load has finished, with either the loaded asset or an error message
+	typedef std::function<void(const std::shared_ptr<void>& asset, const std::string& error)> LoadedFunc;
+
+	// Stores a single asset in the cache, the loaded asset is type erased so we can store everything in one map
+	struct Entry {
+		std::weak_ptr<void> Asset;
+		size_t              Bytes = 0;
+		// Valid while the asset is being loaded, so other threads can wait for it
+		std::shared_future<std::shared_ptr<void>> Pending;
+		// Streams that are waiting for the pending load, these are called by the loading thread once it's done
+		std::vector<LoadedFunc> Continuations;
+		// The handle state of an AssetStreamer load that is in flight, so requests for the same asset share it
+		std::weak_ptr<void> Streaming;
+	};
+
+	// The result of asking to stream an asset, at most one of the fields will be set
+	struct StreamRequest {
+		// The asset, if it is already loaded
+		std::shared_ptr<void> Asset;
+		// The handle state of a stream that is already loading the asset
+		std::shared_ptr<void> Streaming;
+		// True if a synchronous load of the asset is in flight, onLoaded will be called once it finishes
+		bool Chained = false;
+	};
+	friend class AssetStreamer;
+
+	static std::mutex _lock;
+	static std::unordered_map<std::string, Entry> _entries;
+	static uint64_t _hits;
+	static uint64_t _misses;
+
+	// Builds a cache key out of the type of asset, the canonical path and any extra options
+	static std::string _MakeKey(const char* type, const std::string& path, const std::string& options = "");
+
+	static std::shared_ptr<void> _Find(const std::string& key);
+	static std::shared_ptr<void> _Insert(const std::string& key, const std::shared_ptr<void>& asset, size_t bytes);
+
+	// Looks up an asset for the AssetStreamer. If nothing has loaded or is loading the asset, state is registered as
+	// the stream that will load it, and an empty request is returned. If a synchronous load is in flight, onLoaded
+	// is chained onto it rather than having the streamer block on it
+	static StreamRequest _BeginStream(const std::string& key, const std::shared_ptr<void>& state, const LoadedFunc& onLoaded);
+	// Removes a stream from it's entry once it has finished, successfully or not
+	static void _EndStream(const std::string& key, const std::shared_ptr<void>& state);
+
+	// Finds or loads an asset, load will be called at most once for concurrent requests with the same key. If the
+	// asset is being streamed in, wait is called with the stream's handle state instead of loading it again
+	static std::shared_ptr<void> _GetOrLoad(const std::string& key,
+		const std::function<std::shared_ptr<void>()>& load,
+		const std::function<size_t(const std::shared_ptr<void>&)>& measure,
+		const std::function<std::shared_ptr<void>(const std::shared_ptr<void>&)>& wait);
+
+	template <typename T>
+	static std::shared_ptr<T> _GetOrLoad(const std::string& key, const std::function<std::shared_ptr<T>()>& load) {
+		return std::static_pointer_cast<T>(_GetOrLoad(key,
+			[&]() { return std::static_pointer_cast<void>(load()); },
+			[](const std::shared_ptr<void>& asset) { return std::static_pointer_cast<T>(asset)->GetGpuMemoryUsage(); },
+			[](const std::shared_ptr<void>& streaming) {
+				AssetHandle<T> handle(std::static_pointer_cast<typename AssetHandle<T>::State>(streaming));
+				AssetStreamer::Wait(handle);
+				return std::static_pointer_cast<void>(handle.Get());
+			}));
+	}
+};
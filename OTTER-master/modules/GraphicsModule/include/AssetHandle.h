@@ -0,0 +1,102 @@
+#pragma once
+#include <memory>
+#include <atomic>
+#include <string>
+
+/// <summary>
+/// The state of an asset that is being streamed in
+/// </summary>
+enum class AssetStatus
+{
+	Loading  = 0,
+	Ready    = 1,
+	Failed   = 2
+};
+
+/// <summary>
+/// A handle to an asset that is being loaded in the background (see AssetStreamer). The handle can be copied around
+/// freely, and all copies will see the asset once it has been uploaded. Until then, Get() will return nullptr, so
+/// callers should fall back to a placeholder
+/// </summary>
+/// <typeparam name="T">The type of asset (ex: VertexArrayObject, Texture2D)</typeparam>
+template <typename T>
+class AssetHandle
+{
+public:
+	/// <summary>
+	/// The shared state between all copies of a handle, this should only be modified by the AssetStreamer
+	/// </summary>
+	struct State
+	{
+		std::atomic<AssetStatus> Status{ AssetStatus::Loading };
+		// Only assigned on the render thread before Status becomes Ready, and never modified afterwards
+		std::shared_ptr<T>       Asset;
+		std::string              Error;
+		std::string              Path;
+	};
+
+	/// <summary>
+	/// Creates an empty handle that does not refer to any asset
+	/// </summary>
+	AssetHandle() = default;
+	/// <summary>
+	/// Creates a handle that refers to the given loading state
+	/// </summary>
+	AssetHandle(const std::shared_ptr<State>& state) : _state(state) {}
+	/// <summary>
+	/// Creates a handle for an asset that is already loaded
+	/// </summary>
+	static AssetHandle FromAsset(const std::shared_ptr<T>& asset) {
+		std::shared_ptr<State> state = std::make_shared<State>();
+		state->Asset = asset;
+		state->Status = asset != nullptr ? AssetStatus::Ready : AssetStatus::Failed;
+		return AssetHandle(state);
+	}
+
+	/// <summary>
+	/// Returns true if this handle refers to an asset (loaded or not)
+	/// </summary>
+	bool IsValid() const { return _state != nullptr; }
+	/// <summary>
+	/// Gets the current status of the asset, handles that are not valid are considered failed
+	/// </summary>
+	AssetStatus GetStatus() const { return _state != nullptr ? _state->Status.load(std::memory_order_acquire) : AssetStatus::Failed; }
+	/// <summary>
+	/// Returns true if the asset has been uploaded and can be used
+	/// </summary>
+	bool IsReady() const { return GetStatus() == AssetStatus::Ready; }
+	/// <summary>
+	/// Returns true if the asset is still being loaded or uploaded
+	/// </summary>
+	bool IsLoading() const { return GetStatus() == AssetStatus::Loading; }
+	/// <summary>
+	/// Returns true if the asset could not be loaded
+	/// </summary>
+	bool IsFailed() const { return GetStatus() == AssetStatus::Failed; }
+
+	/// <summary>
+	/// Gets the loaded asset, or nullptr if it is not ready yet
+	/// </summary>
+	std::shared_ptr<T> Get() const { return IsReady() ? _state->Asset : nullptr; }
+	/// <summary>
+	/// Gets the loaded asset, or the given fallback if it is not ready yet
+	/// </summary>
+	std::shared_ptr<T> GetOr(const std::shared_ptr<T>& fallback) const { return IsReady() ? _state->Asset : fallback; }
+
+	/// <summary>
+	/// Gets the error message if the asset failed to load
+	/// </summary>
+	const std::string& GetError() const { static const std::string empty; return _state != nullptr ? _state->Error : empty; }
+	/// <summary>
+	/// Gets the path that the asset is being loaded from
+	/// </summary>
+	const std::string& GetPath() const { static const std::string empty; return _state != nullptr ? _state->Path : empty; }
+
+	/// <summary>
+	/// Gets the shared state of the handle
+	/// </summary>
+	const std::shared_ptr<State>& GetState() const { return _state; }
+
+private:
+	std::shared_ptr<State> _state;
+};
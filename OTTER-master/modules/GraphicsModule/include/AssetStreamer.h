@@ -0,0 +1,165 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+
+#include <GLM/glm.hpp>
+
+#include "AssetHandle.h"
+#include "VertexArrayObject.h"
+#include "Texture2D.h"
+#include "TextureCubeMap.h"
+#include "Texture2DArray.h"
+
+/// <summary>
+/// The asset streamer loads assets in the background. Files are read, parsed and decoded on the JobSystem,
+/// and the resulting CPU side data is pushed onto an upload queue. The render thread drains that queue by
+/// calling ProcessUploads once per frame, which creates the OpenGL objects within a time budget so loading never
+/// stalls the frame loop for long
+///
+/// Decode jobs never block. Instead, the number of loads that are decoding or waiting for upload is capped, and
+/// any loads requested past that cap are held back until earlier loads have been uploaded
+///
+/// Loaded assets are shared with the AssetCache, so a mesh that is streamed in will be returned by AssetCache::LoadObj
+/// and vice versa
+/// </summary>
+class AssetStreamer
+{
+public:
+	/// <summary>
+	/// Counters for monitoring the streaming system
+	/// </summary>
+	struct Stats
+	{
+		/// <summary>
+		/// The number of assets that have been requested but are not uploaded yet
+		/// </summary>
+		size_t   PendingCount;
+		/// <summary>
+		/// The number of assets waiting in the upload queue
+		/// </summary>
+		size_t   QueuedUploads;
+		/// <summary>
+		/// The number of loads that are held back until there is room to decode them
+		/// </summary>
+		size_t   DeferredCount;
+		/// <summary>
+		/// The total number of assets that have been uploaded
+		/// </summary>
+		uint64_t UploadedCount;
+		/// <summary>
+		/// The number of uploads that were processed during the last call to ProcessUploads
+		/// </summary>
+		size_t   LastFrameUploads;
+		/// <summary>
+		/// The time spent in the last call to ProcessUploads, in milliseconds
+		/// </summary>
+		double   LastFrameMs;
+	};
+
+	/// <summary>
+	/// Starts loading an OBJ mesh in the background
+	/// </summary>
+	static AssetHandle<VertexArrayObject> LoadObjAsync(const std::string& path, const glm::vec4& inColor = glm::vec4(1.0f));
+	/// <summary>
+	/// Starts loading a NotObj mesh in the background
+	/// </summary>
+	static AssetHandle<VertexArrayObject> LoadNotObjAsync(const std::string& path);
+	/// <summary>
+	/// Starts loading a 2D texture in the background
+	/// </summary>
+	static AssetHandle<Texture2D> LoadTexture2DAsync(const std::string& path);
+	/// <summary>
+	/// Starts loading a cube map in the background, with each of the 6 faces decoded in parallel. See
+	/// TextureCubeMapData::LoadFromImages for how the face images are named
+	/// </summary>
+	static AssetHandle<TextureCubeMap> LoadCubeMapAsync(const std::string& path);
+	/// <summary>
+	/// Starts loading a texture array in the background, see BakedTexture::LoadCachedArray
+	/// </summary>
+	/// <param name="cachePath">The path of the baked array (ex: images/props.dds)</param>
+	/// <param name="sourcePaths">The paths of the images to store in each layer, in order</param>
+	static AssetHandle<Texture2DArray> LoadTexture2DArrayAsync(const std::string& cachePath, const std::vector<std::string>& sourcePaths);
+
+	/// <summary>
+	/// Uploads queued assets to the GPU, this must be called from the thread that owns the OpenGL context. At least
+	/// one upload is processed per call (if any are queued), so progress is always made even with a tiny budget
+	/// </summary>
+	/// <param name="budgetMs">The maximum time to spend uploading, in milliseconds</param>
+	/// <returns>The number of assets that were uploaded</returns>
+	static size_t ProcessUploads(double budgetMs = 2.0);
+	/// <summary>
+	/// Blocks until all requested assets have been loaded and uploaded, must be called from the OpenGL thread. This
+	/// is handy for loading screens, or if the rest of a scene can't be built without the assets
+	/// </summary>
+	static void Flush();
+	/// <summary>
+	/// Blocks until a single asset has finished loading (or failed), processing uploads while it waits. This must be
+	/// called from the OpenGL thread, see Flush
+	/// </summary>
+	template <typename T>
+	static void Wait(const AssetHandle<T>& handle) {
+		_WaitUntil([&]() { return !handle.IsLoading(); });
+	}
+
+	/// <summary>
+	/// Sets the maximum number of assets that can be decoding or waiting for upload at once, which keeps the amount
+	/// of decoded data in memory bounded. Loads past this limit are started as earlier loads finish uploading
+	/// </summary>
+	static void SetUploadQueueCapacity(size_t capacity);
+
+	/// <summary>
+	/// Gets the current streaming statistics
+	/// </summary>
+	static Stats GetStats();
+
+protected:
+	AssetStreamer() = default;
+	~AssetStreamer() = default;
+
+	// A unit of work for the render thread, which creates the GPU resource and resolves the handle
+	struct Upload {
+		std::function<void()> Run;
+	};
+
+	static std::mutex _lock;
+	static std::condition_variable _queueChanged;
+	static std::deque<Upload> _uploads;
+	// Loads that have been requested, but not started since too many loads were already in flight
+	static std::deque<std::function<void()>> _deferred;
+	static size_t _uploadCapacity;
+	static size_t _inFlightCount;
+	static size_t _pendingCount;
+	static Stats  _stats;
+
+	// Pushes an upload onto the queue, this never blocks so it is safe to call from inside of a job
+	static void _QueueUpload(std::function<void()> upload);
+	// Starts a load now if there is room for it, otherwise holds it back until an in flight load has finished
+	static void _StartThrottled(std::function<void()> start);
+	// Called once a throttled load has been uploaded (or failed), starts the next deferred load if there is one
+	static void _FinishThrottled();
+	// Processes uploads until done returns true, done is checked while holding the lock
+	static void _WaitUntil(const std::function<bool()>& done);
+
+	// Creates the GPU side of an asset, called on the render thread
+	template <typename T>
+	using UploadFunc = std::function<std::shared_ptr<T>()>;
+	// Called exactly once when the CPU side of a load is done, with either an upload function or an error message
+	template <typename T>
+	using CompleteFunc = std::function<void(const UploadFunc<T>& upload, const std::string& error)>;
+
+	// Shared implementation of all the async loads. start is called on the requesting thread, and should kick off
+	// work on the job system which eventually calls the completion function
+	template <typename T>
+	static AssetHandle<T> _LoadAsync(const std::string& key, const std::string& path,
+		const std::function<void(const CompleteFunc<T>& complete)>& start);
+
+	// Marks a handle as finished, and removes it from the AssetCache's in-flight streams
+	template <typename T>
+	static void _Resolve(const std::string& key, const std::shared_ptr<typename AssetHandle<T>::State>& state,
+		const std::shared_ptr<T>& asset, const std::string& error);
+};
@@ -0,0 +1,288 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <functional>
+
+#include "MeshBuilder.h"
+#include "MeshBakeSettings.h"
+#include "MemoryMappedFile.h"
+#include "Logging.h"
+
+/// <summary>
+/// A baked mesh is a read-only view into a binary ".otm" mesh file. These store the final interleaved
+/// vertex data, the index data and the vertex layout for a mesh, so that it can be uploaded to the GPU
+/// directly from the memory mapped file without any parsing
+///
+/// The bounds of the mesh are calculated when it is baked and stored in the file, so they never need to be
+/// recalculated at load time. Meshes with levels of detail store them all in the one index buffer, along with a
+/// table of where each level starts (see MeshBuilder::GenerateLods)
+///
+/// Each file also stores a hash of the source file and the options it was loaded with, so loaders
+/// can tell when the cached version is out of date
+/// </summary>
+class BakedMesh final
+{
+public:
+	typedef std::shared_ptr<BakedMesh> sptr;
+
+	/// <summary>
+	/// Identifies a file as a baked mesh ("OTM" followed by a null byte)
+	/// </summary>
+	static const uint32_t MAGIC = 0x004D544F;
+	/// <summary>
+	/// The current version of the file format, files with any other version will be rejected
+	/// </summary>
+	static const uint32_t VERSION = 4;
+
+	// We'll disallow moving and copying, since we hold on to a file mapping
+	BakedMesh(const BakedMesh& other) = delete;
+	BakedMesh(BakedMesh&& other) = delete;
+	BakedMesh& operator=(const BakedMesh& other) = delete;
+	BakedMesh& operator=(BakedMesh&& other) = delete;
+
+public:
+	/// <summary>
+	/// Maps a baked mesh file into memory, returning nullptr if the file does not exist, is not a baked
+	/// mesh, or was written with a different version of the format
+	/// </summary>
+	/// <param name="path">The path to the .otm file to open</param>
+	static sptr Open(const std::string& path);
+
+	/// <summary>
+	/// Writes the contents of a mesh builder out to a baked mesh file. Throws a runtime_error if the file cannot be written
+	/// </summary>
+	/// <typeparam name="VertType">The vertex type of the mesh, must have a V_DECL</typeparam>
+	/// <param name="path">The path of the file to write</param>
+	/// <param name="mesh">The mesh to write</param>
+	/// <param name="sourceHash">The hash of the file the mesh was loaded from, see Hash</param>
+	/// <param name="optionsHash">A hash of any options that affected how the mesh was loaded</param>
+	template <typename VertType>
+	static void Write(const std::string& path, const MeshBuilder<VertType>& mesh, uint64_t sourceHash, uint64_t optionsHash = 0) {
+		WriteRaw(path, mesh.GetVertexDataPtr(), sizeof(VertType), mesh.GetVertexCount(),
+			mesh.GetIndexDataPtr(), mesh.GetIndexCount(), VertType::V_DECL, mesh.CalculateBounds(), mesh.GetVertexDecode(),
+			mesh.GetLods(), sourceHash, optionsHash);
+	}
+	/// <summary>
+	/// Writes raw vertex and index data out to a baked mesh file. Throws a runtime_error if the file cannot be written
+	/// </summary>
+	static void WriteRaw(const std::string& path,
+		const void* vertices, size_t vertexStride, size_t vertexCount,
+		const uint32_t* indices, size_t indexCount,
+		const std::vector<BufferAttribute>& attributes,
+		const MeshBounds& bounds, const VertexDecode& decode,
+		const std::vector<MeshLod>& lods,
+		uint64_t sourceHash, uint64_t optionsHash);
+
+	/// <summary>
+	/// Loads a mesh through it's baked cache. If the cache next to the source file was baked from the same source
+	/// contents and options, it is uploaded straight from the mapping. Otherwise the source is parsed with the given
+	/// function and the result is written back to the cache for next time. If the source file does not exist, a
+	/// pre-baked mesh with matching options will be used on it's own
+	/// </summary>
+	/// <typeparam name="VertType">The vertex type that the parse function generates</typeparam>
+	/// <param name="sourcePath">The path to the source file (ex: models/Chicken1.obj)</param>
+	/// <param name="optionsHash">A hash of any options that will affect the parsed result</param>
+	/// <param name="parse">A function taking (const char* data, size_t size, MeshBuilder&lt;VertType&gt;&amp; mesh) that parses the source file</param>
+	/// <param name="settings">How the parsed mesh is processed before it is cached, see MeshBakeSettings</param>
+	template <typename VertType, typename ParseFunc>
+	static VertexArrayObject::sptr LoadCached(const std::string& sourcePath, uint64_t optionsHash, const ParseFunc& parse,
+		const MeshBakeSettings& settings = MeshBakeSettings()) {
+		return PrepareCached<VertType>(sourcePath, optionsHash, parse, settings)();
+	}
+
+	/// <summary>
+	/// Performs all the CPU side work of LoadCached (reading, validating, parsing and writing the cache), and returns
+	/// a function that uploads the result to the GPU. The preparation can happen on any thread, but the returned
+	/// function must be called on the thread that owns the OpenGL context
+	/// </summary>
+	template <typename VertType, typename ParseFunc>
+	static std::function<VertexArrayObject::sptr()> PrepareCached(const std::string& sourcePath, uint64_t optionsHash, const ParseFunc& parse,
+		const MeshBakeSettings& settings = MeshBakeSettings()) {
+		optionsHash = HashBakeOptions(optionsHash, settings);
+		const std::string cachePath = GetCachePath(sourcePath);
+		MemoryMappedFile source(sourcePath);
+
+		if (!source.IsOpen()) {
+			sptr baked = Open(cachePath);
+			if (baked != nullptr && baked->GetOptionsHash() == optionsHash) {
+				return [baked]() { return baked->Bake(); };
+			}
+			throw std::runtime_error("Failed to open file");
+		}
+
+		const uint64_t sourceHash = Hash(source.GetData(), source.GetSize());
+		sptr baked = Open(cachePath);
+		if (baked != nullptr && baked->GetSourceHash() == sourceHash && baked->GetOptionsHash() == optionsHash) {
+			return [baked]() { return baked->Bake(); };
+		}
+		// The stale cache is still mapped, which would stop Write from replacing it on Windows
+		baked.reset();
+
+		MeshBuilder<VertType> mesh;
+		parse(source.GetData(), source.GetSize(), mesh);
+		_Process(mesh, settings, sourcePath);
+		return _ConvertFormat(std::move(mesh), settings.Format, [&](auto converted) -> std::function<VertexArrayObject::sptr()> {
+			auto result = std::make_shared<decltype(converted)>(std::move(converted));
+			try {
+				Write(cachePath, *result, sourceHash, optionsHash);
+			}
+			catch (const std::runtime_error& e) {
+				// Failing to cache is not fatal, we'll just have to parse again next time
+				LOG_WARN("Could not cache mesh \"{}\": {}", sourcePath, e.what());
+			}
+			return [result]() { return result->Bake(); };
+		});
+	}
+
+	/// <summary>
+	/// Parses a source file with the given function and writes the result to it's baked cache, regardless of
+	/// whether the cache is already up to date. Throws a runtime_error if either file cannot be accessed
+	/// </summary>
+	/// <param name="report">If not null, receives the vertex cache statistics from optimizing the mesh</param>
+	/// <returns>The path of the baked mesh that was written</returns>
+	template <typename VertType, typename ParseFunc>
+	static std::string BakeFile(const std::string& sourcePath, uint64_t optionsHash, const ParseFunc& parse,
+		const MeshBakeSettings& settings = MeshBakeSettings(), MeshOptimizeReport* report = nullptr) {
+		MemoryMappedFile source(sourcePath);
+		if (!source.IsOpen()) {
+			throw std::runtime_error("Failed to open file");
+		}
+
+		MeshBuilder<VertType> mesh;
+		parse(source.GetData(), source.GetSize(), mesh);
+		const MeshOptimizeReport result = _Process(mesh, settings, sourcePath);
+		if (report != nullptr) {
+			*report = result;
+		}
+		optionsHash = HashBakeOptions(optionsHash, settings);
+
+		const std::string cachePath = GetCachePath(sourcePath);
+		const uint64_t sourceHash = Hash(source.GetData(), source.GetSize());
+		_ConvertFormat(std::move(mesh), settings.Format, [&](const auto& converted) {
+			Write(cachePath, converted, sourceHash, optionsHash);
+			return 0;
+		});
+		return cachePath;
+	}
+
+	/// <summary>
+	/// Gets the path of the baked mesh that caches the given source file (ex: models/Chicken1.obj -> models/Chicken1.otm)
+	/// </summary>
+	static std::string GetCachePath(const std::string& sourcePath);
+
+	/// <summary>
+	/// Calculates a 64 bit hash of a block of memory, used to detect changes to source files
+	/// </summary>
+	static uint64_t Hash(const void* data, size_t size, uint64_t seed = 0);
+
+	/// <summary>
+	/// Folds the bake settings (and the versions of the optimizer and simplifier that they use) into the hash of a
+	/// mesh's loader options, so that bakes of a file made with different settings are never mixed up
+	/// </summary>
+	static uint64_t HashBakeOptions(uint64_t optionsHash, const MeshBakeSettings& settings);
+
+public:
+	/// <summary>
+	/// Creates a baked mesh from a file that has already been validated, use Open instead
+	/// </summary>
+	BakedMesh(const MemoryMappedFile::sptr& file);
+	~BakedMesh() = default;
+
+	/// <summary>
+	/// Gets the hash of the source file that this mesh was baked from
+	/// </summary>
+	uint64_t GetSourceHash() const { return _sourceHash; }
+	/// <summary>
+	/// Gets the hash of the loader options that this mesh was baked with
+	/// </summary>
+	uint64_t GetOptionsHash() const { return _optionsHash; }
+
+	/// <summary>
+	/// Gets a pointer to the interleaved vertex data, which points directly into the file mapping
+	/// </summary>
+	const void* GetVertexData() const { return _vertexData; }
+	/// <summary>
+	/// Gets the size of a single vertex, in bytes
+	/// </summary>
+	size_t GetVertexStride() const { return _vertexStride; }
+	/// <summary>
+	/// Gets the number of vertices in the mesh
+	/// </summary>
+	size_t GetVertexCount() const { return _vertexCount; }
+	/// <summary>
+	/// Gets a pointer to the index data, which points directly into the file mapping
+	/// </summary>
+	const uint32_t* GetIndexData() const { return _indexData; }
+	/// <summary>
+	/// Gets the number of indices in the mesh
+	/// </summary>
+	size_t GetIndexCount() const { return _indexCount; }
+	/// <summary>
+	/// Gets the vertex layout that the mesh was baked with
+	/// </summary>
+	const std::vector<BufferAttribute>& GetAttributes() const { return _attributes; }
+	/// <summary>
+	/// Gets the model space bounds of the mesh, as calculated when it was baked
+	/// </summary>
+	const MeshBounds& GetBounds() const { return _bounds; }
+	/// <summary>
+	/// Gets the decode that takes the stored vertex positions to model space, see VertexDecode
+	/// </summary>
+	const VertexDecode& GetVertexDecode() const { return _decode; }
+	/// <summary>
+	/// Gets the levels of detail stored in the index buffer, or an empty list if the mesh only has one level
+	/// </summary>
+	const std::vector<MeshLod>& GetLods() const { return _lods; }
+
+	/// <summary>
+	/// Uploads the mesh to the GPU, straight from the file mapping
+	/// </summary>
+	VertexArrayObject::sptr Bake() const;
+
+private:
+	// Generates the levels of detail for a freshly parsed mesh and optimizes it, as the settings ask for
+	template <typename VertType>
+	static MeshOptimizeReport _Process(MeshBuilder<VertType>& mesh, const MeshBakeSettings& settings, const std::string& sourcePath) {
+		if (!settings.LodErrors.empty()) {
+			const std::vector<MeshLod>& lods = mesh.GenerateLods(settings.LodErrors);
+			LOG_TRACE("Generated {} levels of detail for \"{}\", coarsest has {} of {} triangles", lods.size(), sourcePath,
+				lods.empty() ? 0 : lods.back().IndexCount / 3, lods.empty() ? 0 : lods.front().IndexCount / 3);
+		}
+		MeshOptimizeReport report;
+		if (settings.Optimize) {
+			report = mesh.Optimize();
+			LOG_TRACE("Optimized \"{}\": ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", sourcePath,
+				report.Before.ACMR, report.After.ACMR, report.Before.ATVR, report.After.ATVR);
+		}
+		return report;
+	}
+
+	// Converts a mesh into the given vertex format (choosing one if it is Auto), and passes the result on to func
+	template <typename VertType, typename Func>
+	static auto _ConvertFormat(MeshBuilder<VertType>&& mesh, VertexFormat format, const Func& func) {
+		switch (format == VertexFormat::Auto ? mesh.ChooseVertexFormat() : format) {
+			case VertexFormat::Compact:   return func(mesh.ToCompact());
+			case VertexFormat::Quantized: return func(mesh.ToQuantized());
+			default:                      return func(std::move(mesh));
+		}
+	}
+
+	MemoryMappedFile::sptr _file;
+
+	uint64_t _sourceHash;
+	uint64_t _optionsHash;
+
+	const void*     _vertexData;
+	size_t          _vertexStride;
+	size_t          _vertexCount;
+	const uint32_t* _indexData;
+	size_t          _indexCount;
+
+	std::vector<BufferAttribute> _attributes;
+	MeshBounds                   _bounds;
+	VertexDecode                 _decode;
+	std::vector<MeshLod>         _lods;
+};
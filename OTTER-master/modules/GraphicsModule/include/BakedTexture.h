@@ -0,0 +1,171 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "Texture2DData.h"
+#include "TextureBaker.h"
+#include "TextureBakeSettings.h"
+#include "MemoryMappedFile.h"
+
+/// <summary>
+/// A baked texture is a read-only view into a ".dds" texture file written by TextureBaker. These store every mip level
+/// of a texture in it's final (usually block compressed) format, so the levels can be uploaded straight from the
+/// memory mapped file, without decoding the source image at load time
+///
+/// The files are standard DDS files with a DX10 header, so other tools can open them. Note that rows are stored
+/// bottom to top (the way OpenGL expects them), so they will appear upside down in other viewers. We store the hash
+/// of the source file and the options it was baked with in the header's reserved space, so loaders can tell when the
+/// cached version is out of date
+///
+/// Texture arrays are stored the same way, with one DDS array element per layer (see TextureBaker::BakeArray)
+/// </summary>
+class BakedTexture final
+{
+public:
+	typedef std::shared_ptr<BakedTexture> sptr;
+
+	/// <summary>
+	/// Marks a DDS file as one of ours ("OTTX"), stored in the first reserved value of the header
+	/// </summary>
+	static const uint32_t MAGIC = 0x5854544F;
+	/// <summary>
+	/// The current version of our use of the format, files with any other version will be rejected
+	/// </summary>
+	static const uint32_t VERSION = 1;
+
+	// We'll disallow moving and copying, since we hold on to a file mapping
+	BakedTexture(const BakedTexture& other) = delete;
+	BakedTexture(BakedTexture&& other) = delete;
+	BakedTexture& operator=(const BakedTexture& other) = delete;
+	BakedTexture& operator=(BakedTexture&& other) = delete;
+
+public:
+	/// <summary>
+	/// Maps a baked texture file into memory, returning nullptr if the file does not exist, was not written by us,
+	/// or was written with a different version of the format
+	/// </summary>
+	/// <param name="path">The path to the .dds file to open</param>
+	static sptr Open(const std::string& path);
+
+	/// <summary>
+	/// Writes a baked texture out to a file. Throws a runtime_error if the file cannot be written
+	/// </summary>
+	/// <param name="path">The path of the file to write</param>
+	/// <param name="texture">The baked levels of the texture, see TextureBaker::Bake</param>
+	/// <param name="sourceHash">The hash of the file the texture was loaded from, see BakedMesh::Hash</param>
+	/// <param name="optionsHash">A hash of the settings that the texture was baked with, see HashBakeSettings</param>
+	static void Write(const std::string& path, const TextureBakeResult& texture, uint64_t sourceHash, uint64_t optionsHash);
+
+	/// <summary>
+	/// Loads a texture through it's baked cache. If the cache next to the source file was baked from the same source
+	/// contents and settings, the result points straight into the mapping. Otherwise the source is decoded and baked,
+	/// and the result is written back to the cache for next time. If the source file does not exist, a pre-baked
+	/// texture with matching settings will be used on it's own
+	///
+	/// This only does CPU side work, so it can be called from any thread or job. Baking is still slow, so it is best to
+	/// bake ahead of time with the TextureBaker tool
+	/// </summary>
+	/// <param name="sourcePath">The path to the source image (ex: images/grass.jpg)</param>
+	/// <param name="settings">How the texture is baked if the cache is out of date</param>
+	/// <returns>The texture data ready for upload, or nullptr if neither the source nor the cache could be loaded</returns>
+	static Texture2DData::sptr LoadCached(const std::string& sourcePath, const TextureBakeSettings& settings = TextureBakeSettings());
+
+	/// <summary>
+	/// Decodes and bakes a source image and writes the result to it's cache, regardless of whether the cache is already
+	/// up to date. Throws a runtime_error if the source cannot be decoded or the cache cannot be written
+	/// </summary>
+	/// <returns>The path of the baked texture that was written</returns>
+	static std::string BakeFile(const std::string& sourcePath, const TextureBakeSettings& settings = TextureBakeSettings());
+
+	/// <summary>
+	/// Loads a texture array through it's baked cache, see LoadCached. The cache is up to date if it was baked from
+	/// the same list of sources with the same settings. If any of the sources do not exist, a pre-baked array with
+	/// matching settings will be used on it's own
+	/// </summary>
+	/// <param name="cachePath">The path of the baked array (ex: images/props.dds)</param>
+	/// <param name="sourcePaths">The paths of the images to store in each layer, in order</param>
+	/// <param name="settings">How the layers are baked if the cache is out of date</param>
+	/// <returns>The data for each layer ready for upload, or an empty list if the array could not be loaded</returns>
+	static std::vector<Texture2DData::sptr> LoadCachedArray(const std::string& cachePath, const std::vector<std::string>& sourcePaths,
+		const TextureBakeSettings& settings = TextureBakeSettings());
+
+	/// <summary>
+	/// Decodes and bakes a set of images into a texture array, and writes it to the given path. Throws a runtime_error
+	/// if any of the sources cannot be decoded, if they cannot share an array, or if the file cannot be written
+	/// </summary>
+	static void BakeArrayFile(const std::string& cachePath, const std::vector<std::string>& sourcePaths,
+		const TextureBakeSettings& settings = TextureBakeSettings());
+
+	/// <summary>
+	/// Gets the path of the baked texture that caches the given source file (ex: images/grass.jpg -> images/grass.dds)
+	/// </summary>
+	static std::string GetCachePath(const std::string& sourcePath);
+
+	/// <summary>
+	/// Hashes the bake settings, along with the versions of the baker and block compressor that they use, so that
+	/// bakes of a file made with different settings are never mixed up
+	/// </summary>
+	static uint64_t HashBakeSettings(const TextureBakeSettings& settings);
+
+public:
+	/// <summary>
+	/// Creates a baked texture from a file that has already been validated, use Open instead
+	/// </summary>
+	BakedTexture(const MemoryMappedFile::sptr& file);
+	~BakedTexture() = default;
+
+	/// <summary>
+	/// Gets the hash of the source file that this texture was baked from
+	/// </summary>
+	uint64_t GetSourceHash() const { return _sourceHash; }
+	/// <summary>
+	/// Gets the hash of the settings that this texture was baked with
+	/// </summary>
+	uint64_t GetOptionsHash() const { return _optionsHash; }
+	/// <summary>
+	/// Gets the format that the levels are stored in
+	/// </summary>
+	InternalFormat GetFormat() const { return _format; }
+	/// <summary>
+	/// Gets the size and location of each mip level, relative to the start of it's layer in GetLevelData
+	/// </summary>
+	const std::vector<Texture2DLevel>& GetLevels() const { return _levels; }
+	/// <summary>
+	/// Gets the number of layers in the texture, this is 1 unless the texture is an array
+	/// </summary>
+	uint32_t GetLayerCount() const { return _layerCount; }
+	/// <summary>
+	/// Gets a pointer to the start of the level data, which points directly into the file mapping
+	/// </summary>
+	const void* GetLevelData() const { return _levelData; }
+
+	/// <summary>
+	/// Creates texture data that refers to the levels of one layer in the file mapping, keeping the mapping alive for
+	/// as long as the data is
+	/// </summary>
+	/// <param name="debugName">The name to give the data</param>
+	/// <param name="layer">The layer to get, for texture arrays</param>
+	Texture2DData::sptr GetData(const std::string& debugName = "", uint32_t layer = 0) const;
+
+private:
+	// Decodes and bakes a source image, throwing a runtime_error if it can't be decoded
+	static std::shared_ptr<TextureBakeResult> _Bake(const MemoryMappedFile& source, const std::string& sourcePath, const TextureBakeSettings& settings);
+	// Decodes and bakes the layers of a texture array, throwing a runtime_error if they can't be decoded or combined
+	static std::shared_ptr<TextureBakeResult> _BakeArray(const std::vector<MemoryMappedFile::sptr>& sources,
+		const std::vector<std::string>& sourcePaths, const TextureBakeSettings& settings);
+	// Opens all the sources of a texture array and hashes them together, returning false if any are missing
+	static bool _OpenSources(const std::vector<std::string>& sourcePaths, std::vector<MemoryMappedFile::sptr>& sources, uint64_t& hash);
+
+	MemoryMappedFile::sptr _file;
+
+	uint64_t _sourceHash;
+	uint64_t _optionsHash;
+
+	InternalFormat              _format;
+	std::vector<Texture2DLevel> _levels;
+	uint32_t                    _layerCount;
+	size_t                      _layerSize;
+	const void*                 _levelData;
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+#include "TextureEnums.h"
+
+/// <summary>
+/// Encodes images into the BC (DXT) block compressed formats. Each format stores 4x4 blocks of texels in a fixed
+/// number of bytes, which the GPU decodes as it samples, so compressed textures use a quarter to an eighth of the
+/// memory and bandwidth of RGBA8. The encoders are:
+///
+///		BC1 fits a line through the block's colors along their principal axis, then refines the endpoints with a
+///		least squares fit to the chosen indices
+///
+///		BC4 uses the block's range as endpoints, with 8 interpolated values. BC3 and BC5 are built from BC1 and BC4 blocks
+///
+///		BC7 only uses mode 6 (a single RGBA line with 7 bit endpoints, per-endpoint p-bits and 16 interpolated values),
+///		which is fast to encode and handles both opaque and transparent blocks well
+///
+/// All of the encoders are deterministic, so baked textures are reproducible
+/// </summary>
+class BlockCompressor
+{
+public:
+	/// <summary>
+	/// Bumped whenever the output of the encoders changes, so that baked textures from older versions get re-baked
+	/// </summary>
+	static const uint32_t VERSION = 1;
+
+	/// <summary>
+	/// Encodes a single block of opaque RGB texels as BC1
+	/// </summary>
+	/// <param name="rgba">The 16 texels of the block in row order, as 4 bytes each (alpha is ignored)</param>
+	/// <param name="output">Receives the 8 byte block</param>
+	static void EncodeBC1(const uint8_t* rgba, uint8_t* output);
+	/// <summary>
+	/// Encodes a single block of RGBA texels as BC3, see EncodeBC1 for the layout of the input
+	/// </summary>
+	/// <param name="output">Receives the 16 byte block</param>
+	static void EncodeBC3(const uint8_t* rgba, uint8_t* output);
+	/// <summary>
+	/// Encodes a single block of one channel as BC4
+	/// </summary>
+	/// <param name="values">The 16 values of the block in row order</param>
+	/// <param name="stride">The distance between values, in bytes (ex: 4 to encode one channel of RGBA texels)</param>
+	/// <param name="output">Receives the 8 byte block</param>
+	static void EncodeBC4(const uint8_t* values, size_t stride, uint8_t* output);
+	/// <summary>
+	/// Encodes a single block of RG texels as BC5
+	/// </summary>
+	/// <param name="rg">The 16 texels of the block in row order</param>
+	/// <param name="stride">The distance between texels, in bytes</param>
+	/// <param name="output">Receives the 16 byte block</param>
+	static void EncodeBC5(const uint8_t* rg, size_t stride, uint8_t* output);
+	/// <summary>
+	/// Encodes a single block of RGBA texels as BC7, see EncodeBC1 for the layout of the input
+	/// </summary>
+	/// <param name="output">Receives the 16 byte block</param>
+	static void EncodeBC7(const uint8_t* rgba, uint8_t* output);
+
+	/// <summary>
+	/// Compresses a whole image, splitting the rows of blocks across the job system. Images that are not a
+	/// multiple of 4 texels in size have their edge blocks padded by repeating the last row and column
+	/// </summary>
+	/// <param name="pixels">The image, with rows packed tightly together</param>
+	/// <param name="width">The width of the image, in texels</param>
+	/// <param name="height">The height of the image, in texels</param>
+	/// <param name="channels">The number of 8 bit channels in each texel (1, 2 or 4)</param>
+	/// <param name="format">The compressed format to encode to</param>
+	/// <param name="output">Receives the blocks, must be GetLevelSize(format, width, height) bytes</param>
+	static void Compress(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels, InternalFormat format, uint8_t* output);
+};
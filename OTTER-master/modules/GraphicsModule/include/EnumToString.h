@@ -137,7 +137,7 @@ inline std::string GetVals(const std::string& text, int& base) {
 			}
 		} else if (base == 16) {
 			char l = std::tolower(text[ix]);
-			if (l >= 'a' && l <= 'e') {
+			if (l >= 'a' && l <= 'f') {
 				number.push_back(l);
 			}
 		}
@@ -0,0 +1,149 @@
+#pragma once
+#include <memory>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+#include "Framebuffer.h"
+
+/// <summary>
+/// The contents of a framebuffer that were read back to the CPU, as RGBA8 with rows stored bottom to top (the way
+/// OpenGL reads them)
+/// </summary>
+struct CapturedFrame
+{
+	/// <summary>
+	/// The frame number that was passed along with the capture request
+	/// </summary>
+	uint64_t             Frame = 0;
+	uint32_t             Width = 0;
+	uint32_t             Height = 0;
+	std::vector<uint8_t> Pixels;
+};
+
+/// <summary>
+/// The result of comparing two captured frames, see FrameCapture::Compare
+/// </summary>
+struct FrameDifference
+{
+	/// <summary>
+	/// The number of pixels where any channel differs by more than the tolerance
+	/// </summary>
+	uint32_t DifferentPixels = 0;
+	/// <summary>
+	/// The largest difference in any channel of any pixel
+	/// </summary>
+	uint32_t MaxDifference = 0;
+	/// <summary>
+	/// The peak signal to noise ratio across all the channels, in dB (infinite if the frames are identical)
+	/// </summary>
+	double   Psnr = 0.0;
+};
+
+/// <summary>
+/// Reads frames back from the GPU without stalling the pipeline. Each request copies the color attachment of a
+/// framebuffer into one of a ring of pixel buffer objects, and places a fence behind it. The copy happens whenever the
+/// GPU gets to it, and Poll collects the frames whose fences have passed, so the CPU only waits on a frame that is
+/// a few frames old (if at all). With enough buffers to cover the frames that the driver queues up, capturing every
+/// frame costs little more than the memcpy out of the mapped buffer
+///
+/// Frames are always returned in the order they were requested
+/// </summary>
+class FrameCapture final
+{
+public:
+	// We'll disallow moving and copying, since we own the pixel buffers
+	FrameCapture(const FrameCapture& other) = delete;
+	FrameCapture(FrameCapture&& other) = delete;
+	FrameCapture& operator=(const FrameCapture& other) = delete;
+	FrameCapture& operator=(FrameCapture&& other) = delete;
+
+	typedef std::shared_ptr<FrameCapture> sptr;
+	static inline sptr Create(uint32_t bufferCount = 3) {
+		return std::make_shared<FrameCapture>(bufferCount);
+	}
+
+public:
+	/// <summary>
+	/// Creates a new frame capture with the given number of pixel buffers, which is the most frames that can be in
+	/// flight at once
+	/// </summary>
+	FrameCapture(uint32_t bufferCount = 3);
+	~FrameCapture();
+
+	/// <summary>
+	/// Starts reading back the color of a framebuffer. This only queues up the copy, the frame is returned later by
+	/// Poll or Flush
+	/// </summary>
+	/// <param name="framebuffer">The framebuffer to read from</param>
+	/// <param name="frame">A number to identify the frame with when it is returned</param>
+	/// <returns>False if every buffer is waiting on an earlier frame, in which case nothing is read</returns>
+	bool Request(const Framebuffer& framebuffer, uint64_t frame);
+
+	/// <summary>
+	/// Collects the frames that have finished copying, without waiting on any that have not
+	/// </summary>
+	/// <param name="results">The list to append the finished frames to</param>
+	/// <returns>The number of frames that were appended</returns>
+	size_t Poll(std::vector<CapturedFrame>& results);
+	/// <summary>
+	/// Waits for every frame that has been requested to finish copying, and collects them
+	/// </summary>
+	/// <param name="results">The list to append the frames to</param>
+	/// <returns>The number of frames that were appended</returns>
+	size_t Flush(std::vector<CapturedFrame>& results);
+
+	/// <summary>
+	/// Gets the number of frames that have been requested, but not yet collected
+	/// </summary>
+	uint32_t GetPendingCount() const { return _pending; }
+	/// <summary>
+	/// Gets the number of pixel buffers, the most frames that can be in flight at once
+	/// </summary>
+	uint32_t GetBufferCount() const { return static_cast<uint32_t>(_slots.size()); }
+
+	/// <summary>
+	/// Reads the color of a framebuffer back immediately, stalling until everything drawn to it has finished. This
+	/// is mostly useful to compare against, Request should be used for regular captures
+	/// </summary>
+	static CapturedFrame ReadNow(const Framebuffer& framebuffer, uint64_t frame = 0);
+
+	/// <summary>
+	/// Writes a captured frame to a PNG file, flipping it so that it appears the right way up. Throws a
+	/// runtime_error if the file cannot be written
+	/// </summary>
+	static void WritePng(const std::string& path, const CapturedFrame& frame);
+	/// <summary>
+	/// Loads a frame from a PNG file written by WritePng, returning an empty frame if it could not be loaded
+	/// </summary>
+	static CapturedFrame ReadPng(const std::string& path);
+
+	/// <summary>
+	/// Compares two frames, for image-diff tests. Frames of different sizes count every pixel as different
+	/// </summary>
+	/// <param name="a">The first frame</param>
+	/// <param name="b">The frame to compare against</param>
+	/// <param name="tolerance">How much a channel may differ by before the pixel counts as different</param>
+	static FrameDifference Compare(const CapturedFrame& a, const CapturedFrame& b, uint32_t tolerance = 0);
+
+private:
+	struct Slot {
+		GLuint   Buffer = 0;
+		GLsync   Fence = nullptr;
+		size_t   Capacity = 0;
+		uint64_t Frame = 0;
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+	};
+
+	std::vector<Slot> _slots;
+	// The slot that the next request will use
+	uint32_t          _next;
+	// The number of slots that are waiting to be collected, the oldest is _pending slots behind _next
+	uint32_t          _pending;
+
+	// Copies the oldest pending frame out of it's buffer, waiting up to the given timeout for it's fence. Returns
+	// false if the fence did not pass in time
+	bool _Collect(std::vector<CapturedFrame>& results, GLuint64 timeout);
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include <memory>
+#include <cstdint>
+#include <entt.hpp>
+
+class TransformSystem;
+
+/// <summary>
+/// Runs the simulation at a fixed rate, no matter how fast we render. Real time is added to an accumulator every
+/// frame, and a fixed step is taken for every FixedTimeStep worth of time in it. Transforms moved during the fixed
+/// steps are then drawn between their last two fixed states (see TransformSystem::SetInterpolation), so a 60 Hz
+/// simulation still looks smooth at 144 Hz, and render frames can be dropped under load without changing gameplay
+///
+/// A frame runs in this order:
+///
+///     scheduler->BeginFrame(registry, glfwGetTime());
+///     while (scheduler->StepFixed()) {
+///         BehaviourBinding::RunPhase(registry, BehaviourPhase::FixedUpdate);
+///     }
+///     BehaviourBinding::RunPhase(registry, BehaviourPhase::Update);
+///     BehaviourBinding::RunPhase(registry, BehaviourPhase::LateUpdate);
+///     // Render, with BehaviourPhase::RenderGUI in the ImGui pass
+///
+/// If the simulation falls behind (ex: after a breakpoint, or when a fixed step costs more than FixedTimeStep), we
+/// take at most MaxSubsteps steps per frame and throw the rest of the time away, rather than taking more and more
+/// steps each frame and never catching up
+/// </summary>
+class FrameScheduler final
+{
+public:
+	typedef std::shared_ptr<FrameScheduler> sptr;
+	static inline sptr Create(float fixedTimeStep = 1.0f / 60.0f, uint32_t maxSubsteps = 5) {
+		return std::make_shared<FrameScheduler>(fixedTimeStep, maxSubsteps);
+	}
+	// We'll disallow moving and copying, since we hold the state of the frame in progress
+	FrameScheduler(const FrameScheduler& other) = delete;
+	FrameScheduler(FrameScheduler&& other) = delete;
+	FrameScheduler& operator=(const FrameScheduler& other) = delete;
+	FrameScheduler& operator=(FrameScheduler&& other) = delete;
+
+	FrameScheduler(float fixedTimeStep, uint32_t maxSubsteps);
+	~FrameScheduler() = default;
+
+	/// <summary>
+	/// The time between fixed steps, in seconds
+	/// </summary>
+	float    FixedTimeStep;
+	/// <summary>
+	/// The most fixed steps we will take in one frame
+	/// </summary>
+	uint32_t MaxSubsteps;
+	/// <summary>
+	/// The longest frame we will simulate, in seconds. Longer frames (like the first frame after loading) are
+	/// treated as if they took this long
+	/// </summary>
+	float    MaxFrameTime;
+	/// <summary>
+	/// True to draw transforms between their fixed states, false to draw them where the last fixed step left them
+	/// </summary>
+	bool     Interpolate;
+
+	/// <summary>
+	/// Starts a frame, working out how much time has passed and updating Timing to match
+	/// </summary>
+	/// <param name="registry">The registry to simulate, it's TransformSystem is the one that gets interpolated</param>
+	/// <param name="now">The current time in seconds (ex: glfwGetTime)</param>
+	void BeginFrame(entt::registry& registry, double now);
+	/// <summary>
+	/// Finishes the previous fixed step (if any) and starts the next one, returning false once the simulation has
+	/// caught up with real time. Once this returns false, transforms are set up to be interpolated for rendering
+	/// </summary>
+	bool StepFixed();
+
+	/// <summary>
+	/// Gets the number of fixed steps taken this frame
+	/// </summary>
+	uint32_t GetStepsThisFrame() const { return _stepsThisFrame; }
+	/// <summary>
+	/// Gets the total number of fixed steps that have been taken
+	/// </summary>
+	uint64_t GetTotalSteps() const { return _totalSteps; }
+	/// <summary>
+	/// Gets the total time that was thrown away because we fell too far behind, in seconds
+	/// </summary>
+	double GetDroppedTime() const { return _droppedTime; }
+	/// <summary>
+	/// Gets how far we are between the last two fixed steps, from 0 to 1
+	/// </summary>
+	float GetAlpha() const { return _alpha; }
+
+private:
+	TransformSystem* _transforms;
+	double           _lastTime;
+	bool             _hasLastTime;
+	double           _accumulator;
+	bool             _inStep;
+	uint32_t         _stepsThisFrame;
+	uint64_t         _totalSteps;
+	double           _droppedTime;
+	float            _alpha;
+};
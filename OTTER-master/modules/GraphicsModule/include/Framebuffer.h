@@ -0,0 +1,86 @@
+#pragma once
+#include <memory>
+#include <cstdint>
+#include <glad/glad.h>
+
+#include "Texture2D.h"
+#include "TextureEnums.h"
+
+struct FramebufferDescription
+{
+	uint32_t       Width;
+	uint32_t       Height;
+	InternalFormat ColorFormat;
+	// True to attach a 24 bit depth and 8 bit stencil buffer
+	bool           HasDepth;
+
+	FramebufferDescription() :
+		Width(0), Height(0),
+		ColorFormat(InternalFormat::RGBA8),
+		HasDepth(true)
+	{ }
+};
+
+/// <summary>
+/// Represents a wrapper around an OpenGL framebuffer object, with a single color texture and an optional depth
+/// buffer. This lets us render somewhere other than a window, either to use the result as a texture, or to render
+/// without a window at all (see HeadlessContext), and read the result back with FrameCapture
+/// </summary>
+class Framebuffer final
+{
+public:
+	// We'll disallow moving and copying, since we want to manually control when the destructor is called
+	// We'll use these classes via pointers
+	Framebuffer(const Framebuffer& other) = delete;
+	Framebuffer(Framebuffer&& other) = delete;
+	Framebuffer& operator=(const Framebuffer& other) = delete;
+	Framebuffer& operator=(Framebuffer&& other) = delete;
+
+	typedef std::shared_ptr<Framebuffer> sptr;
+	static inline sptr Create(const FramebufferDescription& description = FramebufferDescription()) {
+		return std::make_shared<Framebuffer>(description);
+	}
+
+public:
+	/// <summary>
+	/// Creates a new framebuffer with the given description
+	/// </summary>
+	Framebuffer(const FramebufferDescription& description);
+	~Framebuffer();
+
+	/// <summary>
+	/// Binds this framebuffer for drawing and reading, and sets the viewport to cover all of it
+	/// </summary>
+	void Bind() const;
+	/// <summary>
+	/// Binds the default framebuffer (the window, if there is one). Note that this does not restore the viewport
+	/// </summary>
+	static void Unbind();
+
+	/// <summary>
+	/// Resizes the attachments of this framebuffer, if the size has changed. This discards the contents, and replaces
+	/// the color texture, so any references to the old one will no longer be updated
+	/// </summary>
+	void Resize(uint32_t width, uint32_t height);
+
+	/// <summary>
+	/// Gets the texture that color is rendered into
+	/// </summary>
+	const Texture2D::sptr& GetColor() const { return _color; }
+	/// <summary>
+	/// Gets the underlying OpenGL handle for this framebuffer
+	/// </summary>
+	GLuint GetHandle() const { return _handle; }
+
+	uint32_t GetWidth() const { return _description.Width; }
+	uint32_t GetHeight() const { return _description.Height; }
+	const FramebufferDescription& GetDescription() const { return _description; }
+
+private:
+	FramebufferDescription _description;
+	GLuint                 _handle;
+	GLuint                 _depth;
+	Texture2D::sptr        _color;
+
+	void _RecreateAttachments();
+};
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <GLM/glm.hpp>
+
+#include "MeshBounds.h"
+
+/// <summary>
+/// Stores the world space bounds of a set of objects in a structure of arrays layout, so that they can be tested
+/// against a frustum 4 at a time with SIMD instructions. Each object stores the center and extents of it's world
+/// space bounding box, as well as the radius of it's bounding sphere
+/// </summary>
+class BoundsBatch
+{
+public:
+	BoundsBatch() : _count(0) {}
+	~BoundsBatch() = default;
+
+	/// <summary>
+	/// Removes all the objects from the batch, without releasing any memory
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// Adds an object to the batch, transforming it's bounds into world space
+	/// </summary>
+	/// <param name="bounds">The model space bounds of the object's mesh, invalid bounds will never be culled</param>
+	/// <param name="world">The world transform of the object</param>
+	void Push(const MeshBounds& bounds, const glm::mat4& world);
+
+	/// <summary>
+	/// Gets the number of objects in the batch
+	/// </summary>
+	size_t Size() const { return _count; }
+
+protected:
+	friend class Frustum;
+
+	// All arrays are padded to a multiple of 4 elements, so SIMD code never has to deal with a partial group
+	std::vector<float> _centerX, _centerY, _centerZ;
+	std::vector<float> _extentX, _extentY, _extentZ;
+	std::vector<float> _radius;
+	size_t _count;
+};
+
+/// <summary>
+/// Represents the 6 planes of a view frustum, extracted from a view-projection matrix. Plane normals point into the
+/// frustum, so a point is inside if it is in front of all 6 planes
+/// </summary>
+class Frustum
+{
+public:
+	enum class Plane
+	{
+		Left = 0,
+		Right,
+		Bottom,
+		Top,
+		Near,
+		Far
+	};
+	static const int PLANE_COUNT = 6;
+
+	Frustum();
+	/// <summary>
+	/// Creates a frustum from a view-projection matrix (ex: Camera::GetViewProjection)
+	/// </summary>
+	explicit Frustum(const glm::mat4& viewProjection);
+	~Frustum() = default;
+
+	/// <summary>
+	/// Extracts the planes of the frustum from a view-projection matrix
+	/// </summary>
+	void Update(const glm::mat4& viewProjection);
+
+	/// <summary>
+	/// Gets one of the planes of the frustum, in the form (normal.x, normal.y, normal.z, distance)
+	/// </summary>
+	const glm::vec4& GetPlane(Plane plane) const { return _planes[(int)plane]; }
+
+	/// <summary>
+	/// Tests a single object against the frustum
+	/// </summary>
+	/// <param name="bounds">The model space bounds of the object's mesh</param>
+	/// <param name="world">The world transform of the object</param>
+	/// <returns>True if any part of the object may be visible, or if the bounds are invalid</returns>
+	bool Intersects(const MeshBounds& bounds, const glm::mat4& world) const;
+
+	/// <summary>
+	/// Tests all the objects in a batch against the frustum. An object is culled if either it's bounding box or
+	/// bounding sphere is fully behind any of the planes
+	/// </summary>
+	/// <param name="batch">The batch of objects to test</param>
+	/// <param name="visible">Receives one entry per object in the batch, non-zero if the object may be visible</param>
+	/// <returns>The number of visible objects</returns>
+	size_t Cull(const BoundsBatch& batch, std::vector<uint8_t>& visible) const;
+
+protected:
+	glm::vec4 _planes[PLANE_COUNT];
+};
@@ -0,0 +1,134 @@
+#pragma once
+#include <memory>
+#include <cstdint>
+#include <string>
+
+#include "Framebuffer.h"
+
+struct GLFWwindow;
+
+/// <summary>
+/// The ways that a headless context can be created
+/// </summary>
+enum class HeadlessContextApi
+{
+	/// <summary>
+	/// Try each of the APIs below in order, and use the first that gives us a context with the requested version
+	/// </summary>
+	Auto = 0,
+	/// <summary>
+	/// An EGL context with no surface at all (EGL_MESA_platform_surfaceless), which needs neither a display nor a
+	/// GPU, since Mesa falls back to llvmpipe. Only available on platforms that ship EGL (not Windows)
+	/// </summary>
+	Surfaceless,
+	/// <summary>
+	/// The platform's regular context (WGL on Windows) on a hidden window. Dropping Mesa's opengl32.dll next to the
+	/// executable makes this use llvmpipe on machines without a GPU. Windows only, since other platforms build GLFW's
+	/// null platform
+	/// </summary>
+	Native,
+	/// <summary>
+	/// An EGL context on a hidden window, through GLFW. Windows only, like Native
+	/// </summary>
+	EGL,
+	/// <summary>
+	/// Mesa's off-screen software renderer on a hidden window, through GLFW (needs the OSMesa library)
+	/// </summary>
+	OSMesa
+};
+
+/// <summary>
+/// Controls how a headless context is created
+/// </summary>
+struct HeadlessContextSettings
+{
+	/// <summary>
+	/// The size of the framebuffer that we render into
+	/// </summary>
+	uint32_t           Width = 1280;
+	uint32_t           Height = 720;
+	HeadlessContextApi Api = HeadlessContextApi::Auto;
+	/// <summary>
+	/// The minimum OpenGL version that we need, we use direct state access so this defaults to 4.5
+	/// </summary>
+	int                MajorVersion = 4;
+	int                MinorVersion = 5;
+	/// <summary>
+	/// True to request a debug context, so glDebugMessageCallback reports errors
+	/// </summary>
+	bool               Debug = false;
+};
+
+/// <summary>
+/// A headless context is an OpenGL context that renders into a framebuffer object of any size, rather than a window,
+/// so that we can render on machines with no display (and with a software renderer, no GPU), for automated
+/// performance runs and image-diff tests. Once it is created, OpenGL is loaded through glad the same way as for a
+/// window, so Shader, Texture2D, VertexArrayObject and the rest work unchanged
+///
+/// Only one context should be created per thread, since glad's function pointers are global
+/// </summary>
+class HeadlessContext final
+{
+public:
+	// We'll disallow moving and copying, since we own the context
+	HeadlessContext(const HeadlessContext& other) = delete;
+	HeadlessContext(HeadlessContext&& other) = delete;
+	HeadlessContext& operator=(const HeadlessContext& other) = delete;
+	HeadlessContext& operator=(HeadlessContext&& other) = delete;
+
+	typedef std::shared_ptr<HeadlessContext> sptr;
+
+	/// <summary>
+	/// Creates a headless context, makes it current, loads OpenGL and creates the framebuffer to render into
+	/// </summary>
+	/// <param name="settings">How to create the context</param>
+	/// <returns>The new context, or nullptr if none of the allowed APIs could create one</returns>
+	static sptr Create(const HeadlessContextSettings& settings = HeadlessContextSettings());
+
+	~HeadlessContext();
+
+	/// <summary>
+	/// Makes this context current on the calling thread
+	/// </summary>
+	void MakeCurrent();
+
+	/// <summary>
+	/// Gets the framebuffer that this context renders into, bind it before drawing
+	/// </summary>
+	const Framebuffer::sptr& GetFramebuffer() const { return _framebuffer; }
+	/// <summary>
+	/// Gets the API that the context was created with (never Auto)
+	/// </summary>
+	HeadlessContextApi GetApi() const { return _api; }
+	/// <summary>
+	/// Gets the name of the renderer, as reported by OpenGL (ex: llvmpipe)
+	/// </summary>
+	const std::string& GetRenderer() const { return _renderer; }
+	/// <summary>
+	/// Gets the hidden window that holds the context, or nullptr for surfaceless contexts
+	/// </summary>
+	GLFWwindow* GetWindow() const { return _window; }
+
+	/// <summary>
+	/// Gets whether the given API can be used in this build
+	/// </summary>
+	static bool IsApiAvailable(HeadlessContextApi api);
+
+private:
+	HeadlessContext();
+
+	HeadlessContextApi _api;
+	std::string        _renderer;
+	Framebuffer::sptr  _framebuffer;
+
+	// For contexts made through GLFW
+	GLFWwindow*        _window;
+	// For surfaceless contexts, we keep these as void* so EGL's headers don't leak out
+	void*              _eglDisplay;
+	void*              _eglContext;
+
+	bool _CreateSurfaceless(const HeadlessContextSettings& settings);
+	bool _CreateWindowed(const HeadlessContextSettings& settings, HeadlessContextApi api);
+	bool _LoadGL(const HeadlessContextSettings& settings);
+	void _Destroy();
+};
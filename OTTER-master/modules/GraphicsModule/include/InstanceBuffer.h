@@ -0,0 +1,147 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <memory>
+#include <atomic>
+
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// The per-instance data that is streamed to the GPU for instanced rendering
+/// </summary>
+struct InstanceData
+{
+	/// <summary>
+	/// The model (world) matrix of the instance
+	/// </summary>
+	glm::mat4 Model;
+	/// <summary>
+	/// The normal matrix of the instance, stored as a mat4 so each column is 16 byte aligned. Only the upper 3x3 is used
+	/// </summary>
+	glm::mat4 NormalMatrix;
+	/// <summary>
+	/// Extra values for shaders that need more than a transform per instance (ex: the frames to blend between
+	/// in a morph animation), these are all 0 unless they are set when the instance is pushed
+	/// </summary>
+	glm::vec4 Params;
+	/// <summary>
+	/// Values that vary between materials that are otherwise the same, so that they can be drawn in one batch (see
+	/// ShaderMaterial::MaterialParams)
+	/// </summary>
+	glm::vec4 MaterialParams;
+};
+
+/// <summary>
+/// The instance buffer is a persistently mapped ring buffer that stores InstanceData for instanced draw calls. The
+/// buffer is split into one region per frame in flight, and each region is fenced so that we never write over data
+/// that the GPU is still reading from
+///
+/// Instance attributes are fed to the vertex shader starting at ATTRIB_SLOT:
+///		layout(location = 4) in mat4 inInstanceModel;
+///		layout(location = 8) in mat3 inInstanceNormalMatrix;
+///		layout(location = 11) in vec4 inInstanceParams;
+///		layout(location = 12) in vec4 inInstanceMaterialParams;
+/// </summary>
+class InstanceBuffer final
+{
+public:
+	typedef std::shared_ptr<InstanceBuffer> sptr;
+	template <typename ... TArgs>
+	static inline sptr Create(TArgs&&... args) {
+		return std::make_shared<InstanceBuffer>(std::forward<TArgs>(args)...);
+	}
+	// We'll disallow moving and copying, since we want to manually control when the destructor is called
+	InstanceBuffer(const InstanceBuffer& other) = delete;
+	InstanceBuffer(InstanceBuffer&& other) = delete;
+	InstanceBuffer& operator=(const InstanceBuffer& other) = delete;
+	InstanceBuffer& operator=(InstanceBuffer&& other) = delete;
+
+	/// <summary>
+	/// The first vertex attribute slot used by instance data
+	/// </summary>
+	static const GLuint ATTRIB_SLOT = 4;
+	/// <summary>
+	/// The number of vertex attribute slots used by instance data (4 for the model matrix, 3 for the normal matrix,
+	/// 1 for the params and 1 for the material params)
+	/// </summary>
+	static const GLuint ATTRIB_COUNT = 9;
+	/// <summary>
+	/// The VAO binding index that the instance buffer is attached to, this is well above the slots used by vertex data
+	/// </summary>
+	static const GLuint BINDING_INDEX = 15;
+
+public:
+	/// <summary>
+	/// Creates a new instance buffer
+	/// </summary>
+	/// <param name="capacity">The number of instances that can be submitted per frame, the buffer will grow if this is exceeded</param>
+	/// <param name="framesInFlight">The number of frames the GPU may lag behind the CPU</param>
+	InstanceBuffer(uint32_t capacity = 1024, uint32_t framesInFlight = 3);
+	~InstanceBuffer();
+
+	/// <summary>
+	/// Moves to the next region of the buffer, waiting for the GPU if it is still using it. Must be called once per
+	/// frame before any instances are pushed
+	/// </summary>
+	void BeginFrame();
+	/// <summary>
+	/// Marks the end of the frame, fencing the region that was written to
+	/// </summary>
+	void EndFrame();
+
+	/// <summary>
+	/// Writes a single instance into the buffer
+	/// </summary>
+	/// <param name="model">The world matrix of the instance</param>
+	/// <param name="normalMatrix">The normal matrix of the instance</param>
+	/// <param name="params">Extra per-instance values, see InstanceData::Params</param>
+	/// <param name="materialParams">The per-instance values of the instance's material, see InstanceData::MaterialParams</param>
+	/// <returns>
+	/// The index of the instance in the buffer, to be used as the base instance in draw calls. Instances pushed
+	/// during the same frame always have consecutive indices, even if the buffer needs to grow
+	/// </returns>
+	uint32_t Push(const glm::mat4& model, const glm::mat3& normalMatrix, const glm::vec4& params = glm::vec4(0.0f),
+		const glm::vec4& materialParams = glm::vec4(0.0f));
+
+	/// <summary>
+	/// Gets the number of instances that have been pushed since BeginFrame
+	/// </summary>
+	uint32_t GetFrameCount() const { return _head; }
+	/// <summary>
+	/// Gets the number of instances that can be pushed per frame
+	/// </summary>
+	uint32_t GetCapacity() const { return _capacity; }
+	/// <summary>
+	/// Returns the underlying OpenGL handle that this class is wrapping around, note that this will change if the
+	/// buffer needs to grow
+	/// </summary>
+	GLuint GetHandle() const { return _handle; }
+	/// <summary>
+	/// Gets a number that changes every time the underlying buffer is reallocated, and is never shared with another
+	/// instance buffer. GL may hand back the same handle for the new buffer, so VAOs check this rather than the handle
+	/// to know when they need to re-attach the instance attributes
+	/// </summary>
+	uint64_t GetGeneration() const { return _generation; }
+
+protected:
+	GLuint        _handle;
+	uint64_t      _generation;
+	InstanceData* _mapped;
+	uint32_t      _capacity;
+	uint32_t      _frameCount;
+	uint32_t      _frameIndex;
+	uint32_t      _head;
+	// One fence per region, signaled once the GPU is done reading the region
+	GLsync*       _fences;
+
+	// The generation given to the next buffer that is allocated, shared between all instance buffers
+	static std::atomic<uint64_t> _nextGeneration;
+
+	// Creates the underlying buffer and maps it
+	void _Allocate();
+	// Unmaps and deletes the underlying buffer
+	void _Free();
+	// Doubles the capacity of the buffer, this stalls until the GPU is idle so should be rare. Note that the indices
+	// of the instances already pushed this frame are shifted to the start of the new buffer
+	void _Grow();
+};
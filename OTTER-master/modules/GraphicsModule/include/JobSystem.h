@@ -0,0 +1,252 @@
+#pragma once
+#include <cstdint>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <entt.hpp>
+
+struct Job;
+
+/// <summary>
+/// Where a job is allowed to run
+/// </summary>
+enum class JobAffinity
+{
+	/// <summary>
+	/// The job can run on any worker, or on the main thread while it waits
+	/// </summary>
+	Any,
+	/// <summary>
+	/// The job only runs on the main thread (ex: anything touching the GL context), either from
+	/// JobSystem::RunMainThreadJobs or while the main thread waits on a counter
+	/// </summary>
+	MainThread,
+	/// <summary>
+	/// The job only runs on the workers, and is never picked up by the main thread while it waits. Use this for slow
+	/// work that isn't needed this frame (ex: asset decoding), so a Wait on the main thread never gets stuck with it
+	/// </summary>
+	Background
+};
+
+/// <summary>
+/// Counts the jobs in a group that haven't finished yet. Counters are used to wait for a group of jobs, and to make
+/// jobs depend on other jobs (see JobSystem::Run)
+/// </summary>
+class JobCounter final
+{
+public:
+	typedef std::shared_ptr<JobCounter> sptr;
+	static inline sptr Create() {
+		return std::make_shared<JobCounter>();
+	}
+	// We'll disallow moving and copying, since jobs hold on to us
+	JobCounter(const JobCounter& other) = delete;
+	JobCounter(JobCounter&& other) = delete;
+	JobCounter& operator=(const JobCounter& other) = delete;
+	JobCounter& operator=(JobCounter&& other) = delete;
+
+	JobCounter() : _pending(0) { }
+	~JobCounter() = default;
+
+	/// <summary>
+	/// Returns true if every job added to this counter has finished
+	/// </summary>
+	bool IsDone() const { return _pending.load(std::memory_order_acquire) == 0; }
+	/// <summary>
+	/// Gets the number of jobs that haven't finished yet
+	/// </summary>
+	int GetPending() const { return _pending.load(std::memory_order_acquire); }
+
+private:
+	friend class JobSystem;
+	std::atomic<int> _pending;
+	// Jobs that are waiting for this counter to reach zero before they can be scheduled
+	std::mutex        _lock;
+	std::vector<Job*> _dependents;
+};
+
+/// <summary>
+/// The engine's job system. A fixed set of worker threads each own a work stealing (Chase-Lev) deque: jobs pushed
+/// by a worker go to the bottom of it's own deque and are popped from there, while idle workers steal from the top
+/// of everyone else's. The main thread has a deque of it's own, so jobs it pushes can be stolen as well
+///
+/// Waiting on a counter never blocks a thread, the waiting thread runs other jobs until the counter is done. This
+/// means jobs can wait on jobs (ex: a ParallelFor inside of a job) without deadlocking the workers
+///
+/// Call Init once at startup from the main thread, and Shutdown before exiting. If a job is run before Init, the
+/// job system is started with the default worker count, and the calling thread becomes the main thread
+/// </summary>
+class JobSystem final
+{
+public:
+	/// <summary>
+	/// The most worker threads we will create
+	/// </summary>
+	static const size_t MAX_WORKERS = 64;
+
+	/// <summary>
+	/// Usage statistics for one thread, since the last call to ResetStats
+	/// </summary>
+	struct ThreadStats
+	{
+		std::string Name;
+		/// <summary>
+		/// The number of jobs this thread has run
+		/// </summary>
+		uint64_t    JobsRun;
+		/// <summary>
+		/// The number of those jobs that were stolen from another thread
+		/// </summary>
+		uint64_t    Steals;
+		/// <summary>
+		/// The time spent running jobs, in milliseconds
+		/// </summary>
+		double      BusyMs;
+		/// <summary>
+		/// The fraction of the time since ResetStats that was spent running jobs, from 0 to 1
+		/// </summary>
+		float       Utilization;
+	};
+
+	/// <summary>
+	/// Starts the worker threads, the calling thread becomes the main thread
+	/// </summary>
+	/// <param name="workerCount">The number of worker threads, or 0 to use one less than the number of hardware threads</param>
+	static void Init(size_t workerCount = 0);
+	/// <summary>
+	/// Finishes any jobs that are still queued, then stops all the workers
+	/// </summary>
+	static void Shutdown();
+	/// <summary>
+	/// Returns true if the job system has been started
+	/// </summary>
+	static bool IsRunning();
+
+	/// <summary>
+	/// Gets the number of worker threads, not including the main thread
+	/// </summary>
+	static size_t GetWorkerCount();
+	/// <summary>
+	/// Returns true if called from the thread that started the job system
+	/// </summary>
+	static bool IsMainThread();
+	/// <summary>
+	/// Returns true if called from one of the worker threads
+	/// </summary>
+	static bool IsWorkerThread();
+
+	/// <summary>
+	/// Schedules a job. Exceptions thrown from the job are logged and otherwise ignored, use Submit to get them back
+	/// </summary>
+	/// <param name="func">The function to run</param>
+	/// <param name="counter">If set, the counter is incremented now and decremented when the job has finished</param>
+	/// <param name="dependency">If set, the job won't start until this counter reaches zero</param>
+	/// <param name="affinity">Where the job is allowed to run</param>
+	static void Run(std::function<void()> func, const JobCounter::sptr& counter = nullptr,
+		const JobCounter::sptr& dependency = nullptr, JobAffinity affinity = JobAffinity::Any);
+
+	/// <summary>
+	/// Schedules a job, returning a future that will hold the result of the job (or the exception it threw)
+	/// </summary>
+	/// <param name="func">The function to run</param>
+	/// <param name="affinity">Where the job is allowed to run</param>
+	template <typename Func>
+	static auto Submit(Func&& func, JobAffinity affinity = JobAffinity::Any) -> std::future<decltype(func())> {
+		typedef decltype(func()) Result;
+		auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Func>(func));
+		std::future<Result> result = task->get_future();
+		Run([task]() { (*task)(); }, nullptr, nullptr, affinity);
+		return result;
+	}
+
+	/// <summary>
+	/// Runs other jobs on the calling thread until the counter reaches zero. Waiting on MainThread jobs from
+	/// anywhere but the main thread will only return once the main thread has run them, and the main thread skips
+	/// Background jobs while it waits
+	/// </summary>
+	static void Wait(const JobCounter::sptr& counter);
+
+	/// <summary>
+	/// Runs all the MainThread jobs that are ready. Call this from the main thread once per frame
+	/// </summary>
+	/// <returns>The number of jobs that were run</returns>
+	static size_t RunMainThreadJobs();
+
+	/// <summary>
+	/// Splits a range into chunks and runs them across the workers and the calling thread, returning once all of
+	/// them have finished. We make a few more chunks than threads, so that threads that finish early can steal the
+	/// remaining chunks. Safe to call from inside of a job
+	/// </summary>
+	/// <param name="count">The number of items in the range</param>
+	/// <param name="minChunkSize">The smallest number of items worth sending to another thread</param>
+	/// <param name="func">A function taking (size_t begin, size_t end) that processes part of the range</param>
+	static void ParallelFor(size_t count, size_t minChunkSize, const std::function<void(size_t, size_t)>& func);
+
+	/// <summary>
+	/// Invokes func(entity, components&...) for every entity in a view of the registry, split across the job
+	/// system. Single component views are walked in their packed order, so the component must not be empty.
+	/// The function may modify the components it's given, but must not add or remove components
+	/// </summary>
+	/// <param name="registry">The registry to iterate over</param>
+	/// <param name="func">The function to invoke for each entity</param>
+	/// <param name="minChunkSize">The smallest number of entities worth sending to another thread</param>
+	template <typename... Component, typename Func>
+	static void ParallelForEach(entt::registry& registry, const Func& func, size_t minChunkSize = 64) {
+		static_assert(sizeof...(Component) > 0, "ParallelForEach needs at least one component type");
+		auto view = registry.view<Component...>();
+		if constexpr (sizeof...(Component) == 1) {
+			auto* components = view.raw();
+			const entt::entity* entities = view.data();
+			ParallelFor(view.size(), minChunkSize, [&](size_t begin, size_t end) {
+				for (size_t ix = begin; ix < end; ix++) {
+					func(entities[ix], components[ix]);
+				}
+			});
+		} else {
+			// Multi component views can't be indexed, so we gather the entities first
+			const std::vector<entt::entity> entities(view.begin(), view.end());
+			ParallelFor(entities.size(), minChunkSize, [&](size_t begin, size_t end) {
+				for (size_t ix = begin; ix < end; ix++) {
+					func(entities[ix], view.template get<Component>(entities[ix])...);
+				}
+			});
+		}
+	}
+
+	/// <summary>
+	/// While one of these is alive, ParallelFor calls made on the same thread run the whole range on that thread.
+	/// Useful for timing single threaded work, or for callers that are already split across the job system
+	/// </summary>
+	class SerialScope final
+	{
+	public:
+		SerialScope();
+		~SerialScope();
+		SerialScope(const SerialScope& other) = delete;
+		SerialScope& operator=(const SerialScope& other) = delete;
+	};
+
+	/// <summary>
+	/// Gets usage statistics for the main thread (first) and each worker since the last call to ResetStats
+	/// </summary>
+	static std::vector<ThreadStats> GetStats();
+	/// <summary>
+	/// Resets the usage statistics of every thread
+	/// </summary>
+	static void ResetStats();
+
+private:
+	JobSystem() = default;
+
+	static void _Schedule(Job* job);
+	static bool _TryRunOne(int threadIndex);
+	static void _Execute(Job* job, int threadIndex, bool stolen);
+	static void _Finish(const JobCounter::sptr& counter);
+	static void _WorkerLoop(int threadIndex);
+	static void _EnsureRunning();
+};
@@ -0,0 +1,125 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+#include "Shader.h"
+
+/// <summary>
+/// The types of parameters that a material can store
+/// </summary>
+enum class MaterialParamType
+{
+	Unknown = 0,
+	Float,
+	Vec2,
+	Vec3,
+	Vec4,
+	Mat3,
+	Mat4,
+	Int,
+	Texture
+};
+
+/// <summary>
+/// Describes where a single parameter lives in a material's flat parameter block
+/// </summary>
+struct MaterialParam
+{
+	/// <summary>
+	/// The name of the uniform in the shader
+	/// </summary>
+	std::string       Name;
+	/// <summary>
+	/// The location of the uniform in the shader
+	/// </summary>
+	int               Location;
+	/// <summary>
+	/// The type of data stored for the uniform
+	/// </summary>
+	MaterialParamType Type;
+	/// <summary>
+	/// For values, the offset of the value in the material's data block, in bytes. For textures, the index of the
+	/// texture in the material's texture list
+	/// </summary>
+	uint32_t          Offset;
+};
+
+/// <summary>
+/// A material layout is the "compiled" form of a shader's parameters. It lists all of the shader's active uniforms
+/// sorted by location, with a fixed offset in a flat data block for each one, so materials can store their values
+/// contiguously instead of in per-type hash maps. Layouts are shared between all materials that use the same shader
+///
+/// Texture samplers are assigned to consecutive texture units starting at FIRST_TEXTURE_SLOT when the layout is
+/// built, so materials can bind all of their textures with a single glBindTextures call
+/// </summary>
+class MaterialLayout final
+{
+public:
+	typedef std::shared_ptr<MaterialLayout> sptr;
+	MaterialLayout(const MaterialLayout& other) = delete;
+	MaterialLayout(MaterialLayout&& other) = delete;
+	MaterialLayout& operator=(const MaterialLayout& other) = delete;
+	MaterialLayout& operator=(MaterialLayout&& other) = delete;
+
+	/// <summary>
+	/// The first texture unit used by material textures (slot 0 is left free for general use)
+	/// </summary>
+	static const int FIRST_TEXTURE_SLOT = 1;
+
+	/// <summary>
+	/// Gets the layout for a shader, creating it if no material has used the shader yet. The shader must be linked
+	/// </summary>
+	static sptr Get(const Shader::sptr& shader);
+
+	/// <summary>
+	/// Creates a layout for a linked shader, use Get instead to share layouts between materials
+	/// </summary>
+	MaterialLayout(const Shader::sptr& shader);
+	~MaterialLayout() = default;
+
+	/// <summary>
+	/// Finds the index of a parameter by name
+	/// </summary>
+	/// <returns>The index of the parameter, or -1 if the shader does not have an active uniform with that name</returns>
+	int FindParam(const std::string& name) const;
+
+	/// <summary>
+	/// Gets all of the parameters in the layout, sorted by location
+	/// </summary>
+	const std::vector<MaterialParam>& GetParams() const { return _params; }
+	/// <summary>
+	/// Gets the total size of the data block required by materials using this layout, in bytes
+	/// </summary>
+	uint32_t GetDataSize() const { return _dataSize; }
+	/// <summary>
+	/// Gets the number of textures that materials using this layout will bind
+	/// </summary>
+	uint32_t GetTextureCount() const { return _textureCount; }
+	/// <summary>
+	/// Gets the shader that this layout was built for
+	/// </summary>
+	Shader::sptr GetShader() const { return _shader.lock(); }
+	/// <summary>
+	/// Returns true if the layout was built for the given shader
+	/// </summary>
+	bool IsFor(const Shader::sptr& shader) const { return !_shader.expired() && _shader.lock() == shader; }
+
+	/// <summary>
+	/// Gets the size of a single parameter of the given type in the data block, in bytes
+	/// </summary>
+	static uint32_t GetTypeSize(MaterialParamType type);
+
+	// The ID of the last material to upload it's values to the shader. If a material is applied twice in a row, it
+	// only needs to upload the values that changed in between
+	uint64_t LastApplied;
+
+protected:
+	std::weak_ptr<Shader>          _shader;
+	std::vector<MaterialParam>     _params;
+	std::unordered_map<std::string, int> _lookup;
+	uint32_t                       _dataSize;
+	uint32_t                       _textureCount;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <memory>
+
+/// <summary>
+/// Wraps a read-only memory mapping of a file on disk. The file contents can be accessed directly
+/// via GetData() for as long as this object is alive, without copying them into an intermediate buffer
+/// </summary>
+class MemoryMappedFile final
+{
+public:
+	typedef std::shared_ptr<MemoryMappedFile> sptr;
+	static inline sptr Create(const std::string& path) {
+		return std::make_shared<MemoryMappedFile>(path);
+	}
+
+	// We'll disallow moving and copying, since we want to manually control when the mapping is released
+	MemoryMappedFile(const MemoryMappedFile& other) = delete;
+	MemoryMappedFile(MemoryMappedFile&& other) = delete;
+	MemoryMappedFile& operator=(const MemoryMappedFile& other) = delete;
+	MemoryMappedFile& operator=(MemoryMappedFile&& other) = delete;
+
+public:
+	/// <summary>
+	/// Opens and maps the given file for reading. Use IsOpen() to check whether the mapping succeeded
+	/// </summary>
+	/// <param name="path">The path of the file to map</param>
+	MemoryMappedFile(const std::string& path);
+	~MemoryMappedFile();
+
+	/// <summary>
+	/// Returns true if the file was opened and mapped successfully
+	/// </summary>
+	bool IsOpen() const { return _isOpen; }
+	/// <summary>
+	/// Gets a pointer to the start of the file contents, or nullptr if the file is empty or failed to open
+	/// </summary>
+	const char* GetData() const { return _data; }
+	/// <summary>
+	/// Gets the size of the mapped file, in bytes
+	/// </summary>
+	size_t GetSize() const { return _size; }
+
+private:
+	const char* _data;
+	size_t      _size;
+	bool        _isOpen;
+
+	// Platform specific handles (HANDLEs on Windows, a file descriptor elsewhere)
+	void* _fileHandle;
+	void* _mappingHandle;
+	int   _fileDescriptor;
+};
@@ -0,0 +1,25 @@
+#pragma once
+#include <vector>
+
+#include "VertexPacking.h"
+
+/// <summary>
+/// Controls how a loaded mesh is processed before it is baked (see BakedMesh). These settings are part of the
+/// options hash of a baked mesh, so changing them will re-bake any cached meshes
+/// </summary>
+struct MeshBakeSettings
+{
+	/// <summary>
+	/// True to reorder the mesh for the vertex cache, see MeshBuilder::Optimize
+	/// </summary>
+	bool               Optimize = true;
+	/// <summary>
+	/// The vertex format to store the mesh in, by default the smallest one that keeps the mesh accurate
+	/// </summary>
+	VertexFormat       Format = VertexFormat::Auto;
+	/// <summary>
+	/// The error targets for the levels of detail after the full detail mesh, relative to the radius of the mesh's
+	/// bounding sphere. Leave empty to bake the mesh without any LODs, see MeshBuilder::GenerateLods
+	/// </summary>
+	std::vector<float> LodErrors = { 0.004f, 0.012f, 0.03f };
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// Stores the extent of a mesh in model space, as both an axis aligned bounding box and a bounding sphere. The
+/// sphere is centered on the box, so that both volumes can be tested against a plane using the same center point
+///
+/// Default constructed bounds are invalid, which means the extent of the mesh is unknown, and it should never
+/// be culled (ex: skyboxes)
+/// </summary>
+struct MeshBounds
+{
+	/// <summary>
+	/// The minimum corner of the bounding box
+	/// </summary>
+	glm::vec3 Min;
+	/// <summary>
+	/// The maximum corner of the bounding box
+	/// </summary>
+	glm::vec3 Max;
+	/// <summary>
+	/// The radius of the bounding sphere, centered on the middle of the box
+	/// </summary>
+	float     Radius;
+
+	MeshBounds() : Min(glm::vec3(0.0f)), Max(glm::vec3(0.0f)), Radius(-1.0f) {}
+	MeshBounds(const glm::vec3& min, const glm::vec3& max, float radius) : Min(min), Max(max), Radius(radius) {}
+
+	/// <summary>
+	/// Returns true if these bounds actually describe a mesh, false if the extent is unknown
+	/// </summary>
+	bool IsValid() const { return Radius >= 0.0f; }
+
+	/// <summary>
+	/// Gets the center of the bounding box and sphere
+	/// </summary>
+	glm::vec3 GetCenter() const { return (Min + Max) * 0.5f; }
+	/// <summary>
+	/// Gets the half-size of the bounding box along each axis
+	/// </summary>
+	glm::vec3 GetExtents() const { return (Max - Min) * 0.5f; }
+
+	/// <summary>
+	/// Calculates the bounds for a block of interleaved vertex data
+	/// </summary>
+	/// <param name="vertices">A pointer to the first vertex</param>
+	/// <param name="stride">The size of a single vertex, in bytes</param>
+	/// <param name="count">The number of vertices</param>
+	/// <param name="positionOffset">The offset of the vertex position (3 floats) from the start of each vertex</param>
+	/// <returns>The bounds of the vertices, or invalid bounds if count is 0</returns>
+	static MeshBounds FromVertices(const void* vertices, size_t stride, size_t count, size_t positionOffset);
+};
@@ -1,14 +1,35 @@
 #pragma once
 #include <vector>
+#include <cstddef>
 #include <VertexArrayObject.h>
+#include <VertexTypes.h>
+#include <MeshOptimizer.h>
+#include <MeshSimplifier.h>
+#include <MeshLod.h>
 
 template <typename VertType>
 class MeshBuilder
 {
 public:
+	/// <summary>
+	/// The default largest position error (in model units) that ChooseVertexFormat allows when quantizing positions
+	/// </summary>
+	static constexpr float DEFAULT_POSITION_TOLERANCE = 0.0005f;
+	/// <summary>
+	/// The default largest texture coordinate error that ChooseVertexFormat allows, half a texel on a 1024 texture
+	/// </summary>
+	static constexpr float DEFAULT_UV_TOLERANCE = 1.0f / 2048.0f;
+	/// <summary>
+	/// GenerateLods skips any level that does not have at most this fraction of the triangles of the level before it
+	/// </summary>
+	static constexpr float LOD_MIN_REDUCTION = 0.75f;
+
 	MeshBuilder() :
 		_vertices(std::vector<VertType>()),
-		_indices(std::vector<uint32_t>()) {}
+		_indices(std::vector<uint32_t>()),
+		_bounds(MeshBounds()),
+		_decode(VertexDecode()),
+		_lods(std::vector<MeshLod>()) {}
 	~MeshBuilder() = default;
 
 	/// <summary>
@@ -77,10 +98,96 @@ public:
 	/// <summary>
 	/// Returns the number of triangles in this mesh. If the index vector contains data,
 	/// it will calculate the triangle count using that, otherwise it will use the number
-	/// of vertices
+	/// of vertices. This includes the triangles of every level of detail, see GetLods
 	/// </summary>
 	size_t GetTriangleCount() const { return _indices.size() > 0 ? _indices.size() / 3 : _vertices.size() / 3; }
 
+	/// <summary>
+	/// Reorders the triangles and vertices of this mesh so that it is cheaper to draw, see MeshOptimizer. Vertices that
+	/// are not used by any triangle are removed. This should be called after all the vertices and indices have been
+	/// added (and after GenerateLods, each level is optimized on it's own), and does nothing if the mesh is not an
+	/// indexed triangle list
+	/// </summary>
+	/// <param name="overdrawThreshold">How much vertex cache efficiency may be traded for less overdraw, see MeshOptimizer::OptimizeOverdraw</param>
+	/// <returns>The vertex cache statistics of the full detail mesh before and after optimizing</returns>
+	MeshOptimizeReport Optimize(float overdrawThreshold = MeshOptimizer::DEFAULT_OVERDRAW_THRESHOLD) {
+		const size_t baseCount = _lods.empty() ? _indices.size() : _lods[0].IndexCount;
+		MeshOptimizeReport report;
+		report.Before = MeshOptimizer::AnalyzeVertexCache(_indices.data(), baseCount, _vertices.size());
+		if (_indices.size() < 3 || _indices.size() % 3 != 0) {
+			report.After = report.Before;
+			return report;
+		}
+
+		const std::vector<MeshLod> levels = _lods.empty() ? std::vector<MeshLod>{ MeshLod(0, static_cast<uint32_t>(_indices.size()), 0.0f) } : _lods;
+		for (const MeshLod& level : levels) {
+			uint32_t* indices = _indices.data() + level.IndexOffset;
+			MeshOptimizer::OptimizeVertexCache(indices, level.IndexCount, _vertices.size());
+			MeshOptimizer::OptimizeOverdraw(indices, level.IndexCount, _vertices.data(), sizeof(VertType), _vertices.size(),
+				offsetof(VertType, Position), overdrawThreshold);
+		}
+
+		std::vector<uint32_t> remap;
+		std::vector<VertType> vertices(MeshOptimizer::OptimizeVertexFetch(_indices.data(), _indices.size(), _vertices.size(), remap));
+		for (size_t ix = 0; ix < _vertices.size(); ix++) {
+			if (remap[ix] != MeshOptimizer::UNUSED) {
+				vertices[remap[ix]] = _vertices[ix];
+			}
+		}
+		_vertices = std::move(vertices);
+
+		report.After = MeshOptimizer::AnalyzeVertexCache(_indices.data(), baseCount, _vertices.size());
+		return report;
+	}
+
+	/// <summary>
+	/// Builds a chain of simplified versions of this mesh, see MeshSimplifier. The levels share this mesh's vertices,
+	/// and their triangles are appended to the index buffer after the full detail triangles. Levels that would not
+	/// remove enough triangles to be worth drawing are skipped. Calling this again replaces the existing levels. Only
+	/// available for indexed vertex types with a Position and Normal
+	/// </summary>
+	/// <param name="errors">The largest distance each level may move from the full detail surface, relative to the radius of the mesh's bounding sphere</param>
+	/// <returns>The levels of the mesh, including the full detail level, or an empty list if no levels were generated</returns>
+	const std::vector<MeshLod>& GenerateLods(const std::vector<float>& errors) {
+		if (!_lods.empty()) {
+			_indices.resize(_lods[0].IndexCount);
+			_lods.clear();
+		}
+		const MeshBounds bounds = CalculateBounds();
+		if (_indices.size() < 3 || _indices.size() % 3 != 0 || !bounds.IsValid()) {
+			return _lods;
+		}
+
+		const size_t baseCount = _indices.size();
+		_lods.emplace_back(0, static_cast<uint32_t>(baseCount), 0.0f);
+		std::vector<uint32_t> level(baseCount);
+		for (float error : errors) {
+			if (_lods.size() >= MeshLod::MAX_LODS) {
+				break;
+			}
+			// Each level is simplified from the full detail mesh, so errors do not build up along the chain
+			float resultError = 0.0f;
+			const size_t count = MeshSimplifier::Simplify(level.data(), _indices.data(), baseCount, _vertices.data(), sizeof(VertType),
+				_vertices.size(), offsetof(VertType, Position), offsetof(VertType, Normal), 0, error * bounds.Radius, &resultError);
+			if (count == 0 || count > _lods.back().IndexCount * LOD_MIN_REDUCTION) {
+				continue;
+			}
+			_lods.emplace_back(static_cast<uint32_t>(_indices.size()), static_cast<uint32_t>(count), resultError);
+			_indices.insert(_indices.end(), level.begin(), level.begin() + count);
+		}
+
+		// A single level is the same as having no levels at all
+		if (_lods.size() == 1) {
+			_lods.clear();
+		}
+		return _lods;
+	}
+
+	/// <summary>
+	/// Gets the levels of detail of this mesh, or an empty list if it only has the full detail mesh, see GenerateLods
+	/// </summary>
+	const std::vector<MeshLod>& GetLods() const { return _lods; }
+
 	VertexArrayObject::sptr Bake() {
 		VertexBuffer::sptr vbo = VertexBuffer::Create();
 		vbo->LoadData(GetVertexDataPtr(), _vertices.size());
@@ -91,10 +198,86 @@ public:
 		VertexArrayObject::sptr result = VertexArrayObject::Create();
 		result->AddVertexBuffer(vbo, VertType::V_DECL);
 		result->SetIndexBuffer(ebo);
+		result->SetBounds(CalculateBounds());
+		result->SetVertexDecode(_decode);
+		result->SetLods(_lods);
 
 		return result;
 	}
 	
+	/// <summary>
+	/// Calculates the model space bounds of the vertices in this mesh. Converted meshes keep the bounds of the mesh
+	/// they were converted from, since their positions may not be stored as floats
+	/// </summary>
+	MeshBounds CalculateBounds() const {
+		if (_bounds.IsValid()) {
+			return _bounds;
+		}
+		return MeshBounds::FromVertices(_vertices.data(), sizeof(VertType), _vertices.size(), offsetof(VertType, Position));
+	}
+
+	/// <summary>
+	/// Gets the decode that takes the positions stored in the vertices back to model space, this is only
+	/// needed for quantized meshes (see ToQuantized)
+	/// </summary>
+	const VertexDecode& GetVertexDecode() const { return _decode; }
+
+	/// <summary>
+	/// Picks the smallest vertex format that can store this mesh without going over the given errors. Half float UVs
+	/// lose precision as they get further from 0, so meshes with tiled UVs may need to stay as floats. Only available
+	/// for vertex types with a Position, Normal, UV and Color
+	/// </summary>
+	/// <param name="positionTolerance">The largest error allowed in vertex positions, in model units</param>
+	/// <param name="uvTolerance">The largest error allowed in texture coordinates</param>
+	/// <returns>Quantized, Compact or Float</returns>
+	VertexFormat ChooseVertexFormat(float positionTolerance = DEFAULT_POSITION_TOLERANCE, float uvTolerance = DEFAULT_UV_TOLERANCE) const {
+		float maxUV = 0.0f;
+		for (const VertType& vertex : _vertices) {
+			maxUV = glm::max(maxUV, glm::max(glm::abs(vertex.UV.x), glm::abs(vertex.UV.y)));
+		}
+		if (VertexPacking::HalfError(maxUV) > uvTolerance) {
+			return VertexFormat::Float;
+		}
+
+		// A 16 bit position is off by at most half a step, and there are 32767 steps on either side of the center
+		const MeshBounds bounds = CalculateBounds();
+		const glm::vec3 halfSize = bounds.IsValid() ? bounds.GetExtents() : glm::vec3(0.0f);
+		const float positionError = glm::max(halfSize.x, glm::max(halfSize.y, halfSize.z)) / 32767.0f * 0.5f;
+		return positionError <= positionTolerance ? VertexFormat::Quantized : VertexFormat::Compact;
+	}
+
+	/// <summary>
+	/// Creates a copy of this mesh with VertexPosNormTexColCompact vertices, which are half the size of VertexPosNormTexCol
+	/// </summary>
+	MeshBuilder<VertexPosNormTexColCompact> ToCompact() const {
+		MeshBuilder<VertexPosNormTexColCompact> result;
+		result._vertices.reserve(_vertices.size());
+		for (const VertType& vertex : _vertices) {
+			result._vertices.emplace_back(vertex.Position, vertex.Normal, vertex.UV, vertex.Color);
+		}
+		result._indices = _indices;
+		result._lods = _lods;
+		result._bounds = CalculateBounds();
+		return result;
+	}
+
+	/// <summary>
+	/// Creates a copy of this mesh with VertexPosNormTexColQuantized vertices, where positions are stored relative
+	/// to the bounds of the mesh
+	/// </summary>
+	MeshBuilder<VertexPosNormTexColQuantized> ToQuantized() const {
+		MeshBuilder<VertexPosNormTexColQuantized> result;
+		result._bounds = CalculateBounds();
+		result._decode = result._bounds.IsValid() ? VertexPacking::MakePositionDecode(result._bounds.Min, result._bounds.Max) : VertexDecode();
+		result._vertices.reserve(_vertices.size());
+		for (const VertType& vertex : _vertices) {
+			result._vertices.emplace_back(vertex.Position, result._decode, vertex.Normal, vertex.UV, vertex.Color);
+		}
+		result._indices = _indices;
+		result._lods = _lods;
+		return result;
+	}
+	
 	/// <summary>
 	/// Gets a pointer to the underlying vertex data in the mesh, valid only
 	/// until another call to AddVertex
@@ -112,7 +295,16 @@ public:
 	
 protected:
 	friend class MeshFactory;
+	friend class ObjLoader;
+	template <typename OtherType>
+	friend class MeshBuilder;
 	
 	std::vector<VertType> _vertices;
 	std::vector<uint32_t> _indices;
+
+	// Only set for converted meshes, see CalculateBounds and GetVertexDecode
+	MeshBounds   _bounds;
+	VertexDecode _decode;
+	// The levels of detail in the index buffer, see GenerateLods
+	std::vector<MeshLod> _lods;
 };
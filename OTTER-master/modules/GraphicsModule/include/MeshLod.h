@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+/// <summary>
+/// A single level of detail of a mesh. All of the levels of a mesh share it's vertex buffer, and are stored one after
+/// another in it's index buffer, from the full detail mesh (level 0) to the coarsest
+/// </summary>
+struct MeshLod
+{
+	/// <summary>
+	/// The most levels a single mesh can have, including the full detail level
+	/// </summary>
+	static const uint32_t MAX_LODS = 8;
+
+	/// <summary>
+	/// The index of the first index of this level within the index buffer
+	/// </summary>
+	uint32_t IndexOffset;
+	/// <summary>
+	/// The number of indices in this level, 3 per triangle
+	/// </summary>
+	uint32_t IndexCount;
+	/// <summary>
+	/// The largest distance between this level and the full detail mesh, in model units (0 for the full detail mesh)
+	/// </summary>
+	float    Error;
+
+	MeshLod() : IndexOffset(0), IndexCount(0), Error(0.0f) {}
+	MeshLod(uint32_t indexOffset, uint32_t indexCount, float error) : IndexOffset(indexOffset), IndexCount(indexCount), Error(error) {}
+
+	/// <summary>
+	/// Picks the coarsest level whose error stays under the given number of pixels on screen. Switching to a finer
+	/// level happens as soon as the current level is over the limit, but switching to a coarser one waits until that
+	/// level is well under it, so objects sitting near a threshold do not pop back and forth between levels
+	/// </summary>
+	/// <param name="lods">The levels of the mesh, may be empty</param>
+	/// <param name="boundsRadius">The radius of the mesh's bounding sphere, in model units</param>
+	/// <param name="current">The level that was picked last time</param>
+	/// <param name="projectedRadius">The radius of the mesh's bounding sphere on screen, in pixels</param>
+	/// <param name="pixelError">The largest on-screen error allowed, in pixels</param>
+	/// <param name="hysteresis">How far under the limit (as a fraction of it) a coarser level must be before switching to it</param>
+	static uint32_t Select(const std::vector<MeshLod>& lods, float boundsRadius, uint32_t current, float projectedRadius,
+		float pixelError, float hysteresis) {
+		if (lods.empty() || boundsRadius <= 0.0f) {
+			return 0;
+		}
+		// The error of each level is in model units, so scale it by how many pixels a model unit covers
+		const float pixelsPerUnit = projectedRadius / boundsRadius;
+		uint32_t result = std::min(current, static_cast<uint32_t>(lods.size() - 1));
+		while (result > 0 && lods[result].Error * pixelsPerUnit > pixelError) {
+			result--;
+		}
+		while (result + 1 < lods.size() && lods[result + 1].Error * pixelsPerUnit <= pixelError * (1.0f - hysteresis)) {
+			result++;
+		}
+		return result;
+	}
+};
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/// <summary>
+/// Describes how well an index buffer uses the GPU's post-transform vertex cache, as measured by simulating a FIFO
+/// cache of a given size
+/// </summary>
+struct VertexCacheStats
+{
+	/// <summary>
+	/// The number of vertices that had to be transformed, since they were not in the cache
+	/// </summary>
+	size_t CacheMisses;
+	/// <summary>
+	/// Average cache miss ratio, the number of vertices transformed per triangle. Ranges from 3 (no reuse at all) down
+	/// to around 0.5 for a large, perfectly ordered grid
+	/// </summary>
+	float  ACMR;
+	/// <summary>
+	/// Average transform to vertex ratio, the number of times each vertex is transformed. 1 is the best possible
+	/// </summary>
+	float  ATVR;
+
+	VertexCacheStats() : CacheMisses(0), ACMR(0.0f), ATVR(0.0f) {}
+};
+
+/// <summary>
+/// The vertex cache statistics of a mesh before and after being optimized
+/// </summary>
+struct MeshOptimizeReport
+{
+	VertexCacheStats Before;
+	VertexCacheStats After;
+};
+
+/// <summary>
+/// Reorders the triangles and vertices of indexed triangle meshes so that they are cheaper for the GPU to draw. This
+/// is done in three passes, which should be run in order:
+///
+///		OptimizeVertexCache reorders triangles so that vertices are reused while they are still in the post-transform
+///		cache (Forsyth's linear-speed vertex cache optimization)
+///
+///		OptimizeOverdraw splits the result into clusters that each still use the cache well, and sorts the clusters so
+///		that those facing out from the middle of the mesh are drawn first, reducing overdraw (Sander et al, "Fast
+///		Triangle Reordering for Vertex Locality and Reduced Overdraw")
+///
+///		OptimizeVertexFetch renumbers the vertices in the order they are first used, so that vertex fetches walk
+///		through memory in order
+///
+/// All of the passes are deterministic, the same input will always produce the same output, so baked meshes are
+/// reproducible. See MeshBuilder::Optimize to run them all on a mesh
+/// </summary>
+class MeshOptimizer
+{
+public:
+	/// <summary>
+	/// Bumped whenever the output of the optimizer changes, so that baked meshes from older versions get re-baked
+	/// </summary>
+	static const uint32_t VERSION = 1;
+	/// <summary>
+	/// The size of the FIFO cache used when measuring meshes, most GPUs have a post-transform cache of at least this size
+	/// </summary>
+	static const size_t FIFO_CACHE_SIZE = 16;
+	/// <summary>
+	/// The default amount that a cluster's ACMR may exceed the ACMR of the whole mesh in OptimizeOverdraw
+	/// </summary>
+	static constexpr float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+	/// <summary>
+	/// Marks vertices that are not used by any triangle in a remap table
+	/// </summary>
+	static const uint32_t UNUSED = 0xFFFFFFFFu;
+
+	/// <summary>
+	/// Measures how well an index buffer uses a FIFO vertex cache
+	/// </summary>
+	/// <param name="indices">The index buffer, 3 indices per triangle</param>
+	/// <param name="indexCount">The number of indices in the buffer</param>
+	/// <param name="vertexCount">The number of vertices that the indices refer to</param>
+	/// <param name="cacheSize">The number of vertices in the simulated cache</param>
+	static VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize = FIFO_CACHE_SIZE);
+
+	/// <summary>
+	/// Reorders the triangles in an index buffer to make better use of the post-transform vertex cache. The vertices
+	/// of each triangle keep their winding order
+	/// </summary>
+	/// <param name="indices">The index buffer to reorder in place, 3 indices per triangle</param>
+	/// <param name="indexCount">The number of indices in the buffer</param>
+	/// <param name="vertexCount">The number of vertices that the indices refer to</param>
+	static void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+	/// <summary>
+	/// Reorders clusters of triangles to reduce overdraw, while keeping most of the vertex cache efficiency from
+	/// OptimizeVertexCache (which should be run first)
+	/// </summary>
+	/// <param name="indices">The index buffer to reorder in place, 3 indices per triangle</param>
+	/// <param name="indexCount">The number of indices in the buffer</param>
+	/// <param name="vertices">A pointer to the first vertex</param>
+	/// <param name="stride">The size of a single vertex, in bytes</param>
+	/// <param name="vertexCount">The number of vertices</param>
+	/// <param name="positionOffset">The offset of the vertex position (3 floats) from the start of each vertex</param>
+	/// <param name="threshold">How much worse than the whole mesh each cluster's ACMR may be, larger values make
+	/// smaller clusters, which reduces overdraw further at the cost of more cache misses</param>
+	static void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const void* vertices, size_t stride, size_t vertexCount,
+		size_t positionOffset, float threshold = DEFAULT_OVERDRAW_THRESHOLD);
+
+	/// <summary>
+	/// Renumbers the vertices so that they appear in the order they are first used by the index buffer. The indices are
+	/// rewritten in place, and the vertices need to be moved to match with the returned remap table
+	/// </summary>
+	/// <param name="indices">The index buffer to rewrite, 3 indices per triangle</param>
+	/// <param name="indexCount">The number of indices in the buffer</param>
+	/// <param name="vertexCount">The number of vertices that the indices refer to</param>
+	/// <param name="remap">Receives the new index of each vertex, or UNUSED if no triangle uses it</param>
+	/// <returns>The number of vertices that are used, which is the size the vertex buffer should be shrunk to</returns>
+	static size_t OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& remap);
+
+protected:
+	MeshOptimizer() = default;
+	~MeshOptimizer() = default;
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// Simplifies indexed triangle meshes by collapsing edges, using the quadric error metric (Garland and Heckbert,
+/// "Surface Simplification Using Quadric Error Metrics") to pick the collapses that change the surface the least
+///
+/// Only the index buffer is rewritten, each collapse moves one vertex onto one of it's neighbours, so every level of
+/// detail can share the vertex buffer of the original mesh. The simplifier keeps the things that make a simplified
+/// mesh look wrong:
+///
+///		Vertices with the same position but different attributes (UV seams, hard normal edges) are collapsed together,
+///		and only ever along the seam, so seams never tear open or get stretched across the mesh
+///
+///		Mesh borders only move along themselves, and vertices where several borders or seams meet are never moved
+///
+///		Collapses between vertices with different normals cost more, so creases and silhouettes are kept longer
+///
+///		Collapses that would flip a triangle over, or fold the surface onto itself, are rejected
+///
+/// Like the MeshOptimizer, the simplifier is deterministic, so baked meshes are reproducible. See
+/// MeshBuilder::GenerateLods to build a chain of levels for a mesh
+/// </summary>
+class MeshSimplifier
+{
+public:
+	/// <summary>
+	/// Bumped whenever the output of the simplifier changes, so that baked meshes from older versions get re-baked
+	/// </summary>
+	static const uint32_t VERSION = 1;
+	/// <summary>
+	/// Pass as the normal offset for vertices that do not have a normal
+	/// </summary>
+	static const size_t NO_NORMAL = ~static_cast<size_t>(0);
+
+	/// <summary>
+	/// Simplifies a mesh until it has at most targetIndexCount indices, or no collapse is left that stays within
+	/// targetError of the original surface, whichever comes first
+	/// </summary>
+	/// <param name="destination">Receives the simplified index buffer, must have room for indexCount indices</param>
+	/// <param name="indices">The index buffer to simplify, 3 indices per triangle</param>
+	/// <param name="indexCount">The number of indices in the buffer</param>
+	/// <param name="vertices">A pointer to the first vertex</param>
+	/// <param name="stride">The size of a single vertex, in bytes</param>
+	/// <param name="vertexCount">The number of vertices</param>
+	/// <param name="positionOffset">The offset of the vertex position (3 floats) from the start of each vertex</param>
+	/// <param name="normalOffset">The offset of the vertex normal (3 floats) from the start of each vertex, or NO_NORMAL</param>
+	/// <param name="targetIndexCount">The number of indices to stop at, 0 to only stop once targetError is reached</param>
+	/// <param name="targetError">The largest distance the simplified surface may move from the original, in model units</param>
+	/// <param name="resultError">If not null, receives the largest distance the surface actually moved, in model units</param>
+	/// <returns>The number of indices written to destination</returns>
+	static size_t Simplify(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+		const void* vertices, size_t stride, size_t vertexCount, size_t positionOffset, size_t normalOffset,
+		size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+protected:
+	MeshSimplifier() = default;
+	~MeshSimplifier() = default;
+};
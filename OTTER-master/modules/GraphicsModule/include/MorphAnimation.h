@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+
+#include "VertexArrayObject.h"
+#include "TextureBuffer.h"
+#include "ShaderMaterial.h"
+
+/// <summary>
+/// A morph animation (aka vertex animation) plays back a sequence of poses of a single mesh, such as a set of OBJ
+/// files exported from each frame of an animation. Since the frames share their topology, the mesh is only stored
+/// once, along with an offset and normal for every vertex in every frame. The frames live in a buffer texture and
+/// the vertex shader blends between two of them, so instances at different points in the animation can all be
+/// drawn with a single instanced draw
+///
+/// Shaders read the frames with the following uniforms, which are set by ApplyTo:
+///		uniform isamplerBuffer s_MorphFrames;
+///		uniform int   u_MorphVertexCount;
+///		uniform int   u_MorphQuantized;
+///		uniform float u_MorphDeltaScale;
+/// The two frames to blend between and the blend factor are passed per instance, in the x, y and z of the instance
+/// params (see InstanceData::Params)
+///
+/// Quantized frames store each vertex in 8 bytes: the offset as 3 16-bit integers scaled by u_MorphDeltaScale, and
+/// the normal octahedron encoded into 2 bytes. Unquantized frames use 2 texels per vertex, holding the bits of the
+/// offset and normal as floats
+/// </summary>
+class MorphAnimation final
+{
+public:
+	typedef std::shared_ptr<MorphAnimation> sptr;
+	static inline sptr Create() {
+		return std::make_shared<MorphAnimation>();
+	}
+	// We'll disallow moving and copying, since we want to manually control when the destructor is called
+	MorphAnimation(const MorphAnimation& other) = delete;
+	MorphAnimation(MorphAnimation&& other) = delete;
+	MorphAnimation& operator=(const MorphAnimation& other) = delete;
+	MorphAnimation& operator=(MorphAnimation&& other) = delete;
+
+public:
+	MorphAnimation();
+	~MorphAnimation() = default;
+
+	/// <summary>
+	/// Loads a morph animation from a sequence of OBJ files, one per frame, and uploads it to the GPU
+	/// </summary>
+	/// <param name="framePaths">The paths of the frames, in order. The first frame is used for the mesh's indices and texture coordinates</param>
+	/// <param name="quantize">True to compress the frames (see the class notes), false to store them at full precision</param>
+	static sptr LoadFromFiles(const std::vector<std::string>& framePaths, bool quantize = true);
+	/// <summary>
+	/// Does all the CPU side work of LoadFromFiles, returning a function that uploads the animation to the GPU. The
+	/// preparation can run on any thread, but the returned function must be called on the OpenGL thread
+	///
+	/// Every frame must have the same number of positions and triangles as the first, otherwise this will throw.
+	/// Vertices are matched between frames by their OBJ position index, so frames may triangulate their faces
+	/// differently, but normals are averaged per position, so any hard edges will be smoothed out
+	/// </summary>
+	/// <param name="framePaths">The paths of the frames, in order. The first frame is used for the mesh's indices and texture coordinates</param>
+	/// <param name="quantize">True to compress the frames (see the class notes), false to store them at full precision</param>
+	static std::function<sptr()> PrepareFromFiles(const std::vector<std::string>& framePaths, bool quantize = true);
+
+	/// <summary>
+	/// Sets the uniforms for reading this animation's frames on a material
+	/// </summary>
+	void ApplyTo(const ShaderMaterial::sptr& material) const;
+
+	/// <summary>
+	/// Gets the mesh for this animation, which is in the pose of the first frame. The bounds of the mesh cover every frame
+	/// </summary>
+	const VertexArrayObject::sptr& GetMesh() const { return _mesh; }
+	/// <summary>
+	/// Gets the texture that stores the frames
+	/// </summary>
+	const TextureBuffer::sptr& GetFrames() const { return _frames; }
+	/// <summary>
+	/// Gets the number of frames in the animation
+	/// </summary>
+	uint32_t GetFrameCount() const { return _frameCount; }
+	/// <summary>
+	/// Gets the number of vertices in the mesh
+	/// </summary>
+	uint32_t GetVertexCount() const { return _vertexCount; }
+	/// <summary>
+	/// Returns true if the frames are stored in the quantized format
+	/// </summary>
+	bool IsQuantized() const { return _quantized; }
+	/// <summary>
+	/// Gets the largest offset of any vertex along any axis, quantized offsets are stored relative to this
+	/// </summary>
+	float GetDeltaScale() const { return _deltaScale; }
+
+	/// <summary>
+	/// Gets the total size of the mesh and frames, in bytes
+	/// </summary>
+	size_t GetGpuMemoryUsage() const;
+
+protected:
+	VertexArrayObject::sptr _mesh;
+	TextureBuffer::sptr     _frames;
+	uint32_t                _frameCount;
+	uint32_t                _vertexCount;
+	bool                    _quantized;
+	float                   _deltaScale;
+};
@@ -1,12 +1,48 @@
 #pragma once
 #include "MeshFactory.h"
+#include "MeshBakeSettings.h"
+#include <functional>
 
 class NotObjLoader
 {
 public:
-	static VertexArrayObject::sptr LoadFromFile(const std::string& filename);
+	/// <summary>
+	/// Loads a NotObj scene file and uploads it to the GPU. Like the ObjLoader, the generated mesh is cached in a
+	/// baked mesh (.otm) next to the source file
+	/// </summary>
+	/// <param name="filename">The path of the file to load</param>
+	/// <param name="settings">How the mesh is processed before it is cached and uploaded (optimizing, vertex format and LODs)</param>
+	static VertexArrayObject::sptr LoadFromFile(const std::string& filename, const MeshBakeSettings& settings = MeshBakeSettings());
+
+	/// <summary>
+	/// Does all the CPU side work of LoadFromFile, returning a function that uploads the mesh to the GPU. The
+	/// preparation can run on any thread, but the returned function must be called on the OpenGL thread
+	/// </summary>
+	/// <param name="filename">The path of the file to load</param>
+	/// <param name="settings">How the mesh is processed before it is cached and uploaded (optimizing, vertex format and LODs)</param>
+	static std::function<VertexArrayObject::sptr()> PrepareFromFile(const std::string& filename, const MeshBakeSettings& settings = MeshBakeSettings());
+
+	/// <summary>
+	/// Parses a NotObj scene file into a mesh builder without uploading anything to the GPU
+	/// </summary>
+	/// <param name="filename">The path of the file to load</param>
+	/// <param name="mesh">The mesh builder to append the generated geometry to</param>
+	static void ParseFile(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh);
+
+	/// <summary>
+	/// Parses a file and writes it's baked mesh (.otm) next to it, so that later calls to LoadFromFile can skip parsing
+	/// </summary>
+	/// <param name="filename">The path of the file to bake</param>
+	/// <param name="settings">How the mesh is processed before it is baked (optimizing, vertex format and LODs)</param>
+	/// <param name="report">If not null, receives the vertex cache statistics from optimizing the mesh</param>
+	/// <returns>The path of the baked mesh that was written</returns>
+	static std::string BakeFile(const std::string& filename, const MeshBakeSettings& settings = MeshBakeSettings(),
+		MeshOptimizeReport* report = nullptr);
 
 protected:
 	NotObjLoader() = default;
 	~NotObjLoader() = default;
+
+	// Parses NotObj data that is already in memory
+	static void _ParseData(const char* data, size_t size, MeshBuilder<VertexPosNormTexCol>& mesh);
 };
\ No newline at end of file
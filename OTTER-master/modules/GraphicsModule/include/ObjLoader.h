@@ -1,12 +1,69 @@
 #pragma once
 #include "MeshFactory.h"
+#include "MeshBakeSettings.h"
+#include <functional>
 
 class ObjLoader
 {
 public:
-	static VertexArrayObject::sptr LoadFromFile(const std::string& filename, const glm::vec4& inColor = glm::vec4(1.0f));
+	/// <summary>
+	/// Loads an OBJ file and uploads it to the GPU. The parsed mesh is cached in a baked mesh (.otm) next to
+	/// the source file, which will be used instead of parsing as long as the source file does not change
+	/// </summary>
+	/// <param name="filename">The path of the OBJ file to load</param>
+	/// <param name="inColor">The color to assign to all vertices in the mesh</param>
+	/// <param name="settings">How the mesh is processed before it is cached and uploaded (optimizing, vertex format and LODs)</param>
+	static VertexArrayObject::sptr LoadFromFile(const std::string& filename, const glm::vec4& inColor = glm::vec4(1.0f),
+		const MeshBakeSettings& settings = MeshBakeSettings());
+
+	/// <summary>
+	/// Does all the CPU side work of LoadFromFile, returning a function that uploads the mesh to the GPU. The
+	/// preparation can run on any thread, but the returned function must be called on the OpenGL thread
+	/// </summary>
+	/// <param name="filename">The path of the file to load</param>
+	/// <param name="inColor">The color to assign to all vertices in the mesh</param>
+	/// <param name="settings">How the mesh is processed before it is cached and uploaded (optimizing, vertex format and LODs)</param>
+	static std::function<VertexArrayObject::sptr()> PrepareFromFile(const std::string& filename, const glm::vec4& inColor = glm::vec4(1.0f),
+		const MeshBakeSettings& settings = MeshBakeSettings());
+
+	/// <summary>
+	/// Parses an OBJ file into a mesh builder without uploading anything to the GPU. The file is memory mapped
+	/// and split into line-aligned chunks that are parsed in parallel, and vertices are de-duplicated by their
+	/// position/texture/normal indices
+	/// </summary>
+	/// <param name="filename">The path of the OBJ file to load</param>
+	/// <param name="mesh">The mesh builder to append the vertices and indices to</param>
+	/// <param name="inColor">The color to assign to all vertices in the mesh</param>
+	static void ParseFile(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec4& inColor = glm::vec4(1.0f));
+	/// <summary>
+	/// Parses an OBJ file like ParseFile, but also records which position ("v" line) each vertex was built from.
+	/// Files exported from the same mesh share their position indices even if their faces are split differently,
+	/// which lets their vertices be matched up (see MorphAnimation)
+	/// </summary>
+	/// <param name="filename">The path of the OBJ file to load</param>
+	/// <param name="mesh">The mesh builder to append the vertices and indices to</param>
+	/// <param name="positionIndices">Receives the 0-based position index of every vertex appended to the mesh</param>
+	/// <param name="inColor">The color to assign to all vertices in the mesh</param>
+	/// <returns>The number of positions declared in the file</returns>
+	static size_t ParseFile(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh, std::vector<uint32_t>& positionIndices, const glm::vec4& inColor = glm::vec4(1.0f));
+
+	/// <summary>
+	/// Parses a file and writes it's baked mesh (.otm) next to it, so that later calls to LoadFromFile can skip parsing
+	/// </summary>
+	/// <param name="filename">The path of the file to bake</param>
+	/// <param name="inColor">The color to assign to all vertices in the mesh</param>
+	/// <param name="settings">How the mesh is processed before it is baked (optimizing, vertex format and LODs)</param>
+	/// <param name="report">If not null, receives the vertex cache statistics from optimizing the mesh</param>
+	/// <returns>The path of the baked mesh that was written</returns>
+	static std::string BakeFile(const std::string& filename, const glm::vec4& inColor = glm::vec4(1.0f),
+		const MeshBakeSettings& settings = MeshBakeSettings(), MeshOptimizeReport* report = nullptr);
 
 protected:
 	ObjLoader() = default;
 	~ObjLoader() = default;
-};
\ No newline at end of file
+
+	// Parses OBJ data that is already in memory, returning the number of positions in the file. If positionIndices is
+	// not null, it receives the position index of each vertex that was added
+	static size_t _ParseData(const char* data, size_t size, MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec4& inColor,
+		std::vector<uint32_t>* positionIndices = nullptr);
+};
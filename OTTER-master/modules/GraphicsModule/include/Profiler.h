@@ -0,0 +1,232 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+
+// Profiling zones are compiled in for debug builds, and compiled out of release builds unless OTTER_PROFILING is
+// defined as 1. The Profiler itself is always available, so frame timing works in every build
+#ifndef OTTER_PROFILING
+	#ifdef _DEBUG
+		#define OTTER_PROFILING 1
+	#else
+		#define OTTER_PROFILING 0
+	#endif
+#endif
+
+/// <summary>
+/// A single timed section of a frame, on the CPU or GPU
+/// </summary>
+struct ProfileZone
+{
+	/// <summary>
+	/// The name of the zone, this must outlive the profiler (ex: a string literal)
+	/// </summary>
+	const char* Name;
+	/// <summary>
+	/// When the zone started and ended, in nanoseconds since the profiler started (see Profiler::Now)
+	/// </summary>
+	uint64_t    Start;
+	uint64_t    End;
+	/// <summary>
+	/// The index of the thread that the zone ran on (see Profiler::GetThreadNames), or Profiler::GPU_THREAD
+	/// </summary>
+	uint32_t    Thread;
+	/// <summary>
+	/// How many zones this one is nested inside of
+	/// </summary>
+	uint32_t    Depth;
+
+	double GetMs() const { return (End - Start) / 1000000.0; }
+};
+
+/// <summary>
+/// Everything that was recorded during one frame
+/// </summary>
+struct ProfileFrame
+{
+	uint64_t                 Index = 0;
+	/// <summary>
+	/// When Profiler::BeginFrame and Profiler::EndFrame were called, in nanoseconds since the profiler started
+	/// </summary>
+	uint64_t                 Start = 0;
+	uint64_t                 End = 0;
+	/// <summary>
+	/// The time since the previous frame began, which includes anything outside of BeginFrame/EndFrame (like
+	/// waiting on vsync). This is the real frame time, where Timing::DeltaTime is clamped
+	/// </summary>
+	uint64_t                 Interval = 0;
+	/// <summary>
+	/// The CPU zones that finished during this frame, on any thread
+	/// </summary>
+	std::vector<ProfileZone> CpuZones;
+	/// <summary>
+	/// The GPU zones that were issued during this frame. These arrive a few frames late, see Profiler::GPU_FRAMES_IN_FLIGHT
+	/// </summary>
+	std::vector<ProfileZone> GpuZones;
+	bool                     HasGpuZones = false;
+
+	double GetCpuMs() const { return (End - Start) / 1000000.0; }
+	double GetIntervalMs() const { return Interval / 1000000.0; }
+	/// <summary>
+	/// Gets the total time the GPU spent in top level GPU zones this frame, in milliseconds
+	/// </summary>
+	double GetGpuMs() const;
+};
+
+/// <summary>
+/// The profiler records how long named sections of each frame take, on every thread and on the GPU, so we can see
+/// where the frame goes. Zones are recorded with the PROFILE_SCOPE and PROFILE_GPU_SCOPE macros, and the profiler
+/// keeps the last HISTORY_SIZE frames, which can be shown with ProfilerPanel or exported to a Chrome trace
+///
+/// Each thread writes finished zones to it's own ring buffer, which only that thread writes to and only EndFrame
+/// reads from, so recording a zone never takes a lock. GPU zones are pairs of GL_TIMESTAMP queries (which, unlike
+/// GL_TIME_ELAPSED queries, can be nested), and their results are read back GPU_FRAMES_IN_FLIGHT frames later, so
+/// we never wait for the GPU to catch up
+///
+/// BeginFrame, EndFrame and GPU zones must all be used from the thread that owns the OpenGL context
+/// </summary>
+class Profiler
+{
+public:
+	/// <summary>
+	/// The number of frames that are kept for viewing and exporting
+	/// </summary>
+	static const uint32_t HISTORY_SIZE = 300;
+	/// <summary>
+	/// The number of zones each thread can record between calls to EndFrame, any more are dropped
+	/// </summary>
+	static const uint32_t THREAD_BUFFER_SIZE = 16384;
+	/// <summary>
+	/// How many frames old GPU zones are when we read them back
+	/// </summary>
+	static const uint32_t GPU_FRAMES_IN_FLIGHT = 3;
+	/// <summary>
+	/// The thread index used for GPU zones
+	/// </summary>
+	static const uint32_t GPU_THREAD = ~0u;
+
+	/// <summary>
+	/// Gets the current time in nanoseconds, relative to when the profiler started
+	/// </summary>
+	static uint64_t Now();
+
+	/// <summary>
+	/// Marks the start of a frame
+	/// </summary>
+	static void BeginFrame();
+	/// <summary>
+	/// Marks the end of a frame, collecting the zones from every thread and any GPU results that are ready
+	/// </summary>
+	static void EndFrame();
+
+	/// <summary>
+	/// Names the calling thread, for the panel and the exported trace. Threads that don't set a name are numbered
+	/// </summary>
+	static void SetThreadName(const std::string& name);
+	/// <summary>
+	/// Gets the names of every thread that has recorded a zone, by thread index
+	/// </summary>
+	static std::vector<std::string> GetThreadNames();
+
+	/// <summary>
+	/// While paused, the frame history stays as it is so it can be inspected. Zones are still collected (and thrown
+	/// away) so the thread buffers don't fill up
+	/// </summary>
+	static void SetPaused(bool paused) { _paused = paused; }
+	static bool IsPaused() { return _paused; }
+
+	/// <summary>
+	/// Gets the frames in the history, oldest first
+	/// </summary>
+	static const std::deque<ProfileFrame>& GetFrames() { return _frames; }
+	/// <summary>
+	/// Gets the number of zones that were dropped because a thread's buffer was full
+	/// </summary>
+	static uint64_t GetDroppedZones();
+
+	/// <summary>
+	/// Writes the frame history out as a Chrome trace (the JSON trace_event format), which can be opened in
+	/// chrome://tracing or https://ui.perfetto.dev. Throws a runtime_error if the file cannot be written
+	/// </summary>
+	static void ExportChromeTrace(const std::string& path);
+
+	/// <summary>
+	/// Clears the frame history and releases the GPU queries. This must be called before the OpenGL context that
+	/// GPU zones were recorded in is destroyed, if another context will be profiled after it
+	/// </summary>
+	static void Reset();
+
+	// These are used by the scope types below, prefer the macros over calling them directly
+	static void RecordCpuZone(const char* name, uint64_t start, uint64_t end, uint32_t depth);
+	static uint32_t PushCpuDepth();
+	static void PopCpuDepth();
+	static uint32_t BeginGpuZone(const char* name);
+	static void EndGpuZone(uint32_t zone);
+
+private:
+	Profiler() = default;
+
+	static bool                     _paused;
+	static std::deque<ProfileFrame> _frames;
+};
+
+/// <summary>
+/// Times the scope it is declared in as a CPU zone, use PROFILE_SCOPE rather than declaring these directly
+/// </summary>
+class ProfileScope
+{
+public:
+	ProfileScope(const char* name) : _name(name), _depth(Profiler::PushCpuDepth()), _start(Profiler::Now()) { }
+	~ProfileScope() {
+		Profiler::RecordCpuZone(_name, _start, Profiler::Now(), _depth);
+		Profiler::PopCpuDepth();
+	}
+
+	ProfileScope(const ProfileScope& other) = delete;
+	ProfileScope& operator=(const ProfileScope& other) = delete;
+
+private:
+	const char* _name;
+	uint32_t    _depth;
+	uint64_t    _start;
+};
+
+/// <summary>
+/// Times the GPU work issued in the scope it is declared in, use PROFILE_GPU_SCOPE rather than declaring these directly
+/// </summary>
+class GpuProfileScope
+{
+public:
+	GpuProfileScope(const char* name) : _zone(Profiler::BeginGpuZone(name)) { }
+	~GpuProfileScope() { Profiler::EndGpuZone(_zone); }
+
+	GpuProfileScope(const GpuProfileScope& other) = delete;
+	GpuProfileScope& operator=(const GpuProfileScope& other) = delete;
+
+private:
+	uint32_t _zone;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if OTTER_PROFILING
+/// <summary>
+/// Times the rest of the enclosing scope as a CPU zone with the given name (which must be a string literal)
+/// </summary>
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(_profileScope, __LINE__)(name)
+/// <summary>
+/// Times the rest of the enclosing function as a CPU zone
+/// </summary>
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+/// <summary>
+/// Times the rest of the enclosing scope as both a CPU zone (how long it takes to submit) and a GPU zone (how long
+/// the GPU spends on it). Must only be used on the thread that owns the OpenGL context
+/// </summary>
+#define PROFILE_GPU_SCOPE(name) PROFILE_SCOPE(name); GpuProfileScope PROFILE_CONCAT(_profileGpuScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_GPU_SCOPE(name)
+#endif
@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+
+/// <summary>
+/// Draws the profiler's frame history with ImGui, inside of whatever window is currently open. This shows the real
+/// frame times (with min, max and average), a timeline of the zones in one frame for every thread and the GPU, and
+/// the zones that took the most time, so we can tell which part of the frame is the expensive one
+/// </summary>
+class ProfilerPanel
+{
+public:
+	/// <summary>
+	/// Draws the panel, call this from inside of an ImGui window
+	/// </summary>
+	static void Render();
+
+	/// <summary>
+	/// Sets the file that the "Export trace" button writes to
+	/// </summary>
+	static void SetExportPath(const std::string& path) { _exportPath = path; }
+
+private:
+	ProfilerPanel() = default;
+
+	static std::string _exportPath;
+	// The frame being inspected while paused, as an index into the history
+	static int         _selectedFrame;
+};
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "ShaderMaterial.h"
+#include "VertexArrayObject.h"
+
+// Commands only point at their transform, so we avoid depending on which copy of Transform.h is on the include path
+class Transform;
+
+/// <summary>
+/// A single draw in a render queue
+/// </summary>
+struct RenderCommand
+{
+	/// <summary>
+	/// The sort key for the draw, see RenderQueue::MakeKey
+	/// </summary>
+	uint64_t           Key;
+	ShaderMaterial*    Material;
+	VertexArrayObject* Mesh;
+	/// <summary>
+	/// The level of detail of the mesh to draw, see VertexArrayObject::Render
+	/// </summary>
+	uint32_t           Lod;
+	const Transform*   ObjectTransform;
+	/// <summary>
+	/// Extra values that are passed along with the instance data, see InstanceData::Params
+	/// </summary>
+	glm::vec4          InstanceParams;
+};
+
+/// <summary>
+/// The render queue collects the draws for a frame and sorts them by a 64-bit key, so that draws sharing a shader,
+/// material and mesh end up next to each other. Materials are grouped by their batch ID (see ShaderMaterial::GetBatchId),
+/// so separate materials that only differ by their MaterialParams are sorted together and can share a draw. Keys are
+/// sorted with a radix sort, which is linear in the number of draws, and skips any byte of the key that is the same
+/// for every draw
+///
+/// The queue only stores raw pointers, so everything submitted must stay alive until the queue is cleared
+/// </summary>
+class RenderQueue
+{
+public:
+	// Bits used by each part of the sort key, from most to least significant
+	static const int LAYER_BITS    = 8;
+	static const int SHADER_BITS   = 12;
+	static const int MATERIAL_BITS = 16;
+	static const int MESH_BITS     = 16;
+	static const int DEPTH_BITS    = 12;
+	// The lowest bits of the mesh part of the key hold the level of detail, so that draws of the same mesh at the
+	// same level end up next to each other
+	static const int LOD_BITS      = 3;
+
+	RenderQueue() = default;
+	~RenderQueue() = default;
+
+	/// <summary>
+	/// Removes all the commands from the queue
+	/// </summary>
+	void Clear() { _commands.clear(); }
+
+	/// <summary>
+	/// Adds a draw to the queue
+	/// </summary>
+	/// <param name="material">The material to draw with, it's shader and render layer are used for sorting</param>
+	/// <param name="mesh">The mesh to draw</param>
+	/// <param name="transform">The transform of the object</param>
+	/// <param name="depth">The normalized view depth of the object (0 = near plane, 1 = far plane), used to sort front to back</param>
+	/// <param name="instanceParams">Extra per-instance values for the shader, see InstanceData::Params</param>
+	/// <param name="lod">The level of detail of the mesh to draw, see RendererComponent::SelectLod</param>
+	void Submit(ShaderMaterial* material, VertexArrayObject* mesh, const Transform* transform, float depth = 0.0f,
+		const glm::vec4& instanceParams = glm::vec4(0.0f), uint32_t lod = 0);
+
+	/// <summary>
+	/// Sorts the commands in the queue by their keys
+	/// </summary>
+	void Sort();
+
+	/// <summary>
+	/// Gets the commands in the queue, in sorted order if Sort has been called
+	/// </summary>
+	const std::vector<RenderCommand>& GetCommands() const { return _commands; }
+
+	/// <summary>
+	/// Builds a sort key out of the parts of a draw. Values that do not fit in their bits are wrapped, which only
+	/// affects how well draws are grouped, not correctness
+	/// </summary>
+	/// <param name="layer">The render layer, lower layers are drawn first. Layers are clamped to [-128, 127]</param>
+	/// <param name="shaderId">The ID of the shader (ex: the program handle)</param>
+	/// <param name="materialId">The batch ID of the material</param>
+	/// <param name="meshId">The ID of the mesh (ex: the VAO handle)</param>
+	/// <param name="depth">The normalized view depth, from 0 to 1</param>
+	static uint64_t MakeKey(int layer, uint32_t shaderId, uint64_t materialId, uint32_t meshId, float depth);
+
+protected:
+	std::vector<RenderCommand> _commands;
+	// Scratch space for the radix sort, kept around between frames to avoid allocations
+	std::vector<RenderCommand> _scratch;
+};
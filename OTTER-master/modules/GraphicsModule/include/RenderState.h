@@ -0,0 +1,107 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+
+/// <summary>
+/// The render state cache shadows the parts of the OpenGL state that change most often while drawing (the bound
+/// program, vertex array and textures), so that redundant binds never reach the driver. Shader::Bind,
+/// VertexArrayObject::Bind, ITexture::Bind and ShaderMaterial::Apply all go through the cache
+///
+/// Anything that changes these bindings behind our back (ex: ImGui's renderer) must be followed by a call to
+/// Invalidate, so the cache does not skip a bind that is actually needed
+/// </summary>
+class RenderState
+{
+public:
+	/// <summary>
+	/// Counters for the work done by the renderer during a frame
+	/// </summary>
+	struct Stats
+	{
+		/// <summary>
+		/// The number of draw calls issued
+		/// </summary>
+		uint32_t DrawCalls;
+		/// <summary>
+		/// The number of triangles drawn, counting every instance
+		/// </summary>
+		uint32_t Triangles;
+		/// <summary>
+		/// The number of binds that changed the OpenGL state
+		/// </summary>
+		uint32_t StateChanges;
+		/// <summary>
+		/// The number of binds that were skipped because the state was already set
+		/// </summary>
+		uint32_t CacheHits;
+	};
+
+	/// <summary>
+	/// The number of texture units that are tracked by the cache, binds to higher units are always passed through
+	/// </summary>
+	static const int MAX_TEXTURE_UNITS = 32;
+
+	/// <summary>
+	/// Binds a shader program, if it is not already bound
+	/// </summary>
+	static void UseProgram(GLuint program);
+	/// <summary>
+	/// Binds a vertex array object, if it is not already bound
+	/// </summary>
+	static void BindVertexArray(GLuint vao);
+	/// <summary>
+	/// Binds a texture to a texture unit, if it is not already bound there
+	/// </summary>
+	static void BindTexture(int slot, GLuint texture);
+	/// <summary>
+	/// Binds a range of texture units at once, only issuing a call if at least one of them changed
+	/// </summary>
+	/// <param name="first">The first texture unit to bind</param>
+	/// <param name="count">The number of textures to bind</param>
+	/// <param name="textures">The texture handles to bind, 0 unbinds the unit</param>
+	static void BindTextures(int first, int count, const GLuint* textures);
+
+	/// <summary>
+	/// Records that a draw call was issued, for the frame statistics
+	/// </summary>
+	/// <param name="triangles">The number of triangles that the draw submitted</param>
+	static void CountDraw(uint32_t triangles = 0) { _stats.DrawCalls++; _stats.Triangles += triangles; }
+
+	/// <summary>
+	/// Forgets everything the cache knows about the OpenGL state, so the next bind of each kind is always issued
+	/// </summary>
+	static void Invalidate();
+	/// <summary>
+	/// Removes a deleted program from the cache, since OpenGL may re-use the handle
+	/// </summary>
+	static void ForgetProgram(GLuint program);
+	/// <summary>
+	/// Removes a deleted vertex array from the cache, since OpenGL may re-use the handle
+	/// </summary>
+	static void ForgetVertexArray(GLuint vao);
+	/// <summary>
+	/// Removes a deleted texture from the cache, since OpenGL may re-use the handle
+	/// </summary>
+	static void ForgetTexture(GLuint texture);
+
+	/// <summary>
+	/// Gets the statistics for the current frame
+	/// </summary>
+	static const Stats& GetStats() { return _stats; }
+	/// <summary>
+	/// Resets the frame statistics, call once at the start of each frame
+	/// </summary>
+	static void ResetStats();
+
+protected:
+	RenderState() = default;
+	~RenderState() = default;
+
+	// We use ~0 to mean "unknown", since 0 is a valid binding
+	static const GLuint UNKNOWN = ~0u;
+
+	static GLuint _program;
+	static GLuint _vertexArray;
+	static GLuint _textures[MAX_TEXTURE_UNITS];
+	static Stats  _stats;
+};
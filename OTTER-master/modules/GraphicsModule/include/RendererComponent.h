@@ -1,12 +1,82 @@
 #pragma once
 #include <VertexArrayObject.h>
 #include <ShaderMaterial.h>
+#include <AssetHandle.h>
+#include <Camera.h>
+#include <cmath>
 
 class RendererComponent {
 public:
 	VertexArrayObject::sptr Mesh;
 	ShaderMaterial::sptr    Material;
+	// A mesh that is still streaming in, Mesh will be replaced with it once it's ready
+	AssetHandle<VertexArrayObject> PendingMesh;
+	// The level of detail of the mesh that was picked last frame, see SelectLod
+	uint32_t                       Lod = 0;
 
-	RendererComponent& SetMesh(const VertexArrayObject::sptr& mesh) { Mesh = mesh; return *this; }
+	/// <summary>
+	/// The default largest on-screen error (in pixels) that SelectLod will allow
+	/// </summary>
+	static constexpr float DEFAULT_LOD_PIXEL_ERROR = 1.0f;
+	/// <summary>
+	/// The default fraction that a coarser level's on-screen error must be under the limit before SelectLod switches to it
+	/// </summary>
+	static constexpr float DEFAULT_LOD_HYSTERESIS = 0.25f;
+
+	RendererComponent& SetMesh(const VertexArrayObject::sptr& mesh) { Mesh = mesh; PendingMesh = AssetHandle<VertexArrayObject>(); return *this; }
 	RendererComponent& SetMaterial(const ShaderMaterial::sptr& material) { Material = material; return *this; }
-};
\ No newline at end of file
+
+	/// <summary>
+	/// Sets a mesh that is being streamed in by the AssetStreamer, the fallback will be rendered until it is ready
+	/// </summary>
+	RendererComponent& SetMesh(const AssetHandle<VertexArrayObject>& mesh, const VertexArrayObject::sptr& fallback = nullptr) {
+		Mesh = mesh.GetOr(fallback);
+		PendingMesh = mesh.IsLoading() ? mesh : AssetHandle<VertexArrayObject>();
+		return *this;
+	}
+
+	/// <summary>
+	/// Swaps in the pending mesh if it has finished loading, should be called before rendering
+	/// </summary>
+	/// <returns>True if there is a mesh to render</returns>
+	bool UpdatePending() {
+		if (PendingMesh.IsValid() && !PendingMesh.IsLoading()) {
+			if (PendingMesh.IsReady()) {
+				Mesh = PendingMesh.Get();
+			}
+			PendingMesh = AssetHandle<VertexArrayObject>();
+		}
+		return Mesh != nullptr;
+	}
+
+	/// <summary>
+	/// Picks the level of detail to draw the mesh at, based on how large it's bounding sphere is on screen. See
+	/// MeshLod::Select for how levels are picked
+	/// </summary>
+	/// <param name="projectedRadius">The radius of the mesh's bounding sphere on screen in pixels, see ProjectSphere</param>
+	/// <param name="pixelError">The largest on-screen error allowed, in pixels</param>
+	/// <param name="hysteresis">How far under the limit (as a fraction of it) a coarser level must be before switching to it</param>
+	/// <returns>The selected level, which is also stored in Lod</returns>
+	uint32_t SelectLod(float projectedRadius, float pixelError = DEFAULT_LOD_PIXEL_ERROR, float hysteresis = DEFAULT_LOD_HYSTERESIS) {
+		Lod = MeshLod::Select(Mesh->GetLods(), Mesh->GetBounds().Radius, Lod, projectedRadius, pixelError, hysteresis);
+		return Lod;
+	}
+
+	/// <summary>
+	/// Gets the radius in pixels of a bounding sphere once it has been projected onto the screen
+	/// </summary>
+	/// <param name="center">The center of the sphere in world space</param>
+	/// <param name="radius">The radius of the sphere in world space</param>
+	/// <param name="camera">The camera the sphere is being viewed from</param>
+	/// <param name="viewportHeight">The height of the viewport, in pixels</param>
+	/// <returns>The projected radius, or infinity if the camera is inside the sphere</returns>
+	static float ProjectSphere(const glm::vec3& center, float radius, const Camera& camera, float viewportHeight) {
+		// The projection's Y scale is 1/tan(fov/2) for perspective cameras, and 1/height for orthographic ones
+		const float scale = camera.GetProjection()[1][1] * viewportHeight * 0.5f;
+		if (camera.GetIsOrtho()) {
+			return radius * scale;
+		}
+		const float distance = glm::length(center - camera.GetPosition());
+		return distance > radius ? radius * scale / distance : INFINITY;
+	}
+};
@@ -7,6 +7,7 @@
 #include <GLM/glm.hpp>          // for our GLM types
 #include <GLM/gtc/type_ptr.hpp> // for glm::value_ptr
 #include "Logging.h"            // for the logging functions
+#include "UniformId.h"          // for UniformId
 
 /// <summary>
 /// This class will wrap around an OpenGL shader program
@@ -70,9 +71,43 @@ public:
 	/// Gets the underlying OpenGL handle that this class is wrapping
 	/// </summary>
 	GLuint GetHandle() const { return _handle; }
+
+	/// <summary>
+	/// Returns true if this shader reads per-instance data from an InstanceBuffer (ie, it declares the
+	/// inInstanceModel attribute), and can be drawn with VertexArrayObject::RenderInstanced
+	/// </summary>
+	bool IsInstanced() const { return _isInstanced; }
+
+	/// <summary>
+	/// Assigns a uniform block in this shader to a uniform buffer binding point
+	/// </summary>
+	/// <param name="blockName">The name of the uniform block in the shader source</param>
+	/// <param name="binding">The binding point to use (see UniformBuffer::Bind)</param>
+	/// <returns>True if the block exists in this shader, false if otherwise</returns>
+	bool SetUniformBlockBinding(const std::string& blockName, GLuint binding);
 	
 public:
 	int GetUniformLocation(const std::string& name);
+	/// <summary>
+	/// Gets the location of a uniform by it's precomputed ID, this is much faster than looking it up by name
+	/// </summary>
+	/// <returns>The location of the uniform, or -1 if it is not an active uniform in this shader</returns>
+	int GetUniformLocation(const UniformId& id) const;
+	
+	template <typename T>
+	void SetUniform(const UniformId& id, const T& value) {
+		int location = GetUniformLocation(id);
+		if (location != -1) {
+			SetUniform(location, &value, 1);
+		}
+	}
+	template <typename T>
+	void SetUniformMatrix(const UniformId& id, const T& value, bool transposed = false) {
+		int location = GetUniformLocation(id);
+		if (location != -1) {
+			SetUniformMatrix(location, &value, 1, transposed);
+		}
+	}
 	
 	template <typename T>
 	void SetUniform(const std::string& name, const T& value) {
@@ -121,7 +156,18 @@ protected:
 	GLuint _fs;
 	
 	GLuint _handle;
+	bool   _isInstanced;
 
 	std::unordered_map<std::string, int> _uniformLocs;
+	// An active uniform that can be looked up by ID, the name is kept so that hash collisions can be caught
+	struct ResolvedUniform {
+		int         Location;
+		std::string Name;
+	};
+	// Locations of all the active uniforms, keyed by UniformId hash. Built when the shader is linked
+	std::unordered_map<uint64_t, ResolvedUniform, UniformIdHasher> _uniformIds;
+
+	// Queries all the active uniforms and fills in _uniformIds
+	void _ResolveUniforms();
 	
 };
\ No newline at end of file
@@ -1,53 +1,55 @@
 #pragma once
 #include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
 #include "Shader.h"
 #include "ITexture.h"
+#include "AssetHandle.h"
+#include "MaterialLayout.h"
 #include "Macros.h"
 #include <EnumToString.h>
 
-struct ShaderParamName {
-	std::string Name;
-	int         Location;
-
-	ShaderParamName(const std::string& name) :
-		Name(name), Location(-1) {}
-
-	bool operator ==(const ShaderParamName& r) const {
-		return Name == r.Name;
-	}
-	bool operator !=(const ShaderParamName& r) const {
-		return Name != r.Name;
-	}
-};
-
-namespace  std
-{
-	template<>
-	struct hash<ShaderParamName> {
-		std::size_t operator()(const ShaderParamName& p) const noexcept {
-			return std::hash<std::string>()(p.Name);
-		}
-	};
-}
-
+/// <summary>
+/// A shader material stores the values for a shader's parameters (textures and uniforms). The values are stored in
+/// a flat block described by the shader's MaterialLayout, which is built the first time the material is used with a
+/// shader. Apply only uploads the values that have changed since the material was last applied, unless another
+/// material using the same shader was applied in between
+///
+/// Note that setting a material's uniforms directly on the shader will not be noticed by the material
+///
+/// Materials that share a shader, values and textures can be drawn together, even if they are separate objects (see
+/// GetBatchId). Values that differ between such materials, like the layer of a Texture2DArray or a region in a
+/// TextureAtlas, go in MaterialParams, which is passed to instanced shaders with each instance instead of as a uniform
+/// </summary>
 class ShaderMaterial {
 	SMART_MEMORY_MANAGED(ShaderMaterial)
 public:
-	
+	/// <summary>
+	/// The most textures a material can bind, since Apply binds them all with a single glBindTextures call. Setting
+	/// a sampler past this limit is rejected with an error
+	/// </summary>
+	static const size_t MAX_TEXTURES = 32;
+
 	ShaderMaterial();
 	virtual ~ShaderMaterial();
 
 	Shader::sptr Shader;
-	std::unordered_map<ShaderParamName, ITexture::sptr> Textures;
-	std::unordered_map<ShaderParamName, float> FloatParams;
-	std::unordered_map<ShaderParamName, glm::vec2> Vec2Params;
-	std::unordered_map<ShaderParamName, glm::vec3> Vec3Params;
-	std::unordered_map<ShaderParamName, glm::vec4> Vec4Params;
-	std::unordered_map<ShaderParamName, glm::mat4> Mat4Params;
-	std::unordered_map<ShaderParamName, glm::mat3> Mat3Params;
 
 	int RenderLayer;
 	std::string DebugName;
+	/// <summary>
+	/// Values that are passed along with each instance drawn with this material, rather than set as uniforms, so they
+	/// don't stop the material from being batched with others (see InstanceData::MaterialParams). Shaders decide what
+	/// these mean, ex: the layer of a texture array in x, or a TextureAtlasRegion::UvTransform
+	/// </summary>
+	glm::vec4 MaterialParams;
+
+	/// <summary>
+	/// Builds the parameter layout for the current shader. This is done automatically when the material is first
+	/// used, and any values that were set for a previous shader are carried over where the names and types match
+	/// </summary>
+	void Compile();
 
 	void Apply();
 
@@ -58,6 +60,76 @@ public:
 	void Set(const std::string& name, const glm::vec4& value);
 	void Set(const std::string& name, const glm::mat4& value);
 	void Set(const std::string& name, const glm::mat3& value);
+	void Set(const std::string& name, int value);
+
+	/// <summary>
+	/// Sets a texture that is being streamed in by the AssetStreamer. The fallback will be bound until the texture
+	/// is ready, at which point the material will switch over to it
+	/// </summary>
+	/// <param name="name">The name of the sampler uniform</param>
+	/// <param name="texture">The handle to the texture that is loading</param>
+	/// <param name="fallback">The texture to use until the handle is ready, or if it fails to load</param>
+	template <typename T>
+	void Set(const std::string& name, const AssetHandle<T>& texture, const ITexture::sptr& fallback = nullptr) {
+		Set(name, texture.IsReady() ? texture.Get() : fallback);
+		if (texture.IsLoading()) {
+			_pendingTextures[name] = [texture](ITexture::sptr& result) {
+				if (texture.IsLoading()) {
+					return false;
+				}
+				result = texture.Get();
+				return true;
+			};
+		}
+	}
+
+	/// <summary>
+	/// Gets the layout of this material's parameters, or nullptr if the material has not been compiled yet
+	/// </summary>
+	const MaterialLayout::sptr& GetLayout() const { return _layout; }
+
+	/// <summary>
+	/// Gets the unique ID of this material
+	/// </summary>
+	uint64_t GetId() const { return _id; }
+
+	/// <summary>
+	/// Gets an ID that is shared by all materials with the same shader, parameter values and textures, ignoring
+	/// MaterialParams. Materials with the same batch ID can be drawn one after the other while only applying the
+	/// first, so the render queue sorts by this instead of the material's own ID
+	///
+	/// The ID is a hash of the material's state, it is only recalculated when the state changes
+	/// </summary>
+	uint64_t GetBatchId();
 
 protected:
+	// Unique ID for this material, used to track which material last uploaded to a shader
+	uint64_t                    _id;
+	// The hash of the material's state, see GetBatchId, and whether it needs to be recalculated
+	uint64_t                    _batchId;
+	bool                        _isBatchIdDirty;
+	MaterialLayout::sptr        _layout;
+	// The values of all non-texture parameters, at the offsets given by the layout
+	std::vector<uint8_t>        _data;
+	// The textures for each sampler in the layout
+	std::vector<ITexture::sptr> _textures;
+	// One bit per layout parameter, for parameters that have a value and parameters that changed since the last Apply
+	std::vector<uint64_t>       _setMask;
+	std::vector<uint64_t>       _dirtyMask;
+	// Textures that are still streaming in, checked each time the material is applied. The callback returns true
+	// once the handle is finished, and sets the texture to use if the load succeeded
+	std::unordered_map<std::string, std::function<bool(ITexture::sptr&)>> _pendingTextures;
+
+	// Swaps in any streamed textures that have finished loading
+	void _UpdatePendingTextures();
+	// Finds the parameter with the given name and type, compiling the material if required
+	int _FindParam(const std::string& name, MaterialParamType type);
+	// Stores a value for a parameter and marks it as dirty
+	void _SetValue(const std::string& name, MaterialParamType type, const void* value);
+	// Stores a texture for a sampler parameter and marks it as dirty
+	void _SetTexture(const std::string& name, const ITexture::sptr& texture);
+	// Marks a parameter as having a value that needs uploading
+	void _MarkDirty(int index);
+	// Uploads a single parameter to the shader
+	void _Upload(const MaterialParam& param);
 };
@@ -18,6 +18,8 @@ struct Texture2DDescription
 	MinFilter      MinificationFilter;
 	MagFilter      MagnificationFilter;
 	float          MaxAnisotropic;
+	// True to allocate a full chain of mip levels, and generate them from the full size image if the data we load
+	// does not already have them
 	bool           GenerateMipMaps;
 
 	Texture2DDescription() :
@@ -66,7 +68,7 @@ public:
 	void LoadData(const Texture2DData::sptr& data);
 
 	/// <summary>
-	/// Loads an image directly from a file
+	/// Loads an image from a file, via it's baked version if there is one (see BakedTexture::LoadCached)
 	/// </summary>
 	/// <param name="path">The path to load the image from</param>
 	/// <returns>A pointer to the loaded image</returns>
@@ -79,6 +81,10 @@ public:
 	MagFilter GetMagFilter() const { return _description.MagnificationFilter; }
 	WrapMode GetWrapS() const { return _description.HorizontalWrap; }
 	WrapMode GetWrapT() const { return _description.VerticalWrap; }
+	/// <summary>
+	/// Gets the number of mip levels allocated for this texture
+	/// </summary>
+	uint32_t GetMipLevelCount() const { return _levelCount; }
 	
 	void SetMinFilter(MinFilter filter);
 	void SetMagFilter(MagFilter filter);
@@ -87,9 +93,15 @@ public:
 	void SetAnisotropicFiltering(float level = -1.0f);
 
 	const Texture2DDescription& GetDescription() const { return _description; }
+
+	/// <summary>
+	/// Gets the approximate amount of GPU memory used by this texture, in bytes
+	/// </summary>
+	size_t GetGpuMemoryUsage() const;
 	
 private:
 	Texture2DDescription _description;
+	uint32_t             _levelCount;
 
 	void _RecreateTexture();
 };
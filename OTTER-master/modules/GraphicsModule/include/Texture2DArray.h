@@ -0,0 +1,109 @@
+#pragma once
+#include <memory>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ITexture.h"
+#include "TextureEnums.h"
+#include "Texture2DData.h"
+#include "TextureBakeSettings.h"
+
+struct Texture2DArrayDescription
+{
+	uint32_t       Width;
+	uint32_t       Height;
+	uint32_t       Layers;
+	InternalFormat Format;
+	WrapMode       HorizontalWrap;
+	WrapMode       VerticalWrap;
+	MinFilter      MinificationFilter;
+	MagFilter      MagnificationFilter;
+	float          MaxAnisotropic;
+	// True to allocate a full chain of mip levels, and generate them from the full size layers if the data we load
+	// does not already have them
+	bool           GenerateMipMaps;
+
+	Texture2DArrayDescription() :
+		Width(0), Height(0), Layers(0),
+		Format(InternalFormat::Unknown),
+		HorizontalWrap(WrapMode::Repeat),
+		VerticalWrap(WrapMode::Repeat),
+		MinificationFilter(MinFilter::NearestMipLinear),
+		MagnificationFilter(MagFilter::Linear),
+		MaxAnisotropic(-1.0f),
+		GenerateMipMaps(true)
+	{ }
+};
+
+/// <summary>
+/// Represents a wrapper around an OpenGL 2D texture array. Every layer of an array shares one size and format, and
+/// shaders pick the layer to sample when they sample it (ex: texture(s_Diffuse, vec3(inUV, inLayer))). This lets
+/// materials that only differ by their textures share a single binding, and be drawn together with the layer passed
+/// along with each instance (see ShaderMaterial::MaterialParams)
+///
+/// Layers with different sizes or formats can be combined ahead of time with TextureBaker::BakeArray
+/// </summary>
+class Texture2DArray final : public ITexture
+{
+public:
+	// We'll disallow moving and copying, since we want to manually control when the destructor is called
+	// We'll use these classes via pointers
+	Texture2DArray(const Texture2DArray& other) = delete;
+	Texture2DArray(Texture2DArray&& other) = delete;
+	Texture2DArray& operator=(const Texture2DArray& other) = delete;
+	Texture2DArray& operator=(Texture2DArray&& other) = delete;
+
+	typedef std::shared_ptr<Texture2DArray> sptr;
+	static inline sptr Create(const Texture2DArrayDescription& description = Texture2DArrayDescription()) {
+		return std::make_shared<Texture2DArray>(description);
+	}
+
+public:
+	/// <summary>
+	/// Creates a new texture array with the given description
+	/// </summary>
+	/// <param name="description">The default description for the texture</param>
+	Texture2DArray(const Texture2DArrayDescription& description);
+	// ITexture handles destroying the OpenGL data, so we can use the default destructor
+	~Texture2DArray() = default;
+
+	/// <summary>
+	/// Uploads data to every layer of this texture, resizing it to fit if needed. All of the layers must have the
+	/// same size, format and number of levels, otherwise nothing is uploaded
+	/// </summary>
+	/// <param name="layers">The data for each layer, in order</param>
+	/// <returns>True if the layers were uploaded</returns>
+	bool LoadData(const std::vector<Texture2DData::sptr>& layers);
+
+	/// <summary>
+	/// Loads a texture array through it's baked cache, see BakedTexture::LoadCachedArray
+	/// </summary>
+	/// <param name="cachePath">The path of the baked array (ex: images/props.dds)</param>
+	/// <param name="sourcePaths">The paths of the images to store in each layer, in order</param>
+	/// <returns>The loaded texture array, or nullptr if it could not be loaded</returns>
+	static Texture2DArray::sptr LoadFromFiles(const std::string& cachePath, const std::vector<std::string>& sourcePaths,
+		const TextureBakeSettings& settings = TextureBakeSettings());
+
+	uint32_t GetWidth() const { return _description.Width; }
+	uint32_t GetHeight() const { return _description.Height; }
+	uint32_t GetLayerCount() const { return _description.Layers; }
+	InternalFormat GetFormat() const { return _description.Format; }
+	/// <summary>
+	/// Gets the number of mip levels allocated for each layer of this texture
+	/// </summary>
+	uint32_t GetMipLevelCount() const { return _levelCount; }
+
+	const Texture2DArrayDescription& GetDescription() const { return _description; }
+
+	/// <summary>
+	/// Gets the approximate amount of GPU memory used by this texture (all layers), in bytes
+	/// </summary>
+	size_t GetGpuMemoryUsage() const;
+
+private:
+	Texture2DArrayDescription _description;
+	uint32_t                  _levelCount;
+
+	void _RecreateTexture();
+};
@@ -1,11 +1,34 @@
 #pragma once
 #include <memory>
 #include <cstdint>
+#include <string>
+#include <vector>
 
 #include "TextureEnums.h"
 
+/// <summary>
+/// Describes where a single mip level is stored in a Texture2DData
+/// </summary>
+struct Texture2DLevel
+{
+	uint32_t Width;
+	uint32_t Height;
+	/// <summary>
+	/// The offset of the level from the start of the data, in bytes
+	/// </summary>
+	size_t   Offset;
+	/// <summary>
+	/// The size of the level's data, in bytes
+	/// </summary>
+	size_t   Size;
+};
+
 /// <summary>
 /// Stores data required to upload texture data into OpenGL
+///
+/// The data may hold a full chain of mip levels, and may be block compressed, in which case it is uploaded exactly as
+/// stored. Baked textures (see BakedTexture) point straight into their file mapping, so nothing is decoded or copied
+/// before upload
 /// </summary>
 class Texture2DData final
 {
@@ -28,7 +51,15 @@ public:
 	/// <param name="sourceData">A pointer to the data to upload to this texture</param>
 	/// <param name="recommendedFormat">The recommended internal format to use when creating textures from this data</param>
 	Texture2DData(uint32_t width, uint32_t height, PixelFormat format, PixelType type, void* sourceData, InternalFormat recommendedFormat = InternalFormat::Unknown);
-	~Texture2DData();
+	/// <summary>
+	/// Creates a 2D texture data object that refers to a set of mip levels stored elsewhere, without copying them
+	/// </summary>
+	/// <param name="format">The internal format that the levels are stored in, either compressed, R8, RG8 or RGBA8</param>
+	/// <param name="levels">The mip levels, starting from the full size image</param>
+	/// <param name="data">A pointer to the start of the level data, level offsets are relative to this</param>
+	/// <param name="storage">Whatever owns the memory that data points into (ex: a MemoryMappedFile), this is kept alive for as long as we are</param>
+	Texture2DData(InternalFormat format, const std::vector<Texture2DLevel>& levels, const void* data, const std::shared_ptr<const void>& storage);
+	~Texture2DData() = default;
 
 	/// <summary>
 	/// Loads image data from an external file
@@ -37,6 +68,15 @@ public:
 	/// <param name="forceRgba">True to force STBI to load 4 component texture data</param>
 	/// <returns>A pointer to the data loaded from the file, or nullptr if the file failed to load</returns>
 	static Texture2DData::sptr LoadFromFile(const std::string& file, bool forceRgba = false);
+	/// <summary>
+	/// Decodes an image that has already been loaded into memory (ex: from a memory mapped file)
+	/// </summary>
+	/// <param name="data">The encoded image (ex: the contents of a PNG file)</param>
+	/// <param name="size">The size of the encoded image, in bytes</param>
+	/// <param name="name">The name of the image, used for logging and as it's debug name</param>
+	/// <param name="forceRgba">True to force STBI to load 4 component texture data</param>
+	/// <returns>A pointer to the decoded data, or nullptr if the image could not be decoded</returns>
+	static Texture2DData::sptr LoadFromMemory(const void* data, size_t size, const std::string& name, bool forceRgba = false);
 
 	/// <summary>
 	/// Gets the width of the texture data, in pixels
@@ -60,7 +100,11 @@ public:
 	/// </summary>
 	InternalFormat  GetRecommendedFormat() const { return _recommendedFormat; }
 	/// <summary>
-	/// Get the total size of the underlying data (size of individual pixel * width * height)
+	/// Returns true if the data is block compressed, in which case it must be uploaded in the recommended format
+	/// </summary>
+	bool IsCompressed() const { return ::IsCompressed(_recommendedFormat); }
+	/// <summary>
+	/// Get the total size of the underlying data (size of individual pixel * width * height, plus any mip levels)
 	/// </summary>
 	size_t  GetDataSize() const { return _dataSize; }
 	/// <summary>
@@ -68,11 +112,27 @@ public:
 	/// </summary>
 	const void* GetDataPtr() const { return _data; }
 
+	/// <summary>
+	/// Gets the number of mip levels stored in the data, this is 1 unless the data was baked with mip levels
+	/// </summary>
+	uint32_t GetLevelCount() const { return static_cast<uint32_t>(_levels.size()); }
+	/// <summary>
+	/// Gets the size and location of one of the mip levels
+	/// </summary>
+	const Texture2DLevel& GetLevel(uint32_t level) const { return _levels[level]; }
+	/// <summary>
+	/// Gets a readonly pointer to the data for one of the mip levels
+	/// </summary>
+	const void* GetLevelDataPtr(uint32_t level) const { return static_cast<const char*>(_data) + _levels[level].Offset; }
+
 private:
 	uint32_t    _width, _height;
 	size_t      _dataSize;
 	PixelFormat _format;
 	PixelType   _type;
 	InternalFormat _recommendedFormat;
-	void* _data;
+	const void* _data;
+	std::vector<Texture2DLevel> _levels;
+	// Owns the memory that _data points into
+	std::shared_ptr<const void> _storage;
 };
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <GLM/glm.hpp>
+
+#include "Texture2D.h"
+#include "TextureBaker.h"
+
+struct stbrp_context;
+struct stbrp_node;
+
+/// <summary>
+/// Where an image was placed in a texture atlas
+/// </summary>
+struct TextureAtlasRegion
+{
+	/// <summary>
+	/// The position of the image's top left texel in the atlas, not including it's padding
+	/// </summary>
+	uint32_t X, Y;
+	uint32_t Width, Height;
+	/// <summary>
+	/// Maps the image's own UVs into the atlas, as (scale.x, scale.y, offset.x, offset.y). Shaders apply this per
+	/// instance (inUV * params.xy + params.zw), so it can be used as a material's MaterialParams
+	/// </summary>
+	glm::vec4 UvTransform;
+};
+
+/// <summary>
+/// Packs images into a single RGBA texture with stb_rect_pack, so that materials using different images can share
+/// one texture binding. Each image is surrounded by a border of it's own edge texels, so that filtering and the
+/// smaller mip levels don't bleed neighbouring images into it. A padding of N texels keeps the first log2(N) mip
+/// levels clean
+///
+/// Atlases can be built all at once with Pack (ex: offline, with the result baked by TextureBaker), or filled in at
+/// runtime with Add for dynamic content. Note that UVs outside of [0, 1] will sample neighbouring images, so images
+/// that need to repeat should go in a Texture2DArray instead
+/// </summary>
+class TextureAtlas final
+{
+public:
+	typedef std::shared_ptr<TextureAtlas> sptr;
+	static inline sptr Create(uint32_t size, uint32_t padding = 4) {
+		return std::make_shared<TextureAtlas>(size, padding);
+	}
+
+	// We'll disallow moving and copying, since we hold on to the packer's state
+	TextureAtlas(const TextureAtlas& other) = delete;
+	TextureAtlas(TextureAtlas&& other) = delete;
+	TextureAtlas& operator=(const TextureAtlas& other) = delete;
+	TextureAtlas& operator=(TextureAtlas&& other) = delete;
+
+	/// <summary>
+	/// Packs a set of RGBA images into a square atlas on the CPU, trying the largest images first. Throws a
+	/// runtime_error if the images do not all fit
+	/// </summary>
+	/// <param name="images">The images to pack, these must all have 4 channels</param>
+	/// <param name="size">The width and height of the atlas, in texels</param>
+	/// <param name="padding">The number of border texels to put around each image</param>
+	/// <param name="regions">Receives where each image was placed, in the same order as the images</param>
+	/// <returns>The atlas image, with any unused space left transparent black</returns>
+	static TextureImage Pack(const std::vector<TextureImage>& images, uint32_t size, uint32_t padding, std::vector<TextureAtlasRegion>& regions);
+
+public:
+	/// <summary>
+	/// Creates an empty atlas texture, which images can be added to at runtime
+	/// </summary>
+	/// <param name="size">The width and height of the atlas, in texels</param>
+	/// <param name="padding">The number of border texels to put around each image</param>
+	TextureAtlas(uint32_t size, uint32_t padding);
+	~TextureAtlas();
+
+	/// <summary>
+	/// Finds space for an image and uploads it into the atlas. Mip levels are not updated until Update is called, so
+	/// adding several images in a frame only regenerates them once
+	/// </summary>
+	/// <param name="image">The image to add, this must have 4 channels</param>
+	/// <param name="region">Receives where the image was placed</param>
+	/// <returns>True if the image was added, or false if there is no space left for it</returns>
+	bool Add(const TextureImage& image, TextureAtlasRegion& region);
+
+	/// <summary>
+	/// Regenerates the atlas's mip levels if any images were added since the last update
+	/// </summary>
+	void Update();
+
+	/// <summary>
+	/// Gets the texture that the images are packed into
+	/// </summary>
+	const Texture2D::sptr& GetTexture() const { return _texture; }
+	/// <summary>
+	/// Gets the width and height of the atlas, in texels
+	/// </summary>
+	uint32_t GetSize() const { return _size; }
+	/// <summary>
+	/// Gets the number of images that have been added to the atlas
+	/// </summary>
+	uint32_t GetImageCount() const { return _imageCount; }
+
+private:
+	uint32_t        _size;
+	uint32_t        _padding;
+	uint32_t        _imageCount;
+	bool            _isDirty;
+	Texture2D::sptr _texture;
+
+	std::unique_ptr<stbrp_context>  _packer;
+	std::vector<stbrp_node>         _nodes;
+};
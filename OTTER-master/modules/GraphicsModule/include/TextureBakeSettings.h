@@ -0,0 +1,102 @@
+#pragma once
+
+/// <summary>
+/// The formats that a texture can be stored in when it is baked (see TextureBaker)
+/// </summary>
+enum class TextureCompression
+{
+	/// <summary>
+	/// Keep the texture uncompressed, as R8, RG8 or RGBA8
+	/// </summary>
+	None = 0,
+	/// <summary>
+	/// Opaque RGB at 4 bits per texel
+	/// </summary>
+	BC1,
+	/// <summary>
+	/// RGB with a separately compressed alpha channel at 8 bits per texel
+	/// </summary>
+	BC3,
+	/// <summary>
+	/// A single channel at 4 bits per texel
+	/// </summary>
+	BC4,
+	/// <summary>
+	/// Two separately compressed channels at 8 bits per texel
+	/// </summary>
+	BC5,
+	/// <summary>
+	/// High quality RGBA at 8 bits per texel
+	/// </summary>
+	BC7,
+	/// <summary>
+	/// Let TextureBaker::ChooseCompression pick a format from the texture's channels and contents
+	/// </summary>
+	Auto
+};
+
+/// <summary>
+/// The filters that can be used to generate mip levels
+/// </summary>
+enum class MipFilter
+{
+	/// <summary>
+	/// Averages the texels that each texel of the smaller level covers, fast and never rings
+	/// </summary>
+	Box = 0,
+	/// <summary>
+	/// A Kaiser windowed sinc, which keeps smaller levels sharper at the cost of a little ringing around hard edges
+	/// </summary>
+	Kaiser
+};
+
+/// <summary>
+/// Describes what the color channels of a texture store, which decides how it is filtered
+/// </summary>
+enum class TextureColorSpace
+{
+	/// <summary>
+	/// Color data in the sRGB curve (most images). Mips are filtered in linear space, so they don't darken
+	/// </summary>
+	SRGB = 0,
+	/// <summary>
+	/// Data that is already linear (ex: masks or specular maps), filtered as-is
+	/// </summary>
+	Linear,
+	/// <summary>
+	/// A tangent space normal map, filtered as-is and then renormalized
+	/// </summary>
+	NormalMap,
+	/// <summary>
+	/// Use NormalMap for images with "normal" in their name, Linear for images with one or two channels, and SRGB otherwise
+	/// </summary>
+	Auto
+};
+
+/// <summary>
+/// Controls how a texture is processed when it is baked (see BakedTexture). These settings are part of the options
+/// hash of a baked texture, so changing them will re-bake any cached textures
+/// </summary>
+struct TextureBakeSettings
+{
+	/// <summary>
+	/// The format to store the texture in, by default the smallest one that suits the texture
+	/// </summary>
+	TextureCompression Compression = TextureCompression::Auto;
+	/// <summary>
+	/// True to generate a full chain of mip levels, down to 1x1
+	/// </summary>
+	bool               GenerateMips = true;
+	/// <summary>
+	/// The filter used to generate the mip levels
+	/// </summary>
+	MipFilter          Filter = MipFilter::Box;
+	/// <summary>
+	/// What the color channels of the texture store
+	/// </summary>
+	TextureColorSpace  ColorSpace = TextureColorSpace::Auto;
+	/// <summary>
+	/// True if the texture repeats, so filters wrap around the edges rather than clamping to them
+	/// </summary>
+	bool               WrapEdges = true;
+};
@@ -0,0 +1,114 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "TextureBakeSettings.h"
+#include "Texture2DData.h"
+
+/// <summary>
+/// An uncompressed image with 8 bits per channel, with rows packed tightly together
+/// </summary>
+struct TextureImage
+{
+	uint32_t             Width = 0;
+	uint32_t             Height = 0;
+	/// <summary>
+	/// The number of channels in each texel, 1 (R), 2 (RG) or 4 (RGBA)
+	/// </summary>
+	uint32_t             Channels = 0;
+	std::vector<uint8_t> Pixels;
+};
+
+/// <summary>
+/// The output of TextureBaker::Bake, a set of mip levels in their final format, ready to be written to a baked
+/// texture or uploaded
+/// </summary>
+struct TextureBakeResult
+{
+	InternalFormat              Format = InternalFormat::Unknown;
+	/// <summary>
+	/// The size and location of each mip level within a layer
+	/// </summary>
+	std::vector<Texture2DLevel> Levels;
+	/// <summary>
+	/// The number of layers, for texture arrays (see TextureBaker::BakeArray). Each layer stores all of it's levels
+	/// before the next layer starts
+	/// </summary>
+	uint32_t                    Layers = 1;
+	std::vector<uint8_t>        Data;
+};
+
+/// <summary>
+/// Prepares textures so that they can be uploaded without any work at load time, by generating their mip levels on
+/// the CPU and block compressing them (see BlockCompressor)
+///
+/// Mips are generated in floating point, each from the level above it, with a separable filter. Color data is
+/// converted out of sRGB before filtering and back afterwards, since averaging sRGB values directly darkens the
+/// smaller levels. The filters run across the job system, a row at a time, with SSE when it is available
+///
+/// Baking is deterministic, so baked textures are reproducible
+/// </summary>
+class TextureBaker
+{
+public:
+	/// <summary>
+	/// Bumped whenever the output of the baker changes, so that baked textures from older versions get re-baked
+	/// </summary>
+	static const uint32_t VERSION = 1;
+
+	/// <summary>
+	/// Converts decoded texture data into an image that can be baked. RGB data is expanded to RGBA, since there are
+	/// no compressed formats for RGB without alpha that we can't also use for RGBA
+	/// </summary>
+	static TextureImage FromData(const Texture2DData& data);
+
+	/// <summary>
+	/// Generates a full chain of mip levels for an image, down to 1x1. The first level is a copy of the image
+	/// </summary>
+	/// <param name="image">The full size image</param>
+	/// <param name="filter">The filter to downsample with</param>
+	/// <param name="colorSpace">What the color channels store, must not be Auto (see ResolveColorSpace)</param>
+	/// <param name="wrapEdges">True if the filter should wrap around the edges of the image, false to clamp to them</param>
+	static std::vector<TextureImage> GenerateMips(const TextureImage& image, MipFilter filter, TextureColorSpace colorSpace, bool wrapEdges);
+
+	/// <summary>
+	/// Picks a color space for a texture, if the settings leave it as Auto
+	/// </summary>
+	/// <param name="colorSpace">The color space from the bake settings</param>
+	/// <param name="name">The name or path of the texture</param>
+	/// <param name="channels">The number of channels in the texture</param>
+	static TextureColorSpace ResolveColorSpace(TextureColorSpace colorSpace, const std::string& name, uint32_t channels);
+
+	/// <summary>
+	/// Picks the smallest compressed format that suits an image. One and two channel images use BC4 and BC5, normal
+	/// maps and images with transparency use BC7, and other images use BC1. Images that are not a multiple of 4
+	/// texels in size are left uncompressed
+	/// </summary>
+	static TextureCompression ChooseCompression(const TextureImage& image, TextureColorSpace colorSpace);
+
+	/// <summary>
+	/// Gets the internal format that a texture will be stored in, given the compression and the number of channels
+	/// </summary>
+	static InternalFormat GetFormat(TextureCompression compression, uint32_t channels);
+
+	/// <summary>
+	/// Generates the mip levels for an image and compresses them, as the settings ask for
+	/// </summary>
+	/// <param name="image">The full size image to bake</param>
+	/// <param name="settings">How to process the image</param>
+	/// <param name="name">The name or path of the texture, used to detect normal maps and for logging</param>
+	static TextureBakeResult Bake(const TextureImage& image, const TextureBakeSettings& settings, const std::string& name = "");
+
+	/// <summary>
+	/// Bakes several images into the layers of a texture array, which all share one size, format and mip chain.
+	/// Layers larger than the smallest image are reduced to it's size through their mip chain, so the sizes must
+	/// differ by powers of two. If the compression is Auto, the layers are stored in the format that suits all of them
+	///
+	/// Throws a runtime_error if the images can't share an array (mismatched sizes or channel counts)
+	/// </summary>
+	/// <param name="images">The images to store in the layers, in order</param>
+	/// <param name="settings">How to process the images</param>
+	/// <param name="names">The names or paths of the images, used to detect normal maps and for logging</param>
+	static TextureBakeResult BakeArray(const std::vector<TextureImage>& images, const TextureBakeSettings& settings, const std::vector<std::string>& names);
+};
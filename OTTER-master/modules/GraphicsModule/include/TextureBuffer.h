@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+#include "ITexture.h"
+
+/// <summary>
+/// Represents a wrapper around an OpenGL buffer texture, which exposes a block of GPU memory to shaders as a
+/// 1D array of texels. These are useful for large blocks of per-vertex or per-instance data that are too big
+/// for uniforms, and can be read in a vertex shader with texelFetch:
+///		uniform samplerBuffer s_Data;
+///		vec4 value = texelFetch(s_Data, index);
+///
+/// Note that integer formats need an isamplerBuffer or usamplerBuffer in the shader instead
+/// </summary>
+class TextureBuffer final : public ITexture
+{
+public:
+	// We'll disallow moving and copying, since we want to manually control when the destructor is called
+	// We'll use these classes via pointers
+	TextureBuffer(const TextureBuffer& other) = delete;
+	TextureBuffer(TextureBuffer&& other) = delete;
+	TextureBuffer& operator=(const TextureBuffer& other) = delete;
+	TextureBuffer& operator=(TextureBuffer&& other) = delete;
+
+	typedef std::shared_ptr<TextureBuffer> sptr;
+	static inline sptr Create(GLenum format) {
+		return std::make_shared<TextureBuffer>(format);
+	}
+
+public:
+	/// <summary>
+	/// Creates a new, empty buffer texture
+	/// </summary>
+	/// <param name="format">The sized internal format of each texel (ex: GL_RGBA32F, GL_RGBA16I)</param>
+	TextureBuffer(GLenum format);
+	// ITexture handles destroying the texture, but we need to clean up our buffer
+	~TextureBuffer();
+
+	/// <summary>
+	/// Replaces the contents of the texture, the data must be laid out as a tightly packed array of texels
+	/// </summary>
+	/// <param name="data">The texels to upload</param>
+	/// <param name="size">The size of the data, in bytes</param>
+	void LoadData(const void* data, size_t size);
+
+	/// <summary>
+	/// Gets the sized internal format of the texels in this texture
+	/// </summary>
+	GLenum GetFormat() const { return _format; }
+	/// <summary>
+	/// Returns the handle of the buffer that stores the texels
+	/// </summary>
+	GLuint GetBufferHandle() const { return _buffer; }
+	/// <summary>
+	/// Gets the size of the texture's data, in bytes
+	/// </summary>
+	size_t GetSize() const { return _size; }
+	size_t GetGpuMemoryUsage() const { return _size; }
+
+protected:
+	GLenum _format;
+	GLuint _buffer;
+	size_t _size;
+};
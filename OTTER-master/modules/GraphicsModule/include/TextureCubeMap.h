@@ -62,6 +62,11 @@ public:
 
 	const TextureCubeDesc& GetDescription() const { return _description; }
 
+	/// <summary>
+	/// Gets the approximate amount of GPU memory used by this texture (all 6 faces), in bytes
+	/// </summary>
+	size_t GetGpuMemoryUsage() const { return 6 * static_cast<size_t>(_description.Size) * _description.Size * GetTexelSize(_description.Format); }
+
 private:
 	TextureCubeDesc _description;
 
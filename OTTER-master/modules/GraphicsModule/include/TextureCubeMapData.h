@@ -1,6 +1,7 @@
 #pragma once
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "TextureEnums.h"
 
@@ -70,6 +71,13 @@ public:
 	/// <returns>A pointer to the data created from the images</returns>
 	static TextureCubeMapData::sptr LoadFromImages(const std::string& rootImagePath);
 
+	/// <summary>
+	/// Gets the path to the image for a single face of a cube map, see LoadFromImages for the naming scheme
+	/// </summary>
+	/// <param name="rootImagePath">The base path for images, including extension</param>
+	/// <param name="face">The face to get the image path for</param>
+	static std::string GetFacePath(const std::string& rootImagePath, CubeMapFace face);
+
 	/// <summary>
 	/// Loads 2D image data into this cubemap data for the given face. Dimensions and format must match the existing size and formats
 	/// </summary>
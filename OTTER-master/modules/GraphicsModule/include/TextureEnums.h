@@ -5,6 +5,12 @@
 #include "Logging.h"
 #include "glad/glad.h"
 
+// Our glad loader does not include EXT_texture_compression_s3tc, but every desktop driver supports it
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT  0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
 // https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glTexImage2D.xhtml
 // These are some of our more common available internal formats
 ENUM(InternalFormat, GLint,
@@ -18,7 +24,15 @@ ENUM(InternalFormat, GLint,
 	RGB10        = GL_RGB10,
 	RGB16        = GL_RGB16,
 	RGBA8        = GL_RGBA8,
-	RGBA16       = GL_RGBA16
+	RGBA16       = GL_RGBA16,
+
+	// Block compressed formats, these store 4x4 blocks of texels and can only be uploaded from data that has
+	// already been compressed (see TextureBaker)
+	BC1          = GL_COMPRESSED_RGB_S3TC_DXT1_EXT,  // RGB, 8 bytes per block
+	BC3          = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, // RGBA, 16 bytes per block
+	BC4          = GL_COMPRESSED_RED_RGTC1,          // R, 8 bytes per block
+	BC5          = GL_COMPRESSED_RG_RGTC2,           // RG, 16 bytes per block
+	BC7          = GL_COMPRESSED_RGBA_BPTC_UNORM     // RGBA, 16 bytes per block
 
 	// Note: There are sized internal formats but there is a LOT of them
 );
@@ -126,4 +140,88 @@ constexpr GLint GetTexelComponentCount(PixelFormat format)
  */
 constexpr size_t GetTexelSize(PixelFormat format, PixelType type) {
 	return GetTexelComponentSize(type) * GetTexelComponentCount(format);
-}
\ No newline at end of file
+}
+
+/*
+ * Gets the approximate number of bytes the GPU uses to store a single texel of the given internal format
+ * @param format The internal format of the texture
+ * @returns The size of a single texel in GPU memory, in bytes
+ */
+constexpr size_t GetTexelSize(InternalFormat format) {
+	switch (format) {
+		case InternalFormat::R8:
+			return 1;
+		case InternalFormat::R16:
+		case InternalFormat::RG8:
+			return 2;
+		case InternalFormat::RGB8: // Most drivers pad RGB8 out to 4 bytes
+		case InternalFormat::RGB10:
+		case InternalFormat::RGBA8:
+		case InternalFormat::Depth:
+		case InternalFormat::DepthStencil:
+			return 4;
+		case InternalFormat::RGB16:
+		case InternalFormat::RGBA16:
+			return 8;
+		default:
+			return 0;
+	}
+}
+
+/*
+ * Returns true if the given internal format is block compressed
+ */
+constexpr bool IsCompressed(InternalFormat format) {
+	switch (format) {
+		case InternalFormat::BC1:
+		case InternalFormat::BC3:
+		case InternalFormat::BC4:
+		case InternalFormat::BC5:
+		case InternalFormat::BC7:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Gets the size of a single 4x4 block of a block compressed format
+ * @param format The internal format of the texture
+ * @returns The size of a single block in bytes, or 0 if the format is not compressed
+ */
+constexpr size_t GetBlockSize(InternalFormat format) {
+	switch (format) {
+		case InternalFormat::BC1:
+		case InternalFormat::BC4:
+			return 8;
+		case InternalFormat::BC3:
+		case InternalFormat::BC5:
+		case InternalFormat::BC7:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
+/*
+ * Gets the number of mip levels in a full mip chain for a texture of the given size, down to and including 1x1
+ */
+constexpr uint32_t GetMipLevelCount(uint32_t width, uint32_t height) {
+	uint32_t levels = 1;
+	for (uint32_t size = width > height ? width : height; size > 1; size >>= 1) {
+		levels++;
+	}
+	return levels;
+}
+
+/*
+ * Gets the approximate number of bytes the GPU uses to store a single mip level of a texture
+ * @param format The internal format of the texture
+ * @param width The width of the level, in texels
+ * @param height The height of the level, in texels
+ */
+constexpr size_t GetLevelSize(InternalFormat format, uint32_t width, uint32_t height) {
+	return IsCompressed(format) ?
+		static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format) :
+		static_cast<size_t>(width) * height * GetTexelSize(format);
+}
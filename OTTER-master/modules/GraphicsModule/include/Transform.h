@@ -4,45 +4,37 @@
 #include <GLM/glm.hpp>
 #include <GLM/gtc/quaternion.hpp>
 
+class TransformSystem;
+
 /// <summary>
-/// A simple transformation class, without parent/child relationships
+/// A transformation component, with optional parent/child relationships. The actual transform data lives in the
+/// scene's TransformSystem in structure of arrays form, this component is just a handle to it
 /// </summary>
 class Transform final
 {
 public:
 	struct TransformDirtyTag { };
 	
-	Transform(entt::handle gameObject) :
-		_isLocalDirty(true),
-		_localTransform(glm::mat4(1.0f)),
-		_normalMatrix(glm::mat3(1.0f)),
-		_isWorldDirty(true),
-		_worldTransform(glm::mat4(1.0f)),
-		_worldNormalMatrix(glm::mat3(1.0f)),
-		_rotation(glm::quat(1.0f, 0.0f, 0.0f, 0.0f)),
-		_rotationEulerDeg(glm::vec3(0.0f)),
-		_position(glm::vec3(0.0f)),
-		_scale(glm::vec3(1.0f)),
-		_parent(entt::null),
-		_gameObject(gameObject),
-		_hierarchyDepth(0)
-	{}
-	Transform(const Transform& other) = default;
-	Transform(Transform&& other) = default;
-	Transform& operator =(const Transform & other) = default;
-	Transform& operator =(Transform && other) = default;
-	virtual ~Transform() = default;
+	Transform(entt::handle gameObject);
+	/// <summary>
+	/// Creates a new transform in the same scene as other, with the same local transform and parent
+	/// </summary>
+	Transform(const Transform& other);
+	Transform(Transform&& other) noexcept;
+	Transform& operator =(const Transform & other);
+	Transform& operator =(Transform && other) noexcept;
+	~Transform();
 
 	// Rotation Getters/Setters
 
 	/// <summary>
 	/// Gets the local rotation of the transform in euler degrees
 	/// </summary>
-	const glm::vec3& GetLocalRotation() const { return _rotationEulerDeg; }
+	const glm::vec3& GetLocalRotation() const;
 	/// <summary>
 	/// Returns the local rotation as a quaternion
 	/// </summary>
-	const glm::quat& GetLocalRotationQuat() const { return _rotation; }
+	const glm::quat& GetLocalRotationQuat() const;
 	/// <summary>
 	/// Sets the local rotation of this transform to the given value in euler degrees
 	/// </summary>
@@ -69,7 +61,7 @@ public:
 	/// <summary>
 	/// Gets the local position of this transform
 	/// </summary>
-	const glm::vec3& GetLocalPosition() const { return _position; }
+	const glm::vec3& GetLocalPosition() const;
 	/// <summary>
 	/// Sets this transforms translation within it's local space
 	/// </summary>
@@ -90,7 +82,7 @@ public:
 	/// <summary>
 	/// Gets the local scale for this transform, along each axis
 	/// </summary>
-	const glm::vec3& GetLocalScale() const { return _scale; }
+	const glm::vec3& GetLocalScale() const;
 	/// <summary>
 	/// Sets this transforms scale within it's local space
 	/// </summary>
@@ -183,42 +175,49 @@ public:
 	/// </summary>
 	const glm::mat4& LocalTransform() const;
 	/// <summary>
-	/// Gets the local rotation matrix for this transform, updating it if required.
-	/// This is useful for calculating the normal matrix
+	/// Gets the local normal matrix for this transform
 	/// </summary>
-	const glm::mat3& NormalMatrix() const;
+	glm::mat3 NormalMatrix() const;
 
+	/// <summary>
+	/// Sets the parent of this transform, the parent must be in the same scene
+	/// </summary>
+	/// <param name="parent">The new parent, or a null handle to make this a root transform</param>
 	void SetParent(entt::handle parent);
 
+	/// <summary>
+	/// Recalculates the world matrix for just this transform, using the parent's current world matrix. World
+	/// matrices for the whole scene should be updated with TransformSystem::Update instead
+	/// </summary>
 	void UpdateWorldMatrix() const;
 
-	const glm::mat4& WorldTransform() const { return _worldTransform; }
-	const glm::mat3& WorldNormalMatrix() const { return _worldNormalMatrix; };
+	/// <summary>
+	/// Gets the world transformation matrix, as of the last time the world matrices were updated
+	/// </summary>
+	const glm::mat4& WorldTransform() const;
+	/// <summary>
+	/// Gets the world normal matrix, as of the last time the world matrices were updated
+	/// </summary>
+	const glm::mat3& WorldNormalMatrix() const;
 
 	/// <summary>
 	/// Gets the depth of this transform within the scene hierarchy (ie. how many parents
 	/// to the root)
 	/// </summary>
 	/// <returns></returns>
-	int GetHierarchyDepth() const { return _hierarchyDepth; }
-
-private:
-	mutable bool _isLocalDirty;
-	mutable glm::mat4 _localTransform;
-	mutable glm::mat3 _normalMatrix;
+	int GetHierarchyDepth() const;
 
-	mutable bool _isWorldDirty;
-	mutable glm::mat4 _worldTransform;
-	mutable glm::mat3 _worldNormalMatrix;
-	
-	glm::quat _rotation;
-	glm::vec3 _rotationEulerDeg;
-	glm::vec3 _position;
-	glm::vec3 _scale;
+	/// <summary>
+	/// Gets the system that stores this transform's data
+	/// </summary>
+	const std::shared_ptr<TransformSystem>& GetSystem() const { return _system; }
+	/// <summary>
+	/// Gets the slot that this transform's data is stored at within it's system
+	/// </summary>
+	uint32_t GetSlot() const { return _slot; }
 
-	entt::entity _parent;
+private:
+	std::shared_ptr<TransformSystem> _system;
+	uint32_t _slot;
 	entt::handle _gameObject;
-	int _hierarchyDepth;
-
-	void _UpdateLocalTransformIfDirty() const;
 };
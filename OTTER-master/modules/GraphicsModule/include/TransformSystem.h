@@ -0,0 +1,225 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <entt.hpp>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/quaternion.hpp>
+
+/// <summary>
+/// The transform system stores the transforms of every object in a scene in structure of arrays form, so that
+/// world matrices can be updated in tight loops without touching any other data. Transform components are just
+/// handles into the system
+///
+/// Transforms are grouped into levels by their depth in the hierarchy. Each level only depends on the one above
+/// it, so levels are updated in order, and the transforms within a level are updated in parallel. A transform is
+/// only recalculated when it or one of it's parents has changed, so static parts of the scene cost almost nothing
+///
+/// When the simulation runs at a fixed rate (see FrameScheduler), transforms that are moved during a fixed step are
+/// drawn part way between their previous and current fixed states, so motion stays smooth when we render faster or
+/// slower than we simulate. Transforms changed outside of a fixed step snap straight to their new value
+/// </summary>
+class TransformSystem final
+{
+public:
+	typedef std::shared_ptr<TransformSystem> sptr;
+	static inline sptr Create() {
+		return std::make_shared<TransformSystem>();
+	}
+	// We'll disallow moving and copying, since transforms hold a pointer to us
+	TransformSystem(const TransformSystem& other) = delete;
+	TransformSystem(TransformSystem&& other) = delete;
+	TransformSystem& operator=(const TransformSystem& other) = delete;
+	TransformSystem& operator=(TransformSystem&& other) = delete;
+
+	/// <summary>
+	/// Used for transforms that do not have a parent
+	/// </summary>
+	static const uint32_t INVALID = ~0u;
+	/// <summary>
+	/// Levels with fewer transforms than this are updated on the calling thread, since it isn't worth waking the workers
+	/// </summary>
+	static const size_t PARALLEL_CHUNK_SIZE = 2048;
+
+public:
+	TransformSystem();
+	~TransformSystem() = default;
+
+	/// <summary>
+	/// Gets the transform system for a registry, creating it the first time it is needed
+	/// </summary>
+	static const sptr& Get(entt::registry& registry);
+
+	/// <summary>
+	/// Creates a new root transform at the origin, returning it's slot
+	/// </summary>
+	/// <param name="entity">The entity that the transform belongs to, for debugging</param>
+	uint32_t Allocate(entt::entity entity = entt::null);
+	/// <summary>
+	/// Makes room for at least this many transforms, so that allocating a large batch (ex: loading a scene) doesn't
+	/// keep growing every array
+	/// </summary>
+	void Reserve(size_t count);
+	/// <summary>
+	/// Releases a transform's slot so that it can be re-used. Any children of the transform become roots
+	/// </summary>
+	void Free(uint32_t slot);
+
+	/// <summary>
+	/// Sets the parent of a transform, moving it and all of it's children to their new hierarchy depth. This only
+	/// touches the transform's subtree, so it is cheap enough to do at runtime
+	/// </summary>
+	/// <param name="slot">The transform to re-parent</param>
+	/// <param name="parent">The new parent, or INVALID to make the transform a root</param>
+	void SetParent(uint32_t slot, uint32_t parent);
+	/// <summary>
+	/// Gets the parent of a transform, or INVALID if it is a root
+	/// </summary>
+	uint32_t GetParent(uint32_t slot) const { return _parents[slot]; }
+	/// <summary>
+	/// Gets the first child of a transform, or INVALID if it has no children
+	/// </summary>
+	uint32_t GetFirstChild(uint32_t slot) const { return _firstChildren[slot]; }
+	/// <summary>
+	/// Gets the next child of a transform's parent, or INVALID if this is the last one
+	/// </summary>
+	uint32_t GetNextSibling(uint32_t slot) const { return _nextSiblings[slot]; }
+	/// <summary>
+	/// Gets the number of parents between a transform and the root of it's hierarchy
+	/// </summary>
+	int GetDepth(uint32_t slot) const { return _depths[slot]; }
+	/// <summary>
+	/// Gets the entity that a transform belongs to
+	/// </summary>
+	entt::entity GetEntity(uint32_t slot) const { return _entities[slot]; }
+
+	const glm::vec3& GetPosition(uint32_t slot) const { return _positions[slot]; }
+	void SetPosition(uint32_t slot, const glm::vec3& value) { _positions[slot] = value; _MarkDirty(slot); }
+	const glm::quat& GetRotation(uint32_t slot) const { return _rotations[slot]; }
+	/// <summary>
+	/// Gets the rotation of a transform in euler degrees, as it was last set
+	/// </summary>
+	const glm::vec3& GetRotationEuler(uint32_t slot) const { return _rotationsEuler[slot]; }
+	void SetRotation(uint32_t slot, const glm::quat& value, const glm::vec3& eulerDegrees) {
+		_rotations[slot] = value; _rotationsEuler[slot] = eulerDegrees; _MarkDirty(slot);
+	}
+	const glm::vec3& GetScale(uint32_t slot) const { return _scales[slot]; }
+	void SetScale(uint32_t slot, const glm::vec3& value) { _scales[slot] = value; _MarkDirty(slot); }
+
+	/// <summary>
+	/// Gets the local transformation matrix of a transform, calculating it if it is out of date
+	/// </summary>
+	const glm::mat4& GetLocalMatrix(uint32_t slot);
+	/// <summary>
+	/// Gets the normal matrix for the local transform, this is not cached so it should be used sparingly
+	/// </summary>
+	glm::mat3 GetLocalNormalMatrix(uint32_t slot);
+	/// <summary>
+	/// Gets the world matrix of a transform, as of the last Update
+	/// </summary>
+	const glm::mat4& GetWorldMatrix(uint32_t slot) const { return _worlds[slot]; }
+	/// <summary>
+	/// Gets the world normal matrix of a transform, as of the last Update
+	/// </summary>
+	const glm::mat3& GetWorldNormalMatrix(uint32_t slot) const { return _worldNormals[slot]; }
+
+	/// <summary>
+	/// Updates the world matrices of every transform that has changed since the last update
+	/// </summary>
+	/// <param name="parallel">True to spread large levels across the job system, false to stay on the calling thread</param>
+	void Update(bool parallel = true);
+	/// <summary>
+	/// Recalculates the world matrix for a single transform using it's parent's current world matrix, regardless
+	/// of whether it has changed. Prefer Update, which only touches transforms that have changed
+	/// </summary>
+	void UpdateSingle(uint32_t slot);
+
+	/// <summary>
+	/// Marks the start of a fixed simulation step. The current local transforms become the previous state that we
+	/// interpolate from, and any changes made until EndFixedStep are interpolated
+	/// </summary>
+	void BeginFixedStep();
+	/// <summary>
+	/// Marks the end of a fixed simulation step
+	/// </summary>
+	void EndFixedStep() { _inFixedStep = false; }
+	/// <summary>
+	/// Sets how far we are between the previous and current fixed states, from 0 to 1. World matrices calculated by
+	/// the next Update use this for any transform that moved in the last fixed step. Local transforms (and the
+	/// getters) always return the current state
+	/// </summary>
+	void SetInterpolation(float alpha);
+	float GetInterpolation() const { return _alpha; }
+
+	/// <summary>
+	/// Gets the number of transforms that are currently allocated
+	/// </summary>
+	size_t GetCount() const { return _entities.size() - _freeSlots.size(); }
+	/// <summary>
+	/// Gets the number of hierarchy levels, ie the depth of the deepest transform plus one
+	/// </summary>
+	size_t GetLevelCount() const { return _levels.size(); }
+	/// <summary>
+	/// Gets the number of world matrices that were recalculated during the last Update
+	/// </summary>
+	size_t GetLastUpdateCount() const { return _lastUpdateCount; }
+
+private:
+	// Local transform
+	std::vector<glm::vec3> _positions;
+	std::vector<glm::quat> _rotations;
+	std::vector<glm::vec3> _rotationsEuler;
+	std::vector<glm::vec3> _scales;
+	std::vector<glm::mat4> _locals;
+
+	// The local transform at the start of the last fixed step, for interpolation
+	std::vector<glm::vec3> _prevPositions;
+	std::vector<glm::quat> _prevRotations;
+	std::vector<glm::vec3> _prevScales;
+	// Whether each transform was moved in the last fixed step, and so should be interpolated
+	std::vector<uint8_t>   _interpolated;
+	bool                   _inFixedStep;
+	float                  _alpha;
+
+	// World transform
+	std::vector<glm::mat4> _worlds;
+	std::vector<glm::mat3> _worldNormals;
+	// The square of the world scale if it is uniform, or 0 if it is not. Lets us skip inverting the world matrix
+	std::vector<float>     _worldScalesSq;
+
+	// Flags, stored as bytes so that threads writing to neighbouring transforms don't race
+	std::vector<uint8_t>   _localDirty;
+	std::vector<uint8_t>   _worldDirty;
+	// Whether the world matrix changed in the current update, children need to update if their parent changed
+	std::vector<uint8_t>   _changed;
+
+	// Hierarchy, the children of each transform form a doubly linked list so they can be unlinked in O(1)
+	std::vector<uint32_t>     _parents;
+	std::vector<uint32_t>     _firstChildren;
+	std::vector<uint32_t>     _nextSiblings;
+	std::vector<uint32_t>     _prevSiblings;
+	std::vector<int>          _depths;
+	// The index of each transform within it's level
+	std::vector<uint32_t>     _levelIndices;
+	std::vector<entt::entity> _entities;
+
+	// The slots in each hierarchy level, level 0 holds all the roots
+	std::vector<std::vector<uint32_t>> _levels;
+	std::vector<uint32_t>              _freeSlots;
+	// Scratch space for walking subtrees without recursion
+	std::vector<uint32_t>              _walkStack;
+
+	std::atomic<size_t> _lastUpdateCount;
+
+	void _MarkDirty(uint32_t slot) { _localDirty[slot] = 1; _worldDirty[slot] = 1; _interpolated[slot] = _inFixedStep ? 1 : 0; }
+	void _LinkChild(uint32_t slot, uint32_t parent);
+	void _UnlinkChild(uint32_t slot);
+	void _SetDepth(uint32_t slot, int depth);
+	void _AddToLevel(uint32_t slot, int depth);
+	void _RemoveFromLevel(uint32_t slot);
+	// Updates the world matrix for a transform if it or it's parent changed, returning true if it was updated
+	bool _UpdateWorld(uint32_t slot);
+	void _CalculateWorld(uint32_t slot);
+	void _UpdateLocal(uint32_t slot);
+};
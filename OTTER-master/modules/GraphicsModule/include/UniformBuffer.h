@@ -0,0 +1,50 @@
+#pragma once
+#include "IBuffer.h"
+#include <memory>
+
+/// <summary>
+/// The uniform buffer stores a block of uniform data (laid out with std140 rules) that can be shared between all
+/// shaders that declare a matching uniform block. See Shader::SetUniformBlockBinding
+/// </summary>
+class UniformBuffer : public IBuffer
+{
+public:
+	typedef std::shared_ptr<UniformBuffer> sptr;
+	static inline sptr Create(GLenum usage = GL_DYNAMIC_DRAW) {
+		return std::make_shared<UniformBuffer>(usage);
+	}
+
+public:
+	/// <summary>
+	/// Creates a new uniform buffer, with the given usage. Data will still need to be uploaded before it can be used
+	/// </summary>
+	/// <param name="usage">The usage hint for the buffer, default is GL_DYNAMIC_DRAW since most blocks change every frame</param>
+	UniformBuffer(GLenum usage = GL_DYNAMIC_DRAW) : IBuffer(GL_UNIFORM_BUFFER, usage) { }
+
+	/// <summary>
+	/// Updates the contents of the buffer, re-using the existing storage if the size has not changed
+	/// </summary>
+	/// <typeparam name="T">The type of the block, this must match the std140 layout of the block in the shader</typeparam>
+	/// <param name="data">The data to upload</param>
+	template <typename T>
+	void Update(const T& data) {
+		if (_elementSize == sizeof(T) && _elementCount == 1) {
+			glNamedBufferSubData(_handle, 0, sizeof(T), &data);
+		} else {
+			IBuffer::LoadData(&data, sizeof(T), 1);
+		}
+	}
+
+	// Keep IBuffer::Bind() visible alongside our overload
+	using IBuffer::Bind;
+	/// <summary>
+	/// Binds this buffer to the given uniform buffer binding point
+	/// </summary>
+	/// <param name="binding">The binding point to bind to</param>
+	void Bind(GLuint binding) { glBindBufferBase(GL_UNIFORM_BUFFER, binding, _handle); }
+
+	/// <summary>
+	/// Unbinds the current uniform buffer
+	/// </summary>
+	static void UnBind() { IBuffer::UnBind(GL_UNIFORM_BUFFER); }
+};
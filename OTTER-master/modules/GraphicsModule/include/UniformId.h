@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// A compile-time hashed uniform name. Shaders resolve the locations of all of their active uniforms when they are
+/// linked, so looking a uniform up by ID is a single integer hash lookup, with no strings built or compared. IDs
+/// should be declared once as constants and re-used:
+///		static constexpr UniformId U_MODEL("u_Model");
+///		shader->SetUniformMatrix(U_MODEL, transform);
+/// </summary>
+struct UniformId
+{
+	/// <summary>
+	/// The 64-bit FNV-1a hash of the uniform name
+	/// </summary>
+	uint64_t    Hash;
+	/// <summary>
+	/// The name of the uniform, only used for debugging
+	/// </summary>
+	const char* Name;
+
+	/// <summary>
+	/// Creates a uniform ID from a string literal, this is explicit so that passing a literal to SetUniform still
+	/// selects the string overload
+	/// </summary>
+	template <size_t N>
+	explicit constexpr UniformId(const char(&name)[N]) : Hash(HashName(name, N - 1)), Name(name) {}
+
+	/// <summary>
+	/// Hashes a uniform name, this matches the hash used by the UniformId constructor
+	/// </summary>
+	/// <param name="name">The name to hash</param>
+	/// <param name="length">The number of characters in the name</param>
+	static constexpr uint64_t HashName(const char* name, size_t length) {
+		uint64_t result = 0xcbf29ce484222325ull;
+		for (size_t ix = 0; ix < length; ix++) {
+			result ^= static_cast<uint8_t>(name[ix]);
+			result *= 0x100000001b3ull;
+		}
+		return result;
+	}
+
+	bool operator ==(const UniformId& r) const { return Hash == r.Hash; }
+	bool operator !=(const UniformId& r) const { return Hash != r.Hash; }
+};
+
+/// <summary>
+/// The IDs are already well distributed hashes, so we can use them as-is in hash maps
+/// </summary>
+struct UniformIdHasher {
+	size_t operator()(uint64_t hash) const noexcept { return static_cast<size_t>(hash); }
+};
@@ -6,6 +6,10 @@
 
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
+#include "InstanceBuffer.h"
+#include "MeshBounds.h"
+#include "VertexPacking.h"
+#include "MeshLod.h"
 
 /// <summary>
 /// We'll use this just to make it more clear what the intended usage of an attribute is in our code!
@@ -128,7 +132,71 @@ public:
 	/// </summary>
 	GLuint GetHandle() const { return _handle; }
 
-	void Render() const;
+	/// <summary>
+	/// Renders this VAO
+	/// </summary>
+	/// <param name="lod">The level of detail to draw, see SetLods</param>
+	void Render(uint32_t lod = 0) const;
+	/// <summary>
+	/// Renders multiple instances of this VAO with a single draw call, pulling per-instance data from the given buffer
+	/// </summary>
+	/// <param name="instances">The buffer containing the instance data</param>
+	/// <param name="baseInstance">The index of the first instance in the buffer, as returned by InstanceBuffer::Push</param>
+	/// <param name="count">The number of instances to draw</param>
+	/// <param name="lod">The level of detail to draw, see SetLods</param>
+	void RenderInstanced(const InstanceBuffer& instances, uint32_t baseInstance, uint32_t count, uint32_t lod = 0) const;
+
+	/// <summary>
+	/// Sets the levels of detail that are stored in the index buffer, these are set automatically when baking meshes.
+	/// An empty list means the whole index buffer is a single level
+	/// </summary>
+	void SetLods(const std::vector<MeshLod>& lods) { _lods = lods; }
+	/// <summary>
+	/// Gets the levels of detail of this mesh, which may be empty if it only has a single level
+	/// </summary>
+	const std::vector<MeshLod>& GetLods() const { return _lods; }
+	/// <summary>
+	/// Gets the number of levels of detail this mesh can be drawn at, always at least 1
+	/// </summary>
+	uint32_t GetLodCount() const { return _lods.empty() ? 1u : static_cast<uint32_t>(_lods.size()); }
+	/// <summary>
+	/// Gets the number of triangles drawn at the given level of detail
+	/// </summary>
+	uint32_t GetTriangleCount(uint32_t lod = 0) const;
+
+	/// <summary>
+	/// Gets the total size of all the buffers bound to this VAO, in bytes
+	/// </summary>
+	size_t GetGpuMemoryUsage() const;
+
+	/// <summary>
+	/// Sets the model space bounds of this mesh, these are calculated automatically when baking meshes
+	/// </summary>
+	/// <param name="bounds">The new bounds, or invalid bounds to prevent the mesh from ever being culled</param>
+	void SetBounds(const MeshBounds& bounds) { _bounds = bounds; }
+	/// <summary>
+	/// Gets the model space bounds of this mesh, these may be invalid if the extent of the mesh is not known
+	/// </summary>
+	const MeshBounds& GetBounds() const { return _bounds; }
+
+	/// <summary>
+	/// Sets the decode that takes the positions stored in the vertex buffers to model space, for meshes with quantized
+	/// positions. This is set automatically when baking meshes
+	/// </summary>
+	void SetVertexDecode(const VertexDecode& decode) {
+		_hasVertexDecode = !decode.IsIdentity();
+		_vertexDecode = decode.ToMatrix();
+	}
+	/// <summary>
+	/// Returns true if the positions in this mesh need to be decoded, see ApplyVertexDecode
+	/// </summary>
+	bool HasVertexDecode() const { return _hasVertexDecode; }
+	/// <summary>
+	/// Gets the model matrix to render this mesh with, folding the decode for quantized positions into the given
+	/// transform. Normals are not quantized this way, so normal matrices should still come from the original transform
+	/// </summary>
+	/// <param name="model">The world transform of the object being rendered</param>
+	glm::mat4 ApplyVertexDecode(const glm::mat4& model) const { return _hasVertexDecode ? model * _vertexDecode : model; }
 	
 protected:
 	// Helper structure to store a buffer and the attributes
@@ -144,6 +212,18 @@ protected:
 	std::vector<VertexBufferBinding> _vertexBuffers;
 
 	GLsizei _vertexCount;
+
+	// The model space extent of the mesh, used for culling
+	MeshBounds _bounds;
+	// Takes quantized positions to model space, see SetVertexDecode
+	glm::mat4  _vertexDecode;
+	bool       _hasVertexDecode;
+	// The ranges of the index buffer to draw for each level of detail, see SetLods
+	std::vector<MeshLod> _lods;
+
+	// The generation of the instance buffer that our instance attributes are currently set up for, see
+	// InstanceBuffer::GetGeneration
+	mutable uint64_t _instanceBufferGeneration;
 	
 	// The underlying OpenGL handle that this class is wrapping around
 	GLuint _handle;
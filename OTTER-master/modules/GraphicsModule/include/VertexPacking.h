@@ -0,0 +1,143 @@
+#pragma once
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include <GLM/glm.hpp>
+#include <GLM/gtc/packing.hpp>
+
+/// <summary>
+/// The vertex formats that a mesh can be converted to with MeshBuilder::Convert, from largest to smallest
+/// </summary>
+enum class VertexFormat
+{
+	/// <summary>
+	/// Keep all attributes as floats (VertexPosNormTexCol, 48 bytes)
+	/// </summary>
+	Float = 0,
+	/// <summary>
+	/// Float positions, with packed normals, half float UVs and 8 bit colors (VertexPosNormTexColCompact, 24 bytes)
+	/// </summary>
+	Compact,
+	/// <summary>
+	/// Like Compact, but with 16 bit positions relative to the mesh bounds (VertexPosNormTexColQuantized, 20 bytes)
+	/// </summary>
+	Quantized,
+	/// <summary>
+	/// Let MeshBuilder::ChooseVertexFormat pick the smallest format that keeps the mesh within tolerance
+	/// </summary>
+	Auto
+};
+
+/// <summary>
+/// Describes how to get model space positions back from quantized vertex positions, position = stored * Scale + Offset.
+/// Rather than decoding in the shader, renderers fold this into the model matrix (see VertexArrayObject::ApplyVertexDecode),
+/// which is free
+/// </summary>
+struct VertexDecode
+{
+	glm::vec3 Scale;
+	glm::vec3 Offset;
+
+	VertexDecode() : Scale(glm::vec3(1.0f)), Offset(glm::vec3(0.0f)) {}
+	VertexDecode(const glm::vec3& scale, const glm::vec3& offset) : Scale(scale), Offset(offset) {}
+
+	/// <summary>
+	/// Returns true if positions are stored as-is, and don't need decoding
+	/// </summary>
+	bool IsIdentity() const { return Scale == glm::vec3(1.0f) && Offset == glm::vec3(0.0f); }
+
+	/// <summary>
+	/// Gets the decode as a matrix, to be applied before the model matrix
+	/// </summary>
+	glm::mat4 ToMatrix() const {
+		glm::mat4 result(1.0f);
+		result[0][0] = Scale.x;
+		result[1][1] = Scale.y;
+		result[2][2] = Scale.z;
+		result[3] = glm::vec4(Offset, 1.0f);
+		return result;
+	}
+};
+
+/// <summary>
+/// Helpers for packing vertex attributes into the formats used by the compact vertex types. Each of these matches
+/// what OpenGL does when reading the attribute with normalized set, so the shader receives regular floats
+/// </summary>
+namespace VertexPacking
+{
+	/// <summary>
+	/// Packs a unit vector into 10 bits per component, read with GL_INT_2_10_10_10_REV. Maximum error is about 0.001
+	/// </summary>
+	inline uint32_t PackNormal(const glm::vec3& normal) {
+		return glm::packSnorm3x10_1x2(glm::vec4(normal, 0.0f));
+	}
+	/// <summary>
+	/// Packs a tangent and it's handedness (w, either 1 or -1) into 10 bits per component, read with GL_INT_2_10_10_10_REV
+	/// </summary>
+	inline uint32_t PackTangent(const glm::vec4& tangent) {
+		return glm::packSnorm3x10_1x2(glm::vec4(glm::vec3(tangent), tangent.w < 0.0f ? -1.0f : 1.0f));
+	}
+	inline glm::vec4 UnpackNormal(uint32_t packed) {
+		return glm::unpackSnorm3x10_1x2(packed);
+	}
+
+	/// <summary>
+	/// Packs a texture coordinate into 2 half floats, read with GL_HALF_FLOAT
+	/// </summary>
+	inline uint32_t PackUV(const glm::vec2& uv) {
+		return glm::packHalf2x16(uv);
+	}
+	inline glm::vec2 UnpackUV(uint32_t packed) {
+		return glm::unpackHalf2x16(packed);
+	}
+
+	/// <summary>
+	/// Packs a color into 8 bits per channel (RGBA in memory order), read with GL_UNSIGNED_BYTE
+	/// </summary>
+	inline uint32_t PackColor(const glm::vec4& color) {
+		return glm::packUnorm4x8(color);
+	}
+	inline glm::vec4 UnpackColor(uint32_t packed) {
+		return glm::unpackUnorm4x8(packed);
+	}
+
+	/// <summary>
+	/// Gets the decode that maps 16 bit signed normalized positions onto the given bounds. Flat axes still get a scale
+	/// of 1, so the decode matrix is never singular
+	/// </summary>
+	inline VertexDecode MakePositionDecode(const glm::vec3& min, const glm::vec3& max) {
+		glm::vec3 scale = (max - min) * 0.5f;
+		for (int ix = 0; ix < 3; ix++) {
+			scale[ix] = scale[ix] > 0.0f ? scale[ix] : 1.0f;
+		}
+		return VertexDecode(scale, (min + max) * 0.5f);
+	}
+	/// <summary>
+	/// Quantizes a position to 16 bits per component, read with GL_SHORT (normalized)
+	/// </summary>
+	inline void PackPosition(const glm::vec3& position, const VertexDecode& decode, int16_t* result) {
+		const glm::vec3 normalized = glm::clamp((position - decode.Offset) / decode.Scale, -1.0f, 1.0f);
+		for (int ix = 0; ix < 3; ix++) {
+			result[ix] = static_cast<int16_t>(std::round(normalized[ix] * 32767.0f));
+		}
+	}
+	inline glm::vec3 UnpackPosition(const int16_t* packed, const VertexDecode& decode) {
+		const glm::vec3 normalized = glm::max(glm::vec3(packed[0], packed[1], packed[2]) / 32767.0f, glm::vec3(-1.0f));
+		return normalized * decode.Scale + decode.Offset;
+	}
+
+	/// <summary>
+	/// Gets the largest error from storing a value of the given magnitude as a half float
+	/// </summary>
+	inline float HalfError(float magnitude) {
+		if (magnitude <= 0.0f) {
+			return 0.0f;
+		}
+		// Halfs have 10 bits of mantissa, so the spacing between values is 2^-10 of the power of two below the value,
+		// and the error is half of that (denormals below 2^-14 have a fixed spacing)
+		int exponent;
+		std::frexp(std::max(magnitude, 6.103515625e-05f), &exponent);
+		return std::ldexp(1.0f, exponent - 12);
+	}
+}
@@ -2,6 +2,7 @@
 
 #include <GLM/glm.hpp>
 #include <VertexArrayObject.h>
+#include <VertexPacking.h>
 
 struct VertexPosCol {
 	glm::vec3 Position;
@@ -57,4 +58,42 @@ struct VertexPosNormTexCol {
 		Position({ x, y, z }), Normal({ nX, nY, nZ }), UV({ u, v }), Color({r, g, b, a}) {}
 
 	static const std::vector<BufferAttribute> V_DECL;
-};
\ No newline at end of file
+};
+
+/// <summary>
+/// A half size version of VertexPosNormTexCol (24 bytes), with 10 bit normals, half float UVs and 8 bit colors. These
+/// are all decoded when the attributes are read, so it works with the same shaders as VertexPosNormTexCol. See VertexPacking
+/// </summary>
+struct VertexPosNormTexColCompact {
+	glm::vec3 Position;
+	uint32_t  Normal;
+	uint32_t  UV;
+	uint32_t  Color;
+
+	VertexPosNormTexColCompact() : Position(glm::vec3(0.0f)), Normal(0), UV(0), Color(0xFF000000u) {}
+	VertexPosNormTexColCompact(const glm::vec3& pos, const glm::vec3& norm, const glm::vec2& uv, const glm::vec4& col) :
+		Position(pos), Normal(VertexPacking::PackNormal(norm)), UV(VertexPacking::PackUV(uv)), Color(VertexPacking::PackColor(col)) {}
+
+	static const std::vector<BufferAttribute> V_DECL;
+};
+
+/// <summary>
+/// Like VertexPosNormTexColCompact, but with 16 bit positions relative to the bounds of the mesh (20 bytes). Meshes
+/// using this should be made with MeshBuilder::Convert, which keeps track of the VertexDecode needed to get back
+/// to model space. The decode is applied by the renderer, see VertexArrayObject::ApplyVertexDecode
+/// </summary>
+struct VertexPosNormTexColQuantized {
+	int16_t   Position[3];
+	int16_t   Padding;
+	uint32_t  Normal;
+	uint32_t  UV;
+	uint32_t  Color;
+
+	VertexPosNormTexColQuantized() : Position{ 0, 0, 0 }, Padding(0), Normal(0), UV(0), Color(0xFF000000u) {}
+	VertexPosNormTexColQuantized(const glm::vec3& pos, const VertexDecode& decode, const glm::vec3& norm, const glm::vec2& uv, const glm::vec4& col) :
+		Padding(0), Normal(VertexPacking::PackNormal(norm)), UV(VertexPacking::PackUV(uv)), Color(VertexPacking::PackColor(col)) {
+		VertexPacking::PackPosition(pos, decode, Position);
+	}
+
+	static const std::vector<BufferAttribute> V_DECL;
+};
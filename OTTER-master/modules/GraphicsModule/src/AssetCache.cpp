@@ -0,0 +1,270 @@
+#include "AssetCache.h"
+
+#include <filesystem>
+
+#include "ObjLoader.h"
+#include "NotObjLoader.h"
+#include "Logging.h"
+
+std::mutex AssetCache::_lock;
+std::unordered_map<std::string, AssetCache::Entry> AssetCache::_entries;
+uint64_t AssetCache::_hits = 0;
+uint64_t AssetCache::_misses = 0;
+
+VertexArrayObject::sptr AssetCache::LoadObj(const std::string& path, const glm::vec4& inColor) {
+	return _GetOrLoad<VertexArrayObject>(GetObjKey(path, inColor), [&]() {
+		return ObjLoader::LoadFromFile(path, inColor);
+	});
+}
+
+VertexArrayObject::sptr AssetCache::LoadNotObj(const std::string& path) {
+	return _GetOrLoad<VertexArrayObject>(GetNotObjKey(path), [&]() {
+		return NotObjLoader::LoadFromFile(path);
+	});
+}
+
+Texture2D::sptr AssetCache::LoadTexture2D(const std::string& path) {
+	return _GetOrLoad<Texture2D>(GetTexture2DKey(path), [&]() {
+		return Texture2D::LoadFromFile(path);
+	});
+}
+
+TextureCubeMap::sptr AssetCache::LoadCubeMap(const std::string& path) {
+	return _GetOrLoad<TextureCubeMap>(GetCubeMapKey(path), [&]() {
+		return TextureCubeMap::LoadFromImages(path);
+	});
+}
+
+Texture2DArray::sptr AssetCache::LoadTexture2DArray(const std::string& cachePath, const std::vector<std::string>& sourcePaths) {
+	return _GetOrLoad<Texture2DArray>(GetTexture2DArrayKey(cachePath, sourcePaths), [&]() {
+		return Texture2DArray::LoadFromFiles(cachePath, sourcePaths);
+	});
+}
+
+MorphAnimation::sptr AssetCache::LoadMorphAnimation(const std::vector<std::string>& framePaths, bool quantize) {
+	return _GetOrLoad<MorphAnimation>(GetMorphAnimationKey(framePaths, quantize), [&]() {
+		return MorphAnimation::LoadFromFiles(framePaths, quantize);
+	});
+}
+
+std::string AssetCache::GetObjKey(const std::string& path, const glm::vec4& inColor) {
+	return _MakeKey("obj", path, fmt::format("{},{},{},{}", inColor.r, inColor.g, inColor.b, inColor.a));
+}
+
+std::string AssetCache::GetNotObjKey(const std::string& path) {
+	return _MakeKey("notobj", path);
+}
+
+std::string AssetCache::GetTexture2DKey(const std::string& path) {
+	return _MakeKey("tex2d", path);
+}
+
+std::string AssetCache::GetCubeMapKey(const std::string& path) {
+	return _MakeKey("cube", path);
+}
+
+std::string AssetCache::GetTexture2DArrayKey(const std::string& cachePath, const std::vector<std::string>& sourcePaths) {
+	// Every layer is part of the key, so arrays that share a baked path but not their sources don't collide
+	std::string result = _MakeKey("tex2darray", cachePath);
+	for (const std::string& sourcePath : sourcePaths) {
+		result += "|";
+		result += _MakeKey("layer", sourcePath);
+	}
+	return result;
+}
+
+std::string AssetCache::GetMorphAnimationKey(const std::vector<std::string>& framePaths, bool quantize) {
+	// Every frame is part of the key, since sequences may share their first frame
+	std::string result = fmt::format("morph|{}", quantize);
+	for (const std::string& framePath : framePaths) {
+		result += "|";
+		result += _MakeKey("frame", framePath);
+	}
+	return result;
+}
+
+size_t AssetCache::Collect() {
+	std::lock_guard<std::mutex> lock(_lock);
+	size_t evicted = 0;
+	for (auto it = _entries.begin(); it != _entries.end();) {
+		// Entries that are still loading have not had their asset assigned yet, so we need to keep them around
+		if (it->second.Asset.expired() && !it->second.Pending.valid() && it->second.Streaming.expired()) {
+			it = _entries.erase(it);
+			evicted++;
+		} else {
+			++it;
+		}
+	}
+	return evicted;
+}
+
+AssetCache::Stats AssetCache::GetStats() {
+	Collect();
+
+	std::lock_guard<std::mutex> lock(_lock);
+	Stats result;
+	result.Hits = _hits;
+	result.Misses = _misses;
+	result.ResidentCount = 0;
+	result.ResidentBytes = 0;
+	for (const auto& [key, entry] : _entries) {
+		if (!entry.Pending.valid() && entry.Streaming.expired()) {
+			result.ResidentCount++;
+			result.ResidentBytes += entry.Bytes;
+		}
+	}
+	return result;
+}
+
+void AssetCache::ResetStats() {
+	std::lock_guard<std::mutex> lock(_lock);
+	_hits = 0;
+	_misses = 0;
+}
+
+std::string AssetCache::_MakeKey(const char* type, const std::string& path, const std::string& options) {
+	// Canonicalizing the path means that "models/a.obj" and "./models/../models/a.obj" share an entry
+	std::error_code error;
+	std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+	std::string result = type;
+	result += "|";
+	result += error ? path : canonical.generic_string();
+	if (!options.empty()) {
+		result += "|";
+		result += options;
+	}
+	return result;
+}
+
+std::shared_ptr<void> AssetCache::_Find(const std::string& key) {
+	std::lock_guard<std::mutex> lock(_lock);
+	auto it = _entries.find(key);
+	if (it != _entries.end()) {
+		if (std::shared_ptr<void> asset = it->second.Asset.lock()) {
+			_hits++;
+			return asset;
+		}
+	}
+	return nullptr;
+}
+
+std::shared_ptr<void> AssetCache::_Insert(const std::string& key, const std::shared_ptr<void>& asset, size_t bytes) {
+	std::lock_guard<std::mutex> lock(_lock);
+	Entry& entry = _entries[key];
+	if (std::shared_ptr<void> existing = entry.Asset.lock()) {
+		return existing;
+	}
+	_misses++;
+	entry.Asset = asset;
+	entry.Bytes = bytes;
+	return asset;
+}
+
+AssetCache::StreamRequest AssetCache::_BeginStream(const std::string& key, const std::shared_ptr<void>& state, const LoadedFunc& onLoaded) {
+	std::lock_guard<std::mutex> lock(_lock);
+	Entry& entry = _entries[key];
+	StreamRequest result;
+	if ((result.Asset = entry.Asset.lock()) || (result.Streaming = entry.Streaming.lock())) {
+		_hits++;
+	} else if (entry.Pending.valid()) {
+		_hits++;
+		entry.Continuations.push_back(onLoaded);
+		result.Chained = true;
+	} else {
+		entry.Streaming = state;
+	}
+	return result;
+}
+
+void AssetCache::_EndStream(const std::string& key, const std::shared_ptr<void>& state) {
+	std::lock_guard<std::mutex> lock(_lock);
+	auto it = _entries.find(key);
+	if (it != _entries.end() && it->second.Streaming.lock() == state) {
+		it->second.Streaming.reset();
+	}
+}
+
+std::shared_ptr<void> AssetCache::_GetOrLoad(const std::string& key,
+	const std::function<std::shared_ptr<void>()>& load,
+	const std::function<size_t(const std::shared_ptr<void>&)>& measure,
+	const std::function<std::shared_ptr<void>(const std::shared_ptr<void>&)>& wait)
+{
+	std::promise<std::shared_ptr<void>> promise;
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		Entry& entry = _entries[key];
+
+		// The asset is already loaded
+		if (std::shared_ptr<void> asset = entry.Asset.lock()) {
+			_hits++;
+			return asset;
+		}
+
+		// Another thread is already loading this asset, so we'll wait for it to finish
+		if (entry.Pending.valid()) {
+			_hits++;
+			std::shared_future<std::shared_ptr<void>> pending = entry.Pending;
+			lock.unlock();
+			return pending.get();
+		}
+
+		// The streamer is already loading this asset, so we'll finish that load rather than starting another
+		if (std::shared_ptr<void> streaming = entry.Streaming.lock()) {
+			_hits++;
+			lock.unlock();
+			return wait(streaming);
+		}
+
+		// We're the first to ask for this asset, so it's our job to load it
+		_misses++;
+		entry.Pending = promise.get_future().share();
+	}
+
+	std::vector<LoadedFunc> continuations;
+	std::shared_ptr<void> asset;
+	try {
+		asset = load();
+	}
+	catch (const std::exception& e) {
+		// Let anyone waiting on us know that the load failed, and remove the entry so the next request tries again
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			continuations.swap(_entries[key].Continuations);
+			_entries.erase(key);
+		}
+		promise.set_exception(std::current_exception());
+		for (const LoadedFunc& continuation : continuations) {
+			continuation(nullptr, e.what());
+		}
+		throw;
+	}
+	catch (...) {
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			continuations.swap(_entries[key].Continuations);
+			_entries.erase(key);
+		}
+		promise.set_exception(std::current_exception());
+		for (const LoadedFunc& continuation : continuations) {
+			continuation(nullptr, "Unknown error");
+		}
+		throw;
+	}
+
+	const size_t bytes = asset != nullptr ? measure(asset) : 0;
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		Entry& entry = _entries[key];
+		entry.Asset = asset;
+		entry.Bytes = bytes;
+		entry.Pending = std::shared_future<std::shared_ptr<void>>();
+		continuations.swap(entry.Continuations);
+	}
+	promise.set_value(asset);
+	for (const LoadedFunc& continuation : continuations) {
+		continuation(asset, asset != nullptr ? "" : "Failed to load asset");
+	}
+	LOG_TRACE("Loaded asset {} ({} bytes)", key, bytes);
+
+	return asset;
+}
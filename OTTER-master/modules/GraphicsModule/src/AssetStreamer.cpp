@@ -0,0 +1,365 @@
+#include "AssetStreamer.h"
+
+#include <chrono>
+#include <limits>
+#include <atomic>
+#include <vector>
+#include <stdexcept>
+#include <filesystem>
+
+#include "AssetCache.h"
+#include "BakedTexture.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "ObjLoader.h"
+#include "NotObjLoader.h"
+#include "Logging.h"
+
+std::mutex AssetStreamer::_lock;
+std::condition_variable AssetStreamer::_queueChanged;
+std::deque<AssetStreamer::Upload> AssetStreamer::_uploads;
+std::deque<std::function<void()>> AssetStreamer::_deferred;
+size_t AssetStreamer::_uploadCapacity = 16;
+size_t AssetStreamer::_inFlightCount = 0;
+size_t AssetStreamer::_pendingCount = 0;
+AssetStreamer::Stats AssetStreamer::_stats = AssetStreamer::Stats();
+
+// Runs a single decode step on the job system, forwarding it's result (or error) to the completion function. Decode
+// jobs run in the background so a main thread that is waiting on something else never ends up decoding
+template <typename T>
+void DecodeOnPool(const std::function<std::function<std::shared_ptr<T>()>()>& decode,
+	const std::function<void(const std::function<std::shared_ptr<T>()>&, const std::string&)>& complete)
+{
+	JobSystem::Run([decode, complete]() {
+		std::function<std::shared_ptr<T>()> upload;
+		try {
+			upload = decode();
+		}
+		catch (const std::exception& e) {
+			complete(nullptr, e.what());
+			return;
+		}
+		catch (...) {
+			complete(nullptr, "Unknown error");
+			return;
+		}
+		complete(upload, "");
+	}, nullptr, nullptr, JobAffinity::Background);
+}
+
+AssetHandle<VertexArrayObject> AssetStreamer::LoadObjAsync(const std::string& path, const glm::vec4& inColor) {
+	return _LoadAsync<VertexArrayObject>(AssetCache::GetObjKey(path, inColor), path, [path, inColor](const CompleteFunc<VertexArrayObject>& complete) {
+		DecodeOnPool<VertexArrayObject>([path, inColor]() { return ObjLoader::PrepareFromFile(path, inColor); }, complete);
+	});
+}
+
+AssetHandle<VertexArrayObject> AssetStreamer::LoadNotObjAsync(const std::string& path) {
+	return _LoadAsync<VertexArrayObject>(AssetCache::GetNotObjKey(path), path, [path](const CompleteFunc<VertexArrayObject>& complete) {
+		DecodeOnPool<VertexArrayObject>([path]() { return NotObjLoader::PrepareFromFile(path); }, complete);
+	});
+}
+
+AssetHandle<Texture2D> AssetStreamer::LoadTexture2DAsync(const std::string& path) {
+	return _LoadAsync<Texture2D>(AssetCache::GetTexture2DKey(path), path, [path](const CompleteFunc<Texture2D>& complete) {
+		DecodeOnPool<Texture2D>([path]() -> UploadFunc<Texture2D> {
+			Texture2DData::sptr data = BakedTexture::LoadCached(path);
+			if (data == nullptr) {
+				throw std::runtime_error("Failed to load image");
+			}
+			return [data]() {
+				Texture2D::sptr result = Texture2D::Create();
+				result->LoadData(data);
+				return result;
+			};
+		}, complete);
+	});
+}
+
+AssetHandle<Texture2DArray> AssetStreamer::LoadTexture2DArrayAsync(const std::string& cachePath, const std::vector<std::string>& sourcePaths) {
+	return _LoadAsync<Texture2DArray>(AssetCache::GetTexture2DArrayKey(cachePath, sourcePaths), cachePath, [cachePath, sourcePaths](const CompleteFunc<Texture2DArray>& complete) {
+		DecodeOnPool<Texture2DArray>([cachePath, sourcePaths]() -> UploadFunc<Texture2DArray> {
+			std::vector<Texture2DData::sptr> layers = BakedTexture::LoadCachedArray(cachePath, sourcePaths);
+			if (layers.empty()) {
+				throw std::runtime_error("Failed to load texture array");
+			}
+			return [layers]() {
+				Texture2DArray::sptr result = Texture2DArray::Create();
+				if (!result->LoadData(layers)) {
+					throw std::runtime_error("Texture array layers do not match");
+				}
+				return result;
+			};
+		}, complete);
+	});
+}
+
+AssetHandle<TextureCubeMap> AssetStreamer::LoadCubeMapAsync(const std::string& path) {
+	return _LoadAsync<TextureCubeMap>(AssetCache::GetCubeMapKey(path), path, [path](const CompleteFunc<TextureCubeMap>& complete) {
+		// Each face gets decoded by it's own task, and whichever task finishes last assembles the cube map. We avoid
+		// having one task wait on the others, since that could starve the pool. Every task must count itself off,
+		// even if it fails, otherwise the handle would never be resolved
+		struct CubeLoad {
+			std::vector<Texture2DData::sptr> Faces = std::vector<Texture2DData::sptr>(6);
+			std::vector<std::string> Errors = std::vector<std::string>(6);
+			std::atomic<int> Remaining{ 6 };
+		};
+		std::shared_ptr<CubeLoad> load = std::make_shared<CubeLoad>();
+
+		for (int ix = 0; ix < 6; ix++) {
+			const std::string facePath = TextureCubeMapData::GetFacePath(path, (CubeMapFace)ix);
+			JobSystem::Run([load, facePath, ix, complete]() {
+				try {
+					if (std::filesystem::exists(facePath)) {
+						load->Faces[ix] = Texture2DData::LoadFromFile(facePath);
+					} else {
+						LOG_WARN("Image \"{}\" could not be found!", facePath);
+					}
+				}
+				catch (const std::exception& e) {
+					load->Errors[ix] = fmt::format("Failed to load \"{}\": {}", facePath, e.what());
+				}
+				catch (...) {
+					load->Errors[ix] = fmt::format("Failed to load \"{}\"", facePath);
+				}
+
+				if (load->Remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+					return;
+				}
+				for (const std::string& error : load->Errors) {
+					if (!error.empty()) {
+						complete(nullptr, error);
+						return;
+					}
+				}
+				if (load->Faces[0] == nullptr) {
+					complete(nullptr, "Failed to load the first face of the cube map");
+					return;
+				}
+				TextureCubeMapData::sptr data;
+				try {
+					data = TextureCubeMapData::CreateFromImages(load->Faces);
+				}
+				catch (const std::exception& e) {
+					complete(nullptr, e.what());
+					return;
+				}
+				complete([data]() {
+					TextureCubeMap::sptr result = TextureCubeMap::Create();
+					result->LoadData(data);
+					return result;
+				}, "");
+			}, nullptr, nullptr, JobAffinity::Background);
+		}
+	});
+}
+
+size_t AssetStreamer::ProcessUploads(double budgetMs) {
+	PROFILE_SCOPE("AssetStreamer::ProcessUploads");
+	const auto start = std::chrono::high_resolution_clock::now();
+	double elapsedMs = 0.0;
+	size_t count = 0;
+
+	while (true) {
+		Upload upload;
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			if (_uploads.empty()) {
+				break;
+			}
+			upload = std::move(_uploads.front());
+			_uploads.pop_front();
+		}
+		upload.Run();
+		count++;
+
+		elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		if (elapsedMs >= budgetMs) {
+			break;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(_lock);
+	_stats.LastFrameUploads = count;
+	_stats.LastFrameMs = elapsedMs;
+	_stats.UploadedCount += count;
+	return count;
+}
+
+void AssetStreamer::Flush() {
+	_WaitUntil([]() { return _pendingCount == 0; });
+}
+
+void AssetStreamer::SetUploadQueueCapacity(size_t capacity) {
+	// If the limit went up, we can start some of the loads that were held back
+	std::vector<std::function<void()>> ready;
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_uploadCapacity = capacity > 0 ? capacity : 1;
+		while (!_deferred.empty() && _inFlightCount < _uploadCapacity) {
+			ready.push_back(std::move(_deferred.front()));
+			_deferred.pop_front();
+			_inFlightCount++;
+		}
+	}
+	for (const std::function<void()>& start : ready) {
+		start();
+	}
+}
+
+AssetStreamer::Stats AssetStreamer::GetStats() {
+	std::lock_guard<std::mutex> lock(_lock);
+	Stats result = _stats;
+	result.PendingCount = _pendingCount;
+	result.QueuedUploads = _uploads.size();
+	result.DeferredCount = _deferred.size();
+	return result;
+}
+
+void AssetStreamer::_QueueUpload(std::function<void()> upload) {
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_uploads.push_back(Upload{ std::move(upload) });
+	}
+	_queueChanged.notify_all();
+}
+
+void AssetStreamer::_StartThrottled(std::function<void()> start) {
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		if (_inFlightCount >= _uploadCapacity) {
+			_deferred.push_back(std::move(start));
+			return;
+		}
+		_inFlightCount++;
+	}
+	start();
+}
+
+void AssetStreamer::_FinishThrottled() {
+	std::function<void()> next;
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_inFlightCount--;
+		if (_deferred.empty()) {
+			return;
+		}
+		next = std::move(_deferred.front());
+		_deferred.pop_front();
+		_inFlightCount++;
+	}
+	next();
+}
+
+void AssetStreamer::_WaitUntil(const std::function<bool()>& done) {
+	while (true) {
+		ProcessUploads(std::numeric_limits<double>::infinity());
+
+		std::unique_lock<std::mutex> lock(_lock);
+		if (done()) {
+			break;
+		}
+		_queueChanged.wait(lock, [&]() { return !_uploads.empty() || done(); });
+	}
+}
+
+template <typename T>
+AssetHandle<T> AssetStreamer::_LoadAsync(const std::string& key, const std::string& path,
+	const std::function<void(const CompleteFunc<T>& complete)>& start)
+{
+	typedef typename AssetHandle<T>::State State;
+
+	std::shared_ptr<State> state = std::make_shared<State>();
+	state->Path = path;
+
+	// Only decoded loads count against the upload capacity, loads chained onto a synchronous load hold no extra data
+	const auto makeComplete = [key, state](bool throttled) -> CompleteFunc<T> {
+		return [key, state, throttled](const UploadFunc<T>& upload, const std::string& error) {
+			if (!error.empty()) {
+				_Resolve<T>(key, state, nullptr, error);
+				if (throttled) {
+					_FinishThrottled();
+				}
+				return;
+			}
+			_QueueUpload([key, state, upload, throttled]() {
+				try {
+					std::shared_ptr<T> asset = AssetCache::Insert<T>(key, upload());
+					_Resolve<T>(key, state, asset, "");
+				}
+				catch (const std::exception& e) {
+					_Resolve<T>(key, state, nullptr, e.what());
+				}
+				catch (...) {
+					_Resolve<T>(key, state, nullptr, "Unknown error");
+				}
+				if (throttled) {
+					_FinishThrottled();
+				}
+			});
+		};
+	};
+
+	// We count the load as pending before registering it, since a chained load may resolve as soon as it's registered
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_pendingCount++;
+	}
+
+	// If a synchronous load is already reading this asset, the cache calls us back once it's done instead of us
+	// decoding it again (or blocking a worker on it)
+	const CompleteFunc<T> chained = makeComplete(false);
+	const AssetCache::StreamRequest request = AssetCache::_BeginStream(key, state,
+		[chained](const std::shared_ptr<void>& asset, const std::string& error) {
+			if (!error.empty()) {
+				chained(nullptr, error);
+				return;
+			}
+			std::shared_ptr<T> result = std::static_pointer_cast<T>(asset);
+			chained([result]() { return result; }, "");
+		});
+	if (request.Chained) {
+		return AssetHandle<T>(state);
+	}
+	// There's nothing for us to load in the cases below, so we don't count as pending after all
+	if (request.Asset != nullptr || request.Streaming != nullptr) {
+		std::lock_guard<std::mutex> lock(_lock);
+		_pendingCount--;
+	}
+
+	// If the asset is already resident, we can hand it back right away
+	if (request.Asset != nullptr) {
+		AssetHandle<T> result = AssetHandle<T>::FromAsset(std::static_pointer_cast<T>(request.Asset));
+		result.GetState()->Path = path;
+		return result;
+	}
+	// Someone else already requested this asset, share their handle
+	if (request.Streaming != nullptr) {
+		return AssetHandle<T>(std::static_pointer_cast<State>(request.Streaming));
+	}
+
+	const CompleteFunc<T> complete = makeComplete(true);
+	_StartThrottled([start, complete]() { start(complete); });
+
+	return AssetHandle<T>(state);
+}
+
+template <typename T>
+void AssetStreamer::_Resolve(const std::string& key, const std::shared_ptr<typename AssetHandle<T>::State>& state,
+	const std::shared_ptr<T>& asset, const std::string& error)
+{
+	if (error.empty()) {
+		state->Asset = asset;
+		state->Status.store(AssetStatus::Ready, std::memory_order_release);
+	} else {
+		LOG_WARN("Failed to stream \"{}\": {}", state->Path, error);
+		state->Error = error;
+		state->Status.store(AssetStatus::Failed, std::memory_order_release);
+	}
+
+	AssetCache::_EndStream(key, state);
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_pendingCount--;
+	}
+	_queueChanged.notify_all();
+}
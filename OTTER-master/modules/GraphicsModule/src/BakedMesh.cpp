@@ -0,0 +1,346 @@
+#include "BakedMesh.h"
+
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <thread>
+#include <functional>
+#include <algorithm>
+
+// Sections in the file are aligned to this many bytes, so the data can be read in place
+const size_t SECTION_ALIGNMENT = 16;
+
+#pragma pack(push, 1)
+/// <summary>
+/// The header at the start of every .otm file, all values are little endian
+/// </summary>
+struct OtmHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint64_t SourceHash;
+	uint64_t OptionsHash;
+	uint32_t VertexStride;
+	uint32_t AttributeCount;
+	uint64_t VertexCount;
+	uint64_t IndexCount;
+	uint64_t AttributeOffset;
+	uint64_t VertexOffset;
+	uint64_t IndexOffset;
+	// The model space bounds of the mesh, see MeshBounds
+	float    BoundsMin[3];
+	float    BoundsMax[3];
+	float    BoundsRadius;
+	// Takes the stored positions to model space, see VertexDecode
+	float    DecodeScale[3];
+	float    DecodeOffset[3];
+	// The levels of detail in the index buffer, see MeshLod. A count of 0 means the mesh only has one level
+	uint32_t LodCount;
+	uint32_t Reserved;
+	uint64_t LodOffset;
+};
+
+/// <summary>
+/// Stores a single BufferAttribute in a fixed size format
+/// </summary>
+struct OtmAttribute
+{
+	uint32_t Slot;
+	uint32_t Size;
+	uint32_t Type;
+	uint32_t Normalized;
+	uint32_t Usage;
+	uint32_t Reserved;
+	uint64_t Offset;
+};
+
+/// <summary>
+/// Stores a single MeshLod in a fixed size format
+/// </summary>
+struct OtmLod
+{
+	uint32_t IndexOffset;
+	uint32_t IndexCount;
+	float    Error;
+	uint32_t Reserved;
+};
+#pragma pack(pop)
+
+inline size_t AlignSection(size_t offset) {
+	return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+// Checks that a section of count elements fits in a file, written so that corrupt offsets and counts can't overflow
+inline bool SectionFits(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t fileSize) {
+	return offset <= fileSize && (count == 0 || (elementSize > 0 && count <= (fileSize - offset) / elementSize));
+}
+
+// Gets the number of bytes a vertex attribute reads from each vertex, or 0 if the type or component count is invalid
+inline uint64_t GetAttributeBytes(uint32_t type, uint32_t componentCount) {
+	if (componentCount < 1 || componentCount > 4) {
+		return 0;
+	}
+	switch (type) {
+		case GL_BYTE:
+		case GL_UNSIGNED_BYTE:
+			return componentCount;
+		case GL_SHORT:
+		case GL_UNSIGNED_SHORT:
+		case GL_HALF_FLOAT:
+			return componentCount * 2ull;
+		case GL_INT:
+		case GL_UNSIGNED_INT:
+		case GL_FLOAT:
+		case GL_FIXED:
+			return componentCount * 4ull;
+		case GL_DOUBLE:
+			return componentCount * 8ull;
+		// Packed types hold every component in a single 32 bit value
+		case GL_INT_2_10_10_10_REV:
+		case GL_UNSIGNED_INT_2_10_10_10_REV:
+			return componentCount == 4 ? 4 : 0;
+		case GL_UNSIGNED_INT_10F_11F_11F_REV:
+			return componentCount == 3 ? 4 : 0;
+		default:
+			return 0;
+	}
+}
+
+BakedMesh::sptr BakedMesh::Open(const std::string& path)
+{
+	MemoryMappedFile::sptr file = MemoryMappedFile::Create(path);
+	if (!file->IsOpen() || file->GetSize() < sizeof(OtmHeader)) {
+		return nullptr;
+	}
+
+	OtmHeader header;
+	memcpy(&header, file->GetData(), sizeof(OtmHeader));
+	if (header.Magic != MAGIC || header.Version != VERSION) {
+		return nullptr;
+	}
+
+	// Make sure all of our sections actually fit in the file, so a truncated file can't send us reading off the end
+	const uint64_t size = file->GetSize();
+	if (!SectionFits(header.AttributeOffset, header.AttributeCount, sizeof(OtmAttribute), size) ||
+		!SectionFits(header.VertexOffset, header.VertexCount, header.VertexStride, size) ||
+		!SectionFits(header.IndexOffset, header.IndexCount, sizeof(uint32_t), size) || header.IndexOffset % sizeof(uint32_t) != 0 ||
+		header.LodCount > MeshLod::MAX_LODS || !SectionFits(header.LodOffset, header.LodCount, sizeof(OtmLod), size)) {
+		return nullptr;
+	}
+	// Every attribute has to fit inside of a vertex, otherwise the VAO would read into the next vertex (or past the
+	// end of the last one)
+	for (uint32_t ix = 0; ix < header.AttributeCount; ix++) {
+		OtmAttribute attrib;
+		memcpy(&attrib, file->GetData() + header.AttributeOffset + ix * sizeof(OtmAttribute), sizeof(OtmAttribute));
+		const uint64_t attribBytes = GetAttributeBytes(attrib.Type, attrib.Size);
+		if (attribBytes == 0 || attrib.Offset > header.VertexStride || attribBytes > header.VertexStride - attrib.Offset) {
+			return nullptr;
+		}
+	}
+	// Indices go straight to the GPU, so one that is past the end of the vertices would read outside the buffer
+	const uint32_t* indices = reinterpret_cast<const uint32_t*>(file->GetData() + header.IndexOffset);
+	uint32_t maxIndex = 0;
+	for (uint64_t ix = 0; ix < header.IndexCount; ix++) {
+		maxIndex = std::max(maxIndex, indices[ix]);
+	}
+	if (header.IndexCount > 0 && maxIndex >= header.VertexCount) {
+		return nullptr;
+	}
+	// Every level has to be inside the index buffer
+	for (uint32_t ix = 0; ix < header.LodCount; ix++) {
+		OtmLod lod;
+		memcpy(&lod, file->GetData() + header.LodOffset + ix * sizeof(OtmLod), sizeof(OtmLod));
+		if (static_cast<uint64_t>(lod.IndexOffset) + lod.IndexCount > header.IndexCount) {
+			return nullptr;
+		}
+	}
+
+	return std::make_shared<BakedMesh>(file);
+}
+
+BakedMesh::BakedMesh(const MemoryMappedFile::sptr& file) :
+	_file(file)
+{
+	OtmHeader header;
+	memcpy(&header, _file->GetData(), sizeof(OtmHeader));
+
+	_sourceHash   = header.SourceHash;
+	_optionsHash  = header.OptionsHash;
+	_vertexData   = _file->GetData() + header.VertexOffset;
+	_vertexStride = header.VertexStride;
+	_vertexCount  = static_cast<size_t>(header.VertexCount);
+	_indexData    = reinterpret_cast<const uint32_t*>(_file->GetData() + header.IndexOffset);
+	_indexCount   = static_cast<size_t>(header.IndexCount);
+	_bounds       = MeshBounds(
+		glm::vec3(header.BoundsMin[0], header.BoundsMin[1], header.BoundsMin[2]),
+		glm::vec3(header.BoundsMax[0], header.BoundsMax[1], header.BoundsMax[2]),
+		header.BoundsRadius);
+	_decode       = VertexDecode(
+		glm::vec3(header.DecodeScale[0], header.DecodeScale[1], header.DecodeScale[2]),
+		glm::vec3(header.DecodeOffset[0], header.DecodeOffset[1], header.DecodeOffset[2]));
+
+	_attributes.reserve(header.AttributeCount);
+	for (uint32_t ix = 0; ix < header.AttributeCount; ix++) {
+		OtmAttribute attrib;
+		memcpy(&attrib, _file->GetData() + header.AttributeOffset + ix * sizeof(OtmAttribute), sizeof(OtmAttribute));
+		_attributes.emplace_back(attrib.Slot, attrib.Size, attrib.Type, attrib.Normalized != 0,
+			static_cast<GLsizei>(_vertexStride), static_cast<size_t>(attrib.Offset), static_cast<AttribUsage>(attrib.Usage));
+	}
+
+	_lods.reserve(header.LodCount);
+	for (uint32_t ix = 0; ix < header.LodCount; ix++) {
+		OtmLod lod;
+		memcpy(&lod, _file->GetData() + header.LodOffset + ix * sizeof(OtmLod), sizeof(OtmLod));
+		_lods.emplace_back(lod.IndexOffset, lod.IndexCount, lod.Error);
+	}
+}
+
+VertexArrayObject::sptr BakedMesh::Bake() const
+{
+	VertexBuffer::sptr vbo = VertexBuffer::Create();
+	vbo->LoadData(_vertexData, _vertexStride, _vertexCount);
+
+	IndexBuffer::sptr ebo = IndexBuffer::Create();
+	ebo->LoadData(_indexData, _indexCount);
+
+	VertexArrayObject::sptr result = VertexArrayObject::Create();
+	result->AddVertexBuffer(vbo, _attributes);
+	result->SetIndexBuffer(ebo);
+	result->SetBounds(_bounds);
+	result->SetVertexDecode(_decode);
+	result->SetLods(_lods);
+
+	return result;
+}
+
+void BakedMesh::WriteRaw(const std::string& path,
+	const void* vertices, size_t vertexStride, size_t vertexCount,
+	const uint32_t* indices, size_t indexCount,
+	const std::vector<BufferAttribute>& attributes,
+	const MeshBounds& bounds, const VertexDecode& decode,
+	const std::vector<MeshLod>& lods,
+	uint64_t sourceHash, uint64_t optionsHash)
+{
+	OtmHeader header;
+	header.Magic           = MAGIC;
+	header.Version         = VERSION;
+	header.SourceHash      = sourceHash;
+	header.OptionsHash     = optionsHash;
+	header.VertexStride    = static_cast<uint32_t>(vertexStride);
+	header.AttributeCount  = static_cast<uint32_t>(attributes.size());
+	header.VertexCount     = vertexCount;
+	header.IndexCount      = indexCount;
+	header.AttributeOffset = AlignSection(sizeof(OtmHeader));
+	header.VertexOffset    = AlignSection(header.AttributeOffset + attributes.size() * sizeof(OtmAttribute));
+	header.IndexOffset     = AlignSection(header.VertexOffset + vertexCount * vertexStride);
+	header.LodCount        = static_cast<uint32_t>(lods.size());
+	header.Reserved        = 0;
+	header.LodOffset       = AlignSection(header.IndexOffset + indexCount * sizeof(uint32_t));
+
+	memcpy(header.BoundsMin, &bounds.Min, sizeof(header.BoundsMin));
+	memcpy(header.BoundsMax, &bounds.Max, sizeof(header.BoundsMax));
+	header.BoundsRadius    = bounds.Radius;
+	memcpy(header.DecodeScale, &decode.Scale, sizeof(header.DecodeScale));
+	memcpy(header.DecodeOffset, &decode.Offset, sizeof(header.DecodeOffset));
+
+	// We write to a temporary file first, so that a crash or another process never sees a half-written mesh. The
+	// thread ID is included so that streaming threads baking the same mesh don't write over each other
+	const std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			throw std::runtime_error("Failed to open " + tempPath + " for writing");
+		}
+
+		const char padding[SECTION_ALIGNMENT] = { 0 };
+		auto pad = [&](uint64_t offset) {
+			file.write(padding, static_cast<std::streamsize>(offset - static_cast<uint64_t>(file.tellp())));
+		};
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(OtmHeader));
+
+		pad(header.AttributeOffset);
+		for (const BufferAttribute& attrib : attributes) {
+			OtmAttribute record;
+			record.Slot       = attrib.Slot;
+			record.Size       = static_cast<uint32_t>(attrib.Size);
+			record.Type       = attrib.Type;
+			record.Normalized = attrib.Normalized ? 1 : 0;
+			record.Usage      = static_cast<uint32_t>(attrib.Usage);
+			record.Reserved   = 0;
+			record.Offset     = attrib.Offset;
+			file.write(reinterpret_cast<const char*>(&record), sizeof(OtmAttribute));
+		}
+
+		pad(header.VertexOffset);
+		file.write(static_cast<const char*>(vertices), static_cast<std::streamsize>(vertexCount * vertexStride));
+
+		pad(header.IndexOffset);
+		file.write(reinterpret_cast<const char*>(indices), static_cast<std::streamsize>(indexCount * sizeof(uint32_t)));
+
+		pad(header.LodOffset);
+		for (const MeshLod& lod : lods) {
+			OtmLod record;
+			record.IndexOffset = lod.IndexOffset;
+			record.IndexCount  = lod.IndexCount;
+			record.Error       = lod.Error;
+			record.Reserved    = 0;
+			file.write(reinterpret_cast<const char*>(&record), sizeof(OtmLod));
+		}
+
+		if (!file) {
+			throw std::runtime_error("Failed to write baked mesh " + tempPath);
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, path, error);
+	if (error) {
+		std::filesystem::remove(tempPath, error);
+		throw std::runtime_error("Failed to replace baked mesh " + path);
+	}
+}
+
+std::string BakedMesh::GetCachePath(const std::string& sourcePath)
+{
+	return std::filesystem::path(sourcePath).replace_extension(".otm").string();
+}
+
+uint64_t BakedMesh::Hash(const void* data, size_t size, uint64_t seed)
+{
+	// A simple word-at-a-time multiply/xor hash, we only need to detect changes, not resist attacks
+	const uint64_t prime = 0x100000001B3ull;
+	uint64_t hash = 0xCBF29CE484222325ull ^ (seed * 0x9E3779B97F4A7C15ull) ^ size;
+
+	const char* bytes = static_cast<const char*>(data);
+	size_t ix = 0;
+	for (; ix + sizeof(uint64_t) <= size; ix += sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, bytes + ix, sizeof(uint64_t));
+		hash = (hash ^ word) * prime;
+		hash ^= hash >> 32;
+	}
+	for (; ix < size; ix++) {
+		hash = (hash ^ static_cast<uint8_t>(bytes[ix])) * prime;
+	}
+	return hash ^ (hash >> 29);
+}
+
+uint64_t BakedMesh::HashBakeOptions(uint64_t optionsHash, const MeshBakeSettings& settings)
+{
+	if (settings.Optimize) {
+		const uint32_t version = MeshOptimizer::VERSION;
+		optionsHash = Hash(&version, sizeof(uint32_t), optionsHash);
+	}
+	if (settings.Format != VertexFormat::Float) {
+		const uint32_t value = static_cast<uint32_t>(settings.Format);
+		optionsHash = Hash(&value, sizeof(uint32_t), optionsHash);
+	}
+	if (!settings.LodErrors.empty()) {
+		const uint32_t version = MeshSimplifier::VERSION;
+		optionsHash = Hash(&version, sizeof(uint32_t), optionsHash);
+		optionsHash = Hash(settings.LodErrors.data(), settings.LodErrors.size() * sizeof(float), optionsHash);
+	}
+	return optionsHash;
+}
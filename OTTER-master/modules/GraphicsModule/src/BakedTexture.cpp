@@ -0,0 +1,429 @@
+#include "BakedTexture.h"
+
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <thread>
+#include <functional>
+
+#include "BakedMesh.h"
+#include "BlockCompressor.h"
+
+// "DDS " at the start of every file
+const uint32_t DDS_MAGIC = 0x20534444;
+// "DX10", which says that the DX10 header follows the main header
+const uint32_t DDS_FOURCC_DX10 = 0x30315844;
+
+const uint32_t DDSD_CAPS        = 0x1;
+const uint32_t DDSD_HEIGHT      = 0x2;
+const uint32_t DDSD_WIDTH       = 0x4;
+const uint32_t DDSD_PITCH       = 0x8;
+const uint32_t DDSD_PIXELFORMAT = 0x1000;
+const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+const uint32_t DDSD_LINEARSIZE  = 0x80000;
+const uint32_t DDPF_FOURCC      = 0x4;
+const uint32_t DDSCAPS_COMPLEX  = 0x8;
+const uint32_t DDSCAPS_TEXTURE  = 0x1000;
+const uint32_t DDSCAPS_MIPMAP   = 0x400000;
+const uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+#pragma pack(push, 1)
+/// <summary>
+/// The pixel format block of a DDS header, all values are little endian
+/// </summary>
+struct DdsPixelFormat
+{
+	uint32_t Size;
+	uint32_t Flags;
+	uint32_t FourCC;
+	uint32_t RGBBitCount;
+	uint32_t RBitMask;
+	uint32_t GBitMask;
+	uint32_t BBitMask;
+	uint32_t ABitMask;
+};
+
+/// <summary>
+/// The header that follows the magic number in every DDS file
+/// </summary>
+struct DdsHeader
+{
+	uint32_t       Size;
+	uint32_t       Flags;
+	uint32_t       Height;
+	uint32_t       Width;
+	uint32_t       PitchOrLinearSize;
+	uint32_t       Depth;
+	uint32_t       MipMapCount;
+	// We use the reserved values to store our magic number, version and hashes, see BakedTexture
+	uint32_t       Reserved1[11];
+	DdsPixelFormat PixelFormat;
+	uint32_t       Caps;
+	uint32_t       Caps2;
+	uint32_t       Caps3;
+	uint32_t       Caps4;
+	uint32_t       Reserved2;
+};
+
+/// <summary>
+/// The extended header used by DX10 and later formats, which includes all of the BC formats
+/// </summary>
+struct DdsHeaderDx10
+{
+	uint32_t DxgiFormat;
+	uint32_t ResourceDimension;
+	uint32_t MiscFlag;
+	uint32_t ArraySize;
+	uint32_t MiscFlags2;
+};
+#pragma pack(pop)
+
+// The level data starts straight after the headers
+const size_t DDS_DATA_OFFSET = sizeof(uint32_t) + sizeof(DdsHeader) + sizeof(DdsHeaderDx10);
+
+/// <summary>
+/// Maps between our internal formats and their DXGI_FORMAT values
+/// </summary>
+struct DxgiFormatMapping
+{
+	InternalFormat Format;
+	uint32_t       DxgiFormat;
+};
+
+static const DxgiFormatMapping DXGI_FORMATS[] = {
+	{ InternalFormat::RGBA8, 28 }, // DXGI_FORMAT_R8G8B8A8_UNORM
+	{ InternalFormat::RG8,   49 }, // DXGI_FORMAT_R8G8_UNORM
+	{ InternalFormat::R8,    61 }, // DXGI_FORMAT_R8_UNORM
+	{ InternalFormat::BC1,   71 }, // DXGI_FORMAT_BC1_UNORM
+	{ InternalFormat::BC3,   77 }, // DXGI_FORMAT_BC3_UNORM
+	{ InternalFormat::BC4,   80 }, // DXGI_FORMAT_BC4_UNORM
+	{ InternalFormat::BC5,   83 }, // DXGI_FORMAT_BC5_UNORM
+	{ InternalFormat::BC7,   98 }, // DXGI_FORMAT_BC7_UNORM
+};
+
+static uint32_t ToDxgiFormat(InternalFormat format) {
+	for (const DxgiFormatMapping& mapping : DXGI_FORMATS) {
+		if (mapping.Format == format) {
+			return mapping.DxgiFormat;
+		}
+	}
+	return 0;
+}
+
+static InternalFormat FromDxgiFormat(uint32_t dxgiFormat) {
+	for (const DxgiFormatMapping& mapping : DXGI_FORMATS) {
+		if (mapping.DxgiFormat == dxgiFormat) {
+			return mapping.Format;
+		}
+	}
+	return InternalFormat::Unknown;
+}
+
+// Works out where each level of a texture is stored, returning the total size of the levels
+static size_t LayoutLevels(InternalFormat format, uint32_t width, uint32_t height, uint32_t levelCount, std::vector<Texture2DLevel>& levels) {
+	size_t offset = 0;
+	levels.clear();
+	for (uint32_t ix = 0; ix < levelCount; ix++) {
+		const uint32_t levelWidth = std::max(width >> ix, 1u), levelHeight = std::max(height >> ix, 1u);
+		const size_t size = GetLevelSize(format, levelWidth, levelHeight);
+		levels.push_back({ levelWidth, levelHeight, offset, size });
+		offset += size;
+	}
+	return offset;
+}
+
+BakedTexture::sptr BakedTexture::Open(const std::string& path)
+{
+	MemoryMappedFile::sptr file = MemoryMappedFile::Create(path);
+	if (!file->IsOpen() || file->GetSize() < DDS_DATA_OFFSET) {
+		return nullptr;
+	}
+
+	uint32_t magic;
+	DdsHeader header;
+	DdsHeaderDx10 dx10;
+	memcpy(&magic, file->GetData(), sizeof(uint32_t));
+	memcpy(&header, file->GetData() + sizeof(uint32_t), sizeof(DdsHeader));
+	memcpy(&dx10, file->GetData() + sizeof(uint32_t) + sizeof(DdsHeader), sizeof(DdsHeaderDx10));
+	if (magic != DDS_MAGIC || header.Size != sizeof(DdsHeader) || header.PixelFormat.FourCC != DDS_FOURCC_DX10 ||
+		header.Reserved1[0] != MAGIC || header.Reserved1[1] != VERSION) {
+		return nullptr;
+	}
+
+	// Make sure we can upload the texture, and that all of it's levels fit in the file
+	const InternalFormat format = FromDxgiFormat(dx10.DxgiFormat);
+	const uint32_t levelCount = std::max(header.MipMapCount, 1u);
+	if (format == InternalFormat::Unknown || dx10.ResourceDimension != DDS_DIMENSION_TEXTURE2D || dx10.ArraySize == 0 ||
+		header.Width == 0 || header.Height == 0 || levelCount > GetMipLevelCount(header.Width, header.Height)) {
+		return nullptr;
+	}
+	std::vector<Texture2DLevel> levels;
+	if (DDS_DATA_OFFSET + LayoutLevels(format, header.Width, header.Height, levelCount, levels) * dx10.ArraySize > file->GetSize()) {
+		return nullptr;
+	}
+
+	return std::make_shared<BakedTexture>(file);
+}
+
+BakedTexture::BakedTexture(const MemoryMappedFile::sptr& file) :
+	_file(file)
+{
+	DdsHeader header;
+	DdsHeaderDx10 dx10;
+	memcpy(&header, _file->GetData() + sizeof(uint32_t), sizeof(DdsHeader));
+	memcpy(&dx10, _file->GetData() + sizeof(uint32_t) + sizeof(DdsHeader), sizeof(DdsHeaderDx10));
+
+	_sourceHash  = static_cast<uint64_t>(header.Reserved1[2]) | (static_cast<uint64_t>(header.Reserved1[3]) << 32);
+	_optionsHash = static_cast<uint64_t>(header.Reserved1[4]) | (static_cast<uint64_t>(header.Reserved1[5]) << 32);
+	_format      = FromDxgiFormat(dx10.DxgiFormat);
+	_levelData   = _file->GetData() + DDS_DATA_OFFSET;
+	_layerCount  = dx10.ArraySize;
+	_layerSize   = LayoutLevels(_format, header.Width, header.Height, std::max(header.MipMapCount, 1u), _levels);
+}
+
+Texture2DData::sptr BakedTexture::GetData(const std::string& debugName, uint32_t layer) const
+{
+	LOG_ASSERT(layer < _layerCount, "Layer {} is out of range, the texture has {} layers", layer, _layerCount);
+	const void* data = static_cast<const uint8_t*>(_levelData) + layer * _layerSize;
+	Texture2DData::sptr result = std::make_shared<Texture2DData>(_format, _levels, data, _file);
+	result->DebugName = debugName;
+	return result;
+}
+
+void BakedTexture::Write(const std::string& path, const TextureBakeResult& texture, uint64_t sourceHash, uint64_t optionsHash)
+{
+	const uint32_t dxgiFormat = ToDxgiFormat(texture.Format);
+	if (dxgiFormat == 0 || texture.Levels.empty() || texture.Layers == 0) {
+		throw std::runtime_error("Cannot store a texture in this format");
+	}
+	const Texture2DLevel& top = texture.Levels[0];
+
+	DdsHeader header = { };
+	header.Size              = sizeof(DdsHeader);
+	header.Flags             = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT |
+		(IsCompressed(texture.Format) ? DDSD_LINEARSIZE : DDSD_PITCH);
+	header.Height            = top.Height;
+	header.Width             = top.Width;
+	header.PitchOrLinearSize = static_cast<uint32_t>(IsCompressed(texture.Format) ? top.Size : top.Size / top.Height);
+	header.MipMapCount       = static_cast<uint32_t>(texture.Levels.size());
+	header.Reserved1[0]      = MAGIC;
+	header.Reserved1[1]      = VERSION;
+	header.Reserved1[2]      = static_cast<uint32_t>(sourceHash);
+	header.Reserved1[3]      = static_cast<uint32_t>(sourceHash >> 32);
+	header.Reserved1[4]      = static_cast<uint32_t>(optionsHash);
+	header.Reserved1[5]      = static_cast<uint32_t>(optionsHash >> 32);
+	header.PixelFormat.Size  = sizeof(DdsPixelFormat);
+	header.PixelFormat.Flags = DDPF_FOURCC;
+	header.PixelFormat.FourCC = DDS_FOURCC_DX10;
+	header.Caps              = DDSCAPS_TEXTURE | (texture.Levels.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+	DdsHeaderDx10 dx10 = { };
+	dx10.DxgiFormat        = dxgiFormat;
+	dx10.ResourceDimension = DDS_DIMENSION_TEXTURE2D;
+	dx10.ArraySize         = texture.Layers;
+
+	// We write to a temporary file first, so that a crash or another process never sees a half-written texture. The
+	// thread ID is included so that streaming threads baking the same texture don't write over each other
+	const std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			throw std::runtime_error("Failed to open " + tempPath + " for writing");
+		}
+
+		file.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(uint32_t));
+		file.write(reinterpret_cast<const char*>(&header), sizeof(DdsHeader));
+		file.write(reinterpret_cast<const char*>(&dx10), sizeof(DdsHeaderDx10));
+		file.write(reinterpret_cast<const char*>(texture.Data.data()), static_cast<std::streamsize>(texture.Data.size()));
+
+		if (!file) {
+			throw std::runtime_error("Failed to write baked texture " + tempPath);
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, path, error);
+	if (error) {
+		std::filesystem::remove(tempPath, error);
+		throw std::runtime_error("Failed to replace baked texture " + path);
+	}
+}
+
+Texture2DData::sptr BakedTexture::LoadCached(const std::string& sourcePath, const TextureBakeSettings& settings)
+{
+	const uint64_t optionsHash = HashBakeSettings(settings);
+	const std::string cachePath = GetCachePath(sourcePath);
+	const std::string name = std::filesystem::path(sourcePath).filename().string();
+	MemoryMappedFile source(sourcePath);
+
+	if (!source.IsOpen()) {
+		sptr baked = Open(cachePath);
+		if (baked != nullptr && baked->GetOptionsHash() == optionsHash) {
+			return baked->GetData(name);
+		}
+		LOG_WARN("Could not load texture \"{}\"", sourcePath);
+		return nullptr;
+	}
+
+	const uint64_t sourceHash = BakedMesh::Hash(source.GetData(), source.GetSize());
+	sptr baked = Open(cachePath);
+	if (baked != nullptr && baked->GetSourceHash() == sourceHash && baked->GetOptionsHash() == optionsHash) {
+		return baked->GetData(name);
+	}
+	// The stale cache is still mapped, which would stop Write from replacing it on Windows
+	baked.reset();
+
+	std::shared_ptr<TextureBakeResult> result;
+	try {
+		result = _Bake(source, sourcePath, settings);
+	}
+	catch (const std::runtime_error& e) {
+		LOG_WARN("Could not bake texture \"{}\": {}", sourcePath, e.what());
+		return nullptr;
+	}
+	try {
+		Write(cachePath, *result, sourceHash, optionsHash);
+	}
+	catch (const std::runtime_error& e) {
+		// Failing to cache is not fatal, we'll just have to bake again next time
+		LOG_WARN("Could not cache texture \"{}\": {}", sourcePath, e.what());
+	}
+
+	Texture2DData::sptr data = std::make_shared<Texture2DData>(result->Format, result->Levels, result->Data.data(), result);
+	data->DebugName = name;
+	return data;
+}
+
+std::string BakedTexture::BakeFile(const std::string& sourcePath, const TextureBakeSettings& settings)
+{
+	MemoryMappedFile source(sourcePath);
+	if (!source.IsOpen()) {
+		throw std::runtime_error("Failed to open file");
+	}
+
+	std::shared_ptr<TextureBakeResult> result = _Bake(source, sourcePath, settings);
+	const std::string cachePath = GetCachePath(sourcePath);
+	Write(cachePath, *result, BakedMesh::Hash(source.GetData(), source.GetSize()), HashBakeSettings(settings));
+	return cachePath;
+}
+
+std::vector<Texture2DData::sptr> BakedTexture::LoadCachedArray(const std::string& cachePath, const std::vector<std::string>& sourcePaths,
+	const TextureBakeSettings& settings)
+{
+	const uint64_t optionsHash = HashBakeSettings(settings);
+	const std::string name = std::filesystem::path(cachePath).filename().string();
+	std::vector<MemoryMappedFile::sptr> sources;
+	uint64_t sourceHash;
+	const bool hasSources = _OpenSources(sourcePaths, sources, sourceHash);
+
+	// Gets the data for every layer of a baked array, as long as it has the layers we expect
+	auto getLayers = [&](const sptr& baked) {
+		std::vector<Texture2DData::sptr> result;
+		if (baked != nullptr && baked->GetLayerCount() == sourcePaths.size() && baked->GetOptionsHash() == optionsHash &&
+			(!hasSources || baked->GetSourceHash() == sourceHash)) {
+			for (uint32_t ix = 0; ix < baked->GetLayerCount(); ix++) {
+				result.push_back(baked->GetData(name, ix));
+			}
+		}
+		return result;
+	};
+
+	std::vector<Texture2DData::sptr> result = getLayers(Open(cachePath));
+	if (!result.empty() || !hasSources) {
+		if (result.empty()) {
+			LOG_WARN("Could not load texture array \"{}\"", cachePath);
+		}
+		return result;
+	}
+
+	std::shared_ptr<TextureBakeResult> baked;
+	try {
+		baked = _BakeArray(sources, sourcePaths, settings);
+	}
+	catch (const std::runtime_error& e) {
+		LOG_WARN("Could not bake texture array \"{}\": {}", cachePath, e.what());
+		return result;
+	}
+	try {
+		Write(cachePath, *baked, sourceHash, optionsHash);
+	}
+	catch (const std::runtime_error& e) {
+		LOG_WARN("Could not cache texture array \"{}\": {}", cachePath, e.what());
+	}
+
+	const size_t layerSize = baked->Data.size() / baked->Layers;
+	for (uint32_t ix = 0; ix < baked->Layers; ix++) {
+		Texture2DData::sptr data = std::make_shared<Texture2DData>(baked->Format, baked->Levels, baked->Data.data() + ix * layerSize, baked);
+		data->DebugName = name;
+		result.push_back(data);
+	}
+	return result;
+}
+
+void BakedTexture::BakeArrayFile(const std::string& cachePath, const std::vector<std::string>& sourcePaths, const TextureBakeSettings& settings)
+{
+	std::vector<MemoryMappedFile::sptr> sources;
+	uint64_t sourceHash;
+	if (!_OpenSources(sourcePaths, sources, sourceHash)) {
+		throw std::runtime_error("Failed to open all of the layers");
+	}
+	Write(cachePath, *_BakeArray(sources, sourcePaths, settings), sourceHash, HashBakeSettings(settings));
+}
+
+bool BakedTexture::_OpenSources(const std::vector<std::string>& sourcePaths, std::vector<MemoryMappedFile::sptr>& sources, uint64_t& hash)
+{
+	std::vector<uint64_t> hashes;
+	for (const std::string& path : sourcePaths) {
+		MemoryMappedFile::sptr source = MemoryMappedFile::Create(path);
+		if (!source->IsOpen()) {
+			return false;
+		}
+		hashes.push_back(BakedMesh::Hash(source->GetData(), source->GetSize()));
+		sources.push_back(source);
+	}
+	hash = BakedMesh::Hash(hashes.data(), hashes.size() * sizeof(uint64_t));
+	return !sources.empty();
+}
+
+std::shared_ptr<TextureBakeResult> BakedTexture::_BakeArray(const std::vector<MemoryMappedFile::sptr>& sources,
+	const std::vector<std::string>& sourcePaths, const TextureBakeSettings& settings)
+{
+	std::vector<TextureImage> images;
+	for (size_t ix = 0; ix < sources.size(); ix++) {
+		Texture2DData::sptr decoded = Texture2DData::LoadFromMemory(sources[ix]->GetData(), sources[ix]->GetSize(), sourcePaths[ix]);
+		if (decoded == nullptr) {
+			throw std::runtime_error("Failed to decode " + sourcePaths[ix]);
+		}
+		images.push_back(TextureBaker::FromData(*decoded));
+	}
+	return std::make_shared<TextureBakeResult>(TextureBaker::BakeArray(images, settings, sourcePaths));
+}
+
+std::shared_ptr<TextureBakeResult> BakedTexture::_Bake(const MemoryMappedFile& source, const std::string& sourcePath, const TextureBakeSettings& settings)
+{
+	Texture2DData::sptr decoded = Texture2DData::LoadFromMemory(source.GetData(), source.GetSize(), sourcePath);
+	if (decoded == nullptr) {
+		throw std::runtime_error("Failed to decode image");
+	}
+	return std::make_shared<TextureBakeResult>(TextureBaker::Bake(TextureBaker::FromData(*decoded), settings, sourcePath));
+}
+
+std::string BakedTexture::GetCachePath(const std::string& sourcePath)
+{
+	return std::filesystem::path(sourcePath).replace_extension(".dds").string();
+}
+
+uint64_t BakedTexture::HashBakeSettings(const TextureBakeSettings& settings)
+{
+	const uint32_t values[] = {
+		TextureBaker::VERSION,
+		BlockCompressor::VERSION,
+		static_cast<uint32_t>(settings.Compression),
+		settings.GenerateMips ? 1u : 0u,
+		static_cast<uint32_t>(settings.Filter),
+		static_cast<uint32_t>(settings.ColorSpace),
+		settings.WrapEdges ? 1u : 0u
+	};
+	return BakedMesh::Hash(values, sizeof(values));
+}
@@ -0,0 +1,427 @@
+#include "BlockCompressor.h"
+
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "JobSystem.h"
+#include "Logging.h"
+
+// The interpolation weights (out of 64) for BC7's 4 bit indices
+static const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+// The weight of the first endpoint for each of BC1's 4 color indices
+static const float BC1_WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+inline int ClampRound(float value, int maxValue) {
+	return std::min(std::max(static_cast<int>(value + 0.5f), 0), maxValue);
+}
+
+/// <summary>
+/// Writes a packed stream of bits, starting from the lowest bit of the first byte
+/// </summary>
+struct BlockWriter
+{
+	uint8_t* Output;
+	uint32_t Position = 0;
+
+	BlockWriter(uint8_t* output, size_t size) : Output(output) { memset(output, 0, size); }
+
+	void Write(uint32_t value, int bits) {
+		for (int ix = 0; ix < bits; ix++, Position++) {
+			Output[Position >> 3] |= ((value >> ix) & 1) << (Position & 7);
+		}
+	}
+};
+
+// Finds the direction that the texels of a block are most spread out along, by power iteration on their covariance
+// matrix. Returns false if every texel is the same
+static bool PrincipalAxis(const float points[16][4], int dims, const float mean[4], float axis[4]) {
+	float cov[4][4] = { };
+	for (int ix = 0; ix < 16; ix++) {
+		float d[4];
+		for (int a = 0; a < dims; a++) {
+			d[a] = points[ix][a] - mean[a];
+		}
+		for (int a = 0; a < dims; a++) {
+			for (int b = 0; b < dims; b++) {
+				cov[a][b] += d[a] * d[b];
+			}
+		}
+	}
+
+	// Start from the row of the channel that varies the most, which is never perpendicular to the answer
+	int start = 0;
+	for (int a = 1; a < dims; a++) {
+		if (cov[a][a] > cov[start][start]) {
+			start = a;
+		}
+	}
+	if (cov[start][start] <= 0.0f) {
+		return false;
+	}
+	for (int a = 0; a < dims; a++) {
+		axis[a] = cov[start][a];
+	}
+
+	for (int iteration = 0; iteration < 8; iteration++) {
+		float next[4] = { };
+		float largest = 0.0f;
+		for (int a = 0; a < dims; a++) {
+			for (int b = 0; b < dims; b++) {
+				next[a] += cov[a][b] * axis[b];
+			}
+			largest = std::max(largest, std::abs(next[a]));
+		}
+		if (largest <= 0.0f) {
+			return false;
+		}
+		for (int a = 0; a < dims; a++) {
+			axis[a] = next[a] / largest;
+		}
+	}
+	return true;
+}
+
+// Loads a block into floats, returning the mean of each channel
+static void LoadBlock(const uint8_t* rgba, float points[16][4], float mean[4]) {
+	mean[0] = mean[1] = mean[2] = mean[3] = 0.0f;
+	for (int ix = 0; ix < 16; ix++) {
+		for (int c = 0; c < 4; c++) {
+			points[ix][c] = rgba[ix * 4 + c];
+			mean[c] += points[ix][c] / 16.0f;
+		}
+	}
+}
+
+// Picks starting endpoints for a block, from the extremes of it's texels along their principal axis
+static void InitialEndpoints(const float points[16][4], int dims, const float mean[4], float e0[4], float e1[4]) {
+	float axis[4];
+	if (!PrincipalAxis(points, dims, mean, axis)) {
+		memcpy(e0, mean, sizeof(float) * 4);
+		memcpy(e1, mean, sizeof(float) * 4);
+		return;
+	}
+	float minT = std::numeric_limits<float>::max(), maxT = -std::numeric_limits<float>::max();
+	for (int ix = 0; ix < 16; ix++) {
+		float t = 0.0f;
+		for (int a = 0; a < dims; a++) {
+			t += (points[ix][a] - mean[a]) * axis[a];
+		}
+		if (t < minT) { minT = t; memcpy(e1, points[ix], sizeof(float) * 4); }
+		if (t > maxT) { maxT = t; memcpy(e0, points[ix], sizeof(float) * 4); }
+	}
+}
+
+// Fits new endpoints to a set of indices with least squares, given the weight of the first endpoint for each texel.
+// Returns false if the indices don't constrain the endpoints (ex: all texels use the same index)
+static bool FitEndpoints(const float points[16][4], int dims, const float weights[16], float e0[4], float e1[4]) {
+	float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+	float ax[4] = { }, bx[4] = { };
+	for (int ix = 0; ix < 16; ix++) {
+		const float a = weights[ix], b = 1.0f - weights[ix];
+		aa += a * a; ab += a * b; bb += b * b;
+		for (int c = 0; c < dims; c++) {
+			ax[c] += a * points[ix][c];
+			bx[c] += b * points[ix][c];
+		}
+	}
+	const float det = aa * bb - ab * ab;
+	if (std::abs(det) < 1.0e-4f) {
+		return false;
+	}
+	for (int c = 0; c < dims; c++) {
+		e0[c] = std::min(std::max((bb * ax[c] - ab * bx[c]) / det, 0.0f), 255.0f);
+		e1[c] = std::min(std::max((aa * bx[c] - ab * ax[c]) / det, 0.0f), 255.0f);
+	}
+	return true;
+}
+
+inline uint16_t Pack565(const float color[4]) {
+	return static_cast<uint16_t>((ClampRound(color[0] * 31.0f / 255.0f, 31) << 11) |
+		(ClampRound(color[1] * 63.0f / 255.0f, 63) << 5) | ClampRound(color[2] * 31.0f / 255.0f, 31));
+}
+
+inline void Unpack565(uint16_t packed, int color[3]) {
+	const int r = packed >> 11, g = (packed >> 5) & 63, b = packed & 31;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+// Chooses the best BC1 index for each texel given a pair of endpoints, swapping them if needed so that the block
+// decodes in 4 color mode. Returns the total squared error
+static uint32_t FitColorIndices(const float points[16][4], uint16_t& c0, uint16_t& c1, uint8_t indices[16]) {
+	if (c0 < c1) {
+		std::swap(c0, c1);
+	}
+	int palette[4][3];
+	Unpack565(c0, palette[0]);
+	Unpack565(c1, palette[1]);
+	for (int c = 0; c < 3; c++) {
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+	// If the endpoints are equal the block decodes in 3 color mode, where only index 0 is safe to use
+	const int paletteSize = c0 == c1 ? 1 : 4;
+
+	uint32_t total = 0;
+	for (int ix = 0; ix < 16; ix++) {
+		uint32_t best = std::numeric_limits<uint32_t>::max();
+		for (int p = 0; p < paletteSize; p++) {
+			uint32_t error = 0;
+			for (int c = 0; c < 3; c++) {
+				const int diff = static_cast<int>(points[ix][c]) - palette[p][c];
+				error += diff * diff;
+			}
+			if (error < best) {
+				best = error;
+				indices[ix] = static_cast<uint8_t>(p);
+			}
+		}
+		total += best;
+	}
+	return total;
+}
+
+// Encodes the color half of a BC1 or BC3 block
+static void EncodeColorBlock(const uint8_t* rgba, uint8_t* output) {
+	float points[16][4], mean[4], e0[4], e1[4];
+	LoadBlock(rgba, points, mean);
+	InitialEndpoints(points, 3, mean, e0, e1);
+
+	uint32_t bestError = std::numeric_limits<uint32_t>::max();
+	uint16_t best0 = 0, best1 = 0;
+	uint8_t bestIndices[16] = { };
+	for (int iteration = 0; iteration < 3; iteration++) {
+		uint16_t c0 = Pack565(e0), c1 = Pack565(e1);
+		uint8_t indices[16];
+		const uint32_t error = FitColorIndices(points, c0, c1, indices);
+		if (error < bestError) {
+			bestError = error;
+			best0 = c0;
+			best1 = c1;
+			memcpy(bestIndices, indices, sizeof(indices));
+		}
+		if (error == 0 || iteration == 2) {
+			break;
+		}
+
+		float weights[16];
+		for (int ix = 0; ix < 16; ix++) {
+			weights[ix] = BC1_WEIGHTS[indices[ix]];
+		}
+		// The indices refer to the endpoints in the order FitColorIndices left them
+		float fit0[4], fit1[4];
+		if (!FitEndpoints(points, 3, weights, fit0, fit1)) {
+			break;
+		}
+		memcpy(e0, fit0, sizeof(e0));
+		memcpy(e1, fit1, sizeof(e1));
+	}
+
+	BlockWriter writer(output, 8);
+	writer.Write(best0, 16);
+	writer.Write(best1, 16);
+	for (int ix = 0; ix < 16; ix++) {
+		writer.Write(bestIndices[ix], 2);
+	}
+}
+
+void BlockCompressor::EncodeBC1(const uint8_t* rgba, uint8_t* output) {
+	EncodeColorBlock(rgba, output);
+}
+
+void BlockCompressor::EncodeBC3(const uint8_t* rgba, uint8_t* output) {
+	EncodeBC4(rgba + 3, 4, output);
+	EncodeColorBlock(rgba, output + 8);
+}
+
+void BlockCompressor::EncodeBC4(const uint8_t* values, size_t stride, uint8_t* output) {
+	int minValue = 255, maxValue = 0;
+	for (int ix = 0; ix < 16; ix++) {
+		minValue = std::min(minValue, static_cast<int>(values[ix * stride]));
+		maxValue = std::max(maxValue, static_cast<int>(values[ix * stride]));
+	}
+
+	BlockWriter writer(output, 8);
+	writer.Write(maxValue, 8);
+	writer.Write(minValue, 8);
+	if (minValue == maxValue) {
+		return;
+	}
+
+	// With the first endpoint larger, the block decodes to the endpoints and 6 values evenly spaced between them
+	int palette[8];
+	palette[0] = maxValue;
+	palette[1] = minValue;
+	for (int ix = 2; ix < 8; ix++) {
+		palette[ix] = ((8 - ix) * maxValue + (ix - 1) * minValue) / 7;
+	}
+	for (int ix = 0; ix < 16; ix++) {
+		const int value = values[ix * stride];
+		int best = 0;
+		for (int p = 1; p < 8; p++) {
+			if (std::abs(palette[p] - value) < std::abs(palette[best] - value)) {
+				best = p;
+			}
+		}
+		writer.Write(best, 3);
+	}
+}
+
+void BlockCompressor::EncodeBC5(const uint8_t* rg, size_t stride, uint8_t* output) {
+	EncodeBC4(rg, stride, output);
+	EncodeBC4(rg + 1, stride, output + 8);
+}
+
+/// <summary>
+/// A BC7 mode 6 endpoint, 7 bits per channel plus a p-bit that is shared by all the channels
+/// </summary>
+struct Bc7Endpoint
+{
+	int Channels[4];
+	int PBit;
+
+	int Expand(int channel) const { return (Channels[channel] << 1) | PBit; }
+};
+
+// Quantizes an endpoint to 7 bits per channel, picking whichever p-bit fits it best. Opaque blocks always use a
+// p-bit of 1, so that their alpha decodes to exactly 255
+static Bc7Endpoint QuantizeBc7Endpoint(const float color[4], bool isOpaque) {
+	Bc7Endpoint best = { };
+	float bestError = std::numeric_limits<float>::max();
+	for (int pBit = isOpaque ? 1 : 0; pBit < 2; pBit++) {
+		Bc7Endpoint endpoint;
+		endpoint.PBit = pBit;
+		float error = 0.0f;
+		for (int c = 0; c < 4; c++) {
+			endpoint.Channels[c] = ClampRound((color[c] - pBit) / 2.0f, 127);
+			const float diff = endpoint.Expand(c) - color[c];
+			error += diff * diff;
+		}
+		if (error < bestError) {
+			bestError = error;
+			best = endpoint;
+		}
+	}
+	return best;
+}
+
+void BlockCompressor::EncodeBC7(const uint8_t* rgba, uint8_t* output) {
+	float points[16][4], mean[4], e0[4], e1[4];
+	LoadBlock(rgba, points, mean);
+	bool isOpaque = true;
+	for (int ix = 0; ix < 16; ix++) {
+		isOpaque &= rgba[ix * 4 + 3] == 255;
+	}
+	InitialEndpoints(points, 4, mean, e0, e1);
+
+	uint32_t bestError = std::numeric_limits<uint32_t>::max();
+	Bc7Endpoint best0 = { }, best1 = { };
+	uint8_t bestIndices[16] = { };
+	for (int iteration = 0; iteration < 3; iteration++) {
+		const Bc7Endpoint q0 = QuantizeBc7Endpoint(e0, isOpaque);
+		const Bc7Endpoint q1 = QuantizeBc7Endpoint(e1, isOpaque);
+
+		int palette[16][4];
+		for (int p = 0; p < 16; p++) {
+			for (int c = 0; c < 4; c++) {
+				palette[p][c] = ((64 - BC7_WEIGHTS[p]) * q0.Expand(c) + BC7_WEIGHTS[p] * q1.Expand(c) + 32) >> 6;
+			}
+		}
+
+		uint8_t indices[16];
+		uint32_t error = 0;
+		for (int ix = 0; ix < 16; ix++) {
+			uint32_t texelBest = std::numeric_limits<uint32_t>::max();
+			for (int p = 0; p < 16; p++) {
+				uint32_t texelError = 0;
+				for (int c = 0; c < 4; c++) {
+					const int diff = static_cast<int>(points[ix][c]) - palette[p][c];
+					texelError += diff * diff;
+				}
+				if (texelError < texelBest) {
+					texelBest = texelError;
+					indices[ix] = static_cast<uint8_t>(p);
+				}
+			}
+			error += texelBest;
+		}
+
+		if (error < bestError) {
+			bestError = error;
+			best0 = q0;
+			best1 = q1;
+			memcpy(bestIndices, indices, sizeof(indices));
+		}
+		if (error == 0 || iteration == 2) {
+			break;
+		}
+
+		float weights[16];
+		for (int ix = 0; ix < 16; ix++) {
+			weights[ix] = 1.0f - BC7_WEIGHTS[indices[ix]] / 64.0f;
+		}
+		if (!FitEndpoints(points, 4, weights, e0, e1)) {
+			break;
+		}
+	}
+
+	// The top bit of the first texel's index is implied to be 0, so we flip the line around if it is set
+	if (bestIndices[0] & 8) {
+		std::swap(best0, best1);
+		for (int ix = 0; ix < 16; ix++) {
+			bestIndices[ix] = 15 - bestIndices[ix];
+		}
+	}
+
+	BlockWriter writer(output, 16);
+	writer.Write(1 << 6, 7); // Mode 6
+	for (int c = 0; c < 4; c++) {
+		writer.Write(best0.Channels[c], 7);
+		writer.Write(best1.Channels[c], 7);
+	}
+	writer.Write(best0.PBit, 1);
+	writer.Write(best1.PBit, 1);
+	writer.Write(bestIndices[0], 3);
+	for (int ix = 1; ix < 16; ix++) {
+		writer.Write(bestIndices[ix], 4);
+	}
+}
+
+void BlockCompressor::Compress(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels, InternalFormat format, uint8_t* output) {
+	LOG_ASSERT(IsCompressed(format), "Format {} is not block compressed", format);
+	const uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+	const size_t blockSize = GetBlockSize(format);
+
+	JobSystem::ParallelFor(blocksY, 4, [&](size_t begin, size_t end) {
+		uint8_t block[64];
+		for (size_t by = begin; by < end; by++) {
+			for (uint32_t bx = 0; bx < blocksX; bx++) {
+				// Gather the block as RGBA, repeating the last row and column of the image to pad partial blocks
+				for (uint32_t y = 0; y < 4; y++) {
+					const uint32_t sy = std::min(static_cast<uint32_t>(by) * 4 + y, height - 1);
+					for (uint32_t x = 0; x < 4; x++) {
+						const uint32_t sx = std::min(bx * 4 + x, width - 1);
+						const uint8_t* texel = pixels + (static_cast<size_t>(sy) * width + sx) * channels;
+						uint8_t* dest = block + (y * 4 + x) * 4;
+						for (uint32_t c = 0; c < 4; c++) {
+							dest[c] = c < channels ? texel[c] : (c == 3 ? 255 : 0);
+						}
+					}
+				}
+
+				uint8_t* dest = output + (by * blocksX + bx) * blockSize;
+				switch (format) {
+					case InternalFormat::BC1: EncodeBC1(block, dest); break;
+					case InternalFormat::BC3: EncodeBC3(block, dest); break;
+					case InternalFormat::BC4: EncodeBC4(block, 4, dest); break;
+					case InternalFormat::BC5: EncodeBC5(block, 4, dest); break;
+					case InternalFormat::BC7: EncodeBC7(block, dest); break;
+					default: break;
+				}
+			}
+		}
+	});
+}
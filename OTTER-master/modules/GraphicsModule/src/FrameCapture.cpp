@@ -0,0 +1,170 @@
+#include "FrameCapture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <stb_image.h>
+#include <stb_image_write.h>
+
+#include "Logging.h"
+
+FrameCapture::FrameCapture(uint32_t bufferCount) :
+	_slots(std::max(bufferCount, 1u)), _next(0), _pending(0)
+{
+	for (Slot& slot : _slots) {
+		glCreateBuffers(1, &slot.Buffer);
+	}
+}
+
+FrameCapture::~FrameCapture() {
+	for (Slot& slot : _slots) {
+		if (slot.Fence != nullptr) {
+			glDeleteSync(slot.Fence);
+		}
+		glDeleteBuffers(1, &slot.Buffer);
+	}
+}
+
+bool FrameCapture::Request(const Framebuffer& framebuffer, uint64_t frame) {
+	if (_pending == _slots.size()) {
+		return false;
+	}
+
+	Slot& slot = _slots[_next];
+	slot.Frame = frame;
+	slot.Width = framebuffer.GetWidth();
+	slot.Height = framebuffer.GetHeight();
+
+	// Buffers only ever grow, so that resizing back and forth doesn't re-allocate them
+	const size_t size = static_cast<size_t>(slot.Width) * slot.Height * 4;
+	if (slot.Capacity < size) {
+		glNamedBufferData(slot.Buffer, size, nullptr, GL_STREAM_READ);
+		slot.Capacity = size;
+	}
+
+	// With a pack buffer bound, glReadPixels writes into the buffer instead of our memory, and returns right away
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer.GetHandle());
+	glNamedFramebufferReadBuffer(framebuffer.GetHandle(), GL_COLOR_ATTACHMENT0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, slot.Width, slot.Height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	_next = (_next + 1) % _slots.size();
+	_pending++;
+	return true;
+}
+
+bool FrameCapture::_Collect(std::vector<CapturedFrame>& results, GLuint64 timeout) {
+	const uint32_t index = static_cast<uint32_t>((_next + _slots.size() - _pending) % _slots.size());
+	Slot& slot = _slots[index];
+
+	// The flush makes sure the fence actually gets submitted, otherwise we could wait on it forever
+	const GLenum status = glClientWaitSync(slot.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+	if (status == GL_TIMEOUT_EXPIRED) {
+		return false;
+	}
+	LOG_ASSERT(status != GL_WAIT_FAILED, "Failed to wait on frame capture fence");
+	glDeleteSync(slot.Fence);
+	slot.Fence = nullptr;
+
+	CapturedFrame& result = results.emplace_back();
+	result.Frame = slot.Frame;
+	result.Width = slot.Width;
+	result.Height = slot.Height;
+	result.Pixels.resize(static_cast<size_t>(slot.Width) * slot.Height * 4);
+	const void* mapped = glMapNamedBufferRange(slot.Buffer, 0, result.Pixels.size(), GL_MAP_READ_BIT);
+	if (mapped != nullptr) {
+		memcpy(result.Pixels.data(), mapped, result.Pixels.size());
+		glUnmapNamedBuffer(slot.Buffer);
+	} else {
+		LOG_WARN("Failed to map the buffer for captured frame {}", slot.Frame);
+	}
+
+	_pending--;
+	return true;
+}
+
+size_t FrameCapture::Poll(std::vector<CapturedFrame>& results) {
+	size_t count = 0;
+	while (_pending > 0 && _Collect(results, 0)) {
+		count++;
+	}
+	return count;
+}
+
+size_t FrameCapture::Flush(std::vector<CapturedFrame>& results) {
+	size_t count = 0;
+	while (_pending > 0) {
+		if (_Collect(results, std::numeric_limits<GLuint64>::max())) {
+			count++;
+		}
+	}
+	return count;
+}
+
+CapturedFrame FrameCapture::ReadNow(const Framebuffer& framebuffer, uint64_t frame) {
+	CapturedFrame result;
+	result.Frame = frame;
+	result.Width = framebuffer.GetWidth();
+	result.Height = framebuffer.GetHeight();
+	result.Pixels.resize(static_cast<size_t>(result.Width) * result.Height * 4);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer.GetHandle());
+	glNamedFramebufferReadBuffer(framebuffer.GetHandle(), GL_COLOR_ATTACHMENT0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, result.Width, result.Height, GL_RGBA, GL_UNSIGNED_BYTE, result.Pixels.data());
+	return result;
+}
+
+void FrameCapture::WritePng(const std::string& path, const CapturedFrame& frame) {
+	stbi_flip_vertically_on_write(true);
+	const int result = stbi_write_png(path.c_str(), frame.Width, frame.Height, 4, frame.Pixels.data(), frame.Width * 4);
+	stbi_flip_vertically_on_write(false);
+	if (result == 0) {
+		throw std::runtime_error("Failed to write frame to " + path);
+	}
+}
+
+CapturedFrame FrameCapture::ReadPng(const std::string& path) {
+	CapturedFrame result;
+	int width = 0, height = 0, channels = 0;
+	stbi_set_flip_vertically_on_load(true);
+	uint8_t* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+	if (pixels == nullptr) {
+		return result;
+	}
+	result.Width = width;
+	result.Height = height;
+	result.Pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+	stbi_image_free(pixels);
+	return result;
+}
+
+FrameDifference FrameCapture::Compare(const CapturedFrame& a, const CapturedFrame& b, uint32_t tolerance) {
+	FrameDifference result;
+	if (a.Width != b.Width || a.Height != b.Height || a.Pixels.size() != b.Pixels.size()) {
+		result.DifferentPixels = std::max(a.Width * a.Height, b.Width * b.Height);
+		result.MaxDifference = 255;
+		return result;
+	}
+
+	double squaredError = 0.0;
+	for (size_t ix = 0; ix < a.Pixels.size(); ix += 4) {
+		bool different = false;
+		for (size_t c = 0; c < 4; c++) {
+			const uint32_t diff = static_cast<uint32_t>(std::abs((int)a.Pixels[ix + c] - (int)b.Pixels[ix + c]));
+			result.MaxDifference = std::max(result.MaxDifference, diff);
+			different |= diff > tolerance;
+			squaredError += diff * diff;
+		}
+		result.DifferentPixels += different ? 1 : 0;
+	}
+	const double mse = a.Pixels.empty() ? 0.0 : squaredError / a.Pixels.size();
+	result.Psnr = mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+	return result;
+}
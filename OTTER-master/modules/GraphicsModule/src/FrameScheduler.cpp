@@ -0,0 +1,64 @@
+#include "FrameScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Timing.h"
+#include "TransformSystem.h"
+#include "Logging.h"
+
+FrameScheduler::FrameScheduler(float fixedTimeStep, uint32_t maxSubsteps) :
+	FixedTimeStep(fixedTimeStep), MaxSubsteps(maxSubsteps), MaxFrameTime(1.0f), Interpolate(true),
+	_transforms(nullptr), _lastTime(0.0), _hasLastTime(false), _accumulator(0.0), _inStep(false),
+	_stepsThisFrame(0), _totalSteps(0), _droppedTime(0.0), _alpha(1.0f)
+{
+	LOG_ASSERT(fixedTimeStep > 0.0f, "Fixed time step must be greater than zero");
+}
+
+void FrameScheduler::BeginFrame(entt::registry& registry, double now) {
+	LOG_ASSERT(!_inStep, "BeginFrame was called before the last frame's fixed steps finished");
+	_transforms = TransformSystem::Get(registry).get();
+
+	// The first frame has nothing to measure against, so it doesn't simulate anything
+	const double delta = _hasLastTime ? std::clamp(now - _lastTime, 0.0, (double)MaxFrameTime) : 0.0;
+	_lastTime = now;
+	_hasLastTime = true;
+	_accumulator += delta;
+	_stepsThisFrame = 0;
+
+	Timing& timing = Timing::Instance();
+	timing.LastFrame = timing.CurrentFrame;
+	timing.CurrentFrame = now;
+	timing.DeltaTime = static_cast<float>(delta);
+	timing.FixedTimeStep = FixedTimeStep;
+}
+
+bool FrameScheduler::StepFixed() {
+	Timing& timing = Timing::Instance();
+	if (_inStep) {
+		_transforms->EndFixedStep();
+		_inStep = false;
+		_accumulator -= FixedTimeStep;
+		_stepsThisFrame++;
+		_totalSteps++;
+		timing.FixedTime += FixedTimeStep;
+	}
+
+	if (_accumulator >= FixedTimeStep) {
+		if (_stepsThisFrame < MaxSubsteps) {
+			_transforms->BeginFixedStep();
+			_inStep = true;
+			return true;
+		}
+		// We're too far behind to catch up, so we keep the partial step and drop the rest. The game slows down
+		// instead of locking up
+		const double dropped = std::floor(_accumulator / FixedTimeStep) * FixedTimeStep;
+		_droppedTime += dropped;
+		_accumulator -= dropped;
+	}
+
+	_alpha = Interpolate ? static_cast<float>(_accumulator / FixedTimeStep) : 1.0f;
+	_transforms->SetInterpolation(_alpha);
+	timing.InterpolationAlpha = _alpha;
+	return false;
+}
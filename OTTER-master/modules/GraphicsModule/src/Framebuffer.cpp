@@ -0,0 +1,74 @@
+#include "Framebuffer.h"
+
+#include "Logging.h"
+
+Framebuffer::Framebuffer(const FramebufferDescription& description) :
+	_description(description), _handle(0), _depth(0), _color(nullptr)
+{
+	glCreateFramebuffers(1, &_handle);
+	_RecreateAttachments();
+}
+
+Framebuffer::~Framebuffer() {
+	if (_depth != 0) {
+		glDeleteRenderbuffers(1, &_depth);
+	}
+	if (_handle != 0) {
+		glDeleteFramebuffers(1, &_handle);
+	}
+}
+
+void Framebuffer::_RecreateAttachments() {
+	if (_depth != 0) {
+		glDeleteRenderbuffers(1, &_depth);
+		_depth = 0;
+	}
+	_color = nullptr;
+
+	if (_description.Width * _description.Height == 0) {
+		return;
+	}
+
+	// The color target is a plain texture, so that what we render can be sampled or read back
+	Texture2DDescription colorDesc;
+	colorDesc.Width = _description.Width;
+	colorDesc.Height = _description.Height;
+	colorDesc.Format = _description.ColorFormat;
+	colorDesc.HorizontalWrap = WrapMode::ClampToEdge;
+	colorDesc.VerticalWrap = WrapMode::ClampToEdge;
+	colorDesc.MinificationFilter = MinFilter::Linear;
+	colorDesc.MagnificationFilter = MagFilter::Linear;
+	colorDesc.MaxAnisotropic = 1.0f;
+	colorDesc.GenerateMipMaps = false;
+	_color = Texture2D::Create(colorDesc);
+	glNamedFramebufferTexture(_handle, GL_COLOR_ATTACHMENT0, _color->GetHandle(), 0);
+
+	// We never sample the depth, so a renderbuffer is enough
+	if (_description.HasDepth) {
+		glCreateRenderbuffers(1, &_depth);
+		glNamedRenderbufferStorage(_depth, GL_DEPTH24_STENCIL8, _description.Width, _description.Height);
+		glNamedFramebufferRenderbuffer(_handle, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _depth);
+	} else {
+		glNamedFramebufferRenderbuffer(_handle, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, 0);
+	}
+
+	const GLenum status = glCheckNamedFramebufferStatus(_handle, GL_FRAMEBUFFER);
+	LOG_ASSERT(status == GL_FRAMEBUFFER_COMPLETE, "Framebuffer is incomplete (status 0x{:x})", status);
+}
+
+void Framebuffer::Bind() const {
+	glBindFramebuffer(GL_FRAMEBUFFER, _handle);
+	glViewport(0, 0, _description.Width, _description.Height);
+}
+
+void Framebuffer::Unbind() {
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Framebuffer::Resize(uint32_t width, uint32_t height) {
+	if (_description.Width != width || _description.Height != height) {
+		_description.Width = width;
+		_description.Height = height;
+		_RecreateAttachments();
+	}
+}
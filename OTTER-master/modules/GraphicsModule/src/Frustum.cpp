@@ -0,0 +1,163 @@
+#include "Frustum.h"
+
+#include <algorithm>
+
+#include "Profiler.h"
+
+// SSE2 is always available on x64, on other platforms we fall back to testing one object at a time
+#if defined(_M_X64) || defined(__SSE2__)
+#define FRUSTUM_USE_SSE 1
+#include <emmintrin.h>
+#else
+#define FRUSTUM_USE_SSE 0
+#endif
+
+// Objects with invalid bounds are given a huge (but finite, so we never multiply infinity by 0) size so they never get culled
+const float UNBOUNDED_SIZE = 1.0e30f;
+
+void BoundsBatch::Clear() {
+	_count = 0;
+	_centerX.clear(); _centerY.clear(); _centerZ.clear();
+	_extentX.clear(); _extentY.clear(); _extentZ.clear();
+	_radius.clear();
+}
+
+void BoundsBatch::Push(const MeshBounds& bounds, const glm::mat4& world) {
+	// Grow the arrays a group of 4 at a time, so they are always padded for the SIMD loop
+	if (_count % 4 == 0) {
+		const size_t padded = _count + 4;
+		_centerX.resize(padded, 0.0f); _centerY.resize(padded, 0.0f); _centerZ.resize(padded, 0.0f);
+		_extentX.resize(padded, 0.0f); _extentY.resize(padded, 0.0f); _extentZ.resize(padded, 0.0f);
+		_radius.resize(padded, 0.0f);
+	}
+	const size_t ix = _count++;
+
+	if (!bounds.IsValid()) {
+		_centerX[ix] = world[3].x; _centerY[ix] = world[3].y; _centerZ[ix] = world[3].z;
+		_extentX[ix] = _extentY[ix] = _extentZ[ix] = UNBOUNDED_SIZE;
+		_radius[ix] = UNBOUNDED_SIZE;
+		return;
+	}
+
+	// Transform the box by projecting the transformed axes onto the world axes, this gives the smallest world
+	// aligned box that contains the transformed box
+	const glm::vec3 center = glm::vec3(world * glm::vec4(bounds.GetCenter(), 1.0f));
+	const glm::vec3 extents = bounds.GetExtents();
+	const glm::mat3 absRotScale = glm::mat3(glm::abs(glm::vec3(world[0])), glm::abs(glm::vec3(world[1])), glm::abs(glm::vec3(world[2])));
+	const glm::vec3 worldExtents = absRotScale * extents;
+
+	// The sphere is scaled by the largest scale of the transform, so it still contains the mesh with non-uniform scales
+	const float maxScale = glm::sqrt(std::max({
+		glm::dot(glm::vec3(world[0]), glm::vec3(world[0])),
+		glm::dot(glm::vec3(world[1]), glm::vec3(world[1])),
+		glm::dot(glm::vec3(world[2]), glm::vec3(world[2]))
+	}));
+
+	_centerX[ix] = center.x; _centerY[ix] = center.y; _centerZ[ix] = center.z;
+	_extentX[ix] = worldExtents.x; _extentY[ix] = worldExtents.y; _extentZ[ix] = worldExtents.z;
+	_radius[ix] = bounds.Radius * maxScale;
+}
+
+Frustum::Frustum() {
+	Update(glm::mat4(1.0f));
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection) {
+	Update(viewProjection);
+}
+
+void Frustum::Update(const glm::mat4& viewProjection) {
+	// Gribb-Hartmann plane extraction, each plane is the 4th row of the matrix plus or minus one of the other rows
+	const glm::vec4 row0 = glm::vec4(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+	const glm::vec4 row1 = glm::vec4(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+	const glm::vec4 row2 = glm::vec4(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+	const glm::vec4 row3 = glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+	_planes[(int)Plane::Left]   = row3 + row0;
+	_planes[(int)Plane::Right]  = row3 - row0;
+	_planes[(int)Plane::Bottom] = row3 + row1;
+	_planes[(int)Plane::Top]    = row3 - row1;
+	_planes[(int)Plane::Near]   = row3 + row2;
+	_planes[(int)Plane::Far]    = row3 - row2;
+
+	// Normalize the planes so that the distances we calculate are in world units, and can be compared to radii
+	for (int ix = 0; ix < PLANE_COUNT; ix++) {
+		const float length = glm::length(glm::vec3(_planes[ix]));
+		if (length > 0.0f) {
+			_planes[ix] /= length;
+		}
+	}
+}
+
+bool Frustum::Intersects(const MeshBounds& bounds, const glm::mat4& world) const {
+	BoundsBatch batch;
+	batch.Push(bounds, world);
+	std::vector<uint8_t> visible;
+	return Cull(batch, visible) > 0;
+}
+
+size_t Frustum::Cull(const BoundsBatch& batch, std::vector<uint8_t>& visible) const {
+	PROFILE_SCOPE("Frustum::Cull");
+	const size_t count = batch._count;
+	const size_t padded = (count + 3) & ~(size_t)3;
+	visible.resize(padded);
+
+	#if FRUSTUM_USE_SSE
+	// Broadcast the planes (and the absolute values of their normals) ahead of time
+	__m128 planeX[PLANE_COUNT], planeY[PLANE_COUNT], planeZ[PLANE_COUNT], planeW[PLANE_COUNT];
+	__m128 absX[PLANE_COUNT], absY[PLANE_COUNT], absZ[PLANE_COUNT];
+	for (int p = 0; p < PLANE_COUNT; p++) {
+		planeX[p] = _mm_set1_ps(_planes[p].x);
+		planeY[p] = _mm_set1_ps(_planes[p].y);
+		planeZ[p] = _mm_set1_ps(_planes[p].z);
+		planeW[p] = _mm_set1_ps(_planes[p].w);
+		absX[p]   = _mm_set1_ps(glm::abs(_planes[p].x));
+		absY[p]   = _mm_set1_ps(glm::abs(_planes[p].y));
+		absZ[p]   = _mm_set1_ps(glm::abs(_planes[p].z));
+	}
+	const __m128 zero = _mm_setzero_ps();
+
+	for (size_t ix = 0; ix < padded; ix += 4) {
+		const __m128 cx = _mm_loadu_ps(&batch._centerX[ix]);
+		const __m128 cy = _mm_loadu_ps(&batch._centerY[ix]);
+		const __m128 cz = _mm_loadu_ps(&batch._centerZ[ix]);
+		const __m128 ex = _mm_loadu_ps(&batch._extentX[ix]);
+		const __m128 ey = _mm_loadu_ps(&batch._extentY[ix]);
+		const __m128 ez = _mm_loadu_ps(&batch._extentZ[ix]);
+		const __m128 r  = _mm_loadu_ps(&batch._radius[ix]);
+
+		__m128 outside = zero;
+		for (int p = 0; p < PLANE_COUNT; p++) {
+			// Signed distance from the center to the plane
+			__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], cx), _mm_mul_ps(planeY[p], cy)),
+				_mm_add_ps(_mm_mul_ps(planeZ[p], cz), planeW[p]));
+			// How far the box reaches towards the plane, we use whichever of the box or sphere is tighter
+			__m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absX[p], ex), _mm_mul_ps(absY[p], ey)), _mm_mul_ps(absZ[p], ez));
+			reach = _mm_min_ps(reach, r);
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, reach), zero));
+		}
+
+		const int mask = _mm_movemask_ps(outside);
+		visible[ix + 0] = (mask & 1) == 0;
+		visible[ix + 1] = (mask & 2) == 0;
+		visible[ix + 2] = (mask & 4) == 0;
+		visible[ix + 3] = (mask & 8) == 0;
+	}
+	#else
+	for (size_t ix = 0; ix < count; ix++) {
+		bool isOutside = false;
+		for (int p = 0; p < PLANE_COUNT && !isOutside; p++) {
+			const glm::vec4& plane = _planes[p];
+			const float dist = plane.x * batch._centerX[ix] + plane.y * batch._centerY[ix] + plane.z * batch._centerZ[ix] + plane.w;
+			const float reach = std::min(
+				glm::abs(plane.x) * batch._extentX[ix] + glm::abs(plane.y) * batch._extentY[ix] + glm::abs(plane.z) * batch._extentZ[ix],
+				batch._radius[ix]);
+			isOutside = dist + reach < 0.0f;
+		}
+		visible[ix] = !isOutside;
+	}
+	#endif
+
+	visible.resize(count);
+	return (size_t)std::count(visible.begin(), visible.end(), (uint8_t)1);
+}
@@ -0,0 +1,228 @@
+#include "HeadlessContext.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "Logging.h"
+
+// Surfaceless contexts go through EGL directly, since GLFW always wants a window. Windows doesn't ship EGL (and the
+// libraries that do only offer GLES), so there we rely on the hidden window APIs instead. Builds that use this need
+// to link against libEGL
+#if !defined(_WIN32) && __has_include(<EGL/egl.h>)
+#define HEADLESS_HAS_SURFACELESS 1
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#else
+#define HEADLESS_HAS_SURFACELESS 0
+#endif
+
+// Outside of Windows we build GLFW's null platform (see dependencies/glfw3/premake5.lua), which can only make OSMesa
+// contexts, so the native and EGL window contexts would always fail there
+#if defined(_WIN32)
+#define HEADLESS_HAS_WINDOWED_NATIVE 1
+#else
+#define HEADLESS_HAS_WINDOWED_NATIVE 0
+#endif
+
+static const char* GetApiName(HeadlessContextApi api) {
+	switch (api) {
+		case HeadlessContextApi::Surfaceless: return "EGL surfaceless";
+		case HeadlessContextApi::Native:      return "native";
+		case HeadlessContextApi::EGL:         return "EGL";
+		case HeadlessContextApi::OSMesa:      return "OSMesa";
+		default:                              return "auto";
+	}
+}
+
+HeadlessContext::HeadlessContext() :
+	_api(HeadlessContextApi::Auto), _renderer(""), _framebuffer(nullptr),
+	_window(nullptr), _eglDisplay(nullptr), _eglContext(nullptr)
+{ }
+
+HeadlessContext::~HeadlessContext() {
+	// The framebuffer needs the context to still be current to clean up
+	MakeCurrent();
+	_framebuffer = nullptr;
+	_Destroy();
+}
+
+bool HeadlessContext::IsApiAvailable(HeadlessContextApi api) {
+	switch (api) {
+		case HeadlessContextApi::Surfaceless: return HEADLESS_HAS_SURFACELESS;
+		case HeadlessContextApi::Native:
+		case HeadlessContextApi::EGL:
+			return HEADLESS_HAS_WINDOWED_NATIVE;
+		case HeadlessContextApi::Auto:
+		case HeadlessContextApi::OSMesa:
+			return true;
+		default:
+			return false;
+	}
+}
+
+HeadlessContext::sptr HeadlessContext::Create(const HeadlessContextSettings& settings) {
+	// We can't use make_shared with our private constructor
+	sptr result = sptr(new HeadlessContext());
+
+	// In auto mode we prefer the options that need the least from the machine, APIs that this build doesn't support
+	// are skipped (on Linux that leaves surfaceless, then OSMesa)
+	const HeadlessContextApi order[] = {
+		HeadlessContextApi::Surfaceless, HeadlessContextApi::Native, HeadlessContextApi::EGL, HeadlessContextApi::OSMesa
+	};
+	bool created = false;
+	for (HeadlessContextApi api : order) {
+		if ((settings.Api != HeadlessContextApi::Auto && settings.Api != api) || !IsApiAvailable(api)) {
+			continue;
+		}
+
+		created = api == HeadlessContextApi::Surfaceless ?
+			result->_CreateSurfaceless(settings) : result->_CreateWindowed(settings, api);
+		if (created && result->_LoadGL(settings)) {
+			result->_api = api;
+			break;
+		}
+		result->_Destroy();
+		created = false;
+		LOG_INFO("Could not create a {} context for OpenGL {}.{}", GetApiName(api), settings.MajorVersion, settings.MinorVersion);
+	}
+	if (!created) {
+		LOG_ERROR("Failed to create a headless OpenGL context");
+		return nullptr;
+	}
+
+	FramebufferDescription desc;
+	desc.Width = settings.Width;
+	desc.Height = settings.Height;
+	result->_framebuffer = Framebuffer::Create(desc);
+	result->_framebuffer->Bind();
+
+	LOG_INFO("Created headless context ({}, {}, {}x{})", GetApiName(result->_api), result->_renderer, settings.Width, settings.Height);
+	return result;
+}
+
+bool HeadlessContext::_CreateSurfaceless(const HeadlessContextSettings& settings) {
+#if HEADLESS_HAS_SURFACELESS
+	// The surfaceless platform is an extension, so we have to look up the function that lets us ask for it
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+	if (getPlatformDisplay == nullptr) {
+		return false;
+	}
+	EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	EGLint major = 0, minor = 0;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+		return false;
+	}
+	_eglDisplay = display;
+
+	if (!eglBindAPI(EGL_OPENGL_API)) {
+		return false;
+	}
+
+	// We never draw to a surface, so any config will do, and we can go without one if the driver lets us
+	const EGLint configAttribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+	EGLConfig config = nullptr;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0) {
+		config = nullptr;
+	}
+
+	const EGLint contextAttribs[] = {
+		EGL_CONTEXT_MAJOR_VERSION, settings.MajorVersion,
+		EGL_CONTEXT_MINOR_VERSION, settings.MinorVersion,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_CONTEXT_OPENGL_DEBUG, settings.Debug ? EGL_TRUE : EGL_FALSE,
+		EGL_NONE
+	};
+	EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+	if (context == EGL_NO_CONTEXT) {
+		return false;
+	}
+	_eglContext = context;
+
+	return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+#else
+	(void)settings;
+	return false;
+#endif
+}
+
+bool HeadlessContext::_CreateWindowed(const HeadlessContextSettings& settings, HeadlessContextApi api) {
+	// It is safe to call this more than once, it only initializes GLFW the first time
+	if (glfwInit() == GLFW_FALSE) {
+		return false;
+	}
+
+	glfwDefaultWindowHints();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, settings.MajorVersion);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, settings.MinorVersion);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, settings.Debug);
+	glfwWindowHint(GLFW_CONTEXT_CREATION_API,
+		api == HeadlessContextApi::EGL ? GLFW_EGL_CONTEXT_API :
+		api == HeadlessContextApi::OSMesa ? GLFW_OSMESA_CONTEXT_API : GLFW_NATIVE_CONTEXT_API);
+
+	// We render into our own framebuffer, so the window only needs to exist
+	_window = glfwCreateWindow(1, 1, "Headless", nullptr, nullptr);
+	glfwDefaultWindowHints();
+	if (_window == nullptr) {
+		return false;
+	}
+	glfwMakeContextCurrent(_window);
+	return true;
+}
+
+bool HeadlessContext::_LoadGL(const HeadlessContextSettings& settings) {
+	GLADloadproc loader = nullptr;
+#if HEADLESS_HAS_SURFACELESS
+	if (_eglContext != nullptr) {
+		loader = reinterpret_cast<GLADloadproc>(eglGetProcAddress);
+	}
+#endif
+	if (_window != nullptr) {
+		loader = reinterpret_cast<GLADloadproc>(glfwGetProcAddress);
+	}
+	if (loader == nullptr || gladLoadGLLoader(loader) == 0) {
+		return false;
+	}
+
+	// Drivers are allowed to give us a newer version than we asked for, but not an older one
+	if (GLVersion.major < settings.MajorVersion || (GLVersion.major == settings.MajorVersion && GLVersion.minor < settings.MinorVersion)) {
+		return false;
+	}
+
+	const GLubyte* renderer = glGetString(GL_RENDERER);
+	_renderer = renderer != nullptr ? reinterpret_cast<const char*>(renderer) : "unknown";
+	return true;
+}
+
+void HeadlessContext::MakeCurrent() {
+#if HEADLESS_HAS_SURFACELESS
+	if (_eglContext != nullptr) {
+		eglMakeCurrent(_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, _eglContext);
+	}
+#endif
+	if (_window != nullptr) {
+		glfwMakeContextCurrent(_window);
+	}
+}
+
+void HeadlessContext::_Destroy() {
+#if HEADLESS_HAS_SURFACELESS
+	if (_eglDisplay != nullptr) {
+		eglMakeCurrent(_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (_eglContext != nullptr) {
+			eglDestroyContext(_eglDisplay, _eglContext);
+		}
+		eglTerminate(_eglDisplay);
+	}
+#endif
+	_eglContext = nullptr;
+	_eglDisplay = nullptr;
+
+	if (_window != nullptr) {
+		glfwDestroyWindow(_window);
+		_window = nullptr;
+	}
+}
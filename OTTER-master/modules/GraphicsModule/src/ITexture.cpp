@@ -1,6 +1,7 @@
 #include "ITexture.h"
 
 #include "Logging.h"
+#include "RenderState.h"
 
 ITexture::Limits ITexture::_limits = ITexture::Limits();
 bool ITexture::_isStaticInit = false;
@@ -31,6 +32,7 @@ ITexture::ITexture()
 
 ITexture::~ITexture() {
 	if (glIsTexture(_handle)) {
+		RenderState::ForgetTexture(_handle);
 		glDeleteTextures(1, &_handle);
 	}
 }
@@ -38,14 +40,14 @@ ITexture::~ITexture() {
 void ITexture::Bind(int slot) const {
 	if (_handle != 0) {
 		//glActiveTexture(GL_TEXTURE0 + slot);
-		glBindTextureUnit(slot, _handle);
+		RenderState::BindTexture(slot, _handle);
 	}
 }
 
 void ITexture::Unbind(int slot)
 {
 	//glActiveTexture(GL_TEXTURE0 + slot);
-	glBindTextureUnit(slot, 0);
+	RenderState::BindTexture(slot, 0);
 }
 
 
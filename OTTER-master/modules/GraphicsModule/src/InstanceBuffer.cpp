@@ -0,0 +1,110 @@
+#include "InstanceBuffer.h"
+#include "Logging.h"
+
+#include <vector>
+#include <cstring>
+
+std::atomic<uint64_t> InstanceBuffer::_nextGeneration(1);
+
+InstanceBuffer::InstanceBuffer(uint32_t capacity, uint32_t framesInFlight) :
+	_handle(0),
+	_generation(0),
+	_mapped(nullptr),
+	_capacity(capacity > 0 ? capacity : 1),
+	_frameCount(framesInFlight > 0 ? framesInFlight : 1),
+	_frameIndex(0),
+	_head(0),
+	_fences(nullptr)
+{
+	_fences = new GLsync[_frameCount];
+	for (uint32_t ix = 0; ix < _frameCount; ix++) {
+		_fences[ix] = nullptr;
+	}
+	_Allocate();
+}
+
+InstanceBuffer::~InstanceBuffer() {
+	_Free();
+	delete[] _fences;
+}
+
+void InstanceBuffer::BeginFrame() {
+	_frameIndex = (_frameIndex + 1) % _frameCount;
+	_head = 0;
+
+	// If the GPU is still reading from this region, we have to wait for it
+	GLsync& fence = _fences[_frameIndex];
+	if (fence != nullptr) {
+		GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		while (result == GL_TIMEOUT_EXPIRED) {
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+		}
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+}
+
+void InstanceBuffer::EndFrame() {
+	GLsync& fence = _fences[_frameIndex];
+	if (fence != nullptr) {
+		glDeleteSync(fence);
+	}
+	fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+uint32_t InstanceBuffer::Push(const glm::mat4& model, const glm::mat3& normalMatrix, const glm::vec4& params, const glm::vec4& materialParams) {
+	if (_head >= _capacity) {
+		_Grow();
+	}
+	const uint32_t index = _frameIndex * _capacity + _head;
+	InstanceData& data = _mapped[index];
+	data.Model = model;
+	data.NormalMatrix = glm::mat4(normalMatrix);
+	data.Params = params;
+	data.MaterialParams = materialParams;
+	_head++;
+	return index;
+}
+
+void InstanceBuffer::_Allocate() {
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	const GLsizeiptr size = (GLsizeiptr)sizeof(InstanceData) * _capacity * _frameCount;
+	glCreateBuffers(1, &_handle);
+	_generation = _nextGeneration.fetch_add(1, std::memory_order_relaxed);
+	glNamedBufferStorage(_handle, size, nullptr, flags);
+	_mapped = static_cast<InstanceData*>(glMapNamedBufferRange(_handle, 0, size, flags));
+	LOG_ASSERT(_mapped != nullptr, "Failed to map instance buffer!");
+}
+
+void InstanceBuffer::_Free() {
+	for (uint32_t ix = 0; ix < _frameCount; ix++) {
+		if (_fences[ix] != nullptr) {
+			glDeleteSync(_fences[ix]);
+			_fences[ix] = nullptr;
+		}
+	}
+	if (_handle != 0) {
+		glUnmapNamedBuffer(_handle);
+		glDeleteBuffers(1, &_handle);
+		_handle = 0;
+		_mapped = nullptr;
+	}
+}
+
+void InstanceBuffer::_Grow() {
+	LOG_WARN("Instance buffer is full, growing from {} to {} instances per frame", _capacity, _capacity * 2);
+	// Draws earlier in this frame may still be reading from the old buffer, GL keeps it alive until they finish.
+	// Waiting here means all the fences are already signaled, so we can start fresh
+	glFinish();
+
+	// Keep the instances pushed so far this frame, they're moved to the start of the new buffer so that instance
+	// indices stay contiguous for the rest of the frame
+	std::vector<InstanceData> current(_mapped + _frameIndex * _capacity, _mapped + _frameIndex * _capacity + _head);
+	_Free();
+	_capacity *= 2;
+	_frameIndex = 0;
+	_Allocate();
+	if (!current.empty()) {
+		memcpy(_mapped, current.data(), current.size() * sizeof(InstanceData));
+	}
+}
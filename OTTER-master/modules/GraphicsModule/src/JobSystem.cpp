@@ -0,0 +1,538 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+#include "Logging.h"
+#include "Profiler.h"
+
+/// <summary>
+/// A job waiting to be run
+/// </summary>
+struct Job
+{
+	std::function<void()> Func;
+	JobCounter::sptr      Counter;
+	JobAffinity           Affinity;
+};
+
+/// <summary>
+/// A Chase-Lev work stealing deque, following "Correct and Efficient Work-Stealing for Weak Memory Models"
+/// (Le et al. 2013). Only the owning thread may Push and Pop (at the bottom), any thread may Steal (from the top)
+/// </summary>
+class WorkDeque
+{
+public:
+	WorkDeque() : _top(0), _bottom(0), _buffer(nullptr) {
+		_buffers.push_back(std::make_unique<Buffer>((int64_t)INITIAL_CAPACITY));
+		_buffer.store(_buffers.back().get(), std::memory_order_relaxed);
+	}
+
+	void Push(Job* job) {
+		const int64_t bottom = _bottom.load(std::memory_order_relaxed);
+		const int64_t top = _top.load(std::memory_order_acquire);
+		Buffer* buffer = _buffer.load(std::memory_order_relaxed);
+		if (bottom - top > buffer->Mask) {
+			buffer = _Grow(buffer, top, bottom);
+		}
+		buffer->Put(bottom, job);
+		// Releasing bottom publishes the job to thieves, who acquire it before reading the slot
+		_bottom.store(bottom + 1, std::memory_order_release);
+	}
+
+	Job* Pop() {
+		const int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+		Buffer* buffer = _buffer.load(std::memory_order_relaxed);
+		_bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = _top.load(std::memory_order_relaxed);
+
+		if (top > bottom) {
+			// Empty
+			_bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		Job* job = buffer->Get(bottom);
+		if (top == bottom) {
+			// This is the last job, so we race any thieves for it
+			if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				job = nullptr;
+			}
+			_bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	Job* Steal() {
+		int64_t top = _top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t bottom = _bottom.load(std::memory_order_acquire);
+		if (top >= bottom) {
+			return nullptr;
+		}
+		Buffer* buffer = _buffer.load(std::memory_order_acquire);
+		Job* job = buffer->Get(top);
+		// If this fails, the owner or another thief got there first
+		if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+		return job;
+	}
+
+private:
+	static const int64_t INITIAL_CAPACITY = 1024;
+
+	struct Buffer
+	{
+		int64_t                                Mask;
+		std::unique_ptr<std::atomic<Job*>[]> Items;
+
+		Buffer(int64_t capacity) : Mask(capacity - 1), Items(new std::atomic<Job*>[capacity]) { }
+		Job* Get(int64_t index) const { return Items[index & Mask].load(std::memory_order_relaxed); }
+		void Put(int64_t index, Job* job) { Items[index & Mask].store(job, std::memory_order_relaxed); }
+	};
+
+	alignas(64) std::atomic<int64_t> _top;
+	alignas(64) std::atomic<int64_t> _bottom;
+	std::atomic<Buffer*>             _buffer;
+	// Old buffers are kept until we are destroyed, since a thief may still be reading from one
+	std::vector<std::unique_ptr<Buffer>> _buffers;
+
+	Buffer* _Grow(Buffer* buffer, int64_t top, int64_t bottom) {
+		_buffers.push_back(std::make_unique<Buffer>((buffer->Mask + 1) * 2));
+		Buffer* result = _buffers.back().get();
+		for (int64_t ix = top; ix < bottom; ix++) {
+			result->Put(ix, buffer->Get(ix));
+		}
+		_buffer.store(result, std::memory_order_release);
+		return result;
+	}
+};
+
+/// <summary>
+/// A thread that runs jobs, either the main thread (index 0) or one of the workers
+/// </summary>
+struct JobThread
+{
+	WorkDeque             Deque;
+	std::string           Name;
+	std::atomic<uint64_t> JobsRun;
+	std::atomic<uint64_t> Steals;
+	std::atomic<uint64_t> BusyNs;
+
+	JobThread(const std::string& name) : Name(name), JobsRun(0), Steals(0), BusyNs(0) { }
+};
+
+// Threads are only added in Init and removed in Shutdown, while no jobs are running
+static std::mutex                              startMutex;
+static std::atomic<bool>                       running(false);
+static std::atomic<bool>                       stopping(false);
+static std::thread::id                         mainThreadId;
+static std::vector<std::unique_ptr<JobThread>> threads;
+static std::vector<std::thread>                workers;
+static thread_local int                        currentThread = -1;
+static thread_local int                        serialDepth = 0;
+
+// Jobs scheduled from threads that aren't part of the job system go here, since they can't push to a deque
+static std::mutex          injectedMutex;
+static std::deque<Job*>    injectedJobs;
+static std::atomic<size_t> injectedCount(0);
+
+static std::mutex       mainMutex;
+static std::deque<Job*> mainJobs;
+
+// Background jobs are kept out of the deques, since the main thread steals from those while it waits
+static std::mutex          backgroundMutex;
+static std::deque<Job*>    backgroundJobs;
+static std::atomic<size_t> backgroundCount(0);
+
+// The number of jobs that are waiting in a deque or the injected queue, workers only sleep when this is zero
+static std::mutex              sleepMutex;
+static std::condition_variable sleepCondition;
+static std::atomic<int64_t>    queuedJobs(0);
+static std::atomic<int>        sleepingWorkers(0);
+
+static std::chrono::steady_clock::time_point statsStart = std::chrono::steady_clock::now();
+
+// Stops the workers at exit if the application never called Shutdown
+static struct JobSystemExitGuard {
+	~JobSystemExitGuard() { JobSystem::Shutdown(); }
+} exitGuard;
+
+void JobSystem::Init(size_t workerCount)
+{
+	std::lock_guard<std::mutex> lock(startMutex);
+	if (running.load()) {
+		return;
+	}
+	if (workerCount == 0) {
+		// Leave a core for the main thread
+		const size_t hardwareThreads = std::thread::hardware_concurrency();
+		workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+	workerCount = std::min(workerCount, (size_t)MAX_WORKERS);
+
+	mainThreadId = std::this_thread::get_id();
+	currentThread = 0;
+	threads.push_back(std::make_unique<JobThread>("Main"));
+	for (size_t ix = 0; ix < workerCount; ix++) {
+		threads.push_back(std::make_unique<JobThread>("Worker " + std::to_string(ix)));
+	}
+	statsStart = std::chrono::steady_clock::now();
+	stopping = false;
+	// We're running before the workers start, so that a worker that schedules a job doesn't try to start us again
+	running = true;
+	for (size_t ix = 1; ix <= workerCount; ix++) {
+		workers.emplace_back(&JobSystem::_WorkerLoop, (int)ix);
+	}
+}
+
+void JobSystem::Shutdown()
+{
+	std::lock_guard<std::mutex> lock(startMutex);
+	if (!running.load()) {
+		return;
+	}
+	if (IsMainThread()) {
+		RunMainThreadJobs();
+	}
+
+	// Workers drain every deque before they stop, so nobody is left waiting on a job that never runs
+	{
+		std::lock_guard<std::mutex> sleepLock(sleepMutex);
+		stopping = true;
+	}
+	sleepCondition.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	workers.clear();
+
+	// Anything still left for the main thread can't run anymore
+	{
+		std::lock_guard<std::mutex> mainLock(mainMutex);
+		for (Job* job : mainJobs) {
+			delete job;
+		}
+		mainJobs.clear();
+	}
+	threads.clear();
+	queuedJobs = 0;
+	currentThread = -1;
+	running = false;
+}
+
+bool JobSystem::IsRunning()
+{
+	return running.load();
+}
+
+size_t JobSystem::GetWorkerCount()
+{
+	_EnsureRunning();
+	return threads.size() - 1;
+}
+
+bool JobSystem::IsMainThread()
+{
+	return running.load() && std::this_thread::get_id() == mainThreadId;
+}
+
+bool JobSystem::IsWorkerThread()
+{
+	return currentThread > 0;
+}
+
+void JobSystem::Run(std::function<void()> func, const JobCounter::sptr& counter, const JobCounter::sptr& dependency, JobAffinity affinity)
+{
+	_EnsureRunning();
+	Job* job = new Job{ std::move(func), counter, affinity };
+	if (counter != nullptr) {
+		counter->_pending.fetch_add(1, std::memory_order_acq_rel);
+	}
+	if (dependency != nullptr) {
+		// The counter only releases it's dependents after reaching zero while holding the lock, so either we see
+		// that it's done, or it sees our job
+		std::lock_guard<std::mutex> lock(dependency->_lock);
+		if (dependency->_pending.load(std::memory_order_acquire) > 0) {
+			dependency->_dependents.push_back(job);
+			return;
+		}
+	}
+	_Schedule(job);
+}
+
+void JobSystem::Wait(const JobCounter::sptr& counter)
+{
+	if (counter == nullptr) {
+		return;
+	}
+	const int thread = currentThread;
+	while (!counter->IsDone()) {
+		if (thread == 0) {
+			Job* job = nullptr;
+			{
+				std::lock_guard<std::mutex> lock(mainMutex);
+				if (!mainJobs.empty()) {
+					job = mainJobs.front();
+					mainJobs.pop_front();
+				}
+			}
+			if (job != nullptr) {
+				_Execute(job, thread, false);
+				continue;
+			}
+		}
+		if (!_TryRunOne(thread)) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+size_t JobSystem::RunMainThreadJobs()
+{
+	LOG_ASSERT(currentThread == 0, "Main thread jobs can only be run from the main thread");
+	std::deque<Job*> jobs;
+	{
+		std::lock_guard<std::mutex> lock(mainMutex);
+		jobs.swap(mainJobs);
+	}
+	// Jobs scheduled by these jobs will wait until next time, so this always returns
+	for (Job* job : jobs) {
+		_Execute(job, 0, false);
+	}
+	return jobs.size();
+}
+
+void JobSystem::ParallelFor(size_t count, size_t minChunkSize, const std::function<void(size_t, size_t)>& func)
+{
+	// More chunks than threads lets threads that finish early steal from the ones that don't
+	static const size_t CHUNKS_PER_THREAD = 4;
+
+	if (count == 0) {
+		return;
+	}
+	const size_t minChunk = std::max<size_t>(minChunkSize, 1);
+	const size_t maxChunks = (count + minChunk - 1) / minChunk;
+	const size_t chunks = std::min((GetWorkerCount() + 1) * CHUNKS_PER_THREAD, maxChunks);
+	if (chunks <= 1 || serialDepth > 0) {
+		func(0, count);
+		return;
+	}
+
+	// We have to wait for every chunk before throwing, since the jobs reference func
+	std::mutex errorMutex;
+	std::exception_ptr error = nullptr;
+	auto runChunk = [&](size_t begin, size_t end) {
+		try {
+			func(begin, end);
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(errorMutex);
+			if (error == nullptr) {
+				error = std::current_exception();
+			}
+		}
+	};
+
+	const size_t chunkSize = (count + chunks - 1) / chunks;
+	JobCounter::sptr counter = JobCounter::Create();
+	for (size_t begin = chunkSize; begin < count; begin += chunkSize) {
+		const size_t end = std::min(begin + chunkSize, count);
+		Run([&runChunk, begin, end]() { runChunk(begin, end); }, counter);
+	}
+	// The calling thread takes the first chunk rather than sitting idle, then helps with the rest
+	runChunk(0, std::min(chunkSize, count));
+	Wait(counter);
+	if (error != nullptr) {
+		std::rethrow_exception(error);
+	}
+}
+
+JobSystem::SerialScope::SerialScope()
+{
+	serialDepth++;
+}
+
+JobSystem::SerialScope::~SerialScope()
+{
+	serialDepth--;
+}
+
+std::vector<JobSystem::ThreadStats> JobSystem::GetStats()
+{
+	std::vector<ThreadStats> result;
+	if (!running.load()) {
+		return result;
+	}
+	const double elapsedNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - statsStart).count();
+	result.reserve(threads.size());
+	for (const std::unique_ptr<JobThread>& thread : threads) {
+		ThreadStats stats;
+		stats.Name = thread->Name;
+		stats.JobsRun = thread->JobsRun.load(std::memory_order_relaxed);
+		stats.Steals = thread->Steals.load(std::memory_order_relaxed);
+		const uint64_t busyNs = thread->BusyNs.load(std::memory_order_relaxed);
+		stats.BusyMs = busyNs / 1000000.0;
+		stats.Utilization = elapsedNs > 0.0 ? (float)std::min(busyNs / elapsedNs, 1.0) : 0.0f;
+		result.push_back(stats);
+	}
+	return result;
+}
+
+void JobSystem::ResetStats()
+{
+	for (const std::unique_ptr<JobThread>& thread : threads) {
+		thread->JobsRun = 0;
+		thread->Steals = 0;
+		thread->BusyNs = 0;
+	}
+	statsStart = std::chrono::steady_clock::now();
+}
+
+void JobSystem::_Schedule(Job* job)
+{
+	if (job->Affinity == JobAffinity::MainThread) {
+		std::lock_guard<std::mutex> lock(mainMutex);
+		mainJobs.push_back(job);
+		return;
+	}
+
+	if (job->Affinity == JobAffinity::Background) {
+		std::lock_guard<std::mutex> lock(backgroundMutex);
+		backgroundJobs.push_back(job);
+		backgroundCount.fetch_add(1, std::memory_order_release);
+	} else if (currentThread >= 0) {
+		threads[currentThread]->Deque.Push(job);
+	} else {
+		std::lock_guard<std::mutex> lock(injectedMutex);
+		injectedJobs.push_back(job);
+		injectedCount.fetch_add(1, std::memory_order_release);
+	}
+	// A worker increments sleepingWorkers before checking queuedJobs, so if it missed our job, we see it sleeping
+	queuedJobs.fetch_add(1);
+	if (sleepingWorkers.load() > 0) {
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		sleepCondition.notify_one();
+	}
+}
+
+bool JobSystem::_TryRunOne(int threadIndex)
+{
+	// A cheap per thread random number, so that thieves don't all go after the same deque
+	static thread_local uint32_t stealSeed = (uint32_t)std::hash<std::thread::id>()(std::this_thread::get_id()) | 1u;
+
+	Job* job = nullptr;
+	bool stolen = false;
+	if (threadIndex >= 0) {
+		job = threads[threadIndex]->Deque.Pop();
+	}
+	if (job == nullptr) {
+		stealSeed ^= stealSeed << 13;
+		stealSeed ^= stealSeed >> 17;
+		stealSeed ^= stealSeed << 5;
+		const size_t count = threads.size();
+		const size_t start = stealSeed % count;
+		for (size_t ix = 0; ix < count && job == nullptr; ix++) {
+			const size_t victim = (start + ix) % count;
+			if ((int)victim != threadIndex) {
+				job = threads[victim]->Deque.Steal();
+			}
+		}
+		stolen = job != nullptr;
+	}
+	if (job == nullptr && injectedCount.load(std::memory_order_acquire) > 0) {
+		std::lock_guard<std::mutex> lock(injectedMutex);
+		if (!injectedJobs.empty()) {
+			job = injectedJobs.front();
+			injectedJobs.pop_front();
+			injectedCount.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+	// Background jobs come last, so they never hold up work that somebody is waiting on
+	if (job == nullptr && threadIndex != 0 && backgroundCount.load(std::memory_order_acquire) > 0) {
+		std::lock_guard<std::mutex> lock(backgroundMutex);
+		if (!backgroundJobs.empty()) {
+			job = backgroundJobs.front();
+			backgroundJobs.pop_front();
+			backgroundCount.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+	if (job == nullptr) {
+		return false;
+	}
+	queuedJobs.fetch_sub(1);
+	_Execute(job, threadIndex, stolen);
+	return true;
+}
+
+void JobSystem::_Execute(Job* job, int threadIndex, bool stolen)
+{
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	try {
+		PROFILE_SCOPE("Job");
+		job->Func();
+	}
+	catch (const std::exception& e) {
+		// Jobs from Submit capture their own exceptions, so this only catches errors from raw Run calls
+		LOG_WARN("Unhandled exception in job: {}", e.what());
+	}
+	catch (...) {
+		// Anything else still has to release the counter below, or whoever waits on it would hang
+		LOG_WARN("Unhandled exception of unknown type in job");
+	}
+	if (threadIndex >= 0) {
+		JobThread& thread = *threads[threadIndex];
+		thread.JobsRun.fetch_add(1, std::memory_order_relaxed);
+		thread.Steals.fetch_add(stolen ? 1 : 0, std::memory_order_relaxed);
+		thread.BusyNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+	}
+
+	JobCounter::sptr counter = std::move(job->Counter);
+	delete job;
+	if (counter != nullptr) {
+		_Finish(counter);
+	}
+}
+
+void JobSystem::_Finish(const JobCounter::sptr& counter)
+{
+	if (counter->_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		std::vector<Job*> ready;
+		{
+			std::lock_guard<std::mutex> lock(counter->_lock);
+			ready.swap(counter->_dependents);
+		}
+		for (Job* job : ready) {
+			_Schedule(job);
+		}
+	}
+}
+
+void JobSystem::_WorkerLoop(int threadIndex)
+{
+	currentThread = threadIndex;
+	Profiler::SetThreadName(threads[threadIndex]->Name);
+	while (true) {
+		if (_TryRunOne(threadIndex)) {
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepingWorkers.fetch_add(1);
+		sleepCondition.wait(lock, []() { return queuedJobs.load() > 0 || stopping.load(); });
+		sleepingWorkers.fetch_sub(1);
+		if (stopping.load() && queuedJobs.load() <= 0) {
+			return;
+		}
+	}
+}
+
+void JobSystem::_EnsureRunning()
+{
+	if (!running.load(std::memory_order_acquire)) {
+		Init(0);
+	}
+}
@@ -0,0 +1,117 @@
+#include "MaterialLayout.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include "Logging.h"
+
+// Converts an OpenGL uniform type into the type we store it as
+MaterialParamType GetParamType(GLenum type) {
+	switch (type) {
+	case GL_FLOAT:      return MaterialParamType::Float;
+	case GL_FLOAT_VEC2: return MaterialParamType::Vec2;
+	case GL_FLOAT_VEC3: return MaterialParamType::Vec3;
+	case GL_FLOAT_VEC4: return MaterialParamType::Vec4;
+	case GL_FLOAT_MAT3: return MaterialParamType::Mat3;
+	case GL_FLOAT_MAT4: return MaterialParamType::Mat4;
+	case GL_INT:
+	case GL_BOOL:       return MaterialParamType::Int;
+	case GL_SAMPLER_1D:
+	case GL_SAMPLER_2D:
+	case GL_SAMPLER_3D:
+	case GL_SAMPLER_CUBE:
+	case GL_SAMPLER_2D_SHADOW:
+	case GL_SAMPLER_2D_ARRAY:
+	case GL_SAMPLER_CUBE_MAP_ARRAY:
+	case GL_SAMPLER_BUFFER:
+	case GL_INT_SAMPLER_BUFFER:
+	case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+		return MaterialParamType::Texture;
+	default:            return MaterialParamType::Unknown;
+	}
+}
+
+MaterialLayout::sptr MaterialLayout::Get(const Shader::sptr& shader) {
+	static std::mutex lock;
+	static std::unordered_map<const Shader*, std::weak_ptr<MaterialLayout>> layouts;
+
+	std::lock_guard<std::mutex> guard(lock);
+	std::weak_ptr<MaterialLayout>& entry = layouts[shader.get()];
+	sptr result = entry.lock();
+	// We also need to check the shader, in case a new shader was created at the same address as a deleted one
+	if (result == nullptr || !result->IsFor(shader)) {
+		result = std::make_shared<MaterialLayout>(shader);
+		entry = result;
+	}
+	return result;
+}
+
+MaterialLayout::MaterialLayout(const Shader::sptr& shader) :
+	LastApplied(0),
+	_shader(shader),
+	_dataSize(0),
+	_textureCount(0)
+{
+	LOG_ASSERT(shader != nullptr, "Cannot build a material layout without a shader!");
+	const GLuint handle = shader->GetHandle();
+
+	GLint count = 0, maxLength = 0;
+	glGetProgramiv(handle, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+	std::string name;
+	name.resize(maxLength > 0 ? maxLength : 1);
+	for (GLint ix = 0; ix < count; ix++) {
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum glType = 0;
+		glGetActiveUniform(handle, ix, maxLength, &length, &size, &glType, &name[0]);
+
+		MaterialParam param;
+		param.Name = name.substr(0, length);
+		param.Location = glGetUniformLocation(handle, param.Name.c_str());
+		param.Type = GetParamType(glType);
+		param.Offset = 0;
+		// Skip uniforms in blocks (they have no location), and arrays or types that materials can't store
+		if (param.Location == -1 || param.Type == MaterialParamType::Unknown || size != 1) {
+			continue;
+		}
+		_params.push_back(param);
+	}
+
+	// Sorting by location means that Apply walks the uniforms in the same order the driver stores them
+	std::sort(_params.begin(), _params.end(), [](const MaterialParam& l, const MaterialParam& r) {
+		return l.Location < r.Location;
+	});
+
+	for (size_t ix = 0; ix < _params.size(); ix++) {
+		MaterialParam& param = _params[ix];
+		if (param.Type == MaterialParamType::Texture) {
+			param.Offset = _textureCount++;
+			// Sampler units never change for a layout, so we can set them once here instead of in every Apply
+			shader->SetUniform(param.Location, FIRST_TEXTURE_SLOT + (int)param.Offset);
+		} else {
+			param.Offset = _dataSize;
+			_dataSize += GetTypeSize(param.Type);
+		}
+		_lookup[param.Name] = (int)ix;
+	}
+}
+
+int MaterialLayout::FindParam(const std::string& name) const {
+	auto it = _lookup.find(name);
+	return it != _lookup.end() ? it->second : -1;
+}
+
+uint32_t MaterialLayout::GetTypeSize(MaterialParamType type) {
+	switch (type) {
+	case MaterialParamType::Float: return sizeof(float);
+	case MaterialParamType::Vec2:  return sizeof(glm::vec2);
+	case MaterialParamType::Vec3:  return sizeof(glm::vec3);
+	case MaterialParamType::Vec4:  return sizeof(glm::vec4);
+	case MaterialParamType::Mat3:  return sizeof(glm::mat3);
+	case MaterialParamType::Mat4:  return sizeof(glm::mat4);
+	case MaterialParamType::Int:   return sizeof(int);
+	default:                       return 0;
+	}
+}
@@ -0,0 +1,102 @@
+#include "MemoryMappedFile.h"
+
+#ifdef WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MemoryMappedFile::MemoryMappedFile(const std::string& path) :
+	_data(nullptr),
+	_size(0),
+	_isOpen(false),
+	_fileHandle(nullptr),
+	_mappingHandle(nullptr),
+	_fileDescriptor(-1)
+{
+#ifdef WINDOWS
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	_fileHandle = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		return;
+	}
+	_size = static_cast<size_t>(size.QuadPart);
+	_isOpen = true;
+
+	// Mapping a zero byte file is an error on Windows, so we just report an empty file
+	if (_size == 0) {
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		_isOpen = false;
+		return;
+	}
+	_mappingHandle = mapping;
+
+	_data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (_data == nullptr) {
+		_isOpen = false;
+	}
+#else
+	_fileDescriptor = open(path.c_str(), O_RDONLY);
+	if (_fileDescriptor == -1) {
+		return;
+	}
+
+	struct stat info;
+	if (fstat(_fileDescriptor, &info) != 0) {
+		return;
+	}
+	_size = static_cast<size_t>(info.st_size);
+	_isOpen = true;
+
+	if (_size == 0) {
+		return;
+	}
+
+	void* mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fileDescriptor, 0);
+	if (mapping == MAP_FAILED) {
+		_isOpen = false;
+		return;
+	}
+	// We will be reading the whole file front to back, let the OS know so it can read ahead
+	madvise(mapping, _size, MADV_SEQUENTIAL);
+	_data = static_cast<const char*>(mapping);
+#endif
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+#ifdef WINDOWS
+	if (_data != nullptr) {
+		UnmapViewOfFile(_data);
+	}
+	if (_mappingHandle != nullptr) {
+		CloseHandle(_mappingHandle);
+	}
+	if (_fileHandle != nullptr) {
+		CloseHandle(_fileHandle);
+	}
+#else
+	if (_data != nullptr) {
+		munmap(const_cast<char*>(_data), _size);
+	}
+	if (_fileDescriptor != -1) {
+		close(_fileDescriptor);
+	}
+#endif
+	_data = nullptr;
+	_size = 0;
+}
@@ -0,0 +1,38 @@
+#include "MeshBounds.h"
+
+#include <cstring>
+#include <algorithm>
+
+// Reads the position of a vertex, vertex data is not necessarily aligned so we copy it out
+inline glm::vec3 ReadPosition(const uint8_t* vertices, size_t stride, size_t index, size_t positionOffset) {
+	glm::vec3 result;
+	memcpy(&result, vertices + index * stride + positionOffset, sizeof(glm::vec3));
+	return result;
+}
+
+MeshBounds MeshBounds::FromVertices(const void* vertices, size_t stride, size_t count, size_t positionOffset)
+{
+	if (vertices == nullptr || count == 0) {
+		return MeshBounds();
+	}
+	const uint8_t* data = static_cast<const uint8_t*>(vertices);
+
+	glm::vec3 min = ReadPosition(data, stride, 0, positionOffset);
+	glm::vec3 max = min;
+	for (size_t ix = 1; ix < count; ix++) {
+		const glm::vec3 pos = ReadPosition(data, stride, ix, positionOffset);
+		min = glm::min(min, pos);
+		max = glm::max(max, pos);
+	}
+
+	// The sphere shares the box's center, so we need a second pass to find the furthest vertex from it. This is
+	// usually much tighter than using half the diagonal of the box
+	const glm::vec3 center = (min + max) * 0.5f;
+	float radiusSq = 0.0f;
+	for (size_t ix = 0; ix < count; ix++) {
+		const glm::vec3 offset = ReadPosition(data, stride, ix, positionOffset) - center;
+		radiusSq = std::max(radiusSq, glm::dot(offset, offset));
+	}
+
+	return MeshBounds(min, max, glm::sqrt(radiusSq));
+}
@@ -0,0 +1,300 @@
+#include "MeshOptimizer.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <numeric>
+#include <GLM/glm.hpp>
+
+// Forsyth's scoring uses a simulated LRU cache, which is a bit larger than the FIFO cache we measure with so that
+// it still favors vertices that have just fallen out of a smaller hardware cache
+const size_t LRU_CACHE_SIZE = 32;
+// The tuning values from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+const float CACHE_DECAY_POWER   = 1.5f;
+const float LAST_TRI_SCORE      = 0.75f;
+const float VALENCE_BOOST_SCALE = 2.0f;
+const float VALENCE_BOOST_POWER = 0.5f;
+// Scores are looked up from tables for vertices with up to this many remaining triangles
+const size_t MAX_VALENCE_TABLE = 64;
+
+const uint32_t NO_TRIANGLE = 0xFFFFFFFFu;
+
+/// <summary>
+/// Precomputed vertex scores, by position in the LRU cache and the number of triangles left to draw that use the vertex
+/// </summary>
+struct ForsythScoreTable
+{
+	float CacheScore[LRU_CACHE_SIZE];
+	float ValenceScore[MAX_VALENCE_TABLE];
+
+	ForsythScoreTable() {
+		for (size_t ix = 0; ix < LRU_CACHE_SIZE; ix++) {
+			// The 3 most recent vertices belong to the last triangle, we don't want to favor them too much or we will
+			// end up making strips, which use the cache less effectively than fans
+			CacheScore[ix] = ix < 3 ? LAST_TRI_SCORE :
+				std::pow(1.0f - (ix - 3) / static_cast<float>(LRU_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+		}
+		ValenceScore[0] = 0.0f;
+		for (size_t ix = 1; ix < MAX_VALENCE_TABLE; ix++) {
+			// Boosts vertices with few triangles left, so we finish them off rather than leaving lone triangles behind
+			ValenceScore[ix] = VALENCE_BOOST_SCALE * std::pow(static_cast<float>(ix), -VALENCE_BOOST_POWER);
+		}
+	}
+
+	float Score(int cachePos, uint32_t valence) const {
+		if (valence == 0) {
+			return -1.0f;
+		}
+		const float cache = cachePos < 0 ? 0.0f : CacheScore[cachePos];
+		return cache + (valence < MAX_VALENCE_TABLE ? ValenceScore[valence] :
+			VALENCE_BOOST_SCALE * std::pow(static_cast<float>(valence), -VALENCE_BOOST_POWER));
+	}
+};
+
+// Reads the position of a vertex, vertex data is not necessarily aligned so we copy it out
+inline glm::vec3 ReadPosition(const uint8_t* vertices, size_t stride, size_t index, size_t positionOffset) {
+	glm::vec3 result;
+	memcpy(&result, vertices + index * stride + positionOffset, sizeof(glm::vec3));
+	return result;
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize)
+{
+	VertexCacheStats result;
+	if (indexCount < 3 || vertexCount == 0) {
+		return result;
+	}
+
+	// Rather than shuffling a FIFO queue, we give each vertex the time it entered the cache. Since only misses advance
+	// the clock, a vertex is still in the cache if less than cacheSize misses have happened since it was added. The
+	// clock starts past the cache size so that every vertex starts out missing
+	std::vector<uint32_t> timestamps(vertexCount, 0);
+	uint32_t clock = static_cast<uint32_t>(cacheSize) + 1;
+	for (size_t ix = 0; ix < indexCount; ix++) {
+		const uint32_t vertex = indices[ix];
+		if (clock - timestamps[vertex] > cacheSize) {
+			timestamps[vertex] = clock++;
+			result.CacheMisses++;
+		}
+	}
+
+	const size_t usedVertices = vertexCount - std::count(timestamps.begin(), timestamps.end(), 0u);
+	result.ACMR = result.CacheMisses / static_cast<float>(indexCount / 3);
+	result.ATVR = usedVertices > 0 ? result.CacheMisses / static_cast<float>(usedVertices) : 0.0f;
+	return result;
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+	static const ForsythScoreTable table;
+
+	const size_t triCount = indexCount / 3;
+	if (triCount < 2 || vertexCount == 0) {
+		return;
+	}
+
+	// Build a list of the triangles using each vertex, packed into one array. The valence is the number of triangles
+	// that haven't been drawn yet, we keep those at the front of each vertex's list
+	std::vector<uint32_t> valence(vertexCount, 0);
+	for (size_t ix = 0; ix < triCount * 3; ix++) {
+		valence[indices[ix]]++;
+	}
+	std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		adjacencyOffset[ix + 1] = adjacencyOffset[ix] + valence[ix];
+	}
+	std::vector<uint32_t> adjacency(triCount * 3);
+	{
+		std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+		for (size_t ix = 0; ix < triCount * 3; ix++) {
+			adjacency[fill[indices[ix]]++] = static_cast<uint32_t>(ix / 3);
+		}
+	}
+
+	std::vector<float> vertexScore(vertexCount);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		vertexScore[ix] = table.Score(-1, valence[ix]);
+	}
+
+	// Our starting triangle is the one with the best score, with ties going to whichever comes first
+	std::vector<bool> emitted(triCount, false);
+	uint32_t best = 0;
+	float bestScore = -1.0f;
+	for (size_t ix = 0; ix < triCount; ix++) {
+		const float score = vertexScore[indices[ix * 3]] + vertexScore[indices[ix * 3 + 1]] + vertexScore[indices[ix * 3 + 2]];
+		if (score > bestScore) {
+			bestScore = score;
+			best = static_cast<uint32_t>(ix);
+		}
+	}
+
+	std::vector<uint32_t> result(triCount * 3);
+	uint32_t cache[LRU_CACHE_SIZE + 3];
+	size_t cacheCount = 0;
+	size_t nextUnemitted = 0;
+	for (size_t out = 0; out < triCount; out++) {
+		// If none of the triangles around the cache are left, we start again from the first triangle we haven't drawn
+		if (best == NO_TRIANGLE) {
+			while (emitted[nextUnemitted]) {
+				nextUnemitted++;
+			}
+			best = static_cast<uint32_t>(nextUnemitted);
+		}
+
+		const uint32_t* tri = indices + best * 3;
+		memcpy(&result[out * 3], tri, sizeof(uint32_t) * 3);
+		emitted[best] = true;
+
+		// Move the triangle past the end of each vertex's list of remaining triangles
+		for (int corner = 0; corner < 3; corner++) {
+			const uint32_t vertex = tri[corner];
+			uint32_t* list = &adjacency[adjacencyOffset[vertex]];
+			const uint32_t count = valence[vertex];
+			for (uint32_t ix = 0; ix < count; ix++) {
+				if (list[ix] == best) {
+					std::swap(list[ix], list[count - 1]);
+					break;
+				}
+			}
+			valence[vertex]--;
+		}
+
+		// The triangle's vertices move to the front of the cache, pushing everything else back
+		uint32_t newCache[LRU_CACHE_SIZE + 3];
+		size_t newCount = 0;
+		for (int corner = 0; corner < 3; corner++) {
+			if (std::find(newCache, newCache + newCount, tri[corner]) == newCache + newCount) {
+				newCache[newCount++] = tri[corner];
+			}
+		}
+		for (size_t ix = 0; ix < cacheCount; ix++) {
+			if (cache[ix] != tri[0] && cache[ix] != tri[1] && cache[ix] != tri[2]) {
+				newCache[newCount++] = cache[ix];
+			}
+		}
+
+		// Every vertex that moved (or fell out of the cache) has a new score, and so do the triangles around it
+		for (size_t ix = 0; ix < newCount; ix++) {
+			const uint32_t vertex = newCache[ix];
+			vertexScore[vertex] = table.Score(ix < LRU_CACHE_SIZE ? static_cast<int>(ix) : -1, valence[vertex]);
+		}
+		best = NO_TRIANGLE;
+		bestScore = -1.0f;
+		for (size_t ix = 0; ix < newCount; ix++) {
+			const uint32_t vertex = newCache[ix];
+			const uint32_t* list = &adjacency[adjacencyOffset[vertex]];
+			for (uint32_t t = 0; t < valence[vertex]; t++) {
+				const uint32_t* other = indices + list[t] * 3;
+				const float score = vertexScore[other[0]] + vertexScore[other[1]] + vertexScore[other[2]];
+				// Ties go to the lowest triangle index, so the result doesn't depend on the order of the lists
+				if (score > bestScore || (score == bestScore && list[t] < best)) {
+					bestScore = score;
+					best = list[t];
+				}
+			}
+		}
+
+		cacheCount = std::min(newCount, LRU_CACHE_SIZE);
+		std::copy(newCache, newCache + cacheCount, cache);
+	}
+
+	memcpy(indices, result.data(), sizeof(uint32_t) * triCount * 3);
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint32_t* indices, size_t indexCount, const void* vertices, size_t stride, size_t vertexCount,
+	size_t positionOffset, float threshold)
+{
+	const size_t triCount = indexCount / 3;
+	if (triCount < 2 || vertices == nullptr || vertexCount == 0) {
+		return;
+	}
+	const uint8_t* data = static_cast<const uint8_t*>(vertices);
+
+	// Split the triangles into clusters, ending a cluster as soon as it's ACMR (starting from an empty cache) gets close
+	// to that of the whole mesh. Each cluster is then nearly as cache friendly on it's own as it was in place
+	const float targetAcmr = AnalyzeVertexCache(indices, indexCount, vertexCount).ACMR * threshold;
+	std::vector<size_t> clusterStarts = { 0 };
+	{
+		std::vector<uint32_t> timestamps(vertexCount, 0);
+		uint32_t clock = static_cast<uint32_t>(FIFO_CACHE_SIZE) + 1;
+		size_t misses = 0;
+		for (size_t tri = 0; tri < triCount; tri++) {
+			for (int corner = 0; corner < 3; corner++) {
+				const uint32_t vertex = indices[tri * 3 + corner];
+				if (clock - timestamps[vertex] > FIFO_CACHE_SIZE) {
+					timestamps[vertex] = clock++;
+					misses++;
+				}
+			}
+			const size_t clusterTris = tri + 1 - clusterStarts.back();
+			if (misses <= targetAcmr * clusterTris && tri + 1 < triCount) {
+				clusterStarts.push_back(tri + 1);
+				misses = 0;
+				// Advancing the clock by the size of the cache flushes it
+				clock += static_cast<uint32_t>(FIFO_CACHE_SIZE) + 1;
+			}
+		}
+	}
+	clusterStarts.push_back(triCount);
+	const size_t clusterCount = clusterStarts.size() - 1;
+	if (clusterCount < 2) {
+		return;
+	}
+
+	// Find the area weighted center and normal of each cluster, as well as the center of the whole mesh
+	std::vector<glm::vec3> clusterCenters(clusterCount, glm::vec3(0.0f));
+	std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+	std::vector<float> clusterAreas(clusterCount, 0.0f);
+	glm::vec3 meshCenter(0.0f);
+	float meshArea = 0.0f;
+	for (size_t cluster = 0; cluster < clusterCount; cluster++) {
+		for (size_t tri = clusterStarts[cluster]; tri < clusterStarts[cluster + 1]; tri++) {
+			const glm::vec3 a = ReadPosition(data, stride, indices[tri * 3], positionOffset);
+			const glm::vec3 b = ReadPosition(data, stride, indices[tri * 3 + 1], positionOffset);
+			const glm::vec3 c = ReadPosition(data, stride, indices[tri * 3 + 2], positionOffset);
+			const glm::vec3 normal = glm::cross(b - a, c - a);
+			const float area = glm::length(normal);
+			clusterCenters[cluster] += (a + b + c) * (area / 3.0f);
+			clusterNormals[cluster] += normal;
+			clusterAreas[cluster] += area;
+		}
+		meshCenter += clusterCenters[cluster];
+		meshArea += clusterAreas[cluster];
+	}
+	meshCenter = meshArea > 0.0f ? meshCenter / meshArea : meshCenter;
+
+	// Clusters that face away from the middle of the mesh are more likely to be in front of the rest of it, so we
+	// draw those first and let the depth test reject what's behind them
+	std::vector<float> sortKeys(clusterCount, 0.0f);
+	for (size_t cluster = 0; cluster < clusterCount; cluster++) {
+		const float normalLength = glm::length(clusterNormals[cluster]);
+		if (clusterAreas[cluster] > 0.0f && normalLength > 0.0f) {
+			const glm::vec3 center = clusterCenters[cluster] / clusterAreas[cluster];
+			sortKeys[cluster] = glm::dot(center - meshCenter, clusterNormals[cluster] / normalLength);
+		}
+	}
+	std::vector<size_t> order(clusterCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<uint32_t> result;
+	result.reserve(triCount * 3);
+	for (size_t cluster : order) {
+		result.insert(result.end(), indices + clusterStarts[cluster] * 3, indices + clusterStarts[cluster + 1] * 3);
+	}
+	memcpy(indices, result.data(), sizeof(uint32_t) * result.size());
+}
+
+size_t MeshOptimizer::OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& remap)
+{
+	remap.assign(vertexCount, UNUSED);
+	uint32_t nextVertex = 0;
+	for (size_t ix = 0; ix < indexCount; ix++) {
+		uint32_t& index = indices[ix];
+		if (remap[index] == UNUSED) {
+			remap[index] = nextVertex++;
+		}
+		index = remap[index];
+	}
+	return nextVertex;
+}
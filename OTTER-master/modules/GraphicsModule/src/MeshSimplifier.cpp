@@ -0,0 +1,442 @@
+#include "MeshSimplifier.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <GLM/glm.hpp>
+
+// How strongly mesh borders and attribute seams resist being moved, relative to the surface around them
+const double BORDER_WEIGHT = 10.0;
+// The cost of collapsing an edge between vertices with opposite normals, relative to the squared length of the edge
+const double NORMAL_WEIGHT = 0.5;
+
+const uint32_t NO_VERTEX = 0xFFFFFFFFu;
+
+/// <summary>
+/// The sum of the squared distances to a set of weighted planes, stored as the upper half of a symmetric 4x4 matrix
+/// </summary>
+struct Quadric
+{
+	double XX, XY, XZ, XW, YY, YZ, YW, ZZ, ZW, WW;
+	// The total weight of the planes, used to turn the sum back into an average squared distance
+	double Weight;
+
+	Quadric() : XX(0), XY(0), XZ(0), XW(0), YY(0), YZ(0), YW(0), ZZ(0), ZW(0), WW(0), Weight(0) {}
+
+	// Adds the plane dot(normal, p) + d = 0, normal must be unit length
+	void AddPlane(const glm::dvec3& normal, double d, double weight) {
+		XX += weight * normal.x * normal.x; XY += weight * normal.x * normal.y; XZ += weight * normal.x * normal.z; XW += weight * normal.x * d;
+		YY += weight * normal.y * normal.y; YZ += weight * normal.y * normal.z; YW += weight * normal.y * d;
+		ZZ += weight * normal.z * normal.z; ZW += weight * normal.z * d;
+		WW += weight * d * d;
+		Weight += weight;
+	}
+
+	void Add(const Quadric& other) {
+		XX += other.XX; XY += other.XY; XZ += other.XZ; XW += other.XW;
+		YY += other.YY; YZ += other.YZ; YW += other.YW;
+		ZZ += other.ZZ; ZW += other.ZW;
+		WW += other.WW;
+		Weight += other.Weight;
+	}
+
+	// Gets the weighted average squared distance from a point to the planes
+	double Evaluate(const glm::dvec3& p) const {
+		const double sum =
+			XX * p.x * p.x + YY * p.y * p.y + ZZ * p.z * p.z +
+			2.0 * (XY * p.x * p.y + XZ * p.x * p.z + YZ * p.y * p.z) +
+			2.0 * (XW * p.x + YW * p.y + ZW * p.z) + WW;
+		return Weight > 0.0 ? std::max(sum, 0.0) / Weight : 0.0;
+	}
+};
+
+/// <summary>
+/// A possible collapse of one position onto a neighbouring position
+/// </summary>
+struct EdgeCollapse
+{
+	uint32_t From;
+	uint32_t To;
+	double   Cost;
+};
+
+// Vertex data is not necessarily aligned so we copy attributes out
+inline glm::vec3 ReadVertexVec3(const uint8_t* vertices, size_t stride, size_t index, size_t offset) {
+	glm::vec3 result;
+	memcpy(&result, vertices + index * stride + offset, sizeof(glm::vec3));
+	return result;
+}
+
+inline uint64_t EdgeKey(uint32_t a, uint32_t b) {
+	return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+}
+
+// Gets the corner of a triangle that is at the given position, or -1
+inline int FindCorner(const uint32_t* tri, const std::vector<uint32_t>& positionOf, uint32_t position) {
+	for (int ix = 0; ix < 3; ix++) {
+		if (positionOf[tri[ix]] == position) {
+			return ix;
+		}
+	}
+	return -1;
+}
+
+size_t MeshSimplifier::Simplify(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+	const void* vertices, size_t stride, size_t vertexCount, size_t positionOffset, size_t normalOffset,
+	size_t targetIndexCount, float targetError, float* resultError)
+{
+	const uint8_t* vertexData = static_cast<const uint8_t*>(vertices);
+	const size_t triCount = indexCount / 3;
+	double maxCost = 0.0;
+
+	// Weld vertices that share a position, the simplifier works on positions and carries the attributes along. Sorting
+	// (rather than hashing) keeps the numbering the same on every platform
+	std::vector<uint32_t> order(vertexCount);
+	std::iota(order.begin(), order.end(), 0u);
+	std::vector<glm::vec3> vertexPositions(vertexCount);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		vertexPositions[ix] = ReadVertexVec3(vertexData, stride, ix, positionOffset);
+	}
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		const glm::vec3& pa = vertexPositions[a];
+		const glm::vec3& pb = vertexPositions[b];
+		if (pa.x != pb.x) return pa.x < pb.x;
+		if (pa.y != pb.y) return pa.y < pb.y;
+		if (pa.z != pb.z) return pa.z < pb.z;
+		return a < b;
+	});
+	std::vector<uint32_t> positionOf(vertexCount);
+	std::vector<glm::dvec3> positions;
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		if (ix == 0 || vertexPositions[order[ix]] != vertexPositions[order[ix - 1]]) {
+			positions.push_back(glm::dvec3(vertexPositions[order[ix]]));
+		}
+		positionOf[order[ix]] = static_cast<uint32_t>(positions.size() - 1);
+	}
+	const size_t positionCount = positions.size();
+
+	// The average normal at each position, for weighting collapses across creases
+	std::vector<glm::dvec3> normals(positionCount, glm::dvec3(0.0));
+	if (normalOffset != NO_NORMAL) {
+		for (size_t ix = 0; ix < vertexCount; ix++) {
+			normals[positionOf[ix]] += glm::dvec3(ReadVertexVec3(vertexData, stride, ix, normalOffset));
+		}
+		for (glm::dvec3& normal : normals) {
+			const double length = glm::length(normal);
+			normal = length > 0.0 ? normal / length : glm::dvec3(0.0);
+		}
+	}
+
+	// Copy out the triangles we will be working on, dropping any that have no area to begin with
+	std::vector<uint32_t> tris;
+	tris.reserve(triCount * 3);
+	for (size_t tri = 0; tri < triCount; tri++) {
+		const uint32_t* t = indices + tri * 3;
+		const uint32_t a = positionOf[t[0]], b = positionOf[t[1]], c = positionOf[t[2]];
+		if (a != b && b != c && a != c) {
+			tris.insert(tris.end(), t, t + 3);
+		}
+	}
+
+	// Each position starts with the planes of the triangles around it, weighted by their area
+	std::vector<Quadric> quadrics(positionCount);
+	auto triNormal = [&](const uint32_t* t) {
+		return glm::cross(positions[positionOf[t[1]]] - positions[positionOf[t[0]]], positions[positionOf[t[2]]] - positions[positionOf[t[0]]]);
+	};
+	for (size_t ix = 0; ix < tris.size(); ix += 3) {
+		const glm::dvec3 normal = triNormal(&tris[ix]);
+		const double length = glm::length(normal);
+		if (length <= 0.0) {
+			continue;
+		}
+		const glm::dvec3 unit = normal / length;
+		const double d = -glm::dot(unit, positions[positionOf[tris[ix]]]);
+		for (int corner = 0; corner < 3; corner++) {
+			quadrics[positionOf[tris[ix + corner]]].AddPlane(unit, d, length * 0.5);
+		}
+	}
+
+	// Finds the edges (between vertices, not positions) that only have one triangle, these are either borders of the
+	// mesh or attribute seams. The result is sorted as (edge key, triangle) pairs
+	std::vector<std::pair<uint64_t, uint32_t>> edges;
+	auto collectEdges = [&]() {
+		edges.clear();
+		for (size_t ix = 0; ix < tris.size(); ix += 3) {
+			for (int corner = 0; corner < 3; corner++) {
+				edges.emplace_back(EdgeKey(tris[ix + corner], tris[ix + (corner + 1) % 3]), static_cast<uint32_t>(ix / 3));
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+	};
+
+	// Open edges get an extra plane through the edge and perpendicular to their triangle, so that collapses along
+	// them stay on the line of the border
+	collectEdges();
+	for (size_t ix = 0; ix < edges.size(); ix++) {
+		const bool shared = (ix > 0 && edges[ix - 1].first == edges[ix].first) || (ix + 1 < edges.size() && edges[ix + 1].first == edges[ix].first);
+		if (shared) {
+			continue;
+		}
+		const uint32_t a = positionOf[static_cast<uint32_t>(edges[ix].first >> 32)];
+		const uint32_t b = positionOf[static_cast<uint32_t>(edges[ix].first & 0xFFFFFFFFu)];
+		const glm::dvec3 edge = positions[b] - positions[a];
+		const glm::dvec3 normal = glm::cross(edge, triNormal(&tris[edges[ix].second * 3]));
+		const double length = glm::length(normal);
+		if (length <= 0.0) {
+			continue;
+		}
+		const glm::dvec3 unit = normal / length;
+		const double d = -glm::dot(unit, positions[a]);
+		const double weight = glm::dot(edge, edge) * BORDER_WEIGHT;
+		quadrics[a].AddPlane(unit, d, weight);
+		quadrics[b].AddPlane(unit, d, weight);
+	}
+
+	const double errorLimit = static_cast<double>(targetError) * targetError;
+	size_t liveTris = tris.size() / 3;
+
+	std::vector<uint64_t> openEdges;
+	std::vector<uint32_t> openDegree(positionCount);
+	std::vector<uint8_t>  locked(positionCount);
+	std::vector<uint32_t> triStart(positionCount + 1);
+	std::vector<uint32_t> posTris;
+	std::vector<uint64_t> candidateKeys;
+	std::vector<EdgeCollapse> collapses;
+	std::vector<uint8_t>  touched(positionCount);
+	std::vector<uint8_t>  dead;
+	std::vector<std::pair<uint32_t, uint32_t>> wedgeMap;
+	std::vector<uint32_t> ringFrom, ringTo, shared;
+
+	// Each pass finds every collapse that is still allowed, and applies the cheapest ones that do not touch each other
+	while (liveTris * 3 > targetIndexCount) {
+		// Classify positions by the open edges around them. Positions with exactly two open neighbours sit on a single
+		// border or seam and may slide along it, positions where open edges meet or branch are locked in place
+		collectEdges();
+		openEdges.clear();
+		std::fill(locked.begin(), locked.end(), 0);
+		for (size_t ix = 0; ix < edges.size();) {
+			size_t end = ix;
+			while (end < edges.size() && edges[end].first == edges[ix].first) {
+				end++;
+			}
+			const uint32_t a = positionOf[static_cast<uint32_t>(edges[ix].first >> 32)];
+			const uint32_t b = positionOf[static_cast<uint32_t>(edges[ix].first & 0xFFFFFFFFu)];
+			if (end - ix == 1) {
+				openEdges.push_back(EdgeKey(a, b));
+			} else if (end - ix > 2) {
+				// Non-manifold edge, leave it alone
+				locked[a] = locked[b] = 1;
+			}
+			ix = end;
+		}
+		std::sort(openEdges.begin(), openEdges.end());
+		openEdges.erase(std::unique(openEdges.begin(), openEdges.end()), openEdges.end());
+		std::fill(openDegree.begin(), openDegree.end(), 0);
+		for (uint64_t key : openEdges) {
+			openDegree[key >> 32]++;
+			openDegree[key & 0xFFFFFFFFu]++;
+		}
+		for (size_t ix = 0; ix < positionCount; ix++) {
+			if (openDegree[ix] != 0 && openDegree[ix] != 2) {
+				locked[ix] = 1;
+			}
+		}
+		auto isOpen = [&](uint32_t a, uint32_t b) {
+			return std::binary_search(openEdges.begin(), openEdges.end(), EdgeKey(a, b));
+		};
+
+		// The triangles around each position
+		std::fill(triStart.begin(), triStart.end(), 0);
+		for (size_t ix = 0; ix < tris.size(); ix++) {
+			triStart[positionOf[tris[ix]] + 1]++;
+		}
+		for (size_t ix = 0; ix < positionCount; ix++) {
+			triStart[ix + 1] += triStart[ix];
+		}
+		posTris.resize(tris.size());
+		{
+			std::vector<uint32_t> fill(triStart.begin(), triStart.end() - 1);
+			for (size_t ix = 0; ix < tris.size(); ix++) {
+				posTris[fill[positionOf[tris[ix]]]++] = static_cast<uint32_t>(ix / 3);
+			}
+		}
+
+		// Gather every directed edge between positions as a possible collapse
+		candidateKeys.clear();
+		for (size_t ix = 0; ix < tris.size(); ix += 3) {
+			for (int corner = 0; corner < 3; corner++) {
+				const uint64_t a = positionOf[tris[ix + corner]];
+				const uint64_t b = positionOf[tris[ix + (corner + 1) % 3]];
+				candidateKeys.push_back((a << 32) | b);
+				candidateKeys.push_back((b << 32) | a);
+			}
+		}
+		std::sort(candidateKeys.begin(), candidateKeys.end());
+		candidateKeys.erase(std::unique(candidateKeys.begin(), candidateKeys.end()), candidateKeys.end());
+
+		collapses.clear();
+		for (uint64_t key : candidateKeys) {
+			const uint32_t from = static_cast<uint32_t>(key >> 32);
+			const uint32_t to = static_cast<uint32_t>(key & 0xFFFFFFFFu);
+			// Border and seam positions may only move along their border or seam
+			if (locked[from] || (openDegree[from] == 2 && !isOpen(from, to))) {
+				continue;
+			}
+			Quadric combined = quadrics[from];
+			combined.Add(quadrics[to]);
+			const glm::dvec3 delta = positions[to] - positions[from];
+			const double cost = combined.Evaluate(positions[to]) +
+				NORMAL_WEIGHT * (1.0 - glm::dot(normals[from], normals[to])) * glm::dot(delta, delta);
+			if (cost <= errorLimit) {
+				collapses.push_back({ from, to, cost });
+			}
+		}
+		// Candidates are already in key order, so a stable sort keeps ties deterministic
+		std::stable_sort(collapses.begin(), collapses.end(), [](const EdgeCollapse& a, const EdgeCollapse& b) { return a.Cost < b.Cost; });
+
+		std::fill(touched.begin(), touched.end(), 0);
+		dead.assign(tris.size() / 3, 0);
+		size_t applied = 0;
+		for (const EdgeCollapse& collapse : collapses) {
+			if (liveTris * 3 <= targetIndexCount) {
+				break;
+			}
+			const uint32_t from = collapse.From, to = collapse.To;
+			if (touched[from] || touched[to]) {
+				continue;
+			}
+
+			// Each vertex at the position we are removing is replaced with the vertex at the target position that it
+			// shares an edge with. If a vertex has no such partner, or more than one, the collapse would have to
+			// invent new attributes (ex: across a seam), so we skip it
+			wedgeMap.clear();
+			ringFrom.clear();
+			ringTo.clear();
+			shared.clear();
+			bool valid = true;
+			for (uint32_t ix = triStart[from]; ix < triStart[from + 1] && valid; ix++) {
+				const uint32_t* t = &tris[posTris[ix] * 3];
+				const int cornerFrom = FindCorner(t, positionOf, from);
+				const int cornerTo = FindCorner(t, positionOf, to);
+				for (int corner = 0; corner < 3; corner++) {
+					if (corner != cornerFrom) {
+						ringFrom.push_back(positionOf[t[corner]]);
+					}
+				}
+				if (cornerTo < 0) {
+					continue;
+				}
+				shared.push_back(positionOf[t[3 - cornerFrom - cornerTo]]);
+				for (const auto& pair : wedgeMap) {
+					if (pair.first == t[cornerFrom] && pair.second != t[cornerTo]) {
+						valid = false;
+					}
+				}
+				wedgeMap.emplace_back(t[cornerFrom], t[cornerTo]);
+			}
+			if (!valid) {
+				continue;
+			}
+			auto mapped = [&](uint32_t vertex) {
+				for (const auto& pair : wedgeMap) {
+					if (pair.first == vertex) {
+						return pair.second;
+					}
+				}
+				return NO_VERTEX;
+			};
+
+			// The positions next to both ends must be exactly the ones on the triangles being removed, or the
+			// collapse would pinch the surface into a non-manifold fold
+			for (uint32_t ix = triStart[to]; ix < triStart[to + 1]; ix++) {
+				const uint32_t* t = &tris[posTris[ix] * 3];
+				for (int corner = 0; corner < 3; corner++) {
+					if (positionOf[t[corner]] != to) {
+						ringTo.push_back(positionOf[t[corner]]);
+					}
+				}
+			}
+			std::sort(ringFrom.begin(), ringFrom.end());
+			ringFrom.erase(std::unique(ringFrom.begin(), ringFrom.end()), ringFrom.end());
+			std::sort(ringTo.begin(), ringTo.end());
+			ringTo.erase(std::unique(ringTo.begin(), ringTo.end()), ringTo.end());
+			std::sort(shared.begin(), shared.end());
+			shared.erase(std::unique(shared.begin(), shared.end()), shared.end());
+			size_t common = 0;
+			for (size_t a = 0, b = 0; a < ringFrom.size() && b < ringTo.size();) {
+				if (ringFrom[a] < ringTo[b]) a++;
+				else if (ringTo[b] < ringFrom[a]) b++;
+				else { common++; a++; b++; }
+			}
+			if (common != shared.size()) {
+				continue;
+			}
+
+			// Every remaining triangle must keep facing the same way once it's corner has moved
+			for (uint32_t ix = triStart[from]; ix < triStart[from + 1] && valid; ix++) {
+				const uint32_t* t = &tris[posTris[ix] * 3];
+				if (FindCorner(t, positionOf, to) >= 0) {
+					continue;
+				}
+				const int cornerFrom = FindCorner(t, positionOf, from);
+				if (mapped(t[cornerFrom]) == NO_VERTEX) {
+					valid = false;
+					break;
+				}
+				glm::dvec3 corners[3];
+				for (int corner = 0; corner < 3; corner++) {
+					corners[corner] = corner == cornerFrom ? positions[to] : positions[positionOf[t[corner]]];
+				}
+				const glm::dvec3 after = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+				valid = glm::dot(after, triNormal(t)) > 0.0;
+			}
+			if (!valid) {
+				continue;
+			}
+
+			// Apply the collapse, triangles on the edge disappear and the rest have their corner moved
+			for (uint32_t ix = triStart[from]; ix < triStart[from + 1]; ix++) {
+				const uint32_t tri = posTris[ix];
+				uint32_t* t = &tris[tri * 3];
+				if (FindCorner(t, positionOf, to) >= 0) {
+					dead[tri] = 1;
+					liveTris--;
+					continue;
+				}
+				const int cornerFrom = FindCorner(t, positionOf, from);
+				t[cornerFrom] = mapped(t[cornerFrom]);
+			}
+			quadrics[to].Add(quadrics[from]);
+			maxCost = std::max(maxCost, collapse.Cost);
+
+			// Anything around the removed position has changed, so it waits until the next pass
+			touched[from] = touched[to] = 1;
+			for (uint32_t position : ringFrom) {
+				touched[position] = 1;
+			}
+			applied++;
+		}
+
+		// Drop the triangles that collapsed
+		size_t write = 0;
+		for (size_t tri = 0; tri < dead.size(); tri++) {
+			if (!dead[tri]) {
+				memmove(&tris[write * 3], &tris[tri * 3], sizeof(uint32_t) * 3);
+				write++;
+			}
+		}
+		tris.resize(write * 3);
+
+		if (applied == 0) {
+			break;
+		}
+	}
+
+	std::copy(tris.begin(), tris.end(), destination);
+	if (resultError != nullptr) {
+		*resultError = static_cast<float>(std::sqrt(maxCost));
+	}
+	return tris.size();
+}
@@ -0,0 +1,166 @@
+#include "MorphAnimation.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+#include "ObjLoader.h"
+#include "MeshBuilder.h"
+#include "VertexTypes.h"
+#include "Logging.h"
+
+// Encodes a unit vector onto an octahedron, unfolded into the [-1, 1] square
+inline glm::vec2 OctEncode(const glm::vec3& normal) {
+	const glm::vec3 n = normal / (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+	if (n.z >= 0.0f) {
+		return glm::vec2(n.x, n.y);
+	}
+	return glm::vec2(
+		(1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+		(1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+}
+
+// Packs a value from [-1, 1] into a signed byte
+inline uint8_t PackSnorm8(float value) {
+	return static_cast<uint8_t>(static_cast<int8_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 127.0f)));
+}
+
+MorphAnimation::MorphAnimation() :
+	_mesh(nullptr),
+	_frames(nullptr),
+	_frameCount(0),
+	_vertexCount(0),
+	_quantized(false),
+	_deltaScale(1.0f)
+{ }
+
+MorphAnimation::sptr MorphAnimation::LoadFromFiles(const std::vector<std::string>& framePaths, bool quantize) {
+	return PrepareFromFiles(framePaths, quantize)();
+}
+
+std::function<MorphAnimation::sptr()> MorphAnimation::PrepareFromFiles(const std::vector<std::string>& framePaths, bool quantize)
+{
+	if (framePaths.empty()) {
+		throw std::runtime_error("A morph animation needs at least one frame");
+	}
+
+	// The first frame gives us the mesh that all the other frames are applied to
+	std::shared_ptr<MeshBuilder<VertexPosNormTexCol>> mesh = std::make_shared<MeshBuilder<VertexPosNormTexCol>>();
+	std::vector<uint32_t> basePositions;
+	const size_t positionCount = ObjLoader::ParseFile(framePaths[0], *mesh, basePositions);
+	const size_t vertexCount = mesh->GetVertexCount();
+	const size_t frameCount = framePaths.size();
+	const VertexPosNormTexCol* baseVertices = mesh->GetVertexDataPtr();
+
+	std::vector<glm::vec3> offsets(frameCount * vertexCount);
+	std::vector<glm::vec3> normals(frameCount * vertexCount);
+	glm::vec3 boundsMin = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 boundsMax = glm::vec3(-std::numeric_limits<float>::max());
+	float deltaScale = 0.0f;
+
+	// Where each OBJ position is in the current frame, and the sum of the normals of the vertices using it
+	std::vector<glm::vec3> framePositions(positionCount);
+	std::vector<glm::vec3> frameNormals(positionCount);
+	std::vector<uint8_t>   frameUsed(positionCount);
+
+	for (size_t frame = 0; frame < frameCount; frame++) {
+		MeshBuilder<VertexPosNormTexCol> frameMesh;
+		std::vector<uint32_t> frameIndices;
+		const MeshBuilder<VertexPosNormTexCol>* source = mesh.get();
+		const std::vector<uint32_t>* sourceIndices = &basePositions;
+		if (frame > 0) {
+			const size_t framePositionCount = ObjLoader::ParseFile(framePaths[frame], frameMesh, frameIndices);
+			if (framePositionCount != positionCount || frameMesh.GetTriangleCount() != mesh->GetTriangleCount()) {
+				throw std::runtime_error("Frame \"" + framePaths[frame] + "\" does not have the same topology as \"" + framePaths[0] + "\"");
+			}
+			source = &frameMesh;
+			sourceIndices = &frameIndices;
+		}
+
+		// Frames can split their vertices differently (ex: if quads were triangulated differently), but the positions
+		// always line up, so we collect everything by position and then look it up for each of our vertices
+		std::fill(frameNormals.begin(), frameNormals.end(), glm::vec3(0.0f));
+		std::fill(frameUsed.begin(), frameUsed.end(), (uint8_t)0);
+		const VertexPosNormTexCol* vertices = source->GetVertexDataPtr();
+		for (size_t ix = 0; ix < source->GetVertexCount(); ix++) {
+			const uint32_t position = (*sourceIndices)[ix];
+			framePositions[position] = vertices[ix].Position;
+			frameNormals[position] += vertices[ix].Normal;
+			frameUsed[position] = 1;
+		}
+
+		for (size_t ix = 0; ix < vertexCount; ix++) {
+			const uint32_t position = basePositions[ix];
+			if (!frameUsed[position]) {
+				throw std::runtime_error("Frame \"" + framePaths[frame] + "\" does not use all of the positions used by \"" + framePaths[0] + "\"");
+			}
+			const glm::vec3 offset = framePositions[position] - baseVertices[ix].Position;
+			const float normalLength = glm::length(frameNormals[position]);
+			offsets[frame * vertexCount + ix] = offset;
+			normals[frame * vertexCount + ix] = normalLength > 0.0f ? frameNormals[position] / normalLength : baseVertices[ix].Normal;
+
+			boundsMin = glm::min(boundsMin, framePositions[position]);
+			boundsMax = glm::max(boundsMax, framePositions[position]);
+			deltaScale = std::max(deltaScale, std::max(std::abs(offset.x), std::max(std::abs(offset.y), std::abs(offset.z))));
+		}
+	}
+	deltaScale = deltaScale > 0.0f ? deltaScale : 1.0f;
+
+	// Pack the frames into texels, frame by frame so that a vertex's texel is at (frame * vertexCount + vertex)
+	std::shared_ptr<std::vector<uint8_t>> texels = std::make_shared<std::vector<uint8_t>>();
+	if (quantize) {
+		texels->resize(offsets.size() * 4 * sizeof(int16_t));
+		int16_t* data = reinterpret_cast<int16_t*>(texels->data());
+		for (size_t ix = 0; ix < offsets.size(); ix++) {
+			const glm::vec3 scaled = glm::round(offsets[ix] / deltaScale * 32767.0f);
+			const glm::vec2 oct = OctEncode(normals[ix]);
+			data[ix * 4 + 0] = static_cast<int16_t>(scaled.x);
+			data[ix * 4 + 1] = static_cast<int16_t>(scaled.y);
+			data[ix * 4 + 2] = static_cast<int16_t>(scaled.z);
+			data[ix * 4 + 3] = static_cast<int16_t>(PackSnorm8(oct.x) | (PackSnorm8(oct.y) << 8));
+		}
+	} else {
+		texels->resize(offsets.size() * 8 * sizeof(float));
+		float* data = reinterpret_cast<float*>(texels->data());
+		for (size_t ix = 0; ix < offsets.size(); ix++) {
+			memcpy(data + ix * 8, &offsets[ix], sizeof(glm::vec3));
+			data[ix * 8 + 3] = 0.0f;
+			memcpy(data + ix * 8 + 4, &normals[ix], sizeof(glm::vec3));
+			data[ix * 8 + 7] = 0.0f;
+		}
+	}
+
+	const glm::vec3 extents = (boundsMax - boundsMin) * 0.5f;
+	const MeshBounds bounds = MeshBounds(boundsMin, boundsMax, glm::length(extents));
+	const GLenum format = quantize ? GL_RGBA16I : GL_RGBA32I;
+
+	return [mesh, texels, bounds, format, frameCount, vertexCount, quantize, deltaScale]() {
+		MorphAnimation::sptr result = MorphAnimation::Create();
+		result->_mesh = mesh->Bake();
+		// The mesh is only in the pose of the first frame, so we need bounds that cover the whole animation
+		result->_mesh->SetBounds(bounds);
+		result->_frames = TextureBuffer::Create(format);
+		result->_frames->LoadData(texels->data(), texels->size());
+		result->_frameCount = static_cast<uint32_t>(frameCount);
+		result->_vertexCount = static_cast<uint32_t>(vertexCount);
+		result->_quantized = quantize;
+		result->_deltaScale = deltaScale;
+
+		LOG_INFO("Loaded morph animation with {} frames of {} vertices, using {:.1f} KB (vs {:.1f} KB as separate meshes)",
+			frameCount, vertexCount, result->GetGpuMemoryUsage() / 1024.0f, (result->_mesh->GetGpuMemoryUsage() * frameCount) / 1024.0f);
+		return result;
+	};
+}
+
+void MorphAnimation::ApplyTo(const ShaderMaterial::sptr& material) const {
+	material->Set("s_MorphFrames", _frames);
+	material->Set("u_MorphVertexCount", static_cast<int>(_vertexCount));
+	material->Set("u_MorphQuantized", _quantized ? 1 : 0);
+	material->Set("u_MorphDeltaScale", _deltaScale);
+}
+
+size_t MorphAnimation::GetGpuMemoryUsage() const {
+	return (_mesh != nullptr ? _mesh->GetGpuMemoryUsage() : 0) + (_frames != nullptr ? _frames->GetSize() : 0);
+}
@@ -2,23 +2,39 @@
 
 #include <string>
 #include <sstream>
-#include <fstream>
 #include <iostream>
 
 #include "StringUtils.h"
+#include "BakedMesh.h"
 
-VertexArrayObject::sptr NotObjLoader::LoadFromFile(const std::string& filename)
+VertexArrayObject::sptr NotObjLoader::LoadFromFile(const std::string& filename, const MeshBakeSettings& settings)
 {
-	// Open our file in binary mode
-	std::ifstream file;
-	file.open(filename, std::ios::binary);
+	return PrepareFromFile(filename, settings)();
+}
+
+std::function<VertexArrayObject::sptr()> NotObjLoader::PrepareFromFile(const std::string& filename, const MeshBakeSettings& settings)
+{
+	return BakedMesh::PrepareCached<VertexPosNormTexCol>(filename, 0,
+		[](const char* data, size_t size, MeshBuilder<VertexPosNormTexCol>& mesh) {
+			_ParseData(data, size, mesh);
+		}, settings);
+}
+
+void NotObjLoader::ParseFile(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh)
+{
+	MemoryMappedFile file(filename);
 
 	// If our file fails to open, we will throw an error
-	if (!file) {
+	if (!file.IsOpen()) {
 		throw std::runtime_error("Failed to open file");
 	}
 
-	MeshBuilder<VertexPosNormTexCol> mesh;
+	_ParseData(file.GetData(), file.GetSize(), mesh);
+}
+
+void NotObjLoader::_ParseData(const char* data, size_t size, MeshBuilder<VertexPosNormTexCol>& mesh)
+{
+	std::istringstream file(std::string(data, size));
 	std::string line;
 	
 	// Iterate as long as there is content to read
@@ -103,10 +119,12 @@ VertexArrayObject::sptr NotObjLoader::LoadFromFile(const std::string& filename)
 			}
 		}
 	}
+}
 
-	// Note: with actual OBJ files you're going to run into the issue where faces are composited of different indices
-	// You'll need to keep track of these and create vertex entries for each vertex in the face
-	// If you want to get fancy, you can track which vertices you've already added
-
-	return mesh.Bake();
+std::string NotObjLoader::BakeFile(const std::string& filename, const MeshBakeSettings& settings, MeshOptimizeReport* report)
+{
+	return BakedMesh::BakeFile<VertexPosNormTexCol>(filename, 0,
+		[](const char* data, size_t size, MeshBuilder<VertexPosNormTexCol>& mesh) {
+			_ParseData(data, size, mesh);
+		}, settings, report);
 }
@@ -1,129 +1,528 @@
 #include "ObjLoader.h"
 
 #include <string>
-#include <sstream>
-#include <fstream>
-#include <iostream>
-#include <unordered_map>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
 
-#include "StringUtils.h"
+#include "MemoryMappedFile.h"
+#include "BakedMesh.h"
 
-VertexArrayObject::sptr ObjLoader::LoadFromFile(const std::string& filename, const glm::vec4& inColor)
-{	
-	// Open our file in binary mode
-	std::ifstream file;
-	file.open(filename, std::ios::binary);
+// Files smaller than this will not be split up any further, since the cost of spinning up a thread outweighs the parsing
+const size_t MIN_CHUNK_SIZE = 64 * 1024;
 
-	// If our file fails to open, we will throw an error
-	if (!file) {
-		throw std::runtime_error("Failed to open file");
+// Exact powers of ten that fit in a double, used by our float parser
+const double POWERS_OF_TEN[] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#pragma region Scanning Helpers
+
+inline bool IsInlineSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool IsDigit(char c) {
+	return static_cast<unsigned char>(c - '0') < 10;
+}
+
+// Advances past any spaces or tabs on the current line
+inline const char* SkipSpaces(const char* ptr, const char* end) {
+	while (ptr < end && IsInlineSpace(*ptr)) { ptr++; }
+	return ptr;
+}
+
+// Advances to the first character of the next line
+inline const char* SkipLine(const char* ptr, const char* end) {
+	while (ptr < end && *ptr != '\n') { ptr++; }
+	return ptr < end ? ptr + 1 : end;
+}
+
+// Parses a (possibly negative) integer, returning the position after the last digit, or nullptr if no digits were found
+inline const char* ParseInt(const char* ptr, const char* end, int& result) {
+	bool negative = false;
+	if (ptr < end && (*ptr == '-' || *ptr == '+')) {
+		negative = *ptr == '-';
+		ptr++;
+	}
+	if (ptr >= end || !IsDigit(*ptr)) {
+		return nullptr;
+	}
+	int value = 0;
+	while (ptr < end && IsDigit(*ptr)) {
+		value = value * 10 + (*ptr - '0');
+		ptr++;
+	}
+	result = negative ? -value : value;
+	return ptr;
+}
+
+// Parses a decimal floating point number (with optional exponent) without going through the locale or streams,
+// returning the position after the number or nullptr if there was no number to parse
+const char* ParseFloat(const char* ptr, const char* end, float& result) {
+	bool negative = false;
+	if (ptr < end && (*ptr == '-' || *ptr == '+')) {
+		negative = *ptr == '-';
+		ptr++;
 	}
 
-	// Stores attributes
-	std::vector<glm::vec3> positions;
-	std::vector<glm::vec3> normals;
-	std::vector<glm::vec2> textureCoords;
+	// We accumulate up to 19 significant digits into an integer mantissa, and track the decimal exponent separately
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	bool anyDigits = false;
+	while (ptr < end && IsDigit(*ptr)) {
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (*ptr - '0');
+			if (mantissa != 0) { digits++; }
+		} else {
+			exponent++;
+		}
+		anyDigits = true;
+		ptr++;
+	}
+	if (ptr < end && *ptr == '.') {
+		ptr++;
+		while (ptr < end && IsDigit(*ptr)) {
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*ptr - '0');
+				if (mantissa != 0) { digits++; }
+				exponent--;
+			}
+			anyDigits = true;
+			ptr++;
+		}
+	}
+	if (!anyDigits) {
+		return nullptr;
+	}
+	if (ptr < end && (*ptr == 'e' || *ptr == 'E')) {
+		int exp = 0;
+		const char* expEnd = ParseInt(ptr + 1, end, exp);
+		if (expEnd != nullptr) {
+			exponent += exp;
+			ptr = expEnd;
+		}
+	}
 
-	// We'll use bitmask keys and a map to avoid duplicate vertices
-	std::unordered_map<uint64_t, uint32_t> indexMap;
+	// Dividing or multiplying by an exact power of ten gives us a correctly rounded double, which we then narrow
+	double value = static_cast<double>(mantissa);
+	while (exponent < -22) { value /= 1e22; exponent += 22; }
+	while (exponent > 22)  { value *= 1e22; exponent -= 22; }
+	value = exponent < 0 ? value / POWERS_OF_TEN[-exponent] : value * POWERS_OF_TEN[exponent];
 
-	// We'll leverage the mesh builder class
-	MeshBuilder<VertexPosNormTexCol> mesh;
+	result = static_cast<float>(negative ? -value : value);
+	return ptr;
+}
 
-	// Temporaries for loading data
-	glm::vec3 temp;
-	glm::ivec3 vertexIndices;
-	
-	std::string line;
-	// Iterate as long as there is content to read
-	while (file.peek() != EOF) {
-		std::string command;
-		file >> command;
-
-		// Load in vertex positions
-		if (command == "v") {
-			file >> temp.x >> temp.y >> temp.z;
-			positions.push_back(temp);
-		}
-		// Load in vertex normals
-		else if (command == "vn") {
-			file >> temp.x >> temp.y >> temp.z;
-			normals.push_back(temp);
-		}
-		// Load in UV coordinates
-		else if (command == "vt") {
-			file >> temp.x >> temp.y;
-			textureCoords.push_back(temp);
+// Parses up to count floats from the line, leaving any missing components untouched
+inline const char* ParseFloats(const char* ptr, const char* end, float* values, int count) {
+	for (int ix = 0; ix < count; ix++) {
+		ptr = SkipSpaces(ptr, end);
+		const char* next = ParseFloat(ptr, end, values[ix]);
+		if (next == nullptr) {
+			break;
 		}
-		// Load in face lines
-		else if (command == "f") {
-			// Read the entire line, trim it, and stuff it into a string stream
-			std::string line;
-			std::getline(file, line);
-			trim(line);			
-			std::stringstream stream = std::stringstream(line);
-
-			// We'll store the edges in case we added a quad
-			uint32_t edges[4];
-			int ix = 0;
-			// Iterate over up to 4 sets of attributes
-			for (; ix < 4; ix++) {
-				if (stream.peek() != EOF) {
-					// Load in the faces, split up by slashes
-					char tempChar;
-					vertexIndices = glm::ivec3(0);
-					stream >> vertexIndices.x >> tempChar >> vertexIndices.y >> tempChar >> vertexIndices.z;
-					// The OBJ format can have negative values, which are a reference from the last added attributes
-					if (vertexIndices.x < 0) { vertexIndices.x = positions.size() - 1 + vertexIndices.x; }
-					if (vertexIndices.y < 0) { vertexIndices.y = textureCoords.size() - 1 + vertexIndices.y; }
-					if (vertexIndices.z < 0) { vertexIndices.z = normals.size() - 1 + vertexIndices.z; }
-					// We can construct a key using a bitmask of the attribute indices
-					// This let's us quickly look up a combination of attributes to see if it's already been added
-					// Note that this limits us to 2,097,150 unique attributes for positions, normals and textures
-					const uint64_t mask = 0b0'000000000000000000000'000000000000000000000'111111111111111111111;
-					uint64_t key = ((vertexIndices.x & mask) << 42) | ((vertexIndices.y & mask) << 21) | (vertexIndices.z & mask);
-
-					// Find the index associated with the combination of attributes
-					auto it = indexMap.find(key);
-
-					// If it exists, we push the index to our indices
-					if (it != indexMap.end()) {
-						edges[ix] = it->second;
-					}
-					else {
-						// Construct a new vertex using the indices for the vertex
-						VertexPosNormTexCol vertex;
-						vertex.Position = positions[vertexIndices.x - 1];
-						vertex.UV = vertexIndices.y != 0 ? textureCoords[vertexIndices.y - 1] : glm::vec2(0.0f);
-						vertex.Normal = vertexIndices.z != 0 ? normals[vertexIndices.z - 1] : glm::vec3(0.0f, 0.0f, 1.0f);
-						vertex.Color = inColor;
-
-						// Add to the mesh, get index of the added vertex
-						uint32_t index = mesh.AddVertex(vertex);
-						// Cache the index based on our key
-						indexMap[key] = index;
-						// Add index to mesh, and add to edges list for if we are using quads
-						edges[ix] = index;
-					}
-				} else {
-					break;
+		ptr = next;
+	}
+	return ptr;
+}
+
+#pragma endregion
+
+#pragma region Vertex De-duplication
+
+// Hashes a combination of position, texture and normal indices
+inline uint64_t HashCorner(const glm::ivec3& corner) {
+	uint64_t hash = (static_cast<uint64_t>(static_cast<uint32_t>(corner.x)) * 0x9E3779B97F4A7C15ull) ^
+		(static_cast<uint64_t>(static_cast<uint32_t>(corner.y)) * 0xC2B2AE3D27D4EB4Full) ^
+		(static_cast<uint64_t>(static_cast<uint32_t>(corner.z)) * 0x165667B19E3779F9ull);
+	return hash ^ (hash >> 29);
+}
+
+/// <summary>
+/// A small open addressing hash set that maps unique attribute index combinations to their order of first appearance.
+/// The table only stores indices into the list of unique corners, which keeps it compact and cache friendly
+/// </summary>
+class CornerIndexMap
+{
+public:
+	CornerIndexMap(size_t expectedCount) {
+		size_t capacity = 16;
+		while (capacity < expectedCount * 2) { capacity <<= 1; }
+		_slots.assign(capacity, 0);
+		_mask = capacity - 1;
+	}
+
+	/// <summary>
+	/// Finds the index of the given corner in the unique list, appending it if it does not exist yet
+	/// </summary>
+	uint32_t FindOrAdd(const glm::ivec3& corner) {
+		size_t slot = HashCorner(corner) & _mask;
+		while (true) {
+			const uint32_t entry = _slots[slot];
+			if (entry == 0) {
+				Unique.push_back(corner);
+				_slots[slot] = static_cast<uint32_t>(Unique.size());
+				if (Unique.size() * 2 > _slots.size()) {
+					_Grow();
 				}
+				return static_cast<uint32_t>(Unique.size() - 1);
+			}
+			if (Unique[entry - 1] == corner) {
+				return entry - 1;
+			}
+			slot = (slot + 1) & _mask;
+		}
+	}
+
+	// The unique corners, in the order they were first seen
+	std::vector<glm::ivec3> Unique;
+
+private:
+	std::vector<uint32_t> _slots;
+	size_t _mask;
+
+	void _Grow() {
+		std::vector<uint32_t> old;
+		old.swap(_slots);
+		_slots.assign(old.size() * 2, 0);
+		_mask = _slots.size() - 1;
+		for (uint32_t entry : old) {
+			if (entry != 0) {
+				size_t slot = HashCorner(Unique[entry - 1]) & _mask;
+				while (_slots[slot] != 0) { slot = (slot + 1) & _mask; }
+				_slots[slot] = entry;
 			}
-			// Handling for trangle faces
-			if (ix == 3) {
-				mesh.AddIndexTri(edges[0], edges[1], edges[2]);
+		}
+	}
+};
+
+#pragma endregion
+
+/// <summary>
+/// Stores the results of parsing a single line-aligned section of an OBJ file
+/// </summary>
+struct ObjChunk
+{
+	const char* Begin = nullptr;
+	const char* End   = nullptr;
+
+	std::vector<glm::vec3> Positions;
+	std::vector<glm::vec3> Normals;
+	std::vector<glm::vec2> TextureCoords;
+
+	// The position/texture/normal indices (1-based, 0 for missing) of every face corner in the chunk
+	std::vector<glm::ivec3> Corners;
+	// Triangles within the chunk, as indices into Corners
+	std::vector<uint32_t> Triangles;
+	// Corners that used negative (relative) indices, and which components need to be offset once we know where this chunk starts
+	std::vector<std::pair<uint32_t, uint8_t>> RelativeCorners;
+
+	// The number of each attribute declared before this chunk
+	glm::ivec3 AttribOffset = glm::ivec3(0);
+
+	// Maps each corner to the index of it's unique attribute combination within this chunk
+	std::vector<uint32_t> CornerToLocal;
+	// Maps the unique corners within this chunk to vertices in the final mesh
+	std::vector<uint32_t> LocalToGlobal;
+	std::vector<glm::ivec3> LocalUnique;
+};
+
+/// <summary>
+/// Runs func(ix) for ix in [0, count) with each invocation on it's own thread, re-throwing the first exception encountered
+/// </summary>
+template <typename Func>
+void RunParallel(size_t count, const Func& func) {
+	std::vector<std::exception_ptr> errors(count);
+	std::vector<std::thread> threads;
+	threads.reserve(count > 0 ? count - 1 : 0);
+	for (size_t ix = 1; ix < count; ix++) {
+		threads.emplace_back([&, ix]() {
+			try { func(ix); }
+			catch (...) { errors[ix] = std::current_exception(); }
+		});
+	}
+	if (count > 0) {
+		try { func(0); }
+		catch (...) { errors[0] = std::current_exception(); }
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	for (const std::exception_ptr& error : errors) {
+		if (error) { std::rethrow_exception(error); }
+	}
+}
+
+// Parses a single "f" line, with the pointer positioned just after the command
+void ParseFace(const char* ptr, const char* end, ObjChunk& chunk) {
+	const uint32_t firstCorner = static_cast<uint32_t>(chunk.Corners.size());
+	while (true) {
+		ptr = SkipSpaces(ptr, end);
+		if (ptr >= end || *ptr == '\n') {
+			break;
+		}
+
+		// Corners can be in the form v, v/vt, v//vn or v/vt/vn
+		glm::ivec3 corner = glm::ivec3(0);
+		const char* next = ParseInt(ptr, end, corner.x);
+		if (next == nullptr) {
+			break;
+		}
+		ptr = next;
+		if (ptr < end && *ptr == '/') {
+			ptr++;
+			if (ptr < end && *ptr != '/') {
+				next = ParseInt(ptr, end, corner.y);
+				if (next != nullptr) { ptr = next; }
 			}
-			// Handling for quad faces
-			else if (ix == 4) {
-				mesh.AddIndexTri(edges[0], edges[1], edges[2]);
-				mesh.AddIndexTri(edges[0], edges[2], edges[3]);
+			if (ptr < end && *ptr == '/') {
+				ptr++;
+				next = ParseInt(ptr, end, corner.z);
+				if (next != nullptr) { ptr = next; }
 			}
 		}
+
+		// The OBJ format can have negative values, which are a reference from the last added attributes. Since
+		// other chunks may have declared attributes before this one, we resolve them relative to the chunk for now
+		uint8_t relativeMask = 0;
+		if (corner.x < 0) { corner.x += static_cast<int>(chunk.Positions.size()) + 1;     relativeMask |= 0b001; }
+		if (corner.y < 0) { corner.y += static_cast<int>(chunk.TextureCoords.size()) + 1; relativeMask |= 0b010; }
+		if (corner.z < 0) { corner.z += static_cast<int>(chunk.Normals.size()) + 1;       relativeMask |= 0b100; }
+		if (relativeMask != 0) {
+			chunk.RelativeCorners.emplace_back(static_cast<uint32_t>(chunk.Corners.size()), relativeMask);
+		}
+		chunk.Corners.push_back(corner);
 	}
 
-	// Note: with actual OBJ files you're going to run into the issue where faces are composited of different indices
-	// You'll need to keep track of these and create vertex entries for each vertex in the face
-	// If you want to get fancy, you can track which vertices you've already added
+	// Triangulate the face as a fan, which handles both triangles and quads (0-1-2, 0-2-3)
+	const uint32_t cornerCount = static_cast<uint32_t>(chunk.Corners.size()) - firstCorner;
+	for (uint32_t ix = 2; ix < cornerCount; ix++) {
+		chunk.Triangles.push_back(firstCorner);
+		chunk.Triangles.push_back(firstCorner + ix - 1);
+		chunk.Triangles.push_back(firstCorner + ix);
+	}
+}
+
+void ParseChunk(ObjChunk& chunk) {
+	const char* ptr = chunk.Begin;
+	const char* end = chunk.End;
+
+	// A rough guess at how many elements we'll see, assuming ~30 bytes per line
+	const size_t estimate = (end - ptr) / 30;
+	chunk.Positions.reserve(estimate / 4);
+	chunk.Corners.reserve(estimate);
+	chunk.Triangles.reserve(estimate);
+
+	glm::vec3 temp;
+	while (ptr < end) {
+		ptr = SkipSpaces(ptr, end);
+		if (ptr >= end) {
+			break;
+		}
+
+		if (ptr[0] == 'v' && ptr + 1 < end) {
+			// Load in vertex positions
+			if (IsInlineSpace(ptr[1])) {
+				temp = glm::vec3(0.0f);
+				ptr = ParseFloats(ptr + 2, end, &temp.x, 3);
+				chunk.Positions.push_back(temp);
+			}
+			// Load in vertex normals
+			else if (ptr[1] == 'n' && ptr + 2 < end && IsInlineSpace(ptr[2])) {
+				temp = glm::vec3(0.0f);
+				ptr = ParseFloats(ptr + 3, end, &temp.x, 3);
+				chunk.Normals.push_back(temp);
+			}
+			// Load in UV coordinates
+			else if (ptr[1] == 't' && ptr + 2 < end && IsInlineSpace(ptr[2])) {
+				temp = glm::vec3(0.0f);
+				ptr = ParseFloats(ptr + 3, end, &temp.x, 2);
+				chunk.TextureCoords.emplace_back(temp.x, temp.y);
+			}
+		}
+		// Load in face lines
+		else if (ptr[0] == 'f' && ptr + 1 < end && IsInlineSpace(ptr[1])) {
+			ParseFace(ptr + 2, end, chunk);
+		}
+
+		// Anything else (comments, groups, materials, etc...) is ignored
+		ptr = SkipLine(ptr, end);
+	}
+}
+
+void ObjLoader::ParseFile(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec4& inColor)
+{
+	// Map our file into memory, so we can parse it in place
+	MemoryMappedFile file(filename);
+
+	// If our file fails to open, we will throw an error
+	if (!file.IsOpen()) {
+		throw std::runtime_error("Failed to open file");
+	}
+
+	_ParseData(file.GetData(), file.GetSize(), mesh, inColor);
+}
+
+size_t ObjLoader::ParseFile(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh, std::vector<uint32_t>& positionIndices, const glm::vec4& inColor)
+{
+	MemoryMappedFile file(filename);
+	if (!file.IsOpen()) {
+		throw std::runtime_error("Failed to open file");
+	}
+
+	return _ParseData(file.GetData(), file.GetSize(), mesh, inColor, &positionIndices);
+}
+
+size_t ObjLoader::_ParseData(const char* data, size_t size, MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec4& inColor,
+	std::vector<uint32_t>* positionIndices)
+{
+	if (size == 0) {
+		return 0;
+	}
+	const char* dataEnd = data + size;
+
+	// Split the file into line-aligned chunks, one per thread
+	const size_t maxChunks = std::max(1u, std::thread::hardware_concurrency());
+	const size_t chunkCount = std::clamp<size_t>(size / MIN_CHUNK_SIZE, 1, maxChunks);
+	std::vector<ObjChunk> chunks(chunkCount);
+	const char* chunkStart = data;
+	for (size_t ix = 0; ix < chunkCount; ix++) {
+		const char* chunkEnd = ix == chunkCount - 1 ? dataEnd : data + (size * (ix + 1)) / chunkCount;
+		chunkEnd = std::max(chunkEnd, chunkStart);
+		chunkEnd = SkipLine(chunkEnd == data ? chunkEnd : chunkEnd - 1, dataEnd);
+		chunks[ix].Begin = chunkStart;
+		chunks[ix].End   = chunkEnd;
+		chunkStart = chunkEnd;
+	}
+
+	// Pass 1: Parse all the chunks in parallel
+	RunParallel(chunkCount, [&](size_t ix) { ParseChunk(chunks[ix]); });
+
+	// Determine where each chunk's attributes will land in the combined attribute lists
+	glm::ivec3 totals = glm::ivec3(0);
+	for (ObjChunk& chunk : chunks) {
+		chunk.AttribOffset = totals;
+		totals += glm::ivec3(chunk.Positions.size(), chunk.TextureCoords.size(), chunk.Normals.size());
+	}
+
+	// Pass 2: Resolve relative indices and de-duplicate corners within each chunk
+	RunParallel(chunkCount, [&](size_t ix) {
+		ObjChunk& chunk = chunks[ix];
+		for (const auto& [cornerIx, relativeMask] : chunk.RelativeCorners) {
+			glm::ivec3& corner = chunk.Corners[cornerIx];
+			if (relativeMask & 0b001) { corner.x += chunk.AttribOffset.x; }
+			if (relativeMask & 0b010) { corner.y += chunk.AttribOffset.y; }
+			if (relativeMask & 0b100) { corner.z += chunk.AttribOffset.z; }
+		}
+
+		CornerIndexMap localMap(chunk.Corners.size() / 2);
+		chunk.CornerToLocal.resize(chunk.Corners.size());
+		for (size_t c = 0; c < chunk.Corners.size(); c++) {
+			const glm::ivec3& corner = chunk.Corners[c];
+			if (corner.x <= 0 || corner.x > totals.x || corner.y < 0 || corner.y > totals.y || corner.z < 0 || corner.z > totals.z) {
+				throw std::runtime_error("Face references an attribute that does not exist");
+			}
+			chunk.CornerToLocal[c] = localMap.FindOrAdd(corner);
+		}
+		chunk.LocalUnique.swap(localMap.Unique);
+	});
+
+	// Merge the unique corners in file order, so vertices appear in the same order as a sequential parse would produce
+	size_t uniqueEstimate = 0;
+	for (const ObjChunk& chunk : chunks) {
+		uniqueEstimate += chunk.LocalUnique.size();
+	}
+	CornerIndexMap globalMap(uniqueEstimate);
+	for (ObjChunk& chunk : chunks) {
+		chunk.LocalToGlobal.resize(chunk.LocalUnique.size());
+		for (size_t ix = 0; ix < chunk.LocalUnique.size(); ix++) {
+			chunk.LocalToGlobal[ix] = globalMap.FindOrAdd(chunk.LocalUnique[ix]);
+		}
+	}
+
+	// Gather the attributes from all the chunks into contiguous lists
+	std::vector<glm::vec3> positions(totals.x);
+	std::vector<glm::vec2> textureCoords(totals.y);
+	std::vector<glm::vec3> normals(totals.z);
+	RunParallel(chunkCount, [&](size_t ix) {
+		const ObjChunk& chunk = chunks[ix];
+		std::copy(chunk.Positions.begin(), chunk.Positions.end(), positions.begin() + chunk.AttribOffset.x);
+		std::copy(chunk.TextureCoords.begin(), chunk.TextureCoords.end(), textureCoords.begin() + chunk.AttribOffset.y);
+		std::copy(chunk.Normals.begin(), chunk.Normals.end(), normals.begin() + chunk.AttribOffset.z);
+	});
+
+	// Pass 3: Build our vertices and indices directly in the mesh builder's storage
+	const uint32_t baseVertex = static_cast<uint32_t>(mesh._vertices.size());
+	const size_t baseIndex = mesh._indices.size();
+	const std::vector<glm::ivec3>& unique = globalMap.Unique;
+	mesh._vertices.resize(baseVertex + unique.size());
+	if (positionIndices != nullptr) {
+		positionIndices->resize(baseVertex + unique.size());
+	}
+
+	std::vector<size_t> indexOffsets(chunkCount);
+	size_t indexCount = baseIndex;
+	for (size_t ix = 0; ix < chunkCount; ix++) {
+		indexOffsets[ix] = indexCount;
+		indexCount += chunks[ix].Triangles.size();
+	}
+	mesh._indices.resize(indexCount);
+
+	RunParallel(chunkCount, [&](size_t ix) {
+		// Each thread builds an even share of the vertices
+		const size_t vertBegin = (unique.size() * ix) / chunkCount;
+		const size_t vertEnd   = (unique.size() * (ix + 1)) / chunkCount;
+		for (size_t v = vertBegin; v < vertEnd; v++) {
+			const glm::ivec3& corner = unique[v];
+			VertexPosNormTexCol& vertex = mesh._vertices[baseVertex + v];
+			vertex.Position = positions[corner.x - 1];
+			vertex.UV = corner.y != 0 ? textureCoords[corner.y - 1] : glm::vec2(0.0f);
+			vertex.Normal = corner.z != 0 ? normals[corner.z - 1] : glm::vec3(0.0f, 0.0f, 1.0f);
+			vertex.Color = inColor;
+			if (positionIndices != nullptr) {
+				(*positionIndices)[baseVertex + v] = corner.x - 1;
+			}
+		}
+
+		// And remaps the triangles from it's own chunk
+		const ObjChunk& chunk = chunks[ix];
+		uint32_t* indices = mesh._indices.data() + indexOffsets[ix];
+		for (size_t t = 0; t < chunk.Triangles.size(); t++) {
+			indices[t] = baseVertex + chunk.LocalToGlobal[chunk.CornerToLocal[chunk.Triangles[t]]];
+		}
+	});
+
+	return static_cast<size_t>(totals.x);
+}
+
+// The color is baked into the vertices, so it needs to be part of the cache key for baked meshes
+inline uint64_t HashOptions(const glm::vec4& inColor) {
+	return BakedMesh::Hash(&inColor, sizeof(glm::vec4));
+}
+
+VertexArrayObject::sptr ObjLoader::LoadFromFile(const std::string& filename, const glm::vec4& inColor, const MeshBakeSettings& settings)
+{
+	return PrepareFromFile(filename, inColor, settings)();
+}
+
+std::function<VertexArrayObject::sptr()> ObjLoader::PrepareFromFile(const std::string& filename, const glm::vec4& inColor, const MeshBakeSettings& settings)
+{
+	return BakedMesh::PrepareCached<VertexPosNormTexCol>(filename, HashOptions(inColor),
+		[&](const char* data, size_t size, MeshBuilder<VertexPosNormTexCol>& mesh) {
+			_ParseData(data, size, mesh, inColor);
+		}, settings);
+}
 
-	return mesh.Bake();
+std::string ObjLoader::BakeFile(const std::string& filename, const glm::vec4& inColor, const MeshBakeSettings& settings, MeshOptimizeReport* report)
+{
+	return BakedMesh::BakeFile<VertexPosNormTexCol>(filename, HashOptions(inColor),
+		[&](const char* data, size_t size, MeshBuilder<VertexPosNormTexCol>& mesh) {
+			_ParseData(data, size, mesh, inColor);
+		}, settings, report);
 }
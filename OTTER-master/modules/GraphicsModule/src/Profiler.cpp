@@ -0,0 +1,366 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include <glad/glad.h>
+#include <json.hpp>
+
+#include "Logging.h"
+
+/// <summary>
+/// The zones recorded by one thread, as a single producer single consumer ring buffer. The owning thread is the
+/// only one that moves the head, and EndFrame is the only one that moves the tail
+/// </summary>
+struct ProfilerThreadBuffer
+{
+	std::unique_ptr<ProfileZone[]> Zones;
+	std::atomic<uint64_t>          Head;
+	std::atomic<uint64_t>          Tail;
+	std::atomic<uint64_t>          Dropped;
+	uint32_t                       Index;
+	std::string                    Name;
+
+	ProfilerThreadBuffer(uint32_t index) :
+		Zones(new ProfileZone[Profiler::THREAD_BUFFER_SIZE]), Head(0), Tail(0), Dropped(0), Index(index),
+		Name("Thread " + std::to_string(index)) { }
+};
+
+/// <summary>
+/// A pair of timestamp queries around a GPU zone, waiting for their results
+/// </summary>
+struct GpuPendingZone
+{
+	const char* Name;
+	GLuint      StartQuery;
+	GLuint      EndQuery;
+	uint32_t    Depth;
+};
+
+/// <summary>
+/// The GPU zones that were issued in one frame
+/// </summary>
+struct GpuFrameSlot
+{
+	uint64_t                    Frame = 0;
+	std::vector<GpuPendingZone> Zones;
+};
+
+bool                     Profiler::_paused = false;
+std::deque<ProfileFrame> Profiler::_frames;
+
+// Thread buffers are never freed, so that a zone recorded as a thread exits is still safe to collect. A buffer is
+// only made for threads that record a zone, which is the main thread and the job system's workers
+static std::mutex                                         threadsMutex;
+static std::vector<std::unique_ptr<ProfilerThreadBuffer>> threads;
+static thread_local ProfilerThreadBuffer*                 currentThread = nullptr;
+static thread_local uint32_t                              currentDepth = 0;
+
+static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+static ProfileFrame currentFrame;
+static uint64_t     frameCount = 0;
+static uint64_t     lastFrameStart = 0;
+
+// GPU queries are recycled, since creating them every frame is surprisingly slow on some drivers
+static GpuFrameSlot        gpuSlots[Profiler::GPU_FRAMES_IN_FLIGHT];
+static std::vector<GLuint> gpuFreeQueries;
+static std::vector<GLuint> gpuAllQueries;
+static uint32_t            gpuDepth = 0;
+static bool                gpuUsed = false;
+static int64_t             gpuClockOffset = 0;
+
+static ProfilerThreadBuffer* GetThreadBuffer() {
+	if (currentThread == nullptr) {
+		std::lock_guard<std::mutex> lock(threadsMutex);
+		threads.push_back(std::make_unique<ProfilerThreadBuffer>(static_cast<uint32_t>(threads.size())));
+		currentThread = threads.back().get();
+	}
+	return currentThread;
+}
+
+static GLuint AcquireQuery() {
+	if (gpuFreeQueries.empty()) {
+		GLuint queries[16];
+		glCreateQueries(GL_TIMESTAMP, 16, queries);
+		gpuFreeQueries.insert(gpuFreeQueries.end(), queries, queries + 16);
+		gpuAllQueries.insert(gpuAllQueries.end(), queries, queries + 16);
+	}
+	const GLuint result = gpuFreeQueries.back();
+	gpuFreeQueries.pop_back();
+	return result;
+}
+
+/// <summary>
+/// Reads back the GPU zones in a slot, adding them to their frame if it is still in the history
+/// </summary>
+static void ResolveGpuSlot(GpuFrameSlot& slot, std::deque<ProfileFrame>& frames) {
+	if (slot.Zones.empty()) {
+		return;
+	}
+
+	ProfileFrame* target = nullptr;
+	for (auto it = frames.rbegin(); it != frames.rend(); it++) {
+		if (it->Index == slot.Frame) {
+			target = &*it;
+			break;
+		}
+	}
+
+	for (const GpuPendingZone& pending : slot.Zones) {
+		// A zone that was never closed (ex: an exception skipped the end of the scope) has nothing to read
+		if (target != nullptr && pending.EndQuery != 0) {
+			// These are GPU_FRAMES_IN_FLIGHT frames old, so they are almost always ready and this won't wait
+			GLuint64 start = 0, end = 0;
+			glGetQueryObjectui64v(pending.StartQuery, GL_QUERY_RESULT, &start);
+			glGetQueryObjectui64v(pending.EndQuery, GL_QUERY_RESULT, &end);
+
+			ProfileZone& zone = target->GpuZones.emplace_back();
+			zone.Name = pending.Name;
+			zone.Start = static_cast<uint64_t>(std::max<int64_t>(static_cast<int64_t>(start) + gpuClockOffset, 0));
+			zone.End = std::max(zone.Start, static_cast<uint64_t>(std::max<int64_t>(static_cast<int64_t>(end) + gpuClockOffset, 0)));
+			zone.Thread = Profiler::GPU_THREAD;
+			zone.Depth = pending.Depth;
+		}
+		gpuFreeQueries.push_back(pending.StartQuery);
+		if (pending.EndQuery != 0) {
+			gpuFreeQueries.push_back(pending.EndQuery);
+		}
+	}
+	if (target != nullptr) {
+		target->HasGpuZones = true;
+	}
+	slot.Zones.clear();
+}
+
+double ProfileFrame::GetGpuMs() const {
+	uint64_t total = 0;
+	for (const ProfileZone& zone : GpuZones) {
+		if (zone.Depth == 0) {
+			total += zone.End - zone.Start;
+		}
+	}
+	return total / 1000000.0;
+}
+
+uint64_t Profiler::Now() {
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+void Profiler::BeginFrame() {
+	currentFrame = ProfileFrame();
+	currentFrame.Index = frameCount;
+	currentFrame.Start = Now();
+	currentFrame.Interval = frameCount > 0 ? currentFrame.Start - lastFrameStart : 0;
+	lastFrameStart = currentFrame.Start;
+
+	if (gpuUsed) {
+		// We re-sync the GPU's clock with ours every frame, so that the two don't drift apart over a long session.
+		// GL_TIMESTAMP gives the time that the GPU reaches this point in the command stream, without waiting for it
+		GLint64 gpuNow = 0;
+		glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+		gpuClockOffset = static_cast<int64_t>(Now()) - gpuNow;
+
+		// The slot we're about to use holds the zones from GPU_FRAMES_IN_FLIGHT frames ago
+		GpuFrameSlot& slot = gpuSlots[frameCount % GPU_FRAMES_IN_FLIGHT];
+		ResolveGpuSlot(slot, _frames);
+		slot.Frame = frameCount;
+	}
+}
+
+void Profiler::EndFrame() {
+	currentFrame.End = Now();
+
+	{
+		std::lock_guard<std::mutex> lock(threadsMutex);
+		for (const std::unique_ptr<ProfilerThreadBuffer>& buffer : threads) {
+			const uint64_t head = buffer->Head.load(std::memory_order_acquire);
+			uint64_t tail = buffer->Tail.load(std::memory_order_relaxed);
+			for (; tail < head; tail++) {
+				currentFrame.CpuZones.push_back(buffer->Zones[tail % THREAD_BUFFER_SIZE]);
+			}
+			buffer->Tail.store(tail, std::memory_order_release);
+		}
+	}
+
+	if (!_paused) {
+		_frames.push_back(std::move(currentFrame));
+		while (_frames.size() > HISTORY_SIZE) {
+			_frames.pop_front();
+		}
+	}
+	frameCount++;
+}
+
+void Profiler::SetThreadName(const std::string& name) {
+	ProfilerThreadBuffer* buffer = GetThreadBuffer();
+	std::lock_guard<std::mutex> lock(threadsMutex);
+	buffer->Name = name;
+}
+
+std::vector<std::string> Profiler::GetThreadNames() {
+	std::lock_guard<std::mutex> lock(threadsMutex);
+	std::vector<std::string> result;
+	result.reserve(threads.size());
+	for (const std::unique_ptr<ProfilerThreadBuffer>& buffer : threads) {
+		result.push_back(buffer->Name);
+	}
+	return result;
+}
+
+uint64_t Profiler::GetDroppedZones() {
+	std::lock_guard<std::mutex> lock(threadsMutex);
+	uint64_t result = 0;
+	for (const std::unique_ptr<ProfilerThreadBuffer>& buffer : threads) {
+		result += buffer->Dropped.load(std::memory_order_relaxed);
+	}
+	return result;
+}
+
+void Profiler::Reset() {
+	_frames.clear();
+	for (GpuFrameSlot& slot : gpuSlots) {
+		slot.Zones.clear();
+	}
+	if (!gpuAllQueries.empty()) {
+		glDeleteQueries(static_cast<GLsizei>(gpuAllQueries.size()), gpuAllQueries.data());
+	}
+	gpuAllQueries.clear();
+	gpuFreeQueries.clear();
+	gpuDepth = 0;
+	gpuUsed = false;
+}
+
+void Profiler::RecordCpuZone(const char* name, uint64_t start, uint64_t end, uint32_t depth) {
+	ProfilerThreadBuffer* buffer = GetThreadBuffer();
+	const uint64_t head = buffer->Head.load(std::memory_order_relaxed);
+	if (head - buffer->Tail.load(std::memory_order_acquire) >= THREAD_BUFFER_SIZE) {
+		buffer->Dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	ProfileZone& zone = buffer->Zones[head % THREAD_BUFFER_SIZE];
+	zone.Name = name;
+	zone.Start = start;
+	zone.End = end;
+	zone.Thread = buffer->Index;
+	zone.Depth = depth;
+	buffer->Head.store(head + 1, std::memory_order_release);
+}
+
+uint32_t Profiler::PushCpuDepth() {
+	return currentDepth++;
+}
+
+void Profiler::PopCpuDepth() {
+	currentDepth--;
+}
+
+uint32_t Profiler::BeginGpuZone(const char* name) {
+	if (!gpuUsed) {
+		gpuUsed = true;
+		GLint64 gpuNow = 0;
+		glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+		gpuClockOffset = static_cast<int64_t>(Now()) - gpuNow;
+		gpuSlots[frameCount % GPU_FRAMES_IN_FLIGHT].Frame = frameCount;
+	}
+
+	GpuFrameSlot& slot = gpuSlots[frameCount % GPU_FRAMES_IN_FLIGHT];
+	GpuPendingZone& zone = slot.Zones.emplace_back();
+	zone.Name = name;
+	zone.StartQuery = AcquireQuery();
+	zone.EndQuery = 0;
+	zone.Depth = gpuDepth++;
+	glQueryCounter(zone.StartQuery, GL_TIMESTAMP);
+	return static_cast<uint32_t>(slot.Zones.size() - 1);
+}
+
+void Profiler::EndGpuZone(uint32_t zone) {
+	GpuFrameSlot& slot = gpuSlots[frameCount % GPU_FRAMES_IN_FLIGHT];
+	gpuDepth--;
+	// If the frame ended (or the profiler was reset) inside of the zone, there's nothing sensible to time
+	if (zone >= slot.Zones.size() || slot.Zones[zone].EndQuery != 0) {
+		return;
+	}
+	slot.Zones[zone].EndQuery = AcquireQuery();
+	glQueryCounter(slot.Zones[zone].EndQuery, GL_TIMESTAMP);
+}
+
+void Profiler::ExportChromeTrace(const std::string& path) {
+	// Chrome wants times in microseconds, and every event on a track with a thread ID. We put the frames on a track
+	// of their own above the threads, and the GPU below them
+	const std::vector<std::string> names = GetThreadNames();
+	const int framesTrack = 0;
+	const int gpuTrack = static_cast<int>(names.size()) + 1;
+
+	// The track names go through json.hpp, which takes care of escaping them
+	nlohmann::json metadata = nlohmann::json::array();
+	auto addTrack = [&](int track, const std::string& name) {
+		metadata.push_back({ { "name", "thread_name" }, { "ph", "M" }, { "pid", 1 }, { "tid", track }, { "args", { { "name", name } } } });
+		metadata.push_back({ { "name", "thread_sort_index" }, { "ph", "M" }, { "pid", 1 }, { "tid", track }, { "args", { { "sort_index", track } } } });
+	};
+	metadata.push_back({ { "name", "process_name" }, { "ph", "M" }, { "pid", 1 }, { "args", { { "name", "OTTER" } } } });
+	addTrack(framesTrack, "Frames");
+	for (size_t ix = 0; ix < names.size(); ix++) {
+		addTrack(static_cast<int>(ix) + 1, names[ix]);
+	}
+	addTrack(gpuTrack, "GPU");
+
+	// Like with baked assets, we write to a temporary file first so that nothing ever reads a half-written trace
+	const std::string tempPath = path + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::trunc);
+		if (!file) {
+			throw std::runtime_error("Failed to open " + tempPath + " for writing");
+		}
+
+		// A full history can hold close to a million zones, which is far too many to build into a json object first,
+		// so the zones are streamed out directly. Zone names are string literals, so we only escape each one once
+		std::unordered_map<const char*, std::string> escaped;
+		char line[128];
+		auto writeZone = [&](const std::string& name, uint64_t start, uint64_t end, int track) {
+			snprintf(line, sizeof(line), ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", track, start / 1000.0, (end - start) / 1000.0);
+			file << ",\n{\"name\":" << name << line;
+		};
+		auto escape = [&](const char* name) -> const std::string& {
+			auto it = escaped.find(name);
+			if (it == escaped.end()) {
+				it = escaped.emplace(name, nlohmann::json(name).dump()).first;
+			}
+			return it->second;
+		};
+
+		const std::string header = metadata.dump();
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":" << header.substr(0, header.size() - 1);
+		for (const ProfileFrame& frame : _frames) {
+			writeZone("\"Frame " + std::to_string(frame.Index) + "\"", frame.Start, frame.End, framesTrack);
+			for (const ProfileZone& zone : frame.CpuZones) {
+				writeZone(escape(zone.Name), zone.Start, zone.End, static_cast<int>(zone.Thread) + 1);
+			}
+			for (const ProfileZone& zone : frame.GpuZones) {
+				writeZone(escape(zone.Name), zone.Start, zone.End, gpuTrack);
+			}
+		}
+		file << "\n]}\n";
+		if (!file) {
+			throw std::runtime_error("Failed to write trace " + tempPath);
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, path, error);
+	if (error) {
+		std::filesystem::remove(tempPath, error);
+		throw std::runtime_error("Failed to replace trace " + path);
+	}
+	LOG_INFO("Exported {} frames of profiling to {}", _frames.size(), path);
+}
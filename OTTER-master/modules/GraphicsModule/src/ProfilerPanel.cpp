@@ -0,0 +1,240 @@
+#include "ProfilerPanel.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <imgui.h>
+
+#include "Profiler.h"
+#include "JobSystem.h"
+#include "Logging.h"
+
+std::string ProfilerPanel::_exportPath = "profile.json";
+int         ProfilerPanel::_selectedFrame = 0;
+
+static const float TIMELINE_LABEL_WIDTH = 90.0f;
+static const float TIMELINE_ROW_HEIGHT = 18.0f;
+static const size_t TOP_ZONE_COUNT = 12;
+// How often the job system's usage is sampled, so the numbers are recent but still readable
+static const double JOB_STATS_INTERVAL = 1.0;
+
+static std::vector<JobSystem::ThreadStats> jobStats;
+static std::chrono::steady_clock::time_point jobStatsTime;
+
+/// <summary>
+/// Picks a color for a zone from it's name, so the same zone is always the same color
+/// </summary>
+static ImU32 GetZoneColor(const char* name) {
+	uint32_t hash = 2166136261u;
+	for (const char* c = name; *c != '\0'; c++) {
+		hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+	}
+	float r, g, b;
+	ImGui::ColorConvertHSVtoRGB((hash % 360) / 360.0f, 0.45f, 0.85f, r, g, b);
+	return ImGui::GetColorU32(ImVec4(r, g, b, 1.0f));
+}
+
+/// <summary>
+/// Draws one row of the timeline per nesting level, for the zones on one thread (or the GPU)
+/// </summary>
+static void DrawTimelineTrack(const char* label, const std::vector<const ProfileZone*>& zones, uint64_t start, uint64_t end) {
+	uint32_t depth = 0;
+	for (const ProfileZone* zone : zones) {
+		depth = std::max(depth, zone->Depth + 1);
+	}
+	if (depth == 0) {
+		return;
+	}
+
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	const ImVec2 origin = ImGui::GetCursorScreenPos();
+	const float width = std::max(ImGui::GetContentRegionAvail().x - TIMELINE_LABEL_WIDTH, 1.0f);
+	const float height = depth * TIMELINE_ROW_HEIGHT;
+	const float scale = width / std::max<float>(static_cast<float>(end - start), 1.0f);
+	const ImU32 textColor = ImGui::GetColorU32(ImGuiCol_Text);
+
+	drawList->AddText(origin, textColor, label);
+	drawList->AddRectFilled(ImVec2(origin.x + TIMELINE_LABEL_WIDTH, origin.y), ImVec2(origin.x + TIMELINE_LABEL_WIDTH + width, origin.y + height),
+		ImGui::GetColorU32(ImGuiCol_FrameBg));
+
+	for (const ProfileZone* zone : zones) {
+		// Zones on worker threads can start before the frame does, so we clip them to the frame
+		const uint64_t zoneStart = std::clamp(zone->Start, start, end);
+		const uint64_t zoneEnd = std::clamp(zone->End, start, end);
+		const float x0 = origin.x + TIMELINE_LABEL_WIDTH + (zoneStart - start) * scale;
+		const float x1 = std::max(origin.x + TIMELINE_LABEL_WIDTH + (zoneEnd - start) * scale, x0 + 1.0f);
+		const float y0 = origin.y + zone->Depth * TIMELINE_ROW_HEIGHT;
+		const float y1 = y0 + TIMELINE_ROW_HEIGHT - 1.0f;
+
+		drawList->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), GetZoneColor(zone->Name));
+		if (x1 - x0 > 8.0f) {
+			drawList->PushClipRect(ImVec2(x0, y0), ImVec2(x1, y1), true);
+			drawList->AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), IM_COL32(0, 0, 0, 255), zone->Name);
+			drawList->PopClipRect();
+		}
+		if (ImGui::IsMouseHoveringRect(ImVec2(x0, y0), ImVec2(x1, y1))) {
+			ImGui::SetTooltip("%s\n%.3f ms (starts at %.3f ms)", zone->Name, zone->GetMs(), (zone->Start - (double)start) / 1000000.0);
+		}
+	}
+
+	ImGui::Dummy(ImVec2(TIMELINE_LABEL_WIDTH + width, height + 2.0f));
+}
+
+void ProfilerPanel::Render() {
+	const std::deque<ProfileFrame>& frames = Profiler::GetFrames();
+	if (frames.empty()) {
+		ImGui::Text("No frames profiled yet");
+		return;
+	}
+
+	// The frame times come from the time between frames starting, rather than Timing::DeltaTime, since that is
+	// clamped and doesn't include time outside of our frame (like waiting on vsync)
+	std::vector<float> frameMs;
+	frameMs.reserve(frames.size());
+	float minMs = FLT_MAX, maxMs = 0.0f, totalMs = 0.0f;
+	double gpuTotalMs = 0.0;
+	int gpuFrames = 0;
+	for (const ProfileFrame& frame : frames) {
+		if (frame.Interval > 0) {
+			const float ms = static_cast<float>(frame.GetIntervalMs());
+			frameMs.push_back(ms);
+			minMs = std::min(minMs, ms);
+			maxMs = std::max(maxMs, ms);
+			totalMs += ms;
+		}
+		if (frame.HasGpuZones) {
+			gpuTotalMs += frame.GetGpuMs();
+			gpuFrames++;
+		}
+	}
+	if (!frameMs.empty()) {
+		const float avgMs = totalMs / frameMs.size();
+		ImGui::PlotLines("Frame (ms)", frameMs.data(), static_cast<int>(frameMs.size()), 0, nullptr, 0.0f, maxMs * 1.1f, ImVec2(0.0f, 60.0f));
+		ImGui::Text("Frame: %.2f ms avg (%.1f FPS), min %.2f ms, max %.2f ms", avgMs, 1000.0f / avgMs, minMs, maxMs);
+	}
+	if (gpuFrames > 0) {
+		ImGui::Text("GPU: %.2f ms avg", gpuTotalMs / gpuFrames);
+	}
+
+	bool paused = Profiler::IsPaused();
+	if (ImGui::Checkbox("Pause", &paused)) {
+		Profiler::SetPaused(paused);
+		_selectedFrame = static_cast<int>(frames.size()) - 1;
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Export trace")) {
+		try {
+			Profiler::ExportChromeTrace(_exportPath);
+		} catch (const std::exception& e) {
+			LOG_WARN("Failed to export profiler trace: {}", e.what());
+		}
+	}
+	const uint64_t dropped = Profiler::GetDroppedZones();
+	if (dropped > 0) {
+		ImGui::SameLine();
+		ImGui::Text("(%d zones dropped)", (int)dropped);
+	}
+
+	// While running we show the newest frame that has it's GPU zones, which lag a few frames behind
+	size_t frameIx = frames.size() - 1;
+	if (paused) {
+		ImGui::SliderInt("Frame", &_selectedFrame, 0, static_cast<int>(frames.size()) - 1);
+		frameIx = static_cast<size_t>(std::clamp(_selectedFrame, 0, static_cast<int>(frames.size()) - 1));
+	} else {
+		for (size_t back = 0; back <= Profiler::GPU_FRAMES_IN_FLIGHT && back < frames.size(); back++) {
+			if (frames[frames.size() - 1 - back].HasGpuZones) {
+				frameIx = frames.size() - 1 - back;
+				break;
+			}
+		}
+	}
+	const ProfileFrame& frame = frames[frameIx];
+	ImGui::Text("Frame %d: %.3f ms CPU, %.3f ms GPU", (int)frame.Index, frame.GetCpuMs(), frame.GetGpuMs());
+
+	// GPU work usually finishes after the CPU is done with the frame, so we stretch the timeline to fit it
+	uint64_t end = frame.End;
+	for (const ProfileZone& zone : frame.GpuZones) {
+		end = std::max(end, zone.End);
+	}
+
+	const std::vector<std::string> threadNames = Profiler::GetThreadNames();
+	std::vector<std::vector<const ProfileZone*>> tracks(threadNames.size());
+	for (const ProfileZone& zone : frame.CpuZones) {
+		if (zone.Thread < tracks.size()) {
+			tracks[zone.Thread].push_back(&zone);
+		}
+	}
+	for (size_t ix = 0; ix < tracks.size(); ix++) {
+		DrawTimelineTrack(threadNames[ix].c_str(), tracks[ix], frame.Start, end);
+	}
+	std::vector<const ProfileZone*> gpuZones;
+	for (const ProfileZone& zone : frame.GpuZones) {
+		gpuZones.push_back(&zone);
+	}
+	DrawTimelineTrack("GPU", gpuZones, frame.Start, end);
+
+	// Zones with the same name (ex: a task that runs on several workers) are added together
+	struct ZoneTotal
+	{
+		const char* Name;
+		bool        Gpu;
+		double      Ms;
+		int         Count;
+	};
+	std::unordered_map<std::string, ZoneTotal> totals;
+	auto addTotal = [&](const ProfileZone& zone, bool gpu) {
+		ZoneTotal& total = totals.try_emplace((gpu ? "GPU/" : "CPU/") + std::string(zone.Name), ZoneTotal{ zone.Name, gpu, 0.0, 0 }).first->second;
+		total.Ms += zone.GetMs();
+		total.Count++;
+	};
+	for (const ProfileZone& zone : frame.CpuZones) {
+		addTotal(zone, false);
+	}
+	for (const ProfileZone& zone : frame.GpuZones) {
+		addTotal(zone, true);
+	}
+	std::vector<ZoneTotal> sorted;
+	sorted.reserve(totals.size());
+	for (const auto& [key, total] : totals) {
+		sorted.push_back(total);
+	}
+	std::sort(sorted.begin(), sorted.end(), [](const ZoneTotal& a, const ZoneTotal& b) { return a.Ms > b.Ms; });
+
+	ImGui::Columns(4, "ProfilerZones");
+	ImGui::Text("Zone"); ImGui::NextColumn();
+	ImGui::Text("Where"); ImGui::NextColumn();
+	ImGui::Text("Total (ms)"); ImGui::NextColumn();
+	ImGui::Text("Count"); ImGui::NextColumn();
+	ImGui::Separator();
+	for (size_t ix = 0; ix < sorted.size() && ix < TOP_ZONE_COUNT; ix++) {
+		ImGui::Text("%s", sorted[ix].Name); ImGui::NextColumn();
+		ImGui::Text("%s", sorted[ix].Gpu ? "GPU" : "CPU"); ImGui::NextColumn();
+		ImGui::Text("%.3f", sorted[ix].Ms); ImGui::NextColumn();
+		ImGui::Text("%d", sorted[ix].Count); ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+
+	// Job system usage over the last interval, one bar per thread
+	if (JobSystem::IsRunning()) {
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (jobStats.empty() || std::chrono::duration<double>(now - jobStatsTime).count() >= JOB_STATS_INTERVAL) {
+			jobStats = JobSystem::GetStats();
+			JobSystem::ResetStats();
+			jobStatsTime = now;
+		}
+		ImGui::Separator();
+		ImGui::Text("Jobs (%d workers)", (int)JobSystem::GetWorkerCount());
+		for (const JobSystem::ThreadStats& stats : jobStats) {
+			char overlay[64];
+			snprintf(overlay, sizeof(overlay), "%.0f%% (%d jobs, %d stolen)", stats.Utilization * 100.0f, (int)stats.JobsRun, (int)stats.Steals);
+			ImGui::ProgressBar(stats.Utilization, ImVec2(-TIMELINE_LABEL_WIDTH, 0.0f), overlay);
+			ImGui::SameLine();
+			ImGui::Text("%s", stats.Name.c_str());
+		}
+	}
+}
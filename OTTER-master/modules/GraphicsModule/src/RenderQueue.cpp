@@ -0,0 +1,71 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+
+#include "Profiler.h"
+
+void RenderQueue::Submit(ShaderMaterial* material, VertexArrayObject* mesh, const Transform* transform, float depth,
+	const glm::vec4& instanceParams, uint32_t lod) {
+	RenderCommand command;
+	command.Key = MakeKey(material->RenderLayer, material->Shader != nullptr ? material->Shader->GetHandle() : 0,
+		material->GetBatchId(), (mesh->GetHandle() << LOD_BITS) | (lod & ((1u << LOD_BITS) - 1)), depth);
+	command.Material = material;
+	command.Mesh = mesh;
+	command.Lod = lod;
+	command.ObjectTransform = transform;
+	command.InstanceParams = instanceParams;
+	_commands.push_back(command);
+}
+
+void RenderQueue::Sort() {
+	PROFILE_SCOPE("RenderQueue::Sort");
+	const size_t count = _commands.size();
+	if (count < 2) {
+		return;
+	}
+	_scratch.resize(count);
+
+	// LSD radix sort, one byte at a time. Each pass is stable, so after the last pass the commands are fully sorted
+	RenderCommand* source = _commands.data();
+	RenderCommand* dest = _scratch.data();
+	for (int shift = 0; shift < 64; shift += 8) {
+		size_t histogram[256] = { 0 };
+		for (size_t ix = 0; ix < count; ix++) {
+			histogram[(source[ix].Key >> shift) & 0xFF]++;
+		}
+
+		// If every key has the same value for this byte, this pass would not change the order
+		if (histogram[(source[0].Key >> shift) & 0xFF] == count) {
+			continue;
+		}
+
+		size_t offset = 0;
+		for (int bucket = 0; bucket < 256; bucket++) {
+			const size_t bucketSize = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketSize;
+		}
+		for (size_t ix = 0; ix < count; ix++) {
+			dest[histogram[(source[ix].Key >> shift) & 0xFF]++] = source[ix];
+		}
+		std::swap(source, dest);
+	}
+
+	// After an odd number of passes, the sorted commands are in our scratch buffer
+	if (source != _commands.data()) {
+		_commands.swap(_scratch);
+	}
+}
+
+uint64_t RenderQueue::MakeKey(int layer, uint32_t shaderId, uint64_t materialId, uint32_t meshId, float depth) {
+	// Offset the layer so that negative layers sort before positive ones
+	const uint64_t layerBits = (uint64_t)(std::clamp(layer, -128, 127) + 128);
+	const uint64_t depthBits = (uint64_t)(std::clamp(depth, 0.0f, 1.0f) * ((1 << DEPTH_BITS) - 1));
+
+	uint64_t result = layerBits;
+	result = (result << SHADER_BITS)   | (shaderId   & ((1ull << SHADER_BITS) - 1));
+	result = (result << MATERIAL_BITS) | (materialId & ((1ull << MATERIAL_BITS) - 1));
+	result = (result << MESH_BITS)     | (meshId     & ((1ull << MESH_BITS) - 1));
+	result = (result << DEPTH_BITS)    | depthBits;
+	return result;
+}
@@ -0,0 +1,90 @@
+#include "RenderState.h"
+
+// A fresh context has nothing bound, so we can start with everything at 0
+GLuint RenderState::_program = 0;
+GLuint RenderState::_vertexArray = 0;
+GLuint RenderState::_textures[RenderState::MAX_TEXTURE_UNITS] = { };
+RenderState::Stats RenderState::_stats = RenderState::Stats();
+
+void RenderState::UseProgram(GLuint program) {
+	if (_program == program) {
+		_stats.CacheHits++;
+		return;
+	}
+	glUseProgram(program);
+	_program = program;
+	_stats.StateChanges++;
+}
+
+void RenderState::BindVertexArray(GLuint vao) {
+	if (_vertexArray == vao) {
+		_stats.CacheHits++;
+		return;
+	}
+	glBindVertexArray(vao);
+	_vertexArray = vao;
+	_stats.StateChanges++;
+}
+
+void RenderState::BindTexture(int slot, GLuint texture) {
+	if (slot >= 0 && slot < MAX_TEXTURE_UNITS) {
+		if (_textures[slot] == texture) {
+			_stats.CacheHits++;
+			return;
+		}
+		_textures[slot] = texture;
+	}
+	glBindTextureUnit(slot, texture);
+	_stats.StateChanges++;
+}
+
+void RenderState::BindTextures(int first, int count, const GLuint* textures) {
+	bool changed = false;
+	for (int ix = 0; ix < count; ix++) {
+		const int slot = first + ix;
+		if (slot < 0 || slot >= MAX_TEXTURE_UNITS || _textures[slot] != textures[ix]) {
+			changed = true;
+			if (slot >= 0 && slot < MAX_TEXTURE_UNITS) {
+				_textures[slot] = textures[ix];
+			}
+		}
+	}
+	if (changed) {
+		glBindTextures(first, count, textures);
+		_stats.StateChanges++;
+	} else {
+		_stats.CacheHits++;
+	}
+}
+
+void RenderState::Invalidate() {
+	_program = UNKNOWN;
+	_vertexArray = UNKNOWN;
+	for (int ix = 0; ix < MAX_TEXTURE_UNITS; ix++) {
+		_textures[ix] = UNKNOWN;
+	}
+}
+
+void RenderState::ForgetProgram(GLuint program) {
+	if (_program == program) {
+		_program = UNKNOWN;
+	}
+}
+
+void RenderState::ForgetVertexArray(GLuint vao) {
+	if (_vertexArray == vao) {
+		_vertexArray = UNKNOWN;
+	}
+}
+
+void RenderState::ForgetTexture(GLuint texture) {
+	for (int ix = 0; ix < MAX_TEXTURE_UNITS; ix++) {
+		if (_textures[ix] == texture) {
+			_textures[ix] = UNKNOWN;
+		}
+	}
+}
+
+void RenderState::ResetStats() {
+	_stats = Stats();
+}
@@ -1,18 +1,21 @@
 #include "Shader.h"
 #include "Logging.h"
+#include "RenderState.h"
 #include <fstream>
 #include <sstream>
 
 Shader::Shader() :
 	_vs(0),
 	_fs(0),
-	_handle(0)
+	_handle(0),
+	_isInstanced(false)
 {
 	_handle = glCreateProgram();
 }
 
 Shader::~Shader() {
 	if (_handle != 0) {
+		RenderState::ForgetProgram(_handle);
 		glDeleteProgram(_handle);
 		_handle = 0;
 		LOG_INFO("Deleting shader program");
@@ -112,16 +115,19 @@ bool Shader::Link()
 		else {
 			LOG_ERROR("Shader failed to link for an unknown reason!");
 		}
+	} else {
+		_isInstanced = glGetAttribLocation(_handle, "inInstanceModel") != -1;
+		_ResolveUniforms();
 	}
 	return status != GL_FALSE;
 }
 
 void Shader::Bind() {
-	glUseProgram(_handle);
+	RenderState::UseProgram(_handle);
 }
 
 void Shader::UnBind() {
-	glUseProgram(0);
+	RenderState::UseProgram(0);
 }
 
 void Shader::SetUniformMatrix(int location, const glm::mat3* value, int count, bool transposed) {
@@ -193,4 +199,67 @@ int Shader::GetUniformLocation(const std::string& name) {
 	}
 
 	return result;
-}
\ No newline at end of file
+}
+int Shader::GetUniformLocation(const UniformId& id) const {
+	auto it = _uniformIds.find(id.Hash);
+	if (it == _uniformIds.end()) {
+		return -1;
+	}
+#ifdef _DEBUG
+	// Comparing names would defeat the point of IDs, so we only check for collisions with uniforms that the shader
+	// doesn't have in debug builds
+	LOG_ASSERT(it->second.Name == id.Name, "Uniform ID \"{}\" has the same hash as \"{}\"", id.Name, it->second.Name);
+#endif
+	return it->second.Location;
+}
+
+bool Shader::SetUniformBlockBinding(const std::string& blockName, GLuint binding) {
+	GLuint index = glGetUniformBlockIndex(_handle, blockName.c_str());
+	if (index == GL_INVALID_INDEX) {
+		return false;
+	}
+	glUniformBlockBinding(_handle, index, binding);
+	return true;
+}
+
+void Shader::_ResolveUniforms() {
+	_uniformIds.clear();
+
+	GLint count = 0, maxLength = 0;
+	glGetProgramiv(_handle, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(_handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	if (count <= 0 || maxLength <= 0) {
+		return;
+	}
+
+	std::string name;
+	name.resize(maxLength);
+	for (GLint ix = 0; ix < count; ix++) {
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(_handle, ix, maxLength, &length, &size, &type, &name[0]);
+
+		// Arrays are reported as name[0], but we want to be able to refer to them by their base name
+		if (length > 3 && name.compare(length - 3, 3, "[0]") == 0) {
+			length -= 3;
+		}
+		// Uniforms inside of blocks have no location, they are set via uniform buffers instead
+		const std::string uniformName = name.substr(0, length);
+		const int location = glGetUniformLocation(_handle, uniformName.c_str());
+		if (location == -1) {
+			continue;
+		}
+
+		const uint64_t hash = UniformId::HashName(uniformName.c_str(), uniformName.length());
+		auto it = _uniformIds.find(hash);
+		if (it != _uniformIds.end()) {
+			// Neither uniform can be set by ID now, since we can't tell which one the caller means. They can still be
+			// set by name
+			LOG_ASSERT(false, "Uniform ID hash collision between \"{}\" and \"{}\"", uniformName, it->second.Name);
+			it->second.Location = -1;
+			continue;
+		}
+		_uniformIds[hash] = ResolvedUniform{ location, uniformName };
+	}
+}
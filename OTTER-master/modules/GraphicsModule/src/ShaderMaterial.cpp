@@ -1,92 +1,261 @@
 #include "ShaderMaterial.h"
+#include "RenderState.h"
 
-template<typename T>
-void SubmitUniforms(const Shader::sptr& shader, const std::unordered_map<ShaderParamName, T>& values) {
-	for (auto& kvp : values) {
-		shader->SetUniform(kvp.first.Location, kvp.second);
+#include <atomic>
+#include <cstring>
+#include <algorithm>
+
+// Returns the bit for a parameter index within it's mask word
+inline uint64_t ParamBit(int index) { return 1ull << (index & 63); }
+
+// Iterates over the indices of all the set bits in a mask
+template <typename Func>
+void ForEachBit(const std::vector<uint64_t>& mask, const Func& func) {
+	for (size_t word = 0; word < mask.size(); word++) {
+		uint64_t bits = mask[word];
+		while (bits != 0) {
+			int bit = 0;
+			while ((bits & (1ull << bit)) == 0) { bit++; }
+			bits &= bits - 1;
+			func((int)(word * 64) + bit);
+		}
 	}
 }
 
-template<typename T>
-void SubmitUniformsMat(const Shader::sptr& shader, const std::unordered_map<ShaderParamName, T>& values) {
-	for (auto& kvp : values) {
-		shader->SetUniformMatrix(kvp.first.Location, kvp.second);
+// Mixes some bytes into an FNV-1a hash, the same hash that UniformId uses
+inline uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t ix = 0; ix < size; ix++) {
+		hash ^= bytes[ix];
+		hash *= 0x100000001b3ull;
 	}
+	return hash;
 }
 
 ShaderMaterial::ShaderMaterial()
-	: Shader(nullptr),  RenderLayer(0)
+	: Shader(nullptr),  RenderLayer(0), MaterialParams(0.0f), _batchId(0), _isBatchIdDirty(true), _layout(nullptr)
 {
+	static std::atomic<uint64_t> nextId(1);
+	_id = nextId++;
 }
 
 ShaderMaterial::~ShaderMaterial() {
 	LOG_INFO("Deleting material");
 }
 
+void ShaderMaterial::Compile()
+{
+	LOG_ASSERT(Shader != nullptr, "Must set Material shader before compiling");
+	MaterialLayout::sptr layout = MaterialLayout::Get(Shader);
+	if (layout == _layout) {
+		return;
+	}
+
+	if (layout->GetTextureCount() > MAX_TEXTURES) {
+		LOG_ERROR("Shader uses {} textures, but materials can only bind {}, the rest will not be bound", layout->GetTextureCount(), MAX_TEXTURES);
+	}
+
+	const size_t maskWords = (layout->GetParams().size() + 63) / 64;
+	std::vector<uint8_t>        data(layout->GetDataSize(), 0);
+	std::vector<ITexture::sptr> textures(layout->GetTextureCount(), nullptr);
+	std::vector<uint64_t>       setMask(maskWords, 0);
+
+	// Carry over any values from the old shader that still make sense for the new one
+	if (_layout != nullptr) {
+		const std::vector<MaterialParam>& oldParams = _layout->GetParams();
+		ForEachBit(_setMask, [&](int oldIx) {
+			const MaterialParam& oldParam = oldParams[oldIx];
+			int newIx = layout->FindParam(oldParam.Name);
+			if (newIx == -1) {
+				return;
+			}
+			const MaterialParam& newParam = layout->GetParams()[newIx];
+			if (newParam.Type != oldParam.Type) {
+				return;
+			}
+			if (newParam.Type == MaterialParamType::Texture) {
+				textures[newParam.Offset] = _textures[oldParam.Offset];
+			} else {
+				memcpy(data.data() + newParam.Offset, _data.data() + oldParam.Offset, MaterialLayout::GetTypeSize(newParam.Type));
+			}
+			setMask[newIx / 64] |= ParamBit(newIx);
+		});
+	}
+
+	_layout = layout;
+	_data = std::move(data);
+	_textures = std::move(textures);
+	_setMask = std::move(setMask);
+	_dirtyMask = _setMask;
+	_isBatchIdDirty = true;
+}
+
 void ShaderMaterial::Apply()
-{	
-	int slot = 1;
-	for (auto& kvp : Textures) {
-		if (kvp.first.Location != -1 && kvp.second != nullptr) {
-			Shader->SetUniform(kvp.first.Location, slot);
-			kvp.second->Bind(slot);
-			slot++;
+{
+	if (_layout == nullptr || !_layout->IsFor(Shader)) {
+		Compile();
+	}
+
+	_UpdatePendingTextures();
+
+	// If we were the last material to use this shader, only the values we changed since then need to be uploaded,
+	// otherwise the shader has another material's values and we need to upload all of ours
+	const bool uploadAll = _layout->LastApplied != _id;
+	const std::vector<MaterialParam>& params = _layout->GetParams();
+	ForEachBit(uploadAll ? _setMask : _dirtyMask, [&](int ix) {
+		if (params[ix].Type != MaterialParamType::Texture) {
+			_Upload(params[ix]);
+		}
+	});
+	std::fill(_dirtyMask.begin(), _dirtyMask.end(), 0);
+	_layout->LastApplied = _id;
+
+	// Texture units are shared between all shaders, so we always have to bind ours. Luckily we can do it in one go
+	if (!_textures.empty()) {
+		GLuint handles[MAX_TEXTURES];
+		const GLsizei count = (GLsizei)std::min<size_t>(_textures.size(), MAX_TEXTURES);
+		for (GLsizei ix = 0; ix < count; ix++) {
+			handles[ix] = _textures[ix] != nullptr ? _textures[ix]->GetHandle() : 0;
 		}
+		RenderState::BindTextures(MaterialLayout::FIRST_TEXTURE_SLOT, count, handles);
+	}
+}
+
+uint64_t ShaderMaterial::GetBatchId()
+{
+	if (_layout == nullptr || !_layout->IsFor(Shader)) {
+		Compile();
 	}
+	// A texture finishing it's load changes our state, so it has to be swapped in before we compare against others
+	_UpdatePendingTextures();
 
-	SubmitUniforms(Shader, FloatParams);
-	SubmitUniforms(Shader, Vec2Params);
-	SubmitUniforms(Shader, Vec3Params);
-	SubmitUniforms(Shader, Vec4Params);
-	SubmitUniformsMat(Shader, Mat4Params);
-	SubmitUniformsMat(Shader, Mat3Params);
+	if (_isBatchIdDirty) {
+		uint64_t hash = 0xcbf29ce484222325ull;
+		const MaterialLayout* layout = _layout.get();
+		hash = HashBytes(hash, &layout, sizeof(layout));
+		hash = HashBytes(hash, _setMask.data(), _setMask.size() * sizeof(uint64_t));
+		hash = HashBytes(hash, _data.data(), _data.size());
+		// Textures are compared by object rather than handle, since a texture's handle changes if it is resized
+		for (const ITexture::sptr& texture : _textures) {
+			const ITexture* pointer = texture.get();
+			hash = HashBytes(hash, &pointer, sizeof(pointer));
+		}
+		_batchId = hash;
+		_isBatchIdDirty = false;
+	}
+	return _batchId;
+}
+
+void ShaderMaterial::_UpdatePendingTextures()
+{
+	for (auto it = _pendingTextures.begin(); it != _pendingTextures.end();) {
+		ITexture::sptr texture = nullptr;
+		if (it->second(texture)) {
+			if (texture != nullptr) {
+				_SetTexture(it->first, texture);
+			}
+			it = _pendingTextures.erase(it);
+		} else {
+			++it;
+		}
+	}
 }
 
 void ShaderMaterial::Set(const std::string& name, const ITexture::sptr& texture) {
-	LOG_ASSERT(Shader != nullptr, "Must set Material shader before setting params");
-	ShaderParamName pName = name;
-	pName.Location = Shader->GetUniformLocation(name);
-	Textures[pName] = texture;
+	_pendingTextures.erase(name);
+	_SetTexture(name, texture);
 }
 
 void ShaderMaterial::Set(const std::string& name, float value) {
-	LOG_ASSERT(Shader != nullptr, "Must set Material shader before setting params");
-	ShaderParamName pName = name;
-	pName.Location = Shader->GetUniformLocation(name);
-	FloatParams[pName] = value;
+	_SetValue(name, MaterialParamType::Float, &value);
 }
 
 void ShaderMaterial::Set(const std::string& name, const glm::vec2& value) {
-	LOG_ASSERT(Shader != nullptr, "Must set Material shader before setting params");
-	ShaderParamName pName = name;
-	pName.Location = Shader->GetUniformLocation(name);
-	Vec2Params[pName] = value;
+	_SetValue(name, MaterialParamType::Vec2, &value);
 }
 
 void ShaderMaterial::Set(const std::string& name, const glm::vec3& value) {
-	LOG_ASSERT(Shader != nullptr, "Must set Material shader before setting params");
-	ShaderParamName pName = name;
-	pName.Location = Shader->GetUniformLocation(name);
-	Vec3Params[pName] = value;
+	_SetValue(name, MaterialParamType::Vec3, &value);
 }
 
 void ShaderMaterial::Set(const std::string& name, const glm::vec4& value) {
-	LOG_ASSERT(Shader != nullptr, "Must set Material shader before setting params");
-	ShaderParamName pName = name;
-	pName.Location = Shader->GetUniformLocation(name);
-	Vec4Params[pName] = value;
+	_SetValue(name, MaterialParamType::Vec4, &value);
 }
 
 void ShaderMaterial::Set(const std::string& name, const glm::mat4& value) {
-	LOG_ASSERT(Shader != nullptr, "Must set Material shader before setting params");
-	ShaderParamName pName = name;
-	pName.Location = Shader->GetUniformLocation(name);
-	Mat4Params[pName] = value;
+	_SetValue(name, MaterialParamType::Mat4, &value);
 }
 
 void ShaderMaterial::Set(const std::string& name, const glm::mat3& value) {
+	_SetValue(name, MaterialParamType::Mat3, &value);
+}
+
+void ShaderMaterial::Set(const std::string& name, int value) {
+	_SetValue(name, MaterialParamType::Int, &value);
+}
+
+int ShaderMaterial::_FindParam(const std::string& name, MaterialParamType type) {
 	LOG_ASSERT(Shader != nullptr, "Must set Material shader before setting params");
-	ShaderParamName pName = name;
-	pName.Location = Shader->GetUniformLocation(name);
-	Mat3Params[pName] = value;
+	if (_layout == nullptr || !_layout->IsFor(Shader)) {
+		Compile();
+	}
+
+	int index = _layout->FindParam(name);
+	if (index == -1) {
+		LOG_WARN("Ignoring material parameter \"{}\"", name);
+		return -1;
+	}
+	if (_layout->GetParams()[index].Type != type) {
+		LOG_WARN("Material parameter \"{}\" does not match the type in the shader, ignoring", name);
+		return -1;
+	}
+	return index;
+}
+
+void ShaderMaterial::_SetValue(const std::string& name, MaterialParamType type, const void* value) {
+	int index = _FindParam(name, type);
+	if (index != -1) {
+		const MaterialParam& param = _layout->GetParams()[index];
+		uint8_t* dest = _data.data() + param.Offset;
+		const uint32_t size = MaterialLayout::GetTypeSize(type);
+		// Skip values that haven't actually changed, so they don't get re-uploaded
+		if ((_setMask[index / 64] & ParamBit(index)) && memcmp(dest, value, size) == 0) {
+			return;
+		}
+		memcpy(dest, value, size);
+		_MarkDirty(index);
+	}
+}
+
+void ShaderMaterial::_SetTexture(const std::string& name, const ITexture::sptr& texture) {
+	int index = _FindParam(name, MaterialParamType::Texture);
+	if (index != -1) {
+		const uint32_t slot = _layout->GetParams()[index].Offset;
+		if (slot >= MAX_TEXTURES) {
+			LOG_ERROR("Texture \"{}\" uses slot {}, but materials can only bind {} textures", name, slot, MAX_TEXTURES);
+			return;
+		}
+		_textures[slot] = texture;
+		_MarkDirty(index);
+	}
+}
+
+void ShaderMaterial::_MarkDirty(int index) {
+	_setMask[index / 64]   |= ParamBit(index);
+	_dirtyMask[index / 64] |= ParamBit(index);
+	_isBatchIdDirty = true;
+}
+
+void ShaderMaterial::_Upload(const MaterialParam& param) {
+	const void* value = _data.data() + param.Offset;
+	switch (param.Type) {
+	case MaterialParamType::Float: Shader->SetUniform(param.Location, static_cast<const float*>(value)); break;
+	case MaterialParamType::Vec2:  Shader->SetUniform(param.Location, static_cast<const glm::vec2*>(value)); break;
+	case MaterialParamType::Vec3:  Shader->SetUniform(param.Location, static_cast<const glm::vec3*>(value)); break;
+	case MaterialParamType::Vec4:  Shader->SetUniform(param.Location, static_cast<const glm::vec4*>(value)); break;
+	case MaterialParamType::Int:   Shader->SetUniform(param.Location, static_cast<const int*>(value)); break;
+	case MaterialParamType::Mat3:  Shader->SetUniformMatrix(param.Location, static_cast<const glm::mat3*>(value)); break;
+	case MaterialParamType::Mat4:  Shader->SetUniformMatrix(param.Location, static_cast<const glm::mat4*>(value)); break;
+	default: break;
+	}
 }
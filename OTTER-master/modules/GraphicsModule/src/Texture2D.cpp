@@ -1,14 +1,20 @@
 #include "Texture2D.h"
 
+#include <algorithm>
+
+#include "BakedTexture.h"
+#include "RenderState.h"
+
 Texture2D::Texture2D(const Texture2DDescription& description) :
 	ITexture(), _description(description)
 {
-
+	_levelCount = _description.GenerateMipMaps ? ::GetMipLevelCount(_description.Width, _description.Height) : 1;
 	_RecreateTexture();
 }
 
 void Texture2D::_RecreateTexture() {
 	if (_handle != 0) {
+		RenderState::ForgetTexture(_handle);
 		glDeleteTextures(1, &_handle);
 		_handle = 0;
 	}
@@ -21,7 +27,7 @@ void Texture2D::_RecreateTexture() {
 
 	if (_description.Width * _description.Height > 0 && _description.Format != InternalFormat::Unknown)
 	{
-		glTextureStorage2D(_handle, 1, *_description.Format, _description.Width, _description.Height);
+		glTextureStorage2D(_handle, _levelCount, *_description.Format, _description.Width, _description.Height);
 
 		glTextureParameteri(_handle, GL_TEXTURE_WRAP_S, (GLenum)_description.HorizontalWrap);
 		glTextureParameteri(_handle, GL_TEXTURE_WRAP_T, (GLenum)_description.VerticalWrap);
@@ -32,15 +38,24 @@ void Texture2D::_RecreateTexture() {
 }
 
 void Texture2D::LoadData(const Texture2DData::sptr& data) {
+	// Compressed data can only be uploaded into a texture of the same format
+	const InternalFormat format = data->IsCompressed() || _description.Format == InternalFormat::Unknown ?
+		data->GetRecommendedFormat() : _description.Format;
+	// If the data was baked with mip levels we upload them as-is, otherwise we allocate a full chain and let the driver
+	// generate them (which it can't do for compressed formats)
+	const bool hasMips = data->GetLevelCount() > 1;
+	const uint32_t levelCount = hasMips ? data->GetLevelCount() :
+		(_description.GenerateMipMaps && !data->IsCompressed() ? ::GetMipLevelCount(data->GetWidth(), data->GetHeight()) : 1);
+
 	if (_description.Width != data->GetWidth() ||
-		_description.Height != data->GetHeight()) 
+		_description.Height != data->GetHeight() ||
+		_description.Format != format ||
+		_levelCount != levelCount)
 	{
 		_description.Width = data->GetWidth();
 		_description.Height = data->GetHeight();
-		
-		if (_description.Format == InternalFormat::Unknown) {
-			_description.Format = data->GetRecommendedFormat();
-		}
+		_description.Format = format;
+		_levelCount = levelCount;
 		
 		_RecreateTexture();
 	}
@@ -49,28 +64,48 @@ void Texture2D::LoadData(const Texture2DData::sptr& data) {
 	if (!data->DebugName.empty()) {
 		glObjectLabel(GL_TEXTURE, _handle, data->DebugName.length(), data->DebugName.c_str());
 	}
+
+	if (data->IsCompressed()) {
+		// Compressed levels go up exactly as they are stored
+		for (uint32_t ix = 0; ix < data->GetLevelCount(); ix++) {
+			const Texture2DLevel& level = data->GetLevel(ix);
+			glCompressedTextureSubImage2D(_handle, ix, 0, 0, level.Width, level.Height, *format, (GLsizei)level.Size, data->GetLevelDataPtr(ix));
+		}
+		return;
+	}
 	
 	// Align the data store to the size of a single component in
 	// See https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glPixelStore.xhtml
 	int componentSize = (GLint)GetTexelComponentSize(data->GetPixelType());
-	glPixelStorei(GL_PACK_ALIGNMENT, componentSize);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, componentSize);
 
 	// Upload our data to our image
-	glTextureSubImage2D(_handle, 0, 0, 0, _description.Width, _description.Height, *data->GetFormat(), *data->GetPixelType(), data->GetDataPtr());
+	for (uint32_t ix = 0; ix < data->GetLevelCount(); ix++) {
+		const Texture2DLevel& level = data->GetLevel(ix);
+		glTextureSubImage2D(_handle, ix, 0, 0, level.Width, level.Height, *data->GetFormat(), *data->GetPixelType(), data->GetLevelDataPtr(ix));
+	}
 
-	if (_description.GenerateMipMaps) {
+	if (!hasMips && _levelCount > 1) {
 		glGenerateTextureMipmap(_handle);
 	}
 }
 
 Texture2D::sptr Texture2D::LoadFromFile(const std::string& path) {
-	Texture2DData::sptr data = Texture2DData::LoadFromFile(path);
+	Texture2DData::sptr data = BakedTexture::LoadCached(path);
 	LOG_ASSERT(data != nullptr, "Failed to load image from file!");
 	Texture2D::sptr result = Texture2D::Create();
 	result->LoadData(data);
 	return result;
 }
 
+size_t Texture2D::GetGpuMemoryUsage() const {
+	size_t result = 0;
+	for (uint32_t ix = 0; ix < _levelCount; ix++) {
+		result += GetLevelSize(_description.Format, std::max(_description.Width >> ix, 1u), std::max(_description.Height >> ix, 1u));
+	}
+	return result;
+}
+
 void Texture2D::SetMinFilter(MinFilter filter) {
 	_description.MinificationFilter = filter;
 	if (_handle != 0) {
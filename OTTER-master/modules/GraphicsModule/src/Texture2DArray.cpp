@@ -0,0 +1,122 @@
+#include "Texture2DArray.h"
+
+#include <algorithm>
+
+#include "BakedTexture.h"
+#include "Logging.h"
+#include "RenderState.h"
+
+Texture2DArray::Texture2DArray(const Texture2DArrayDescription& description) :
+	ITexture(), _description(description)
+{
+	_levelCount = _description.GenerateMipMaps ? ::GetMipLevelCount(_description.Width, _description.Height) : 1;
+	_RecreateTexture();
+}
+
+void Texture2DArray::_RecreateTexture() {
+	if (_handle != 0) {
+		RenderState::ForgetTexture(_handle);
+		glDeleteTextures(1, &_handle);
+		_handle = 0;
+	}
+
+	glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &_handle);
+
+	if (_description.MaxAnisotropic < 0.0f) {
+		_description.MaxAnisotropic = ITexture::GetLimits().MAX_ANISOTROPY;
+	}
+
+	if (_description.Width * _description.Height * _description.Layers > 0 && _description.Format != InternalFormat::Unknown)
+	{
+		glTextureStorage3D(_handle, _levelCount, *_description.Format, _description.Width, _description.Height, _description.Layers);
+
+		glTextureParameteri(_handle, GL_TEXTURE_WRAP_S, (GLenum)_description.HorizontalWrap);
+		glTextureParameteri(_handle, GL_TEXTURE_WRAP_T, (GLenum)_description.VerticalWrap);
+		glTextureParameteri(_handle, GL_TEXTURE_MIN_FILTER, (GLenum)_description.MinificationFilter);
+		glTextureParameteri(_handle, GL_TEXTURE_MAG_FILTER, (GLenum)_description.MagnificationFilter);
+		glTextureParameterf(_handle, GL_TEXTURE_MAX_ANISOTROPY, _description.MaxAnisotropic);
+	}
+}
+
+bool Texture2DArray::LoadData(const std::vector<Texture2DData::sptr>& layers) {
+	if (layers.empty()) {
+		return false;
+	}
+	const Texture2DData& first = *layers[0];
+	for (const Texture2DData::sptr& layer : layers) {
+		if (layer->GetWidth() != first.GetWidth() || layer->GetHeight() != first.GetHeight() || layer->GetLevelCount() != first.GetLevelCount() ||
+			layer->GetRecommendedFormat() != first.GetRecommendedFormat() || layer->GetFormat() != first.GetFormat() ||
+			layer->GetPixelType() != first.GetPixelType())
+		{
+			LOG_WARN("Layer \"{}\" does not match the first layer of texture array \"{}\", skipping upload", layer->DebugName, first.DebugName);
+			return false;
+		}
+	}
+
+	// Same as Texture2D::LoadData, compressed data forces it's own format, and baked mips are uploaded as-is
+	const InternalFormat format = first.IsCompressed() || _description.Format == InternalFormat::Unknown ?
+		first.GetRecommendedFormat() : _description.Format;
+	const bool hasMips = first.GetLevelCount() > 1;
+	const uint32_t levelCount = hasMips ? first.GetLevelCount() :
+		(_description.GenerateMipMaps && !first.IsCompressed() ? ::GetMipLevelCount(first.GetWidth(), first.GetHeight()) : 1);
+	const uint32_t layerCount = static_cast<uint32_t>(layers.size());
+
+	if (_description.Width != first.GetWidth() ||
+		_description.Height != first.GetHeight() ||
+		_description.Layers != layerCount ||
+		_description.Format != format ||
+		_levelCount != levelCount)
+	{
+		_description.Width = first.GetWidth();
+		_description.Height = first.GetHeight();
+		_description.Layers = layerCount;
+		_description.Format = format;
+		_levelCount = levelCount;
+
+		_RecreateTexture();
+	}
+
+	if (!first.DebugName.empty()) {
+		glObjectLabel(GL_TEXTURE, _handle, first.DebugName.length(), first.DebugName.c_str());
+	}
+
+	if (!first.IsCompressed()) {
+		int componentSize = (GLint)GetTexelComponentSize(first.GetPixelType());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, componentSize);
+	}
+
+	// Each layer is uploaded as a slice of depth 1, at it's index in the array
+	for (uint32_t layer = 0; layer < layerCount; layer++) {
+		const Texture2DData& data = *layers[layer];
+		for (uint32_t ix = 0; ix < data.GetLevelCount(); ix++) {
+			const Texture2DLevel& level = data.GetLevel(ix);
+			if (data.IsCompressed()) {
+				glCompressedTextureSubImage3D(_handle, ix, 0, 0, layer, level.Width, level.Height, 1, *format, (GLsizei)level.Size, data.GetLevelDataPtr(ix));
+			} else {
+				glTextureSubImage3D(_handle, ix, 0, 0, layer, level.Width, level.Height, 1, *data.GetFormat(), *data.GetPixelType(), data.GetLevelDataPtr(ix));
+			}
+		}
+	}
+
+	if (!hasMips && _levelCount > 1) {
+		glGenerateTextureMipmap(_handle);
+	}
+	return true;
+}
+
+Texture2DArray::sptr Texture2DArray::LoadFromFiles(const std::string& cachePath, const std::vector<std::string>& sourcePaths, const TextureBakeSettings& settings) {
+	std::vector<Texture2DData::sptr> layers = BakedTexture::LoadCachedArray(cachePath, sourcePaths, settings);
+	if (layers.empty()) {
+		return nullptr;
+	}
+	Texture2DArray::sptr result = Texture2DArray::Create();
+	return result->LoadData(layers) ? result : nullptr;
+}
+
+size_t Texture2DArray::GetGpuMemoryUsage() const {
+	size_t result = 0;
+	for (uint32_t ix = 0; ix < _levelCount; ix++) {
+		result += GetLevelSize(_description.Format, std::max(_description.Width >> ix, 1u), std::max(_description.Height >> ix, 1u));
+	}
+	return result * _description.Layers;
+}
@@ -1,38 +1,79 @@
 #include "Texture2DData.h"
 
+#include <cstring>
+#include <algorithm>
 #include <filesystem>
+#include <mutex>
 #include <stb_image.h>
 
+#include "MemoryMappedFile.h"
+
 Texture2DData::Texture2DData(uint32_t width, uint32_t height, PixelFormat format, PixelType type, void* sourceData, InternalFormat recommendedFormat) :
-	_width(width), _height(height), _format(format), _type(type), _data(nullptr), _recommendedFormat(recommendedFormat)
+	_width(width), _height(height), _format(format), _type(type), _recommendedFormat(recommendedFormat), _data(nullptr)
 {
 	LOG_ASSERT(width > 0 & height > 0, "Width and height must both be greater than zero! Got {}x{}", width, height);
 	_dataSize = width * (size_t)height * GetTexelSize(_format, _type);
-	_data = malloc(_dataSize);
-	LOG_ASSERT(_data != nullptr, "Failed to allocate texture data!");
+	void* data = malloc(_dataSize);
+	LOG_ASSERT(data != nullptr, "Failed to allocate texture data!");
 	if (sourceData != nullptr) {
-		memcpy(_data, sourceData, _dataSize);
+		memcpy(data, sourceData, _dataSize);
 	}
+	_storage = std::shared_ptr<const void>(data, free);
+	_data = data;
+	_levels.push_back({ width, height, 0, _dataSize });
 }
 
-Texture2DData::~Texture2DData() {
-	free(_data);
+Texture2DData::Texture2DData(InternalFormat format, const std::vector<Texture2DLevel>& levels, const void* data, const std::shared_ptr<const void>& storage) :
+	_width(0), _height(0), _dataSize(0), _format(PixelFormat::RGBA), _type(PixelType::UByte),
+	_recommendedFormat(format), _data(data), _levels(levels), _storage(storage)
+{
+	LOG_ASSERT(!levels.empty() && levels[0].Width > 0 && levels[0].Height > 0, "Texture data must have at least one level!");
+	_width = levels[0].Width;
+	_height = levels[0].Height;
+	for (const Texture2DLevel& level : levels) {
+		_dataSize = std::max(_dataSize, level.Offset + level.Size);
+	}
+
+	// Compressed data is uploaded in it's internal format, but uncompressed levels still need a layout
+	switch (format) {
+		case InternalFormat::R8:
+			_format = PixelFormat::Red;
+			break;
+		case InternalFormat::RG8:
+			_format = PixelFormat::RG;
+			break;
+		default:
+			_format = PixelFormat::RGBA;
+			break;
+	}
 }
 
 Texture2DData::sptr Texture2DData::LoadFromFile(const std::string& file, bool forceRgba)
+{
+	MemoryMappedFile source(file);
+	if (!source.IsOpen()) {
+		LOG_WARN("STBI Failed to load image from \"{}\"", file);
+		return nullptr;
+	}
+	return LoadFromMemory(source.GetData(), source.GetSize(), file, forceRgba);
+}
+
+Texture2DData::sptr Texture2DData::LoadFromMemory(const void* encoded, size_t size, const std::string& name, bool forceRgba)
 {
 	// Variables that will store properties about our image
 	int width, height, numChannels;
 	const int targetChannels = forceRgba ? 4 : 0;
 
-	// Use STBI to load the image
-	stbi_set_flip_vertically_on_load(true);
-	uint8_t* data = stbi_load(file.c_str(), &width, &height, &numChannels, targetChannels);
+	// Use STBI to load the image. The flip flag is global in STBI, so we only set it once to avoid racing with images
+	// being decoded on other threads
+	static std::once_flag flipFlag;
+	std::call_once(flipFlag, []() { stbi_set_flip_vertically_on_load(true); });
+	uint8_t* data = stbi_load_from_memory(static_cast<const stbi_uc*>(encoded), static_cast<int>(size), &width, &height, &numChannels, targetChannels);
 
 	// If we could not load any data, warn and return null
 	if (data == nullptr) {
-		LOG_WARN("STBI Failed to load image from \"{}\"", file); 
-		return nullptr; 
+		LOG_WARN("STBI Failed to load image from \"{}\"", name);
+		return nullptr;
 	}
 
 	// We should estimate a good format for our data
@@ -62,20 +103,20 @@ Texture2DData::sptr Texture2DData::LoadFromFile(const std::string& file, bool fo
 		image_format = PixelFormat::RGBA;
 		break;
 	default:
-		LOG_ASSERT(false, "Unsupported texture format for texture \"{}\" with {} channels", file, numChannels)
+		LOG_ASSERT(false, "Unsupported texture format for texture \"{}\" with {} channels", name, numChannels)
 		break;
 	}
-	
+
 	// This is one of those poorly documented things in OpenGL
 	if ((numChannels * width) % 4 != 0) {
-		LOG_WARN("The alignment of a horizontal line is not a multiple of 4, this will require a call to glPixelStorei(GL_PACK_ALIGNMENT)");
+		LOG_WARN("The alignment of a horizontal line is not a multiple of 4, this will require a call to glPixelStorei(GL_UNPACK_ALIGNMENT)");
 	}
 
 	// Create the result and store our image data in it
 	// Note that stbi will always give us an array of unsigned bytes (uint8_t)
 	Texture2DData::sptr result = std::make_shared<Texture2DData>(width, height, image_format, PixelType::UByte, data, internal_format);
-	result->DebugName = std::filesystem::path(file).filename().string();
-	
+	result->DebugName = std::filesystem::path(name).filename().string();
+
 	// We now have a copy in our ptr, we can free STBI's copy of it
 	stbi_image_free(data);
 
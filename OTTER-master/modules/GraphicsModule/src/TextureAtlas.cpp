@@ -0,0 +1,116 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "stb_rect_pack.h"
+#include "Logging.h"
+
+// Copies an image into a larger RGBA buffer with a border of it's edge texels around it, the buffer must have room
+// for the image plus the padding on every side
+static void CopyWithBorder(const TextureImage& image, uint32_t padding, uint8_t* dest, size_t destStride) {
+	const uint32_t paddedWidth = image.Width + padding * 2, paddedHeight = image.Height + padding * 2;
+	for (uint32_t y = 0; y < paddedHeight; y++) {
+		const uint32_t sourceY = std::min(y > padding ? y - padding : 0, image.Height - 1);
+		const uint8_t* sourceRow = image.Pixels.data() + sourceY * static_cast<size_t>(image.Width) * 4;
+		uint8_t* destRow = dest + y * destStride;
+		for (uint32_t x = 0; x < paddedWidth; x++) {
+			const uint32_t sourceX = std::min(x > padding ? x - padding : 0, image.Width - 1);
+			memcpy(destRow + x * 4, sourceRow + sourceX * 4, 4);
+		}
+	}
+}
+
+static TextureAtlasRegion MakeRegion(const stbrp_rect& rect, uint32_t padding, uint32_t size) {
+	TextureAtlasRegion region;
+	region.X = rect.x + padding;
+	region.Y = rect.y + padding;
+	region.Width = rect.w - padding * 2;
+	region.Height = rect.h - padding * 2;
+	region.UvTransform = glm::vec4(region.Width, region.Height, region.X, region.Y) / static_cast<float>(size);
+	return region;
+}
+
+TextureImage TextureAtlas::Pack(const std::vector<TextureImage>& images, uint32_t size, uint32_t padding, std::vector<TextureAtlasRegion>& regions) {
+	std::vector<stbrp_rect> rects(images.size());
+	for (size_t ix = 0; ix < images.size(); ix++) {
+		if (images[ix].Channels != 4) {
+			throw std::runtime_error("Only RGBA images can be packed into an atlas");
+		}
+		rects[ix].id = static_cast<int>(ix);
+		rects[ix].w = static_cast<stbrp_coord>(images[ix].Width + padding * 2);
+		rects[ix].h = static_cast<stbrp_coord>(images[ix].Height + padding * 2);
+	}
+
+	// Packing everything at once lets stb_rect_pack sort the rectangles by height, which packs much tighter than
+	// adding them one at a time
+	stbrp_context context;
+	std::vector<stbrp_node> nodes(size);
+	stbrp_init_target(&context, size, size, nodes.data(), (int)nodes.size());
+	if (!stbrp_pack_rects(&context, rects.data(), (int)rects.size())) {
+		throw std::runtime_error("The images do not fit in a " + std::to_string(size) + "x" + std::to_string(size) + " atlas");
+	}
+
+	TextureImage result;
+	result.Width = result.Height = size;
+	result.Channels = 4;
+	result.Pixels.resize(static_cast<size_t>(size) * size * 4, 0);
+	regions.resize(images.size());
+	for (const stbrp_rect& rect : rects) {
+		CopyWithBorder(images[rect.id], padding, result.Pixels.data() + (rect.y * static_cast<size_t>(size) + rect.x) * 4, size * 4);
+		regions[rect.id] = MakeRegion(rect, padding, size);
+	}
+	return result;
+}
+
+TextureAtlas::TextureAtlas(uint32_t size, uint32_t padding) :
+	_size(size),
+	_padding(padding),
+	_imageCount(0),
+	_isDirty(false),
+	_packer(std::make_unique<stbrp_context>()),
+	_nodes(size)
+{
+	Texture2DDescription desc;
+	desc.Width = size;
+	desc.Height = size;
+	desc.Format = InternalFormat::RGBA8;
+	desc.HorizontalWrap = WrapMode::ClampToEdge;
+	desc.VerticalWrap = WrapMode::ClampToEdge;
+	desc.MinificationFilter = MinFilter::LinearMipLinear;
+	_texture = Texture2D::Create(desc);
+	_texture->Clear(glm::vec4(0.0f));
+
+	stbrp_init_target(_packer.get(), size, size, _nodes.data(), (int)_nodes.size());
+}
+
+// Defined here, where stbrp_context is a complete type
+TextureAtlas::~TextureAtlas() = default;
+
+bool TextureAtlas::Add(const TextureImage& image, TextureAtlasRegion& region) {
+	LOG_ASSERT(image.Channels == 4, "Only RGBA images can be added to an atlas");
+	stbrp_rect rect = { };
+	rect.w = static_cast<stbrp_coord>(image.Width + _padding * 2);
+	rect.h = static_cast<stbrp_coord>(image.Height + _padding * 2);
+	if (!stbrp_pack_rects(_packer.get(), &rect, 1)) {
+		return false;
+	}
+
+	std::vector<uint8_t> padded(static_cast<size_t>(rect.w) * rect.h * 4);
+	CopyWithBorder(image, _padding, padded.data(), rect.w * 4);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTextureSubImage2D(_texture->GetHandle(), 0, rect.x, rect.y, rect.w, rect.h, GL_RGBA, GL_UNSIGNED_BYTE, padded.data());
+
+	region = MakeRegion(rect, _padding, _size);
+	_imageCount++;
+	_isDirty = true;
+	return true;
+}
+
+void TextureAtlas::Update() {
+	if (_isDirty) {
+		glGenerateTextureMipmap(_texture->GetHandle());
+		_isDirty = false;
+	}
+}
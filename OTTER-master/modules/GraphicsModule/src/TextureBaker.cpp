@@ -0,0 +1,442 @@
+#include "TextureBaker.h"
+
+#include <cmath>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+#include "BlockCompressor.h"
+#include "JobSystem.h"
+#include "Logging.h"
+
+// SSE2 is always available on x64, on other platforms we fall back to filtering one channel at a time
+#if defined(_M_X64) || defined(__SSE2__)
+#define TEXTURE_USE_SSE 1
+#include <emmintrin.h>
+#else
+#define TEXTURE_USE_SSE 0
+#endif
+
+const float PI = 3.14159265358979f;
+// The Kaiser filter reaches 3 texels of the smaller level either side of each texel, with a window shape (alpha) of 4
+const float KAISER_RADIUS = 3.0f;
+const float KAISER_ALPHA = 4.0f;
+
+/// <summary>
+/// An RGBA image with a float per channel, which mip levels are filtered in
+/// </summary>
+struct FloatImage
+{
+	uint32_t           Width = 0;
+	uint32_t           Height = 0;
+	std::vector<float> Texels;
+
+	FloatImage(uint32_t width, uint32_t height) : Width(width), Height(height), Texels(static_cast<size_t>(width) * height * 4) {}
+};
+
+/// <summary>
+/// The weighted taps that make up each texel of a downsampled row or column
+/// </summary>
+struct FilterKernel
+{
+	// The first tap of each texel, with an extra entry at the end
+	std::vector<uint32_t> Starts;
+	std::vector<uint32_t> Sources;
+	std::vector<float>    Weights;
+};
+
+/// <summary>
+/// Lookup tables for converting to and from sRGB
+/// </summary>
+struct SrgbTables
+{
+	float ToLinear[256];
+	// The linear value at which each sRGB byte rounds up to the next one, so encoding rounds exactly
+	float Thresholds[255];
+
+	SrgbTables() {
+		auto decode = [](float value) {
+			return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+		};
+		for (int ix = 0; ix < 256; ix++) {
+			ToLinear[ix] = decode(ix / 255.0f);
+		}
+		for (int ix = 0; ix < 255; ix++) {
+			Thresholds[ix] = decode((ix + 0.5f) / 255.0f);
+		}
+	}
+
+	uint8_t Encode(float value) const {
+		return static_cast<uint8_t>(std::upper_bound(Thresholds, Thresholds + 255, value) - Thresholds);
+	}
+};
+
+static const SrgbTables& GetSrgbTables() {
+	static const SrgbTables tables;
+	return tables;
+}
+
+inline float Sinc(float x) {
+	return std::abs(x) < 1.0e-5f ? 1.0f : std::sin(PI * x) / (PI * x);
+}
+
+// The zeroth order modified Bessel function of the first kind, which shapes the Kaiser window
+inline float BesselI0(float x) {
+	float sum = 1.0f, term = 1.0f;
+	for (int k = 1; k < 32 && term > sum * 1.0e-8f; k++) {
+		const float half = x / (2.0f * k);
+		term *= half * half;
+		sum += term;
+	}
+	return sum;
+}
+
+inline float Kaiser(float t) {
+	if (std::abs(t) >= 1.0f) {
+		return 0.0f;
+	}
+	return BesselI0(KAISER_ALPHA * std::sqrt(1.0f - t * t)) / BesselI0(KAISER_ALPHA);
+}
+
+// Works out which texels of the larger level contribute to each texel of the smaller one along one axis, and by how much
+static FilterKernel BuildKernel(uint32_t sourceSize, uint32_t destSize, MipFilter filter, bool wrapEdges) {
+	FilterKernel kernel;
+	const float scale = static_cast<float>(sourceSize) / destSize;
+	auto addTap = [&](int index, float weight) {
+		if (weight == 0.0f) {
+			return;
+		}
+		const int size = static_cast<int>(sourceSize);
+		index = wrapEdges ? ((index % size) + size) % size : std::min(std::max(index, 0), size - 1);
+		kernel.Sources.push_back(static_cast<uint32_t>(index));
+		kernel.Weights.push_back(weight);
+	};
+
+	for (uint32_t ix = 0; ix < destSize; ix++) {
+		const size_t first = kernel.Weights.size();
+		kernel.Starts.push_back(static_cast<uint32_t>(first));
+
+		if (filter == MipFilter::Box) {
+			// Each texel covers [begin, end) of the larger level, partially covered texels get a partial weight
+			const float begin = ix * scale, end = (ix + 1) * scale;
+			for (int j = static_cast<int>(std::floor(begin)); j < static_cast<int>(std::ceil(end)); j++) {
+				addTap(j, std::min(end, j + 1.0f) - std::max(begin, static_cast<float>(j)));
+			}
+		} else {
+			// The filter is evaluated in texels of the smaller level, centered on the texel
+			const float center = (ix + 0.5f) * scale - 0.5f;
+			const float radius = KAISER_RADIUS * scale;
+			for (int j = static_cast<int>(std::ceil(center - radius)); j <= static_cast<int>(std::floor(center + radius)); j++) {
+				const float x = (j - center) / scale;
+				addTap(j, Sinc(x) * Kaiser(x / KAISER_RADIUS));
+			}
+		}
+
+		float total = 0.0f;
+		for (size_t tap = first; tap < kernel.Weights.size(); tap++) {
+			total += kernel.Weights[tap];
+		}
+		for (size_t tap = first; tap < kernel.Weights.size(); tap++) {
+			kernel.Weights[tap] /= total;
+		}
+	}
+	kernel.Starts.push_back(static_cast<uint32_t>(kernel.Weights.size()));
+	return kernel;
+}
+
+// Downsamples each row of an image, the result has the same number of rows
+static void FilterRows(const FloatImage& source, const FilterKernel& kernel, FloatImage& dest) {
+	JobSystem::ParallelFor(source.Height, 8, [&](size_t begin, size_t end) {
+		for (size_t y = begin; y < end; y++) {
+			const float* row = source.Texels.data() + y * source.Width * 4;
+			float* output = dest.Texels.data() + y * dest.Width * 4;
+			for (uint32_t x = 0; x < dest.Width; x++) {
+				#if TEXTURE_USE_SSE
+				__m128 sum = _mm_setzero_ps();
+				for (uint32_t tap = kernel.Starts[x]; tap < kernel.Starts[x + 1]; tap++) {
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel.Weights[tap]), _mm_loadu_ps(row + kernel.Sources[tap] * 4)));
+				}
+				_mm_storeu_ps(output + x * 4, sum);
+				#else
+				float sum[4] = { };
+				for (uint32_t tap = kernel.Starts[x]; tap < kernel.Starts[x + 1]; tap++) {
+					for (int c = 0; c < 4; c++) {
+						sum[c] += kernel.Weights[tap] * row[kernel.Sources[tap] * 4 + c];
+					}
+				}
+				memcpy(output + x * 4, sum, sizeof(sum));
+				#endif
+			}
+		}
+	});
+}
+
+// Downsamples each column of an image, by adding whole rows together. The result has the same number of columns
+static void FilterColumns(const FloatImage& source, const FilterKernel& kernel, FloatImage& dest) {
+	const size_t rowFloats = static_cast<size_t>(source.Width) * 4;
+	JobSystem::ParallelFor(dest.Height, 4, [&](size_t begin, size_t end) {
+		for (size_t y = begin; y < end; y++) {
+			float* output = dest.Texels.data() + y * rowFloats;
+			std::fill(output, output + rowFloats, 0.0f);
+			for (uint32_t tap = kernel.Starts[y]; tap < kernel.Starts[y + 1]; tap++) {
+				const float* row = source.Texels.data() + kernel.Sources[tap] * rowFloats;
+				const float weight = kernel.Weights[tap];
+				#if TEXTURE_USE_SSE
+				const __m128 w = _mm_set1_ps(weight);
+				for (size_t ix = 0; ix < rowFloats; ix += 4) {
+					_mm_storeu_ps(output + ix, _mm_add_ps(_mm_loadu_ps(output + ix), _mm_mul_ps(w, _mm_loadu_ps(row + ix))));
+				}
+				#else
+				for (size_t ix = 0; ix < rowFloats; ix++) {
+					output[ix] += weight * row[ix];
+				}
+				#endif
+			}
+		}
+	});
+}
+
+static FloatImage ToFloat(const TextureImage& image, bool isSrgb) {
+	FloatImage result(image.Width, image.Height);
+	const SrgbTables& srgb = GetSrgbTables();
+	JobSystem::ParallelFor(image.Height, 16, [&](size_t begin, size_t end) {
+		for (size_t y = begin; y < end; y++) {
+			for (size_t x = 0; x < image.Width; x++) {
+				const size_t texel = y * image.Width + x;
+				for (uint32_t c = 0; c < 4; c++) {
+					const uint8_t value = c < image.Channels ? image.Pixels[texel * image.Channels + c] : (c == 3 ? 255 : 0);
+					result.Texels[texel * 4 + c] = isSrgb && c < 3 ? srgb.ToLinear[value] : value / 255.0f;
+				}
+			}
+		}
+	});
+	return result;
+}
+
+static TextureImage ToImage(const FloatImage& image, uint32_t channels, bool isSrgb) {
+	TextureImage result;
+	result.Width = image.Width;
+	result.Height = image.Height;
+	result.Channels = channels;
+	result.Pixels.resize(static_cast<size_t>(image.Width) * image.Height * channels);
+	const SrgbTables& srgb = GetSrgbTables();
+	JobSystem::ParallelFor(image.Height, 16, [&](size_t begin, size_t end) {
+		for (size_t y = begin; y < end; y++) {
+			for (size_t x = 0; x < image.Width; x++) {
+				const size_t texel = y * image.Width + x;
+				for (uint32_t c = 0; c < channels; c++) {
+					const float value = std::min(std::max(image.Texels[texel * 4 + c], 0.0f), 1.0f);
+					result.Pixels[texel * channels + c] = isSrgb && c < 3 ? srgb.Encode(value) : static_cast<uint8_t>(value * 255.0f + 0.5f);
+				}
+			}
+		}
+	});
+	return result;
+}
+
+// Filtering shortens normals, so we bring them back to unit length
+static void Renormalize(FloatImage& image) {
+	for (size_t ix = 0; ix < image.Texels.size(); ix += 4) {
+		float* texel = &image.Texels[ix];
+		const float x = texel[0] * 2.0f - 1.0f, y = texel[1] * 2.0f - 1.0f, z = texel[2] * 2.0f - 1.0f;
+		const float length = std::sqrt(x * x + y * y + z * z);
+		if (length > 1.0e-6f) {
+			texel[0] = x / length * 0.5f + 0.5f;
+			texel[1] = y / length * 0.5f + 0.5f;
+			texel[2] = z / length * 0.5f + 0.5f;
+		}
+	}
+}
+
+TextureImage TextureBaker::FromData(const Texture2DData& data) {
+	LOG_ASSERT(!data.IsCompressed() && data.GetPixelType() == PixelType::UByte, "Only 8 bit uncompressed data can be baked");
+	const uint32_t sourceChannels = static_cast<uint32_t>(GetTexelComponentCount(data.GetFormat()));
+
+	TextureImage result;
+	result.Width = data.GetWidth();
+	result.Height = data.GetHeight();
+	result.Channels = sourceChannels == 3 ? 4 : sourceChannels;
+	const size_t texelCount = static_cast<size_t>(result.Width) * result.Height;
+	const uint8_t* source = static_cast<const uint8_t*>(data.GetDataPtr());
+	if (sourceChannels == result.Channels) {
+		result.Pixels.assign(source, source + texelCount * sourceChannels);
+	} else {
+		result.Pixels.resize(texelCount * 4);
+		for (size_t ix = 0; ix < texelCount; ix++) {
+			memcpy(&result.Pixels[ix * 4], source + ix * 3, 3);
+			result.Pixels[ix * 4 + 3] = 255;
+		}
+	}
+	return result;
+}
+
+std::vector<TextureImage> TextureBaker::GenerateMips(const TextureImage& image, MipFilter filter, TextureColorSpace colorSpace, bool wrapEdges) {
+	LOG_ASSERT(colorSpace != TextureColorSpace::Auto, "The color space must be resolved before generating mips");
+	const bool isSrgb = colorSpace == TextureColorSpace::SRGB;
+	const bool isNormalMap = colorSpace == TextureColorSpace::NormalMap && image.Channels >= 3;
+
+	std::vector<TextureImage> levels;
+	levels.reserve(GetMipLevelCount(image.Width, image.Height));
+	levels.push_back(image);
+
+	// Each level is filtered from the float version of the level above it, so rounding errors don't build up
+	FloatImage current = ToFloat(image, isSrgb);
+	while (current.Width > 1 || current.Height > 1) {
+		const uint32_t width = std::max(current.Width / 2, 1u);
+		const uint32_t height = std::max(current.Height / 2, 1u);
+
+		FloatImage rows(width, current.Height);
+		FilterRows(current, BuildKernel(current.Width, width, filter, wrapEdges), rows);
+		FloatImage next(width, height);
+		FilterColumns(rows, BuildKernel(current.Height, height, filter, wrapEdges), next);
+		if (isNormalMap) {
+			Renormalize(next);
+		}
+
+		levels.push_back(ToImage(next, image.Channels, isSrgb));
+		current = std::move(next);
+	}
+	return levels;
+}
+
+TextureColorSpace TextureBaker::ResolveColorSpace(TextureColorSpace colorSpace, const std::string& name, uint32_t channels) {
+	if (colorSpace != TextureColorSpace::Auto) {
+		return colorSpace;
+	}
+	if (channels < 3) {
+		return TextureColorSpace::Linear;
+	}
+	std::string fileName = std::filesystem::path(name).filename().string();
+	std::transform(fileName.begin(), fileName.end(), fileName.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	return fileName.find("normal") != std::string::npos ? TextureColorSpace::NormalMap : TextureColorSpace::SRGB;
+}
+
+TextureCompression TextureBaker::ChooseCompression(const TextureImage& image, TextureColorSpace colorSpace) {
+	if (image.Width % 4 != 0 || image.Height % 4 != 0) {
+		return TextureCompression::None;
+	}
+	switch (image.Channels) {
+		case 1: return TextureCompression::BC4;
+		case 2: return TextureCompression::BC5;
+		default: break;
+	}
+	// BC1 squashes normals too much, so they always get BC7
+	if (colorSpace == TextureColorSpace::NormalMap) {
+		return TextureCompression::BC7;
+	}
+	for (size_t ix = 3; ix < image.Pixels.size(); ix += 4) {
+		if (image.Pixels[ix] != 255) {
+			return TextureCompression::BC7;
+		}
+	}
+	return TextureCompression::BC1;
+}
+
+InternalFormat TextureBaker::GetFormat(TextureCompression compression, uint32_t channels) {
+	switch (compression) {
+		case TextureCompression::BC1: return InternalFormat::BC1;
+		case TextureCompression::BC3: return InternalFormat::BC3;
+		case TextureCompression::BC4: return InternalFormat::BC4;
+		case TextureCompression::BC5: return InternalFormat::BC5;
+		case TextureCompression::BC7: return InternalFormat::BC7;
+		default:
+			return channels == 1 ? InternalFormat::R8 : channels == 2 ? InternalFormat::RG8 : InternalFormat::RGBA8;
+	}
+}
+
+TextureBakeResult TextureBaker::Bake(const TextureImage& image, const TextureBakeSettings& settings, const std::string& name) {
+	const TextureColorSpace colorSpace = ResolveColorSpace(settings.ColorSpace, name, image.Channels);
+	const TextureCompression compression = settings.Compression == TextureCompression::Auto ?
+		ChooseCompression(image, colorSpace) : settings.Compression;
+
+	std::vector<TextureImage> levels;
+	if (settings.GenerateMips) {
+		levels = GenerateMips(image, settings.Filter, colorSpace, settings.WrapEdges);
+	} else {
+		levels.push_back(image);
+	}
+
+	TextureBakeResult result;
+	result.Format = GetFormat(compression, image.Channels);
+	size_t offset = 0;
+	for (const TextureImage& level : levels) {
+		const size_t size = GetLevelSize(result.Format, level.Width, level.Height);
+		result.Levels.push_back({ level.Width, level.Height, offset, size });
+		offset += size;
+	}
+	result.Data.resize(offset);
+
+	for (size_t ix = 0; ix < levels.size(); ix++) {
+		const TextureImage& level = levels[ix];
+		uint8_t* output = result.Data.data() + result.Levels[ix].Offset;
+		if (IsCompressed(result.Format)) {
+			BlockCompressor::Compress(level.Pixels.data(), level.Width, level.Height, level.Channels, result.Format, output);
+		} else {
+			memcpy(output, level.Pixels.data(), level.Pixels.size());
+		}
+	}
+
+	LOG_TRACE("Baked \"{}\" as {} with {} levels ({:.1f} KB)", name, result.Format, result.Levels.size(), result.Data.size() / 1024.0f);
+	return result;
+}
+
+TextureBakeResult TextureBaker::BakeArray(const std::vector<TextureImage>& images, const TextureBakeSettings& settings, const std::vector<std::string>& names) {
+	if (images.empty()) {
+		throw std::runtime_error("A texture array needs at least one layer");
+	}
+	uint32_t width = images[0].Width, height = images[0].Height;
+	for (const TextureImage& image : images) {
+		if (image.Channels != images[0].Channels) {
+			throw std::runtime_error("All the layers of a texture array need the same number of channels");
+		}
+		width = std::min(width, image.Width);
+		height = std::min(height, image.Height);
+	}
+
+	// Reduce each layer to the common size, and work out which format fits each of them
+	std::vector<TextureImage> layers;
+	std::vector<TextureColorSpace> colorSpaces;
+	layers.reserve(images.size());
+	TextureCompression compression = settings.Compression;
+	for (size_t ix = 0; ix < images.size(); ix++) {
+		const TextureImage& image = images[ix];
+		const std::string name = ix < names.size() ? names[ix] : "";
+		uint32_t level = 0;
+		while ((image.Width >> level) > width && (image.Height >> level) > height) {
+			level++;
+		}
+		if ((image.Width >> level) != width || (image.Height >> level) != height ||
+			(image.Width >> level << level) != image.Width || (image.Height >> level << level) != image.Height) {
+			throw std::runtime_error(fmt::format("Layer \"{}\" is {}x{}, which can't be halved down to {}x{}", name, image.Width, image.Height, width, height));
+		}
+		colorSpaces.push_back(ResolveColorSpace(settings.ColorSpace, name, image.Channels));
+		layers.push_back(level == 0 ? image : GenerateMips(image, settings.Filter, colorSpaces.back(), settings.WrapEdges)[level]);
+
+		if (settings.Compression == TextureCompression::Auto) {
+			const TextureCompression choice = ChooseCompression(layers.back(), colorSpaces.back());
+			// Every choice for the same channel count is a subset of BC7, except for leaving the layer uncompressed
+			if (ix == 0 || choice == TextureCompression::None) {
+				compression = choice;
+			} else if (choice != compression && compression != TextureCompression::None) {
+				compression = TextureCompression::BC7;
+			}
+		}
+	}
+
+	TextureBakeResult result;
+	result.Layers = static_cast<uint32_t>(layers.size());
+	for (size_t ix = 0; ix < layers.size(); ix++) {
+		TextureBakeSettings layerSettings = settings;
+		layerSettings.Compression = compression;
+		layerSettings.ColorSpace = colorSpaces[ix];
+		TextureBakeResult layer = Bake(layers[ix], layerSettings, ix < names.size() ? names[ix] : "");
+		if (ix == 0) {
+			result.Format = layer.Format;
+			result.Levels = layer.Levels;
+		}
+		result.Data.insert(result.Data.end(), layer.Data.begin(), layer.Data.end());
+	}
+	return result;
+}
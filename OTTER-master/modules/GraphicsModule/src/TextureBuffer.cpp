@@ -0,0 +1,33 @@
+#include "TextureBuffer.h"
+
+TextureBuffer::TextureBuffer(GLenum format) :
+	ITexture(),
+	_format(format),
+	_buffer(0),
+	_size(0)
+{
+	glCreateTextures(GL_TEXTURE_BUFFER, 1, &_handle);
+}
+
+TextureBuffer::~TextureBuffer() {
+	if (_buffer != 0) {
+		glDeleteBuffers(1, &_buffer);
+		_buffer = 0;
+	}
+}
+
+void TextureBuffer::LoadData(const void* data, size_t size) {
+	// Buffer storage is immutable, so if we're loading new data we need a new buffer
+	if (_buffer != 0) {
+		glDeleteBuffers(1, &_buffer);
+		_buffer = 0;
+	}
+	_size = size;
+	if (size == 0) {
+		return;
+	}
+
+	glCreateBuffers(1, &_buffer);
+	glNamedBufferStorage(_buffer, (GLsizeiptr)size, data, 0);
+	glTextureBuffer(_handle, _format, _buffer);
+}
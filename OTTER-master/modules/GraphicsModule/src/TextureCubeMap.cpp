@@ -1,5 +1,7 @@
 #include "TextureCubeMap.h"
 
+#include "RenderState.h"
+
 TextureCubeMap::TextureCubeMap(const TextureCubeDesc& description) :
 	ITexture(), _description(description)
 {
@@ -9,6 +11,7 @@ TextureCubeMap::TextureCubeMap(const TextureCubeDesc& description) :
 
 void TextureCubeMap::_RecreateTexture() {
 	if (_handle != 0) {
+		RenderState::ForgetTexture(_handle);
 		glDeleteTextures(1, &_handle);
 		_handle = 0;
 	}
@@ -1,5 +1,6 @@
 #include "TextureCubeMapData.h"
 #include <filesystem>
+#include "JobSystem.h"
 
 TextureCubeMapData::TextureCubeMapData(uint32_t size, PixelFormat format, PixelType type, void* sourceData, InternalFormat recommendedFormat) :
 	_size(size), _format(format), _type(type), _data(nullptr), _recommendedFormat(recommendedFormat) {
@@ -37,13 +38,33 @@ TextureCubeMapData::sptr TextureCubeMapData::CreateFromImages(const std::vector<
 }
 
 TextureCubeMapData::sptr TextureCubeMapData::LoadFromImages(const std::string& rootImagePath) {
+	// Decoding the images is by far the slowest part, and each face is independent, so we decode them all at once.
+	// Wait runs other jobs while it waits, so this is safe to call from inside of a job
+	std::vector<Texture2DData::sptr> data;
+	data.resize(6);
+	JobCounter::sptr counter = JobCounter::Create();
+	for(int ix = 0; ix < 6; ix++) {
+		const std::string imagePath = GetFacePath(rootImagePath, (CubeMapFace)ix);
+		Texture2DData::sptr& face = data[ix];
+		JobSystem::Run([imagePath, &face]() {
+			if (std::filesystem::exists(imagePath)) {
+				face = Texture2DData::LoadFromFile(imagePath);
+			} else {
+				LOG_WARN("Image \"{}\" could not be found!", imagePath);
+			}
+		}, counter);
+	}
+	JobSystem::Wait(counter);
+
+	return CreateFromImages(data);
+}
+
+std::string TextureCubeMapData::GetFacePath(const std::string& rootImagePath, CubeMapFace face) {
 	namespace fs = std::filesystem;
 	fs::path imagePath = fs::path(rootImagePath);
-	fs::path directory = imagePath.parent_path();
-	fs::path rootFile  = directory / imagePath.stem();
-	fs::path extension = imagePath.extension();
+	fs::path result    = imagePath.parent_path() / imagePath.stem();
 
-	const std::string PATHS[6] = {
+	static const char* const PATHS[6] = {
 		"_pos_x",
 		"_neg_x",
 		"_pos_y",
@@ -52,22 +73,9 @@ TextureCubeMapData::sptr TextureCubeMapData::LoadFromImages(const std::string& r
 		"_neg_z"
 	};
 
-	std::vector<Texture2DData::sptr> data;
-	data.resize(6);
-
-	for(int ix = 0; ix < 6; ix++) {
-		fs::path imagePath = rootFile;
-		imagePath += PATHS[ix];
-		imagePath += extension;
-		if (fs::exists(imagePath)) {
-			data[ix] = Texture2DData::LoadFromFile(imagePath.string());
-		}
-		else {
-			LOG_WARN("Image \"{}\" could not be found!", imagePath.string());
-		}
-	}
-
-	return CreateFromImages(data);
+	result += PATHS[(int)face];
+	result += imagePath.extension();
+	return result.string();
 }
 
 void TextureCubeMapData::LoadFaceData(const Texture2DData::sptr& data, CubeMapFace face) {
@@ -5,45 +5,104 @@
 #include <GLM/gtx/quaternion.hpp>
 
 #include "Logging.h"
+#include "TransformSystem.h"
 
-const glm::mat4 IDENTITY = glm::mat4(1.0f);
+Transform::Transform(entt::handle gameObject) :
+	_system(TransformSystem::Get(gameObject.registry())),
+	_slot(TransformSystem::INVALID),
+	_gameObject(gameObject)
+{
+	_slot = _system->Allocate(gameObject.entity());
+}
+
+Transform::Transform(const Transform& other) :
+	_system(other._system),
+	_slot(TransformSystem::INVALID),
+	_gameObject(other._gameObject)
+{
+	_slot = _system->Allocate(_gameObject.entity());
+	*this = other;
+}
+
+Transform::Transform(Transform&& other) noexcept :
+	_system(std::move(other._system)),
+	_slot(other._slot),
+	_gameObject(other._gameObject)
+{
+	other._slot = TransformSystem::INVALID;
+}
+
+Transform& Transform::operator=(const Transform& other) {
+	if (this == &other) {
+		return *this;
+	}
+	SetLocalPosition(other.GetLocalPosition());
+	SetLocalScale(other.GetLocalScale());
+	_system->SetRotation(_slot, other.GetLocalRotationQuat(), other.GetLocalRotation());
+	// We can only share a parent if we are in the same scene
+	if (_system == other._system) {
+		_system->SetParent(_slot, _system->GetParent(other._slot));
+	}
+	return *this;
+}
+
+Transform& Transform::operator=(Transform&& other) noexcept {
+	if (this != &other) {
+		if (_system != nullptr && _slot != TransformSystem::INVALID) {
+			_system->Free(_slot);
+		}
+		_system = std::move(other._system);
+		_slot = other._slot;
+		_gameObject = other._gameObject;
+		other._slot = TransformSystem::INVALID;
+	}
+	return *this;
+}
+
+Transform::~Transform() {
+	if (_system != nullptr && _slot != TransformSystem::INVALID) {
+		_system->Free(_slot);
+	}
+}
+
+const glm::vec3& Transform::GetLocalRotation() const {
+	return _system->GetRotationEuler(_slot);
+}
+
+const glm::quat& Transform::GetLocalRotationQuat() const {
+	return _system->GetRotation(_slot);
+}
+
+const glm::vec3& Transform::GetLocalPosition() const {
+	return _system->GetPosition(_slot);
+}
+
+const glm::vec3& Transform::GetLocalScale() const {
+	return _system->GetScale(_slot);
+}
 
 Transform& Transform::SetLocalRotation(const glm::vec3 eulerDegrees) {
-	_rotationEulerDeg = eulerDegrees;
-	_rotation = glm::quat(glm::radians(eulerDegrees));
-	_isLocalDirty = true;
+	_system->SetRotation(_slot, glm::quat(glm::radians(eulerDegrees)), eulerDegrees);
 	return *this;
 }
 
 Transform& Transform::SetLocalRotation(const glm::quat& quaternion) {
-	_rotation = quaternion;
-	_rotationEulerDeg = glm::degrees(glm::eulerAngles(_rotation));
-	_isLocalDirty = true;
+	_system->SetRotation(_slot, quaternion, glm::degrees(glm::eulerAngles(quaternion)));
 	return *this;
 }
 
 Transform& Transform::SetLocalRotation(float yawDeg, float pitchDeg, float rollDeg) {
-	_rotationEulerDeg.x = yawDeg;
-	_rotationEulerDeg.y = pitchDeg;
-	_rotationEulerDeg.z = rollDeg;
-	_rotation = glm::quat(glm::radians(_rotationEulerDeg));
-	_isLocalDirty = true;
+	SetLocalRotation(glm::vec3(yawDeg, pitchDeg, rollDeg));
 	return *this;
 }
 
 Transform& Transform::SetLocalPosition(float x, float y, float z) {
-	_position.x = x;
-	_position.y = y;
-	_position.z = z;
-	_isLocalDirty = true;
+	_system->SetPosition(_slot, glm::vec3(x, y, z));
 	return *this;
 }
 
 Transform& Transform::SetLocalScale(float x, float y, float z) {
-	_scale.x = x;
-	_scale.y = y;
-	_scale.z = z;
-	_isLocalDirty = true;
+	_system->SetScale(_slot, glm::vec3(x, y, z));
 	return *this;
 }
 
@@ -53,9 +112,7 @@ Transform& Transform::RotateLocal(float yawDeg, float pitchDeg, float rollDeg) {
 }
 
 Transform& Transform::RotateLocalFixed(const glm::vec3& rotationDeg) {
-	_rotation = glm::quat(glm::radians(rotationDeg)) * _rotation;
-	_rotationEulerDeg = glm::degrees(glm::eulerAngles(_rotation));
-	_isLocalDirty = true;
+	SetLocalRotation(glm::quat(glm::radians(rotationDeg)) * GetLocalRotationQuat());
 	return *this;
 }
 
@@ -65,28 +122,23 @@ Transform& Transform::RotateLocalFixed(float yawDeg, float pitchDeg, float rollD
 }
 
 Transform& Transform::SetLocalPosition(const glm::vec3 value) {
-	_position = value;
-	_isLocalDirty = true;
+	_system->SetPosition(_slot, value);
 	return *this;
 }
 
 Transform& Transform::SetLocalScale(const glm::vec3 value) {
-	_scale = value;
-	_isLocalDirty = true;
+	_system->SetScale(_slot, value);
 	return *this;
 }
 
 Transform& Transform::RotateLocal(const glm::vec3& rotation) {
-	_rotation = _rotation * glm::quat(glm::radians(rotation));
-	_rotationEulerDeg = glm::degrees(glm::eulerAngles(_rotation));
-	_isLocalDirty = true;
+	SetLocalRotation(GetLocalRotationQuat() * glm::quat(glm::radians(rotation)));
 	return *this;
 }
 
 Transform& Transform::MoveLocal(const glm::vec3& localMovement)
 {
-	_position += _rotation * localMovement;
-	_isLocalDirty = true;
+	_system->SetPosition(_slot, GetLocalPosition() + GetLocalRotationQuat() * localMovement);
 	return *this;
 }
 
@@ -97,81 +149,58 @@ Transform& Transform::MoveLocal(float x, float y, float z) {
 
 Transform& Transform::MoveLocalFixed(const glm::vec3& localMovement)
 {
-	_position += localMovement;
-	_isLocalDirty = true;
+	_system->SetPosition(_slot, GetLocalPosition() + localMovement);
 	return *this;
 }
 
 Transform& Transform::MoveLocalFixed(float x, float y, float z) {
-	_position.x += x;
-	_position.y += y;
-	_position.z += z;
-	_isLocalDirty = true;
+	MoveLocalFixed(glm::vec3(x, y, z));
 	return *this;
 }
 
 Transform& Transform::LookAt(const glm::vec3& localSpace)
 {
-	_rotation = glm::quatLookAt(-glm::normalize(_position - localSpace), glm::normalize(_rotation * glm::vec3(0, 0, 1)));
-	_rotationEulerDeg = glm::degrees(glm::eulerAngles(_rotation));
-	_isLocalDirty = true;
+	const glm::vec3& position = GetLocalPosition();
+	SetLocalRotation(glm::quatLookAt(-glm::normalize(position - localSpace), glm::normalize(GetLocalRotationQuat() * glm::vec3(0, 0, 1))));
 	return *this;
 }
 
 void Transform::Recalculate() const {
-	_UpdateLocalTransformIfDirty();
+	_system->GetLocalMatrix(_slot);
 }
 
 const glm::mat4& Transform::LocalTransform() const {
-	_UpdateLocalTransformIfDirty();
-	return _localTransform;
+	return _system->GetLocalMatrix(_slot);
 }
 
-const glm::mat3& Transform::NormalMatrix() const {
-	_UpdateLocalTransformIfDirty();
-	return _normalMatrix;	
+glm::mat3 Transform::NormalMatrix() const {
+	return _system->GetLocalNormalMatrix(_slot);
 }
 
 void Transform::SetParent(entt::handle parent)
 {
-	_parent = parent;
 	// If we passed in a handle, make sure it has a transform and belongs to the same scene
 	if (&parent.registry() != nullptr && parent.entity() != entt::null) {
 		LOG_ASSERT(parent.has<Transform>(), "Parent entity must have a transform component");
 		LOG_ASSERT(&parent.registry() == &_gameObject.registry(), "Parent entity must be in same registry!");
-		_hierarchyDepth = parent.get<Transform>()._hierarchyDepth + 1;
+		_system->SetParent(_slot, parent.get<Transform>()._slot);
 	} else {
-		_hierarchyDepth = 0;
+		_system->SetParent(_slot, TransformSystem::INVALID);
 	}
-	
-	// Re-calculate hierarchy depth for all children recursively
-	_gameObject.registry().view<Transform>().each([&](entt::entity entity, Transform& t) {
-		if (t._parent == _gameObject) {
-			t.SetParent(entt::handle(parent.registry(), _gameObject));
-		}
-	});
-	// Re-sort components
-	_gameObject.registry().sort<Transform>([](const Transform& l, const Transform& r) {
-		return l.GetHierarchyDepth() < r.GetHierarchyDepth();
-	});
 }
 
 void Transform::UpdateWorldMatrix() const {
-	if (_parent != entt::null) {
-		_worldTransform = _gameObject.registry().get<Transform>(_parent)._worldTransform * LocalTransform();
-		_worldNormalMatrix = glm::mat3(glm::transpose(glm::inverse(_worldTransform)));
-	} else {
-		_worldTransform = LocalTransform();
-		_worldNormalMatrix = _normalMatrix;
-	}
+	_system->UpdateSingle(_slot);
 }
 
-void Transform::_UpdateLocalTransformIfDirty() const {
-	if (_isLocalDirty) {
-		// TRS
-		_localTransform = glm::translate(IDENTITY, _position) * glm::toMat4(_rotation) * glm::scale(IDENTITY, _scale);
-		_normalMatrix = glm::mat3(glm::transpose(glm::inverse(_localTransform)));
+const glm::mat4& Transform::WorldTransform() const {
+	return _system->GetWorldMatrix(_slot);
+}
 
-		_isLocalDirty = false;
-	}
+const glm::mat3& Transform::WorldNormalMatrix() const {
+	return _system->GetWorldNormalMatrix(_slot);
+}
+
+int Transform::GetHierarchyDepth() const {
+	return _system->GetDepth(_slot);
 }
@@ -0,0 +1,369 @@
+#include "TransformSystem.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "Logging.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+// How close the scale axes need to be for us to treat the scale as uniform
+const float UNIFORM_SCALE_EPSILON = 1.0e-5f;
+
+// Returns the square of the scale if it is uniform, or 0 if it is not
+inline float UniformScaleSq(const glm::vec3& scale) {
+	const float tolerance = UNIFORM_SCALE_EPSILON * std::abs(scale.x);
+	if (std::abs(scale.x - scale.y) <= tolerance && std::abs(scale.x - scale.z) <= tolerance) {
+		return scale.x * scale.x;
+	}
+	return 0.0f;
+}
+
+// Calculates the normal matrix for a transform. With a uniform scale s, the matrix is R * s, and it's inverse
+// transpose is R / s, so we can just divide by s^2 instead of doing a full inverse
+inline glm::mat3 NormalMatrix(const glm::mat4& transform, float scaleSq) {
+	if (scaleSq > 0.0f) {
+		return glm::mat3(transform) * (1.0f / scaleSq);
+	}
+	return glm::transpose(glm::inverse(glm::mat3(transform)));
+}
+
+// TRS, but we apply the scale and translation directly to the rotation matrix rather than multiplying
+inline glm::mat4 ComposeLocal(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+	glm::mat4 result = glm::mat4_cast(rotation);
+	result[0] *= scale.x;
+	result[1] *= scale.y;
+	result[2] *= scale.z;
+	result[3] = glm::vec4(position, 1.0f);
+	return result;
+}
+
+TransformSystem::TransformSystem() :
+	_inFixedStep(false), _alpha(1.0f), _lastUpdateCount(0)
+{ }
+
+const TransformSystem::sptr& TransformSystem::Get(entt::registry& registry)
+{
+	sptr* result = registry.try_ctx<sptr>();
+	if (result == nullptr) {
+		result = &registry.set<sptr>(Create());
+	}
+	return *result;
+}
+
+uint32_t TransformSystem::Allocate(entt::entity entity)
+{
+	uint32_t slot;
+	if (!_freeSlots.empty()) {
+		slot = _freeSlots.back();
+		_freeSlots.pop_back();
+	} else {
+		slot = static_cast<uint32_t>(_entities.size());
+		_positions.emplace_back();
+		_rotations.emplace_back();
+		_rotationsEuler.emplace_back();
+		_scales.emplace_back();
+		_locals.emplace_back();
+		_prevPositions.emplace_back();
+		_prevRotations.emplace_back();
+		_prevScales.emplace_back();
+		_interpolated.emplace_back();
+		_worlds.emplace_back();
+		_worldNormals.emplace_back();
+		_worldScalesSq.emplace_back();
+		_localDirty.emplace_back();
+		_worldDirty.emplace_back();
+		_changed.emplace_back();
+		_parents.emplace_back();
+		_firstChildren.emplace_back();
+		_nextSiblings.emplace_back();
+		_prevSiblings.emplace_back();
+		_depths.emplace_back();
+		_levelIndices.emplace_back();
+		_entities.emplace_back();
+	}
+
+	_positions[slot]      = glm::vec3(0.0f);
+	_rotations[slot]      = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	_rotationsEuler[slot] = glm::vec3(0.0f);
+	_scales[slot]         = glm::vec3(1.0f);
+	_locals[slot]         = glm::mat4(1.0f);
+	_prevPositions[slot]  = glm::vec3(0.0f);
+	_prevRotations[slot]  = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	_prevScales[slot]     = glm::vec3(1.0f);
+	_interpolated[slot]   = 0;
+	_worlds[slot]         = glm::mat4(1.0f);
+	_worldNormals[slot]   = glm::mat3(1.0f);
+	_worldScalesSq[slot]  = 1.0f;
+	_localDirty[slot]     = 0;
+	_worldDirty[slot]     = 0;
+	_changed[slot]        = 0;
+	_parents[slot]        = INVALID;
+	_firstChildren[slot]  = INVALID;
+	_nextSiblings[slot]   = INVALID;
+	_prevSiblings[slot]   = INVALID;
+	_entities[slot]       = entity;
+	_AddToLevel(slot, 0);
+
+	return slot;
+}
+
+void TransformSystem::Reserve(size_t count)
+{
+	_positions.reserve(count);
+	_rotations.reserve(count);
+	_rotationsEuler.reserve(count);
+	_scales.reserve(count);
+	_locals.reserve(count);
+	_prevPositions.reserve(count);
+	_prevRotations.reserve(count);
+	_prevScales.reserve(count);
+	_interpolated.reserve(count);
+	_worlds.reserve(count);
+	_worldNormals.reserve(count);
+	_worldScalesSq.reserve(count);
+	_localDirty.reserve(count);
+	_worldDirty.reserve(count);
+	_changed.reserve(count);
+	_parents.reserve(count);
+	_firstChildren.reserve(count);
+	_nextSiblings.reserve(count);
+	_prevSiblings.reserve(count);
+	_depths.reserve(count);
+	_levelIndices.reserve(count);
+	_entities.reserve(count);
+	// New transforms start out as roots
+	if (_levels.empty()) {
+		_levels.emplace_back();
+	}
+	_levels[0].reserve(count);
+}
+
+void TransformSystem::Free(uint32_t slot)
+{
+	// Any children become roots, keeping their local transforms
+	while (_firstChildren[slot] != INVALID) {
+		SetParent(_firstChildren[slot], INVALID);
+	}
+	if (_parents[slot] != INVALID) {
+		_UnlinkChild(slot);
+		_parents[slot] = INVALID;
+	}
+
+	_RemoveFromLevel(slot);
+	_entities[slot] = entt::null;
+	_freeSlots.push_back(slot);
+}
+
+void TransformSystem::SetParent(uint32_t slot, uint32_t parent)
+{
+	if (_parents[slot] == parent) {
+		return;
+	}
+	// Make sure we aren't about to create a loop
+	for (uint32_t ancestor = parent; ancestor != INVALID; ancestor = _parents[ancestor]) {
+		LOG_ASSERT(ancestor != slot, "A transform cannot be parented to itself or one of it's children");
+	}
+
+	if (_parents[slot] != INVALID) {
+		_UnlinkChild(slot);
+	}
+	_parents[slot] = parent;
+	if (parent != INVALID) {
+		_LinkChild(slot, parent);
+	}
+
+	_SetDepth(slot, parent != INVALID ? _depths[parent] + 1 : 0);
+	_worldDirty[slot] = 1;
+}
+
+const glm::mat4& TransformSystem::GetLocalMatrix(uint32_t slot)
+{
+	_UpdateLocal(slot);
+	return _locals[slot];
+}
+
+glm::mat3 TransformSystem::GetLocalNormalMatrix(uint32_t slot)
+{
+	_UpdateLocal(slot);
+	return NormalMatrix(_locals[slot], UniformScaleSq(_scales[slot]));
+}
+
+void TransformSystem::Update(bool parallel)
+{
+	PROFILE_SCOPE("TransformSystem::Update");
+	_lastUpdateCount = 0;
+
+	for (const std::vector<uint32_t>& level : _levels) {
+		auto updateRange = [&](size_t begin, size_t end) {
+			size_t updated = 0;
+			for (size_t ix = begin; ix < end; ix++) {
+				updated += _UpdateWorld(level[ix]) ? 1 : 0;
+			}
+			_lastUpdateCount += updated;
+		};
+
+		// Every transform in this level only reads from the level above, so they can all be updated at the same time
+		if (parallel && level.size() >= PARALLEL_CHUNK_SIZE * 2) {
+			JobSystem::ParallelFor(level.size(), PARALLEL_CHUNK_SIZE, updateRange);
+		} else {
+			updateRange(0, level.size());
+		}
+	}
+}
+
+void TransformSystem::BeginFixedStep()
+{
+	// Anything that was part way through moving needs one more update to land exactly on it's current state
+	const size_t count = _interpolated.size();
+	for (size_t slot = 0; slot < count; slot++) {
+		if (_interpolated[slot]) {
+			_worldDirty[slot] = 1;
+			_interpolated[slot] = 0;
+		}
+	}
+	_prevPositions = _positions;
+	_prevRotations = _rotations;
+	_prevScales = _scales;
+	_inFixedStep = true;
+}
+
+void TransformSystem::SetInterpolation(float alpha)
+{
+	_alpha = glm::clamp(alpha, 0.0f, 1.0f);
+}
+
+void TransformSystem::UpdateSingle(uint32_t slot)
+{
+	// We leave the transform marked as dirty, so that it's children still pick up the change in the next Update
+	_CalculateWorld(slot);
+}
+
+void TransformSystem::_LinkChild(uint32_t slot, uint32_t parent)
+{
+	const uint32_t next = _firstChildren[parent];
+	_prevSiblings[slot] = INVALID;
+	_nextSiblings[slot] = next;
+	if (next != INVALID) {
+		_prevSiblings[next] = slot;
+	}
+	_firstChildren[parent] = slot;
+}
+
+void TransformSystem::_UnlinkChild(uint32_t slot)
+{
+	const uint32_t prev = _prevSiblings[slot];
+	const uint32_t next = _nextSiblings[slot];
+	if (prev != INVALID) {
+		_nextSiblings[prev] = next;
+	} else {
+		_firstChildren[_parents[slot]] = next;
+	}
+	if (next != INVALID) {
+		_prevSiblings[next] = prev;
+	}
+	_prevSiblings[slot] = INVALID;
+	_nextSiblings[slot] = INVALID;
+}
+
+void TransformSystem::_SetDepth(uint32_t slot, int depth)
+{
+	const int delta = depth - _depths[slot];
+	if (delta == 0) {
+		return;
+	}
+
+	// The whole subtree moves by the same number of levels. We walk it with our own stack, since a long chain of
+	// transforms could overflow the call stack
+	_walkStack.clear();
+	_walkStack.push_back(slot);
+	while (!_walkStack.empty()) {
+		const uint32_t current = _walkStack.back();
+		_walkStack.pop_back();
+
+		const int newDepth = _depths[current] + delta;
+		_RemoveFromLevel(current);
+		_AddToLevel(current, newDepth);
+
+		for (uint32_t child = _firstChildren[current]; child != INVALID; child = _nextSiblings[child]) {
+			_walkStack.push_back(child);
+		}
+	}
+}
+
+void TransformSystem::_AddToLevel(uint32_t slot, int depth)
+{
+	if (_levels.size() <= (size_t)depth) {
+		_levels.resize(depth + 1);
+	}
+	_depths[slot] = depth;
+	_levelIndices[slot] = static_cast<uint32_t>(_levels[depth].size());
+	_levels[depth].push_back(slot);
+}
+
+void TransformSystem::_RemoveFromLevel(uint32_t slot)
+{
+	// Swap the last transform in the level into our place
+	std::vector<uint32_t>& level = _levels[_depths[slot]];
+	const uint32_t index = _levelIndices[slot];
+	const uint32_t last = level.back();
+	level[index] = last;
+	_levelIndices[last] = index;
+	level.pop_back();
+
+	// Trim any empty levels off the end, so we don't keep iterating over them
+	while (!_levels.empty() && _levels.back().empty()) {
+		_levels.pop_back();
+	}
+}
+
+bool TransformSystem::_UpdateWorld(uint32_t slot)
+{
+	const uint32_t parent = _parents[slot];
+	// Interpolated transforms change every frame, even when the simulation doesn't step
+	const bool needsUpdate = _worldDirty[slot] || _interpolated[slot] || (parent != INVALID && _changed[parent]);
+	_changed[slot] = needsUpdate ? 1 : 0;
+	if (!needsUpdate) {
+		return false;
+	}
+	_CalculateWorld(slot);
+	_worldDirty[slot] = 0;
+	return true;
+}
+
+void TransformSystem::_CalculateWorld(uint32_t slot)
+{
+	_UpdateLocal(slot);
+
+	// The cached local matrix always holds the current state, the blend between fixed states is only used for the
+	// world matrix
+	glm::mat4 interpolated;
+	const glm::mat4* local = &_locals[slot];
+	glm::vec3 scale = _scales[slot];
+	if (_interpolated[slot] && _alpha < 1.0f) {
+		scale = glm::mix(_prevScales[slot], _scales[slot], _alpha);
+		interpolated = ComposeLocal(glm::mix(_prevPositions[slot], _positions[slot], _alpha),
+			glm::slerp(_prevRotations[slot], _rotations[slot], _alpha), scale);
+		local = &interpolated;
+	}
+
+	const float localScaleSq = UniformScaleSq(scale);
+	const uint32_t parent = _parents[slot];
+	if (parent == INVALID) {
+		_worlds[slot] = *local;
+		_worldScalesSq[slot] = localScaleSq;
+	} else {
+		_worlds[slot] = _worlds[parent] * *local;
+		// A uniform scale stays uniform under any rotation, but a non-uniform parent scale will skew us
+		_worldScalesSq[slot] = _worldScalesSq[parent] * localScaleSq;
+	}
+	_worldNormals[slot] = NormalMatrix(_worlds[slot], _worldScalesSq[slot]);
+}
+
+void TransformSystem::_UpdateLocal(uint32_t slot)
+{
+	if (_localDirty[slot]) {
+		_locals[slot] = ComposeLocal(_positions[slot], _rotations[slot], _scales[slot]);
+		_localDirty[slot] = 0;
+	}
+}
@@ -1,12 +1,19 @@
 #include "VertexArrayObject.h"
 #include "IndexBuffer.h"
 #include "Logging.h"
+#include "RenderState.h"
 #include "VertexBuffer.h"
 
+#include <cstddef>
+#include <algorithm>
+
 VertexArrayObject::VertexArrayObject() :
 	_indexBuffer(nullptr),
 	_handle(0),
-	_vertexCount(0)
+	_vertexCount(0),
+	_vertexDecode(glm::mat4(1.0f)),
+	_hasVertexDecode(false),
+	_instanceBufferGeneration(0)
 {
 	glCreateVertexArrays(1, &_handle);
 }
@@ -14,6 +21,7 @@ VertexArrayObject::VertexArrayObject() :
 VertexArrayObject::~VertexArrayObject()
 {
 	if (_handle != 0) {
+		RenderState::ForgetVertexArray(_handle);
 		glDeleteVertexArrays(1, &_handle);
 		_handle = 0;
 	}
@@ -54,19 +62,89 @@ void VertexArrayObject::AddVertexBuffer(const VertexBuffer::sptr& buffer, const
 }
 
 void VertexArrayObject::Bind() const {
-	glBindVertexArray(_handle);
+	RenderState::BindVertexArray(_handle);
 }
 
 void VertexArrayObject::UnBind() {
-	glBindVertexArray(0);
+	RenderState::BindVertexArray(0);
+}
+
+size_t VertexArrayObject::GetGpuMemoryUsage() const {
+	size_t result = _indexBuffer != nullptr ? _indexBuffer->GetTotalSize() : 0;
+	for (const VertexBufferBinding& binding : _vertexBuffers) {
+		result += binding.Buffer->GetTotalSize();
+	}
+	return result;
+}
+
+uint32_t VertexArrayObject::GetTriangleCount(uint32_t lod) const {
+	if (!_lods.empty()) {
+		return _lods[std::min(lod, static_cast<uint32_t>(_lods.size() - 1))].IndexCount / 3;
+	}
+	return _indexBuffer != nullptr ? _indexBuffer->GetElementCount() / 3 : _vertexCount / 3;
+}
+
+// Gets the range of the index buffer to draw for a level of detail, as a count and byte offset
+inline void GetLodRange(const std::vector<MeshLod>& lods, const IndexBuffer& indices, uint32_t lod, GLsizei& count, const void*& offset) {
+	if (lods.empty()) {
+		count = indices.GetElementCount();
+		offset = nullptr;
+	} else {
+		const MeshLod& level = lods[std::min(lod, static_cast<uint32_t>(lods.size() - 1))];
+		count = static_cast<GLsizei>(level.IndexCount);
+		offset = reinterpret_cast<const void*>(static_cast<size_t>(level.IndexOffset) * indices.GetElementSize());
+	}
 }
 
-void VertexArrayObject::Render() const {
+void VertexArrayObject::Render(uint32_t lod) const {
 	Bind();
 	if (_indexBuffer != nullptr) {
-		glDrawElements(GL_TRIANGLES, _indexBuffer->GetElementCount(), _indexBuffer->GetElementType(), nullptr);
+		GLsizei count;
+		const void* offset;
+		GetLodRange(_lods, *_indexBuffer, lod, count, offset);
+		glDrawElements(GL_TRIANGLES, count, _indexBuffer->GetElementType(), offset);
 	} else {
-		glDrawArrays(GL_TRIANGLES, 0, _vertexCount / 3);
+		glDrawArrays(GL_TRIANGLES, 0, _vertexCount);
 	}
-	UnBind();
+	RenderState::CountDraw(GetTriangleCount(lod));
+}
+
+void VertexArrayObject::RenderInstanced(const InstanceBuffer& instances, uint32_t baseInstance, uint32_t count, uint32_t lod) const {
+	// Attach the instance attributes the first time we draw with this buffer (or after it has grown)
+	if (_instanceBufferGeneration != instances.GetGeneration()) {
+		_instanceBufferGeneration = instances.GetGeneration();
+		glVertexArrayVertexBuffer(_handle, InstanceBuffer::BINDING_INDEX, instances.GetHandle(), 0, sizeof(InstanceData));
+		glVertexArrayBindingDivisor(_handle, InstanceBuffer::BINDING_INDEX, 1);
+		for (GLuint ix = 0; ix < InstanceBuffer::ATTRIB_COUNT; ix++) {
+			const GLuint slot = InstanceBuffer::ATTRIB_SLOT + ix;
+			// The first 4 slots are the model matrix columns, the next 3 are the normal matrix columns, and the last
+			// two are the params and material params
+			GLuint offset;
+			GLint size = 4;
+			if (ix < 4) {
+				offset = (GLuint)offsetof(InstanceData, Model) + ix * sizeof(glm::vec4);
+			} else if (ix < 7) {
+				offset = (GLuint)offsetof(InstanceData, NormalMatrix) + (ix - 4) * sizeof(glm::vec4);
+				size = 3;
+			} else if (ix < 8) {
+				offset = (GLuint)offsetof(InstanceData, Params);
+			} else {
+				offset = (GLuint)offsetof(InstanceData, MaterialParams);
+			}
+			glEnableVertexArrayAttrib(_handle, slot);
+			glVertexArrayAttribFormat(_handle, slot, size, GL_FLOAT, GL_FALSE, offset);
+			glVertexArrayAttribBinding(_handle, slot, InstanceBuffer::BINDING_INDEX);
+		}
+	}
+
+	Bind();
+	if (_indexBuffer != nullptr) {
+		GLsizei indexCount;
+		const void* offset;
+		GetLodRange(_lods, *_indexBuffer, lod, indexCount, offset);
+		glDrawElementsInstancedBaseInstance(GL_TRIANGLES, indexCount, _indexBuffer->GetElementType(), offset, count, baseInstance);
+	} else {
+		glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, _vertexCount, count, baseInstance);
+	}
+	RenderState::CountDraw(GetTriangleCount(lod) * count);
 }
@@ -5,6 +5,8 @@ VertexPosCol* VPC = nullptr;
 VertexPosNormCol* VPNC = nullptr;
 VertexPosNormTex* VPNT = nullptr;
 VertexPosNormTexCol* VPNTC = nullptr;
+VertexPosNormTexColCompact* VPNTCC = nullptr;
+VertexPosNormTexColQuantized* VPNTCQ = nullptr;
 
 const std::vector<BufferAttribute> VertexPosCol::V_DECL = {
 	BufferAttribute(0, 3, GL_FLOAT, false, sizeof(VertexPosCol), (size_t)&VPC->Position, AttribUsage::Position),
@@ -26,4 +28,17 @@ const std::vector<BufferAttribute> VertexPosNormTexCol::V_DECL = {
 	BufferAttribute(2, 3, GL_FLOAT, false, sizeof(VertexPosNormTexCol), (size_t)&VPNTC->Normal, AttribUsage::Normal),
 	BufferAttribute(3, 2, GL_FLOAT, false, sizeof(VertexPosNormTexCol), (size_t)&VPNTC->UV, AttribUsage::Texture),
 };
+// The packed types use the same slots as VertexPosNormTexCol, and are normalized when read so the shader still gets floats
+const std::vector<BufferAttribute> VertexPosNormTexColCompact::V_DECL = {
+	BufferAttribute(0, 3, GL_FLOAT, false, sizeof(VertexPosNormTexColCompact), (size_t)&VPNTCC->Position, AttribUsage::Position),
+	BufferAttribute(1, 4, GL_UNSIGNED_BYTE, true, sizeof(VertexPosNormTexColCompact), (size_t)&VPNTCC->Color, AttribUsage::Color),
+	BufferAttribute(2, 4, GL_INT_2_10_10_10_REV, true, sizeof(VertexPosNormTexColCompact), (size_t)&VPNTCC->Normal, AttribUsage::Normal),
+	BufferAttribute(3, 2, GL_HALF_FLOAT, false, sizeof(VertexPosNormTexColCompact), (size_t)&VPNTCC->UV, AttribUsage::Texture),
+};
+const std::vector<BufferAttribute> VertexPosNormTexColQuantized::V_DECL = {
+	BufferAttribute(0, 3, GL_SHORT, true, sizeof(VertexPosNormTexColQuantized), (size_t)&VPNTCQ->Position, AttribUsage::Position),
+	BufferAttribute(1, 4, GL_UNSIGNED_BYTE, true, sizeof(VertexPosNormTexColQuantized), (size_t)&VPNTCQ->Color, AttribUsage::Color),
+	BufferAttribute(2, 4, GL_INT_2_10_10_10_REV, true, sizeof(VertexPosNormTexColQuantized), (size_t)&VPNTCQ->Normal, AttribUsage::Normal),
+	BufferAttribute(3, 2, GL_HALF_FLOAT, false, sizeof(VertexPosNormTexColQuantized), (size_t)&VPNTCQ->UV, AttribUsage::Texture),
+};
 #pragma warning(pop)
\ No newline at end of file
@@ -0,0 +1,50 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+CSkinnedMeshRenderer.h
+Mesh renderer component for skinned meshes - the mesh is deformed
+by the joints of one of the characters in a PoseEvaluator.
+Use with the skinned.vert shader.
+*/
+
+#pragma once
+
+#include "CMeshRenderer.h"
+#include "PoseEvaluator.h"
+
+namespace nou
+{
+	class CSkinnedMeshRenderer : public CMeshRenderer
+	{
+		public:
+
+		//The most joints a skinned mesh can have.
+		//This must match the size of the joints array in skinned.vert.
+		static constexpr size_t MAX_JOINTS = 128;
+
+		//The uniform block binding used for the joint matrices.
+		static constexpr GLuint PALETTE_BINDING = 0;
+
+		CSkinnedMeshRenderer(Entity& owner, const Mesh& mesh, Material& mat,
+							 const PoseEvaluator& poses, size_t character);
+		virtual ~CSkinnedMeshRenderer() = default;
+
+		CSkinnedMeshRenderer(CSkinnedMeshRenderer&&) = default;
+		CSkinnedMeshRenderer& operator=(CSkinnedMeshRenderer&&) = default;
+
+		//Sets which character's pose we draw the mesh in.
+		void SetCharacter(const PoseEvaluator& poses, size_t character);
+
+		virtual void Draw() override;
+
+		protected:
+
+		const PoseEvaluator* m_poses;
+		size_t m_character;
+
+		//We only need one palette on the GPU at a time, so all of our
+		//skinned renderers share a single buffer.
+		static std::unique_ptr<UniformBuffer> m_paletteBuffer;
+	};
+}
@@ -113,6 +113,127 @@ namespace nou
 		bool m_dynamic;
 	};
 
+	//Class for managing OpenGL index buffers (aka Element Buffer Objects).
+	//An index buffer lists which vertices make up each triangle of a model,
+	//so vertices shared between triangles only need to be stored once.
+	//As with VertexBuffer, this is intended to be used via pointers.
+	class IndexBuffer
+	{
+		public:
+
+		IndexBuffer(const std::vector<GLuint>& indices)
+		{
+			m_len = 0;
+			m_type = GL_UNSIGNED_INT;
+
+			glGenBuffers(1, &m_id);
+			UpdateData(indices);
+		}
+
+		~IndexBuffer()
+		{
+			glDeleteBuffers(1, &m_id);
+		}
+
+		IndexBuffer(const IndexBuffer&) = delete;
+
+		GLsizei Length() const { return m_len; }
+
+		//The type of our indices (GL_UNSIGNED_SHORT or GL_UNSIGNED_INT).
+		GLenum Type() const { return m_type; }
+
+		GLuint GetID() const { return m_id; }
+
+		//This uploads the indices specified into our OpenGL buffer on the GPU.
+		//If every index fits in 16 bits, we store them that way to halve
+		//the memory they take up.
+		void UpdateData(const std::vector<GLuint>& indices)
+		{
+			m_len = (GLsizei)indices.size();
+
+			GLuint maxIndex = 0;
+			for (GLuint index : indices)
+				maxIndex = (index > maxIndex) ? index : maxIndex;
+
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
+
+			if (maxIndex <= 0xFFFF)
+			{
+				std::vector<GLushort> shortIndices(indices.begin(), indices.end());
+				m_type = GL_UNSIGNED_SHORT;
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_len * sizeof(GLushort), shortIndices.data(), GL_STATIC_DRAW);
+			}
+			else
+			{
+				m_type = GL_UNSIGNED_INT;
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_len * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+			}
+		}
+
+		protected:
+
+		//The OpenGL ID of our index buffer.
+		GLuint m_id;
+
+		//The number of indices in our buffer.
+		GLsizei m_len;
+
+		//The type of each index.
+		GLenum m_type;
+	};
+
+	//Class for managing OpenGL Uniform Buffer Objects (UBOs).
+	//A uniform buffer holds a block of uniform data on the GPU. When we have a lot
+	//of uniform data to send at once (e.g., the joint matrices for a skinned mesh),
+	//this is much faster than setting the uniforms one at a time.
+	//As with VertexBuffer, this is intended to be used via pointers.
+	class UniformBuffer
+	{
+		public:
+
+		UniformBuffer(GLsizeiptr size)
+		{
+			m_size = size;
+
+			glGenBuffers(1, &m_id);
+			glBindBuffer(GL_UNIFORM_BUFFER, m_id);
+			glBufferData(GL_UNIFORM_BUFFER, m_size, nullptr, GL_DYNAMIC_DRAW);
+		}
+
+		~UniformBuffer()
+		{
+			glDeleteBuffers(1, &m_id);
+		}
+
+		UniformBuffer(const UniformBuffer&) = delete;
+
+		GLsizeiptr Size() const { return m_size; }
+
+		GLuint GetID() const { return m_id; }
+
+		//This uploads the data specified into part of our buffer on the GPU.
+		void UpdateData(const void* data, GLsizeiptr size, GLintptr offset = 0)
+		{
+			glBindBuffer(GL_UNIFORM_BUFFER, m_id);
+			glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+		}
+
+		//This makes our buffer the source of data for any uniform blocks
+		//using the binding slot given (i.e., layout(binding = slot) in the shader).
+		void Bind(GLuint slot) const
+		{
+			glBindBufferBase(GL_UNIFORM_BUFFER, slot, m_id);
+		}
+
+		protected:
+
+		//The OpenGL ID of our UBO.
+		GLuint m_id;
+
+		//The size of our buffer in bytes.
+		GLsizeiptr m_size;
+	};
+
 	//Class for managing OpenGL Vertex Array Objects (VAOs).
 	//Just as with VertexBuffer, as written, this class is intended to be used via pointers.
 	class VertexArray
@@ -136,6 +257,7 @@ namespace nou
 			m_drawMode = DrawMode::TRIANGLES;
 			glGenVertexArrays(1, &m_id);
 			m_len = 0;
+			m_ibo = nullptr;
 		}
 
 		~VertexArray()
@@ -240,6 +362,17 @@ namespace nou
 														 (long long)buf.ElementSize()));
 		}
 
+		//This associates an IndexBuffer with our vertex array object.
+		//Once we have one, Draw will use it to decide which vertices
+		//make up each primitive, rather than just going through them in order.
+		void BindIndices(const IndexBuffer& buf)
+		{
+			m_ibo = &buf;
+
+			glBindVertexArray(m_id);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buf.GetID());
+		}
+
 		void SetDrawMode(DrawMode drawMode)
 		{
 			m_drawMode = drawMode;
@@ -247,9 +380,15 @@ namespace nou
 
 		void Draw()
 		{
-			m_len = m_vbos.begin()->second->Length();
-
 			glBindVertexArray(m_id);
+
+			if (m_ibo != nullptr)
+			{
+				glDrawElements((int)m_drawMode, m_ibo->Length(), m_ibo->Type(), nullptr);
+				return;
+			}
+
+			m_len = m_vbos.begin()->second->Length();
 			glDrawArrays((int)m_drawMode, 0, m_len);
 		}
 
@@ -275,6 +414,9 @@ namespace nou
 
 		//A record of the VBOs associated with this VAO.
 		std::map<GLint, const VertexBuffer*> m_vbos;
+
+		//The index buffer associated with this VAO, if any.
+		const IndexBuffer* m_ibo;
 	};
 }
 
@@ -10,8 +10,11 @@ Helpful reference: https://www.khronos.org/files/gltf20-reference-guide.pdf
 #pragma once
 
 #include "Mesh.h"
+#include "Skeleton.h"
 
 #include <string>
+#include <vector>
+#include <memory>
 
 //Forward declaration of objects defined by the tinyGLTF library.
 namespace tinygltf
@@ -28,10 +31,64 @@ namespace nou::GLTF
 		size_t len;
 		int stride;
 		int elementSize;
+		int componentType;
+	};
+
+	//The vertex data for a mesh, as we collect it from each of its primitives.
+	struct MeshData
+	{
+		std::vector<glm::vec3> verts;
+		std::vector<glm::vec3> normals;
+		std::vector<glm::vec2> uvs;
+		std::vector<glm::vec4> joints;
+		std::vector<glm::vec4> weights;
+		std::vector<GLuint> indices;
+
+		//These are cleared if any primitive is missing the attribute.
+		bool hasNormals = true;
+		bool hasUVs = true;
+		bool hasSkin = true;
+	};
+
+	//A node in a glTF scene, with its transform relative to its parent.
+	struct SceneNode
+	{
+		std::string name;
+
+		//The index of the node's parent in Scene::nodes, or -1 if it has none.
+		int parent = -1;
+
+		//The index of the node's mesh in Scene::meshes, or -1 if it has none.
+		//Several nodes can share the same mesh.
+		int mesh = -1;
+
+		glm::vec3 pos = glm::vec3(0.0f);
+		glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		glm::vec3 scale = glm::vec3(1.0f);
+	};
+
+	//Everything in a glTF file - all of its meshes, and the nodes placing them in the scene.
+	//Nodes are sorted so that every node comes after its parent, so they can be
+	//turned into entities (and parented) in order.
+	struct Scene
+	{
+		std::vector<std::unique_ptr<Mesh>> meshes;
+		std::vector<SceneNode> nodes;
 	};
 
 	//Loads a 3D model into the mesh object given.
+	//Only the first mesh in the file is loaded - see LoadScene for files with several.
 	void LoadMesh(const std::string& filename, Mesh& mesh, bool flipUVY = true);
+
+	//Loads every mesh in a file, along with the node hierarchy that places them in the scene.
+	bool LoadScene(const std::string& filename, Scene& scene, bool flipUVY = true);
+
+	//Loads a skinned 3D model into the mesh object given, along with the skeleton
+	//it is bound to and any animations for that skeleton.
+	//Animations are resampled at the given rate (in frames per second).
+	bool LoadSkinnedMesh(const std::string& filename, Mesh& mesh, Skeleton& skeleton,
+						 std::vector<AnimationClip>& clips, bool flipUVY = true,
+						 float sampleRate = 30.0f);
 	
 	void DumpErrorsAndWarnings(const std::string& filename,
 							   const std::string& err,
@@ -41,16 +98,40 @@ namespace nou::GLTF
 	bool ParseGLTF(const std::string& filename, tinygltf::Model& gltf,
 				   std::string& err, std::string& warn);
 
-	//Takes a glTF model and extracts vertex positions, normals, and texture coordinates.
-	bool ExtractGeometry(const tinygltf::Model& gltf, Mesh& mesh, bool flipUVY,
-					     std::string& err, std::string& warn);
+	//Takes one of the meshes in a glTF model and extracts its vertex positions, normals,
+	//texture coordinates, and indices.
+	//If the model is skinned, this also extracts the joints and weights for each vertex.
+	//jointRemap (from ExtractSkeleton) maps the joint indices in the file to our skeleton's joints.
+	bool ExtractGeometry(const tinygltf::Model& gltf, size_t meshIndex, Mesh& mesh, bool flipUVY,
+					     std::string& err, std::string& warn,
+						 const std::vector<int>* jointRemap = nullptr);
 
-	bool ProcessPrimitive(const tinygltf::Model& gltf, size_t geomIndex, 
-					      std::vector<glm::vec3>& verts, std::vector<glm::vec2>& uvs,
-						  std::vector<glm::vec3>& normals, bool flipUVY,
-						  bool& hasNormals, bool& hasUVs,
+	//Appends the vertices and indices of one primitive of a mesh to the data given.
+	bool ProcessPrimitive(const tinygltf::Model& gltf, size_t meshIndex, size_t geomIndex,
+						  MeshData& data, bool flipUVY, const std::vector<int>* jointRemap,
 						  std::string& err, std::string& warn);
 
+	//Takes a glTF model and extracts the node hierarchy of its default scene.
+	bool ExtractNodes(const tinygltf::Model& gltf, std::vector<SceneNode>& nodes,
+					  std::string& err, std::string& warn);
+
+	//Takes a glTF model and extracts the joint hierarchy of its first skin.
+	//jointRemap maps the skin's joint indices to the (sorted) joints of our skeleton,
+	//and nodeToJoint maps each node in the file to a joint, or -1 if it isn't one.
+	bool ExtractSkeleton(const tinygltf::Model& gltf, Skeleton& skeleton,
+						 std::vector<int>& jointRemap, std::vector<int>& nodeToJoint,
+						 std::string& err, std::string& warn);
+
+	//Takes a glTF model and resamples all of the animations affecting the skeleton given.
+	bool ExtractAnimations(const tinygltf::Model& gltf, const Skeleton& skeleton,
+						   const std::vector<int>& nodeToJoint, float sampleRate,
+						   std::vector<AnimationClip>& clips,
+						   std::string& err, std::string& warn);
+
+	//Fetches the local transform of a node, either as a pose or a matrix.
+	JointPose GetNodePose(const tinygltf::Model& gltf, int node);
+	glm::mat4 GetNodeMatrix(const tinygltf::Model& gltf, int node);
+
 	//Utility functions for more easily accessing data stored in glTF buffers.
 	int FindAccessor(const tinygltf::Primitive& geom, const std::string& name);
 	DataGetter BuildGetter(const tinygltf::Model& gltf, int accIndex);
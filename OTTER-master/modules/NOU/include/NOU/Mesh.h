@@ -37,27 +37,59 @@ namespace nou
 		Mesh() = default;
 		virtual ~Mesh() = default;
 
-		void SetVerts(const std::vector<glm::vec3>& verts);
-		void SetNormals(const std::vector<glm::vec3>& normals);
-		void SetUVs(const std::vector<glm::vec2>& uvs);
+		//The setters take their data by value, so you can std::move
+		//your vectors in to avoid copying them.
+		void SetVerts(std::vector<glm::vec3> verts);
+		void SetNormals(std::vector<glm::vec3> normals);
+		void SetUVs(std::vector<glm::vec2> uvs);
+
+		//Skinning data - up to 4 joints influence each vertex.
+		//Joint indices are stored as floats, since our vertex arrays
+		//always pass attributes to the shader as floating point data.
+		void SetJoints(std::vector<glm::vec4> joints);
+		void SetWeights(std::vector<glm::vec4> weights);
+
+		//Sets which vertices make up each triangle of the mesh.
+		//Without indices, every 3 vertices in order make up a triangle.
+		void SetIndices(std::vector<GLuint> indices);
+
+		//Access to the CPU-side copy of our data (e.g., for skinning on the CPU).
+		const std::vector<glm::vec3>& GetVerts() const { return m_verts; }
+		const std::vector<glm::vec3>& GetNormals() const { return m_normals; }
+		const std::vector<glm::vec2>& GetUVs() const { return m_uvs; }
+		const std::vector<glm::vec4>& GetJoints() const { return m_joints; }
+		const std::vector<glm::vec4>& GetWeights() const { return m_weights; }
+		const std::vector<GLuint>& GetIndices() const { return m_indices; }
 
 		//Fetches a vertex buffer associated with the desired attribute.
 		//Used by mesh rendering components to grab the requisite data
 		//associated with this model in OpenGL.
 		const VertexBuffer* GetVBO(Attrib attrib) const;
 
+		//Fetches the index buffer for this mesh, or nullptr if it isn't indexed.
+		const IndexBuffer* GetIBO() const { return m_ibo.get(); }
+
 		protected:
 
 		std::vector<glm::vec3> m_verts;
 		std::vector<glm::vec3> m_normals;
 		std::vector<glm::vec2> m_uvs;
+		std::vector<glm::vec4> m_joints;
+		std::vector<glm::vec4> m_weights;
+		std::vector<GLuint> m_indices;
 
 		std::map<Attrib, std::unique_ptr<VertexBuffer>> m_vbo;
+		std::unique_ptr<IndexBuffer> m_ibo;
 
 		//Sets up a VertexBuffer for the desired attribute.
 		template<typename T>
 		void SetVBO(Attrib attrib, GLint elementLen, const std::vector<T>& data)
 		{
+			//Without an OpenGL context (e.g., in headless tests), we can
+			//only keep the CPU-side copy of our data.
+			if (glGenBuffers == nullptr)
+				return;
+
 			//We shouldn't be trying to send an empty array!
 			//A VBO with no data would just lead to memory access errors.
 			if (data.size() == 0)
@@ -0,0 +1,82 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+PoseEvaluator.h
+Computes the joint matrices needed to skin many characters
+sharing the same skeleton.
+*/
+
+#pragma once
+
+#include "Skeleton.h"
+
+#include <vector>
+#include <functional>
+
+namespace nou
+{
+	//Evaluates animation clips for a group of characters sharing a skeleton,
+	//producing a "palette" of skinning matrices for each character.
+	//A palette has one matrix per joint, which takes a vertex from the bind pose
+	//of the mesh to where that joint has moved it in the current pose.
+	//
+	//All of the palettes live in one contiguous array, so they can be uploaded
+	//to the GPU in one go, and characters are independent of each other,
+	//so they can be evaluated across multiple threads.
+	class PoseEvaluator
+	{
+		public:
+
+		//A function that splits a range of work across threads, and returns once
+		//all of it is done (e.g., JobSystem::ParallelFor). It is given the size of
+		//the range, the smallest chunk worth sending to another thread, and
+		//a function that processes the part of the range from begin to end.
+		typedef std::function<void(size_t count, size_t minChunkSize,
+								   const std::function<void(size_t begin, size_t end)>& func)> ParallelFor;
+
+		PoseEvaluator(const Skeleton& skeleton);
+		~PoseEvaluator() = default;
+
+		//Adds a character to be evaluated, returning its index.
+		//Pass nullptr as the clip to leave the character in its rest pose.
+		size_t AddCharacter(const AnimationClip* clip = nullptr, float time = 0.0f);
+
+		void SetClip(size_t character, const AnimationClip* clip);
+		void SetTime(size_t character, float time);
+		float GetTime(size_t character) const { return m_times[character]; }
+
+		//Moves every character forward in their animation.
+		//Animations loop, so there is no need to wrap the time yourself.
+		void Advance(float deltaTime);
+
+		//Computes the palettes for every character.
+		//If no ParallelFor is given, this all happens on the calling thread.
+		void Evaluate(const ParallelFor& parallelFor = nullptr);
+
+		//Computes the palettes for the characters from begin up to (but not including) end.
+		void EvaluateRange(size_t begin, size_t end);
+
+		//Samples a clip at the given time (looping), writing each component of each
+		//joint's local pose in the same structure-of-arrays layout as AnimationClip frames.
+		//The output must hold AnimationClip::TRACK_COUNT * clip.GetStride() floats.
+		static void SampleClip(const AnimationClip& clip, float time, float* localOut);
+
+		const glm::mat4* GetPalette(size_t character) const { return &m_palettes[character * m_jointCount]; }
+		const std::vector<glm::mat4>& GetPalettes() const { return m_palettes; }
+
+		size_t GetCharacterCount() const { return m_clips.size(); }
+		size_t GetJointCount() const { return m_jointCount; }
+
+		protected:
+
+		const Skeleton* m_skeleton;
+		size_t m_jointCount;
+
+		//Per-character data, stored side by side rather than in a struct,
+		//since each pass over the characters only needs some of it.
+		std::vector<const AnimationClip*> m_clips;
+		std::vector<float> m_times;
+		std::vector<glm::mat4> m_palettes;
+	};
+}
@@ -0,0 +1,122 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+Skeleton.h
+Classes for storing the joint hierarchy of a skinned model and the
+animations that can be played on it.
+*/
+
+#pragma once
+
+#define GLM_ENABLE_EXPERIMENTAL
+
+#include "Mesh.h"
+
+#include "GLM/glm.hpp"
+#include "GLM/gtx/quaternion.hpp"
+
+#include <vector>
+#include <string>
+
+namespace nou
+{
+	//The local transform of a single joint, relative to its parent.
+	struct JointPose
+	{
+		glm::vec3 pos = glm::vec3(0.0f);
+		glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		glm::vec3 scale = glm::vec3(1.0f);
+	};
+
+	//The joint hierarchy of a skinned model (a "skin" in glTF).
+	//Joints are sorted so that every joint comes after its parent.
+	//This lets us compute all of the global joint transforms in a single
+	//pass over the joints, without needing any recursion.
+	struct Skeleton
+	{
+		std::vector<std::string> names;
+
+		//The index of each joint's parent, or -1 for root joints.
+		std::vector<int> parents;
+
+		//Transforms a vertex from model space into the space of each joint,
+		//as it was when the model was bound to the skeleton.
+		std::vector<glm::mat4> inverseBind;
+
+		//For root joints, the global transform of any nodes above the
+		//skeleton in the scene (e.g., an armature object). Identity otherwise.
+		std::vector<glm::mat4> rootTransforms;
+
+		//The pose of each joint when it is not being animated.
+		std::vector<JointPose> restPose;
+
+		size_t JointCount() const { return parents.size(); }
+
+		//Returns the index of the joint with the given name, or -1 if there isn't one.
+		int FindJoint(const std::string& name) const;
+	};
+
+	//An animation for a skeleton, resampled at a fixed rate.
+	//Resampling means every joint has a key on every frame, so playing the
+	//animation back never needs to search for keys - we just blend between
+	//the two frames on either side of the current time.
+	//
+	//Each frame is stored in structure-of-arrays form: all of the joints'
+	//position X values, then all of their position Y values, etc.
+	//This lets us sample several joints at once with SIMD instructions.
+	class AnimationClip
+	{
+		public:
+
+		//The components of a joint pose, in the order they are stored in each frame.
+		enum Track
+		{
+			POS_X, POS_Y, POS_Z,
+			ROT_X, ROT_Y, ROT_Z, ROT_W,
+			SCALE_X, SCALE_Y, SCALE_Z,
+			TRACK_COUNT
+		};
+
+		std::string m_name;
+
+		AnimationClip();
+		~AnimationClip() = default;
+
+		//Sets up storage for the animation, with every joint in its rest pose.
+		void Allocate(const Skeleton& skeleton, size_t frameCount, float sampleRate);
+
+		void SetJointPose(size_t frame, size_t joint, const JointPose& pose);
+		JointPose GetJointPose(size_t frame, size_t joint) const;
+
+		//Returns one component of every joint's pose for the given frame.
+		//The track has GetStride() elements - joints past the end are padding.
+		const float* GetTrack(size_t frame, Track track) const
+		{
+			return &m_data[(frame * TRACK_COUNT + track) * m_stride];
+		}
+
+		size_t GetJointCount() const { return m_jointCount; }
+		size_t GetFrameCount() const { return m_frameCount; }
+		float GetSampleRate() const { return m_sampleRate; }
+		float GetDuration() const;
+
+		//The number of joints in each track, rounded up to a multiple of 4.
+		size_t GetStride() const { return m_stride; }
+
+		protected:
+
+		size_t m_jointCount;
+		size_t m_frameCount;
+		size_t m_stride;
+		float m_sampleRate;
+
+		std::vector<float> m_data;
+	};
+
+	//Skins a mesh on the CPU using the joint palette given (one matrix per joint, see PoseEvaluator).
+	//This is far slower than skinning in a vertex shader, but lets us get the skinned
+	//vertices back without a GPU (e.g., in headless tests).
+	void SkinVertices(const Mesh& mesh, const glm::mat4* palette,
+					  std::vector<glm::vec3>& vertsOut, std::vector<glm::vec3>& normalsOut);
+}
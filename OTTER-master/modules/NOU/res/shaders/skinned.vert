@@ -0,0 +1,47 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+skinned.vert
+Vertex shader.
+Deforms the vertex by the joints of the skeleton influencing it,
+then passes world vertex position, transformed normal direction,
+and UV coordinates to the fragment shader.
+*/
+
+#version 420 core
+
+uniform mat4 model;
+uniform mat3 normal;
+uniform mat4 viewproj;
+
+//One matrix per joint, uploaded by CSkinnedMeshRenderer.
+//The size must match CSkinnedMeshRenderer::MAX_JOINTS.
+layout(std140, binding = 0) uniform JointPalette
+{
+    mat4 joints[128];
+};
+
+layout(location = 0) in vec4 inPos;
+layout(location = 1) in vec3 inNorm;
+layout(location = 2) in vec2 inUV;
+layout(location = 3) in vec4 inJoints;
+layout(location = 4) in vec4 inWeights;
+
+layout(location = 0) out vec4 outPos;
+layout(location = 1) out vec3 outNorm;
+layout(location = 2) out vec2 outUV;
+
+void main()
+{
+    mat4 skin = joints[int(inJoints.x)] * inWeights.x +
+                joints[int(inJoints.y)] * inWeights.y +
+                joints[int(inJoints.z)] * inWeights.z +
+                joints[int(inJoints.w)] * inWeights.w;
+
+    outNorm = normal * normalize(mat3(skin) * inNorm);
+    outPos = model * (skin * inPos);
+    outUV = inUV;
+
+    gl_Position = viewproj * outPos;
+}
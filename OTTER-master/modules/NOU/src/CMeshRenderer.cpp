@@ -48,6 +48,15 @@ namespace nou
 
 		if ((vbo = mesh.GetVBO(Mesh::Attrib::UV)) != nullptr)
 			m_vao->BindAttrib(*vbo, (GLint)Mesh::Attrib::UV);
+
+		if ((vbo = mesh.GetVBO(Mesh::Attrib::JOINT_INFLUENCE)) != nullptr)
+			m_vao->BindAttrib(*vbo, (GLint)Mesh::Attrib::JOINT_INFLUENCE);
+
+		if ((vbo = mesh.GetVBO(Mesh::Attrib::SKIN_WEIGHT)) != nullptr)
+			m_vao->BindAttrib(*vbo, (GLint)Mesh::Attrib::SKIN_WEIGHT);
+
+		if (mesh.GetIBO() != nullptr)
+			m_vao->BindIndices(*mesh.GetIBO());
 	}
 
 	void CMeshRenderer::SetMaterial(Material& mat)
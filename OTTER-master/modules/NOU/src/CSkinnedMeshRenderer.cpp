@@ -0,0 +1,54 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+CSkinnedMeshRenderer.cpp
+Mesh renderer component for skinned meshes - the mesh is deformed
+by the joints of one of the characters in a PoseEvaluator.
+Use with the skinned.vert shader.
+*/
+
+#include "NOU/CSkinnedMeshRenderer.h"
+
+#include <cstdio>
+#include <algorithm>
+
+namespace nou
+{
+	std::unique_ptr<UniformBuffer> CSkinnedMeshRenderer::m_paletteBuffer = nullptr;
+
+	CSkinnedMeshRenderer::CSkinnedMeshRenderer(Entity& owner,
+											   const Mesh& mesh,
+											   Material& mat,
+											   const PoseEvaluator& poses,
+											   size_t character)
+		: CMeshRenderer(owner, mesh, mat)
+	{
+		SetCharacter(poses, character);
+	}
+
+	void CSkinnedMeshRenderer::SetCharacter(const PoseEvaluator& poses, size_t character)
+	{
+		if (poses.GetJointCount() > MAX_JOINTS)
+			printf("Skeleton has %zu joints, only the first %zu will be used for skinning!\n",
+				   poses.GetJointCount(), MAX_JOINTS);
+
+		m_poses = &poses;
+		m_character = character;
+	}
+
+	void CSkinnedMeshRenderer::Draw()
+	{
+		if (m_paletteBuffer == nullptr)
+			m_paletteBuffer = std::make_unique<UniformBuffer>(MAX_JOINTS * sizeof(glm::mat4));
+
+		//glm::mat4 has the same layout as a std140 mat4, so the palette
+		//can be copied straight into our buffer.
+		size_t jointCount = std::min(m_poses->GetJointCount(), MAX_JOINTS);
+
+		m_paletteBuffer->UpdateData(m_poses->GetPalette(m_character), jointCount * sizeof(glm::mat4));
+		m_paletteBuffer->Bind(PALETTE_BINDING);
+
+		CMeshRenderer::Draw();
+	}
+}
@@ -10,6 +10,11 @@ Helpful reference: https://www.khronos.org/files/gltf20-reference-guide.pdf
 #include "NOU/GLTFLoader.h"
 
 #include <sstream>
+#include <cmath>
+#include <algorithm>
+
+#include "GLM/gtx/transform.hpp"
+#include "GLM/gtx/matrix_decompose.hpp"
 
 #include "tiny_gltf.h"
 
@@ -29,7 +34,7 @@ namespace nou::GLTF
 			return;
 		}
 
-		result = ExtractGeometry(*gltf, mesh, flipUVY, err, warn);
+		result = ExtractGeometry(*gltf, 0, mesh, flipUVY, err, warn);
 
 		if (!result)
 		{
@@ -41,6 +46,77 @@ namespace nou::GLTF
 		printf("Loaded mesh from %s.\n", filename.c_str());
 	}
 
+	bool LoadSkinnedMesh(const std::string& filename, Mesh& mesh, Skeleton& skeleton,
+						 std::vector<AnimationClip>& clips, bool flipUVY, float sampleRate)
+	{
+		auto gltf = std::make_unique<tinygltf::Model>();
+
+		std::string err, warn;
+
+		bool result = ParseGLTF(filename, *gltf, err, warn);
+
+		//We need the skeleton first, since it decides the order of the joints
+		//that our vertices (and animations) refer to.
+		std::vector<int> jointRemap, nodeToJoint;
+
+		if (result)
+			result = ExtractSkeleton(*gltf, skeleton, jointRemap, nodeToJoint, err, warn);
+
+		//The skinned mesh is the one on the node using the skin.
+		size_t meshIndex = 0;
+
+		for (const tinygltf::Node& node : gltf->nodes)
+		{
+			if (node.skin == 0 && node.mesh >= 0)
+			{
+				meshIndex = node.mesh;
+				break;
+			}
+		}
+
+		if (result)
+			result = ExtractGeometry(*gltf, meshIndex, mesh, flipUVY, err, warn, &jointRemap);
+
+		if (result)
+			result = ExtractAnimations(*gltf, skeleton, nodeToJoint, sampleRate, clips, err, warn);
+
+		DumpErrorsAndWarnings(filename, err, warn);
+
+		if (result)
+			printf("Loaded skinned mesh from %s (%zu joints, %zu animations).\n",
+				   filename.c_str(), skeleton.JointCount(), clips.size());
+
+		return result;
+	}
+
+	bool LoadScene(const std::string& filename, Scene& scene, bool flipUVY)
+	{
+		auto gltf = std::make_unique<tinygltf::Model>();
+
+		std::string err, warn;
+
+		bool result = ParseGLTF(filename, *gltf, err, warn);
+
+		scene.meshes.clear();
+
+		for (size_t i = 0; result && i < gltf->meshes.size(); ++i)
+		{
+			scene.meshes.push_back(std::make_unique<Mesh>());
+			result = ExtractGeometry(*gltf, i, *scene.meshes.back(), flipUVY, err, warn);
+		}
+
+		if (result)
+			result = ExtractNodes(*gltf, scene.nodes, err, warn);
+
+		DumpErrorsAndWarnings(filename, err, warn);
+
+		if (result)
+			printf("Loaded scene from %s (%zu meshes, %zu nodes).\n",
+				   filename.c_str(), scene.meshes.size(), scene.nodes.size());
+
+		return result;
+	}
+
 	void DumpErrorsAndWarnings(const std::string& filename,
 							   const std::string& err,
 							   const std::string& warn)
@@ -102,16 +178,17 @@ namespace nou::GLTF
 		return result;
 	}
 
-	bool ExtractGeometry(const tinygltf::Model& gltf, Mesh& mesh, bool flipUVY,
-						 std::string& err, std::string& warn)
+	bool ExtractGeometry(const tinygltf::Model& gltf, size_t meshIndex, Mesh& mesh, bool flipUVY,
+						 std::string& err, std::string& warn,
+						 const std::vector<int>* jointRemap)
 	{
-		if (gltf.meshes.size() == 0)
+		if (meshIndex >= gltf.meshes.size())
 		{
 			err = "No meshes in file.";
 			return false;
 		}
 			
-		const tinygltf::Mesh& meshData = gltf.meshes[0];
+		const tinygltf::Mesh& meshData = gltf.meshes[meshIndex];
 
 		if (meshData.primitives.size() == 0)
 		{
@@ -119,62 +196,110 @@ namespace nou::GLTF
 			return false;
 		}
 
-		std::vector<glm::vec3> verts;
-		std::vector<glm::vec3> normals;
-		std::vector<glm::vec2> uvs;
-
-		bool hasNormals = true, hasUVs = true;
+		MeshData data;
 
 		for (size_t i = 0; i < meshData.primitives.size(); ++i)
 		{
-			if(!ProcessPrimitive(gltf, i, verts, uvs, normals, 
-						         flipUVY, hasNormals, hasUVs, err, warn))
+			if(!ProcessPrimitive(gltf, meshIndex, i, data, flipUVY, jointRemap, err, warn))
 				return false;
 		}
 
-		mesh.SetVerts(verts);
+		mesh.SetVerts(std::move(data.verts));
+
+		if(data.hasNormals)
+			mesh.SetNormals(std::move(data.normals));
 
-		if(hasNormals)
-			mesh.SetNormals(normals);
+		if(data.hasUVs)
+			mesh.SetUVs(std::move(data.uvs));
 
-		if(hasUVs)
-			mesh.SetUVs(uvs);
+		if (data.hasSkin)
+		{
+			mesh.SetJoints(std::move(data.joints));
+			mesh.SetWeights(std::move(data.weights));
+		}
+
+		mesh.SetIndices(std::move(data.indices));
 
 		return true;
 	}
 
-	bool ProcessPrimitive(const tinygltf::Model& gltf, size_t geomIndex,
-		                  std::vector<glm::vec3>& verts, std::vector<glm::vec2>& uvs,
-		                  std::vector<glm::vec3>& normals, bool flipUVY,
-						  bool& hasNormals, bool& hasUVs,
-		                  std::string& err, std::string& warn)
+	//Copies the elements of an accessor into a tightly packed array.
+	//Exporters usually pack each attribute tightly in its own buffer view,
+	//in which case this is a single memcpy.
+	template<typename T>
+	static void CopyAccessor(const DataGetter& getter, T* out)
 	{
-		const tinygltf::Primitive geom = gltf.meshes[0].primitives[geomIndex];
-
-		if (geom.indices == -1)
+		if (getter.stride == sizeof(T))
 		{
-			err = "File is missing primitive indices. "\
-				"Consider changing your GLTF export settings, or else this loader " \
-				"must be augmented to support files without indices.";
+			memcpy(out, getter.data, getter.len * sizeof(T));
+			return;
+		}
 
-			return false;
+		//Interleaved data has to be copied an element at a time.
+		for (size_t i = 0; i < getter.len; ++i)
+			memcpy(&out[i], &getter.data[i * getter.stride], sizeof(T));
+	}
+
+	//Copies indices of any width into our (32-bit) index list, offsetting
+	//them to account for the vertices of any primitives before this one.
+	template<typename T>
+	static void CopyIndices(const DataGetter& getter, GLuint baseVertex, GLuint* out)
+	{
+		for (size_t i = 0; i < getter.len; ++i)
+		{
+			T index;
+			memcpy(&index, &getter.data[i * getter.stride], sizeof(T));
+			out[i] = baseVertex + static_cast<GLuint>(index);
 		}
+	}
 
-		//glTF stores data per-vertex.
-		//This indexer will allow us to access the data that tells
-		//us which vertices make up the faces of the object.
-		//This allows us to specify our data in the order we need it
-		//for OpenGL vertex buffers - in other words, spelling out the vertex
-		//data as a set of triangles.
-		DataGetter faceIndexer = BuildGetter(gltf, geom.indices);
+	//Reads a 4 component attribute as floats, whatever component type the file used.
+	//This lets us handle joint indices stored as bytes or shorts, and weights stored
+	//as floats or normalized integers.
+	static glm::vec4 ReadVec4(const DataGetter& getter, size_t index, bool normalized)
+	{
+		const unsigned char* data = &getter.data[index * getter.stride];
+		glm::vec4 result;
 
-		if (faceIndexer.elementSize != sizeof(GLshort))
+		switch (getter.componentType)
 		{
-			err = "Primitive indices are in a currently unsupported format. " \
-				"Consider changing your GLTF export settings, or else this loader " \
-				"must be augmented to support the provided format.";
+			case TINYGLTF_COMPONENT_TYPE_FLOAT:
+				memcpy(&result, data, sizeof(glm::vec4));
+				break;
+
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+				for (int i = 0; i < 4; ++i)
+					result[i] = static_cast<float>(data[i]) / (normalized ? 255.0f : 1.0f);
+				break;
+
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+				for (int i = 0; i < 4; ++i)
+				{
+					unsigned short value;
+					memcpy(&value, &data[i * sizeof(unsigned short)], sizeof(unsigned short));
+					result[i] = static_cast<float>(value) / (normalized ? 65535.0f : 1.0f);
+				}
+				break;
+
+			default:
+				result = glm::vec4(0.0f);
+				break;
+		}
 
-			return false;
+		return result;
+	}
+
+	bool ProcessPrimitive(const tinygltf::Model& gltf, size_t meshIndex, size_t geomIndex,
+						  MeshData& data, bool flipUVY, const std::vector<int>* jointRemap,
+						  std::string& err, std::string& warn)
+	{
+		const tinygltf::Primitive& geom = gltf.meshes[meshIndex].primitives[geomIndex];
+
+		//We draw everything as triangles, so skip points, lines, and strips.
+		if (geom.mode != -1 && geom.mode != TINYGLTF_MODE_TRIANGLES)
+		{
+			warn += "\nSkipping non-triangle mesh primitive " + std::to_string(geomIndex);
+			return true;
 		}
 
 		int vID = FindAccessor(geom, "POSITION");
@@ -186,22 +311,27 @@ namespace nou::GLTF
 		}
 
 		int nID = FindAccessor(geom, "NORMAL");
-		hasNormals = hasNormals && nID != -1;
+		data.hasNormals = data.hasNormals && nID != -1;
 
-		if (!hasNormals)
+		if (!data.hasNormals)
 			warn += "\nNo normals found in mesh primitive " + std::to_string(geomIndex);
 
 		int uvID = FindAccessor(geom, "TEXCOORD_0");
-		hasUVs = hasUVs && uvID != -1;
+		data.hasUVs = data.hasUVs && uvID != -1;
 
 		if (uvID == -1)
 			warn += "\nNo UVs found in mesh primitive " + std::to_string(geomIndex);
 
-		DataGetter vGetter, nGetter, uvGetter;
+		//Skinning data is optional - we only need it for animated models.
+		int jID = FindAccessor(geom, "JOINTS_0");
+		int wID = FindAccessor(geom, "WEIGHTS_0");
+		data.hasSkin = data.hasSkin && jID != -1 && wID != -1;
+
+		DataGetter vGetter{}, nGetter{}, uvGetter{}, jGetter{}, wGetter{};
 
 		vGetter = BuildGetter(gltf, vID);
 
-		if (vGetter.elementSize != sizeof(glm::vec3))
+		if (vGetter.elementSize != sizeof(glm::vec3) || vGetter.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT)
 		{
 			err = "Vertex position data is in a currently unsupported format. " \
 				"Consider changing your GLTF export settings, or else this loader " \
@@ -210,13 +340,13 @@ namespace nou::GLTF
 			return false;
 		}
 
-		if (hasNormals)
+		if (data.hasNormals)
 		{
 			nGetter = BuildGetter(gltf, nID);
 
-			if (nGetter.elementSize != sizeof(glm::vec3))
+			if (nGetter.elementSize != sizeof(glm::vec3) || nGetter.len != vGetter.len)
 			{
-				hasNormals = false;
+				data.hasNormals = false;
 				warn += "\nNormal data is in a currently unsupported format. " \
 					"Consider changing your GLTF export settings, or else this loader " \
 					"must be augmented to support the provided format.";
@@ -224,60 +354,620 @@ namespace nou::GLTF
 		}
 
 
-		if (hasUVs)
+		if (data.hasUVs)
 		{
 			uvGetter = BuildGetter(gltf, uvID);
 
-			if (uvGetter.elementSize != sizeof(glm::vec2))
+			if (uvGetter.elementSize != sizeof(glm::vec2) || uvGetter.len != vGetter.len)
 			{
-				hasUVs = false;
+				data.hasUVs = false;
 				warn += "\nUV data is in a currently unsupported format. " \
 					"Consider changing your GLTF export settings, or else this loader " \
 					"must be augmented to support the provided format.";
 			}
 		}
 
-		size_t startIndex = verts.size();
+		if (data.hasSkin)
+		{
+			jGetter = BuildGetter(gltf, jID);
+			wGetter = BuildGetter(gltf, wID);
+
+			if (jGetter.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT ||
+				jGetter.elementSize != 4 * tinygltf::GetComponentSizeInBytes(jGetter.componentType) ||
+				wGetter.elementSize != 4 * tinygltf::GetComponentSizeInBytes(wGetter.componentType) ||
+				jGetter.len != vGetter.len || wGetter.len != vGetter.len)
+			{
+				data.hasSkin = false;
+				warn += "\nSkinning data is in a currently unsupported format. " \
+					"Consider changing your GLTF export settings, or else this loader " \
+					"must be augmented to support the provided format.";
+			}
+		}
+
+		//glTF stores data per-vertex, along with a list of indices telling us
+		//which vertices make up each triangle - exactly what OpenGL wants.
+		//So we can copy each attribute across as-is, and keep the indices
+		//so that vertices shared between triangles are only stored once.
+		size_t baseVertex = data.verts.size();
+		size_t vertCount = vGetter.len;
+
+		data.verts.resize(baseVertex + vertCount);
+		CopyAccessor(vGetter, &data.verts[baseVertex]);
+
+		if (data.hasNormals)
+		{
+			data.normals.resize(baseVertex + vertCount);
+			CopyAccessor(nGetter, &data.normals[baseVertex]);
+		}
+
+		if (data.hasUVs)
+		{
+			data.uvs.resize(baseVertex + vertCount);
+			CopyAccessor(uvGetter, &data.uvs[baseVertex]);
+
+			//We may need to flip our vertical UV-coordinate.
+			//You will probably need to do this, depending on your export settings/texture.
+			if (flipUVY)
+			{
+				for (size_t i = baseVertex; i < data.uvs.size(); ++i)
+					data.uvs[i].y = 1.0f - data.uvs[i].y;
+			}
+		}
+
+		//Joints and weights come in a few formats, so these need converting as we go.
+		if (data.hasSkin)
+		{
+			data.joints.resize(baseVertex + vertCount);
+			data.weights.resize(baseVertex + vertCount);
+
+			for (size_t i = baseVertex, v = 0; v < vertCount; ++i, ++v)
+			{
+				data.joints[i] = ReadVec4(jGetter, v, false);
+				data.weights[i] = ReadVec4(wGetter, v, true);
+
+				//Map the joints to our skeleton's order.
+				if (jointRemap != nullptr)
+				{
+					for (int j = 0; j < 4; ++j)
+					{
+						size_t joint = static_cast<size_t>(data.joints[i][j]);
+						data.joints[i][j] = (joint < jointRemap->size()) ? static_cast<float>((*jointRemap)[joint]) : 0.0f;
+					}
+				}
+
+				//Make sure our weights add up to 1, otherwise the vertex will
+				//shrink towards (or grow away from) the origin as it is skinned.
+				float total = data.weights[i].x + data.weights[i].y + data.weights[i].z + data.weights[i].w;
+
+				if (total > 0.0f)
+					data.weights[i] /= total;
+				else
+					data.weights[i] = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+			}
+		}
+
+		size_t baseIndex = data.indices.size();
+
+		//Primitives without indices just use their vertices in order.
+		if (geom.indices == -1)
+		{
+			data.indices.resize(baseIndex + vertCount);
+
+			for (size_t i = 0; i < vertCount; ++i)
+				data.indices[baseIndex + i] = static_cast<GLuint>(baseVertex + i);
+
+			return true;
+		}
+
+		DataGetter faceIndexer = BuildGetter(gltf, geom.indices);
+		data.indices.resize(baseIndex + faceIndexer.len);
+		GLuint* indicesOut = &data.indices[baseIndex];
+
+		switch (faceIndexer.componentType)
+		{
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+				CopyIndices<uint8_t>(faceIndexer, static_cast<GLuint>(baseVertex), indicesOut);
+				break;
+
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+				CopyIndices<uint16_t>(faceIndexer, static_cast<GLuint>(baseVertex), indicesOut);
+				break;
+
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+				CopyIndices<uint32_t>(faceIndexer, static_cast<GLuint>(baseVertex), indicesOut);
+				break;
+
+			default:
+				err = "Primitive indices are in an invalid format.";
+				return false;
+		}
+
+		return true;
+	}
+
+	bool ExtractNodes(const tinygltf::Model& gltf, std::vector<SceneNode>& nodes,
+					  std::string& err, std::string& warn)
+	{
+		//Start from the roots of the default scene, or if the file doesn't
+		//have any scenes, from every node without a parent.
+		std::vector<int> roots;
+
+		const int nodeCount = static_cast<int>(gltf.nodes.size());
+
+		if (gltf.scenes.size() > 0)
+		{
+			int sceneIndex = gltf.defaultScene;
+
+			if (sceneIndex < 0 || sceneIndex >= static_cast<int>(gltf.scenes.size()))
+			{
+				if (sceneIndex >= 0)
+					warn += "\nDefault scene " + std::to_string(sceneIndex) + " does not exist - using the first scene.";
+
+				sceneIndex = 0;
+			}
+
+			roots = gltf.scenes[sceneIndex].nodes;
+		}
+		else
+		{
+			std::vector<bool> isChild(gltf.nodes.size(), false);
+
+			for (const tinygltf::Node& node : gltf.nodes)
+			{
+				for (int child : node.children)
+				{
+					if (child < 0 || child >= nodeCount)
+					{
+						err = "Node " + node.name + " has a child that does not exist.";
+						return false;
+					}
+
+					isChild[child] = true;
+				}
+			}
+
+			for (size_t n = 0; n < gltf.nodes.size(); ++n)
+			{
+				if (!isChild[n])
+					roots.push_back(static_cast<int>(n));
+			}
+		}
+
+		//Go through the hierarchy breadth first, so parents come before children.
+		//Each entry is (node in file, parent in our list).
+		std::vector<std::pair<int, int>> queue;
+
+		for (int root : roots)
+		{
+			if (root < 0 || root >= nodeCount)
+			{
+				err = "Scene refers to node " + std::to_string(root) + ", which does not exist.";
+				return false;
+			}
+
+			queue.push_back({ root, -1 });
+		}
+
+		//A node should only be reached once, but a broken file could list
+		//a node twice (or even make it its own ancestor).
+		std::vector<bool> visited(gltf.nodes.size(), false);
+
+		nodes.clear();
+
+		for (size_t i = 0; i < queue.size(); ++i)
+		{
+			int index = queue[i].first;
+			const tinygltf::Node& node = gltf.nodes[index];
+
+			if (visited[index])
+			{
+				warn += "\nNode " + node.name + " is referenced more than once - ignoring the extra reference.";
+				continue;
+			}
+
+			visited[index] = true;
+
+			SceneNode result;
+			result.name = node.name;
+			result.parent = queue[i].second;
+			result.mesh = node.mesh;
+
+			if (result.mesh >= static_cast<int>(gltf.meshes.size()))
+			{
+				warn += "\nNode " + node.name + " refers to a mesh that does not exist - ignoring it.";
+				result.mesh = -1;
+			}
+
+			JointPose pose = GetNodePose(gltf, index);
+			result.pos = pose.pos;
+			result.rotation = pose.rotation;
+			result.scale = pose.scale;
+
+			const int resultIndex = static_cast<int>(nodes.size());
+			nodes.push_back(result);
+
+			for (int child : node.children)
+			{
+				if (child < 0 || child >= nodeCount)
+				{
+					err = "Node " + node.name + " has a child that does not exist.";
+					return false;
+				}
+
+				queue.push_back({ child, resultIndex });
+			}
+		}
+
+		return true;
+	}
+
+	bool ExtractSkeleton(const tinygltf::Model& gltf, Skeleton& skeleton,
+						 std::vector<int>& jointRemap, std::vector<int>& nodeToJoint,
+						 std::string& err, std::string& warn)
+	{
+		if (gltf.skins.size() == 0)
+		{
+			err = "No skins in file.";
+			return false;
+		}
+
+		const tinygltf::Skin& skin = gltf.skins[0];
+		const size_t jointCount = skin.joints.size();
+
+		if (jointCount == 0)
+		{
+			err = "Skin has no joints.";
+			return false;
+		}
+
+		//glTF only stores the children of each node, so work out the parents.
+		std::vector<int> nodeParents(gltf.nodes.size(), -1);
+
+		for (size_t n = 0; n < gltf.nodes.size(); ++n)
+		{
+			for (int child : gltf.nodes[n].children)
+				nodeParents[child] = static_cast<int>(n);
+		}
+
+		//Which joint in the skin (if any) each node is.
+		std::vector<int> skinJoint(gltf.nodes.size(), -1);
+
+		for (size_t i = 0; i < jointCount; ++i)
+			skinJoint[skin.joints[i]] = static_cast<int>(i);
+
+		//glTF doesn't promise that parents come before their children,
+		//so we sort the joints by how many joints are above them.
+		std::vector<int> depth(jointCount, 0);
+
+		for (size_t i = 0; i < jointCount; ++i)
+		{
+			for (int p = nodeParents[skin.joints[i]]; p != -1; p = nodeParents[p])
+			{
+				if (skinJoint[p] != -1)
+					++depth[i];
+			}
+		}
+
+		std::vector<int> order(jointCount);
+
+		for (size_t i = 0; i < jointCount; ++i)
+			order[i] = static_cast<int>(i);
+
+		std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return depth[a] < depth[b]; });
+
+		jointRemap.assign(jointCount, 0);
+		nodeToJoint.assign(gltf.nodes.size(), -1);
+
+		for (size_t i = 0; i < jointCount; ++i)
+		{
+			jointRemap[order[i]] = static_cast<int>(i);
+			nodeToJoint[skin.joints[order[i]]] = static_cast<int>(i);
+		}
+
+		DataGetter ibmGetter = { nullptr, 0, 0, 0, 0 };
+
+		if (skin.inverseBindMatrices != -1)
+		{
+			ibmGetter = BuildGetter(gltf, skin.inverseBindMatrices);
 
-		verts.resize(verts.size() + faceIndexer.len);
+			if (ibmGetter.elementSize != sizeof(glm::mat4) || ibmGetter.len < jointCount)
+			{
+				ibmGetter.data = nullptr;
+				warn += "\nInverse bind matrices are in a currently unsupported format.";
+			}
+		}
 
-		if (hasNormals)
-			normals.resize(normals.size() + faceIndexer.len);
+		skeleton.names.resize(jointCount);
+		skeleton.parents.resize(jointCount);
+		skeleton.inverseBind.resize(jointCount);
+		skeleton.rootTransforms.resize(jointCount);
+		skeleton.restPose.resize(jointCount);
 
-		if (hasUVs)
-			uvs.resize(uvs.size() + faceIndexer.len);
+		bool skippedNodes = false;
 
-		//This is the bit where we actually get to extracting our data.
-		for (size_t i = startIndex, f = 0; i < startIndex + faceIndexer.len && f < faceIndexer.len; ++i, ++f)
+		for (size_t i = 0; i < jointCount; ++i)
 		{
-			//What vertex do we need to look at?
-			GLshort vertIndex;
-			memcpy(&vertIndex, &faceIndexer.data[f * faceIndexer.stride], sizeof(GLshort));
+			int node = skin.joints[order[i]];
+
+			skeleton.names[i] = gltf.nodes[node].name;
+			skeleton.restPose[i] = GetNodePose(gltf, node);
+
+			//Without inverse bind matrices, the spec says to use identity.
+			if (ibmGetter.data != nullptr)
+				memcpy(&skeleton.inverseBind[i], &ibmGetter.data[order[i] * ibmGetter.stride], sizeof(glm::mat4));
+			else
+				skeleton.inverseBind[i] = glm::mat4(1.0f);
+
+			//Find our parent joint, collecting the transforms of any
+			//other nodes we pass on the way up.
+			glm::mat4 offset = glm::mat4(1.0f);
+			int p = nodeParents[node];
+
+			while (p != -1 && skinJoint[p] == -1)
+			{
+				offset = GetNodeMatrix(gltf, p) * offset;
+				p = nodeParents[p];
+			}
+
+			if (p == -1)
+			{
+				skeleton.parents[i] = -1;
+				skeleton.rootTransforms[i] = offset;
+			}
+			else
+			{
+				skeleton.parents[i] = jointRemap[skinJoint[p]];
+				skeleton.rootTransforms[i] = glm::mat4(1.0f);
+				skippedNodes = skippedNodes || offset != glm::mat4(1.0f);
+			}
+		}
+
+		if (skippedNodes)
+			warn += "\nSkin has non-joint nodes between joints - their transforms will be ignored.";
+
+		return true;
+	}
+
+	//Reads one keyframe value from an animation sampler's output.
+	//Cubic spline samplers store an in-tangent, value, and out-tangent for every key.
+	static glm::vec4 ReadKey(const DataGetter& getter, size_t key, int comps, bool cubic, int part = 1)
+	{
+		size_t index = cubic ? key * 3 + part : key;
+
+		glm::vec4 result = glm::vec4(0.0f);
+		memcpy(&result, &getter.data[index * getter.stride], comps * sizeof(float));
+		return result;
+	}
 
-			size_t vert = vertIndex;
+	bool ExtractAnimations(const tinygltf::Model& gltf, const Skeleton& skeleton,
+						   const std::vector<int>& nodeToJoint, float sampleRate,
+						   std::vector<AnimationClip>& clips,
+						   std::string& err, std::string& warn)
+	{
+		for (const tinygltf::Animation& anim : gltf.animations)
+		{
+			//First, make sure every channel is something we can read, and find
+			//out how long the animation is.
+			float duration = 0.0f;
 
-			//Grab our vertex position.
-			memcpy(&verts[i], &vGetter.data[vert * vGetter.stride], sizeof(glm::vec3));
+			for (const tinygltf::AnimationChannel& channel : anim.channels)
+			{
+				if (channel.sampler < 0 || channel.sampler >= static_cast<int>(anim.samplers.size()))
+				{
+					err = "Animation " + anim.name + " has a channel with a sampler that does not exist.";
+					return false;
+				}
+
+				if (channel.target_node >= static_cast<int>(nodeToJoint.size()))
+				{
+					err = "Animation " + anim.name + " targets a node that does not exist.";
+					return false;
+				}
+
+				if (channel.target_path != "translation" && channel.target_path != "rotation" &&
+					channel.target_path != "scale" && channel.target_path != "weights")
+				{
+					err = "Animation " + anim.name + " animates an unsupported property \"" + channel.target_path + "\".";
+					return false;
+				}
+
+				const tinygltf::AnimationSampler& sampler = anim.samplers[channel.sampler];
+				const int accessorCount = static_cast<int>(gltf.accessors.size());
+
+				if (sampler.input < 0 || sampler.input >= accessorCount ||
+					sampler.output < 0 || sampler.output >= accessorCount)
+				{
+					err = "Animation " + anim.name + " has a sampler without valid keys.";
+					return false;
+				}
+
+				if (sampler.interpolation != "LINEAR" && sampler.interpolation != "STEP" &&
+					sampler.interpolation != "CUBICSPLINE")
+				{
+					err = "Animation " + anim.name + " uses an unsupported interpolation \"" + sampler.interpolation + "\".";
+					return false;
+				}
+
+				if (channel.target_node < 0 || nodeToJoint[channel.target_node] == -1)
+					continue;
+
+				const tinygltf::Accessor& input = gltf.accessors[sampler.input];
+
+				if (input.maxValues.size() > 0)
+					duration = std::max(duration, static_cast<float>(input.maxValues[0]));
+			}
 
-			//Grab our vertex normal.
-			if (hasNormals)
-				memcpy(&normals[i], &nGetter.data[vert * nGetter.stride], sizeof(glm::vec3));
+			AnimationClip clip;
+			clip.m_name = anim.name;
+			clip.Allocate(skeleton, static_cast<size_t>(std::ceil(duration * sampleRate)) + 1, sampleRate);
 
-			//Grab our texture coordinates.
-			if (hasUVs)
+			for (const tinygltf::AnimationChannel& channel : anim.channels)
 			{
-				memcpy(&uvs[i], &uvGetter.data[vert * uvGetter.stride], sizeof(glm::vec2));
+				//We only support joint animations (no morph target weights).
+				if (channel.target_node < 0 || nodeToJoint[channel.target_node] == -1 ||
+					channel.target_path == "weights")
+					continue;
+
+				const size_t joint = nodeToJoint[channel.target_node];
+				const tinygltf::AnimationSampler& sampler = anim.samplers[channel.sampler];
+				const bool rotation = channel.target_path == "rotation";
+				const int comps = rotation ? 4 : 3;
+
+				DataGetter input = BuildGetter(gltf, sampler.input);
+				DataGetter output = BuildGetter(gltf, sampler.output);
+
+				if (input.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT ||
+					output.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT ||
+					output.elementSize != comps * static_cast<int>(sizeof(float)) ||
+					input.len == 0)
+				{
+					warn += "\nAnimation " + anim.name + " has keys in a currently unsupported format - skipping a channel.";
+					continue;
+				}
+
+				const bool step = sampler.interpolation == "STEP";
+				const bool cubic = sampler.interpolation == "CUBICSPLINE";
+
+				//Cubic splines store an in-tangent, value and out-tangent for each key.
+				if (output.len != input.len * (cubic ? 3 : 1))
+				{
+					err = "Animation " + anim.name + " has a sampler with a different number of keys and values.";
+					return false;
+				}
+
+				std::vector<float> times(input.len);
+
+				for (size_t k = 0; k < input.len; ++k)
+					memcpy(&times[k], &input.data[k * input.stride], sizeof(float));
+
+				size_t key = 0;
+
+				for (size_t f = 0; f < clip.GetFrameCount(); ++f)
+				{
+					float time = std::min(static_cast<float>(f) / sampleRate, duration);
+
+					while (key + 1 < times.size() && times[key + 1] <= time)
+						++key;
+
+					glm::vec4 value;
+
+					if (time <= times[0] || key + 1 >= times.size() || step)
+						value = ReadKey(output, key, comps, cubic);
+					else
+					{
+						float dt = times[key + 1] - times[key];
+						float t = (time - times[key]) / dt;
+
+						glm::vec4 v0 = ReadKey(output, key, comps, cubic);
+						glm::vec4 v1 = ReadKey(output, key + 1, comps, cubic);
+
+						if (cubic)
+						{
+							//Hermite spline, using the out-tangent of the first key
+							//and the in-tangent of the second.
+							glm::vec4 m0 = ReadKey(output, key, comps, cubic, 2) * dt;
+							glm::vec4 m1 = ReadKey(output, key + 1, comps, cubic, 0) * dt;
+
+							float t2 = t * t, t3 = t2 * t;
+
+							value = (2.0f * t3 - 3.0f * t2 + 1.0f) * v0 + (t3 - 2.0f * t2 + t) * m0 +
+									(-2.0f * t3 + 3.0f * t2) * v1 + (t3 - t2) * m1;
+						}
+						else if (rotation)
+						{
+							glm::quat q = glm::slerp(glm::quat(v0.w, v0.x, v0.y, v0.z),
+													 glm::quat(v1.w, v1.x, v1.y, v1.z), t);
+							value = glm::vec4(q.x, q.y, q.z, q.w);
+						}
+						else
+							value = glm::mix(v0, v1, t);
+					}
+
+					JointPose pose = clip.GetJointPose(f, joint);
+
+					if (rotation)
+						pose.rotation = glm::normalize(glm::quat(value.w, value.x, value.y, value.z));
+					else if (channel.target_path == "translation")
+						pose.pos = glm::vec3(value);
+					else
+						pose.scale = glm::vec3(value);
+
+					clip.SetJointPose(f, joint, pose);
+				}
+			}
 
-				//We may need to flip our vertical UV-coordinate.
-				//You will probably need to do this, depending on your export settings/texture.
-				if (flipUVY)
-					uvs[i].y = 1.0f - uvs[i].y;
+			//q and -q are the same rotation, so flip any rotations that would make
+			//a joint take the long way around between frames.
+			for (size_t j = 0; j < skeleton.JointCount(); ++j)
+			{
+				for (size_t f = 1; f < clip.GetFrameCount(); ++f)
+				{
+					JointPose prev = clip.GetJointPose(f - 1, j);
+					JointPose pose = clip.GetJointPose(f, j);
+
+					if (glm::dot(prev.rotation, pose.rotation) < 0.0f)
+					{
+						pose.rotation = -pose.rotation;
+						clip.SetJointPose(f, j, pose);
+					}
+				}
 			}
+
+			clips.push_back(std::move(clip));
 		}
 
 		return true;
 	}
 
+	JointPose GetNodePose(const tinygltf::Model& gltf, int node)
+	{
+		const tinygltf::Node& data = gltf.nodes[node];
+		JointPose pose;
+
+		if (data.matrix.size() == 16)
+		{
+			glm::vec3 skew;
+			glm::vec4 perspective;
+			glm::decompose(GetNodeMatrix(gltf, node), pose.scale, pose.rotation, pose.pos, skew, perspective);
+			return pose;
+		}
+
+		if (data.translation.size() == 3)
+			pose.pos = glm::vec3(data.translation[0], data.translation[1], data.translation[2]);
+
+		//glTF stores quaternions as XYZW, while GLM's constructor takes WXYZ.
+		if (data.rotation.size() == 4)
+			pose.rotation = glm::quat(static_cast<float>(data.rotation[3]), static_cast<float>(data.rotation[0]),
+									  static_cast<float>(data.rotation[1]), static_cast<float>(data.rotation[2]));
+
+		if (data.scale.size() == 3)
+			pose.scale = glm::vec3(data.scale[0], data.scale[1], data.scale[2]);
+
+		return pose;
+	}
+
+	glm::mat4 GetNodeMatrix(const tinygltf::Model& gltf, int node)
+	{
+		const tinygltf::Node& data = gltf.nodes[node];
+
+		//Matrices are stored column-major, same as GLM.
+		if (data.matrix.size() == 16)
+		{
+			glm::mat4 result;
+
+			for (int i = 0; i < 16; ++i)
+				result[i / 4][i % 4] = static_cast<float>(data.matrix[i]);
+
+			return result;
+		}
+
+		JointPose pose = GetNodePose(gltf, node);
+
+		return glm::translate(glm::mat4(1.0f), pose.pos) *
+			   glm::toMat4(pose.rotation) *
+			   glm::scale(glm::mat4(1.0f), pose.scale);
+	}
+
 	int FindAccessor(const tinygltf::Primitive& geom, const std::string& name)
 	{
 		auto it = geom.attributes.find(name);
@@ -300,6 +990,6 @@ namespace nou::GLTF
 		int size = tinygltf::GetComponentSizeInBytes(acc.componentType) *
 				   tinygltf::GetNumComponentsInType(acc.type);
 
-		return { data, len, stride, size };
+		return { data, len, stride, size, acc.componentType };
 	}
 }
\ No newline at end of file
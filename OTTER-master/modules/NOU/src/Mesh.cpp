@@ -8,26 +8,56 @@ Very basic class for managing the data associated with a 3D model.
 
 #include "NOU/Mesh.h"
 
+#include <utility>
+
 namespace nou
 {
-	void Mesh::SetVerts(const std::vector<glm::vec3>& verts)
+	void Mesh::SetVerts(std::vector<glm::vec3> verts)
 	{
-		m_verts = verts;
+		m_verts = std::move(verts);
 		SetVBO(Attrib::POSITION, 3, m_verts);
 	}
 
-	void Mesh::SetNormals(const std::vector<glm::vec3>& normals)
+	void Mesh::SetNormals(std::vector<glm::vec3> normals)
 	{
-		m_normals = normals;
+		m_normals = std::move(normals);
 		SetVBO(Attrib::NORMAL, 3, m_normals);			
 	}
 
-	void Mesh::SetUVs(const std::vector<glm::vec2>& uvs)
+	void Mesh::SetUVs(std::vector<glm::vec2> uvs)
 	{
-		m_uvs = uvs;
+		m_uvs = std::move(uvs);
 		SetVBO(Attrib::UV, 2, m_uvs);
 	}
 
+	void Mesh::SetJoints(std::vector<glm::vec4> joints)
+	{
+		m_joints = std::move(joints);
+		SetVBO(Attrib::JOINT_INFLUENCE, 4, m_joints);
+	}
+
+	void Mesh::SetWeights(std::vector<glm::vec4> weights)
+	{
+		m_weights = std::move(weights);
+		SetVBO(Attrib::SKIN_WEIGHT, 4, m_weights);
+	}
+
+	void Mesh::SetIndices(std::vector<GLuint> indices)
+	{
+		m_indices = std::move(indices);
+
+		//As with our VBOs, we can only keep the CPU-side copy without an OpenGL context.
+		if (glGenBuffers == nullptr)
+			return;
+
+		if (m_indices.size() == 0)
+			m_ibo.reset();
+		else if (m_ibo == nullptr)
+			m_ibo = std::make_unique<IndexBuffer>(m_indices);
+		else
+			m_ibo->UpdateData(m_indices);
+	}
+
 	const VertexBuffer* Mesh::GetVBO(Mesh::Attrib attrib) const
 	{
 		auto it = m_vbo.find(attrib);
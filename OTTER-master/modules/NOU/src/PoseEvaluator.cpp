@@ -0,0 +1,292 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+PoseEvaluator.cpp
+Computes the joint matrices needed to skin many characters
+sharing the same skeleton.
+*/
+
+#include "NOU/PoseEvaluator.h"
+
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+//Every x64 CPU supports SSE2, so we can always use it there.
+#if defined(_M_X64) || defined(__SSE2__)
+	#define NOU_USE_SSE
+	#include <emmintrin.h>
+#endif
+
+namespace nou
+{
+	//Blends between two quaternions (a to b).
+	//Proper slerp needs an acos and a few sines, which SSE can't do for us.
+	//Instead, we nlerp with the blend factor adjusted so that we follow the
+	//slerp arc closely (see Arseny Kapoulkine, "Approximating slerp", 2015).
+	//Since our clips are resampled, neighbouring frames are always close together,
+	//and the difference from a true slerp is far too small to see.
+	static inline float AdjustSlerpT(float t, float d)
+	{
+		float a = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+		float b = 0.848013f + d * (-1.06021f + d * 0.215638f);
+		float k = a * (t - 0.5f) * (t - 0.5f) + b;
+		return t + t * (t - 0.5f) * (t - 1.0f) * k;
+	}
+
+	PoseEvaluator::PoseEvaluator(const Skeleton& skeleton)
+	{
+		m_skeleton = &skeleton;
+		m_jointCount = skeleton.JointCount();
+	}
+
+	size_t PoseEvaluator::AddCharacter(const AnimationClip* clip, float time)
+	{
+		size_t index = m_clips.size();
+
+		m_clips.push_back(nullptr);
+		m_times.push_back(time);
+		m_palettes.resize(m_palettes.size() + m_jointCount, glm::mat4(1.0f));
+
+		SetClip(index, clip);
+
+		return index;
+	}
+
+	void PoseEvaluator::SetClip(size_t character, const AnimationClip* clip)
+	{
+		if (clip != nullptr && clip->GetJointCount() != m_jointCount)
+		{
+			printf("Animation clip %s does not match the skeleton (%zu joints vs %zu)!\n",
+				   clip->m_name.c_str(), clip->GetJointCount(), m_jointCount);
+			clip = nullptr;
+		}
+
+		m_clips[character] = clip;
+	}
+
+	void PoseEvaluator::SetTime(size_t character, float time)
+	{
+		m_times[character] = time;
+	}
+
+	void PoseEvaluator::Advance(float deltaTime)
+	{
+		for (size_t i = 0; i < m_clips.size(); ++i)
+		{
+			m_times[i] += deltaTime;
+
+			//Keep our times small, so we don't lose precision over a long session.
+			if (m_clips[i] != nullptr && m_clips[i]->GetDuration() > 0.0f)
+				m_times[i] = std::fmod(m_times[i], m_clips[i]->GetDuration());
+		}
+	}
+
+	void PoseEvaluator::Evaluate(const ParallelFor& parallelFor)
+	{
+		if (parallelFor)
+			parallelFor(m_clips.size(), 16, [this](size_t begin, size_t end) { EvaluateRange(begin, end); });
+		else
+			EvaluateRange(0, m_clips.size());
+	}
+
+	void PoseEvaluator::EvaluateRange(size_t begin, size_t end)
+	{
+		if (m_jointCount == 0)
+			return;
+
+		const size_t stride = (m_jointCount + 3) & ~size_t(3);
+
+		//Scratch space, reused for every character in our range.
+		std::vector<float> local(AnimationClip::TRACK_COUNT * stride);
+		std::vector<glm::mat4> global(m_jointCount);
+
+		const std::vector<int>& parents = m_skeleton->parents;
+		const std::vector<glm::mat4>& inverseBind = m_skeleton->inverseBind;
+		const std::vector<glm::mat4>& rootTransforms = m_skeleton->rootTransforms;
+
+		for (size_t c = begin; c < end; ++c)
+		{
+			const AnimationClip* clip = m_clips[c];
+			glm::mat4* palette = &m_palettes[c * m_jointCount];
+
+			//Characters with no animation use the skeleton's rest pose.
+			if (clip == nullptr)
+			{
+				for (size_t j = 0; j < m_jointCount; ++j)
+				{
+					const JointPose& pose = m_skeleton->restPose[j];
+
+					local[AnimationClip::POS_X * stride + j] = pose.pos.x;
+					local[AnimationClip::POS_Y * stride + j] = pose.pos.y;
+					local[AnimationClip::POS_Z * stride + j] = pose.pos.z;
+					local[AnimationClip::ROT_X * stride + j] = pose.rotation.x;
+					local[AnimationClip::ROT_Y * stride + j] = pose.rotation.y;
+					local[AnimationClip::ROT_Z * stride + j] = pose.rotation.z;
+					local[AnimationClip::ROT_W * stride + j] = pose.rotation.w;
+					local[AnimationClip::SCALE_X * stride + j] = pose.scale.x;
+					local[AnimationClip::SCALE_Y * stride + j] = pose.scale.y;
+					local[AnimationClip::SCALE_Z * stride + j] = pose.scale.z;
+				}
+			}
+			else
+				SampleClip(*clip, m_times[c], local.data());
+
+			const float* px = &local[AnimationClip::POS_X * stride];
+			const float* py = &local[AnimationClip::POS_Y * stride];
+			const float* pz = &local[AnimationClip::POS_Z * stride];
+			const float* qx = &local[AnimationClip::ROT_X * stride];
+			const float* qy = &local[AnimationClip::ROT_Y * stride];
+			const float* qz = &local[AnimationClip::ROT_Z * stride];
+			const float* qw = &local[AnimationClip::ROT_W * stride];
+			const float* sx = &local[AnimationClip::SCALE_X * stride];
+			const float* sy = &local[AnimationClip::SCALE_Y * stride];
+			const float* sz = &local[AnimationClip::SCALE_Z * stride];
+
+			//Parents always come before their children, so one pass
+			//from front to back gives us every joint's global transform.
+			for (size_t j = 0; j < m_jointCount; ++j)
+			{
+				glm::mat3 rot = glm::mat3_cast(glm::quat(qw[j], qx[j], qy[j], qz[j]));
+
+				glm::mat4 localMat = glm::mat4(glm::vec4(rot[0] * sx[j], 0.0f),
+											   glm::vec4(rot[1] * sy[j], 0.0f),
+											   glm::vec4(rot[2] * sz[j], 0.0f),
+											   glm::vec4(px[j], py[j], pz[j], 1.0f));
+
+				int parent = parents[j];
+				global[j] = (parent >= 0) ? global[parent] * localMat : rootTransforms[j] * localMat;
+
+				palette[j] = global[j] * inverseBind[j];
+			}
+		}
+	}
+
+	void PoseEvaluator::SampleClip(const AnimationClip& clip, float time, float* localOut)
+	{
+		const size_t stride = clip.GetStride();
+		const size_t lastFrame = (clip.GetFrameCount() > 0) ? clip.GetFrameCount() - 1 : 0;
+
+		//Find the two frames on either side of our time, looping around.
+		float duration = clip.GetDuration();
+		if (duration > 0.0f)
+		{
+			time = std::fmod(time, duration);
+			if (time < 0.0f)
+				time += duration;
+		}
+		else
+			time = 0.0f;
+
+		float frame = time * clip.GetSampleRate();
+		size_t f0 = std::min(static_cast<size_t>(frame), lastFrame);
+		size_t f1 = std::min(f0 + 1, lastFrame);
+		float t = std::min(std::max(frame - static_cast<float>(f0), 0.0f), 1.0f);
+
+		//Positions and scales just need a linear blend.
+		const AnimationClip::Track linearTracks[] = {
+			AnimationClip::POS_X, AnimationClip::POS_Y, AnimationClip::POS_Z,
+			AnimationClip::SCALE_X, AnimationClip::SCALE_Y, AnimationClip::SCALE_Z
+		};
+
+		for (AnimationClip::Track track : linearTracks)
+		{
+			const float* a = clip.GetTrack(f0, track);
+			const float* b = clip.GetTrack(f1, track);
+			float* out = &localOut[track * stride];
+
+		#ifdef NOU_USE_SSE
+			__m128 vt = _mm_set1_ps(t);
+
+			for (size_t j = 0; j < stride; j += 4)
+			{
+				__m128 va = _mm_loadu_ps(a + j);
+				__m128 vb = _mm_loadu_ps(b + j);
+				_mm_storeu_ps(out + j, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), vt)));
+			}
+		#else
+			for (size_t j = 0; j < stride; ++j)
+				out[j] = a[j] + (b[j] - a[j]) * t;
+		#endif
+		}
+
+		//Rotations take the shortest path between the two frames.
+		const float* ax = clip.GetTrack(f0, AnimationClip::ROT_X);
+		const float* ay = clip.GetTrack(f0, AnimationClip::ROT_Y);
+		const float* az = clip.GetTrack(f0, AnimationClip::ROT_Z);
+		const float* aw = clip.GetTrack(f0, AnimationClip::ROT_W);
+		const float* bx = clip.GetTrack(f1, AnimationClip::ROT_X);
+		const float* by = clip.GetTrack(f1, AnimationClip::ROT_Y);
+		const float* bz = clip.GetTrack(f1, AnimationClip::ROT_Z);
+		const float* bw = clip.GetTrack(f1, AnimationClip::ROT_W);
+		float* ox = &localOut[AnimationClip::ROT_X * stride];
+		float* oy = &localOut[AnimationClip::ROT_Y * stride];
+		float* oz = &localOut[AnimationClip::ROT_Z * stride];
+		float* ow = &localOut[AnimationClip::ROT_W * stride];
+
+	#ifdef NOU_USE_SSE
+		//Same as AdjustSlerpT, but for 4 joints at once.
+		const __m128 vt = _mm_set1_ps(t);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 signBit = _mm_set1_ps(-0.0f);
+		const __m128 tCurve = _mm_mul_ps(_mm_mul_ps(vt, _mm_sub_ps(vt, half)), _mm_sub_ps(vt, one));
+		const __m128 tCentre = _mm_mul_ps(_mm_sub_ps(vt, half), _mm_sub_ps(vt, half));
+
+		for (size_t j = 0; j < stride; j += 4)
+		{
+			__m128 x0 = _mm_loadu_ps(ax + j), y0 = _mm_loadu_ps(ay + j), z0 = _mm_loadu_ps(az + j), w0 = _mm_loadu_ps(aw + j);
+			__m128 x1 = _mm_loadu_ps(bx + j), y1 = _mm_loadu_ps(by + j), z1 = _mm_loadu_ps(bz + j), w1 = _mm_loadu_ps(bw + j);
+
+			__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x0, x1), _mm_mul_ps(y0, y1)),
+									_mm_add_ps(_mm_mul_ps(z0, z1), _mm_mul_ps(w0, w1)));
+
+			//If the quaternions are more than 180 degrees apart, flip the second one
+			//(it's the same rotation) so that we go the short way around.
+			__m128 flip = _mm_and_ps(dot, signBit);
+			x1 = _mm_xor_ps(x1, flip);
+			y1 = _mm_xor_ps(y1, flip);
+			z1 = _mm_xor_ps(z1, flip);
+			w1 = _mm_xor_ps(w1, flip);
+			__m128 d = _mm_andnot_ps(signBit, dot);
+
+			__m128 a = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-3.2452f),
+					   _mm_mul_ps(d, _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)))))));
+			__m128 b = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-1.06021f),
+					   _mm_mul_ps(d, _mm_set1_ps(0.215638f)))));
+			__m128 k = _mm_add_ps(_mm_mul_ps(a, tCentre), b);
+			__m128 ot = _mm_add_ps(vt, _mm_mul_ps(tCurve, k));
+
+			__m128 rx = _mm_add_ps(x0, _mm_mul_ps(_mm_sub_ps(x1, x0), ot));
+			__m128 ry = _mm_add_ps(y0, _mm_mul_ps(_mm_sub_ps(y1, y0), ot));
+			__m128 rz = _mm_add_ps(z0, _mm_mul_ps(_mm_sub_ps(z1, z0), ot));
+			__m128 rw = _mm_add_ps(w0, _mm_mul_ps(_mm_sub_ps(w1, w0), ot));
+
+			__m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)),
+												_mm_add_ps(_mm_mul_ps(rz, rz), _mm_mul_ps(rw, rw))));
+
+			_mm_storeu_ps(ox + j, _mm_div_ps(rx, len));
+			_mm_storeu_ps(oy + j, _mm_div_ps(ry, len));
+			_mm_storeu_ps(oz + j, _mm_div_ps(rz, len));
+			_mm_storeu_ps(ow + j, _mm_div_ps(rw, len));
+		}
+	#else
+		for (size_t j = 0; j < stride; ++j)
+		{
+			float dot = ax[j] * bx[j] + ay[j] * by[j] + az[j] * bz[j] + aw[j] * bw[j];
+			float sign = (dot < 0.0f) ? -1.0f : 1.0f;
+			float ot = AdjustSlerpT(t, std::abs(dot));
+
+			glm::vec4 r = glm::vec4(ax[j], ay[j], az[j], aw[j]) * (1.0f - ot) +
+						  glm::vec4(bx[j], by[j], bz[j], bw[j]) * (sign * ot);
+			r = glm::normalize(r);
+
+			ox[j] = r.x;
+			oy[j] = r.y;
+			oz[j] = r.z;
+			ow[j] = r.w;
+		}
+	#endif
+	}
+}
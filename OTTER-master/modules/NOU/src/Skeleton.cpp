@@ -0,0 +1,126 @@
+/*
+NOU Framework - Created for INFR 2310 at Ontario Tech.
+(c) Samantha Stahlke 2020
+
+Skeleton.cpp
+Classes for storing the joint hierarchy of a skinned model and the
+animations that can be played on it.
+*/
+
+#include "NOU/Skeleton.h"
+
+namespace nou
+{
+	int Skeleton::FindJoint(const std::string& name) const
+	{
+		for (size_t i = 0; i < names.size(); ++i)
+		{
+			if (names[i] == name)
+				return static_cast<int>(i);
+		}
+
+		return -1;
+	}
+
+	AnimationClip::AnimationClip()
+	{
+		m_jointCount = 0;
+		m_frameCount = 0;
+		m_stride = 0;
+		m_sampleRate = 30.0f;
+	}
+
+	void AnimationClip::Allocate(const Skeleton& skeleton, size_t frameCount, float sampleRate)
+	{
+		m_jointCount = skeleton.JointCount();
+		m_frameCount = frameCount;
+		m_sampleRate = sampleRate;
+
+		//Padding our tracks to a multiple of 4 joints means we can always
+		//process 4 joints at a time without worrying about the leftovers.
+		m_stride = (m_jointCount + 3) & ~size_t(3);
+
+		m_data.assign(m_frameCount * TRACK_COUNT * m_stride, 0.0f);
+
+		//Padding joints get an identity pose, so that they blend cleanly.
+		JointPose identity;
+
+		for (size_t f = 0; f < m_frameCount; ++f)
+		{
+			for (size_t j = 0; j < m_stride; ++j)
+				SetJointPose(f, j, (j < m_jointCount) ? skeleton.restPose[j] : identity);
+		}
+	}
+
+	void AnimationClip::SetJointPose(size_t frame, size_t joint, const JointPose& pose)
+	{
+		float* data = &m_data[frame * TRACK_COUNT * m_stride + joint];
+
+		data[POS_X * m_stride] = pose.pos.x;
+		data[POS_Y * m_stride] = pose.pos.y;
+		data[POS_Z * m_stride] = pose.pos.z;
+		data[ROT_X * m_stride] = pose.rotation.x;
+		data[ROT_Y * m_stride] = pose.rotation.y;
+		data[ROT_Z * m_stride] = pose.rotation.z;
+		data[ROT_W * m_stride] = pose.rotation.w;
+		data[SCALE_X * m_stride] = pose.scale.x;
+		data[SCALE_Y * m_stride] = pose.scale.y;
+		data[SCALE_Z * m_stride] = pose.scale.z;
+	}
+
+	JointPose AnimationClip::GetJointPose(size_t frame, size_t joint) const
+	{
+		const float* data = &m_data[frame * TRACK_COUNT * m_stride + joint];
+
+		JointPose pose;
+		pose.pos = glm::vec3(data[POS_X * m_stride], data[POS_Y * m_stride], data[POS_Z * m_stride]);
+		pose.rotation = glm::quat(data[ROT_W * m_stride], data[ROT_X * m_stride],
+								  data[ROT_Y * m_stride], data[ROT_Z * m_stride]);
+		pose.scale = glm::vec3(data[SCALE_X * m_stride], data[SCALE_Y * m_stride], data[SCALE_Z * m_stride]);
+
+		return pose;
+	}
+
+	float AnimationClip::GetDuration() const
+	{
+		if (m_frameCount < 2)
+			return 0.0f;
+
+		return static_cast<float>(m_frameCount - 1) / m_sampleRate;
+	}
+
+	void SkinVertices(const Mesh& mesh, const glm::mat4* palette,
+					  std::vector<glm::vec3>& vertsOut, std::vector<glm::vec3>& normalsOut)
+	{
+		const std::vector<glm::vec3>& verts = mesh.GetVerts();
+		const std::vector<glm::vec3>& normals = mesh.GetNormals();
+		const std::vector<glm::vec4>& joints = mesh.GetJoints();
+		const std::vector<glm::vec4>& weights = mesh.GetWeights();
+
+		vertsOut.resize(verts.size());
+		normalsOut.resize(normals.size());
+
+		//Without skinning data, the mesh just stays in its bind pose.
+		if (joints.size() != verts.size() || weights.size() != verts.size())
+		{
+			vertsOut = verts;
+			normalsOut = normals;
+			return;
+		}
+
+		for (size_t i = 0; i < verts.size(); ++i)
+		{
+			//Blend the matrices of the joints influencing this vertex,
+			//exactly as the skinning vertex shader does.
+			glm::mat4 skin = palette[(int)joints[i].x] * weights[i].x +
+							 palette[(int)joints[i].y] * weights[i].y +
+							 palette[(int)joints[i].z] * weights[i].z +
+							 palette[(int)joints[i].w] * weights[i].w;
+
+			vertsOut[i] = glm::vec3(skin * glm::vec4(verts[i], 1.0f));
+
+			if (i < normals.size())
+				normalsOut[i] = glm::normalize(glm::mat3(skin) * normals[i]);
+		}
+	}
+}
@@ -43,5 +43,14 @@ private:
 #define LOG_WARN(...)  ::Logger::GetLogger()->warn(__VA_ARGS__)
 #define LOG_ERROR(...) { ::Logger::GetLogger()->error(__VA_ARGS__); ::Logger::GetLogger()->error("Location: \n{}", ::Logger::DumpStackTrace()); }
 
+// Breaks into the debugger, __debugbreak is MSVC only so other compilers trap instead
+#ifndef DEBUG_BREAK
+#ifdef _MSC_VER
+#define DEBUG_BREAK() __debugbreak()
+#else
+#define DEBUG_BREAK() __builtin_trap()
+#endif
+#endif
+
 // Allows us to assert if a value is true, and automagically debug break if it is false
-#define LOG_ASSERT(x, ...) { if (!(x)) { ::Logger::GetLogger()->error(__VA_ARGS__); __debugbreak(); } }
\ No newline at end of file
+#define LOG_ASSERT(x, ...) { if (!(x)) { ::Logger::GetLogger()->error(__VA_ARGS__); DEBUG_BREAK(); } }
\ No newline at end of file
@@ -18,8 +18,7 @@ project "toolkit"
         "Glad",
         "GLFW",
         "stbs",
-        "spdlog",
-        "opengl32.lib"
+        "spdlog"
     }
 
     includedirs {
@@ -46,6 +45,10 @@ project "toolkit"
             "TTK_GLFW"
         }
 
+        links {
+            "opengl32.lib"
+        }
+
         
     filter "configurations:Debug"
         runtime "Debug"
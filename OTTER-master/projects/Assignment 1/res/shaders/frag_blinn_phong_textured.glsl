@@ -4,8 +4,10 @@ layout(location = 0) in vec3 inPos;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec3 inNormal;
 layout(location = 3) in vec2 inUV;
+// The layer of the diffuse array to sample, see ShaderMaterial::MaterialParams
+layout(location = 4) flat in float inLayer;
 
-uniform sampler2D s_Diffuse;
+uniform sampler2DArray s_Diffuse;
 uniform sampler2D s_Diffuse2;
 
 uniform vec3  u_AmbientCol;
@@ -22,7 +24,14 @@ uniform float u_LightAttenuationConstant;
 uniform float u_LightAttenuationLinear;
 uniform float u_LightAttenuationQuadratic;
 
-uniform vec3  u_CamPos;
+// Per-frame camera data, shared by all shaders (see BackendHandler::FrameUniforms)
+layout(std140) uniform b_FrameData {
+	mat4 u_View;
+	mat4 u_Projection;
+	mat4 u_ViewProjection;
+	mat4 u_SkyboxMatrix;
+	vec3 u_CamPos;
+};
 
 uniform int u_Condition;
 
@@ -62,7 +71,7 @@ void main() {
 	vec3 specular = u_SpecularLightStrength * texSpec * spec * u_LightCol; // Can also use a specular color
 
 	// Get the albedo from the diffuse / albedo map
-	vec4 textureColor = texture(s_Diffuse, inUV);
+	vec4 textureColor = texture(s_Diffuse, vec3(inUV, inLayer));
 
 	//Toon-Shading
 	vec3 diffuseOut = (dif * u_LightCol) / (dist * dist);
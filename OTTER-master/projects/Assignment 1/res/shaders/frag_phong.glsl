@@ -12,7 +12,14 @@ uniform vec3  u_LightCol;
 uniform float u_AmbientLightStrength;
 uniform float u_Shininess;
 
-uniform vec3  u_CamPos;
+// Per-frame camera data, shared by all shaders (see BackendHandler::FrameUniforms)
+layout(std140) uniform b_FrameData {
+	mat4 u_View;
+	mat4 u_Projection;
+	mat4 u_ViewProjection;
+	mat4 u_SkyboxMatrix;
+	vec3 u_CamPos;
+};
 
 out vec4 frag_color;
 
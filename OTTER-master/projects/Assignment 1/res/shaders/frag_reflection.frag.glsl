@@ -8,7 +8,14 @@ layout(location = 3) in vec2 inUV;
 uniform samplerCube s_Environment;
 uniform mat3 u_EnvironmentRotation;
 
-uniform vec3  u_CamPos;
+// Per-frame camera data, shared by all shaders (see BackendHandler::FrameUniforms)
+layout(std140) uniform b_FrameData {
+	mat4 u_View;
+	mat4 u_Projection;
+	mat4 u_ViewProjection;
+	mat4 u_SkyboxMatrix;
+	vec3 u_CamPos;
+};
 
 out vec4 frag_color;
 
@@ -1,5 +1,7 @@
 #version 410
 
+// Meshes may store these packed (see VertexPacking.h), in which case OpenGL unpacks them to floats as they are read.
+// Quantized positions are decoded by the model matrix, see VertexArrayObject::ApplyVertexDecode
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec3 inNormal;
@@ -11,7 +13,14 @@ layout(location = 2) out vec3 outNormal;
 layout(location = 3) out vec2 outUV;
 
 uniform mat4 u_ModelViewProjection;
-uniform mat4 u_View;
+// Per-frame camera data, shared by all shaders (see BackendHandler::FrameUniforms)
+layout(std140) uniform b_FrameData {
+	mat4 u_View;
+	mat4 u_Projection;
+	mat4 u_ViewProjection;
+	mat4 u_SkyboxMatrix;
+	vec3 u_CamPos;
+};
 uniform mat4 u_Model;
 uniform mat3 u_NormalMatrix;
 uniform vec3 u_LightPos;
@@ -0,0 +1,52 @@
+#version 410
+
+// Meshes may store these packed (see VertexPacking.h), in which case OpenGL unpacks them to floats as they are read.
+// Quantized positions are decoded by the model matrix, see VertexArrayObject::ApplyVertexDecode
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inUV;
+
+// Per-instance data, see InstanceBuffer
+layout(location = 4) in mat4 inInstanceModel;
+layout(location = 8) in mat3 inInstanceNormalMatrix;
+// The material's per-instance values, the layer of the diffuse array in x (see ShaderMaterial::MaterialParams)
+layout(location = 12) in vec4 inInstanceMaterialParams;
+
+layout(location = 0) out vec3 outPos;
+layout(location = 1) out vec3 outColor;
+layout(location = 2) out vec3 outNormal;
+layout(location = 3) out vec2 outUV;
+layout(location = 4) flat out float outLayer;
+
+// Per-frame camera data, shared by all shaders (see BackendHandler::FrameUniforms)
+layout(std140) uniform b_FrameData {
+	mat4 u_View;
+	mat4 u_Projection;
+	mat4 u_ViewProjection;
+	mat4 u_SkyboxMatrix;
+	vec3 u_CamPos;
+};
+
+uniform vec3 u_LightPos;
+
+
+void main() {
+
+	// Pass vertex pos in world space to frag shader
+	vec4 worldPos = inInstanceModel * vec4(inPosition, 1.0);
+	outPos = worldPos.xyz;
+
+	gl_Position = u_ViewProjection * worldPos;
+
+	// Normals
+	outNormal = inInstanceNormalMatrix * inNormal;
+
+	// Pass our UV coords to the fragment shader
+	outUV = inUV;
+	outLayer = inInstanceMaterialParams.x;
+
+	///////////
+	outColor = inColor;
+
+}
@@ -0,0 +1,87 @@
+#version 410
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inUV;
+
+// Per-instance data, see InstanceBuffer
+layout(location = 4) in mat4 inInstanceModel;
+layout(location = 8) in mat3 inInstanceNormalMatrix;
+// The frames to blend between in x and y, and the blend factor in z (see MorphPose)
+layout(location = 11) in vec4 inInstanceParams;
+// The material's per-instance values, the layer of the diffuse array in x (see ShaderMaterial::MaterialParams)
+layout(location = 12) in vec4 inInstanceMaterialParams;
+
+layout(location = 0) out vec3 outPos;
+layout(location = 1) out vec3 outColor;
+layout(location = 2) out vec3 outNormal;
+layout(location = 3) out vec2 outUV;
+layout(location = 4) flat out float outLayer;
+
+// Per-frame camera data, shared by all shaders (see BackendHandler::FrameUniforms)
+layout(std140) uniform b_FrameData {
+	mat4 u_View;
+	mat4 u_Projection;
+	mat4 u_ViewProjection;
+	mat4 u_SkyboxMatrix;
+	vec3 u_CamPos;
+};
+
+// The offset and normal of every vertex in every frame, see MorphAnimation
+uniform isamplerBuffer s_MorphFrames;
+uniform int   u_MorphVertexCount;
+uniform int   u_MorphQuantized;
+uniform float u_MorphDeltaScale;
+
+uniform vec3 u_LightPos;
+
+// Decodes a normal that was packed onto an octahedron
+vec3 OctDecode(vec2 e) {
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if (n.z < 0.0) {
+		n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	}
+	return normalize(n);
+}
+
+// Reads the offset and normal of this vertex in the given frame
+void ReadFrame(int frame, out vec3 offset, out vec3 normal) {
+	int index = frame * u_MorphVertexCount + gl_VertexID;
+	if (u_MorphQuantized != 0) {
+		ivec4 texel = texelFetch(s_MorphFrames, index);
+		offset = vec3(texel.xyz) * (u_MorphDeltaScale / 32767.0);
+		vec2 oct = vec2(bitfieldExtract(texel.w, 0, 8), bitfieldExtract(texel.w, 8, 8)) / 127.0;
+		normal = OctDecode(clamp(oct, -1.0, 1.0));
+	} else {
+		offset = intBitsToFloat(texelFetch(s_MorphFrames, index * 2).xyz);
+		normal = intBitsToFloat(texelFetch(s_MorphFrames, index * 2 + 1).xyz);
+	}
+}
+
+void main() {
+
+	// Blend between the two keyframes for this instance
+	vec3 offset0, normal0, offset1, normal1;
+	ReadFrame(int(inInstanceParams.x), offset0, normal0);
+	ReadFrame(int(inInstanceParams.y), offset1, normal1);
+	vec3 position = inPosition + mix(offset0, offset1, inInstanceParams.z);
+	vec3 normal = normalize(mix(normal0, normal1, inInstanceParams.z));
+
+	// Pass vertex pos in world space to frag shader
+	vec4 worldPos = inInstanceModel * vec4(position, 1.0);
+	outPos = worldPos.xyz;
+
+	gl_Position = u_ViewProjection * worldPos;
+
+	// Normals
+	outNormal = inInstanceNormalMatrix * normal;
+
+	// Pass our UV coords to the fragment shader
+	outUV = inUV;
+	outLayer = inInstanceMaterialParams.x;
+
+	///////////
+	outColor = inColor;
+
+}
@@ -2,6 +2,7 @@
 
 GLFWwindow* BackendHandler::window = nullptr;
 std::vector<std::function<void()>> BackendHandler::imGuiCallbacks;
+UniformBuffer::sptr BackendHandler::frameUniforms = nullptr;
 
 
 void BackendHandler::GlDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam)
@@ -31,13 +32,16 @@ void BackendHandler::GlDebugMessage(GLenum source, GLenum type, GLuint id, GLenu
 bool BackendHandler::InitAll()
 {
 	Logger::Init();
+	// The job system starts first, so that the main thread is the one that owns it
+	JobSystem::Init();
 
-	if (!InitGLFW())
-		return 1;
-	if (!InitGLAD())
-		return 1;
+	if (!InitGLFW() || !InitGLAD()) {
+		JobSystem::Shutdown();
+		return false;
+	}
 
 	InitImGui();
+	return true;
 }
 
 void BackendHandler::GlfwWindowResizedCallback(GLFWwindow* window, int width, int height)
@@ -122,6 +126,13 @@ void BackendHandler::ShutdownImGui()
 	ImGui::DestroyContext();
 }
 
+void BackendHandler::ShutdownAll()
+{
+	ShutdownImGui();
+	// Let any background work finish before we unload the logger
+	JobSystem::Shutdown();
+}
+
 void BackendHandler::RenderImGui()
 {
 	// Implementation new frame
@@ -158,21 +169,39 @@ void BackendHandler::RenderImGui()
 	}
 }
 
-void BackendHandler::RenderVAO(const Shader::sptr& shader, const VertexArrayObject::sptr& vao, const glm::mat4& viewProjection, const Transform& transform)
+// We resolve these once at compile time, so per-draw uniform lookups don't need to build or hash strings
+static constexpr UniformId U_MODEL_VIEW_PROJECTION("u_ModelViewProjection");
+static constexpr UniformId U_MODEL("u_Model");
+static constexpr UniformId U_NORMAL_MATRIX("u_NormalMatrix");
+
+void BackendHandler::RenderVAO(const Shader::sptr& shader, const VertexArrayObject& vao, const glm::mat4& viewProjection, const Transform& transform, uint32_t lod)
 {
-	shader->SetUniformMatrix("u_ModelViewProjection", viewProjection * transform.WorldTransform());
-	shader->SetUniformMatrix("u_Model", transform.WorldTransform());
-	shader->SetUniformMatrix("u_NormalMatrix", transform.WorldNormalMatrix());
-	vao->Render();
+	// Quantized meshes need their positions decoded, which we fold into the model matrix
+	const glm::mat4 model = vao.ApplyVertexDecode(transform.WorldTransform());
+	shader->SetUniformMatrix(U_MODEL_VIEW_PROJECTION, viewProjection * model);
+	shader->SetUniformMatrix(U_MODEL, model);
+	shader->SetUniformMatrix(U_NORMAL_MATRIX, transform.WorldNormalMatrix());
+	vao.Render(lod);
 }
 
-void BackendHandler::SetupShaderForFrame(const Shader::sptr& shader, const glm::mat4& view, const glm::mat4& projection)
+void BackendHandler::UpdateFrameUniforms(const glm::mat4& view, const glm::mat4& projection)
 {
-	shader->Bind();
-	// These are the uniforms that update only once per frame
-	shader->SetUniformMatrix("u_View", view);
-	shader->SetUniformMatrix("u_ViewProjection", projection * view);
-	shader->SetUniformMatrix("u_SkyboxMatrix", projection * glm::mat4(glm::mat3(view)));
-	glm::vec3 camPos = glm::inverse(view) * glm::vec4(0, 0, 0, 1);
-	shader->SetUniform("u_CamPos", camPos);
+	if (frameUniforms == nullptr) {
+		frameUniforms = UniformBuffer::Create();
+	}
+
+	FrameUniforms data;
+	data.View = view;
+	data.Projection = projection;
+	data.ViewProjection = projection * view;
+	data.SkyboxMatrix = projection * glm::mat4(glm::mat3(view));
+	data.CamPos = glm::inverse(view) * glm::vec4(0, 0, 0, 1);
+
+	frameUniforms->Update(data);
+	frameUniforms->Bind(FRAME_UNIFORM_BINDING);
 }
+
+void BackendHandler::BindFrameUniforms(const Shader::sptr& shader)
+{
+	shader->SetUniformBlockBinding("b_FrameData", FRAME_UNIFORM_BINDING);
+}
\ No newline at end of file
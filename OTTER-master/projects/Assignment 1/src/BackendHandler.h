@@ -9,10 +9,12 @@
 #include <Transform.h>
 #include <VertexArrayObject.h>
 #include <Shader.h>
+#include <UniformBuffer.h>
 
 #include <Application.h>
 #include <Camera.h>
 #include <Scene.h>
+#include <JobSystem.h>
 
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
@@ -20,7 +22,7 @@
 
 #define LOG_GL_NOTIFICATIONS
 
-class BackendHandler abstract
+class BackendHandler
 {
 public:
 	/*
@@ -38,6 +40,8 @@ public:
 
 	//Initialize everything
 	static bool InitAll();
+	//Shut down everything InitAll started, once the scene has been released
+	static void ShutdownAll();
 
 	//Window resize callback
 	static void GlfwWindowResizedCallback(GLFWwindow* window, int width, int height);
@@ -51,10 +55,29 @@ public:
 	static void ShutdownImGui();
 	static void RenderImGui();
 
+	// The per-frame camera data, this must match the std140 layout of b_FrameData in our shaders
+	struct FrameUniforms {
+		glm::mat4 View;
+		glm::mat4 Projection;
+		glm::mat4 ViewProjection;
+		glm::mat4 SkyboxMatrix;
+		glm::vec4 CamPos; // Only xyz is used, but a vec3 takes up a full vec4 in std140
+	};
+	// The uniform buffer binding point that b_FrameData is bound to
+	static const GLuint FRAME_UNIFORM_BINDING = 0;
+
 	//Render our VAO
-	static void RenderVAO(const Shader::sptr& shader, const VertexArrayObject::sptr& vao, const glm::mat4& viewProjection, const Transform& transform);
-	static void SetupShaderForFrame(const Shader::sptr& shader, const glm::mat4& view, const glm::mat4& projection);
+	static void RenderVAO(const Shader::sptr& shader, const VertexArrayObject& vao, const glm::mat4& viewProjection, const Transform& transform, uint32_t lod = 0);
+	// Uploads the camera data for the frame, this only needs to be called once per frame, not for every shader
+	static void UpdateFrameUniforms(const glm::mat4& view, const glm::mat4& projection);
+	// Connects a shader's b_FrameData block to the frame uniform buffer, call once after linking
+	static void BindFrameUniforms(const Shader::sptr& shader);
+
+	static UniformBuffer::sptr frameUniforms;
 
 	static GLFWwindow* window;
 	static std::vector<std::function<void()>> imGuiCallbacks;
+
+	// Everything here is static, so nobody should make one (this replaces MSVC's abstract keyword)
+	BackendHandler() = delete;
 };
\ No newline at end of file
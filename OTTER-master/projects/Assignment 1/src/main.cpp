@@ -7,15 +7,27 @@
 
 #include <Texture2D.h>
 #include <Texture2DData.h>
+#include <Texture2DArray.h>
 #include <MeshBuilder.h>
 #include <MeshFactory.h>
 #include <NotObjLoader.h>
 #include <ObjLoader.h>
+#include <AssetCache.h>
+#include <AssetStreamer.h>
 #include <VertexTypes.h>
+#include <InstanceBuffer.h>
+#include <RenderQueue.h>
+#include <Frustum.h>
+#include <TransformSystem.h>
+#include <RenderState.h>
+#include <Profiler.h>
+#include <FrameScheduler.h>
+#include <ProfilerPanel.h>
 #include <ShaderMaterial.h>
 #include <RendererComponent.h>
 #include <TextureCubeMap.h>
 #include <TextureCubeMapData.h>
+#include <MorphAnimation.h>
 
 #include <Timing.h>
 #include <GameObjectTag.h>
@@ -25,14 +37,23 @@
 #include <CameraControlBehaviour.h>
 #include <FollowPathBehaviour.h>
 #include <SimpleMoveBehaviour.h>
+#include <MorphAnimator.h>
+#include <SceneAssets.h>
+#include <SceneSerializer.h>
 
 int main() { 
-	int frameIx = 0;
-	float fpsBuffer[128];
-	float minFps, maxFps, avgFps;
 	int toggleMode = 0;
-
-	BackendHandler::InitAll();
+	// The simulation runs at a fixed 60 Hz, no matter how fast we render
+	FrameScheduler::sptr scheduler = FrameScheduler::Create(1.0f / 60.0f, 5);
+	int simulationRate = 60;
+	int objectsDrawn = 0, objectsCulled = 0;
+	// Meshes with levels of detail are drawn at the coarsest level that stays within this many pixels of the full mesh
+	bool useLods = true;
+	float lodPixelError = RendererComponent::DEFAULT_LOD_PIXEL_ERROR;
+	int trianglesFullDetail = 0;
+
+	if (!BackendHandler::InitAll())
+		return 1;
 
 	// Let OpenGL know that we want debug output, and route it to our handler function
 	glEnable(GL_DEBUG_OUTPUT);
@@ -46,9 +67,23 @@ int main() {
 		#pragma region Shader and ImGui
 		// Load our shaders
 		Shader::sptr shader = Shader::Create();
-		shader->LoadShaderPartFromFile("shaders/vertex_shader.glsl", GL_VERTEX_SHADER);
+		shader->LoadShaderPartFromFile("shaders/vertex_shader_instanced.glsl", GL_VERTEX_SHADER);
 		shader->LoadShaderPartFromFile("shaders/frag_blinn_phong_textured.glsl", GL_FRAGMENT_SHADER);
 		shader->Link();
+		BackendHandler::BindFrameUniforms(shader);
+
+		// The animated chickens blend between keyframes in their own vertex shader, but are lit the same as everything else
+		Shader::sptr morphShader = Shader::Create();
+		morphShader->LoadShaderPartFromFile("shaders/vertex_shader_morph.glsl", GL_VERTEX_SHADER);
+		morphShader->LoadShaderPartFromFile("shaders/frag_blinn_phong_textured.glsl", GL_FRAGMENT_SHADER);
+		morphShader->Link();
+		BackendHandler::BindFrameUniforms(morphShader);
+
+		// Sets a lighting uniform on all of our lit shaders
+		auto setLightingUniform = [&](const std::string& name, const auto& value) {
+			shader->SetUniform(name, value);
+			morphShader->SetUniform(name, value);
+		};
 
 		glm::vec3 lightPos = glm::vec3(0.0f, 0.0f, 2.0f);
 		//::vec3 lightCol = glm::vec3(0.f);//0.9,0.85,0.5
@@ -63,17 +98,17 @@ int main() {
 
 		// These are our application / scene level uniforms that don't necessarily update
 		// every frame
-		shader->SetUniform("u_LightPos", lightPos); 
-		//shader->SetUniform("u_LightCol", lightCol);
-		//shader->SetUniform("u_AmbientLightStrength", lightAmbientPow);
-		//shader->SetUniform("u_SpecularLightStrength", lightSpecularPow);
-		//shader->SetUniform("u_AmbientCol", ambientCol); 
-		//shader->SetUniform("u_AmbientStrength", ambientPow);
-		shader->SetUniform("u_LightAttenuationConstant", 1.0f);
-		shader->SetUniform("u_LightAttenuationLinear", lightLinearFalloff); 
-		shader->SetUniform("u_LightAttenuationQuadratic", lightQuadraticFalloff);
-
-		shader->SetUniform("u_Condition", condition);
+		setLightingUniform("u_LightPos", lightPos); 
+		//setLightingUniform("u_LightCol", lightCol);
+		//setLightingUniform("u_AmbientLightStrength", lightAmbientPow);
+		//setLightingUniform("u_SpecularLightStrength", lightSpecularPow);
+		//setLightingUniform("u_AmbientCol", ambientCol); 
+		//setLightingUniform("u_AmbientStrength", ambientPow);
+		setLightingUniform("u_LightAttenuationConstant", 1.0f);
+		setLightingUniform("u_LightAttenuationLinear", lightLinearFalloff); 
+		setLightingUniform("u_LightAttenuationQuadratic", lightQuadraticFalloff);
+
+		setLightingUniform("u_Condition", condition);
 		 
 		// We'll add some ImGui controls to control our shader 
 		BackendHandler::imGuiCallbacks.push_back([&]() { 	 
@@ -81,59 +116,59 @@ int main() {
 			if (ImGui::Button("No Lighting"))
 			{
 				toggleMode = 0;
-				shader->SetUniform("u_Condition", 0);
+				setLightingUniform("u_Condition", 0);
 			}
 			// Ambient Light Toggle
 			if (ImGui::Button("Ambient Only"))
 			{
 				toggleMode = 1;
-				shader->SetUniform("u_Condition", 1);
+				setLightingUniform("u_Condition", 1);
 
-				shader->SetUniform("u_AmbientCol", glm::vec3(1.0f)); 
-				shader->SetUniform("u_AmbientStrength", 0.38f); 
-				shader->SetUniform("u_AmbientLightStrength", 0.05f); 
-				shader->SetUniform("u_LightCol", glm::vec3(1.0f)); 
+				setLightingUniform("u_AmbientCol", glm::vec3(1.0f)); 
+				setLightingUniform("u_AmbientStrength", 0.38f); 
+				setLightingUniform("u_AmbientLightStrength", 0.05f); 
+				setLightingUniform("u_LightCol", glm::vec3(1.0f)); 
 			}
 			// Diffuse Light Toggle
 			if (ImGui::Button("Diffuse Only"))
 			{
 				toggleMode = 2;
-				shader->SetUniform("u_Condition", 2);
+				setLightingUniform("u_Condition", 2);
 				 
-				shader->SetUniform("u_LightCol", glm::vec3(1.0f)); 
+				setLightingUniform("u_LightCol", glm::vec3(1.0f)); 
 			}   
 			// Specular Light Toggle
 			if (ImGui::Button("Specular Only"))
 			{
 				toggleMode = 3;
-				shader->SetUniform("u_Condition", 3);
+				setLightingUniform("u_Condition", 3);
 				   
-				shader->SetUniform("u_LightCol", glm::vec3(1.0f)); 
-				shader->SetUniform("u_SpecularLightStrength", 1.f);
+				setLightingUniform("u_LightCol", glm::vec3(1.0f)); 
+				setLightingUniform("u_SpecularLightStrength", 1.f);
 			} 
 			// Blinn-Phong Toggle
 			if (ImGui::Button("Ambient + Specular + Diffuse"))
 			{
 				toggleMode = 4;
-				shader->SetUniform("u_Condition", 4);
+				setLightingUniform("u_Condition", 4);
 
-				shader->SetUniform("u_LightCol", glm::vec3(1.f));
-				shader->SetUniform("u_AmbientLightStrength", 0.05f); 
-				shader->SetUniform("u_AmbientCol", glm::vec3(1.0f)); 
-				shader->SetUniform("u_AmbientStrength", 0.38f);
-				shader->SetUniform("u_SpecularLightStrength", 1.f);
+				setLightingUniform("u_LightCol", glm::vec3(1.f));
+				setLightingUniform("u_AmbientLightStrength", 0.05f); 
+				setLightingUniform("u_AmbientCol", glm::vec3(1.0f)); 
+				setLightingUniform("u_AmbientStrength", 0.38f);
+				setLightingUniform("u_SpecularLightStrength", 1.f);
 			}
 			// Blinn-Phong w/ Toon Shading Toggle
 			if (ImGui::Button("Ambient + Specular + Diffuse + Toon-Shading"))
 			{
 				toggleMode = 5;
-				shader->SetUniform("u_Condition", 5);
+				setLightingUniform("u_Condition", 5);
 
-				shader->SetUniform("u_LightCol", glm::vec3(1.f));
-				shader->SetUniform("u_AmbientLightStrength", 0.05f);
-				shader->SetUniform("u_AmbientCol", glm::vec3(1.0f));
-				shader->SetUniform("u_AmbientStrength", 0.38f);
-				shader->SetUniform("u_SpecularLightStrength", 1.f);
+				setLightingUniform("u_LightCol", glm::vec3(1.f));
+				setLightingUniform("u_AmbientLightStrength", 0.05f);
+				setLightingUniform("u_AmbientCol", glm::vec3(1.0f));
+				setLightingUniform("u_AmbientStrength", 0.38f);
+				setLightingUniform("u_SpecularLightStrength", 1.f);
 			}			
 			
 			ImGui::Text("Toggle Mode: ", toggleMode);
@@ -170,16 +205,33 @@ int main() {
 				ImGui::Text("Ambient + Diffuse + Specular + Toon Shading");
 			}
 
-			minFps = FLT_MAX;
-			maxFps = 0;
-			avgFps = 0;
-			for (int ix = 0; ix < 128; ix++) {
-				if (fpsBuffer[ix] < minFps) { minFps = fpsBuffer[ix]; }
-				if (fpsBuffer[ix] > maxFps) { maxFps = fpsBuffer[ix]; }
-				avgFps += fpsBuffer[ix];
+			// Simulation rate, and how the fixed steps are keeping up with rendering
+			if (ImGui::SliderInt("Simulation Hz", &simulationRate, 10, 240)) {
+				scheduler->FixedTimeStep = 1.0f / simulationRate;
+			}
+			ImGui::Checkbox("Interpolate", &scheduler->Interpolate);
+			ImGui::Text("Fixed steps: %d this frame, %.2f s dropped", (int)scheduler->GetStepsThisFrame(), scheduler->GetDroppedTime());
+
+			// Frame times, and where each frame's time went
+			if (ImGui::CollapsingHeader("Profiler")) {
+				ProfilerPanel::Render();
 			}
-			ImGui::PlotLines("FPS", fpsBuffer, 128);
-			ImGui::Text("MIN: %f MAX: %f AVG: %f", minFps, maxFps, avgFps / 128.0f);
+
+			AssetCache::Stats assetStats = AssetCache::GetStats();
+			ImGui::Text("Assets: %d loaded (%.2f MB), %d hits, %d misses", (int)assetStats.ResidentCount,
+				assetStats.ResidentBytes / (1024.0f * 1024.0f), (int)assetStats.Hits, (int)assetStats.Misses);
+
+			AssetStreamer::Stats streamStats = AssetStreamer::GetStats();
+			ImGui::Text("Streaming: %d pending, %d queued, %d uploaded last frame (%.2f ms)", (int)streamStats.PendingCount,
+				(int)streamStats.QueuedUploads, (int)streamStats.LastFrameUploads, streamStats.LastFrameMs);
+
+			ImGui::Text("Objects: %d drawn, %d culled", objectsDrawn, objectsCulled);
+			const RenderState::Stats& renderStats = RenderState::GetStats();
+			ImGui::Text("Draws: %d, state changes: %d, cache hits: %d", (int)renderStats.DrawCalls,
+				(int)renderStats.StateChanges, (int)renderStats.CacheHits);
+			ImGui::Text("Triangles: %d submitted, %d at full detail", (int)renderStats.Triangles, trianglesFullDetail);
+			ImGui::Checkbox("Use LODs", &useLods);
+			ImGui::SliderFloat("LOD pixel error", &lodPixelError, 0.25f, 8.0f);
 			});
 		#pragma endregion 
 
@@ -189,36 +241,64 @@ int main() {
 		glDepthFunc(GL_LEQUAL); // New  
 
 		#pragma region TEXTURE LOADING
-		// Load some textures from files
-		Texture2D::sptr groundTex = Texture2D::LoadFromFile("images/grass.jpg");
-		Texture2D::sptr chickenTex = Texture2D::LoadFromFile("images/DrumstickTexture.png");
-		Texture2D::sptr stoneTex = Texture2D::LoadFromFile("images/Stone_001_Specular.png");
-		Texture2D::sptr buttonTex = Texture2D::LoadFromFile("images/ButtonTexture.png");
+		// Start loading some textures from files, these will stream in over the first few frames
+		// The diffuse textures are stored as layers of a single array, so that objects which only differ by their texture
+		// share a material batch, and the layer is passed along with each instance (see ShaderMaterial::MaterialParams)
+		AssetHandle<Texture2DArray> diffuseArray = AssetStreamer::LoadTexture2DArrayAsync("images/diffuse.dds", {
+			"images/DrumstickTexture.png", "images/Stone_001_Specular.png", "images/ButtonTexture.png"
+		});
+		const float chickenLayer = 0.0f;
+		const float stoneLayer = 1.0f;
+		const float buttonLayer = 2.0f;
 
 		// Load the cube map
-		TextureCubeMap::sptr environmentMap = TextureCubeMap::LoadFromImages("images/cubemaps/skybox/ocean.jpg");
+		AssetHandle<TextureCubeMap> environmentMap = AssetStreamer::LoadCubeMapAsync("images/cubemaps/skybox/ocean.jpg");
 		
-		// Creating an empty texture
-		Texture2DDescription desc = Texture2DDescription();
+		// Creating an empty texture array to use until the diffuse array is ready, it only has one layer, but OpenGL
+		// clamps the layer index so it works for any layer
+		Texture2DArrayDescription desc = Texture2DArrayDescription();
 		desc.Width = 1;
 		desc.Height = 1;
+		desc.Layers = 1;
 		desc.Format = InternalFormat::RGB8;
-		Texture2D::sptr texture2 = Texture2D::Create(desc);
+		desc.GenerateMipMaps = false;
+		Texture2DArray::sptr whiteArray = Texture2DArray::Create(desc);
 		// Clear it with a white colour
-		texture2->Clear();
+		whiteArray->Clear();
 		#pragma endregion
 
 		///////////////////////////////////// Scene Generation //////////////////////////////////////////////////
 		#pragma region Scene Generation
 		// We need to tell our scene system what extra component types we want to support
 		GameScene::RegisterComponentType<RendererComponent>();
-		GameScene::RegisterComponentType<BehaviourBinding>();
+		GameScene::RegisterComponentType<BehaviourBinding>(&BehaviourBinding::Stamp);
 		GameScene::RegisterComponentType<Camera>();
+		GameScene::RegisterComponentType<MorphPose>();
+		// And which behaviours get saved with the scene
+		SceneSerializer::RegisterBehaviour<SimpleMoveBehaviour>("SimpleMoveBehaviour");
+		SceneSerializer::RegisterBehaviour<FollowPathBehaviour>("FollowPathBehaviour");
+		SceneSerializer::RegisterBehaviour<MorphAnimator>("MorphAnimator");
 
 		// Create a scene, and set it to be the active scene in the application
 		GameScene::sptr scene = GameScene::Create("test");
 		Application::Instance().ActiveScene = scene;
 
+		// Stores the per-instance transforms for instanced rendering
+		InstanceBuffer::sptr instances = InstanceBuffer::Create();
+		// Collects and sorts the draws for each frame
+		RenderQueue renderQueue;
+
+		// Used to cull objects that are outside of the camera's view before they are submitted
+		Frustum frustum;
+		BoundsBatch cullBatch;
+		struct CullObject {
+			RendererComponent* Renderer;
+			Transform*         ObjectTransform;
+			glm::vec4          InstanceParams;
+		};
+		std::vector<CullObject> cullObjects;
+		std::vector<uint8_t> cullResults;
+
 		// We can create a group ahead of time to make iterating on the group faster
 		entt::basic_group<entt::entity, entt::exclude_t<>, entt::get_t<Transform>, RendererComponent> renderGroup =
 			scene->Registry().group<RendererComponent>(entt::get_t<Transform>());
@@ -226,32 +306,76 @@ int main() {
 		// Create a material and set some properties for it
 		ShaderMaterial::sptr material0 = ShaderMaterial::Create();
 		material0->Shader = shader;
-		material0->Set("s_Diffuse", groundTex);
+		material0->Set("s_Diffuse", whiteArray);
 		material0->Set("u_Shininess", 8.0f);
 
 		ShaderMaterial::sptr material1 = ShaderMaterial::Create();
 		material1->Shader = shader;
-		material1->Set("s_Diffuse", chickenTex);
+		material1->Set("s_Diffuse", diffuseArray, whiteArray);
 		material1->Set("u_Shininess", 8.0f);
+		material1->MaterialParams.x = chickenLayer;
 
 		ShaderMaterial::sptr material2 = ShaderMaterial::Create();
 		material2->Shader = shader;
-		material2->Set("s_Diffuse", stoneTex);
+		material2->Set("s_Diffuse", diffuseArray, whiteArray);
 		material2->Set("u_Shininess", 8.0f);
+		material2->MaterialParams.x = stoneLayer;
 
 		ShaderMaterial::sptr material3 = ShaderMaterial::Create();
 		material3->Shader = shader;
-		material3->Set("s_Diffuse", buttonTex);
+		material3->Set("s_Diffuse", diffuseArray, whiteArray);
 		material3->Set("u_Shininess", 8.0f);
-
-		#pragma region Game Objects
-		GameObject ground = scene->CreateEntity("ground_object");
+		material3->MaterialParams.x = buttonLayer;
+
+		// The chicken models are all frames of the same animation, so we load them as a single morph animation that
+		// shares one mesh, rather than as separate meshes. All the animated chickens get drawn with one instanced draw
+		MorphAnimation::sptr chickenMorph = AssetCache::LoadMorphAnimation({
+			"models/Chicken1.obj", "models/Chicken2.obj", "models/Chicken3.obj", "models/Chicken4.obj",
+			"models/Chicken5.obj", "models/Chicken6.obj", "models/Chicken7.obj"
+		});
+
+		ShaderMaterial::sptr morphMaterial = ShaderMaterial::Create();
+		morphMaterial->Shader = morphShader;
+		morphMaterial->Set("s_Diffuse", diffuseArray, whiteArray);
+		morphMaterial->Set("u_Shininess", 8.0f);
+		morphMaterial->MaterialParams.x = chickenLayer;
+		chickenMorph->ApplyTo(morphMaterial);
+
+		// Starts a chicken's animation on the given frame, so that they aren't all in step
+		auto animateChicken = [&](GameObject chickenObj, int startFrame) {
+			MorphAnimator* animator = BehaviourBinding::Bind<MorphAnimator>(chickenObj);
+			animator->FrameCount = (int)chickenMorph->GetFrameCount();
+			animator->FrameRate = 8.0f;
+			animator->Time = startFrame / animator->FrameRate;
+		};
+
+		// The meshes that the scene uses, each one is only loaded once no matter how many objects use it
+		VertexArrayObject::sptr groundMesh;
 		{
 			MeshBuilder<VertexPosNormTexCol> builder = MeshBuilder<VertexPosNormTexCol>();
 			MeshFactory::AddPlane(builder, glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec2(25.0f, 25.f), glm::vec4(1.0f));
-			VertexArrayObject::sptr vao = builder.Bake();
+			groundMesh = builder.Bake();
+		}
+		AssetHandle<VertexArrayObject> chickenStillMesh = AssetStreamer::LoadObjAsync("models/ChickenStill.obj");
+		AssetHandle<VertexArrayObject> buttonMesh = AssetStreamer::LoadObjAsync("models/Button.obj");
+		AssetHandle<VertexArrayObject> coilMesh = AssetStreamer::LoadObjAsync("models/Coil.obj");
+
+		// Saved scenes refer to meshes and materials by these names
+		scene->Assets()->AddMesh("ground", groundMesh);
+		scene->Assets()->AddMesh("chicken_still", chickenStillMesh);
+		scene->Assets()->AddMesh("chicken_morph", chickenMorph->GetMesh());
+		scene->Assets()->AddMesh("button", buttonMesh);
+		scene->Assets()->AddMesh("coil", coilMesh);
+		scene->Assets()->AddMaterial("ground", material0);
+		scene->Assets()->AddMaterial("chicken", material1);
+		scene->Assets()->AddMaterial("stone", material2);
+		scene->Assets()->AddMaterial("button", material3);
+		scene->Assets()->AddMaterial("chicken_morph", morphMaterial);
 
-			ground.emplace<RendererComponent>().SetMesh(vao).SetMaterial(material0);
+		#pragma region Game Objects
+		GameObject ground = scene->CreateEntity("ground_object");
+		{
+			ground.emplace<RendererComponent>().SetMesh(groundMesh).SetMaterial(material0);
 			ground.get<Transform>().SetLocalPosition(0.0f, 0.0f, 0.0f);
 			BehaviourBinding::BindDisabled<SimpleMoveBehaviour>(ground);
 		}
@@ -259,8 +383,7 @@ int main() {
 		// Giant chicken beind button
 		GameObject chicken = scene->CreateEntity("chicken_main_object");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/ChickenStill.obj");
-			chicken.emplace<RendererComponent>().SetMesh(vao).SetMaterial(material1);
+			chicken.emplace<RendererComponent>().SetMesh(chickenStillMesh).SetMaterial(material1);
 			chicken.get<Transform>().SetLocalPosition(0.0f, -9.0f, 0.0f);
 			chicken.get<Transform>().SetLocalRotation(glm::vec3(90.f, 0.f, 180.f));
 			BehaviourBinding::BindDisabled<SimpleMoveBehaviour>(chicken);
@@ -269,13 +392,13 @@ int main() {
 		// Moving chicken left side
 		GameObject chicken1 = scene->CreateEntity("chicken_object_1");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Chicken1.obj");
-			chicken1.emplace<RendererComponent>().SetMesh(vao).SetMaterial(material1);
+			chicken1.emplace<RendererComponent>().SetMesh(chickenMorph->GetMesh()).SetMaterial(morphMaterial);
+			animateChicken(chicken1, 0);
 			chicken1.get<Transform>().SetLocalPosition(6.0f, -4.0f, 0.0f);
 			chicken1.get<Transform>().SetLocalRotation(glm::vec3(90.f, 0.f, 180.f));
 			chicken1.get<Transform>().SetLocalScale(glm::vec3(0.4f));
 
-			// Bind returns a smart pointer to the behaviour that was added
+			// Bind returns a pointer to the behaviour that was added, only valid until the next FollowPathBehaviour is bound
 			auto pathing = BehaviourBinding::Bind<FollowPathBehaviour>(chicken1);
 			// Set up a path for the object to follow
 			pathing->Points.push_back({ 6.0f, 10.0f, 0.0f });
@@ -286,8 +409,8 @@ int main() {
 		// Fallen Chicken
 		GameObject chicken2 = scene->CreateEntity("chicken_object_2");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Chicken2.obj");
-			chicken2.emplace<RendererComponent>().SetMesh(vao).SetMaterial(material1);
+			chicken2.emplace<RendererComponent>().SetMesh(chickenMorph->GetMesh()).SetMaterial(morphMaterial);
+			animateChicken(chicken2, 1);
 			chicken2.get<Transform>().SetLocalPosition(8.0f, 10.0f, 0.0f);
 			chicken2.get<Transform>().SetLocalRotation(glm::vec3(45.f, -90.f, 180.f));
 			chicken2.get<Transform>().SetLocalScale(glm::vec3(0.4f));
@@ -296,8 +419,8 @@ int main() {
 		// Fallen Chicken
 		GameObject chicken3 = scene->CreateEntity("chicken_object_3");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Chicken3.obj");
-			chicken3.emplace<RendererComponent>().SetMesh(vao).SetMaterial(material1);
+			chicken3.emplace<RendererComponent>().SetMesh(chickenMorph->GetMesh()).SetMaterial(morphMaterial);
+			animateChicken(chicken3, 2);
 			chicken3.get<Transform>().SetLocalPosition(2.0f, 4.0f, 0.0f);
 			chicken3.get<Transform>().SetLocalRotation(glm::vec3(50.f, 90.f, 180.f));
 			chicken3.get<Transform>().SetLocalScale(glm::vec3(0.4f));
@@ -307,8 +430,8 @@ int main() {
 		// Spinning chicken
 		GameObject chicken4 = scene->CreateEntity("chicken_object_4");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Chicken4.obj");
-			chicken4.emplace<RendererComponent>().SetMesh(vao).SetMaterial(material1);
+			chicken4.emplace<RendererComponent>().SetMesh(chickenMorph->GetMesh()).SetMaterial(morphMaterial);
+			animateChicken(chicken4, 3);
 			chicken4.get<Transform>().SetLocalPosition(0.0f, 0.0f, 0.0f);
 			chicken4.get<Transform>().SetLocalRotation(glm::vec3(90.f, 0.f, 180.f));
 			chicken4.get<Transform>().SetLocalScale(glm::vec3(0.4f));
@@ -317,8 +440,8 @@ int main() {
 		// Fallen spinning chicken
 		GameObject chicken5 = scene->CreateEntity("chicken_object_5");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Chicken5.obj");
-			chicken5.emplace<RendererComponent>().SetMesh(vao).SetMaterial(material1);
+			chicken5.emplace<RendererComponent>().SetMesh(chickenMorph->GetMesh()).SetMaterial(morphMaterial);
+			animateChicken(chicken5, 4);
 			chicken5.get<Transform>().SetLocalPosition(2.0f, 9.0f, 0.0f);
 			chicken5.get<Transform>().SetLocalRotation(glm::vec3(0.f, 90.f, 180.f));
 			chicken5.get<Transform>().SetLocalScale(glm::vec3(0.4f));
@@ -327,13 +450,13 @@ int main() {
 		// Moving chicken right side
 		GameObject chicken6 = scene->CreateEntity("chicken_object_6");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Chicken6.obj");
-			chicken6.emplace<RendererComponent>().SetMesh(vao).SetMaterial(material1);
+			chicken6.emplace<RendererComponent>().SetMesh(chickenMorph->GetMesh()).SetMaterial(morphMaterial);
+			animateChicken(chicken6, 5);
 			chicken6.get<Transform>().SetLocalPosition(-4.0f, 10.0f, 0.0f);
 			chicken6.get<Transform>().SetLocalRotation(glm::vec3(90.f, 0.f, 180.f));
 			chicken6.get<Transform>().SetLocalScale(glm::vec3(0.4f));
 
-			// Bind returns a smart pointer to the behaviour that was added
+			// Bind returns a pointer to the behaviour that was added, only valid until the next FollowPathBehaviour is bound
 			auto pathing = BehaviourBinding::Bind<FollowPathBehaviour>(chicken6);
 			// Set up a path for the object to follow
 			pathing->Points.push_back({ -4.0f, -4.0f, 0.0f });
@@ -344,8 +467,8 @@ int main() {
 		// Fallen Chicken
 		GameObject chicken7 = scene->CreateEntity("chicken_object_7");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Chicken7.obj");
-			chicken7.emplace<RendererComponent>().SetMesh(vao).SetMaterial(material1);
+			chicken7.emplace<RendererComponent>().SetMesh(chickenMorph->GetMesh()).SetMaterial(morphMaterial);
+			animateChicken(chicken7, 6);
 			chicken7.get<Transform>().SetLocalPosition(-7.0f, 8.0f, 0.0f);
 			chicken7.get<Transform>().SetLocalScale(glm::vec3(0.4f));
 			BehaviourBinding::BindDisabled<SimpleMoveBehaviour>(chicken7);
@@ -354,8 +477,8 @@ int main() {
 		// Spinning chicken upside down
 		GameObject chicken8 = scene->CreateEntity("chicken_object_8");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Chicken3.obj");
-			chicken8.emplace<RendererComponent>().SetMesh(vao).SetMaterial(material1);
+			chicken8.emplace<RendererComponent>().SetMesh(chickenMorph->GetMesh()).SetMaterial(morphMaterial);
+			animateChicken(chicken8, 2);
 			chicken8.get<Transform>().SetLocalPosition(-7.0f, -3.0f, 3.0f);
 			chicken8.get<Transform>().SetLocalRotation(glm::vec3(-90.f, 0.f, 180.f));
 			chicken8.get<Transform>().SetLocalScale(glm::vec3(0.4f));
@@ -364,8 +487,8 @@ int main() {
 		// Fallen Chicken
 		GameObject chicken9 = scene->CreateEntity("chicken_object_9");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Chicken7.obj");
-			chicken9.emplace<RendererComponent>().SetMesh(vao).SetMaterial(material1);
+			chicken9.emplace<RendererComponent>().SetMesh(chickenMorph->GetMesh()).SetMaterial(morphMaterial);
+			animateChicken(chicken9, 6);
 			chicken9.get<Transform>().SetLocalPosition(11.0f, -2.0f, 0.0f);
 			chicken9.get<Transform>().SetLocalRotation(glm::vec3(90.f, 90.f, 180.f));
 			chicken9.get<Transform>().SetLocalScale(glm::vec3(0.4f));
@@ -374,8 +497,7 @@ int main() {
 
 		GameObject button = scene->CreateEntity("button_object");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Button.obj");
-			button.emplace<RendererComponent>().SetMesh(vao).SetMaterial(material3);
+			button.emplace<RendererComponent>().SetMesh(buttonMesh).SetMaterial(material3);
 			button.get<Transform>().SetLocalPosition(0.0f, -6.0f, 0.0f);
 			button.get<Transform>().SetLocalRotation(glm::vec3(90.f, 0.f, 0.f));
 			BehaviourBinding::BindDisabled<SimpleMoveBehaviour>(button);
@@ -383,8 +505,7 @@ int main() {
 
 		GameObject coil = scene->CreateEntity("coil_object");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Coil.obj");
-			coil.emplace<RendererComponent>().SetMesh(vao).SetMaterial(material2);
+			coil.emplace<RendererComponent>().SetMesh(coilMesh).SetMaterial(material2);
 			coil.get<Transform>().SetLocalPosition(8.0f, -8.0f, 0.0f);
 			coil.get<Transform>().SetLocalRotation(glm::vec3(90.f, 0.f, 0.f));
 			coil.get<Transform>().SetLocalScale(glm::vec3(0.5f));
@@ -393,14 +514,13 @@ int main() {
 
 		GameObject coil2 = scene->CreateEntity("coil_object_2");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/Coil.obj");
-			coil2.emplace<RendererComponent>().SetMesh(vao).SetMaterial(material2);
+			coil2.emplace<RendererComponent>().SetMesh(coilMesh).SetMaterial(material2);
 			coil2.get<Transform>().SetLocalPosition(-8.0f, -8.0f, 0.0f);
 			coil2.get<Transform>().SetLocalRotation(glm::vec3(90.f, 0.f, 0.f));
 			coil2.get<Transform>().SetLocalScale(glm::vec3(0.5f));
 			BehaviourBinding::BindDisabled<SimpleMoveBehaviour>(coil2);
 		}
-#pragma endregion 
+		#pragma endregion
 
 		// Create an object to be our camera
 		GameObject cameraObject = scene->CreateEntity("Camera");
@@ -428,6 +548,7 @@ int main() {
 			skybox->LoadShaderPartFromFile("shaders/skybox-shader.vert.glsl", GL_VERTEX_SHADER);
 			skybox->LoadShaderPartFromFile("shaders/skybox-shader.frag.glsl", GL_FRAGMENT_SHADER);
 			skybox->Link();
+			BackendHandler::BindFrameUniforms(skybox);
 
 			ShaderMaterial::sptr skyboxMat = ShaderMaterial::Create();
 			skyboxMat->Shader = skybox;
@@ -439,6 +560,8 @@ int main() {
 			MeshFactory::AddIcoSphere(mesh, glm::vec3(0.0f), 1.0f);
 			MeshFactory::InvertFaces(mesh);
 			VertexArrayObject::sptr meshVao = mesh.Bake();
+			// The skybox is always drawn around the camera, so it's bounds don't mean anything and it should never be culled
+			meshVao->SetBounds(MeshBounds());
 
 			GameObject skyboxObj = scene->CreateEntity("skybox");
 			skyboxObj.get<Transform>().SetLocalPosition(0.0f, 0.0f, 0.0f);
@@ -457,29 +580,46 @@ int main() {
 			keyToggles.emplace_back(GLFW_KEY_T, [&]() { cameraObject.get<Camera>().ToggleOrtho(); });
 		}
 
-		// Initialize our timing instance and grab a reference for our use
-		Timing& time = Timing::Instance();
-		time.LastFrame = glfwGetTime();
-
 		int spinFactor = 0;
 		int spinFactor2 = 0;
 		int spinFactor3 = 0;
 
+		// The scene is always built in code above, saving it is only done on request. Anything that registers the same
+		// asset names can load the file (see SceneSerializer)
+		BackendHandler::imGuiCallbacks.push_back([&]() {
+			if (ImGui::Button("Save Scene")) {
+				const std::string scenePath = "scenes/assignment1.scene";
+				try {
+					std::filesystem::create_directories(std::filesystem::path(scenePath).parent_path());
+					scene->Save(scenePath);
+					LOG_INFO("Saved the scene to \"{}\"", scenePath);
+				}
+				catch (const std::exception& e) {
+					LOG_WARN("Failed to save the scene: {}", e.what());
+				}
+			}
+		});
+
+		// Behaviours draw their own UI in the ImGui pass, after everything else has updated
+		BackendHandler::imGuiCallbacks.push_back([&]() {
+			BehaviourBinding::RunPhase(scene->Registry(), BehaviourPhase::RenderGUI);
+		});
+
+		Profiler::SetThreadName("Main");
+
 		///// Game loop /////
 		while (!glfwWindowShouldClose(BackendHandler::window)) {
+			Profiler::BeginFrame();
 			glfwPollEvents();
+			RenderState::ResetStats();
 
-			// Update the timing
-			time.CurrentFrame = glfwGetTime();
-			time.DeltaTime = static_cast<float>(time.CurrentFrame - time.LastFrame);
+			// Update the timing, and work out how many fixed steps we need to catch up with real time
+			scheduler->BeginFrame(scene->Registry(), glfwGetTime());
 
-			time.DeltaTime = time.DeltaTime > 1.0f ? 1.0f : time.DeltaTime;
-
-			// Update our FPS tracker data
-			fpsBuffer[frameIx] = 1.0f / time.DeltaTime;
-			frameIx++;
-			if (frameIx >= 128)
-				frameIx = 0;
+			// Upload any assets that finished loading in the background, without spending too much of the frame on it
+			AssetStreamer::ProcessUploads(2.0);
+			// Run any jobs that need to be on the main thread (ex: anything that touches the GL context)
+			JobSystem::RunMainThreadJobs();
 
 			// We'll make sure our UI isn't focused before we start handling input for our game
 			if (!ImGui::IsAnyWindowFocused()) {
@@ -491,15 +631,54 @@ int main() {
 				}
 			}
 
-			// Iterate over all the behaviour binding components
-			scene->Registry().view<BehaviourBinding>().each([&](entt::entity entity, BehaviourBinding& binding) {
-				// Iterate over all the behaviour scripts attached to the entity, and update them in sequence (if enabled)
-				for (const auto& behaviour : binding.Behaviours) {
-					if (behaviour->Enabled) {
-						behaviour->Update(entt::handle(scene->Registry(), entity));
+			// The simulation runs first, in as many fixed steps as it takes to catch up, then the per-frame updates
+			{
+				PROFILE_SCOPE("FixedUpdate");
+				while (scheduler->StepFixed()) {
+					BehaviourBinding::RunPhase(scene->Registry(), BehaviourPhase::FixedUpdate);
+
+					#pragma region Chicken Updates
+					// Rotate chicken when they reach certain y-location
+					if (chicken1.get<Transform>().GetLocalPosition().y >= 9.9f)
+					{
+						chicken1.get<Transform>().SetLocalRotation(glm::vec3(90.f, 0.f, 0.f));
 					}
+					if (chicken1.get<Transform>().GetLocalPosition().y <= -3.9f)
+					{
+						chicken1.get<Transform>().SetLocalRotation(glm::vec3(90.f, 0.f, 180.f));
+					}
+
+					if (chicken6.get<Transform>().GetLocalPosition().y >= 9.9f)
+					{
+						chicken6.get<Transform>().SetLocalRotation(glm::vec3(90.f, 0.f, 0.f));
+					}
+					if (chicken6.get<Transform>().GetLocalPosition().y <= -3.9f)
+					{
+						chicken6.get<Transform>().SetLocalRotation(glm::vec3(90.f, 0.f, 180.f));
+					}
+
+					// Spin chicken4
+					chicken4.get<Transform>().SetLocalRotation(glm::vec3(90.0f, 0.0f, spinFactor % 360));
+					spinFactor++;
+
+					// Spin chicken5
+					chicken5.get<Transform>().SetLocalRotation(glm::vec3(0.0f, 0.0f, spinFactor2 % 360));
+					spinFactor2++;
+
+					// Spin chicken 8
+					chicken8.get<Transform>().SetLocalRotation(glm::vec3(-90.0f, 0.0f, spinFactor3 % 360));
+					spinFactor3++;
+#pragma endregion
 				}
-			});
+			}
+			{
+				PROFILE_SCOPE("Update");
+				BehaviourBinding::RunPhase(scene->Registry(), BehaviourPhase::Update);
+			}
+			{
+				PROFILE_SCOPE("LateUpdate");
+				BehaviourBinding::RunPhase(scene->Registry(), BehaviourPhase::LateUpdate);
+			}
 
 			// Clear the screen
 			glClearColor(0.08f, 0.17f, 0.31f, 1.0f);
@@ -508,99 +687,149 @@ int main() {
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 			// Update all world matrices for this frame
-			scene->Registry().view<Transform>().each([](entt::entity entity, Transform& t) {
-				t.UpdateWorldMatrix();
-			});
+			TransformSystem::Get(scene->Registry())->Update();
 
 			// Grab out camera info from the camera object
 			Transform& camTransform = cameraObject.get<Transform>();
 			glm::mat4 view = glm::inverse(camTransform.LocalTransform());
-			glm::mat4 projection = cameraObject.get<Camera>().GetProjection();
-			glm::mat4 viewProjection = projection * view;
-
-			#pragma region Chicken Updates
-			// Rotate chicken when they reach certain y-location
-			if (chicken1.get<Transform>().GetLocalPosition().y >= 9.9f)
-			{
-				chicken1.get<Transform>().SetLocalRotation(glm::vec3(90.f, 0.f, 0.f));
-			}
-			if (chicken1.get<Transform>().GetLocalPosition().y <= -3.9f)
+			Camera& camera = cameraObject.get<Camera>();
+			camera.SetView(view);
+			glm::mat4 projection = camera.GetProjection();
+			glm::mat4 viewProjection = camera.GetViewProjection();
+
+			// Upload the camera data once, it's shared by all of our shaders
+			BackendHandler::UpdateFrameUniforms(view, projection);
+
+			// Build the render queue for this frame. Each draw gets a sort key made from it's layer, shader, material,
+			// mesh and depth, so that sorting the keys groups draws to minimize context switches, and draws sharing a
+			// mesh and material end up next to each other where they can be instanced
+			// Objects are first gathered into a batch and culled against the view frustum, only the visible ones are
+			// submitted to the queue
 			{
-				chicken1.get<Transform>().SetLocalRotation(glm::vec3(90.f, 0.f, 180.f));
+				PROFILE_SCOPE("Culling");
+				cullBatch.Clear();
+				cullObjects.clear();
+				renderGroup.each([&](entt::entity e, RendererComponent& renderer, Transform& transform) {
+					// Skip objects whose mesh is still streaming in
+					if (!renderer.UpdatePending()) {
+						return;
+					}
+					cullBatch.Push(renderer.Mesh->GetBounds(), transform.WorldTransform());
+					// Animated objects pass their current pose along to the shader
+					const MorphPose* pose = scene->Registry().try_get<MorphPose>(e);
+					cullObjects.push_back({ &renderer, &transform, pose != nullptr ? pose->ToInstanceParams() : glm::vec4(0.0f) });
+				});
+				frustum.Update(viewProjection);
+				objectsDrawn = (int)frustum.Cull(cullBatch, cullResults);
+				objectsCulled = (int)cullObjects.size() - objectsDrawn;
 			}
 
-			if (chicken6.get<Transform>().GetLocalPosition().y >= 9.9f)
-			{
-				chicken6.get<Transform>().SetLocalRotation(glm::vec3(90.f, 0.f, 0.f));
-			}
-			if (chicken6.get<Transform>().GetLocalPosition().y <= -3.9f)
+			// Visible meshes pick their level of detail from how big their bounding sphere is on screen
+			int viewportWidth = 0, viewportHeight = 0;
+			glfwGetWindowSize(BackendHandler::window, &viewportWidth, &viewportHeight);
+			trianglesFullDetail = 0;
+
 			{
-				chicken6.get<Transform>().SetLocalRotation(glm::vec3(90.f, 0.f, 180.f));
+				PROFILE_SCOPE("Submit");
+				renderQueue.Clear();
+				for (size_t ix = 0; ix < cullObjects.size(); ix++) {
+					if (!cullResults[ix]) {
+						continue;
+					}
+					RendererComponent& renderer = *cullObjects[ix].Renderer;
+					const Transform& transform = *cullObjects[ix].ObjectTransform;
+					const glm::mat4& world = transform.WorldTransform();
+					// Use the clip space depth of the object's origin, mapped from [-1, 1] to [0, 1]
+					glm::vec4 clipPos = viewProjection * world[3];
+					float depth = clipPos.w > 0.0f ? (clipPos.z / clipPos.w) * 0.5f + 0.5f : 0.0f;
+
+					const MeshBounds& bounds = renderer.Mesh->GetBounds();
+					// SelectLod starts from last frame's level, so the hysteresis band keeps meshes from flipping at a threshold
+					if (useLods && bounds.IsValid()) {
+						const float scale = glm::max(glm::length(world[0]), glm::max(glm::length(world[1]), glm::length(world[2])));
+						const glm::vec3 center = glm::vec3(world * glm::vec4(bounds.GetCenter(), 1.0f));
+						renderer.SelectLod(RendererComponent::ProjectSphere(center, bounds.Radius * scale, camera, (float)viewportHeight), lodPixelError);
+					} else {
+						renderer.Lod = 0;
+					}
+					trianglesFullDetail += renderer.Mesh->GetTriangleCount(0);
+					renderQueue.Submit(renderer.Material.get(), renderer.Mesh.get(), &transform, depth, cullObjects[ix].InstanceParams, renderer.Lod);
+				}
 			}
+			renderQueue.Sort();
 
-			// Spin chicken4
-			chicken4.get<Transform>().SetLocalRotation(glm::vec3(90.0f, 0.0f, spinFactor % 360));
-			spinFactor++;
-
-			// Spin chicken5
-			chicken5.get<Transform>().SetLocalRotation(glm::vec3(0.0f, 0.0f, spinFactor2 % 360));
-			spinFactor2++;
-
-			// Spin chicken 8
-			chicken8.get<Transform>().SetLocalRotation(glm::vec3(-90.0f, 0.0f, spinFactor3 % 360));
-			spinFactor3++;
-#pragma endregion
-
-			// Sort the renderers by shader and material, we will go for a minimizing context switches approach here,
-			// but you could for instance sort front to back to optimize for fill rate if you have intensive fragment shaders
-			renderGroup.sort<RendererComponent>([](const RendererComponent& l, const RendererComponent& r) {
-				// Sort by render layer first, higher numbers get drawn last
-				if (l.Material->RenderLayer < r.Material->RenderLayer) return true;
-				if (l.Material->RenderLayer > r.Material->RenderLayer) return false;
-
-				// Sort by shader pointer next (so materials using the same shader run sequentially where possible)
-				if (l.Material->Shader < r.Material->Shader) return true;
-				if (l.Material->Shader > r.Material->Shader) return false;
-
-				// Sort by material pointer last (so we can minimize switching between materials)
-				if (l.Material < r.Material) return true;
-				if (l.Material > r.Material) return false;
-
-				return false;
-			});
-
-			// Start by assuming no shader or material is applied
-			Shader::sptr current = nullptr;
-			ShaderMaterial::sptr currentMat = nullptr;
-
-			// Iterate over the render group components and draw them
-			renderGroup.each([&](entt::entity e, RendererComponent& renderer, Transform& transform) {
-				// If the shader has changed, set up it's uniforms
-				if (current != renderer.Material->Shader) {
-					current = renderer.Material->Shader;
-					current->Bind();
-					BackendHandler::SetupShaderForFrame(current, view, projection);
-				}
-				// If the material has changed, apply it
-				if (currentMat != renderer.Material) {
-					currentMat = renderer.Material;
-					currentMat->Apply();
+			{
+				PROFILE_GPU_SCOPE("Draw");
+				// Start by assuming no shader or material is applied
+				Shader* current = nullptr;
+				ShaderMaterial* currentMat = nullptr;
+
+				// Consecutive renderers that share a mesh, level of detail and material batch are collected into a batch, and
+				// drawn with a single instanced draw call once any of them or the shader changes. Materials that only differ by
+				// their MaterialParams share a batch ID, so they are drawn together with the params passed per instance
+				instances->BeginFrame();
+				VertexArrayObject* batchMesh = nullptr;
+				uint32_t batchLod = 0;
+				uint32_t batchEnd = 0;
+				uint32_t batchCount = 0;
+				auto flushBatch = [&]() {
+					if (batchCount > 0) {
+						batchMesh->RenderInstanced(*instances, batchEnd - batchCount, batchCount, batchLod);
+						batchCount = 0;
+					}
+				};
+
+				// Draw everything in the queue, the render state cache takes care of skipping any redundant binds
+				for (const RenderCommand& command : renderQueue.GetCommands()) {
+					// If the shader has changed, set up it's uniforms
+					if (current != command.Material->Shader.get()) {
+						flushBatch();
+						current = command.Material->Shader.get();
+						command.Material->Shader->Bind();
+					}
+					// If the material has changed, apply it
+					if (currentMat == nullptr || currentMat->GetBatchId() != command.Material->GetBatchId()) {
+						flushBatch();
+						currentMat = command.Material;
+						currentMat->Apply();
+					}
+					// Render the mesh
+					if (current->IsInstanced()) {
+						if (batchMesh != command.Mesh || batchLod != command.Lod) {
+							flushBatch();
+							batchMesh = command.Mesh;
+							batchLod = command.Lod;
+						}
+						// Quantized meshes fold their position decode into the model matrix, see VertexArrayObject::ApplyVertexDecode
+						batchEnd = instances->Push(command.Mesh->ApplyVertexDecode(command.ObjectTransform->WorldTransform()),
+							command.ObjectTransform->WorldNormalMatrix(), command.InstanceParams, command.Material->MaterialParams) + 1;
+						batchCount++;
+					} else {
+						BackendHandler::RenderVAO(command.Material->Shader, *command.Mesh, viewProjection, *command.ObjectTransform, command.Lod);
+					}
 				}
-				// Render the mesh
-				BackendHandler::RenderVAO(renderer.Material->Shader, renderer.Mesh, viewProjection, transform);
-			});
+				flushBatch();
+				instances->EndFrame();
+			}
 
 			// Draw our ImGui content
-			BackendHandler::RenderImGui();
+			{
+				PROFILE_GPU_SCOPE("ImGui");
+				BackendHandler::RenderImGui();
+			}
+			// ImGui binds it's own program, vertex array and textures, so our cached state is no longer valid
+			RenderState::Invalidate();
 
 			scene->Poll();
+			// The frame ends before the swap, so the profiled frame doesn't include waiting on vsync
+			Profiler::EndFrame();
 			glfwSwapBuffers(BackendHandler::window);
-			time.LastFrame = time.CurrentFrame;
 		}
 
 		// Nullify scene so that we can release references
 		Application::Instance().ActiveScene = nullptr;
-		BackendHandler::ShutdownImGui();
+		BackendHandler::frameUniforms = nullptr;
+		BackendHandler::ShutdownAll();
 	}
 
 	// Clean up the toolkit logger so we don't leak memory
@@ -0,0 +1,144 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <typeindex>
+#include <stdexcept>
+
+#include <entt.hpp>
+#include <GLM/glm.hpp>
+
+#include <IBehaviour.h>
+#include <FollowPathBehaviour.h>
+#include <SimpleMoveBehaviour.h>
+#include <Transform.h>
+#include <TransformSystem.h>
+#include <JobSystem.h>
+#include <Timing.h>
+
+/// <summary>
+/// How behaviours used to be stored, a list of shared pointers per entity that we walk and call virtually
+/// </summary>
+struct LegacyBinding
+{
+	std::vector<std::shared_ptr<IBehaviour>> Behaviours;
+
+	template <typename T>
+	static std::shared_ptr<T> Get(entt::handle entity) {
+		for (const auto& ptr : entity.get<LegacyBinding>().Behaviours) {
+			if (std::type_index(typeid(*ptr.get())) == std::type_index(typeid(T))) {
+				return std::dynamic_pointer_cast<T>(ptr);
+			}
+		}
+		return nullptr;
+	}
+};
+
+static void RunLegacyFrame(entt::registry& registry) {
+	registry.view<LegacyBinding>().each([&](entt::entity entity, LegacyBinding& binding) {
+		for (const auto& behaviour : binding.Behaviours) {
+			if (behaviour->Enabled) {
+				behaviour->FixedUpdate(entt::handle(registry, entity));
+			}
+		}
+	});
+	SimpleMoveBehaviour::BeginPhase(BehaviourPhase::Update);
+	registry.view<LegacyBinding>().each([&](entt::entity entity, LegacyBinding& binding) {
+		for (const auto& behaviour : binding.Behaviours) {
+			if (behaviour->Enabled) {
+				behaviour->Update(entt::handle(registry, entity));
+			}
+		}
+	});
+}
+
+static void RunBatchedFrame(entt::registry& registry) {
+	BehaviourBinding::RunPhase(registry, BehaviourPhase::FixedUpdate);
+	BehaviourBinding::RunPhase(registry, BehaviourPhase::Update);
+}
+
+/// <summary>
+/// Sets up the path for an entity, with each entity going around a slightly different square
+/// </summary>
+static void SetupPath(FollowPathBehaviour& path, int index) {
+	const glm::vec3 offset = glm::vec3((float)(index % 100), (float)(index / 100), 0.0f) * 3.0f;
+	path.Points = { offset, offset + glm::vec3(2.0f, 0.0f, 0.0f), offset + glm::vec3(2.0f, 2.0f, 0.0f), offset + glm::vec3(0.0f, 2.0f, 0.0f) };
+	path.Speed = 1.0f + (index % 7) * 0.25f;
+}
+
+void RunBehaviourBenchmark(const std::vector<std::string>& args)
+{
+	const int count = args.size() > 0 ? std::stoi(args[0]) : 50000;
+	const int frames = args.size() > 1 ? std::stoi(args[1]) : 200;
+
+	Timing::Instance().FixedTimeStep = 1.0f / 60.0f;
+	Timing::Instance().DeltaTime = 1.0f / 60.0f;
+
+	// Two registries with the same entities, one with each kind of binding
+	entt::registry legacy;
+	entt::registry batched;
+	std::vector<entt::handle> legacyEntities;
+	std::vector<entt::handle> batchedEntities;
+	for (int ix = 0; ix < count; ix++) {
+		entt::handle a(legacy, legacy.create());
+		a.emplace<Transform>(a);
+		std::shared_ptr<FollowPathBehaviour> legacyPath = std::make_shared<FollowPathBehaviour>();
+		SetupPath(*legacyPath, ix);
+		a.emplace<LegacyBinding>().Behaviours = { legacyPath, std::make_shared<SimpleMoveBehaviour>() };
+		legacyEntities.push_back(a);
+
+		entt::handle b(batched, batched.create());
+		b.emplace<Transform>(b);
+		SetupPath(*BehaviourBinding::Bind<FollowPathBehaviour>(b), ix);
+		BehaviourBinding::Bind<SimpleMoveBehaviour>(b);
+		batchedEntities.push_back(b);
+	}
+
+	// Warm up, then time each approach for the same number of frames
+	RunLegacyFrame(legacy);
+	RunBatchedFrame(batched);
+
+	BenchmarkTimer timer;
+	for (int frame = 1; frame < frames; frame++) {
+		RunLegacyFrame(legacy);
+	}
+	const double legacyMs = timer.ElapsedMs() / (frames - 1);
+
+	timer.Reset();
+	for (int frame = 1; frame < frames; frame++) {
+		RunBatchedFrame(batched);
+	}
+	const double batchedMs = timer.ElapsedMs() / (frames - 1);
+
+	// Both should have moved every entity to exactly the same place
+	for (int ix = 0; ix < count; ix++) {
+		const glm::vec3 a = legacyEntities[ix].get<Transform>().GetLocalPosition();
+		const glm::vec3 b = batchedEntities[ix].get<Transform>().GetLocalPosition();
+		if (glm::length(a - b) > 1.0e-4f) {
+			throw std::runtime_error("Batched behaviours moved entity " + std::to_string(ix) + " differently");
+		}
+	}
+
+	// Typed lookups, which used to compare typeids for every behaviour on the entity
+	size_t found = 0;
+	timer.Reset();
+	for (const entt::handle& entity : legacyEntities) {
+		found += LegacyBinding::Get<SimpleMoveBehaviour>(entity) != nullptr ? 1 : 0;
+	}
+	const double legacyLookupMs = timer.ElapsedMs();
+	timer.Reset();
+	for (const entt::handle& entity : batchedEntities) {
+		found += BehaviourBinding::Get<SimpleMoveBehaviour>(entity) != nullptr ? 1 : 0;
+	}
+	const double batchedLookupMs = timer.ElapsedMs();
+	if (found != (size_t)count * 2) {
+		throw std::runtime_error("Lookups did not find every behaviour");
+	}
+
+	std::cout << count << " entities with FollowPathBehaviour and SimpleMoveBehaviour, " << frames << " frames, "
+		<< JobSystem::GetWorkerCount() << " workers" << std::endl;
+	std::cout << std::fixed << std::setprecision(3)
+		<< "Per entity (shared_ptr, virtual): " << std::setw(9) << legacyMs << " ms/frame, " << std::setw(8) << legacyLookupMs * 1000000.0 / count << " ns/Get" << std::endl
+		<< "Type batched:                     " << std::setw(9) << batchedMs << " ms/frame, " << std::setw(8) << batchedLookupMs * 1000000.0 / count << " ns/Get"
+		<< " (" << std::setprecision(2) << legacyMs / batchedMs << "x)" << std::endl;
+}
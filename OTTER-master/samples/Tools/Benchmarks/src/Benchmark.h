@@ -0,0 +1,154 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// A simple stopwatch for timing sections of code in our benchmarks
+/// </summary>
+class BenchmarkTimer
+{
+public:
+	BenchmarkTimer() : _start(std::chrono::high_resolution_clock::now()) {}
+
+	/// <summary>
+	/// Restarts the timer from the current time
+	/// </summary>
+	void Reset() { _start = std::chrono::high_resolution_clock::now(); }
+
+	/// <summary>
+	/// Gets the time since the timer was started or reset, in milliseconds
+	/// </summary>
+	double ElapsedMs() const {
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - _start).count();
+	}
+
+private:
+	std::chrono::high_resolution_clock::time_point _start;
+};
+
+// Each benchmark takes the command line arguments that follow it's name
+
+/// <summary>
+/// Compares the throughput of the memory mapped OBJ parser against the old iostream based loader
+/// Arguments: [models directory] [iterations]
+/// </summary>
+void RunObjLoaderBenchmark(const std::vector<std::string>& args);
+
+/// <summary>
+/// Compares parsing OBJ files against loading them from baked meshes (CPU side only)
+/// Arguments: [models directory] [iterations]
+/// </summary>
+void RunBakedMeshBenchmark(const std::vector<std::string>& args);
+
+/// <summary>
+/// Compares looking up uniform locations by name against looking them up by precomputed UniformId
+/// Arguments: [iterations]
+/// </summary>
+void RunUniformLookupBenchmark(const std::vector<std::string>& args);
+
+/// <summary>
+/// Compares the TransformSystem's world matrix update against the old per-entity Transform update, using a
+/// random hierarchy of transforms at mixed depths
+/// Arguments: [transform count] [frames]
+/// </summary>
+void RunTransformBenchmark(const std::vector<std::string>& args);
+
+/// <summary>
+/// Measures building a transform hierarchy and reparenting transforms at runtime, compared against the old
+/// approach of scanning and re-sorting every transform on each reparent
+/// Arguments: [transform count] [reparent count]
+/// </summary>
+void RunHierarchyBenchmark(const std::vector<std::string>& args);
+
+/// <summary>
+/// Measures evaluating skinning palettes for many characters sharing a skeleton, on one thread and across the
+/// job system, and checks the SIMD sampling against a reference slerp. Also times the CPU skinning fallback
+/// Arguments: [character count] [joint count] [frames]
+/// </summary>
+void RunSkinningBenchmark(const std::vector<std::string>& args);
+
+/// <summary>
+/// Compares extracting an indexed glTF mesh against the old loader's approach of expanding every index into it's
+/// own vertex, and reports the GPU memory each would use. Uses a generated grid, written to the given path
+/// Arguments: [grid size] [iterations] [path]
+/// </summary>
+void RunGltfBenchmark(const std::vector<std::string>& args);
+
+/// <summary>
+/// Reports the vertex cache efficiency (ACMR/ATVR) of generated meshes and any OBJ files in a directory, before and
+/// after MeshBuilder::Optimize, along with how long optimizing takes. Also checks that optimizing is deterministic
+/// Arguments: [models directory] [grid size]
+/// </summary>
+void RunMeshOptimizerBenchmark(const std::vector<std::string>& args);
+
+/// <summary>
+/// Converts generated meshes and any OBJ files in a directory to the compact and quantized vertex formats, reporting
+/// the format MeshBuilder::ChooseVertexFormat picks, the memory saved and the largest error in each attribute
+/// Arguments: [models directory]
+/// </summary>
+void RunVertexFormatBenchmark(const std::vector<std::string>& args);
+
+/// <summary>
+/// Generates the levels of detail for generated meshes and any OBJ files in a directory, reporting the triangles and
+/// error of each level and how long simplifying takes. Also checks that simplifying is deterministic, and simulates
+/// LOD selection over a row of meshes to compare the triangles submitted with LODs on and off
+/// Arguments: [models directory]
+/// </summary>
+void RunLodBenchmark(const std::vector<std::string>& args);
+
+/// <summary>
+/// Times mip generation (box and Kaiser filters) and block compression on one thread and across the job system,
+/// reporting the quality of each compressed format as PSNR. Checks that sRGB mips are filtered in linear space, and
+/// compares decoding the images in a directory against loading them from baked textures (CPU side only)
+/// Arguments: [images directory] [image size] [iterations]
+/// </summary>
+void RunTextureBenchmark(const std::vector<std::string>& args);
+
+/// <summary>
+/// Renders a grid of instanced spheres into a headless context, comparing frame times with no readback, with
+/// asynchronous readback through FrameCapture and with a synchronous glReadPixels every frame. Checks that both
+/// readbacks agree, and compares the first frame against a reference image (writing it if it doesn't exist yet)
+/// Arguments: [width] [height] [frames] [reference image]
+/// </summary>
+void RunRenderBenchmark(const std::vector<std::string>& args);
+
+/// <summary>
+/// Measures the cost of recording profiler zones on the main thread and from every job system thread at once,
+/// checks that nested GPU zones are read back in a headless context, and that an exported Chrome trace holds every
+/// zone in the history
+/// Arguments: [zones per frame] [frames] [trace path]
+/// </summary>
+void RunProfilerBenchmark(const std::vector<std::string>& args);
+
+/// <summary>
+/// Simulates moving transforms at 60 Hz while rendering at several rates (including uneven and overloaded frames),
+/// checking that the number of fixed steps doesn't depend on the render rate, that interpolated positions land where
+/// they should, and that an overloaded frame never takes more than the max number of steps
+/// Arguments: [transform count] [seconds]
+/// </summary>
+void RunFixedStepBenchmark(const std::vector<std::string>& args);
+
+/// <summary>
+/// Runs FollowPathBehaviour and SimpleMoveBehaviour on many entities, comparing per entity shared_ptr bindings with
+/// virtual calls against type batched behaviours, checks that both move every entity to the same place, and
+/// compares the cost of looking up a behaviour by type
+/// Arguments: [entity count] [frames]
+/// </summary>
+void RunBehaviourBenchmark(const std::vector<std::string>& args);
+
+/// <summary>
+/// Stress tests the job system: empty job throughput from the main thread and from inside of a job, recursive
+/// fork-join against std::async, a long dependency chain, main thread jobs, ParallelFor (including exceptions),
+/// ParallelForEach over entt views and nested ParallelFor calls, then prints how busy each thread was
+/// Arguments: [empty job count] [fib n]
+/// </summary>
+void RunJobBenchmark(const std::vector<std::string>& args);
+
+/// <summary>
+/// Builds a scene with transforms, hierarchies, renderers and behaviours, then saves and loads it in each scene
+/// format, comparing save and load times against building it procedurally and checking that every loaded entity
+/// matches the original. Also checks that a truncated file is rejected without changing the scene
+/// Arguments: [entity count] [scene path]
+/// </summary>
+void RunSceneBenchmark(const std::vector<std::string>& args);
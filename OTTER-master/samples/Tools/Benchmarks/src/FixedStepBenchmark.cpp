@@ -0,0 +1,141 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <stdexcept>
+#include <algorithm>
+
+#include <entt.hpp>
+#include <GLM/glm.hpp>
+
+#include <FrameScheduler.h>
+#include <TransformSystem.h>
+
+// Everything moves at a constant speed, so we know exactly where it should be at any time
+static const glm::vec3 VELOCITY = glm::vec3(3.0f, 0.0f, -1.5f);
+
+// Transforms are spread out along Y, so that adding up the steps doesn't lose precision on large positions
+static glm::vec3 Origin(int index) { return glm::vec3(0.0f, (float)index, 0.0f); }
+
+/// <summary>
+/// The results of simulating one render rate
+/// </summary>
+struct FixedStepRun
+{
+	uint64_t Steps = 0;
+	uint32_t MostStepsInFrame = 0;
+	double   DroppedTime = 0.0;
+	// The furthest a rendered position was from where it should have been, in world units
+	float    MaxError = 0.0f;
+	double   FrameMs = 0.0;
+	int      Frames = 0;
+};
+
+/// <summary>
+/// Simulates a number of moving transforms for the given frame times, checking where they are drawn each frame
+/// </summary>
+static FixedStepRun Simulate(int count, const std::vector<double>& frameTimes, bool interpolate) {
+	entt::registry registry;
+	TransformSystem& system = *TransformSystem::Get(registry);
+	std::vector<uint32_t> slots(count);
+	for (int ix = 0; ix < count; ix++) {
+		slots[ix] = system.Allocate();
+		system.SetPosition(slots[ix], Origin(ix));
+	}
+	system.Update(false);
+
+	FrameScheduler::sptr scheduler = FrameScheduler::Create(1.0f / 60.0f, 5);
+	scheduler->Interpolate = interpolate;
+	const float step = scheduler->FixedTimeStep;
+
+	FixedStepRun result;
+	double now = 0.0;
+	BenchmarkTimer timer;
+	scheduler->BeginFrame(registry, now);
+	for (double frameTime : frameTimes) {
+		now += frameTime;
+		scheduler->BeginFrame(registry, now);
+		while (scheduler->StepFixed()) {
+			for (uint32_t slot : slots) {
+				system.SetPosition(slot, system.GetPosition(slot) + VELOCITY * step);
+			}
+		}
+		system.Update(false);
+		result.MostStepsInFrame = std::max(result.MostStepsInFrame, scheduler->GetStepsThisFrame());
+
+		// Ideally we draw exactly one step behind real time (less any time that was dropped). Interpolation gets us
+		// there, without it we draw wherever the last step left things, which jumps back and forth around that.
+		// Nothing moves until the first step
+		if (scheduler->GetTotalSteps() == 0) {
+			continue;
+		}
+		const double drawnTime = now - scheduler->GetDroppedTime() - step;
+		const glm::vec3 offset = VELOCITY * (float)drawnTime;
+		for (int ix = 0; ix < count; ix += std::max(count / 64, 1)) {
+			const glm::vec3 expected = Origin(ix) + offset;
+			const glm::vec3 actual = glm::vec3(system.GetWorldMatrix(slots[ix])[3]);
+			result.MaxError = std::max(result.MaxError, glm::length(actual - expected));
+		}
+	}
+	result.FrameMs = timer.ElapsedMs() / frameTimes.size();
+	result.Frames = (int)frameTimes.size();
+	result.Steps = scheduler->GetTotalSteps();
+	result.DroppedTime = scheduler->GetDroppedTime();
+
+	// The simulation itself never depends on the render rate, only on how many steps have been taken
+	for (int ix = 0; ix < count; ix += std::max(count / 64, 1)) {
+		const glm::vec3 expected = Origin(ix) + VELOCITY * (float)(result.Steps * (double)step);
+		if (glm::length(system.GetPosition(slots[ix]) - expected) > 1.0e-2f) {
+			throw std::runtime_error("Simulated position drifted from the expected position");
+		}
+	}
+	return result;
+}
+
+void RunFixedStepBenchmark(const std::vector<std::string>& args)
+{
+	const int count = args.size() > 0 ? std::stoi(args[0]) : 10000;
+	const double seconds = args.size() > 1 ? std::stod(args[1]) : 10.0;
+
+	struct Scenario
+	{
+		std::string         Name;
+		std::vector<double> FrameTimes;
+	};
+	std::vector<Scenario> scenarios;
+	for (double hz : { 30.0, 60.0, 144.0, 240.0 }) {
+		scenarios.push_back({ std::to_string((int)hz) + " Hz", std::vector<double>((size_t)(seconds * hz), 1.0 / hz) });
+	}
+	// Frame times that wander between 4 and 40 ms, like a game under uneven load
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<double> jitter(0.004, 0.040);
+	Scenario uneven = { "Uneven", {} };
+	for (double total = 0.0; total < seconds; total += uneven.FrameTimes.back()) {
+		uneven.FrameTimes.push_back(jitter(random));
+	}
+	scenarios.push_back(uneven);
+	// Every frame takes 250 ms, which would need 15 steps each to keep up
+	scenarios.push_back({ "Overloaded", std::vector<double>((size_t)(seconds * 4.0), 0.25) });
+
+	std::cout << count << " transforms, 60 Hz simulation, " << seconds << " s per run" << std::endl;
+	std::cout << std::left << std::setw(12) << "Render" << std::right << std::setw(8) << "Frames" << std::setw(8) << "Steps"
+		<< std::setw(10) << "Max/frame" << std::setw(12) << "Dropped s" << std::setw(14) << "Error (lerp)"
+		<< std::setw(14) << "Error (snap)" << std::setw(12) << "ms/frame" << std::endl;
+	for (const Scenario& scenario : scenarios) {
+		const FixedStepRun smooth = Simulate(count, scenario.FrameTimes, true);
+		const FixedStepRun snapped = Simulate(count, scenario.FrameTimes, false);
+		if (smooth.Steps != snapped.Steps || smooth.MostStepsInFrame > 5) {
+			throw std::runtime_error("Interpolation changed the simulation, or took too many steps in a frame");
+		}
+		// Interpolated positions should be exact, short of float error in the positions themselves
+		if (smooth.MaxError > 1.0e-2f) {
+			throw std::runtime_error("Interpolated positions are off by " + std::to_string(smooth.MaxError) + " in " + scenario.Name);
+		}
+		std::cout << std::left << std::setw(12) << scenario.Name << std::right << std::setw(8) << smooth.Frames
+			<< std::setw(8) << smooth.Steps << std::setw(10) << smooth.MostStepsInFrame
+			<< std::fixed << std::setprecision(2) << std::setw(12) << smooth.DroppedTime
+			<< std::setprecision(4) << std::setw(14) << smooth.MaxError << std::setw(14) << snapped.MaxError
+			<< std::setprecision(3) << std::setw(12) << smooth.FrameMs << std::endl;
+	}
+}
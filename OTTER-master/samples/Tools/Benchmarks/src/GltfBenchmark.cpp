@@ -0,0 +1,148 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+
+#include <GLM/glm.hpp>
+
+#include <NOU/GLTFLoader.h>
+#include <tiny_gltf.h>
+
+/// <summary>
+/// Writes a flat grid of (size x size) vertices as a glTF file with an external buffer, the way most exporters lay
+/// out their data (each attribute tightly packed in it's own buffer view)
+/// </summary>
+static void WriteGrid(const std::string& path, const std::string& binName, int size) {
+	const int vertCount = size * size;
+	const int indexCount = (size - 1) * (size - 1) * 6;
+	std::vector<glm::vec3> positions(vertCount), normals(vertCount, glm::vec3(0.0f, 1.0f, 0.0f));
+	std::vector<glm::vec2> uvs(vertCount);
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			positions[y * size + x] = glm::vec3(x, 0.0f, y);
+			uvs[y * size + x] = glm::vec2(x, y) / static_cast<float>(size - 1);
+		}
+	}
+	std::vector<uint32_t> indices;
+	indices.reserve(indexCount);
+	for (int y = 0; y < size - 1; y++) {
+		for (int x = 0; x < size - 1; x++) {
+			const uint32_t i = y * size + x;
+			indices.insert(indices.end(), { i, i + size, i + 1, i + 1, i + size, i + size + 1 });
+		}
+	}
+
+	const size_t posBytes = positions.size() * sizeof(glm::vec3);
+	const size_t normBytes = normals.size() * sizeof(glm::vec3);
+	const size_t uvBytes = uvs.size() * sizeof(glm::vec2);
+	const size_t indexBytes = indices.size() * sizeof(uint32_t);
+
+	std::ofstream bin(path.substr(0, path.find_last_of("/\\") + 1) + binName, std::ios::binary);
+	bin.write(reinterpret_cast<const char*>(positions.data()), posBytes);
+	bin.write(reinterpret_cast<const char*>(normals.data()), normBytes);
+	bin.write(reinterpret_cast<const char*>(uvs.data()), uvBytes);
+	bin.write(reinterpret_cast<const char*>(indices.data()), indexBytes);
+	bin.close();
+
+	std::ofstream json(path);
+	json << "{\"asset\":{\"version\":\"2.0\"},"
+		<< "\"buffers\":[{\"uri\":\"" << binName << "\",\"byteLength\":" << (posBytes + normBytes + uvBytes + indexBytes) << "}],"
+		<< "\"bufferViews\":["
+		<< "{\"buffer\":0,\"byteOffset\":0,\"byteLength\":" << posBytes << "},"
+		<< "{\"buffer\":0,\"byteOffset\":" << posBytes << ",\"byteLength\":" << normBytes << "},"
+		<< "{\"buffer\":0,\"byteOffset\":" << (posBytes + normBytes) << ",\"byteLength\":" << uvBytes << "},"
+		<< "{\"buffer\":0,\"byteOffset\":" << (posBytes + normBytes + uvBytes) << ",\"byteLength\":" << indexBytes << "}],"
+		<< "\"accessors\":["
+		<< "{\"bufferView\":0,\"componentType\":5126,\"type\":\"VEC3\",\"count\":" << vertCount
+		<< ",\"min\":[0,0,0],\"max\":[" << (size - 1) << ",0," << (size - 1) << "]},"
+		<< "{\"bufferView\":1,\"componentType\":5126,\"type\":\"VEC3\",\"count\":" << vertCount << "},"
+		<< "{\"bufferView\":2,\"componentType\":5126,\"type\":\"VEC2\",\"count\":" << vertCount << "},"
+		<< "{\"bufferView\":3,\"componentType\":5125,\"type\":\"SCALAR\",\"count\":" << indices.size() << "}],"
+		<< "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},\"indices\":3}]}],"
+		<< "\"nodes\":[{\"mesh\":0}],\"scenes\":[{\"nodes\":[0]}],\"scene\":0}";
+}
+
+/// <summary>
+/// Mirrors how the loader used to extract a primitive: every index was expanded into its own vertex, with a
+/// memcpy per attribute per vertex
+/// </summary>
+static size_t LegacyExtract(const tinygltf::Model& gltf, std::vector<glm::vec3>& verts, std::vector<glm::vec3>& normals, std::vector<glm::vec2>& uvs) {
+	const tinygltf::Primitive& geom = gltf.meshes[0].primitives[0];
+	nou::GLTF::DataGetter faceIndexer = nou::GLTF::BuildGetter(gltf, geom.indices);
+	nou::GLTF::DataGetter vGetter = nou::GLTF::BuildGetter(gltf, nou::GLTF::FindAccessor(geom, "POSITION"));
+	nou::GLTF::DataGetter nGetter = nou::GLTF::BuildGetter(gltf, nou::GLTF::FindAccessor(geom, "NORMAL"));
+	nou::GLTF::DataGetter uvGetter = nou::GLTF::BuildGetter(gltf, nou::GLTF::FindAccessor(geom, "TEXCOORD_0"));
+
+	verts.resize(faceIndexer.len);
+	normals.resize(faceIndexer.len);
+	uvs.resize(faceIndexer.len);
+	for (size_t ix = 0; ix < faceIndexer.len; ix++) {
+		uint32_t vert;
+		memcpy(&vert, &faceIndexer.data[ix * faceIndexer.stride], sizeof(uint32_t));
+		memcpy(&verts[ix], &vGetter.data[vert * vGetter.stride], sizeof(glm::vec3));
+		memcpy(&normals[ix], &nGetter.data[vert * nGetter.stride], sizeof(glm::vec3));
+		memcpy(&uvs[ix], &uvGetter.data[vert * uvGetter.stride], sizeof(glm::vec2));
+		uvs[ix].y = 1.0f - uvs[ix].y;
+	}
+	return faceIndexer.len;
+}
+
+void RunGltfBenchmark(const std::vector<std::string>& args)
+{
+	int size = args.size() > 0 ? std::stoi(args[0]) : 300;
+	int iterations = args.size() > 1 ? std::stoi(args[1]) : 10;
+	const std::string path = args.size() > 2 ? args[2] : "benchmark_grid.gltf";
+
+	// A 300x300 grid has more than 65k vertices, which the old loader rejected because of it's 16 bit indices
+	WriteGrid(path, "benchmark_grid.bin", size);
+
+	tinygltf::Model gltf;
+	std::string err, warn;
+	if (!nou::GLTF::ParseGLTF(path, gltf, err, warn)) {
+		throw std::runtime_error("Failed to parse the benchmark grid: " + err);
+	}
+
+	std::cout << (size * size) << " vertices, " << ((size - 1) * (size - 1) * 2) << " triangles, " << iterations << " iterations" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	// Without a GL context the meshes only keep their CPU side data, so this measures just the extraction
+	size_t vertCount = 0, indexCount = 0;
+	{
+		BenchmarkTimer timer;
+		for (int ix = 0; ix < iterations; ix++) {
+			nou::Mesh mesh;
+			if (!nou::GLTF::ExtractGeometry(gltf, 0, mesh, true, err, warn)) {
+				throw std::runtime_error("Failed to extract the benchmark grid: " + err);
+			}
+			vertCount = mesh.GetVerts().size();
+			indexCount = mesh.GetIndices().size();
+		}
+		std::cout << "Indexed extract:      " << std::setw(10) << timer.ElapsedMs() / iterations << " ms" << std::endl;
+	}
+
+	size_t legacyCount = 0;
+	{
+		BenchmarkTimer timer;
+		for (int ix = 0; ix < iterations; ix++) {
+			std::vector<glm::vec3> verts, normals;
+			std::vector<glm::vec2> uvs;
+			legacyCount = LegacyExtract(gltf, verts, normals, uvs);
+		}
+		std::cout << "Legacy extract:       " << std::setw(10) << timer.ElapsedMs() / iterations << " ms" << std::endl;
+	}
+
+	// Same sizes that the buffers end up with on the GPU
+	const size_t vertexSize = sizeof(glm::vec3) * 2 + sizeof(glm::vec2);
+	const size_t indexSize = vertCount > 0xFFFF ? sizeof(uint32_t) : sizeof(uint16_t);
+	const double indexedKb = (vertCount * vertexSize + indexCount * indexSize) / 1024.0;
+	const double legacyKb = (legacyCount * vertexSize) / 1024.0;
+	std::cout << "GPU memory (indexed): " << std::setw(10) << indexedKb << " KB (" << vertCount << " vertices, " << indexCount << " indices)" << std::endl;
+	std::cout << "GPU memory (legacy):  " << std::setw(10) << legacyKb << " KB (" << legacyCount << " vertices)" << std::endl;
+
+	std::remove(path.c_str());
+	std::remove((path.substr(0, path.find_last_of("/\\") + 1) + "benchmark_grid.bin").c_str());
+}
@@ -0,0 +1,144 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <stdexcept>
+#include <algorithm>
+
+#include <TransformSystem.h>
+
+/// <summary>
+/// Mirrors how the old Transform::SetParent maintained the hierarchy: every reparent scanned every transform to
+/// find the children that needed their depth updated, then re-sorted the whole pool by depth
+/// </summary>
+struct LegacyHierarchy
+{
+	std::vector<int> Parents;
+	std::vector<int> Depths;
+	// Stands in for the order of the Transform pool in the registry
+	std::vector<int> Order;
+
+	LegacyHierarchy(int count) : Parents(count, -1), Depths(count, 0), Order(count) {
+		for (int ix = 0; ix < count; ix++) {
+			Order[ix] = ix;
+		}
+	}
+
+	void SetParent(int node, int parent) {
+		Parents[node] = parent;
+		_Recalculate(node);
+		std::stable_sort(Order.begin(), Order.end(), [&](int l, int r) { return Depths[l] < Depths[r]; });
+	}
+
+private:
+	void _Recalculate(int node) {
+		Depths[node] = Parents[node] != -1 ? Depths[Parents[node]] + 1 : 0;
+		for (size_t ix = 0; ix < Parents.size(); ix++) {
+			if (Parents[ix] == node) {
+				_Recalculate(static_cast<int>(ix));
+			}
+		}
+	}
+};
+
+// Returns true if making parent the parent of node would create a loop
+static bool WouldLoop(const TransformSystem& system, uint32_t node, uint32_t parent) {
+	for (uint32_t ancestor = parent; ancestor != TransformSystem::INVALID; ancestor = system.GetParent(ancestor)) {
+		if (ancestor == node) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void RunHierarchyBenchmark(const std::vector<std::string>& args)
+{
+	int count = args.size() > 0 ? std::stoi(args[0]) : 10000;
+	int churn = args.size() > 1 ? std::stoi(args[1]) : 10000;
+
+	// Pick a random tree up front so that every version builds the same one. Each node's parent is one of the few
+	// nodes before it, which gives us lots of small objects with a few levels each
+	std::mt19937 random(4321);
+	std::vector<int> parents(count, -1);
+	for (int ix = 1; ix < count; ix++) {
+		if (random() % 10 != 0) {
+			parents[ix] = ix - 1 - static_cast<int>(random() % std::min(ix, 8));
+		}
+	}
+
+	std::cout << count << " transforms, " << churn << " reparents" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	// Top down, parents are attached before their children, so no existing subtrees need to move
+	{
+		TransformSystem system;
+		for (int ix = 0; ix < count; ix++) {
+			system.Allocate();
+		}
+		BenchmarkTimer timer;
+		for (int ix = 0; ix < count; ix++) {
+			if (parents[ix] != -1) {
+				system.SetParent(ix, parents[ix]);
+			}
+		}
+		std::cout << "Build top down:       " << std::setw(10) << timer.ElapsedMs() << " ms (" << system.GetLevelCount() << " levels)" << std::endl;
+	}
+
+	// Bottom up, every attach moves a subtree that has already been built
+	{
+		TransformSystem system;
+		for (int ix = 0; ix < count; ix++) {
+			system.Allocate();
+		}
+		BenchmarkTimer timer;
+		for (int ix = count - 1; ix >= 0; ix--) {
+			if (parents[ix] != -1) {
+				system.SetParent(ix, parents[ix]);
+			}
+		}
+		const double buildMs = timer.ElapsedMs();
+		std::cout << "Build bottom up:      " << std::setw(10) << buildMs << " ms (" << system.GetLevelCount() << " levels)" << std::endl;
+
+		// Reparent churn, like picking up and dropping objects at runtime. We update the world matrices as we go,
+		// since each reparent dirties the moved transform
+		std::uniform_int_distribution<int> node(0, count - 1);
+		int moved = 0;
+		timer.Reset();
+		for (int ix = 0; ix < churn; ix++) {
+			const uint32_t child = node(random);
+			const uint32_t parent = random() % 4 == 0 ? TransformSystem::INVALID : node(random);
+			if (parent == TransformSystem::INVALID || !WouldLoop(system, child, parent)) {
+				system.SetParent(child, parent);
+				moved++;
+			}
+			if (ix % 100 == 99) {
+				system.Update(false);
+			}
+		}
+		const double churnMs = timer.ElapsedMs();
+		std::cout << "Reparent churn:       " << std::setw(10) << churnMs << " ms (" << (churnMs * 1000.0 / std::max(moved, 1)) << " us/reparent, "
+			<< system.GetLevelCount() << " levels)" << std::endl;
+
+		// Make sure the depth buckets are still consistent with the parent links
+		for (int ix = 0; ix < count; ix++) {
+			const uint32_t parent = system.GetParent(ix);
+			const int expected = parent != TransformSystem::INVALID ? system.GetDepth(parent) + 1 : 0;
+			if (system.GetDepth(ix) != expected) {
+				throw std::runtime_error("Hierarchy depths are out of sync after reparenting");
+			}
+		}
+	}
+
+	// The old approach, which is quadratic in the number of transforms
+	{
+		LegacyHierarchy legacy(count);
+		BenchmarkTimer timer;
+		for (int ix = count - 1; ix >= 0; ix--) {
+			if (parents[ix] != -1) {
+				legacy.SetParent(ix, parents[ix]);
+			}
+		}
+		std::cout << "Legacy bottom up:     " << std::setw(10) << timer.ElapsedMs() << " ms" << std::endl;
+	}
+}
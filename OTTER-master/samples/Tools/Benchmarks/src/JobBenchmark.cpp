@@ -0,0 +1,247 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <numeric>
+#include <stdexcept>
+
+#include <entt.hpp>
+
+#include <JobSystem.h>
+
+// Below this, fib is computed serially. Keeps the std::async baseline from starting thousands of threads
+static const int FIB_CUTOFF = 16;
+
+static uint64_t FibSerial(int n) {
+	return n < 2 ? n : FibSerial(n - 1) + FibSerial(n - 2);
+}
+
+/// <summary>
+/// Fork-join through the job system, one half as a job and the other half on this thread, then waiting
+/// </summary>
+static uint64_t FibJobs(int n) {
+	if (n < FIB_CUTOFF) {
+		return FibSerial(n);
+	}
+	uint64_t a = 0;
+	JobCounter::sptr counter = JobCounter::Create();
+	JobSystem::Run([&a, n]() { a = FibJobs(n - 1); }, counter);
+	const uint64_t b = FibJobs(n - 2);
+	JobSystem::Wait(counter);
+	return a + b;
+}
+
+/// <summary>
+/// The same fork-join with a new thread for every fork, which is what std::async gives us
+/// </summary>
+static uint64_t FibAsync(int n) {
+	if (n < FIB_CUTOFF) {
+		return FibSerial(n);
+	}
+	std::future<uint64_t> a = std::async(std::launch::async, FibAsync, n - 1);
+	const uint64_t b = FibAsync(n - 2);
+	return a.get() + b;
+}
+
+struct JobTestValue
+{
+	uint32_t Value;
+};
+
+struct JobTestScale
+{
+	uint32_t Scale;
+};
+
+void RunJobBenchmark(const std::vector<std::string>& args)
+{
+	const int jobs = args.size() > 0 ? std::stoi(args[0]) : 200000;
+	const int fib = args.size() > 1 ? std::stoi(args[1]) : 30;
+
+	JobSystem::ResetStats();
+	std::cout << std::fixed << std::setprecision(3) << JobSystem::GetWorkerCount() << " workers" << std::endl;
+
+	// Throughput of empty jobs, scheduled from the main thread and fanned out from inside of a job
+	{
+		std::atomic<int> ran(0);
+		JobCounter::sptr counter = JobCounter::Create();
+		BenchmarkTimer timer;
+		for (int ix = 0; ix < jobs; ix++) {
+			JobSystem::Run([&ran]() { ran.fetch_add(1, std::memory_order_relaxed); }, counter);
+		}
+		JobSystem::Wait(counter);
+		const double mainMs = timer.ElapsedMs();
+
+		timer.Reset();
+		JobCounter::sptr outer = JobCounter::Create();
+		JobSystem::Run([&ran, jobs]() {
+			JobCounter::sptr inner = JobCounter::Create();
+			for (int ix = 0; ix < jobs; ix++) {
+				JobSystem::Run([&ran]() { ran.fetch_add(1, std::memory_order_relaxed); }, inner);
+			}
+			JobSystem::Wait(inner);
+		}, outer);
+		JobSystem::Wait(outer);
+		const double fanMs = timer.ElapsedMs();
+		if (ran.load() != jobs * 2) {
+			throw std::runtime_error("Not every empty job ran");
+		}
+		std::cout << "Empty jobs from main:      " << std::setw(9) << mainMs * 1000000.0 / jobs << " ns/job" << std::endl
+		          << "Empty jobs from a job:     " << std::setw(9) << fanMs * 1000000.0 / jobs << " ns/job" << std::endl;
+	}
+
+	// Recursive fork-join, where every level waits on the level below it
+	{
+		BenchmarkTimer timer;
+		const uint64_t expected = FibSerial(fib);
+		const double serialMs = timer.ElapsedMs();
+		timer.Reset();
+		const uint64_t jobResult = FibJobs(fib);
+		const double jobMs = timer.ElapsedMs();
+		timer.Reset();
+		const uint64_t asyncResult = FibAsync(fib);
+		const double asyncMs = timer.ElapsedMs();
+		if (jobResult != expected || asyncResult != expected) {
+			throw std::runtime_error("Fork-join fib gave the wrong answer");
+		}
+		std::cout << "fib(" << fib << ") serial:          " << std::setw(9) << serialMs << " ms" << std::endl
+		          << "fib(" << fib << ") job system:      " << std::setw(9) << jobMs << " ms" << std::endl
+		          << "fib(" << fib << ") std::async:      " << std::setw(9) << asyncMs << " ms" << std::endl;
+	}
+
+	// A chain of jobs where each depends on the one before it must run strictly in order
+	{
+		const int length = 1000;
+		std::vector<int> order;
+		order.reserve(length);
+		JobCounter::sptr previous = nullptr;
+		JobCounter::sptr all = JobCounter::Create();
+		BenchmarkTimer timer;
+		for (int ix = 0; ix < length; ix++) {
+			JobCounter::sptr counter = JobCounter::Create();
+			JobSystem::Run([&order, ix]() { order.push_back(ix); }, counter, previous);
+			// Every link also counts towards the whole chain, so we can wait on all of them at once
+			JobSystem::Run([]() {}, all, counter);
+			previous = counter;
+		}
+		JobSystem::Wait(all);
+		const double chainMs = timer.ElapsedMs();
+		for (int ix = 0; ix < length; ix++) {
+			if (ix >= (int)order.size() || order[ix] != ix) {
+				throw std::runtime_error("Dependent jobs ran out of order");
+			}
+		}
+		std::cout << "Dependency chain:          " << std::setw(9) << chainMs * 1000.0 / length << " us/link" << std::endl;
+	}
+
+	// Jobs pinned to the main thread only run there, even when a worker schedules them
+	{
+		std::atomic<int> onMain(0);
+		std::atomic<int> offMain(0);
+		JobCounter::sptr counter = JobCounter::Create();
+		JobCounter::sptr scheduled = JobCounter::Create();
+		JobSystem::Run([&, counter]() {
+			for (int ix = 0; ix < 16; ix++) {
+				JobSystem::Run([&]() {
+					(JobSystem::IsMainThread() ? onMain : offMain)++;
+				}, counter, nullptr, JobAffinity::MainThread);
+			}
+		}, scheduled);
+		// The main thread may pick some of them up while it waits, RunMainThreadJobs gets the rest
+		JobSystem::Wait(scheduled);
+		JobSystem::RunMainThreadJobs();
+		JobSystem::Wait(counter);
+		if (onMain.load() != 16 || offMain.load() != 0) {
+			throw std::runtime_error("Main thread jobs ran somewhere else");
+		}
+	}
+
+	// ParallelFor should cover every item exactly once, and hand back the first exception
+	{
+		const size_t count = 1000000;
+		std::vector<uint32_t> values(count, 0);
+		JobSystem::ParallelFor(count, 256, [&](size_t begin, size_t end) {
+			for (size_t ix = begin; ix < end; ix++) {
+				values[ix] += (uint32_t)ix;
+			}
+		});
+		const uint64_t sum = std::accumulate(values.begin(), values.end(), (uint64_t)0);
+		if (sum != (uint64_t)count * (count - 1) / 2) {
+			throw std::runtime_error("ParallelFor missed or repeated items");
+		}
+
+		bool caught = false;
+		try {
+			JobSystem::ParallelFor(count, 256, [&](size_t begin, size_t end) {
+				if (begin <= count / 2 && count / 2 < end) {
+					throw std::runtime_error("expected");
+				}
+			});
+		}
+		catch (const std::runtime_error&) {
+			caught = true;
+		}
+		if (!caught) {
+			throw std::runtime_error("ParallelFor swallowed an exception");
+		}
+	}
+
+	// ParallelForEach over single and multi component views
+	{
+		entt::registry registry;
+		const uint32_t entities = 100000;
+		for (uint32_t ix = 0; ix < entities; ix++) {
+			entt::entity entity = registry.create();
+			registry.emplace<JobTestValue>(entity, JobTestValue{ ix });
+			if (ix % 2 == 0) {
+				registry.emplace<JobTestScale>(entity, JobTestScale{ 3 });
+			}
+		}
+		JobSystem::ParallelForEach<JobTestValue>(registry, [](entt::entity, JobTestValue& value) {
+			value.Value += 1;
+		});
+		JobSystem::ParallelForEach<JobTestValue, JobTestScale>(registry, [](entt::entity, JobTestValue& value, const JobTestScale& scale) {
+			value.Value *= scale.Scale;
+		});
+		uint64_t sum = 0;
+		registry.view<JobTestValue>().each([&](JobTestValue& value) { sum += value.Value; });
+		uint64_t expected = 0;
+		for (uint32_t ix = 0; ix < entities; ix++) {
+			expected += (uint64_t)(ix + 1) * (ix % 2 == 0 ? 3 : 1);
+		}
+		if (sum != expected) {
+			throw std::runtime_error("ParallelForEach missed or repeated entities");
+		}
+	}
+
+	// ParallelFor from inside of jobs, which would deadlock a pool that blocks while waiting
+	{
+		const int outer = (int)(JobSystem::GetWorkerCount() + 1) * 4;
+		std::atomic<uint64_t> total(0);
+		JobCounter::sptr counter = JobCounter::Create();
+		BenchmarkTimer timer;
+		for (int ix = 0; ix < outer; ix++) {
+			JobSystem::Run([&total]() {
+				JobSystem::ParallelFor(100000, 1024, [&total](size_t begin, size_t end) {
+					total.fetch_add(end - begin, std::memory_order_relaxed);
+				});
+			}, counter);
+		}
+		JobSystem::Wait(counter);
+		const double nestedMs = timer.ElapsedMs();
+		if (total.load() != (uint64_t)outer * 100000) {
+			throw std::runtime_error("Nested ParallelFor missed items");
+		}
+		std::cout << "Nested ParallelFor:        " << std::setw(9) << nestedMs << " ms for " << outer << " jobs" << std::endl;
+	}
+
+	std::cout << std::left << std::setw(12) << "Thread" << std::right << std::setw(10) << "Jobs" << std::setw(10) << "Steals"
+		<< std::setw(12) << "Busy ms" << std::setw(8) << "Util" << std::endl;
+	for (const JobSystem::ThreadStats& stats : JobSystem::GetStats()) {
+		std::cout << std::left << std::setw(12) << stats.Name << std::right << std::setw(10) << stats.JobsRun << std::setw(10) << stats.Steals
+			<< std::setw(12) << std::setprecision(1) << stats.BusyMs << std::setw(7) << stats.Utilization * 100.0f << "%" << std::endl;
+	}
+}
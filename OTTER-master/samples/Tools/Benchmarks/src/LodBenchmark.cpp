@@ -0,0 +1,135 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
+
+#include <ObjLoader.h>
+#include <MeshFactory.h>
+#include <MeshBakeSettings.h>
+
+typedef MeshBuilder<VertexPosNormTexCol> Builder;
+
+/// <summary>
+/// Checks that a level is a whole number of triangles inside the index buffer, using only vertices that exist
+/// </summary>
+static bool LevelUsesValidVertices(const Builder& mesh, const MeshLod& level) {
+	const uint32_t* indices = mesh.GetIndexDataPtr() + level.IndexOffset;
+	for (uint32_t ix = 0; ix < level.IndexCount; ix++) {
+		if (indices[ix] >= mesh.GetVertexCount()) {
+			return false;
+		}
+	}
+	return level.IndexCount % 3 == 0 && level.IndexOffset + level.IndexCount <= mesh.GetIndexCount();
+}
+
+static void Report(const std::string& name, const Builder& source, const std::vector<float>& errors) {
+	Builder mesh = source;
+	BenchmarkTimer timer;
+	mesh.GenerateLods(errors);
+	const double ms = timer.ElapsedMs();
+
+	// Like optimizing, simplifying has to be deterministic or baked meshes would not be reproducible
+	Builder again = source;
+	again.GenerateLods(errors);
+	const bool deterministic = again.GetIndexCount() == mesh.GetIndexCount() &&
+		memcmp(again.GetIndexDataPtr(), mesh.GetIndexDataPtr(), sizeof(uint32_t) * mesh.GetIndexCount()) == 0;
+
+	const std::vector<MeshLod>& lods = mesh.GetLods();
+	const float radius = mesh.CalculateBounds().Radius;
+	std::cout << std::left << std::setw(24) << name << std::right << std::setw(10) << source.GetTriangleCount();
+	for (size_t ix = 1; ix < lods.size(); ix++) {
+		if (!LevelUsesValidVertices(mesh, lods[ix])) {
+			throw std::runtime_error("Level " + std::to_string(ix) + " of " + name + " is not a valid index range");
+		}
+		std::cout << std::setw(9) << lods[ix].IndexCount / 3 << " (" << std::setprecision(4) << lods[ix].Error / radius << ")";
+	}
+	std::cout << std::setprecision(3) << "  " << ms << " ms" << (deterministic ? "" : "  NOT DETERMINISTIC") << std::endl;
+	if (!deterministic) {
+		throw std::runtime_error("Simplifying " + name + " gave different results on the same input");
+	}
+}
+
+/// <summary>
+/// Walks a row of copies of a mesh away from a camera, one bounding sphere radius apart, and counts the triangles
+/// submitted with and without LODs, and how often each copy changes level when it's distance wobbles back and forth
+/// </summary>
+static void SimulateSelection(const Builder& mesh, int copies, float viewportHeight) {
+	const std::vector<MeshLod>& lods = mesh.GetLods();
+	if (lods.empty()) {
+		return;
+	}
+	const float radius = mesh.CalculateBounds().Radius;
+	// A 60 degree field of view, matching the projection's 1/tan(fov/2) Y scale
+	const float scale = 1.0f / std::tan(glm::radians(30.0f)) * viewportHeight * 0.5f;
+
+	size_t fullTris = 0, lodTris = 0;
+	size_t switchesWith = 0, switchesWithout = 0;
+	for (int ix = 0; ix < copies; ix++) {
+		const float distance = radius * (2.0f + ix);
+		uint32_t lod = MeshLod::Select(lods, radius, 0, radius * scale / distance, 1.0f, 0.25f);
+		fullTris += lods[0].IndexCount / 3;
+		lodTris += lods[lod].IndexCount / 3;
+
+		// Wobble the distance by 2% for a few frames, like a camera bobbing up and down
+		uint32_t with = lod, without = lod;
+		for (int frame = 0; frame < 60; frame++) {
+			const float wobble = distance * (1.0f + 0.02f * std::sin(frame * 0.5f));
+			const float projected = radius * scale / wobble;
+			const uint32_t nextWith = MeshLod::Select(lods, radius, with, projected, 1.0f, 0.25f);
+			const uint32_t nextWithout = MeshLod::Select(lods, radius, without, projected, 1.0f, 0.0f);
+			switchesWith += nextWith != with;
+			switchesWithout += nextWithout != without;
+			with = nextWith;
+			without = nextWithout;
+		}
+	}
+	std::cout << copies << " copies at " << viewportHeight << "px: "
+		<< fullTris << " tris without LODs, " << lodTris << " with LODs (" << std::setprecision(1)
+		<< 100.0 * lodTris / fullTris << "%)" << std::setprecision(3) << std::endl;
+	std::cout << "Level switches over 60 wobbling frames: " << switchesWithout << " without hysteresis, "
+		<< switchesWith << " with" << std::endl;
+}
+
+void RunLodBenchmark(const std::vector<std::string>& args)
+{
+	std::string modelDir = args.size() > 0 ? args[0] : "../../../projects/Assignment 1/res/models";
+	const std::vector<float> errors = MeshBakeSettings().LodErrors;
+
+	std::cout << "Triangles per level (error relative to the bounding sphere radius)" << std::endl;
+	std::cout << std::left << std::setw(24) << "Mesh" << std::right << std::setw(10) << "Tris" << "   Levels..." << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	Builder sphere;
+	MeshFactory::AddUvSphere(sphere, glm::vec3(0.0f), 1.0f, 6);
+	Report("uv sphere", sphere, errors);
+
+	Builder largest;
+	if (std::filesystem::is_directory(modelDir)) {
+		std::vector<std::filesystem::path> files;
+		for (const auto& entry : std::filesystem::directory_iterator(modelDir)) {
+			if (entry.path().extension() == ".obj") {
+				files.push_back(entry.path());
+			}
+		}
+		std::sort(files.begin(), files.end());
+		for (const auto& path : files) {
+			Builder mesh;
+			ObjLoader::ParseFile(path.string(), mesh);
+			Report(path.filename().string(), mesh, errors);
+			if (mesh.GetTriangleCount() > largest.GetTriangleCount()) {
+				largest = mesh;
+			}
+		}
+	}
+
+	if (largest.GetTriangleCount() == 0) {
+		largest = sphere;
+	}
+	largest.GenerateLods(errors);
+	SimulateSelection(largest, 100, 1080.0f);
+}
@@ -0,0 +1,121 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <algorithm>
+#include <random>
+#include <cstring>
+#include <stdexcept>
+
+#include <ObjLoader.h>
+#include <MeshFactory.h>
+
+typedef MeshBuilder<VertexPosNormTexCol> Builder;
+
+/// <summary>
+/// Builds a flat grid of (size x size) vertices, with it's triangles in row order like most generated meshes
+/// </summary>
+static Builder MakeGrid(int size) {
+	Builder mesh;
+	mesh.ReserveVertexSpace(static_cast<size_t>(size) * size);
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			mesh.AddVertex(glm::vec3(x, 0.0f, y), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(x, y) / static_cast<float>(size - 1), glm::vec4(1.0f));
+		}
+	}
+	for (int y = 0; y < size - 1; y++) {
+		for (int x = 0; x < size - 1; x++) {
+			const uint32_t i = y * size + x;
+			mesh.AddIndexTri(i, i + size, i + 1);
+			mesh.AddIndexTri(i + 1, i + size, i + size + 1);
+		}
+	}
+	return mesh;
+}
+
+/// <summary>
+/// Copies a mesh with it's triangles in a random order, like the worst case from an exporter that doesn't care
+/// </summary>
+static Builder Shuffle(const Builder& source, uint32_t seed) {
+	const size_t triCount = source.GetIndexCount() / 3;
+	std::vector<size_t> order(triCount);
+	for (size_t ix = 0; ix < triCount; ix++) {
+		order[ix] = ix;
+	}
+	std::shuffle(order.begin(), order.end(), std::mt19937(seed));
+
+	Builder mesh;
+	for (size_t ix = 0; ix < source.GetVertexCount(); ix++) {
+		mesh.AddVertex(source.GetVertexDataPtr()[ix]);
+	}
+	const uint32_t* indices = source.GetIndexDataPtr();
+	for (size_t tri : order) {
+		mesh.AddIndexTri(indices[tri * 3], indices[tri * 3 + 1], indices[tri * 3 + 2]);
+	}
+	return mesh;
+}
+
+static void Report(const std::string& name, const Builder& source) {
+	Builder mesh = source;
+	BenchmarkTimer timer;
+	const MeshOptimizeReport report = mesh.Optimize();
+	const double ms = timer.ElapsedMs();
+
+	// Optimizing the same input again has to give exactly the same result, or baked meshes would not be reproducible
+	Builder again = source;
+	again.Optimize();
+	const bool deterministic = again.GetIndexCount() == mesh.GetIndexCount() && again.GetVertexCount() == mesh.GetVertexCount() &&
+		memcmp(again.GetIndexDataPtr(), mesh.GetIndexDataPtr(), sizeof(uint32_t) * mesh.GetIndexCount()) == 0 &&
+		memcmp(again.GetVertexDataPtr(), mesh.GetVertexDataPtr(), sizeof(VertexPosNormTexCol) * mesh.GetVertexCount()) == 0;
+
+	std::cout << std::left << std::setw(24) << name << std::right
+		<< std::setw(10) << mesh.GetTriangleCount()
+		<< std::setw(10) << report.Before.ACMR << std::setw(10) << report.After.ACMR
+		<< std::setw(10) << report.Before.ATVR << std::setw(10) << report.After.ATVR
+		<< std::setw(12) << ms
+		<< (deterministic ? "" : "  NOT DETERMINISTIC") << std::endl;
+	if (!deterministic) {
+		throw std::runtime_error("Optimizing " + name + " gave different results on the same input");
+	}
+}
+
+void RunMeshOptimizerBenchmark(const std::vector<std::string>& args)
+{
+	std::string modelDir = args.size() > 0 ? args[0] : "../../../projects/Assignment 1/res/models";
+	int gridSize = args.size() > 1 ? std::stoi(args[1]) : 200;
+
+	std::cout << "Vertex cache statistics with a " << MeshOptimizer::FIFO_CACHE_SIZE << " entry FIFO cache" << std::endl;
+	std::cout << std::left << std::setw(24) << "Mesh" << std::right
+		<< std::setw(10) << "Tris"
+		<< std::setw(10) << "ACMR"
+		<< std::setw(10) << "(opt)"
+		<< std::setw(10) << "ATVR"
+		<< std::setw(10) << "(opt)"
+		<< std::setw(12) << "Time ms" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	const Builder grid = MakeGrid(gridSize);
+	Report("grid", grid);
+	Report("grid (shuffled)", Shuffle(grid, 1234));
+
+	Builder sphere;
+	MeshFactory::AddUvSphere(sphere, glm::vec3(0.0f), 1.0f, 5);
+	Report("uv sphere", sphere);
+	Report("uv sphere (shuffled)", Shuffle(sphere, 1234));
+
+	if (std::filesystem::is_directory(modelDir)) {
+		std::vector<std::filesystem::path> files;
+		for (const auto& entry : std::filesystem::directory_iterator(modelDir)) {
+			if (entry.path().extension() == ".obj") {
+				files.push_back(entry.path());
+			}
+		}
+		std::sort(files.begin(), files.end());
+		for (const auto& path : files) {
+			Builder mesh;
+			ObjLoader::ParseFile(path.string(), mesh);
+			Report(path.filename().string(), mesh);
+		}
+	}
+}
@@ -0,0 +1,173 @@
+#include "Benchmark.h"
+
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <unordered_map>
+#include <algorithm>
+
+#include <ObjLoader.h>
+#include <StringUtils.h>
+
+// The original stream based OBJ loader, kept around as a baseline to compare the parallel parser against
+static void ParseObjReference(const std::string& filename, MeshBuilder<VertexPosNormTexCol>& mesh, const glm::vec4& inColor)
+{
+	std::ifstream file;
+	file.open(filename, std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Failed to open file");
+	}
+
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> normals;
+	std::vector<glm::vec2> textureCoords;
+	std::unordered_map<uint64_t, uint32_t> indexMap;
+
+	glm::vec3 temp;
+	glm::ivec3 vertexIndices;
+
+	while (file.peek() != EOF) {
+		std::string command;
+		file >> command;
+
+		if (command == "v") {
+			file >> temp.x >> temp.y >> temp.z;
+			positions.push_back(temp);
+		}
+		else if (command == "vn") {
+			file >> temp.x >> temp.y >> temp.z;
+			normals.push_back(temp);
+		}
+		else if (command == "vt") {
+			file >> temp.x >> temp.y;
+			textureCoords.push_back(temp);
+		}
+		else if (command == "f") {
+			std::string line;
+			std::getline(file, line);
+			trim(line);
+			std::stringstream stream = std::stringstream(line);
+
+			uint32_t edges[4];
+			int ix = 0;
+			for (; ix < 4; ix++) {
+				if (stream.peek() != EOF) {
+					char tempChar;
+					vertexIndices = glm::ivec3(0);
+					stream >> vertexIndices.x >> tempChar >> vertexIndices.y >> tempChar >> vertexIndices.z;
+					const uint64_t mask = 0b0'000000000000000000000'000000000000000000000'111111111111111111111;
+					uint64_t key = ((vertexIndices.x & mask) << 42) | ((vertexIndices.y & mask) << 21) | (vertexIndices.z & mask);
+
+					auto it = indexMap.find(key);
+					if (it != indexMap.end()) {
+						edges[ix] = it->second;
+					}
+					else {
+						VertexPosNormTexCol vertex;
+						vertex.Position = positions[vertexIndices.x - 1];
+						vertex.UV = vertexIndices.y != 0 ? textureCoords[vertexIndices.y - 1] : glm::vec2(0.0f);
+						vertex.Normal = vertexIndices.z != 0 ? normals[vertexIndices.z - 1] : glm::vec3(0.0f, 0.0f, 1.0f);
+						vertex.Color = inColor;
+
+						uint32_t index = mesh.AddVertex(vertex);
+						indexMap[key] = index;
+						edges[ix] = index;
+					}
+				} else {
+					break;
+				}
+			}
+			if (ix == 3) {
+				mesh.AddIndexTri(edges[0], edges[1], edges[2]);
+			}
+			else if (ix == 4) {
+				mesh.AddIndexTri(edges[0], edges[1], edges[2]);
+				mesh.AddIndexTri(edges[0], edges[2], edges[3]);
+			}
+		}
+	}
+}
+
+// Checks that two meshes have identical vertex and index data
+static bool MeshesMatch(const MeshBuilder<VertexPosNormTexCol>& a, const MeshBuilder<VertexPosNormTexCol>& b) {
+	if (a.GetVertexCount() != b.GetVertexCount() || a.GetIndexCount() != b.GetIndexCount()) {
+		return false;
+	}
+	for (size_t ix = 0; ix < a.GetVertexCount(); ix++) {
+		const VertexPosNormTexCol& va = a.GetVertexDataPtr()[ix];
+		const VertexPosNormTexCol& vb = b.GetVertexDataPtr()[ix];
+		if (va.Position != vb.Position || va.Normal != vb.Normal || va.UV != vb.UV || va.Color != vb.Color) {
+			return false;
+		}
+	}
+	return std::equal(a.GetIndexDataPtr(), a.GetIndexDataPtr() + a.GetIndexCount(), b.GetIndexDataPtr());
+}
+
+void RunObjLoaderBenchmark(const std::vector<std::string>& args)
+{
+	// By default we'll use the models from assignment 1, relative to our output directory
+	std::string modelDir = args.size() > 0 ? args[0] : "../../../projects/Assignment 1/res/models";
+	int iterations = args.size() > 1 ? std::stoi(args[1]) : 10;
+
+	std::vector<std::filesystem::path> files;
+	for (const auto& entry : std::filesystem::directory_iterator(modelDir)) {
+		if (entry.path().extension() == ".obj") {
+			files.push_back(entry.path());
+		}
+	}
+	std::sort(files.begin(), files.end());
+	if (files.empty()) {
+		throw std::runtime_error("No OBJ files found in " + modelDir);
+	}
+
+	std::cout << std::left << std::setw(20) << "File" << std::right
+		<< std::setw(10) << "Size (KB)"
+		<< std::setw(14) << "Stream MB/s"
+		<< std::setw(14) << "Mapped MB/s"
+		<< std::setw(10) << "Speedup"
+		<< std::setw(8) << "Match" << std::endl;
+
+	double totalBytes = 0.0, totalStreamMs = 0.0, totalMappedMs = 0.0;
+	for (const std::filesystem::path& path : files) {
+		const double bytes = static_cast<double>(std::filesystem::file_size(path));
+
+		// Make sure both loaders agree before we time anything
+		MeshBuilder<VertexPosNormTexCol> expected, actual;
+		ParseObjReference(path.string(), expected, glm::vec4(1.0f));
+		ObjLoader::ParseFile(path.string(), actual);
+		const bool match = MeshesMatch(expected, actual);
+
+		BenchmarkTimer timer;
+		for (int ix = 0; ix < iterations; ix++) {
+			MeshBuilder<VertexPosNormTexCol> mesh;
+			ParseObjReference(path.string(), mesh, glm::vec4(1.0f));
+		}
+		const double streamMs = timer.ElapsedMs();
+
+		timer.Reset();
+		for (int ix = 0; ix < iterations; ix++) {
+			MeshBuilder<VertexPosNormTexCol> mesh;
+			ObjLoader::ParseFile(path.string(), mesh);
+		}
+		const double mappedMs = timer.ElapsedMs();
+
+		const double megabytes = bytes * iterations / (1024.0 * 1024.0);
+		std::cout << std::left << std::setw(20) << path.filename().string() << std::right << std::fixed << std::setprecision(1)
+			<< std::setw(10) << bytes / 1024.0
+			<< std::setw(14) << megabytes / (streamMs / 1000.0)
+			<< std::setw(14) << megabytes / (mappedMs / 1000.0)
+			<< std::setw(9) << streamMs / mappedMs << "x"
+			<< std::setw(8) << (match ? "yes" : "NO") << std::endl;
+
+		totalBytes += bytes * iterations;
+		totalStreamMs += streamMs;
+		totalMappedMs += mappedMs;
+	}
+
+	const double totalMegabytes = totalBytes / (1024.0 * 1024.0);
+	std::cout << "Total: stream " << totalMegabytes / (totalStreamMs / 1000.0) << " MB/s, mapped "
+		<< totalMegabytes / (totalMappedMs / 1000.0) << " MB/s (" << totalStreamMs / totalMappedMs << "x)" << std::endl;
+}
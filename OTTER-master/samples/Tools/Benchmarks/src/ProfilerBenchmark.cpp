@@ -0,0 +1,178 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+#include <atomic>
+#include <stdexcept>
+
+#include <json.hpp>
+
+#include <Profiler.h>
+#include <JobSystem.h>
+#include <HeadlessContext.h>
+
+// We use the scope types directly rather than the macros, so that this measures the profiler even in builds where
+// the macros are compiled out
+
+/// <summary>
+/// Spends a little time on some work that the compiler can't remove, so zones have something inside of them
+/// </summary>
+static uint32_t Work(uint32_t seed, int iterations) {
+	for (int ix = 0; ix < iterations; ix++) {
+		seed = seed * 1664525u + 1013904223u;
+	}
+	return seed;
+}
+
+/// <summary>
+/// Runs a frame of work, split into groups of zones nested 3 deep
+/// </summary>
+static uint32_t RunFrame(int zones, bool profile, uint32_t seed) {
+	for (int ix = 0; ix < zones; ix += 3) {
+		if (profile) {
+			ProfileScope outer("Outer");
+			seed = Work(seed, 10);
+			{
+				ProfileScope middle("Middle");
+				seed = Work(seed, 10);
+				{
+					ProfileScope inner("Inner");
+					seed = Work(seed, 10);
+				}
+			}
+		} else {
+			seed = Work(seed, 10);
+			seed = Work(seed, 10);
+			seed = Work(seed, 10);
+		}
+	}
+	return seed;
+}
+
+void RunProfilerBenchmark(const std::vector<std::string>& args)
+{
+	const int zonesPerFrame = args.size() > 0 ? std::stoi(args[0]) : 3000;
+	const int frames = args.size() > 1 ? std::stoi(args[1]) : 200;
+	const std::string tracePath = args.size() > 2 ? args[2] : (std::filesystem::temp_directory_path() / "otter_profile.json").string();
+
+	Profiler::Reset();
+	Profiler::SetThreadName("Main");
+
+	// The overhead of recording a zone, compared to the same work without any zones
+	uint32_t seed = 1;
+	BenchmarkTimer timer;
+	for (int frame = 0; frame < frames; frame++) {
+		seed = RunFrame(zonesPerFrame, false, seed);
+	}
+	const double baseMs = timer.ElapsedMs();
+
+	const uint64_t droppedBefore = Profiler::GetDroppedZones();
+	timer.Reset();
+	for (int frame = 0; frame < frames; frame++) {
+		Profiler::BeginFrame();
+		seed = RunFrame(zonesPerFrame, true, seed);
+		Profiler::EndFrame();
+	}
+	const double profiledMs = timer.ElapsedMs();
+	const int recorded = (zonesPerFrame + 2) / 3 * 3;
+	if (Profiler::GetFrames().back().CpuZones.size() != (size_t)recorded || Profiler::GetDroppedZones() != droppedBefore) {
+		throw std::runtime_error("Profiler lost zones on the main thread");
+	}
+	for (const ProfileZone& zone : Profiler::GetFrames().back().CpuZones) {
+		const uint32_t expected = zone.Name[0] == 'O' ? 0 : zone.Name[0] == 'M' ? 1 : 2;
+		if (zone.Depth != expected || zone.End < zone.Start) {
+			throw std::runtime_error("Profiler recorded a zone with the wrong depth or time");
+		}
+	}
+
+	std::cout << std::fixed << std::setprecision(3)
+		<< "Main thread:  " << std::setw(9) << baseMs / frames << " ms/frame without zones, " << profiledMs / frames << " ms/frame with "
+		<< recorded << " zones (" << std::setprecision(1) << (profiledMs - baseMs) * 1000000.0 / ((double)frames * recorded) << " ns/zone)" << std::endl;
+
+	// Zones recorded on every worker at once, which is where a lock would start to hurt
+	const size_t tasks = (JobSystem::GetWorkerCount() + 1) * 4;
+	std::atomic<uint32_t> sink(0);
+	timer.Reset();
+	for (int frame = 0; frame < frames; frame++) {
+		Profiler::BeginFrame();
+		JobSystem::ParallelFor(tasks, 1, [&](size_t begin, size_t end) {
+			for (size_t ix = begin; ix < end; ix++) {
+				sink += RunFrame(zonesPerFrame / (int)tasks, true, (uint32_t)ix);
+			}
+		});
+		Profiler::EndFrame();
+	}
+	const double parallelMs = timer.ElapsedMs();
+	size_t threadsSeen = 0;
+	{
+		std::vector<bool> seen(Profiler::GetThreadNames().size());
+		for (const ProfileZone& zone : Profiler::GetFrames().back().CpuZones) {
+			threadsSeen += seen[zone.Thread] ? 0 : 1;
+			seen[zone.Thread] = true;
+		}
+	}
+	std::cout << std::setprecision(3) << "Job system:   " << std::setw(9) << parallelMs / frames << " ms/frame, zones from "
+		<< threadsSeen << " threads, " << Profiler::GetDroppedZones() << " dropped" << std::endl;
+
+	// GPU zones, if we can get a context. These are read back a few frames late, so we run a few extra frames to
+	// collect them all
+	HeadlessContextSettings settings;
+	settings.Width = 256;
+	settings.Height = 256;
+	HeadlessContext::sptr context = HeadlessContext::Create(settings);
+	if (context != nullptr) {
+		const int gpuFrames = 16;
+		for (int frame = 0; frame < gpuFrames + (int)Profiler::GPU_FRAMES_IN_FLIGHT; frame++) {
+			Profiler::BeginFrame();
+			{
+				GpuProfileScope outer("Frame");
+				for (int ix = 0; ix < 4; ix++) {
+					GpuProfileScope clear("Clear");
+					glClearColor(ix * 0.25f, 0.0f, 0.0f, 1.0f);
+					glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				}
+			}
+			Profiler::EndFrame();
+		}
+		glFinish();
+
+		const std::deque<ProfileFrame>& history = Profiler::GetFrames();
+		const ProfileFrame& checked = history[history.size() - 1 - Profiler::GPU_FRAMES_IN_FLIGHT];
+		if (!checked.HasGpuZones || checked.GpuZones.size() != 5) {
+			throw std::runtime_error("GPU zones were not read back");
+		}
+		for (const ProfileZone& zone : checked.GpuZones) {
+			const ProfileZone& outer = checked.GpuZones[0];
+			if (zone.End < zone.Start || (zone.Depth == 1 && (zone.Start < outer.Start || zone.End > outer.End))) {
+				throw std::runtime_error("GPU zones are not nested inside of each other");
+			}
+		}
+		std::cout << "GPU:          " << std::setw(9) << checked.GetGpuMs() << " ms/frame for 4 clears (" << context->GetRenderer() << ")" << std::endl;
+	} else {
+		std::cout << "GPU:          skipped, could not create a headless context" << std::endl;
+	}
+
+	// The trace should hold one event for every frame and zone in the history, plus the track names
+	timer.Reset();
+	Profiler::ExportChromeTrace(tracePath);
+	const double exportMs = timer.ElapsedMs();
+	size_t expected = 0;
+	for (const ProfileFrame& frame : Profiler::GetFrames()) {
+		expected += 1 + frame.CpuZones.size() + frame.GpuZones.size();
+	}
+	std::ifstream file(tracePath);
+	const nlohmann::json trace = nlohmann::json::parse(file);
+	size_t events = 0;
+	for (const nlohmann::json& event : trace["traceEvents"]) {
+		events += event["ph"] == "X" ? 1 : 0;
+	}
+	if (events != expected) {
+		throw std::runtime_error("Exported trace has " + std::to_string(events) + " events, expected " + std::to_string(expected));
+	}
+	std::cout << "Export:       " << std::setw(9) << exportMs << " ms for " << events << " events (" << tracePath << ")" << std::endl;
+
+	// The queries belong to the context, so they have to go before it does
+	Profiler::Reset();
+}
@@ -0,0 +1,212 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <cmath>
+#include <stdexcept>
+
+#include <GLM/gtc/matrix_transform.hpp>
+
+#include <HeadlessContext.h>
+#include <FrameCapture.h>
+#include <InstanceBuffer.h>
+#include <MeshFactory.h>
+#include <Shader.h>
+
+// A minimal instanced shader with one directional light, so the benchmark doesn't depend on any project's resources
+static const char* VERTEX_SHADER = R"(#version 410
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormal;
+layout(location = 4) in mat4 inInstanceModel;
+layout(location = 8) in mat3 inInstanceNormalMatrix;
+layout(location = 11) in vec4 inInstanceParams;
+
+uniform mat4 u_ViewProjection;
+
+out vec3 outColor;
+out vec3 outNormal;
+
+void main() {
+	gl_Position = u_ViewProjection * inInstanceModel * vec4(inPosition, 1.0);
+	outNormal = inInstanceNormalMatrix * inNormal;
+	outColor = inColor * inInstanceParams.rgb;
+}
+)";
+
+static const char* FRAGMENT_SHADER = R"(#version 410
+in vec3 outColor;
+in vec3 outNormal;
+
+out vec4 frag_color;
+
+void main() {
+	float light = max(dot(normalize(outNormal), normalize(vec3(0.4, 0.8, 0.6))), 0.0) * 0.8 + 0.2;
+	frag_color = vec4(outColor * light, 1.0);
+}
+)";
+
+/// <summary>
+/// How the frames are read back while rendering
+/// </summary>
+enum class CaptureMode
+{
+	None,
+	Async,
+	Sync
+};
+
+/// <summary>
+/// The state needed to draw the benchmark scene
+/// </summary>
+struct RenderScene
+{
+	Framebuffer::sptr       Target;
+	Shader::sptr            Program;
+	VertexArrayObject::sptr Mesh;
+	InstanceBuffer::sptr    Instances;
+	int                     GridSize;
+};
+
+/// <summary>
+/// Draws one frame of a grid of spheres, orbiting the camera by the frame number so that frames are deterministic
+/// </summary>
+static void DrawFrame(RenderScene& scene, uint64_t frame) {
+	scene.Target->Bind();
+	glClearColor(0.08f, 0.17f, 0.31f, 1.0f);
+	glClearDepth(1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	const float aspect = scene.Target->GetWidth() / (float)scene.Target->GetHeight();
+	const float angle = frame * 0.01f;
+	const float extent = (float)scene.GridSize;
+	const glm::mat4 view = glm::lookAt(glm::vec3(std::sin(angle), 0.6f, std::cos(angle)) * extent * 1.5f, glm::vec3(0.0f), glm::vec3(0, 1, 0));
+	const glm::mat4 projection = glm::perspective(glm::radians(60.0f), aspect, 0.1f, extent * 4.0f);
+	scene.Program->Bind();
+	scene.Program->SetUniformMatrix("u_ViewProjection", projection * view);
+
+	scene.Instances->BeginFrame();
+	uint32_t first = 0;
+	const float offset = (scene.GridSize - 1) * 0.5f;
+	for (int z = 0; z < scene.GridSize; z++) {
+		for (int x = 0; x < scene.GridSize; x++) {
+			const glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x - offset, 0.0f, z - offset));
+			const glm::vec4 color = glm::vec4(x / extent, 0.5f, z / extent, 0.0f);
+			const uint32_t index = scene.Instances->Push(model, glm::mat3(1.0f), color);
+			if (x == 0 && z == 0) {
+				first = index;
+			}
+		}
+	}
+	scene.Mesh->RenderInstanced(*scene.Instances, first, scene.GridSize * scene.GridSize);
+	scene.Instances->EndFrame();
+}
+
+/// <summary>
+/// Renders a number of frames with the given capture mode, returning the average time per frame in milliseconds
+/// </summary>
+static double RunFrames(RenderScene& scene, int frames, CaptureMode mode, FrameCapture& capture, std::vector<CapturedFrame>& captured) {
+	// Make sure nothing from before is still running when we start the clock
+	glFinish();
+	BenchmarkTimer timer;
+	for (int frame = 0; frame < frames; frame++) {
+		DrawFrame(scene, frame);
+		if (mode == CaptureMode::Async) {
+			// If every buffer is still busy, we have to wait on them before we can queue another
+			if (!capture.Request(*scene.Target, frame)) {
+				capture.Flush(captured);
+				capture.Request(*scene.Target, frame);
+			}
+			capture.Poll(captured);
+		} else if (mode == CaptureMode::Sync) {
+			captured.push_back(FrameCapture::ReadNow(*scene.Target, frame));
+		}
+	}
+	capture.Flush(captured);
+	glFinish();
+	return timer.ElapsedMs() / frames;
+}
+
+void RunRenderBenchmark(const std::vector<std::string>& args)
+{
+	const uint32_t width = args.size() > 0 ? std::stoi(args[0]) : 1280;
+	const uint32_t height = args.size() > 1 ? std::stoi(args[1]) : 720;
+	const int frames = args.size() > 2 ? std::stoi(args[2]) : 120;
+	const std::string reference = args.size() > 3 ? args[3] : "";
+
+	HeadlessContextSettings settings;
+	settings.Width = width;
+	settings.Height = height;
+	HeadlessContext::sptr context = HeadlessContext::Create(settings);
+	if (context == nullptr) {
+		throw std::runtime_error("Could not create a headless OpenGL context");
+	}
+
+	RenderScene scene;
+	scene.Target = context->GetFramebuffer();
+	scene.GridSize = 32;
+	scene.Program = Shader::Create();
+	scene.Program->LoadShaderPart(VERTEX_SHADER, GL_VERTEX_SHADER);
+	scene.Program->LoadShaderPart(FRAGMENT_SHADER, GL_FRAGMENT_SHADER);
+	if (!scene.Program->Link()) {
+		throw std::runtime_error("Failed to link the benchmark shader");
+	}
+	MeshBuilder<VertexPosNormTexCol> mesh;
+	MeshFactory::AddIcoSphere(mesh, glm::vec3(0.0f), 0.4f, 2);
+	scene.Mesh = mesh.Bake();
+	scene.Instances = InstanceBuffer::Create(scene.GridSize * scene.GridSize);
+	glEnable(GL_DEPTH_TEST);
+
+	std::cout << "Renderer: " << context->GetRenderer() << ", " << width << "x" << height << ", "
+		<< scene.GridSize * scene.GridSize << " spheres (" << mesh.GetIndexCount() / 3 << " triangles each)" << std::endl;
+
+	// Warm up, so shader compilation and first-use allocations aren't counted
+	FrameCapture::sptr capture = FrameCapture::Create(3);
+	std::vector<CapturedFrame> captured;
+	RunFrames(scene, 4, CaptureMode::None, *capture, captured);
+	RunFrames(scene, 4, CaptureMode::Async, *capture, captured);
+	RunFrames(scene, 4, CaptureMode::Sync, *capture, captured);
+	captured.clear();
+
+	const double noneMs = RunFrames(scene, frames, CaptureMode::None, *capture, captured);
+	const double asyncMs = RunFrames(scene, frames, CaptureMode::Async, *capture, captured);
+	if ((int)captured.size() != frames) {
+		throw std::runtime_error("Async capture lost frames");
+	}
+	std::vector<CapturedFrame> asyncFrames = std::move(captured);
+	captured.clear();
+	const double syncMs = RunFrames(scene, frames, CaptureMode::Sync, *capture, captured);
+
+	// Both ways of reading back should give exactly the same pixels, in the same order
+	for (int ix = 0; ix < frames; ix++) {
+		if (asyncFrames[ix].Frame != (uint64_t)ix || captured[ix].Frame != (uint64_t)ix) {
+			throw std::runtime_error("Captured frames were returned out of order");
+		}
+		if (FrameCapture::Compare(asyncFrames[ix], captured[ix]).DifferentPixels != 0) {
+			throw std::runtime_error("Async and sync captures of frame " + std::to_string(ix) + " differ");
+		}
+	}
+
+	std::cout << std::fixed << std::setprecision(3)
+		<< "No capture:    " << std::setw(9) << noneMs << " ms/frame" << std::endl
+		<< "Async capture: " << std::setw(9) << asyncMs << " ms/frame (+" << (asyncMs - noneMs) << " ms)" << std::endl
+		<< "Sync capture:  " << std::setw(9) << syncMs << " ms/frame (+" << (syncMs - noneMs) << " ms)" << std::endl;
+
+	// The first frame works as a golden image for regression tests, software renderers are deterministic so we
+	// allow no difference beyond rounding
+	if (!reference.empty()) {
+		if (std::filesystem::exists(reference)) {
+			const FrameDifference diff = FrameCapture::Compare(asyncFrames[0], FrameCapture::ReadPng(reference), 1);
+			std::cout << std::setprecision(2) << "Reference:     " << diff.DifferentPixels << " pixels differ (max " << diff.MaxDifference
+				<< ", PSNR " << diff.Psnr << " dB)" << std::endl;
+			if (diff.DifferentPixels > 0) {
+				FrameCapture::WritePng(std::filesystem::path(reference).replace_extension(".actual.png").string(), asyncFrames[0]);
+				throw std::runtime_error("Frame does not match the reference image " + reference);
+			}
+		} else {
+			FrameCapture::WritePng(reference, asyncFrames[0]);
+			std::cout << "Wrote reference image to " << reference << std::endl;
+		}
+	}
+}
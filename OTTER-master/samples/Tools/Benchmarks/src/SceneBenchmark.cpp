@@ -0,0 +1,235 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+
+#include <GLM/glm.hpp>
+
+#include <Scene.h>
+#include <SceneAssets.h>
+#include <SceneSerializer.h>
+#include <Transform.h>
+#include <TransformSystem.h>
+#include <GameObjectTag.h>
+#include <RendererComponent.h>
+#include <IBehaviour.h>
+#include <FollowPathBehaviour.h>
+#include <MorphAnimator.h>
+
+static const int SCENE_MESH_COUNT = 4;
+static const int SCENE_MATERIAL_COUNT = 3;
+
+/// <summary>
+/// The assets that every scene in the benchmark uses. The meshes are handles that never finish loading, so we don't
+/// need a GL context, and renderers can be checked by the handle they are waiting on
+/// </summary>
+struct SceneBenchmarkAssets
+{
+	std::vector<AssetHandle<VertexArrayObject>> Meshes;
+	std::vector<ShaderMaterial::sptr>           Materials;
+
+	SceneBenchmarkAssets() {
+		for (int ix = 0; ix < SCENE_MESH_COUNT; ix++) {
+			Meshes.emplace_back(std::make_shared<AssetHandle<VertexArrayObject>::State>());
+		}
+		for (int ix = 0; ix < SCENE_MATERIAL_COUNT; ix++) {
+			Materials.push_back(ShaderMaterial::Create());
+		}
+	}
+
+	void AddTo(const GameScene::sptr& scene) const {
+		for (int ix = 0; ix < SCENE_MESH_COUNT; ix++) {
+			scene->Assets()->AddMesh("mesh" + std::to_string(ix), Meshes[ix]);
+		}
+		for (int ix = 0; ix < SCENE_MATERIAL_COUNT; ix++) {
+			scene->Assets()->AddMaterial("material" + std::to_string(ix), Materials[ix]);
+		}
+	}
+};
+
+/// <summary>
+/// Builds the scene the way a game would, one entity at a time. Every 10th entity starts a small hierarchy that
+/// the next few are parented to, and some entities get behaviours
+/// </summary>
+static GameScene::sptr BuildScene(const SceneBenchmarkAssets& assets, int count) {
+	GameScene::sptr scene = GameScene::Create("benchmark");
+	assets.AddTo(scene);
+	entt::entity root = entt::null;
+	for (int ix = 0; ix < count; ix++) {
+		entt::handle entity = scene->CreateEntity("object" + std::to_string(ix));
+		Transform& transform = entity.get<Transform>();
+		transform.SetLocalPosition(glm::vec3((float)(ix % 100), (float)(ix / 100), (float)(ix % 7)));
+		transform.SetLocalRotation((float)(ix % 360), 0.0f, (float)(ix % 90));
+		transform.SetLocalScale(glm::vec3(1.0f + (ix % 3) * 0.5f));
+		if (ix % 10 == 0) {
+			root = entity.entity();
+		} else if (ix % 10 < 4) {
+			transform.SetParent(entt::handle(scene->Registry(), root));
+		}
+
+		entity.emplace<RendererComponent>()
+			.SetMesh(assets.Meshes[ix % SCENE_MESH_COUNT])
+			.SetMaterial(assets.Materials[ix % SCENE_MATERIAL_COUNT]);
+
+		if (ix % 5 == 0) {
+			const glm::vec3 offset = transform.GetLocalPosition();
+			FollowPathBehaviour* path = ix % 15 == 0 ?
+				BehaviourBinding::BindDisabled<FollowPathBehaviour>(entity) :
+				BehaviourBinding::Bind<FollowPathBehaviour>(entity);
+			path->Points = { offset, offset + glm::vec3(2.0f, 0.0f, 0.0f), offset + glm::vec3(2.0f, 2.0f, 0.0f) };
+			path->Speed = 1.0f + (ix % 7) * 0.25f;
+		}
+		if (ix % 7 == 0) {
+			MorphAnimator* animator = BehaviourBinding::Bind<MorphAnimator>(entity);
+			animator->FrameCount = 2 + ix % 5;
+			animator->Time = (ix % 11) * 0.1f;
+		}
+	}
+	return scene;
+}
+
+/// <summary>
+/// Gets the entities of a scene in the order they were created
+/// </summary>
+static std::vector<entt::entity> GetEntities(entt::registry& registry) {
+	std::vector<entt::entity> result;
+	registry.each([&](entt::entity entity) { result.push_back(entity); });
+	std::sort(result.begin(), result.end(), [](entt::entity a, entt::entity b) {
+		return (entt::to_integral(a) & entt::entt_traits<entt::entity>::entity_mask) < (entt::to_integral(b) & entt::entt_traits<entt::entity>::entity_mask);
+	});
+	return result;
+}
+
+/// <summary>
+/// Checks that a loaded scene matches the one that was saved, entity by entity
+/// </summary>
+static void VerifyScene(GameScene& expected, GameScene& actual, const std::string& format) {
+	entt::registry& from = expected.Registry();
+	entt::registry& to = actual.Registry();
+	const std::vector<entt::entity> fromEntities = GetEntities(from);
+	const std::vector<entt::entity> toEntities = GetEntities(to);
+	if (fromEntities.size() != toEntities.size()) {
+		throw std::runtime_error(format + " scene has " + std::to_string(toEntities.size()) + " entities, expected " + std::to_string(fromEntities.size()));
+	}
+	// Maps an entity in the saved scene to the same entity in the loaded one
+	auto toIndex = [&](entt::entity entity) {
+		return std::lower_bound(fromEntities.begin(), fromEntities.end(), entity, [](entt::entity a, entt::entity b) {
+			return (entt::to_integral(a) & entt::entt_traits<entt::entity>::entity_mask) < (entt::to_integral(b) & entt::entt_traits<entt::entity>::entity_mask);
+		}) - fromEntities.begin();
+	};
+
+	const TransformSystem& fromSystem = *TransformSystem::Get(from);
+	const TransformSystem& toSystem = *TransformSystem::Get(to);
+	for (size_t ix = 0; ix < fromEntities.size(); ix++) {
+		const entt::handle a(from, fromEntities[ix]);
+		const entt::handle b(to, toEntities[ix]);
+		const std::string where = format + " entity " + std::to_string(ix) + ": ";
+
+		if (a.get<GameObjectTag>().Name != b.get<GameObjectTag>().Name || a.get<GameObjectTag>().HashedName != b.get<GameObjectTag>().HashedName) {
+			throw std::runtime_error(where + "names do not match");
+		}
+
+		const Transform& ta = a.get<Transform>();
+		const Transform& tb = b.get<Transform>();
+		if (ta.GetLocalPosition() != tb.GetLocalPosition() || ta.GetLocalRotationQuat() != tb.GetLocalRotationQuat() ||
+			ta.GetLocalRotation() != tb.GetLocalRotation() || ta.GetLocalScale() != tb.GetLocalScale()) {
+			throw std::runtime_error(where + "transforms do not match");
+		}
+		const uint32_t parentA = fromSystem.GetParent(ta.GetSlot());
+		const uint32_t parentB = toSystem.GetParent(tb.GetSlot());
+		if ((parentA == TransformSystem::INVALID) != (parentB == TransformSystem::INVALID) ||
+			(parentA != TransformSystem::INVALID && toEntities[toIndex(fromSystem.GetEntity(parentA))] != toSystem.GetEntity(parentB))) {
+			throw std::runtime_error(where + "parents do not match");
+		}
+
+		const RendererComponent& ra = a.get<RendererComponent>();
+		const RendererComponent& rb = b.get<RendererComponent>();
+		if (ra.PendingMesh.GetState() != rb.PendingMesh.GetState() || ra.Material != rb.Material) {
+			throw std::runtime_error(where + "renderers do not match");
+		}
+
+		const FollowPathBehaviour* pa = a.try_get<FollowPathBehaviour>();
+		const FollowPathBehaviour* pb = b.try_get<FollowPathBehaviour>();
+		if ((pa == nullptr) != (pb == nullptr) ||
+			(pa != nullptr && (pa->Points != pb->Points || pa->Speed != pb->Speed || pa->Enabled != pb->Enabled))) {
+			throw std::runtime_error(where + "paths do not match");
+		}
+		const MorphAnimator* ma = a.try_get<MorphAnimator>();
+		const MorphAnimator* mb = b.try_get<MorphAnimator>();
+		if ((ma == nullptr) != (mb == nullptr) ||
+			(ma != nullptr && (ma->FrameCount != mb->FrameCount || ma->Time != mb->Time || ma->Loop != mb->Loop))) {
+			throw std::runtime_error(where + "animators do not match");
+		}
+		// The animator's OnLoad should have set up the pose from the loaded time
+		if (ma != nullptr && b.get<MorphPose>().ToInstanceParams() != ma->GetPose().ToInstanceParams()) {
+			throw std::runtime_error(where + "morph poses do not match");
+		}
+		const BehaviourBinding* ba = a.try_get<BehaviourBinding>();
+		const BehaviourBinding* bb = b.try_get<BehaviourBinding>();
+		if ((ba == nullptr) != (bb == nullptr) || (ba != nullptr && ba->Types.size() != bb->Types.size())) {
+			throw std::runtime_error(where + "behaviour bindings do not match");
+		}
+	}
+}
+
+void RunSceneBenchmark(const std::vector<std::string>& args)
+{
+	const int count = args.size() > 0 ? std::stoi(args[0]) : 100000;
+	const std::string path = args.size() > 1 ? args[1] : "benchmark.scene";
+
+	SceneSerializer::RegisterBehaviour<FollowPathBehaviour>("FollowPathBehaviour");
+	SceneSerializer::RegisterBehaviour<MorphAnimator>("MorphAnimator");
+	const SceneBenchmarkAssets assets;
+
+	BenchmarkTimer timer;
+	GameScene::sptr scene = BuildScene(assets, count);
+	const double buildMs = timer.ElapsedMs();
+
+	std::cout << std::fixed << std::setprecision(2) << count << " entities" << std::endl;
+	std::cout << std::left << std::setw(14) << "Format" << std::right << std::setw(12) << "Save ms" << std::setw(12) << "Load ms"
+		<< std::setw(14) << "Size KB" << std::endl;
+	std::cout << std::left << std::setw(14) << "Procedural" << std::right << std::setw(12) << "-" << std::setw(12) << buildMs
+		<< std::setw(14) << "-" << std::endl;
+
+	const std::pair<SceneFormat, const char*> formats[] = {
+		{ SceneFormat::Binary, "Binary" },
+		{ SceneFormat::Compressed, "Compressed" },
+		{ SceneFormat::Json, "Json" }
+	};
+	for (const auto& [format, name] : formats) {
+		timer.Reset();
+		scene->Save(path, format);
+		const double saveMs = timer.ElapsedMs();
+		const uintmax_t size = std::filesystem::file_size(path);
+
+		GameScene::sptr loaded = GameScene::Create("loaded");
+		assets.AddTo(loaded);
+		timer.Reset();
+		if (!loaded->Load(path)) {
+			throw std::runtime_error(std::string("Failed to load ") + name + " scene");
+		}
+		const double loadMs = timer.ElapsedMs();
+		VerifyScene(*scene, *loaded, name);
+
+		std::cout << std::left << std::setw(14) << name << std::right << std::setw(12) << saveMs << std::setw(12) << loadMs
+			<< std::setw(14) << size / 1024.0 << std::endl;
+	}
+
+	// A truncated file should fail to load and leave the scene untouched
+	{
+		scene->Save(path, SceneFormat::Binary);
+		const uintmax_t size = std::filesystem::file_size(path);
+		std::filesystem::resize_file(path, size / 2);
+		GameScene::sptr loaded = GameScene::Create("truncated");
+		assets.AddTo(loaded);
+		loaded->CreateEntity("existing");
+		if (loaded->Load(path) || loaded->Registry().alive() != 1 || TransformSystem::Get(loaded->Registry())->GetCount() != 1) {
+			throw std::runtime_error("Truncated scene was not rejected cleanly");
+		}
+	}
+	std::filesystem::remove(path);
+}
@@ -0,0 +1,177 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <stdexcept>
+#include <algorithm>
+
+#include <GLM/glm.hpp>
+#include <GLM/gtc/matrix_transform.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <GLM/gtx/quaternion.hpp>
+
+#include <NOU/PoseEvaluator.h>
+#include <JobSystem.h>
+
+/// <summary>
+/// Builds a random skeleton, where each joint hangs off one of the few joints before it (like the limbs and
+/// fingers of a character rig), and the bind pose is the rest pose
+/// </summary>
+static nou::Skeleton MakeSkeleton(int jointCount, std::mt19937& random) {
+	nou::Skeleton skeleton;
+	std::vector<glm::mat4> global(jointCount);
+	for (int ix = 0; ix < jointCount; ix++) {
+		nou::JointPose pose;
+		pose.pos = glm::vec3(0.0f, 0.25f, 0.05f * (ix % 3));
+		const int parent = ix == 0 ? -1 : ix - 1 - static_cast<int>(random() % std::min(ix, 4));
+		const glm::mat4 local = glm::translate(glm::mat4(1.0f), pose.pos);
+		global[ix] = parent != -1 ? global[parent] * local : local;
+
+		skeleton.names.push_back("joint" + std::to_string(ix));
+		skeleton.parents.push_back(parent);
+		skeleton.inverseBind.push_back(glm::inverse(global[ix]));
+		skeleton.rootTransforms.push_back(glm::mat4(1.0f));
+		skeleton.restPose.push_back(pose);
+	}
+	return skeleton;
+}
+
+/// <summary>
+/// Builds a clip where every joint swings back and forth around a random axis
+/// </summary>
+static nou::AnimationClip MakeClip(const nou::Skeleton& skeleton, float duration, float sampleRate, std::mt19937& random) {
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	nou::AnimationClip clip;
+	clip.m_name = "swing";
+	clip.Allocate(skeleton, static_cast<size_t>(duration * sampleRate) + 1, sampleRate);
+	for (size_t joint = 0; joint < skeleton.JointCount(); joint++) {
+		const glm::vec3 axis = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.0f, 2.0f));
+		const float phase = unit(random) * glm::pi<float>();
+		for (size_t frame = 0; frame < clip.GetFrameCount(); frame++) {
+			nou::JointPose pose = skeleton.restPose[joint];
+			const float time = frame / sampleRate;
+			pose.rotation = glm::angleAxis(0.8f * glm::sin(time * glm::two_pi<float>() / duration + phase), axis);
+			clip.SetJointPose(frame, joint, pose);
+		}
+	}
+	return clip;
+}
+
+/// <summary>
+/// Computes a palette the straightforward way, with a real slerp and glm matrices, to check the evaluator against
+/// </summary>
+static void ReferencePalette(const nou::Skeleton& skeleton, const nou::AnimationClip& clip, float time, std::vector<glm::mat4>& palette) {
+	time = std::fmod(time, clip.GetDuration());
+	const float frame = time * clip.GetSampleRate();
+	const size_t f0 = std::min(static_cast<size_t>(frame), clip.GetFrameCount() - 1);
+	const size_t f1 = std::min(f0 + 1, clip.GetFrameCount() - 1);
+	const float t = frame - f0;
+
+	std::vector<glm::mat4> global(skeleton.JointCount());
+	palette.resize(skeleton.JointCount());
+	for (size_t joint = 0; joint < skeleton.JointCount(); joint++) {
+		const nou::JointPose a = clip.GetJointPose(f0, joint);
+		const nou::JointPose b = clip.GetJointPose(f1, joint);
+		const glm::mat4 local =
+			glm::translate(glm::mat4(1.0f), glm::mix(a.pos, b.pos, t)) *
+			glm::toMat4(glm::slerp(a.rotation, b.rotation, t)) *
+			glm::scale(glm::mat4(1.0f), glm::mix(a.scale, b.scale, t));
+		const int parent = skeleton.parents[joint];
+		global[joint] = parent != -1 ? global[parent] * local : skeleton.rootTransforms[joint] * local;
+		palette[joint] = global[joint] * skeleton.inverseBind[joint];
+	}
+}
+
+void RunSkinningBenchmark(const std::vector<std::string>& args)
+{
+	int characters = args.size() > 0 ? std::stoi(args[0]) : 2000;
+	int joints = args.size() > 1 ? std::stoi(args[1]) : 64;
+	int frames = args.size() > 2 ? std::stoi(args[2]) : 100;
+
+	std::mt19937 random(1234);
+	const nou::Skeleton skeleton = MakeSkeleton(joints, random);
+	const nou::AnimationClip clip = MakeClip(skeleton, 2.0f, 30.0f, random);
+
+	// Every character is at a different point in the animation
+	std::uniform_real_distribution<float> start(0.0f, clip.GetDuration());
+	nou::PoseEvaluator poses(skeleton);
+	for (int ix = 0; ix < characters; ix++) {
+		poses.AddCharacter(&clip, start(random));
+	}
+
+	std::cout << characters << " characters, " << joints << " joints, " << frames << " frames" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	// Single threaded
+	{
+		BenchmarkTimer timer;
+		for (int frame = 0; frame < frames; frame++) {
+			poses.Advance(1.0f / 60.0f);
+			poses.Evaluate();
+		}
+		const double ms = timer.ElapsedMs() / frames;
+		std::cout << "Evaluate (1 thread):  " << std::setw(10) << ms << " ms/frame (" << (characters / ms) << " characters/ms)" << std::endl;
+	}
+
+	// Spread across the engine's job system
+	{
+		const nou::PoseEvaluator::ParallelFor parallelFor = [](size_t count, size_t minChunkSize, const std::function<void(size_t, size_t)>& func) {
+			JobSystem::ParallelFor(count, minChunkSize, func);
+		};
+		BenchmarkTimer timer;
+		for (int frame = 0; frame < frames; frame++) {
+			poses.Advance(1.0f / 60.0f);
+			poses.Evaluate(parallelFor);
+		}
+		const double ms = timer.ElapsedMs() / frames;
+		std::cout << "Evaluate (" << std::setw(2) << JobSystem::GetWorkerCount() + 1 << " threads): " << std::setw(9) << ms << " ms/frame ("
+			<< (characters / ms) << " characters/ms)" << std::endl;
+	}
+
+	// Make sure the SIMD sampling still matches a real slerp
+	float maxError = 0.0f;
+	std::vector<glm::mat4> reference;
+	for (int ix = 0; ix < std::min(characters, 100); ix++) {
+		ReferencePalette(skeleton, clip, poses.GetTime(ix), reference);
+		const glm::mat4* palette = poses.GetPalette(ix);
+		for (int joint = 0; joint < joints; joint++) {
+			for (int col = 0; col < 4; col++) {
+				const glm::vec4 diff = glm::abs(palette[joint][col] - reference[joint][col]);
+				maxError = std::max(maxError, std::max(std::max(diff.x, diff.y), std::max(diff.z, diff.w)));
+			}
+		}
+	}
+	std::cout << "Max palette error vs slerp: " << std::scientific << std::setprecision(2) << maxError << std::fixed << std::setprecision(3) << std::endl;
+	if (maxError > 1e-2f) {
+		throw std::runtime_error("Evaluated palettes do not match the reference");
+	}
+
+	// CPU skinning fallback, on a mesh with every vertex influenced by 4 joints
+	{
+		const int vertexCount = 5000;
+		std::vector<glm::vec3> verts(vertexCount), normals(vertexCount, glm::vec3(0.0f, 0.0f, 1.0f));
+		std::vector<glm::vec4> influences(vertexCount), weights(vertexCount);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		for (int ix = 0; ix < vertexCount; ix++) {
+			verts[ix] = glm::vec3(unit(random), unit(random) * joints * 0.25f, unit(random));
+			influences[ix] = glm::vec4(random() % joints, random() % joints, random() % joints, random() % joints);
+			weights[ix] = glm::vec4(unit(random), unit(random), unit(random), unit(random));
+			weights[ix] /= weights[ix].x + weights[ix].y + weights[ix].z + weights[ix].w;
+		}
+		nou::Mesh mesh;
+		mesh.SetVerts(verts);
+		mesh.SetNormals(normals);
+		mesh.SetJoints(influences);
+		mesh.SetWeights(weights);
+
+		const int skinned = std::min(characters, 100);
+		std::vector<glm::vec3> vertsOut, normalsOut;
+		BenchmarkTimer timer;
+		for (int ix = 0; ix < skinned; ix++) {
+			nou::SkinVertices(mesh, poses.GetPalette(ix), vertsOut, normalsOut);
+		}
+		const double ms = timer.ElapsedMs() / skinned;
+		std::cout << "CPU skinning:         " << std::setw(10) << ms << " ms/character (" << vertexCount << " vertices)" << std::endl;
+	}
+}
@@ -0,0 +1,327 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+#include <random>
+#include <cmath>
+
+#include <JobSystem.h>
+#include <TextureBaker.h>
+#include <BlockCompressor.h>
+#include <BakedTexture.h>
+#include <BakedMesh.h>
+
+/// <summary>
+/// Builds a test image with smooth gradients, hard edged shapes and a little noise, which covers the cases that block
+/// compression struggles with. Alpha is a radial falloff
+/// </summary>
+static TextureImage MakeImage(uint32_t size) {
+	std::mt19937 random(1234);
+	std::uniform_int_distribution<int> noise(-6, 6);
+	TextureImage image;
+	image.Width = image.Height = size;
+	image.Channels = 4;
+	image.Pixels.resize(size * (size_t)size * 4);
+	for (uint32_t y = 0; y < size; y++) {
+		for (uint32_t x = 0; x < size; x++) {
+			const float u = x / (float)size, v = y / (float)size;
+			float r = u, g = v, b = 0.5f + 0.5f * std::sin(u * 20.0f) * std::cos(v * 14.0f);
+			// A grid of circles with solid colors and sharp edges
+			const float cu = std::fmod(u * 8.0f, 1.0f) - 0.5f, cv = std::fmod(v * 8.0f, 1.0f) - 0.5f;
+			if (cu * cu + cv * cv < 0.09f) {
+				r = ((x / (size / 8)) % 2) ? 1.0f : 0.1f;
+				g = 0.2f;
+				b = ((y / (size / 8)) % 2) ? 0.9f : 0.3f;
+			}
+			const float du = u - 0.5f, dv = v - 0.5f;
+			uint8_t* texel = &image.Pixels[(y * (size_t)size + x) * 4];
+			texel[0] = static_cast<uint8_t>(std::clamp(r * 255.0f + noise(random), 0.0f, 255.0f));
+			texel[1] = static_cast<uint8_t>(std::clamp(g * 255.0f + noise(random), 0.0f, 255.0f));
+			texel[2] = static_cast<uint8_t>(std::clamp(b * 255.0f + noise(random), 0.0f, 255.0f));
+			texel[3] = static_cast<uint8_t>(std::clamp(255.0f * (1.4f - 2.0f * std::sqrt(du * du + dv * dv)), 0.0f, 255.0f));
+		}
+	}
+	return image;
+}
+
+// Reference decoders for the formats we encode, so we can measure the quality of the encoders without a GPU
+
+static void DecodeColors565(uint16_t c0, uint16_t c1, bool allowTransparent, uint8_t palette[4][4]) {
+	const auto expand = [](uint16_t c, uint8_t* out) {
+		out[0] = static_cast<uint8_t>(((c >> 11) & 31) * 255 / 31);
+		out[1] = static_cast<uint8_t>(((c >> 5) & 63) * 255 / 63);
+		out[2] = static_cast<uint8_t>((c & 31) * 255 / 31);
+		out[3] = 255;
+	};
+	expand(c0, palette[0]);
+	expand(c1, palette[1]);
+	for (int ix = 0; ix < 4; ix++) {
+		if (c0 > c1 || !allowTransparent) {
+			palette[2][ix] = static_cast<uint8_t>((2 * palette[0][ix] + palette[1][ix]) / 3);
+			palette[3][ix] = static_cast<uint8_t>((palette[0][ix] + 2 * palette[1][ix]) / 3);
+		} else {
+			palette[2][ix] = static_cast<uint8_t>((palette[0][ix] + palette[1][ix]) / 2);
+			palette[3][ix] = 0;
+		}
+	}
+}
+
+static void DecodeBC1(const uint8_t* block, bool allowTransparent, uint8_t* rgba) {
+	uint8_t palette[4][4];
+	DecodeColors565(static_cast<uint16_t>(block[0] | block[1] << 8), static_cast<uint16_t>(block[2] | block[3] << 8), allowTransparent, palette);
+	for (int ix = 0; ix < 16; ix++) {
+		const int index = (block[4 + ix / 4] >> ((ix % 4) * 2)) & 3;
+		std::copy(palette[index], palette[index] + 3, rgba + ix * 4);
+	}
+}
+
+static void DecodeBC4(const uint8_t* block, uint8_t* values, size_t stride) {
+	const int a0 = block[0], a1 = block[1];
+	uint8_t palette[8] = { static_cast<uint8_t>(a0), static_cast<uint8_t>(a1) };
+	for (int ix = 2; ix < 8; ix++) {
+		if (a0 > a1) {
+			palette[ix] = static_cast<uint8_t>(((8 - ix) * a0 + (ix - 1) * a1) / 7);
+		} else {
+			palette[ix] = ix < 6 ? static_cast<uint8_t>(((6 - ix) * a0 + (ix - 1) * a1) / 5) : (ix == 6 ? 0 : 255);
+		}
+	}
+	uint64_t bits = 0;
+	for (int ix = 0; ix < 6; ix++) {
+		bits |= static_cast<uint64_t>(block[2 + ix]) << (ix * 8);
+	}
+	for (int ix = 0; ix < 16; ix++) {
+		values[ix * stride] = palette[(bits >> (ix * 3)) & 7];
+	}
+}
+
+static void DecodeBC7Mode6(const uint8_t* block, uint8_t* rgba) {
+	size_t position = 0;
+	const auto read = [&](int count) {
+		uint32_t value = 0;
+		for (int ix = 0; ix < count; ix++, position++) {
+			value |= ((block[position / 8] >> (position % 8)) & 1u) << ix;
+		}
+		return value;
+	};
+	if (read(7) != 1u << 6) {
+		throw std::runtime_error("BC7 block is not mode 6");
+	}
+	uint32_t endpoints[2][4];
+	for (int channel = 0; channel < 4; channel++) {
+		endpoints[0][channel] = read(7);
+		endpoints[1][channel] = read(7);
+	}
+	const uint32_t p0 = read(1), p1 = read(1);
+	static const uint32_t weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+	for (int ix = 0; ix < 16; ix++) {
+		const uint32_t weight = weights[read(ix == 0 ? 3 : 4)];
+		for (int channel = 0; channel < 4; channel++) {
+			const uint32_t e0 = endpoints[0][channel] << 1 | p0, e1 = endpoints[1][channel] << 1 | p1;
+			rgba[ix * 4 + channel] = static_cast<uint8_t>(((64 - weight) * e0 + weight * e1 + 32) >> 6);
+		}
+	}
+}
+
+/// <summary>
+/// Decodes a compressed image back to texels with the given number of channels
+/// </summary>
+static std::vector<uint8_t> Decode(const std::vector<uint8_t>& blocks, uint32_t width, uint32_t height, uint32_t channels, InternalFormat format) {
+	std::vector<uint8_t> result(width * (size_t)height * channels);
+	const size_t blockSize = GetBlockSize(format);
+	for (uint32_t by = 0; by < height / 4; by++) {
+		for (uint32_t bx = 0; bx < width / 4; bx++) {
+			const uint8_t* block = &blocks[(by * (width / 4) + bx) * blockSize];
+			uint8_t texels[64] = { };
+			switch (format) {
+				case InternalFormat::BC1: DecodeBC1(block, true, texels); break;
+				case InternalFormat::BC3: DecodeBC4(block, texels + 3, 4); DecodeBC1(block + 8, false, texels); break;
+				case InternalFormat::BC4: DecodeBC4(block, texels, 4); break;
+				case InternalFormat::BC5: DecodeBC4(block, texels, 4); DecodeBC4(block + 8, texels + 1, 4); break;
+				case InternalFormat::BC7: DecodeBC7Mode6(block, texels); break;
+				default: throw std::runtime_error("No decoder for format");
+			}
+			for (int ix = 0; ix < 16; ix++) {
+				const size_t texel = ((by * 4 + ix / 4) * (size_t)width + bx * 4 + ix % 4) * channels;
+				std::copy(texels + ix * 4, texels + ix * 4 + channels, &result[texel]);
+			}
+		}
+	}
+	return result;
+}
+
+/// <summary>
+/// Gets the peak signal to noise ratio between two images over the first few channels of each texel, in dB
+/// </summary>
+static double Psnr(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, uint32_t channels, uint32_t compared) {
+	double error = 0.0;
+	size_t count = 0;
+	for (size_t ix = 0; ix < a.size(); ix += channels) {
+		for (uint32_t channel = 0; channel < compared; channel++, count++) {
+			const double delta = static_cast<double>(a[ix + channel]) - b[ix + channel];
+			error += delta * delta;
+		}
+	}
+	return error == 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / (error / count));
+}
+
+static void ReportCompression(const std::string& name, const TextureImage& image, InternalFormat format, uint32_t compared) {
+	std::vector<uint8_t> blocks(GetLevelSize(format, image.Width, image.Height));
+	BenchmarkTimer timer;
+	{
+		JobSystem::SerialScope serial;
+		BlockCompressor::Compress(image.Pixels.data(), image.Width, image.Height, image.Channels, format, blocks.data());
+	}
+	const double singleMs = timer.ElapsedMs();
+	timer.Reset();
+	BlockCompressor::Compress(image.Pixels.data(), image.Width, image.Height, image.Channels, format, blocks.data());
+	const double jobsMs = timer.ElapsedMs();
+
+	const double psnr = Psnr(image.Pixels, Decode(blocks, image.Width, image.Height, image.Channels, format), image.Channels, compared);
+	const double mtexels = image.Width * (double)image.Height / 1.0e6;
+	std::cout << std::left << std::setw(8) << name << std::right
+		<< std::setw(12) << singleMs
+		<< std::setw(12) << jobsMs
+		<< std::setw(14) << mtexels / (jobsMs / 1000.0)
+		<< std::setw(10) << psnr << std::endl;
+}
+
+/// <summary>
+/// Box filters a black and white checkerboard down to a single texel. Averaging in linear space should give 50% grey
+/// (188 in sRGB), where averaging the sRGB values directly gives a darker 128
+/// </summary>
+static void CheckGammaCorrectFiltering() {
+	TextureImage checker;
+	checker.Width = checker.Height = 4;
+	checker.Channels = 4;
+	checker.Pixels.resize(4 * 4 * 4);
+	for (size_t ix = 0; ix < 16; ix++) {
+		const uint8_t value = ((ix % 4) + (ix / 4)) % 2 ? 255 : 0;
+		std::fill(&checker.Pixels[ix * 4], &checker.Pixels[ix * 4] + 3, value);
+		checker.Pixels[ix * 4 + 3] = 255;
+	}
+	const uint8_t srgb = TextureBaker::GenerateMips(checker, MipFilter::Box, TextureColorSpace::SRGB, true).back().Pixels[0];
+	const uint8_t linear = TextureBaker::GenerateMips(checker, MipFilter::Box, TextureColorSpace::Linear, true).back().Pixels[0];
+	std::cout << "Checkerboard filtered to 1x1: " << (int)srgb << " in sRGB (expect 188), " << (int)linear << " as linear data" << std::endl;
+	if (std::abs(srgb - 188) > 1) {
+		throw std::runtime_error("Mips of sRGB textures are not filtered in linear space");
+	}
+}
+
+void RunTextureBenchmark(const std::vector<std::string>& args)
+{
+	std::string imageDir = args.size() > 0 ? args[0] : "../../../projects/Assignment 1/res/images";
+	uint32_t size = args.size() > 1 ? static_cast<uint32_t>(std::stoul(args[1])) : 1024;
+	int iterations = args.size() > 2 ? std::stoi(args[2]) : 10;
+
+	CheckGammaCorrectFiltering();
+
+	const TextureImage image = MakeImage(size);
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "Mip generation for a " << size << "x" << size << " RGBA image (" << JobSystem::GetWorkerCount() << " workers)" << std::endl;
+	std::cout << std::left << std::setw(8) << "Filter" << std::right << std::setw(12) << "1 thread ms" << std::setw(12) << "Jobs ms" << std::endl;
+	for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser }) {
+		BenchmarkTimer timer;
+		size_t levels = 0;
+		{
+			JobSystem::SerialScope serial;
+			levels = TextureBaker::GenerateMips(image, filter, TextureColorSpace::SRGB, true).size();
+		}
+		const double singleMs = timer.ElapsedMs();
+		timer.Reset();
+		TextureBaker::GenerateMips(image, filter, TextureColorSpace::SRGB, true);
+		const double jobsMs = timer.ElapsedMs();
+		if (levels != GetMipLevelCount(size, size)) {
+			throw std::runtime_error("Generated the wrong number of mip levels");
+		}
+		std::cout << std::left << std::setw(8) << (filter == MipFilter::Box ? "Box" : "Kaiser") << std::right
+			<< std::setw(12) << singleMs << std::setw(12) << jobsMs << std::endl;
+	}
+
+	std::cout << "Block compression of the top level" << std::endl;
+	std::cout << std::left << std::setw(8) << "Format" << std::right << std::setw(12) << "1 thread ms" << std::setw(12) << "Jobs ms"
+		<< std::setw(14) << "Mtexels/s" << std::setw(10) << "PSNR dB" << std::endl;
+	ReportCompression("BC1", image, InternalFormat::BC1, 3);
+	ReportCompression("BC3", image, InternalFormat::BC3, 4);
+	ReportCompression("BC7", image, InternalFormat::BC7, 4);
+	TextureImage rg;
+	rg.Width = image.Width;
+	rg.Height = image.Height;
+	rg.Channels = 2;
+	rg.Pixels.resize(image.Width * (size_t)image.Height * 2);
+	for (size_t ix = 0; ix < rg.Pixels.size() / 2; ix++) {
+		rg.Pixels[ix * 2] = image.Pixels[ix * 4];
+		rg.Pixels[ix * 2 + 1] = image.Pixels[ix * 4 + 1];
+	}
+	ReportCompression("BC5", rg, InternalFormat::BC5, 2);
+
+	if (!std::filesystem::is_directory(imageDir)) {
+		return;
+	}
+	std::vector<std::filesystem::path> files;
+	for (const auto& entry : std::filesystem::directory_iterator(imageDir)) {
+		const std::string extension = entry.path().extension().string();
+		if (extension == ".png" || extension == ".jpg" || extension == ".bmp") {
+			files.push_back(entry.path());
+		}
+	}
+	std::sort(files.begin(), files.end());
+
+	// We bake into the temp directory so we don't leave files in the source tree
+	const std::filesystem::path bakeDir = std::filesystem::temp_directory_path() / "otter_bench";
+	std::filesystem::create_directories(bakeDir);
+
+	std::cout << "Loading images (CPU side only)" << std::endl;
+	std::cout << std::left << std::setw(24) << "File" << std::right
+		<< std::setw(12) << "Decode ms"
+		<< std::setw(12) << "Cached ms"
+		<< std::setw(10) << "Speedup"
+		<< std::setw(12) << "RGBA8 KB"
+		<< std::setw(12) << "Baked KB" << std::endl;
+
+	const TextureBakeSettings settings;
+	for (const std::filesystem::path& path : files) {
+		const std::string bakedPath = (bakeDir / path.filename()).replace_extension(".dds").string();
+		Texture2DData::sptr decoded = Texture2DData::LoadFromFile(path.string());
+		if (decoded == nullptr) {
+			continue;
+		}
+		const TextureBakeResult baked = TextureBaker::Bake(TextureBaker::FromData(*decoded), settings, path.string());
+		{
+			MemoryMappedFile source(path.string());
+			BakedTexture::Write(bakedPath, baked, BakedMesh::Hash(source.GetData(), source.GetSize()), BakedTexture::HashBakeSettings(settings));
+		}
+
+		BenchmarkTimer timer;
+		for (int ix = 0; ix < iterations; ix++) {
+			Texture2DData::LoadFromFile(path.string());
+		}
+		const double decodeMs = timer.ElapsedMs() / iterations;
+
+		// This mirrors what BakedTexture::LoadCached does on a cache hit: hash the source to validate the cache, then
+		// hand out data that points into the mapping
+		uint64_t checksum = 0;
+		timer.Reset();
+		for (int ix = 0; ix < iterations; ix++) {
+			MemoryMappedFile source(path.string());
+			BakedTexture::sptr cached = BakedTexture::Open(bakedPath);
+			if (cached == nullptr || cached->GetSourceHash() != BakedMesh::Hash(source.GetData(), source.GetSize())) {
+				throw std::runtime_error("Baked texture did not validate for " + path.string());
+			}
+			Texture2DData::sptr data = cached->GetData();
+			checksum += BakedMesh::Hash(data->GetLevelDataPtr(0), data->GetLevel(0).Size);
+		}
+		const double cachedMs = timer.ElapsedMs() / iterations;
+
+		std::cout << std::left << std::setw(24) << path.filename().string() << std::right << std::setprecision(3)
+			<< std::setw(12) << decodeMs
+			<< std::setw(12) << cachedMs
+			<< std::setprecision(1) << std::setw(9) << decodeMs / cachedMs << "x"
+			<< std::setw(12) << decoded->GetWidth() * (double)decoded->GetHeight() * 4.0 * 4.0 / 3.0 / 1024.0
+			<< std::setw(12) << baked.Data.size() / 1024.0 << std::endl;
+		(void)checksum;
+	}
+	std::filesystem::remove_all(bakeDir);
+}
@@ -0,0 +1,173 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <stdexcept>
+#include <algorithm>
+
+#include <GLM/glm.hpp>
+#include <GLM/gtc/matrix_transform.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <GLM/gtx/quaternion.hpp>
+
+#include <TransformSystem.h>
+
+// The deepest hierarchy level that we generate
+static const int MAX_DEPTH = 7;
+
+/// <summary>
+/// Mirrors the data and update of the old Transform component, which stored everything in one object and was
+/// updated one entity at a time, in hierarchy order
+/// </summary>
+struct LegacyTransform
+{
+	mutable bool      IsLocalDirty = true;
+	mutable glm::mat4 Local = glm::mat4(1.0f);
+	mutable glm::mat3 Normal = glm::mat3(1.0f);
+	mutable glm::mat4 World = glm::mat4(1.0f);
+	mutable glm::mat3 WorldNormal = glm::mat3(1.0f);
+	glm::quat Rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	glm::vec3 Position = glm::vec3(0.0f);
+	glm::vec3 Scale = glm::vec3(1.0f);
+	int       Parent = -1;
+	int       Depth = 0;
+
+	virtual ~LegacyTransform() = default;
+
+	void Update(const std::vector<LegacyTransform>& all) const {
+		if (IsLocalDirty) {
+			Local = glm::translate(glm::mat4(1.0f), Position) * glm::toMat4(Rotation) * glm::scale(glm::mat4(1.0f), Scale);
+			Normal = glm::mat3(glm::transpose(glm::inverse(Local)));
+			IsLocalDirty = false;
+		}
+		if (Parent != -1) {
+			World = all[Parent].World * Local;
+			WorldNormal = glm::mat3(glm::transpose(glm::inverse(World)));
+		} else {
+			World = Local;
+			WorldNormal = Normal;
+		}
+	}
+};
+
+void RunTransformBenchmark(const std::vector<std::string>& args)
+{
+	int count = args.size() > 0 ? std::stoi(args[0]) : 100000;
+	int frames = args.size() > 1 ? std::stoi(args[1]) : 100;
+
+	// Build a random forest, parents always come before their children so depths are known as we go. Roughly 1 in
+	// 10 transforms are roots, and parents are picked from the last few transforms so that we get lots of small
+	// objects rather than a few giant trees. About a third of the transforms are non-uniformly scaled
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<LegacyTransform> legacy(count);
+	TransformSystem system;
+	std::vector<uint32_t> slots(count);
+	for (int ix = 0; ix < count; ix++) {
+		LegacyTransform& t = legacy[ix];
+		t.Position = glm::vec3(unit(random), unit(random), unit(random)) * 10.0f;
+		t.Rotation = glm::normalize(glm::quat(unit(random), unit(random), unit(random), unit(random)));
+		const float scale = 1.0f + unit(random) * 0.5f;
+		t.Scale = (random() % 3 == 0) ? glm::vec3(scale, 1.0f, 2.0f - scale) : glm::vec3(scale);
+		if (ix > 0 && random() % 10 != 0) {
+			int parent = ix - 1 - static_cast<int>(random() % std::min(ix, 16));
+			while (legacy[parent].Depth >= MAX_DEPTH) {
+				parent = legacy[parent].Parent;
+			}
+			t.Parent = parent;
+			t.Depth = legacy[parent].Depth + 1;
+		}
+
+		slots[ix] = system.Allocate();
+		system.SetPosition(slots[ix], t.Position);
+		system.SetRotation(slots[ix], t.Rotation, glm::degrees(glm::eulerAngles(t.Rotation)));
+		system.SetScale(slots[ix], t.Scale);
+		if (t.Parent != -1) {
+			system.SetParent(slots[ix], slots[t.Parent]);
+		}
+	}
+
+	// The old update relied on the registry being sorted by depth
+	std::vector<int> legacyOrder(count);
+	for (int ix = 0; ix < count; ix++) {
+		legacyOrder[ix] = ix;
+	}
+	std::stable_sort(legacyOrder.begin(), legacyOrder.end(), [&](int l, int r) { return legacy[l].Depth < legacy[r].Depth; });
+
+	// Make sure both versions agree before timing anything
+	for (int ix : legacyOrder) {
+		legacy[ix].Update(legacy);
+	}
+	system.Update();
+	float maxError = 0.0f;
+	for (int ix = 0; ix < count; ix++) {
+		const glm::mat4& expected = legacy[ix].World;
+		const glm::mat4& actual = system.GetWorldMatrix(slots[ix]);
+		const glm::mat3& expectedNormal = legacy[ix].WorldNormal;
+		const glm::mat3& actualNormal = system.GetWorldNormalMatrix(slots[ix]);
+		for (int col = 0; col < 3; col++) {
+			for (int row = 0; row < 3; row++) {
+				maxError = std::max(maxError, std::abs(expected[col][row] - actual[col][row]) / (1.0f + std::abs(expected[col][row])));
+				maxError = std::max(maxError, std::abs(expectedNormal[col][row] - actualNormal[col][row]) / (1.0f + std::abs(expectedNormal[col][row])));
+			}
+		}
+	}
+	if (maxError > 1.0e-3f) {
+		throw std::runtime_error("Transform system results do not match the legacy update (error " + std::to_string(maxError) + ")");
+	}
+
+	// The old update recalculated every world matrix every frame, whether anything moved or not
+	BenchmarkTimer timer;
+	for (int frame = 0; frame < frames; frame++) {
+		for (int ix : legacyOrder) {
+			legacy[ix].Update(legacy);
+		}
+	}
+	const double legacyMs = timer.ElapsedMs() / frames;
+
+	// Worst case, every root moves every frame so the whole scene needs updating
+	std::vector<uint32_t> roots;
+	for (int ix = 0; ix < count; ix++) {
+		if (legacy[ix].Parent == -1) {
+			roots.push_back(slots[ix]);
+		}
+	}
+	auto moveRoots = [&](size_t stride) {
+		for (size_t ix = 0; ix < roots.size(); ix += stride) {
+			system.SetPosition(roots[ix], system.GetPosition(roots[ix]) + glm::vec3(0.001f));
+		}
+	};
+
+	timer.Reset();
+	for (int frame = 0; frame < frames; frame++) {
+		moveRoots(1);
+		system.Update(false);
+	}
+	const double serialMs = timer.ElapsedMs() / frames;
+	const size_t allCount = system.GetLastUpdateCount();
+
+	timer.Reset();
+	for (int frame = 0; frame < frames; frame++) {
+		moveRoots(1);
+		system.Update(true);
+	}
+	const double parallelMs = timer.ElapsedMs() / frames;
+
+	// A more typical frame, where only a few objects move and the rest of the scene is static
+	timer.Reset();
+	for (int frame = 0; frame < frames; frame++) {
+		moveRoots(100);
+		system.Update(true);
+	}
+	const double sparseMs = timer.ElapsedMs() / frames;
+	const size_t sparseCount = system.GetLastUpdateCount();
+
+	std::cout << count << " transforms over " << system.GetLevelCount() << " levels, " << frames << " frames" << std::endl;
+	std::cout << std::fixed << std::setprecision(3)
+		<< "Legacy (per entity):          " << std::setw(9) << legacyMs << " ms/frame" << std::endl
+		<< "SoA, all moving, 1 thread:    " << std::setw(9) << serialMs << " ms/frame (" << allCount << " updated)" << std::endl
+		<< "SoA, all moving, parallel:    " << std::setw(9) << parallelMs << " ms/frame" << std::endl
+		<< "SoA, 1% of roots moving:      " << std::setw(9) << sparseMs << " ms/frame (" << sparseCount << " updated)" << std::endl
+		<< "Speedup (all moving):         " << (legacyMs / parallelMs) << "x" << std::endl;
+}
@@ -0,0 +1,71 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <UniformId.h>
+
+// The names that get looked up on every draw or shader switch in the old render loop
+static constexpr UniformId U_MODEL_VIEW_PROJECTION("u_ModelViewProjection");
+static constexpr UniformId U_MODEL("u_Model");
+static constexpr UniformId U_NORMAL_MATRIX("u_NormalMatrix");
+static constexpr UniformId U_VIEW("u_View");
+static constexpr UniformId U_VIEW_PROJECTION("u_ViewProjection");
+
+void RunUniformLookupBenchmark(const std::vector<std::string>& args)
+{
+	int iterations = args.size() > 0 ? std::stoi(args[0]) : 10000000;
+
+	// This mirrors the two lookup tables in Shader, with the set of uniforms from the Assignment 1 shader. We don't
+	// need an OpenGL context here, since the locations are resolved once up front either way
+	const char* names[] = {
+		"u_ModelViewProjection", "u_Model", "u_NormalMatrix", "u_View", "u_ViewProjection", "u_LightPos", "u_LightCol",
+		"u_AmbientCol", "u_AmbientStrength", "u_AmbientLightStrength", "u_SpecularLightStrength", "u_Shininess",
+		"u_LightAttenuationConstant", "u_LightAttenuationLinear", "u_LightAttenuationQuadratic", "u_Condition",
+		"s_Diffuse", "s_Diffuse2"
+	};
+	std::unordered_map<std::string, int> byName;
+	std::unordered_map<uint64_t, int, UniformIdHasher> byId;
+	int location = 0;
+	for (const char* name : names) {
+		byName[name] = location;
+		byId[UniformId::HashName(name, strlen(name))] = location;
+		location++;
+	}
+
+	// Each iteration does the lookups of one non-instanced draw plus the old per-shader camera uniforms
+	int checksum = 0;
+	BenchmarkTimer timer;
+	for (int ix = 0; ix < iterations; ix++) {
+		// Shader::SetUniform(const std::string&, ...) builds a std::string from the literal on every call
+		checksum += byName.find("u_ModelViewProjection")->second;
+		checksum += byName.find("u_Model")->second;
+		checksum += byName.find("u_NormalMatrix")->second;
+		checksum += byName.find("u_View")->second;
+		checksum += byName.find("u_ViewProjection")->second;
+	}
+	const double nameMs = timer.ElapsedMs();
+
+	timer.Reset();
+	for (int ix = 0; ix < iterations; ix++) {
+		checksum -= byId.find(U_MODEL_VIEW_PROJECTION.Hash)->second;
+		checksum -= byId.find(U_MODEL.Hash)->second;
+		checksum -= byId.find(U_NORMAL_MATRIX.Hash)->second;
+		checksum -= byId.find(U_VIEW.Hash)->second;
+		checksum -= byId.find(U_VIEW_PROJECTION.Hash)->second;
+	}
+	const double idMs = timer.ElapsedMs();
+
+	if (checksum != 0) {
+		throw std::runtime_error("Name and ID lookups returned different locations");
+	}
+
+	const double lookups = iterations * 5.0;
+	std::cout << std::fixed << std::setprecision(2)
+		<< "By name: " << std::setw(10) << nameMs << " ms (" << (nameMs * 1000000.0 / lookups) << " ns/lookup)" << std::endl
+		<< "By ID:   " << std::setw(10) << idMs << " ms (" << (idMs * 1000000.0 / lookups) << " ns/lookup)" << std::endl
+		<< "Speedup: " << (nameMs / idMs) << "x" << std::endl;
+}
@@ -0,0 +1,137 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <algorithm>
+
+#include <ObjLoader.h>
+#include <MeshFactory.h>
+
+typedef MeshBuilder<VertexPosNormTexCol> Builder;
+
+/// <summary>
+/// The largest difference between the original mesh and it's converted version, for each attribute
+/// </summary>
+struct ConversionError
+{
+	float Position = 0.0f;
+	float Normal = 0.0f;
+	float UV = 0.0f;
+	float Color = 0.0f;
+};
+
+inline const char* FormatName(VertexFormat format) {
+	switch (format) {
+		case VertexFormat::Compact:   return "Compact";
+		case VertexFormat::Quantized: return "Quantized";
+		default:                      return "Float";
+	}
+}
+
+inline float MaxDiff(const glm::vec4& a, const glm::vec4& b) {
+	const glm::vec4 diff = glm::abs(a - b);
+	return std::max(std::max(diff.x, diff.y), std::max(diff.z, diff.w));
+}
+
+template <typename PackedType>
+static void MeasureAttributes(const VertexPosNormTexCol& source, const PackedType& packed, ConversionError& error) {
+	error.Normal = std::max(error.Normal, MaxDiff(glm::vec4(source.Normal, 0.0f), glm::vec4(glm::vec3(VertexPacking::UnpackNormal(packed.Normal)), 0.0f)));
+	error.UV = std::max(error.UV, MaxDiff(glm::vec4(source.UV, 0.0f, 0.0f), glm::vec4(VertexPacking::UnpackUV(packed.UV), 0.0f, 0.0f)));
+	error.Color = std::max(error.Color, MaxDiff(source.Color, VertexPacking::UnpackColor(packed.Color)));
+}
+
+static ConversionError MeasureError(const Builder& source, const MeshBuilder<VertexPosNormTexColCompact>& compact) {
+	ConversionError error;
+	for (size_t ix = 0; ix < source.GetVertexCount(); ix++) {
+		const VertexPosNormTexCol& original = source.GetVertexDataPtr()[ix];
+		const VertexPosNormTexColCompact& packed = compact.GetVertexDataPtr()[ix];
+		error.Position = std::max(error.Position, MaxDiff(glm::vec4(original.Position, 0.0f), glm::vec4(packed.Position, 0.0f)));
+		MeasureAttributes(original, packed, error);
+	}
+	return error;
+}
+
+static ConversionError MeasureError(const Builder& source, const MeshBuilder<VertexPosNormTexColQuantized>& quantized) {
+	ConversionError error;
+	for (size_t ix = 0; ix < source.GetVertexCount(); ix++) {
+		const VertexPosNormTexCol& original = source.GetVertexDataPtr()[ix];
+		const VertexPosNormTexColQuantized& packed = quantized.GetVertexDataPtr()[ix];
+		const glm::vec3 position = VertexPacking::UnpackPosition(packed.Position, quantized.GetVertexDecode());
+		error.Position = std::max(error.Position, MaxDiff(glm::vec4(original.Position, 0.0f), glm::vec4(position, 0.0f)));
+		MeasureAttributes(original, packed, error);
+	}
+	return error;
+}
+
+static void Report(const std::string& name, const Builder& mesh) {
+	BenchmarkTimer timer;
+	const MeshBuilder<VertexPosNormTexColCompact> compact = mesh.ToCompact();
+	const MeshBuilder<VertexPosNormTexColQuantized> quantized = mesh.ToQuantized();
+	const double ms = timer.ElapsedMs();
+
+	const ConversionError compactError = MeasureError(mesh, compact);
+	const ConversionError quantizedError = MeasureError(mesh, quantized);
+	const VertexFormat chosen = mesh.ChooseVertexFormat();
+	const size_t chosenSize = chosen == VertexFormat::Quantized ? sizeof(VertexPosNormTexColQuantized) :
+		chosen == VertexFormat::Compact ? sizeof(VertexPosNormTexColCompact) : sizeof(VertexPosNormTexCol);
+
+	std::cout << std::left << std::setw(20) << name << std::right
+		<< std::setw(10) << mesh.GetVertexCount()
+		<< std::setw(12) << (mesh.GetVertexCount() * sizeof(VertexPosNormTexCol)) / 1024.0
+		<< std::setw(12) << (mesh.GetVertexCount() * chosenSize) / 1024.0
+		<< std::setw(11) << FormatName(chosen)
+		<< std::setw(9) << static_cast<double>(sizeof(VertexPosNormTexCol)) / chosenSize << "x"
+		<< std::scientific << std::setprecision(1)
+		<< std::setw(10) << quantizedError.Position
+		<< std::setw(10) << compactError.Normal
+		<< std::setw(10) << compactError.UV
+		<< std::setw(10) << compactError.Color
+		<< std::fixed << std::setprecision(3)
+		<< std::setw(10) << ms << std::endl;
+}
+
+void RunVertexFormatBenchmark(const std::vector<std::string>& args)
+{
+	std::string modelDir = args.size() > 0 ? args[0] : "../../../projects/Assignment 1/res/models";
+
+	std::cout << "Float: " << sizeof(VertexPosNormTexCol) << " bytes, Compact: " << sizeof(VertexPosNormTexColCompact)
+		<< " bytes, Quantized: " << sizeof(VertexPosNormTexColQuantized) << " bytes" << std::endl;
+	std::cout << "Errors are the largest difference in any component (position error is for Quantized)" << std::endl;
+	std::cout << std::left << std::setw(20) << "Mesh" << std::right
+		<< std::setw(10) << "Verts"
+		<< std::setw(12) << "Float KB"
+		<< std::setw(12) << "Packed KB"
+		<< std::setw(11) << "Format"
+		<< std::setw(10) << "Saving"
+		<< std::setw(10) << "Pos err"
+		<< std::setw(10) << "Norm err"
+		<< std::setw(10) << "UV err"
+		<< std::setw(10) << "Col err"
+		<< std::setw(10) << "Conv ms" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+
+	Builder sphere;
+	MeshFactory::AddUvSphere(sphere, glm::vec3(0.0f), 1.0f, 5, glm::vec4(0.25f, 0.5f, 0.75f, 1.0f));
+	Report("uv sphere", sphere);
+
+	// Positions on a large mesh are too far apart for 16 bits to keep within tolerance
+	Builder plane;
+	MeshFactory::AddPlane(plane, glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec2(500.0f, 500.0f));
+	Report("plane (500 units)", plane);
+
+	if (std::filesystem::is_directory(modelDir)) {
+		std::vector<std::filesystem::path> files;
+		for (const auto& entry : std::filesystem::directory_iterator(modelDir)) {
+			if (entry.path().extension() == ".obj") {
+				files.push_back(entry.path());
+			}
+		}
+		std::sort(files.begin(), files.end());
+		for (const auto& path : files) {
+			Builder mesh;
+			ObjLoader::ParseFile(path.string(), mesh);
+			Report(path.filename().string(), mesh);
+		}
+	}
+}
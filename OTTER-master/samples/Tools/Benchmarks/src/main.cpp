@@ -0,0 +1,73 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+#include <Logging.h>
+#include <JobSystem.h>
+
+#include "Benchmark.h"
+
+struct BenchmarkEntry {
+	std::string Name;
+	std::function<void(const std::vector<std::string>&)> Run;
+};
+
+// All the benchmarks that we can run, in the order they will be run if none are specified
+const std::vector<BenchmarkEntry> Benchmarks = {
+	{ "obj", RunObjLoaderBenchmark },
+	{ "otm", RunBakedMeshBenchmark },
+	{ "uniforms", RunUniformLookupBenchmark },
+	{ "transforms", RunTransformBenchmark },
+	{ "hierarchy", RunHierarchyBenchmark },
+	{ "skinning", RunSkinningBenchmark },
+	{ "gltf", RunGltfBenchmark },
+	{ "meshopt", RunMeshOptimizerBenchmark },
+	{ "vertexformats", RunVertexFormatBenchmark },
+	{ "lods", RunLodBenchmark },
+	{ "textures", RunTextureBenchmark },
+	{ "render", RunRenderBenchmark },
+	{ "profiler", RunProfilerBenchmark },
+	{ "fixedstep", RunFixedStepBenchmark },
+	{ "behaviours", RunBehaviourBenchmark },
+	{ "jobs", RunJobBenchmark },
+	{ "scenes", RunSceneBenchmark },
+};
+
+// Usage: Benchmarks [benchmark name] [benchmark arguments...]
+int main(int argc, char** argv) {
+	Logger::Init();
+	JobSystem::Init();
+
+	std::vector<std::string> args(argv + 1, argv + argc);
+
+	int result = 0;
+	try {
+		if (args.empty()) {
+			for (const BenchmarkEntry& entry : Benchmarks) {
+				std::cout << "=== " << entry.Name << " ===" << std::endl;
+				entry.Run({});
+			}
+		} else {
+			auto it = std::find_if(Benchmarks.begin(), Benchmarks.end(), [&](const BenchmarkEntry& entry) { return entry.Name == args[0]; });
+			if (it == Benchmarks.end()) {
+				std::cout << "Unknown benchmark \"" << args[0] << "\", options are:" << std::endl;
+				for (const BenchmarkEntry& entry : Benchmarks) {
+					std::cout << "\t" << entry.Name << std::endl;
+				}
+				result = 1;
+			} else {
+				it->Run(std::vector<std::string>(args.begin() + 1, args.end()));
+			}
+		}
+	}
+	catch (const std::exception& e) {
+		std::cout << "Benchmark failed: " << e.what() << std::endl;
+		result = 1;
+	}
+
+	JobSystem::Shutdown();
+	Logger::Uninitialize();
+	return result;
+}
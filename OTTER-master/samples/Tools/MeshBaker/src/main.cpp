@@ -0,0 +1,103 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+
+#include <Logging.h>
+#include <ObjLoader.h>
+#include <NotObjLoader.h>
+#include <BakedMesh.h>
+
+// Converts every OBJ and NotObj file in a directory tree into a baked mesh (.otm) next to the source file, so
+// that the loaders can skip parsing at runtime. Meshes are optimized for the vertex cache unless --no-optimize is given,
+// stored in the smallest vertex format that keeps them accurate unless --float is given, and get a chain of levels of
+// detail unless --no-lods is given
+//
+// Usage: MeshBaker [--no-optimize] [--float] [--no-lods] [directory...]
+int main(int argc, char** argv) {
+	Logger::Init();
+
+	MeshBakeSettings settings;
+	std::vector<std::string> directories;
+	for (int ix = 1; ix < argc; ix++) {
+		if (std::string(argv[ix]) == "--no-optimize") {
+			settings.Optimize = false;
+		} else if (std::string(argv[ix]) == "--float") {
+			settings.Format = VertexFormat::Float;
+		} else if (std::string(argv[ix]) == "--no-lods") {
+			settings.LodErrors.clear();
+		} else {
+			directories.push_back(argv[ix]);
+		}
+	}
+	if (directories.empty() && std::filesystem::is_directory("../../../projects")) {
+		// Default to the models from the user projects, relative to our output directory
+		for (const auto& project : std::filesystem::directory_iterator("../../../projects")) {
+			if (std::filesystem::is_directory(project.path() / "res" / "models")) {
+				directories.push_back((project.path() / "res" / "models").string());
+			}
+		}
+	}
+
+	int baked = 0, failed = 0;
+	for (const std::string& directory : directories) {
+		if (!std::filesystem::is_directory(directory)) {
+			LOG_WARN("\"{}\" is not a directory", directory);
+			failed++;
+			continue;
+		}
+
+		LOG_INFO("Baking meshes in \"{}\"", directory);
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(directory)) {
+			if (!entry.is_regular_file()) {
+				continue;
+			}
+			const std::filesystem::path& path = entry.path();
+			const std::string extension = path.extension().string();
+			if (extension != ".obj" && extension != ".notobj") {
+				continue;
+			}
+
+			try {
+				auto start = std::chrono::high_resolution_clock::now();
+				MeshOptimizeReport report;
+				const std::string output = extension == ".obj" ?
+					ObjLoader::BakeFile(path.string(), glm::vec4(1.0f), settings, &report) :
+					NotObjLoader::BakeFile(path.string(), settings, &report);
+				const double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+				// Reading it back catches short writes and anything else that would make the cache unusable
+				BakedMesh::sptr mesh = BakedMesh::Open(output);
+				if (mesh == nullptr) {
+					LOG_WARN("\tFailed to bake {}: \"{}\" could not be read back", path.string(), output);
+					failed++;
+					continue;
+				}
+				const size_t tris = mesh->GetLods().empty() ? mesh->GetIndexCount() / 3 : mesh->GetLods()[0].IndexCount / 3;
+				LOG_INFO("\t{} -> {} ({} verts at {} bytes, {} tris, {:.1f} KB -> {:.1f} KB, {:.2f} ms)",
+					path.filename().string(), std::filesystem::path(output).filename().string(),
+					mesh->GetVertexCount(), mesh->GetVertexStride(), tris,
+					std::filesystem::file_size(path) / 1024.0, std::filesystem::file_size(output) / 1024.0, ms);
+				for (size_t lod = 1; lod < mesh->GetLods().size(); lod++) {
+					LOG_INFO("\t\tLOD {}: {} tris, error {:.5f}", lod, mesh->GetLods()[lod].IndexCount / 3, mesh->GetLods()[lod].Error);
+				}
+				if (settings.Optimize) {
+					LOG_INFO("\t\tACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+						report.Before.ACMR, report.After.ACMR, report.Before.ATVR, report.After.ATVR);
+				}
+				baked++;
+			}
+			catch (const std::exception& e) {
+				LOG_WARN("\tFailed to bake {}: {}", path.string(), e.what());
+				failed++;
+			}
+		}
+	}
+
+	LOG_INFO("Baked {} meshes, {} failed", baked, failed);
+
+	Logger::Uninitialize();
+	return failed == 0 ? 0 : 1;
+}
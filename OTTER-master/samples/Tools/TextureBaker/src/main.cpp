@@ -0,0 +1,147 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+
+#include <Logging.h>
+#include <BakedTexture.h>
+
+// Converts every image in a directory tree into a baked texture (.dds) next to the source file, with a full chain of
+// mip levels in a block compressed format, so that the loaders can skip decoding at runtime. The format is picked per
+// texture unless --format is given, mips use a box filter unless --kaiser is given, and the color space is detected
+// from the texture's name and channels unless --srgb, --linear or --normal is given. Cube maps are skipped, since they
+// are not loaded through the texture cache
+//
+// With --array, the remaining arguments are images that get baked into the layers of a single texture array instead
+// (see BakedTexture::LoadCachedArray)
+//
+// Usage: TextureBaker [--format none|bc1|bc3|bc4|bc5|bc7] [--kaiser] [--no-mips] [--clamp] [--srgb|--linear|--normal] [directory...]
+//        TextureBaker [options] --array output.dds image...
+int main(int argc, char** argv) {
+	Logger::Init();
+
+	TextureBakeSettings settings;
+	std::vector<std::string> directories;
+	std::string arrayPath;
+	for (int ix = 1; ix < argc; ix++) {
+		const std::string arg = argv[ix];
+		if (arg == "--format" && ix + 1 < argc) {
+			const std::string format = argv[++ix];
+			if (format == "none") {
+				settings.Compression = TextureCompression::None;
+			} else if (format == "bc1") {
+				settings.Compression = TextureCompression::BC1;
+			} else if (format == "bc3") {
+				settings.Compression = TextureCompression::BC3;
+			} else if (format == "bc4") {
+				settings.Compression = TextureCompression::BC4;
+			} else if (format == "bc5") {
+				settings.Compression = TextureCompression::BC5;
+			} else if (format == "bc7") {
+				settings.Compression = TextureCompression::BC7;
+			} else {
+				LOG_WARN("Unknown format \"{}\", picking formats per texture", format);
+			}
+		} else if (arg == "--kaiser") {
+			settings.Filter = MipFilter::Kaiser;
+		} else if (arg == "--no-mips") {
+			settings.GenerateMips = false;
+		} else if (arg == "--clamp") {
+			settings.WrapEdges = false;
+		} else if (arg == "--srgb") {
+			settings.ColorSpace = TextureColorSpace::SRGB;
+		} else if (arg == "--linear") {
+			settings.ColorSpace = TextureColorSpace::Linear;
+		} else if (arg == "--normal") {
+			settings.ColorSpace = TextureColorSpace::NormalMap;
+		} else if (arg == "--array" && ix + 1 < argc) {
+			arrayPath = argv[++ix];
+		} else {
+			directories.push_back(arg);
+		}
+	}
+	if (!arrayPath.empty()) {
+		int result = 0;
+		try {
+			auto start = std::chrono::high_resolution_clock::now();
+			BakedTexture::BakeArrayFile(arrayPath, directories, settings);
+			const double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+			BakedTexture::sptr texture = BakedTexture::Open(arrayPath);
+			const Texture2DLevel& top = texture->GetLevels()[0];
+			LOG_INFO("Baked {} layers -> {} ({}x{}, {}, {} levels, {:.1f} KB, {:.2f} ms)", texture->GetLayerCount(), arrayPath,
+				top.Width, top.Height, ~texture->GetFormat(), texture->GetLevels().size(), std::filesystem::file_size(arrayPath) / 1024.0, ms);
+		}
+		catch (const std::exception& e) {
+			LOG_WARN("Failed to bake {}: {}", arrayPath, e.what());
+			result = 1;
+		}
+		Logger::Uninitialize();
+		return result;
+	}
+
+	if (directories.empty() && std::filesystem::is_directory("../../../projects")) {
+		// Default to the images from the user projects, relative to our output directory
+		for (const auto& project : std::filesystem::directory_iterator("../../../projects")) {
+			if (std::filesystem::is_directory(project.path() / "res" / "images")) {
+				directories.push_back((project.path() / "res" / "images").string());
+			}
+		}
+	}
+
+	int baked = 0, failed = 0;
+	uintmax_t totalSource = 0, totalBaked = 0;
+	for (const std::string& directory : directories) {
+		if (!std::filesystem::is_directory(directory)) {
+			LOG_WARN("\"{}\" is not a directory", directory);
+			failed++;
+			continue;
+		}
+
+		LOG_INFO("Baking textures in \"{}\"", directory);
+		for (auto it = std::filesystem::recursive_directory_iterator(directory); it != std::filesystem::recursive_directory_iterator(); ++it) {
+			if (it->is_directory() && it->path().filename() == "cubemaps") {
+				it.disable_recursion_pending();
+				continue;
+			}
+			if (!it->is_regular_file()) {
+				continue;
+			}
+			const std::filesystem::path& path = it->path();
+			const std::string extension = path.extension().string();
+			if (extension != ".png" && extension != ".jpg" && extension != ".jpeg" && extension != ".bmp" && extension != ".tga") {
+				continue;
+			}
+
+			try {
+				auto start = std::chrono::high_resolution_clock::now();
+				const std::string output = BakedTexture::BakeFile(path.string(), settings);
+				const double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+				BakedTexture::sptr texture = BakedTexture::Open(output);
+				const Texture2DLevel& top = texture->GetLevels()[0];
+				const uintmax_t sourceSize = std::filesystem::file_size(path);
+				const uintmax_t bakedSize = std::filesystem::file_size(output);
+				// The decoded size is what the texture would have used in video memory before, as RGBA8 with a mip chain
+				const double decodedKb = top.Width * (double)top.Height * 4.0 * (settings.GenerateMips ? 4.0 / 3.0 : 1.0) / 1024.0;
+				LOG_INFO("\t{} -> {} ({}x{}, {}, {} levels, {:.1f} KB on disk -> {:.1f} KB, {:.1f} KB in memory -> {:.1f} KB, {:.2f} ms)",
+					path.filename().string(), std::filesystem::path(output).filename().string(),
+					top.Width, top.Height, ~texture->GetFormat(), texture->GetLevels().size(),
+					sourceSize / 1024.0, bakedSize / 1024.0, decodedKb, bakedSize / 1024.0, ms);
+				totalSource += sourceSize;
+				totalBaked += bakedSize;
+				baked++;
+			}
+			catch (const std::exception& e) {
+				LOG_WARN("\tFailed to bake {}: {}", path.string(), e.what());
+				failed++;
+			}
+		}
+	}
+
+	LOG_INFO("Baked {} textures ({:.1f} KB -> {:.1f} KB), {} failed", baked, totalSource / 1024.0, totalBaked / 1024.0, failed);
+
+	Logger::Uninitialize();
+	return failed == 0 ? 0 : 1;
+}